@@ -0,0 +1,178 @@
+// 资产集合：localId 字符串哈希集合 vs 行号位图（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_asset_bitset.c ../Cleaner8-Xu2/manager/ASAssetBitset.c -o bench_asset_bitset
+//   ./bench_asset_bitset            # 50k 张
+//   ./bench_asset_bitset 200000
+//
+// 模拟 recomputeSnapshotFromCurrentContainers + as_buildExcludeIdsForOther + removeModelsByIds 一轮：
+//   容器：comparable 图片 70%、视频 10%、截图 8%（与 comparable 部分重叠）、分组成员 20%、模糊 300 张、其他 40%
+//   1. 跨 4 个容器去重统计张数与字节
+//   2. 建「其他」的排除集合，再对全库逐个判定
+//   3. 删除 50 张：每个容器逐个 model 判是否在删除集合里
+// string：开放寻址哈希集合，存 localId 指针，FNV-1a + strcmp（NSSet 还要多一层消息发送与 -hash/-isEqual:）
+// bitset：localId 已登记成行号（App 里每个 localId 每次会话查一次字典，行号缓存在 model 上），之后只做位运算
+// 两边每一步的结果必须一致。
+
+#include "ASAssetBitset.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    char lid[48];       // 与 PHAsset.localIdentifier 同形：UUID/L0/001
+    uint32_t row;       // 登记后的行号（ASAssetModel.as_row）
+    uint64_t bytes;
+} Model;
+
+// MARK: - 字符串哈希集合
+
+typedef struct {
+    const char **slots;
+    uint32_t mask, count;
+} StrSet;
+
+static uint64_t fnv(const char *s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    while (*s) { h ^= (uint8_t)*s++; h *= 0x100000001b3ull; }
+    return h;
+}
+
+static void sset_init(StrSet *s, uint32_t expect) {
+    uint32_t cap = 64;
+    while (cap < expect * 2) cap *= 2;
+    s->slots = calloc(cap, sizeof(char *));
+    s->mask = cap - 1;
+    s->count = 0;
+}
+
+static int sset_contains(const StrSet *s, const char *k) {
+    for (uint32_t i = (uint32_t)fnv(k) & s->mask;; i = (i + 1) & s->mask) {
+        if (!s->slots[i]) return 0;
+        if (strcmp(s->slots[i], k) == 0) return 1;
+    }
+}
+
+static int sset_add(StrSet *s, const char *k) {
+    uint32_t i = (uint32_t)fnv(k) & s->mask;
+    for (; s->slots[i]; i = (i + 1) & s->mask)
+        if (strcmp(s->slots[i], k) == 0) return 0;
+    s->slots[i] = k;
+    s->count++;
+    return 1;
+}
+
+// MARK: - main
+
+typedef struct { Model **m; uint32_t n; } List;
+
+static List pick(Model *all, uint32_t n, uint32_t percent, uint32_t offset) {
+    List l = { malloc(sizeof(Model *) * n), 0 };
+    for (uint32_t i = 0; i < n; i++)
+        if ((i * 2654435761u + offset) % 100 < percent) l.m[l.n++] = &all[i];
+    return l;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 50000;
+
+    Model *all = calloc(n, sizeof(Model));
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t a = rng64(), b = rng64();
+        snprintf(all[i].lid, sizeof(all[i].lid), "%08X-%04X-%04X-%04X-%012" PRIX64 "/L0/001",
+                 (uint32_t)a, (uint32_t)(a >> 32) & 0xFFFF, (uint32_t)(a >> 48), (uint32_t)b & 0xFFFF, (uint64_t)(b >> 16 & 0xFFFFFFFFFFFFull));
+        all[i].bytes = 500000 + rng64() % 4000000;
+    }
+
+    List comparable = pick(all, n, 70, 0), videos = pick(all, n, 10, 71), shots = pick(all, n, 8, 65);
+    List grouped = pick(all, n, 20, 13), other = pick(all, n, 40, 37);
+    List blurry = { malloc(sizeof(Model *) * 300), 0 };
+    for (uint32_t i = 0; i < 300 && i < n; i++) blurry.m[blurry.n++] = &all[rng64() % n];
+    List gone = { malloc(sizeof(Model *) * 50), 0 };
+    for (uint32_t i = 0; i < 50 && i < n; i++) gone.m[gone.n++] = &all[rng64() % n];
+    List stats[4] = { comparable, videos, shots, grouped };
+    List conts[6] = { comparable, videos, shots, grouped, blurry, other };
+
+    // string
+    double t0 = now_ms();
+    StrSet ids; sset_init(&ids, n);
+    uint64_t sBytes = 0;
+    for (int c = 0; c < 4; c++)
+        for (uint32_t i = 0; i < stats[c].n; i++)
+            if (sset_add(&ids, stats[c].m[i]->lid)) sBytes += stats[c].m[i]->bytes;
+    StrSet ex; sset_init(&ex, grouped.n + blurry.n);
+    for (uint32_t i = 0; i < grouped.n; i++) sset_add(&ex, grouped.m[i]->lid);
+    for (uint32_t i = 0; i < blurry.n; i++) sset_add(&ex, blurry.m[i]->lid);
+    uint32_t sOther = 0;
+    for (uint32_t i = 0; i < n; i++) sOther += !sset_contains(&ex, all[i].lid);
+    StrSet del; sset_init(&del, gone.n);
+    for (uint32_t i = 0; i < gone.n; i++) sset_add(&del, gone.m[i]->lid);
+    uint32_t sKept = 0;
+    for (int c = 0; c < 6; c++)
+        for (uint32_t i = 0; i < conts[c].n; i++) sKept += !sset_contains(&del, conts[c].m[i]->lid);
+    double strMs = now_ms() - t0;
+
+    // bitset
+    for (uint32_t i = 0; i < n; i++) all[i].row = i + 1;
+
+    t0 = now_ms();
+    ASAssetBitset *bids = as_bitset_create(n + 1);
+    uint64_t bBytes = 0;
+    for (int c = 0; c < 4; c++)
+        for (uint32_t i = 0; i < stats[c].n; i++)
+            if (as_bitset_set(bids, stats[c].m[i]->row)) bBytes += stats[c].m[i]->bytes;
+    ASAssetBitset *bex = as_bitset_create(n + 1);
+    for (uint32_t i = 0; i < grouped.n; i++) as_bitset_set(bex, grouped.m[i]->row);
+    for (uint32_t i = 0; i < blurry.n; i++) as_bitset_set(bex, blurry.m[i]->row);
+    uint32_t bOther = 0;
+    for (uint32_t i = 0; i < n; i++) bOther += !as_bitset_test(bex, all[i].row);
+    ASAssetBitset *bdel = as_bitset_create(n + 1);
+    for (uint32_t i = 0; i < gone.n; i++) as_bitset_set(bdel, gone.m[i]->row);
+    uint32_t bKept = 0;
+    for (int c = 0; c < 6; c++)
+        for (uint32_t i = 0; i < conts[c].n; i++) bKept += !as_bitset_test(bdel, conts[c].m[i]->row);
+    double bitMs = now_ms() - t0;
+
+    // 差集 / 遍历与逐个判定一致
+    as_bitset_andnot(bids, bex);
+    uint32_t walk = 0, expect = 0;
+    for (uint32_t r = as_bitset_next(bids, 0); r != AS_BITSET_END; r = as_bitset_next(bids, r + 1)) walk++;
+    for (uint32_t i = 0; i < n; i++) expect += sset_contains(&ids, all[i].lid) && !sset_contains(&ex, all[i].lid);
+
+    int same = sBytes == bBytes && sOther == bOther && sKept == bKept && walk == expect && as_bitset_count(bids) == expect;
+
+    printf("assets %u: scanned %u (%" PRIu64 " bytes), other %u, kept %u after deleting %u\n",
+           n, ids.count, sBytes, sOther, sKept, del.count);
+    printf("%-24s %9.2f ms\n", "string hash set", strMs);
+    printf("%-24s %9.2f ms\n", "row bitset", bitMs);
+    printf("memory per full set: string %zu KB, bitset %u KB\n",
+           (size_t)(ids.mask + 1) * sizeof(char *) / 1024, (n + 64) / 8 / 1024);
+    printf("result %s\n", same ? "identical" : "DIFFERENT");
+
+    as_bitset_destroy(bids); as_bitset_destroy(bex); as_bitset_destroy(bdel);
+    free(ids.slots); free(ex.slots); free(del.slots);
+    for (int c = 0; c < 6; c++) free(conts[c].m);
+    free(gone.m); free(all);
+    if (!same) {
+        fprintf(stderr, "bitset check failed\n");
+        return 1;
+    }
+    return 0;
+}
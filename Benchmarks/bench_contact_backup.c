@@ -0,0 +1,381 @@
+// 联系人备份容器：列表 / 翻页 / 删除 vs 旧的「整个 vCard base64 进 JSON」，正确性核对（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_contact_backup.c ../Cleaner8-Xu2/manager/CMBackupFormat.c -o bench_contact_backup
+//   ./bench_contact_backup            # 1k / 5k / 20k 条
+//   ./bench_contact_backup 50000
+//
+// 合成 vCard 文本（300~900 字节 / 条）。旧格式的代价按它必须做的事算：
+//   列表 / 看第一页 = 读整个 JSON + base64 解码 + 按 END:VCARD 切出全部联系人；删几条 = 以上 + 重新编码 + 整个文件重写。
+// 新容器：列表只读 Header + 字符串；第一页 = 打开（校验表）+ 取 50 条；删几条 = 只改写头部（Header + 表）。
+// vCard 解析（CNContactVCardSerialization）本身不在这里，两边都要做，新格式只解析看到的那一页。
+//   核对 1：写入 / 读回逐字节相同，flags / rawLen 保留。
+//   核对 2：多轮随机删除（含重复 / 越界下标）与参照数组一致；压缩后顺序不变、无死字节。
+//   核对 3：截断 / 改坏表项的文件打开失败；改坏记录字节时该条取不出，其余不受影响。
+
+#include "CMBackupFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static inline uint32_t rnd(uint32_t n) { return (uint32_t)(rng64() % n); }
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    char *bytes;
+    uint32_t len;
+} Rec;
+
+static Rec make_vcard(uint32_t i) {
+    char buf[2048];
+    int n = snprintf(buf, sizeof(buf),
+                     "BEGIN:VCARD\r\nVERSION:3.0\r\nPRODID:-//Apple Inc.//iPhone OS 17.0//EN\r\n"
+                     "N:Name%u;Given%u;;;\r\nFN:Given%u Name%u\r\n"
+                     "TEL;type=CELL;type=VOICE;type=pref:+86 1%02u %04u %04u\r\n",
+                     i, rnd(1000), rnd(1000), i, rnd(100), rnd(10000), rnd(10000));
+    uint32_t extra = rnd(6);
+    for (uint32_t k = 0; k < extra && n < 1800; k++) {
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n, "item%u.EMAIL;type=INTERNET:user%u.%u@example.com\r\n"
+                      "item%u.ADR;type=HOME:;;%u Long Street Name;City;;%05u;China\r\n",
+                      k, i, k, k, rnd(999), rnd(100000));
+    }
+    n += snprintf(buf + n, sizeof(buf) - (size_t)n, "END:VCARD\r\n");
+    Rec r = { malloc((size_t)n), (uint32_t)n };
+    memcpy(r.bytes, buf, (size_t)n);
+    return r;
+}
+
+// MARK: - 旧格式（base64 整块）
+
+static const char kB64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static char *b64_encode(const uint8_t *p, size_t n, size_t *outLen) {
+    size_t len = (n + 2) / 3 * 4;
+    char *o = malloc(len + 1);
+    size_t j = 0;
+    for (size_t i = 0; i < n; i += 3) {
+        uint32_t v = (uint32_t)p[i] << 16;
+        if (i + 1 < n) v |= (uint32_t)p[i + 1] << 8;
+        if (i + 2 < n) v |= p[i + 2];
+        o[j++] = kB64[(v >> 18) & 63];
+        o[j++] = kB64[(v >> 12) & 63];
+        o[j++] = i + 1 < n ? kB64[(v >> 6) & 63] : '=';
+        o[j++] = i + 2 < n ? kB64[v & 63] : '=';
+    }
+    o[j] = 0;
+    *outLen = len;
+    return o;
+}
+
+static uint8_t *b64_decode(const char *s, size_t n, size_t *outLen) {
+    static int8_t dec[256];
+    static int inited;
+    if (!inited) {
+        memset(dec, -1, sizeof(dec));
+        for (int i = 0; i < 64; i++) dec[(uint8_t)kB64[i]] = (int8_t)i;
+        inited = 1;
+    }
+    uint8_t *o = malloc(n / 4 * 3 + 3);
+    size_t j = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < n; i++) {
+        int8_t d = dec[(uint8_t)s[i]];
+        if (d < 0) continue;
+        acc = (acc << 6) | (uint32_t)d;
+        bits += 6;
+        if (bits >= 8) { bits -= 8; o[j++] = (uint8_t)(acc >> bits); }
+    }
+    *outLen = j;
+    return o;
+}
+
+typedef struct {
+    char *json;
+    size_t len;
+} Legacy;
+
+static Legacy legacy_write(Rec *recs, uint32_t n) {
+    size_t total = 0;
+    for (uint32_t i = 0; i < n; i++) total += recs[i].len;
+    uint8_t *blob = malloc(total);
+    size_t at = 0;
+    for (uint32_t i = 0; i < n; i++) { memcpy(blob + at, recs[i].bytes, recs[i].len); at += recs[i].len; }
+    size_t bl;
+    char *b64 = b64_encode(blob, total, &bl);
+    free(blob);
+    Legacy l;
+    l.json = malloc(bl + 256);
+    l.len = (size_t)sprintf(l.json, "{\n  \"backupId\" : \"X\",\n  \"name\" : \"Backup\",\n  \"count\" : %u,\n  \"vcardBase64\" : \"%s\"\n}", n, b64);
+    free(b64);
+    return l;
+}
+
+// 找到 vcardBase64 的值，解码后按 END:VCARD 切
+static uint32_t legacy_parse(const Legacy *l, uint8_t **blobOut, uint32_t *starts, uint32_t cap) {
+    const char *k = strstr(l->json, "\"vcardBase64\" : \"");
+    const char *v = k + strlen("\"vcardBase64\" : \"");
+    const char *e = strchr(v, '"');
+    size_t bl;
+    uint8_t *blob = b64_decode(v, (size_t)(e - v), &bl);
+    uint32_t n = 0;
+    starts[0] = 0;
+    for (size_t i = 0; i + 11 <= bl && n < cap; i++) {
+        if (blob[i] == 'E' && memcmp(blob + i, "END:VCARD\r\n", 11) == 0) starts[++n] = (uint32_t)(i + 11);
+    }
+    *blobOut = blob;
+    return n;
+}
+
+// MARK: - 核对
+
+static uint8_t *build(Rec *recs, uint32_t n, size_t *len) {
+    CMBackupWriter *w = cm_bk_writer_create();
+    for (uint32_t i = 0; i < n; i++) cm_bk_writer_add(w, recs[i].bytes, recs[i].len, recs[i].len * 3, i % 3 == 0 ? CM_BK_COMPRESSED : 0);
+    uint8_t *out = NULL;
+    cm_bk_writer_finish(w, "0D9C-UUID", 9, "我的备份", (uint32_t)strlen("我的备份"), 1700000000000ll, &out, len);
+    cm_bk_writer_destroy(w);
+    return out;
+}
+
+static int same_as(const CMBackupView *v, Rec *recs, const uint32_t *order, uint32_t n) {
+    if (cm_bk_live_count(v) != n) return 0;
+    for (uint32_t i = 0; i < n; i++) {
+        CMBackupRecord r;
+        const Rec *x = &recs[order[i]];
+        if (!cm_bk_get(v, i, &r) || r.storedLen != x->len || memcmp(r.bytes, x->bytes, x->len) != 0) return 0;
+        if (r.rawLen != x->len * 3 || r.flags != (order[i] % 3 == 0 ? CM_BK_COMPRESSED : 0u)) return 0;
+    }
+    return 1;
+}
+
+static int check_roundtrip_and_delete(void) {
+    const uint32_t n = 3000;
+    Rec *recs = malloc(sizeof(Rec) * n);
+    for (uint32_t i = 0; i < n; i++) recs[i] = make_vcard(i);
+    size_t len;
+    uint8_t *file = build(recs, n, &len);
+    int ok = 1;
+
+    // 列表只读元数据
+    CMBackupHeader h;
+    size_t meta = cm_bk_meta_len(file, CM_BK_HEADER_BYTES);
+    if (!meta || !cm_bk_read_header(file, meta, &h) || h.live != n || h.idLen != 9 ||
+        memcmp(h.backupId, "0D9C-UUID", 9) != 0 || memcmp(h.name, "我的备份", h.nameLen) != 0) ok = 0;
+
+    uint32_t *order = malloc(sizeof(uint32_t) * n);
+    for (uint32_t i = 0; i < n; i++) order[i] = i;
+    uint32_t live = n;
+
+    CMBackupView *v = cm_bk_open(file, len);
+    if (!v || !same_as(v, recs, order, live)) ok = 0;
+    cm_bk_close(v);
+
+    // 多轮删除：每轮在当前活下标上删一批（含重复 / 越界），头部原地改写
+    uint32_t rounds = 0;
+    while (live > 0 && ok) {
+        uint32_t k = 1 + rnd(live < 40 ? live : 40);
+        uint32_t idx[64];
+        for (uint32_t i = 0; i < k; i++) idx[i] = rnd(live + 3);
+        idx[k] = idx[0];                                    // 重复
+        size_t headLen = cm_bk_head_len(file, len);
+        uint32_t removed = cm_bk_delete(file, headLen, idx, k + 1);
+
+        // 参照：按值去重后从大到小删
+        uint8_t *mark = calloc(live, 1);
+        uint32_t want = 0;
+        for (uint32_t i = 0; i <= k; i++) if (idx[i] < live && !mark[idx[i]]) { mark[idx[i]] = 1; want++; }
+        uint32_t w = 0;
+        for (uint32_t i = 0; i < live; i++) if (!mark[i]) order[w++] = order[i];
+        free(mark);
+        live = w;
+        if (removed != want) ok = 0;
+
+        v = cm_bk_open(file, len);
+        if (!v || !same_as(v, recs, order, live)) ok = 0;
+
+        // 隔几轮压缩一次
+        if (v && (rounds % 7 == 6 || cm_bk_should_compact(v, 0))) {
+            uint8_t *c; size_t cl;
+            if (!cm_bk_compact(v, &c, &cl)) ok = 0;
+            cm_bk_close(v);
+            free(file);
+            file = c; len = cl;
+            v = cm_bk_open(file, len);
+            if (!v || !same_as(v, recs, order, live) || cm_bk_header(v)->deadBytes != 0 || cm_bk_header(v)->count != live) ok = 0;
+        }
+        cm_bk_close(v);
+        rounds++;
+    }
+    printf("round trip + %u delete rounds + compaction vs reference (%u records): %s\n", rounds, n, ok ? "identical" : "DIFFERENT");
+
+    free(order);
+    free(file);
+    for (uint32_t i = 0; i < n; i++) free(recs[i].bytes);
+    free(recs);
+    return ok;
+}
+
+static int check_corruption(void) {
+    const uint32_t n = 200;
+    Rec *recs = malloc(sizeof(Rec) * n);
+    for (uint32_t i = 0; i < n; i++) recs[i] = make_vcard(i);
+    size_t len;
+    uint8_t *file = build(recs, n, &len);
+    size_t headLen = cm_bk_head_len(file, len);
+    int ok = 1;
+
+    // 截断：头部不完整必须打开失败；记录区被截断时偏移越界也必须失败
+    for (int t = 0; t < 200; t++) {
+        size_t cut = rnd((uint32_t)len);
+        CMBackupView *v = cm_bk_open(file, cut);
+        if (v) { ok = 0; cm_bk_close(v); }
+    }
+
+    // 改坏表项偏移 / 长度
+    for (int t = 0; t < 200; t++) {
+        uint8_t *bad = malloc(len);
+        memcpy(bad, file, len);
+        size_t tableOff = cm_bk_meta_len(file, len);
+        size_t at = tableOff + (size_t)rnd(n) * 24 + rnd(12);
+        bad[at] ^= (uint8_t)(1 + rnd(255));
+        CMBackupView *v = cm_bk_open(bad, len);
+        if (v) {
+            // 偏移仍在范围内：每条要么取出与原来相同，要么校验失败
+            for (uint32_t i = 0; i < cm_bk_live_count(v); i++) {
+                CMBackupRecord r;
+                if (cm_bk_get(v, i, &r) && (r.storedLen != recs[i].len || memcmp(r.bytes, recs[i].bytes, r.storedLen) != 0)) ok = 0;
+            }
+            cm_bk_close(v);
+        }
+        free(bad);
+    }
+
+    // 改坏记录字节：只有那一条取不出
+    uint32_t victim = 77;
+    CMBackupView *v = cm_bk_open(file, len);
+    CMBackupRecord r;
+    cm_bk_get(v, victim, &r);
+    size_t at = (size_t)((const uint8_t *)r.bytes - file) + 5;
+    cm_bk_close(v);
+    file[at] ^= 0x20;
+    v = cm_bk_open(file, len);
+    for (uint32_t i = 0; v && i < n; i++) if (cm_bk_get(v, i, &r) != (i != victim)) ok = 0;
+    cm_bk_close(v);
+    if (headLen == 0) ok = 0;
+
+    printf("truncated / corrupted files: %s\n", ok ? "rejected" : "ACCEPTED");
+    free(file);
+    for (uint32_t i = 0; i < n; i++) free(recs[i].bytes);
+    free(recs);
+    return ok;
+}
+
+// MARK: - 吞吐
+
+static void bench(uint32_t n) {
+    Rec *recs = malloc(sizeof(Rec) * n);
+    for (uint32_t i = 0; i < n; i++) recs[i] = make_vcard(i);
+    uint32_t *starts = malloc(sizeof(uint32_t) * (n + 1));
+    const uint32_t page = 50, del = 5;
+    volatile uint64_t sink = 0;
+
+    // 旧格式
+    Legacy l = legacy_write(recs, n);
+    double t0 = now_ms();
+    uint8_t *blob;
+    uint32_t got = legacy_parse(&l, &blob, starts, n);
+    sink += got;
+    double legacyList = now_ms() - t0;
+    t0 = now_ms();
+    {
+        // 删 5 条：整体解析 + 拼回 + 重新编码 + 整个 JSON 重写
+        uint8_t *b2;
+        legacy_parse(&l, &b2, starts, n);
+        Rec *keep = malloc(sizeof(Rec) * n);
+        uint32_t kn = 0;
+        for (uint32_t i = 0; i < got; i++) {
+            if (i % (n / del) == 0 && i / (n / del) < del) continue;
+            keep[kn++] = (Rec){ (char *)b2 + starts[i], starts[i + 1] - starts[i] };
+        }
+        Legacy l2 = legacy_write(keep, kn);
+        sink += l2.len;
+        free(l2.json);
+        free(keep);
+        free(b2);
+    }
+    double legacyDel = now_ms() - t0;
+    size_t legacyBytes = l.len;
+    free(blob);
+    free(l.json);
+
+    // 新容器
+    size_t len;
+    uint8_t *file = build(recs, n, &len);
+    t0 = now_ms();
+    CMBackupHeader h;
+    cm_bk_read_header(file, cm_bk_meta_len(file, CM_BK_HEADER_BYTES), &h);
+    sink += h.live;
+    double bkList = now_ms() - t0;
+
+    t0 = now_ms();
+    CMBackupView *v = cm_bk_open(file, len);
+    for (uint32_t i = 0; i < page; i++) {
+        CMBackupRecord r;
+        if (cm_bk_get(v, i, &r)) sink += r.storedLen;
+    }
+    cm_bk_close(v);
+    double bkPage = now_ms() - t0;
+
+    t0 = now_ms();
+    size_t headLen = cm_bk_head_len(file, len);
+    uint8_t *head = malloc(headLen);
+    memcpy(head, file, headLen);                            // 读头部
+    uint32_t idx[5];
+    for (uint32_t i = 0; i < del; i++) idx[i] = i * (n / del);
+    sink += cm_bk_delete(head, headLen, idx, del);
+    memcpy(file, head, headLen);                            // 写回头部
+    free(head);
+    double bkDel = now_ms() - t0;
+
+    printf("%8u %10.2f %10.3f %10.3f %10.2f %10.3f %11zu %11zu %11zu\n",
+           n, legacyList, bkList, bkPage, legacyDel, bkDel, legacyBytes, len, headLen);
+
+    free(file);
+    free(starts);
+    for (uint32_t i = 0; i < n; i++) free(recs[i].bytes);
+    free(recs);
+    (void)sink;
+}
+
+int main(int argc, char **argv) {
+    int ok = check_roundtrip_and_delete();
+    ok &= check_corruption();
+
+    printf("\n%8s %10s %10s %10s %10s %10s %11s %11s %11s\n", "contacts", "old list", "new list", "new page50",
+           "old del5", "new del5", "old bytes", "new bytes", "del writes");
+    printf("%8s %10s %10s %10s %10s %10s %11s %11s %11s\n", "", "ms", "ms", "ms", "ms", "ms", "", "", "bytes");
+    if (argc > 1) {
+        bench((uint32_t)strtoul(argv[1], NULL, 10));
+    } else {
+        bench(1000);
+        bench(5000);
+        bench(20000);
+    }
+    return ok ? 0 : 1;
+}
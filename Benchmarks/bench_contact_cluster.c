@@ -0,0 +1,364 @@
+// 重复联系人聚类：精确键传递合并 + 分块模糊找疑似对，耗时随规模的变化、召回 / 精度，与全对比较核对（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_contact_cluster.c ../Cleaner8-Xu2/manager/CMContactCluster.c -o bench_contact_cluster
+//   ./bench_contact_cluster            # 6.25k / 12.5k / 25k / 50k / 100k
+//   ./bench_contact_cluster 200000
+//
+// 合成通讯录：拉丁化姓名（音节拼成的 名 + 姓）、11 位手机号、约 40% 有邮箱。约 12% 的条目是前面某人的重复：
+//   同名换号 / 姓名 1~2 处错字换号 / 同号换名 / 同邮箱换名 / 错字同号；来源本身也可能是重复，
+//   于是自然出现「A、B 同名，B、C 同号」的链。
+//   簇（只由精确键合并，会被预选 / 计入看板）：召回 = 重复条目与来源同簇的比例；精度 = 簇内成对来源相同的比例。
+//   疑似对（姓名相近、不合并）：精度 = 两端来源相同的比例；「+疑似」召回 = 同簇或被某个疑似对连上的重复条目比例。
+//   音节表里有 zhang / wang / wei 这类高频拼音，随机撞出的同音名就是疑似对精度的下限来源。
+//   核对 1：有界编辑距离与完整 DP 在随机串上逐个相同。
+//   核对 2：2000 人时与全对比较（同样的键 / 距离规则、不分块）相比：簇必须完全相同；
+//          每个疑似对都必须满足距离规则且两端不同簇，并报告全对能找到的簇对里分块找回了多少。
+//   核对 3：手工小例子，同一精确簇里姓名相近的两人（包括只靠后面一行才连上的）不会再出疑似对。
+
+#include "CMContactCluster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static inline uint32_t rnd(uint32_t n) { return (uint32_t)(rng64() % n); }
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static uint64_t fnv(const uint16_t *s, uint32_t n) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint32_t i = 0; i < n; i++) { h ^= s[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+typedef struct {
+    uint16_t name[CM_CLUSTER_FUZZY_MAX];
+    uint32_t nameLen;
+    uint64_t phone, email;   // 0 = 没有
+    uint32_t origin;         // 真实的人
+} Contact;
+
+static const char *kSyl[] = {
+    "an", "bo", "chen", "da", "en", "fei", "gao", "hui", "jin", "kai", "li", "ming", "na", "ou",
+    "ping", "qing", "ran", "shu", "tao", "wei", "xin", "yu", "zhi", "zhang", "wang", "liu", "mar",
+    "tin", "son", "ber", "ka", "ro", "el", "la", "mi", "sa", "to", "ni", "co", "de",
+    "bai", "cao", "ding", "feng", "guo", "han", "huang", "jiang", "kong", "lei", "lin", "luo", "meng",
+    "peng", "qian", "shen", "song", "sun", "tang", "xie", "xu", "yang", "ye", "zhao", "zhou", "zhu",
+    "al", "ben", "car", "dav", "ed", "fran", "geo", "hel", "ive", "jo", "kev", "lu", "mat", "nor",
+};
+
+// 名 2 个音节 + 姓 2~3 个音节
+static uint32_t make_name(uint16_t *out) {
+    uint32_t n = 0;
+    uint32_t parts = 4 + rnd(2);
+    for (uint32_t p = 0; p < parts; p++) {
+        const char *s = kSyl[rnd(sizeof(kSyl) / sizeof(kSyl[0]))];
+        while (*s && n < CM_CLUSTER_FUZZY_MAX) out[n++] = (uint16_t)*s++;
+    }
+    return n;
+}
+
+static void typo(Contact *c, uint32_t edits) {
+    for (uint32_t e = 0; e < edits && c->nameLen > 2; e++) {
+        uint32_t i = rnd(c->nameLen);
+        switch (rnd(3)) {
+            case 0: c->name[i] = (uint16_t)('a' + rnd(26)); break;                    // 替换
+            case 1: memmove(c->name + i, c->name + i + 1, sizeof(uint16_t) * (c->nameLen - i - 1));
+                    c->nameLen--; break;                                              // 删除
+            default:
+                if (c->nameLen < CM_CLUSTER_FUZZY_MAX) {
+                    memmove(c->name + i + 1, c->name + i, sizeof(uint16_t) * (c->nameLen - i));
+                    c->name[i] = (uint16_t)('a' + rnd(26));
+                    c->nameLen++;
+                }
+        }
+    }
+}
+
+static uint64_t new_phone(void) { return 13000000000ull + rng64() % 7000000000ull; }
+
+static Contact *make_book(uint32_t n) {
+    Contact *b = calloc(n, sizeof(Contact));
+    for (uint32_t i = 0; i < n; i++) {
+        Contact *c = &b[i];
+        if (i > 16 && rnd(100) < 12) {
+            uint32_t j = i - 1 - rnd(i < 5000 ? i - 1 : 5000);
+            *c = b[j];
+            switch (rnd(5)) {
+                case 0: c->phone = new_phone(); c->email = 0; break;                       // 同名换号
+                case 1: typo(c, 1 + rnd(2)); c->phone = new_phone(); c->email = 0; break;  // 错字换号
+                case 2: c->nameLen = make_name(c->name); break;                            // 同号换名
+                case 3: if (c->email) { c->nameLen = make_name(c->name); c->phone = new_phone(); }
+                        break;                                                             // 同邮箱换名
+                default: typo(c, 1); break;                                                // 错字同号
+            }
+            continue;
+        }
+        c->nameLen = make_name(c->name);
+        c->phone = new_phone();
+        c->email = rnd(100) < 40 ? rng64() | 1 : 0;
+        c->origin = i;
+    }
+    return b;
+}
+
+static CMCluster *load(const Contact *b, uint32_t n) {
+    CMCluster *c = cm_cluster_create();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t row = cm_cluster_add(c, b[i].name, b[i].nameLen);
+        cm_cluster_add_key(c, row, CMClusterKeyName, fnv(b[i].name, b[i].nameLen));
+        if (b[i].phone) cm_cluster_add_key(c, row, CMClusterKeyPhone, b[i].phone);
+        if (b[i].email) cm_cluster_add_key(c, row, CMClusterKeyEmail, b[i].email);
+    }
+    return c;
+}
+
+// MARK: - 参照实现
+
+static uint32_t full_dp(const uint16_t *a, uint32_t la, const uint16_t *b, uint32_t lb) {
+    uint32_t d[CM_CLUSTER_FUZZY_MAX + 1][CM_CLUSTER_FUZZY_MAX + 1];
+    for (uint32_t i = 0; i <= la; i++) d[i][0] = i;
+    for (uint32_t j = 0; j <= lb; j++) d[0][j] = j;
+    for (uint32_t i = 1; i <= la; i++) {
+        for (uint32_t j = 1; j <= lb; j++) {
+            uint32_t v = d[i - 1][j - 1] + (a[i - 1] != b[j - 1]);
+            if (d[i - 1][j] + 1 < v) v = d[i - 1][j] + 1;
+            if (d[i][j - 1] + 1 < v) v = d[i][j - 1] + 1;
+            d[i][j] = v;
+        }
+    }
+    return d[la][lb];
+}
+
+static uint32_t uf_find(uint32_t *p, uint32_t x) {
+    while (p[x] != x) { p[x] = p[p[x]]; x = p[x]; }
+    return x;
+}
+
+static void uf_union(uint32_t *p, uint32_t a, uint32_t b) {
+    a = uf_find(p, a); b = uf_find(p, b);
+    if (a != b) p[a < b ? b : a] = a < b ? a : b;
+}
+
+static int brute_fuzzy(const Contact *x, const Contact *y, const CMClusterParams *p) {
+    if (x->nameLen < p->minFuzzyLen || y->nameLen < p->minFuzzyLen) return 0;
+    uint32_t mx = x->nameLen > y->nameLen ? x->nameLen : y->nameLen;
+    uint32_t k = mx >= p->longLen ? p->maxDistLong : p->maxDistShort;
+    return full_dp(x->name, x->nameLen, y->name, y->nameLen) <= k;
+}
+
+// 全对比较：精确键合并成簇（不分块）
+static uint32_t *brute_force(const Contact *b, uint32_t n) {
+    uint32_t *par = malloc(sizeof(uint32_t) * n);
+    for (uint32_t i = 0; i < n; i++) par[i] = i;
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = i + 1; j < n; j++) {
+            const Contact *x = &b[i], *y = &b[j];
+            if (fnv(x->name, x->nameLen) == fnv(y->name, y->nameLen) ||
+                (x->phone && x->phone == y->phone) || (x->email && x->email == y->email)) uf_union(par, i, j);
+        }
+    }
+    return par;
+}
+
+static int check_edit_distance(void) {
+    uint32_t bad = 0;
+    for (uint32_t t = 0; t < 200000; t++) {
+        uint16_t a[CM_CLUSTER_FUZZY_MAX], b[CM_CLUSTER_FUZZY_MAX];
+        uint32_t la = rnd(20), lb = la + rnd(5);
+        lb = lb >= 2 ? lb - 2 : 0;
+        for (uint32_t i = 0; i < la; i++) a[i] = (uint16_t)('a' + rnd(4));
+        for (uint32_t i = 0; i < lb; i++) b[i] = i < la && rnd(4) ? a[i] : (uint16_t)('a' + rnd(4));
+        uint32_t k = rnd(4);
+        uint32_t ref = full_dp(a, la, b, lb);
+        uint32_t got = cm_edit_distance_bounded(a, la, b, lb, k);
+        if ((ref <= k) ? got != ref : got != k + 1) bad++;
+    }
+    return bad == 0;
+}
+
+static int check_against_brute(uint32_t n) {
+    CMClusterParams p;
+    cm_cluster_default_params(&p);
+    Contact *b = make_book(n);
+    CMCluster *c = load(b, n);
+    cm_cluster_run(c, &p);
+    uint32_t *par = brute_force(b, n);
+
+    // 簇：两边对任意两行的「同簇」判断必须一致
+    uint32_t violations = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = i + 1; j < n; j++) {
+            int x = cm_cluster_find(c, i) == cm_cluster_find(c, j);
+            int y = uf_find(par, i) == uf_find(par, j);
+            violations += x != y;
+        }
+    }
+
+    // 疑似对：必须满足距离规则、两端不同簇、簇对不重复
+    uint32_t pc = cm_cluster_fuzzy_pair_count(c);
+    uint8_t *found = calloc((size_t)n * n, 1);   // 按簇根对记
+    for (uint32_t i = 0; i < pc; i++) {
+        uint32_t x, y;
+        cm_cluster_fuzzy_pair(c, i, &x, &y);
+        uint32_t rx = uf_find(par, x), ry = uf_find(par, y);
+        if (x >= y || rx == ry || !brute_fuzzy(&b[x], &b[y], &p)) { violations++; continue; }
+        size_t k = rx < ry ? (size_t)rx * n + ry : (size_t)ry * n + rx;
+        if (found[k]) violations++;
+        found[k] = 1;
+    }
+    uint8_t *want = calloc((size_t)n * n, 1);
+    uint32_t pairsBrute = 0, pairsFound = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = i + 1; j < n; j++) {
+            uint32_t ri = uf_find(par, i), rj = uf_find(par, j);
+            if (ri == rj || !brute_fuzzy(&b[i], &b[j], &p)) continue;
+            size_t k = ri < rj ? (size_t)ri * n + rj : (size_t)rj * n + ri;
+            if (want[k]) continue;
+            want[k] = 1;
+            pairsBrute++;
+            pairsFound += found[k];
+        }
+    }
+    printf("vs all-pairs (%u contacts): violations %u, cluster pairs with a fuzzy match recovered %.2f%%\n",
+           n, violations, pairsBrute ? 100.0 * pairsFound / pairsBrute : 100.0);
+    free(found); free(want); free(par); free(b);
+    cm_cluster_destroy(c);
+    return violations == 0;
+}
+
+// 同一精确簇里的两人即使姓名相近也不能再作为疑似对：
+//   0、1 同号且姓名差一个字；3、4 姓名相近，只靠后面的 5（与 3 同号、与 4 同邮箱）连到一起；
+//   2 与 0 / 1 姓名相近但不同簇 —— 只应有一个疑似对，且两端不同簇
+static int check_exact_excludes_possible(void) {
+    static const struct { const char *name; uint64_t phone, email; } kRows[] = {
+        { "zhangwei lin", 13800000001ull, 0 },
+        { "zhangwei lim", 13800000001ull, 0 },
+        { "zhangwei lan", 13800000002ull, 7 },
+        { "wangfang xiu", 13800000003ull, 0 },
+        { "wangfang xiv", 0,              9 },
+        { "li na",        13800000003ull, 9 },
+    };
+    uint32_t n = sizeof(kRows) / sizeof(kRows[0]);
+    Contact b[sizeof(kRows) / sizeof(kRows[0])];
+    memset(b, 0, sizeof(b));
+    for (uint32_t i = 0; i < n; i++) {
+        for (const char *s = kRows[i].name; *s; s++) b[i].name[b[i].nameLen++] = (uint16_t)*s;
+        b[i].phone = kRows[i].phone;
+        b[i].email = kRows[i].email;
+    }
+    CMCluster *c = load(b, n);
+    cm_cluster_run(c, NULL);
+
+    uint32_t pc = cm_cluster_fuzzy_pair_count(c), bad = 0;
+    for (uint32_t i = 0; i < pc; i++) {
+        uint32_t x, y;
+        cm_cluster_fuzzy_pair(c, i, &x, &y);
+        bad += cm_cluster_find(c, x) == cm_cluster_find(c, y);
+    }
+    int ok = pc == 1 && bad == 0 && cm_cluster_find(c, 0) == cm_cluster_find(c, 1) &&
+             cm_cluster_find(c, 3) == cm_cluster_find(c, 4);
+    printf("possible pairs inside an exact cluster: %u of %u pairs (%s)\n", bad, pc, ok ? "ok" : "WRONG");
+    cm_cluster_destroy(c);
+    return ok;
+}
+
+// MARK: - main
+
+static int cmp_u64(const void *x, const void *y) {
+    uint64_t a = *(const uint64_t *)x, b = *(const uint64_t *)y;
+    return a < b ? -1 : (a > b);
+}
+
+int main(int argc, char **argv) {
+    uint32_t maxN = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+
+    int edOk = check_edit_distance();
+    printf("bounded edit distance vs full DP: %s\n", edOk ? "identical" : "DIFFERENT");
+    int bruteOk = check_against_brute(2000);
+    int exactOk = check_exact_excludes_possible();
+
+    printf("\n%8s %9s %9s %8s %10s %8s %8s %9s %8s %8s %9s %8s\n",
+           "contacts", "load ms", "run ms", "ns/row", "compares", "fuzzy", "recall", "precision", "largest",
+           "+fuzzy", "pair prec", "big");
+    for (uint32_t n = 6250; n <= maxN; n *= 2) {
+        Contact *b = make_book(n);
+        CMClusterParams p;
+        cm_cluster_default_params(&p);
+
+        double t0 = now_ms();
+        CMCluster *c = load(b, n);
+        double loadMs = now_ms() - t0;
+        t0 = now_ms();
+        cm_cluster_run(c, &p);
+        double runMs = now_ms() - t0;
+
+        CMClusterStats st;
+        cm_cluster_stats(c, &st);
+
+        // 疑似对：两端来源相同的比例；并记下每个簇根被哪些簇根疑似连上（只用于「+疑似」召回）
+        uint32_t pc = cm_cluster_fuzzy_pair_count(c), pairGood = 0;
+        uint64_t *links = malloc(sizeof(uint64_t) * (pc ? pc : 1));
+        for (uint32_t i = 0; i < pc; i++) {
+            uint32_t x, y;
+            cm_cluster_fuzzy_pair(c, i, &x, &y);
+            pairGood += b[x].origin == b[y].origin;
+            uint32_t rx = cm_cluster_find(c, x), ry = cm_cluster_find(c, y);
+            links[i] = rx < ry ? ((uint64_t)rx << 32 | ry) : ((uint64_t)ry << 32 | rx);
+        }
+        qsort(links, pc, sizeof(uint64_t), cmp_u64);
+
+        // 召回：重复条目与来源同簇；「+疑似」再算上两簇之间有疑似对的
+        uint32_t dups = 0, hit = 0, hitFuzzy = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            if (b[i].origin == i) continue;
+            dups++;
+            uint32_t ri = cm_cluster_find(c, i), ro = cm_cluster_find(c, b[i].origin);
+            if (ri == ro) { hit++; hitFuzzy++; continue; }
+            uint64_t key = ri < ro ? ((uint64_t)ri << 32 | ro) : ((uint64_t)ro << 32 | ri);
+            hitFuzzy += bsearch(&key, links, pc, sizeof(uint64_t), cmp_u64) != NULL;
+        }
+        free(links);
+        // 精度：簇内成对来源相同
+        uint32_t *rows = malloc(sizeof(uint32_t) * n), *starts = malloc(sizeof(uint32_t) * (n + 1));
+        uint32_t groups = cm_cluster_groups(c, 2, rows, starts);
+        uint64_t pairs = 0, good = 0;
+        uint32_t largest = 0;
+        for (uint32_t g = 0; g < groups; g++) {
+            if (starts[g + 1] - starts[g] > largest) largest = starts[g + 1] - starts[g];
+            for (uint32_t x = starts[g]; x < starts[g + 1]; x++) {
+                for (uint32_t y = x + 1; y < starts[g + 1]; y++) {
+                    pairs++;
+                    good += b[rows[x]].origin == b[rows[y]].origin;
+                }
+            }
+        }
+
+        printf("%8u %9.1f %9.1f %8.0f %10llu %8u %7.1f%% %8.1f%% %8u %7.1f%% %8.1f%% %8u\n",
+               n, loadMs, runMs, runMs * 1e6 / n, (unsigned long long)st.comparisons, st.fuzzyPairs,
+               dups ? 100.0 * hit / dups : 100.0, pairs ? 100.0 * good / pairs : 100.0, largest,
+               dups ? 100.0 * hitFuzzy / dups : 100.0, pc ? 100.0 * pairGood / pc : 100.0, st.bigBlocks);
+        free(rows); free(starts); free(b);
+        cm_cluster_destroy(c);
+    }
+
+    if (!edOk || !bruteOk || !exactOk) {
+        fprintf(stderr, "contact cluster check failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,356 @@
+// 联系人键归一化：查表内核 vs 逐次分配的朴素实现，逐个比对 + 吞吐（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_contact_key.c ../Cleaner8-Xu2/manager/CMContactKey.c -o bench_contact_key
+//   ./bench_contact_key            # 200k 条
+//   ./bench_contact_key 1000000
+//
+// 表从 libc 建（C.UTF-8 下的 towlower / iswalpha / iswdigit），相当于 App 里从 NSCharacterSet 建表。
+// 参照实现照原 ObjC 的写法：每次 malloc 一份小写副本，再 malloc 一份过滤结果；电话逐位追加再截最后 11 位。
+//   核对 1：姓名 / 邮箱 / 电话（数字串与 64 位打包键）与参照逐个相同。
+//   核对 2：内置小写表（不传位图时）在它声称覆盖的区段与 towlower 一致（U+0130 除外，小写后变长）。
+//   核对 3：CMKeySet 相同串同 id、不同串不同 id；强制全部同哈希时也不合并。
+
+#include "CMContactKey.h"
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wctype.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static inline uint32_t rnd(uint32_t n) { return (uint32_t)(rng64() % n); }
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// MARK: - 参照实现
+
+static uint8_t gKeep[8192];
+
+static int ref_keep(uint32_t c) { return c < 0x10000 && ((gKeep[c >> 3] >> (c & 7)) & 1); }
+
+static uint16_t ref_lower(uint16_t c) {
+    if (c >= 0xD800 && c <= 0xDFFF) return c;
+    wint_t l = towlower(c);
+    return l < 0x10000 ? (uint16_t)l : c;
+}
+
+static uint16_t *ref_name(const uint16_t *in, uint32_t len, uint32_t *outLen) {
+    uint16_t *low = malloc(sizeof(uint16_t) * (len + 1));
+    for (uint32_t i = 0; i < len; i++) low[i] = ref_lower(in[i]);
+    uint16_t *out = malloc(sizeof(uint16_t) * (len + 1));
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t c = low[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < len && low[i + 1] >= 0xDC00 && low[i + 1] <= 0xDFFF) {
+            uint32_t cp = 0x10000 + (((uint32_t)c - 0xD800) << 10) + ((uint32_t)low[i + 1] - 0xDC00);
+            if ((cp >> 16) == 2 || (cp >> 16) == 3) { out[n++] = c; out[n++] = low[i + 1]; }
+            i++;
+        } else if (ref_keep(c)) {
+            out[n++] = c;
+        }
+    }
+    free(low);
+    *outLen = n;
+    return out;
+}
+
+static const uint16_t kSpaces[] = {
+    0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x20, 0x85, 0xA0, 0x1680, 0x2000, 0x2001, 0x2002, 0x2003, 0x2004,
+    0x2005, 0x2006, 0x2007, 0x2008, 0x2009, 0x200A, 0x2028, 0x2029, 0x202F, 0x205F, 0x3000,
+};
+
+static int ref_space(uint16_t c) {
+    for (size_t i = 0; i < sizeof(kSpaces) / sizeof(kSpaces[0]); i++) if (kSpaces[i] == c) return 1;
+    return 0;
+}
+
+static uint16_t *ref_email(const uint16_t *in, uint32_t len, uint32_t *outLen) {
+    uint32_t a = 0, b = len;
+    while (a < b && ref_space(in[a])) a++;
+    while (b > a && ref_space(in[b - 1])) b--;
+    uint16_t *trim = malloc(sizeof(uint16_t) * (b - a + 1));
+    memcpy(trim, in + a, sizeof(uint16_t) * (b - a));
+    uint16_t *out = malloc(sizeof(uint16_t) * (b - a + 1));
+    for (uint32_t i = 0; i < b - a; i++) out[i] = ref_lower(trim[i]);
+    free(trim);
+    *outLen = b - a;
+    return out;
+}
+
+static char *ref_phone(const uint16_t *in, uint32_t len) {
+    char *digits = malloc(1);
+    size_t n = 0;
+    digits[0] = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        if (in[i] < '0' || in[i] > '9') continue;
+        digits = realloc(digits, n + 2);
+        digits[n++] = (char)in[i];
+        digits[n] = 0;
+    }
+    if (n > 11) {
+        char *tail = strdup(digits + n - 11);
+        free(digits);
+        return tail;
+    }
+    return digits;
+}
+
+// MARK: - 合成输入
+
+static uint16_t pick_char(void) {
+    switch (rnd(12)) {
+        case 0: case 1: case 2: return (uint16_t)('a' + rnd(26));
+        case 3: return (uint16_t)('A' + rnd(26));
+        case 4: return (uint16_t)(0xC0 + rnd(0x40));               // Latin-1
+        case 5: return (uint16_t)(0x100 + rnd(0x80));              // 拉丁扩展 A
+        case 6: return (uint16_t)(0x386 + rnd(0x50));              // 希腊
+        case 7: return (uint16_t)(0x400 + rnd(0x60));              // 西里尔
+        case 8: return (uint16_t)(0x4E00 + rnd(0x5200));           // CJK
+        case 9: return (uint16_t)(rnd(2) ? 0xFF21 + rnd(26) : 0xFF10 + rnd(10)); // 全角
+        case 10: return (uint16_t)('0' + rnd(10));
+        default: {
+            static const uint16_t p[] = { ' ', '.', '-', '\'', ',', 0xA0, 0x3000, 0x2019, '(', ')' };
+            return p[rnd(sizeof(p) / sizeof(p[0]))];
+        }
+    }
+}
+
+static uint32_t make_name(uint16_t *out, uint32_t cap) {
+    uint32_t n = 2 + rnd(20);
+    uint32_t k = 0;
+    while (k < n && k + 2 <= cap) {
+        if (rnd(40) == 0) {                                        // emoji / CJK 扩展 B
+            uint32_t cp = rnd(2) ? 0x1F600 + rnd(0x40) : 0x20000 + rnd(0xA6D6);
+            cp -= 0x10000;
+            out[k++] = (uint16_t)(0xD800 + (cp >> 10));
+            out[k++] = (uint16_t)(0xDC00 + (cp & 0x3FF));
+        } else {
+            out[k++] = pick_char();
+        }
+    }
+    return k;
+}
+
+static uint32_t make_phone(uint16_t *out) {
+    static const char *fmt[] = { "+86 1## #### ####", "(###) ###-####", "1##########", "0## ########", "+44 #### ######", "##-##" };
+    const char *f = fmt[rnd(sizeof(fmt) / sizeof(fmt[0]))];
+    uint32_t n = 0;
+    for (; *f; f++) out[n++] = (uint16_t)(*f == '#' ? (uint32_t)'0' + rnd(10) : (uint32_t)*f);
+    return n;
+}
+
+static uint32_t make_email(uint16_t *out) {
+    uint32_t n = 0;
+    if (rnd(4) == 0) out[n++] = rnd(2) ? ' ' : 0xA0;
+    uint32_t user = 3 + rnd(10);
+    for (uint32_t i = 0; i < user; i++) out[n++] = (uint16_t)(rnd(3) ? 'a' + rnd(26) : 'A' + rnd(26));
+    const char *dom = rnd(2) ? "@Example.COM" : "@mail.cn";
+    while (*dom) out[n++] = (uint16_t)*dom++;
+    if (rnd(4) == 0) out[n++] = rnd(2) ? '\n' : 0x3000;
+    return n;
+}
+
+// MARK: - 核对
+
+static CMKeyTables *tables_from_libc(void) {
+    memset(gKeep, 0, sizeof(gKeep));
+    for (uint32_t c = 0; c < 0x10000; c++) {
+        if (c >= 0xD800 && c <= 0xDFFF) continue;
+        if (iswalpha((wint_t)c) || iswdigit((wint_t)c)) gKeep[c >> 3] |= (uint8_t)(1u << (c & 7));
+    }
+    CMKeyTables *t = cm_keytab_create(gKeep);
+    for (uint32_t c = 0; c < 0x10000; c++) {
+        uint16_t l = ref_lower((uint16_t)c);
+        if (l != c) cm_keytab_set_lower(t, (uint16_t)c, l);
+    }
+    return t;
+}
+
+static int check_builtin_lower(void) {
+    CMKeyTables *t = cm_keytab_create(NULL);
+    static const uint32_t ranges[][2] = { { 0x0000, 0x017F }, { 0x0386, 0x03AB }, { 0x0400, 0x042F }, { 0xFF21, 0xFF3A } };
+    int bad = 0;
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        for (uint32_t c = ranges[r][0]; c <= ranges[r][1]; c++) {
+            if (c == 0x130 || (c >= 0xD800 && c <= 0xDFFF)) continue;
+            uint16_t in = (uint16_t)c, out;
+            if (c == 0x20 || (c >= 0x09 && c <= 0x0D) || c == 0x85 || c == 0xA0) continue; // 邮箱会裁掉
+            cm_key_email(t, &in, 1, &out);
+            if (out != ref_lower(in)) {
+                if (bad < 5) fprintf(stderr, "builtin lower U+%04X -> U+%04X, towlower U+%04X\n", c, out, ref_lower(in));
+                bad++;
+            }
+        }
+    }
+    cm_keytab_destroy(t);
+    printf("builtin lowercase vs towlower: %s (%d mismatches)\n", bad ? "DIFFERENT" : "identical", bad);
+    return bad == 0;
+}
+
+static int check_keys(const CMKeyTables *t, uint32_t n) {
+    uint16_t in[64], out[64];
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t len = make_name(in, 64);
+        uint32_t rl, kl = cm_key_name(t, in, len, out);
+        uint16_t *r = ref_name(in, len, &rl);
+        if (rl != kl || memcmp(r, out, sizeof(uint16_t) * kl) != 0) bad++;
+        free(r);
+
+        len = make_email(in);
+        kl = cm_key_email(t, in, len, out);
+        r = ref_email(in, len, &rl);
+        if (rl != kl || memcmp(r, out, sizeof(uint16_t) * kl) != 0) bad++;
+        free(r);
+
+        len = rnd(8) ? make_phone(in) : make_name(in, 64);
+        char d[11];
+        uint32_t dl = cm_key_phone_digits(in, len, d);
+        char *rp = ref_phone(in, len);
+        uint64_t packed = rp[0] ? (((uint64_t)strlen(rp) << 40) | strtoull(rp, NULL, 10)) : 0;
+        if (dl != strlen(rp) || memcmp(d, rp, dl) != 0 || cm_key_phone(in, len) != packed) bad++;
+        free(rp);
+    }
+    printf("name / email / phone keys vs reference (%u each): %s (%u mismatches)\n",
+           n, bad ? "DIFFERENT" : "identical", bad);
+    return bad == 0;
+}
+
+static int cmp_u16(const uint16_t *a, uint32_t al, const uint16_t *b, uint32_t bl) {
+    if (al != bl) return al < bl ? -1 : 1;
+    return memcmp(a, b, sizeof(uint16_t) * al);
+}
+
+static int check_keyset(void) {
+    enum { N = 20000 };
+    static uint16_t strs[N][6];
+    static uint32_t lens[N], ids[N];
+    int ok = 1;
+
+    // 小字母表造大量重复
+    CMKeySet *s = cm_keyset_create();
+    for (uint32_t i = 0; i < N; i++) {
+        lens[i] = 1 + rnd(4);
+        for (uint32_t k = 0; k < lens[i]; k++) strs[i][k] = (uint16_t)('a' + rnd(6));
+        ids[i] = cm_keyset_intern(s, strs[i], lens[i]);
+    }
+    // 每个 id 的第一个串作代表：同 id 必同串，不同 id 必不同串
+    uint32_t cnt = cm_keyset_count(s);
+    uint32_t *rep = malloc(sizeof(uint32_t) * cnt);
+    for (uint32_t i = 0; i < cnt; i++) rep[i] = UINT32_MAX;
+    for (uint32_t i = 0; i < N; i++) {
+        if (ids[i] >= cnt) { ok = 0; break; }
+        if (rep[ids[i]] == UINT32_MAX) rep[ids[i]] = i;
+        else if (cmp_u16(strs[i], lens[i], strs[rep[ids[i]]], lens[rep[ids[i]]]) != 0) ok = 0;
+    }
+    for (uint32_t a = 0; a < cnt && ok; a++)
+        for (uint32_t b = a + 1; b < cnt; b++)
+            if (cmp_u16(strs[rep[a]], lens[rep[a]], strs[rep[b]], lens[rep[b]]) == 0) { ok = 0; break; }
+    free(rep);
+    cm_keyset_destroy(s);
+
+    // 全部同一个哈希：必须靠比串区分
+    s = cm_keyset_create();
+    uint32_t forced = 0;
+    for (uint32_t i = 0; i < 2000; i++) {
+        uint16_t k[2] = { (uint16_t)(i & 0xFFFF), (uint16_t)(i >> 16) };
+        if (cm_keyset_intern_hashed(s, 42, k, 2) != i) ok = 0;
+    }
+    for (uint32_t i = 0; i < 2000; i += 7) {
+        uint16_t k[2] = { (uint16_t)(i & 0xFFFF), (uint16_t)(i >> 16) };
+        if (cm_keyset_intern_hashed(s, 42, k, 2) != i) ok = 0;
+    }
+    forced = cm_keyset_collisions(s);
+    if (cm_keyset_count(s) != 2000 || forced == 0) ok = 0;
+    cm_keyset_destroy(s);
+
+    printf("key set ids (%u strings, %u distinct) + forced hash collisions (%u probes): %s\n",
+           N, cnt, forced, ok ? "consistent" : "BROKEN");
+    return ok;
+}
+
+// MARK: - 吞吐
+
+typedef struct {
+    uint16_t buf[64];
+    uint32_t len;
+} Field;
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 200000;
+    if (!setlocale(LC_CTYPE, "C.UTF-8") && !setlocale(LC_CTYPE, "en_US.UTF-8")) {
+        fprintf(stderr, "no UTF-8 locale, towlower only covers ASCII\n");
+    }
+
+    CMKeyTables *t = tables_from_libc();
+    int ok = check_builtin_lower();
+    ok &= check_keys(t, 100000);
+    ok &= check_keyset();
+
+    Field *names = malloc(sizeof(Field) * n), *phones = malloc(sizeof(Field) * n), *emails = malloc(sizeof(Field) * n);
+    for (uint32_t i = 0; i < n; i++) {
+        names[i].len = make_name(names[i].buf, 64);
+        phones[i].len = make_phone(phones[i].buf);
+        emails[i].len = make_email(emails[i].buf);
+    }
+
+    volatile uint64_t sink = 0;
+    uint16_t out[64];
+    char d[11];
+
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t rl;
+        uint16_t *r = ref_name(names[i].buf, names[i].len, &rl); sink += rl; free(r);
+        r = ref_email(emails[i].buf, emails[i].len, &rl); sink += rl; free(r);
+        char *p = ref_phone(phones[i].buf, phones[i].len); sink += p[0]; free(p);
+    }
+    double refMs = now_ms() - t0;
+
+    t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        sink += cm_key_name(t, names[i].buf, names[i].len, out);
+        sink += cm_key_email(t, emails[i].buf, emails[i].len, out);
+        sink += cm_key_phone_digits(phones[i].buf, phones[i].len, d);
+    }
+    double kernMs = now_ms() - t0;
+
+    // 归一化 + 入表（聚类时的用法）
+    CMKeySet *ns = cm_keyset_create(), *es = cm_keyset_create();
+    t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t l = cm_key_name(t, names[i].buf, names[i].len, out);
+        sink += cm_keyset_intern(ns, out, l);
+        l = cm_key_email(t, emails[i].buf, emails[i].len, out);
+        sink += cm_keyset_intern(es, out, l);
+        sink += cm_key_phone(phones[i].buf, phones[i].len);
+    }
+    double internMs = now_ms() - t0;
+
+    printf("\n%9s %12s %12s %14s %9s\n", "contacts", "reference ms", "kernel ms", "kernel+set ms", "speedup");
+    printf("%9u %12.1f %12.1f %14.1f %8.1fx\n", n, refMs, kernMs, internMs, refMs / (kernMs > 0 ? kernMs : 1e-3));
+    printf("per contact (name + email + phone): reference %.0f ns, kernel %.0f ns; key set %u names / %u emails, %u + %u collisions\n",
+           refMs * 1e6 / n, kernMs * 1e6 / n, cm_keyset_count(ns), cm_keyset_count(es),
+           cm_keyset_collisions(ns), cm_keyset_collisions(es));
+
+    cm_keyset_destroy(ns);
+    cm_keyset_destroy(es);
+    free(names); free(phones); free(emails);
+    cm_keytab_destroy(t);
+    (void)sink;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Vision 特征 L2 距离：标量 vs 向量内核 vs 批量内核，并与 double 参考实现核对（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_feature_arena.c ../Cleaner8-Xu2/manager/ASFeatureArena.c -lm -o bench_feature_arena
+//   ./bench_feature_arena           # 768 维（Revision2）/ 2048 维（Revision1），各 20k 行
+//
+// 模拟 matchAndGroup：每个新 model 与 64 个 pHash 候选比 Vision 距离。
+// 旧路径的主要开销是 NSKeyedUnarchiver 解档 + computeDistance（Linux 上无法复现），这里只测距离本身。
+
+#include "ASFeatureArena.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROWS 20000
+#define CANDS 64
+#define QUERIES 20000
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static float scalar_l2(const float *a, const float *b, uint32_t dim) {
+    float s = 0;
+    for (uint32_t i = 0; i < dim; i++) { float d = a[i] - b[i]; s += d * d; }
+    return sqrtf(s);
+}
+
+static int run(uint32_t dim) {
+    ASFeatureArena *a = as_feature_arena_create(dim);
+    float *row = malloc(sizeof(float) * dim);
+    for (uint32_t r = 0; r < ROWS; r++) {
+        // 近似单位向量（Revision2 特征是归一化的）
+        for (uint32_t i = 0; i < dim; i++) row[i] = ((float)(rng64() % 20001) - 10000.f) / (10000.f * sqrtf((float)dim / 3.f));
+        if (as_feature_arena_add(a, row) != r) { fprintf(stderr, "add failed\n"); return 1; }
+    }
+
+    uint32_t *q = malloc(sizeof(uint32_t) * QUERIES);
+    uint32_t *cand = malloc(sizeof(uint32_t) * (size_t)QUERIES * CANDS);
+    for (uint32_t k = 0; k < QUERIES; k++) {
+        q[k] = (uint32_t)(rng64() % ROWS);
+        for (uint32_t c = 0; c < CANDS; c++) cand[(size_t)k * CANDS + c] = (uint32_t)(rng64() % ROWS);
+    }
+
+    const float *rows[CANDS];
+    float out[CANDS];
+    volatile float sink = 0;
+
+    double t0 = now_ms();
+    for (uint32_t k = 0; k < QUERIES; k++) {
+        const float *qa = as_feature_arena_row(a, q[k]);
+        for (uint32_t c = 0; c < CANDS; c++) sink += scalar_l2(qa, as_feature_arena_row(a, cand[(size_t)k * CANDS + c]), dim);
+    }
+    double scalarMs = now_ms() - t0;
+
+    t0 = now_ms();
+    for (uint32_t k = 0; k < QUERIES; k++) {
+        const float *qa = as_feature_arena_row(a, q[k]);
+        for (uint32_t c = 0; c < CANDS; c++) sink += as_feature_l2(qa, as_feature_arena_row(a, cand[(size_t)k * CANDS + c]), dim);
+    }
+    double vecMs = now_ms() - t0;
+
+    t0 = now_ms();
+    for (uint32_t k = 0; k < QUERIES; k++) {
+        for (uint32_t c = 0; c < CANDS; c++) rows[c] = as_feature_arena_row(a, cand[(size_t)k * CANDS + c]);
+        as_feature_l2_batch(as_feature_arena_row(a, q[k]), rows, CANDS, dim, out);
+        sink += out[0];
+    }
+    double batchMs = now_ms() - t0;
+
+    // 核对：全部内核与 double 参考的相对误差
+    double maxRel = 0;
+    for (uint32_t k = 0; k < 2000; k++) {
+        const float *qa = as_feature_arena_row(a, q[k]);
+        for (uint32_t c = 0; c < CANDS; c++) rows[c] = as_feature_arena_row(a, cand[(size_t)k * CANDS + c]);
+        as_feature_l2_batch(qa, rows, CANDS - 3, dim, out); // 奇数个，覆盖尾部
+        for (uint32_t c = 0; c < CANDS - 3; c++) {
+            float ref = as_feature_l2_reference(qa, rows[c], dim);
+            float v = as_feature_l2(qa, rows[c], dim);
+            double rel1 = ref > 0 ? fabs((double)v - ref) / ref : fabs((double)v);
+            double rel2 = ref > 0 ? fabs((double)out[c] - ref) / ref : fabs((double)out[c]);
+            if (rel1 > maxRel) maxRel = rel1;
+            if (rel2 > maxRel) maxRel = rel2;
+        }
+    }
+    (void)sink;
+
+    double pairs = (double)QUERIES * CANDS;
+    printf("%6u %10.0f %10.1f %10.1f %10.1f %8.1fx %10.2e\n",
+           dim, pairs, scalarMs, vecMs, batchMs, scalarMs / batchMs, maxRel);
+
+    free(row);
+    free(q);
+    free(cand);
+    as_feature_arena_destroy(a);
+    if (maxRel > 1e-4) { fprintf(stderr, "kernel mismatch: %.3e\n", maxRel); return 1; }
+    return 0;
+}
+
+int main(void) {
+    printf("%6s %10s %10s %10s %10s %9s %10s\n", "dim", "pairs", "scalarMs", "vecMs", "batchMs", "speedup", "maxRelErr");
+    if (run(768) || run(2048)) return 1;
+    return 0;
+}
@@ -0,0 +1,258 @@
+// 持久化特征库：增量重建时需要重新解码的张数、加载 / 查询耗时 + 半截写入与压缩校验（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_feature_store.c ../Cleaner8-Xu2/manager/ASFeatureStoreFormat.c -o bench_feature_store
+//   ./bench_feature_store           # 100k 资产，每天 300 张
+//   ./bench_feature_store 200000
+//
+// 1. 全量扫描后把全部特征（大小 / pHash / 模糊度，三分之一带 768 维 Vision 特征，十分之一带 208 字节视频指纹）写入库并落盘
+// 2. 冷启动：读文件重建索引
+// 3. 20 个忙碌的天各新增 1 张、编辑 1 张后重建：旧行为整天重新解码，新行为只算未命中的
+// 4. 截掉最后一条记录的一半，确认打开时在完整记录处停下；一半资产被编辑后压缩，核对条目数
+
+#include "ASFeatureStoreFormat.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PER_DAY 300
+#define FEATURE_DIM 768
+#define BUSY_DAYS 20
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    char id[48];
+    uint32_t idLen;
+    int64_t modMs;
+} Asset;
+
+static float gFeature[FEATURE_DIM];
+static uint8_t gVideo[208];
+
+static void make_entry(uint32_t i, ASFeatureEntry *e) {
+    memset(e, 0, sizeof(*e));
+    e->flags = AS_FSTORE_HAS_SIZE | AS_FSTORE_HAS_PHASH | AS_FSTORE_HAS_BLUR;
+    e->fileSize = 1000000 + i;
+    e->sizeParts[AS_FSTORE_PART_PHOTO] = 900000 + i;
+    e->sizeParts[AS_FSTORE_PART_ADJUSTMENT] = 100000;
+    for (int k = 0; k < 4; k++) e->phash[k] = (uint64_t)i * 0x9E3779B97F4A7C15ull + (uint64_t)k;
+    e->blurScore = (float)(i % 1000);
+    if (i % 3 == 0) {
+        e->flags |= AS_FSTORE_HAS_FEATURE;
+        e->feature = gFeature;
+        e->featureCount = FEATURE_DIM;
+    }
+    if (i % 10 == 0) {
+        e->flags |= AS_FSTORE_HAS_VIDEO;
+        e->video = gVideo;
+        e->videoLen = sizeof(gVideo);
+    }
+}
+
+// 把未落盘的字节写到文件（追加或整体重写），再整文件读回作为新的映射
+static uint8_t *flush(ASFStore *s, const char *path, uint8_t *oldMap, size_t *mapLen) {
+    const uint8_t *p;
+    size_t len;
+    int rewrite;
+    as_fstore_pending(s, &p, &len, &rewrite);
+    FILE *f = fopen(path, rewrite ? "wb" : "ab");
+    if (!f || fwrite(p, 1, len, f) != len) { fprintf(stderr, "write failed\n"); exit(1); }
+    fclose(f);
+
+    f = fopen(path, "rb");
+    fseek(f, 0, SEEK_END);
+    size_t n = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *map = malloc(n + 8);
+    if (fread(map, 1, n, f) != n) { fprintf(stderr, "read failed\n"); exit(1); }
+    fclose(f);
+    if (!as_fstore_rebase(s, map, n)) { fprintf(stderr, "rebase failed\n"); exit(1); }
+    free(oldMap);
+    *mapLen = n;
+    return map;
+}
+
+static int run(uint32_t n) {
+    const char *path = "/tmp/as_bench_feature_store.bin";
+    unlink(path);
+
+    Asset *a = calloc(n + BUSY_DAYS, sizeof(Asset));
+    for (uint32_t i = 0; i < n + BUSY_DAYS; i++) {
+        uint64_t x = rng64(), y = rng64();
+        a[i].idLen = (uint32_t)sprintf(a[i].id, "%016" PRIX64 "-%016" PRIX64 "/L0/001", x, y);
+        a[i].modMs = 1600000000000ll + (int64_t)i * 1000;
+    }
+
+    // 1. 全量扫描写入
+    ASFStore *s = as_fstore_create(7);
+    double t0 = now_ms();
+    ASFeatureEntry e;
+    for (uint32_t i = 0; i < n; i++) {
+        make_entry(i, &e);
+        as_fstore_put(s, a[i].id, a[i].idLen, a[i].modMs, &e);
+    }
+    size_t mapLen = 0;
+    uint8_t *map = flush(s, path, NULL, &mapLen);
+    double putMs = now_ms() - t0;
+
+    // 2. 冷启动加载
+    as_fstore_destroy(s);
+    s = as_fstore_create(7);
+    t0 = now_ms();
+    size_t valid = as_fstore_open(s, map, mapLen);
+    double openMs = now_ms() - t0;
+    ASFeatureStoreStats st;
+    as_fstore_stats(s, &st);
+    if (valid != mapLen || st.entries != n) {
+        fprintf(stderr, "open: valid=%zu/%zu entries=%" PRIu64 "\n", valid, mapLen, st.entries);
+        return 1;
+    }
+
+    // 3. 忙碌的天：新增 1 张（新 localId）+ 编辑 1 张（modMs 变化），重建整天
+    uint32_t days = n / PER_DAY;
+    uint64_t oldDecodes = 0, newDecodes = 0;
+    for (uint32_t d = 0; d < BUSY_DAYS && d < days; d++) {
+        uint32_t day = (uint32_t)(rng64() % days);
+        uint32_t from = day * PER_DAY, to = from + PER_DAY;
+        a[from + 7].modMs += 60000;
+        for (uint32_t i = from; i <= to; i++) {
+            Asset *x = (i == to) ? &a[n + d] : &a[i];
+            oldDecodes++;
+            ASFeatureEntry got;
+            if (as_fstore_get(s, x->id, x->idLen, x->modMs, &got)) continue;
+            newDecodes++;
+            make_entry(i, &e);
+            as_fstore_put(s, x->id, x->idLen, x->modMs, &e);
+        }
+    }
+    map = flush(s, path, map, &mapLen);
+    as_fstore_stats(s, &st);
+
+    // 查询耗时（全部命中）
+    as_fstore_reset_counters(s);
+    t0 = now_ms();
+    uint64_t sink = 0;
+    for (int rep = 0; rep < 3; rep++) {
+        for (uint32_t i = 0; i < n; i++) {
+            ASFeatureEntry got;
+            if (as_fstore_get(s, a[i].id, a[i].idLen, a[i].modMs, &got)) sink += got.fileSize;
+        }
+    }
+    double getNs = (now_ms() - t0) * 1e6 / (3.0 * n);
+    ASFeatureStoreStats gs;
+    as_fstore_stats(s, &gs);
+    if (gs.hits != 3ull * n || sink == 0) {
+        fprintf(stderr, "lookup: hits=%" PRIu64 " expected %u\n", gs.hits, 3 * n);
+        return 1;
+    }
+
+    // 4a. 半截尾记录：截掉最后一条的一半，之前的都在
+    {
+        ASFStore *t = as_fstore_create(7);
+        as_fstore_open(t, map, mapLen);
+        ASFeatureEntry x;
+        make_entry(1, &x);
+        as_fstore_put(t, "torn-tail", 9, 1, &x);
+        const uint8_t *p;
+        size_t plen;
+        as_fstore_pending(t, &p, &plen, NULL);
+        uint8_t *torn = malloc(mapLen + plen);
+        memcpy(torn, map, mapLen);
+        memcpy(torn + mapLen, p, plen / 2);
+        size_t v = as_fstore_open(t, torn, mapLen + plen / 2);
+        ASFeatureStoreStats ts;
+        as_fstore_stats(t, &ts);
+        if (v != mapLen || ts.entries != st.entries) {
+            fprintf(stderr, "torn tail: valid=%zu expected %zu\n", v, mapLen);
+            return 1;
+        }
+        as_fstore_destroy(t);
+        free(torn);
+    }
+
+    // 4b. 一半资产被编辑 -> 死字节超过活字节 -> 压缩
+    for (uint32_t i = 0; i < n; i += 2) {
+        a[i].modMs += 1000;
+        make_entry(i, &e);
+        as_fstore_put(s, a[i].id, a[i].idLen, a[i].modMs, &e);
+    }
+    for (uint32_t i = 1; i < n; i += 4) as_fstore_remove(s, a[i].id, a[i].idLen);
+    ASFeatureStoreStats before;
+    as_fstore_stats(s, &before);
+    int compact = as_fstore_should_compact(s, 1 << 20);
+    uint8_t *img;
+    size_t imgLen;
+    if (!compact || !as_fstore_compact(s, &img, &imgLen)) {
+        fprintf(stderr, "compaction not triggered\n");
+        return 1;
+    }
+    as_fstore_open(s, img, imgLen);
+    ASFeatureStoreStats after;
+    as_fstore_stats(s, &after);
+    for (uint32_t i = 0; i < n; i++) {
+        ASFeatureEntry got;
+        int want = (i % 4) != 1;
+        if (as_fstore_get(s, a[i].id, a[i].idLen, a[i].modMs, &got) != want) {
+            fprintf(stderr, "after compaction: asset %u lookup mismatch\n", i);
+            return 1;
+        }
+        if (want && (i % 3 == 0) && (got.featureCount != FEATURE_DIM || got.feature[5] != gFeature[5])) {
+            fprintf(stderr, "after compaction: asset %u feature mismatch\n", i);
+            return 1;
+        }
+        if (want && got.sizeParts[AS_FSTORE_PART_PHOTO] != 900000 + i) {
+            fprintf(stderr, "after compaction: asset %u size breakdown mismatch\n", i);
+            return 1;
+        }
+        if (want && (i % 10 == 0) && (got.videoLen != sizeof(gVideo) || memcmp(got.video, gVideo, sizeof(gVideo)) != 0)) {
+            fprintf(stderr, "after compaction: asset %u video fingerprint mismatch\n", i);
+            return 1;
+        }
+    }
+    if (after.entries != before.entries || after.deadBytes != 0) {
+        fprintf(stderr, "compaction: entries %" PRIu64 " -> %" PRIu64 "\n", before.entries, after.entries);
+        return 1;
+    }
+
+    printf("%8u %9.1f %8.0f %8.1f %7.0f %10" PRIu64 " %10" PRIu64 " %6" PRIu64 " %9.1f %9.1f\n",
+           n, mapLen / 1048576.0, putMs, openMs, getNs,
+           oldDecodes, newDecodes, st.stale,
+           (before.liveBytes + before.deadBytes) / 1048576.0, imgLen / 1048576.0);
+
+    free(img);
+    free(map);
+    free(a);
+    as_fstore_destroy(s);
+    unlink(path);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 0; i < FEATURE_DIM; i++) gFeature[i] = (float)(rng64() % 1000) / 1000.0f;
+    for (size_t i = 0; i < sizeof(gVideo); i++) gVideo[i] = (uint8_t)rng64();
+
+    printf("%8s %9s %8s %8s %7s %10s %10s %6s %9s %9s\n",
+           "assets", "fileMB", "putMs", "openMs", "getNs", "oldDecode", "newDecode", "stale", "preMB", "compactMB");
+    if (argc > 1) return run((uint32_t)strtoul(argv[1], NULL, 10));
+
+    uint32_t sizes[2] = { 20000, 100000 };
+    for (int i = 0; i < 2; i++) if (run(sizes[i])) return 1;
+    return 0;
+}
@@ -0,0 +1,193 @@
+// 分组：旧的「遍历所有组所有成员比 localId」 vs 并查集；并与暴力重算核对汇总（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_group_forest.c ../Cleaner8-Xu2/manager/ASGroupForest.c -o bench_group_forest
+//   ./bench_group_forest            # 5k / 20k / 50k
+//   ./bench_group_forest 100000
+//
+// 模拟扫描：约 30% 的 asset 命中一个已扫描的 asset（偏向最近的），其中 1/20 同时命中另一个组（需要合并）。
+//   linear：旧行为，命中后遍历全部组全部成员做字符串比较，只加入第一个组；每张之后重算可清理汇总
+//   forest：union + 增量汇总
+// 最后物化 forest 的分组，逐组暴力重算字节 / 张数，与增量汇总比对。
+// 另有 matchAndGroup 的配对规则回归：A~B、B~C 相似，A≡C 重复，A、C 须进同一个重复组。
+
+#include "ASGroupForest.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    char id[48];
+    uint64_t bytes;
+    uint32_t hit, hit2; // UINT32_MAX = 无
+} Asset;
+
+typedef struct {
+    uint32_t *members;
+    uint32_t count, cap;
+} Group;
+
+static void group_push(Group *g, uint32_t x) {
+    if (g->count == g->cap) {
+        g->cap = g->cap ? g->cap * 2 : 4;
+        g->members = realloc(g->members, g->cap * sizeof(uint32_t));
+    }
+    g->members[g->count++] = x;
+}
+
+static int run(uint32_t n) {
+    Asset *a = calloc(n, sizeof(Asset));
+    for (uint32_t i = 0; i < n; i++) {
+        sprintf(a[i].id, "%016" PRIX64 "-%016" PRIX64 "/L0/001", rng64(), rng64());
+        a[i].bytes = 1000000 + rng64() % 4000000;
+        a[i].hit = a[i].hit2 = UINT32_MAX;
+        if (i > 0 && rng64() % 10 < 3) {
+            uint32_t back = 1 + (uint32_t)(rng64() % (i < 50 ? i : 50));
+            a[i].hit = i - back;
+            if (rng64() % 20 == 0) a[i].hit2 = (uint32_t)(rng64() % i);
+        }
+    }
+
+    // 旧：线性查找
+    double t0 = now_ms();
+    Group *groups = NULL;
+    uint32_t groupCount = 0, groupCap = 0;
+    volatile uint64_t linBytes = 0, linCount = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (a[i].hit != UINT32_MAX) {
+            const char *memberId = a[a[i].hit].id;
+            int found = 0;
+            for (uint32_t g = 0; g < groupCount && !found; g++) {
+                for (uint32_t k = 0; k < groups[g].count; k++) {
+                    if (strcmp(a[groups[g].members[k]].id, memberId) == 0) {
+                        group_push(&groups[g], i);
+                        found = 1;
+                        break;
+                    }
+                }
+            }
+            if (!found) {
+                if (groupCount == groupCap) {
+                    groupCap = groupCap ? groupCap * 2 : 64;
+                    groups = realloc(groups, groupCap * sizeof(Group));
+                }
+                memset(&groups[groupCount], 0, sizeof(Group));
+                group_push(&groups[groupCount], a[i].hit);
+                group_push(&groups[groupCount], i);
+                groupCount++;
+            }
+        }
+        // recomputeCleanableStatsFast：每张之后全量重算
+        linBytes = linCount = 0;
+        for (uint32_t g = 0; g < groupCount; g++) {
+            for (uint32_t k = 1; k < groups[g].count; k++) { linBytes += a[groups[g].members[k]].bytes; linCount++; }
+        }
+    }
+    double linMs = now_ms() - t0;
+
+    // 新：并查集（同时按 hit2 合并两个组）
+    t0 = now_ms();
+    ASGroupForest *f = as_forest_create();
+    uint32_t merges = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        as_forest_add(f, a[i].bytes, 0);
+        if (a[i].hit != UINT32_MAX) as_forest_union(f, a[i].hit, i);
+        if (a[i].hit2 != UINT32_MAX) {
+            int wasGrouped = as_forest_set_size(f, a[i].hit2) >= 2 && as_forest_set_size(f, i) >= 2;
+            if (as_forest_union(f, a[i].hit2, i) && wasGrouped) merges++;
+        }
+        volatile uint64_t sink = as_forest_cleanable_bytes(f) + as_forest_cleanable_count(f);
+        (void)sink;
+    }
+    double forestMs = now_ms() - t0;
+
+    // 物化 + 暴力核对
+    uint32_t fg = as_forest_group_count(f);
+    uint32_t *roots = malloc(sizeof(uint32_t) * (fg + 1));
+    uint32_t *members = malloc(sizeof(uint32_t) * n);
+    t0 = now_ms();
+    uint32_t got = as_forest_groups(f, roots);
+    uint64_t bruteBytes = 0, bruteCount = 0;
+    for (uint32_t g = 0; g < got; g++) {
+        uint32_t k = as_forest_members(f, roots[g], members);
+        for (uint32_t j = 1; j < k; j++) {
+            if (members[j] <= members[j - 1]) { fprintf(stderr, "members not ascending\n"); return 1; }
+            bruteBytes += a[members[j]].bytes;
+            bruteCount++;
+        }
+    }
+    double materialiseMs = now_ms() - t0;
+    if (got != fg || bruteBytes != as_forest_cleanable_bytes(f) || bruteCount != as_forest_cleanable_count(f)) {
+        fprintf(stderr, "aggregate mismatch: groups %u/%u bytes %" PRIu64 "/%" PRIu64 " count %" PRIu64 "/%" PRIu64 "\n",
+                got, fg, bruteBytes, as_forest_cleanable_bytes(f), bruteCount, as_forest_cleanable_count(f));
+        return 1;
+    }
+
+    printf("%8u %8u %8u %7u %10.1f %10.2f %10.2f %8.0fx\n",
+           n, groupCount, fg, merges, linMs, forestMs, materialiseMs, linMs / (forestMs > 0.01 ? forestMs : 0.01));
+
+    for (uint32_t g = 0; g < groupCount; g++) free(groups[g].members);
+    free(groups);
+    free(roots);
+    free(members);
+    as_forest_destroy(f);
+    free(a);
+    return 0;
+}
+
+// matchAndGroup 的循环：按扫描顺序逐张加入，候选按池里顺序；sim / dup 为两两关系（dup 蕴含 sim）
+static int check_pair_need(void) {
+    enum { A, B, C, N };
+    const int sim[N][N] = { [A][B] = 1, [B][A] = 1, [B][C] = 1, [C][B] = 1, [A][C] = 1, [C][A] = 1 };
+    const int dup[N][N] = { [A][C] = 1, [C][A] = 1 };
+    const uint32_t cands[N][N] = { [B] = { A }, [C] = { B, A } };   // C 先命中 B，经 B 与 A 同相似组
+    const uint32_t candCount[N] = { 0, 1, 2 };
+
+    ASGroupForest *fs = as_forest_create(), *fd = as_forest_create();
+    for (uint32_t x = 0; x < N; x++) {
+        as_forest_add(fs, 1, 0);
+        as_forest_add(fd, 1, 0);
+        for (uint32_t k = 0; k < candCount[x]; k++) {
+            uint32_t c = cands[x][k];
+            ASPairNeed need = as_forest_pair_need(fs, fd, c, x);
+            if (need == AS_PAIR_SKIP || !sim[x][c]) continue;
+            if (need == AS_PAIR_DUPLICATE_ONLY && !dup[x][c]) continue;
+            as_forest_union(fs, c, x);
+            if (dup[x][c]) as_forest_union(fd, c, x);
+        }
+    }
+    int ok = as_forest_find(fd, A) == as_forest_find(fd, C) && as_forest_find(fd, B) != as_forest_find(fd, A) &&
+             as_forest_set_size(fs, A) == 3;
+    if (!ok) fprintf(stderr, "pair need: A and C not in one duplicate group\n");
+    as_forest_destroy(fs);
+    as_forest_destroy(fd);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (check_pair_need()) return 1;
+    printf("%8s %8s %8s %7s %10s %10s %10s %9s\n",
+           "assets", "linGrp", "forGrp", "merges", "linearMs", "forestMs", "materMs", "speedup");
+    if (argc > 1) return run((uint32_t)strtoul(argv[1], NULL, 10));
+
+    uint32_t sizes[3] = { 5000, 20000, 50000 };
+    for (int i = 0; i < 3; i++) if (run(sizes[i])) return 1;
+    return 0;
+}
@@ -0,0 +1,324 @@
+// 分组窗口 benchmark：按天分桶 vs 跨天（Global）分组（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_grouping_window.c ../Cleaner8-Xu2/manager/ASPHashIndex.c -o bench_grouping_window -lpthread
+//   ./bench_grouping_window            # 20k / 100k / 500k
+//   ./bench_grouping_window 50000      # 指定规模
+//
+// 模拟相册：按时间倒序扫描，每天若干张；约 30% 是天内连拍（翻转 0..40 bit），
+// 约 3% 是跨午夜连拍，约 5% 是若干天前照片的再保存/截图（翻转 0..20 bit，落在重复阈值内）。
+//
+// 对比三种策略（与 ASPhotoScanManager 的实现一致）：
+//   day    : 每天一个池，r=119，换天清空（现状）
+//   global : 当天池带入相邻一天午夜附近的照片，r=119；另有按内存预算滚动淘汰的跨天池，r=30
+//   naive  : 单个全库池，r=119（仅小规模，用来说明为什么不这么做）
+// 输出：耗时、popcount 比较次数、送去 Vision 的候选数、跨天重复召回率。
+
+#include "ASPHashIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define R_SIMILAR   119 // kPolicySimilar.phashThreshold
+#define R_DUPLICATE 30  // kPolicyDuplicate.phashThreshold
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    uint64_t *hash;   // n * 4
+    uint32_t *day;    // n，扫描顺序递增（越大越旧）
+    int32_t  *origin; // n，跨天再保存的源照片，-1 表示无
+    uint8_t  *edge;   // n，拍摄时间在当天午夜后的带入窗口内
+    size_t n;
+    size_t crossDay;  // origin >= 0 的条数
+} Library;
+
+static void flip_bits(uint64_t *h, int flips) {
+    for (int f = 0; f < flips; f++) {
+        int bit = (int)(rng64() % 256);
+        h[bit >> 6] ^= 1ull << (bit & 63);
+    }
+}
+
+static void make_library(Library *lib, size_t n) {
+    lib->hash = (uint64_t *)malloc(n * 4 * sizeof(uint64_t));
+    lib->day = (uint32_t *)malloc(n * sizeof(uint32_t));
+    lib->origin = (int32_t *)malloc(n * sizeof(int32_t));
+    lib->edge = (uint8_t *)malloc(n);
+    lib->n = n;
+    lib->crossDay = 0;
+
+    uint32_t day = 0;
+    size_t left = 0;
+    size_t i = 0;
+    while (i < n) {
+        if (left == 0) { day++; left = 5 + rng64() % 60; }
+
+        uint64_t *h = lib->hash + i * 4;
+        lib->day[i] = day;
+        lib->origin[i] = -1;
+        lib->edge[i] = (rng64() % 100) < 8;
+
+        uint64_t p = rng64() % 100;
+        if (p < 5 && i > 2000) {
+            // 再保存：源照片来自至少一天前
+            size_t src = i - 500 - rng64() % (i - 500);
+            if (lib->day[src] + 1 < day) {
+                memcpy(h, lib->hash + src * 4, 4 * sizeof(uint64_t));
+                flip_bits(h, (int)(rng64() % 21));
+                lib->origin[i] = (int32_t)src;
+                lib->crossDay++;
+                i++; left--;
+                continue;
+            }
+        }
+
+        h[0] = rng64(); h[1] = rng64(); h[2] = rng64(); h[3] = rng64();
+        i++; left--;
+
+        if (p < 35) {
+            size_t burst = 2 + rng64() % 8;
+            int crossMidnight = (p < 8);
+            for (size_t b = 0; b < burst && i < n; b++, i++) {
+                if (crossMidnight && b == burst / 2) { day++; left = 5 + rng64() % 60; }
+                uint64_t *c = lib->hash + i * 4;
+                memcpy(c, h, 4 * sizeof(uint64_t));
+                flip_bits(c, (int)(rng64() % 41));
+                lib->day[i] = day;
+                lib->origin[i] = -1;
+                lib->edge[i] = crossMidnight && b < burst / 2;
+                if (left) left--;
+            }
+        }
+    }
+}
+
+static void free_library(Library *lib) {
+    free(lib->hash);
+    free(lib->day);
+    free(lib->origin);
+    free(lib->edge);
+}
+
+typedef struct {
+    double ms;
+    size_t examined;
+    size_t candidates;
+    size_t recalled;
+    size_t peakBytes;
+} Result;
+
+// slot -> 照片下标（每个池各一份）
+typedef struct {
+    ASPHashIndex *idx;
+    uint32_t *photo;
+    size_t cap;
+} Pool;
+
+// 与 ASPHashPool 一致：按池子的查询半径建索引（r=119 只做线性扫描）
+static void pool_init(Pool *p, size_t cap, uint32_t radius) {
+    p->idx = as_phash_index_create_for_radius(radius);
+    p->photo = (uint32_t *)malloc(cap * sizeof(uint32_t));
+    p->cap = cap;
+}
+
+static void pool_add(Pool *p, const Library *lib, uint32_t i) {
+    uint32_t slot = as_phash_index_add(p->idx, lib->hash + (size_t)i * 4);
+    if (slot != UINT32_MAX && slot < p->cap) p->photo[slot] = i;
+}
+
+static void pool_free(Pool *p) {
+    as_phash_index_destroy(p->idx);
+    free(p->photo);
+}
+
+static int hits_contain(const Pool *p, const ASPHashHits *hits, int32_t photo) {
+    for (size_t k = 0; k < hits->count; k++) {
+        if ((int32_t)p->photo[hits->slots[k]] == photo) return 1;
+    }
+    return 0;
+}
+
+static Result run_day(const Library *lib) {
+    Result r = {0};
+    Pool pool;
+    pool_init(&pool, lib->n, R_SIMILAR);
+    ASPHashHits hits = {0};
+    uint32_t cur = UINT32_MAX;
+
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < lib->n; i++) {
+        if (lib->day[i] != cur) { cur = lib->day[i]; as_phash_index_clear(pool.idx); }
+        size_t ex = 0;
+        as_phash_index_query(pool.idx, lib->hash + (size_t)i * 4, R_SIMILAR, &hits, &ex);
+        r.examined += ex;
+        r.candidates += hits.count;
+        if (lib->origin[i] >= 0 && hits_contain(&pool, &hits, lib->origin[i])) r.recalled++;
+        pool_add(&pool, lib, i);
+        size_t bytes = as_phash_index_memory_bytes(pool.idx);
+        if (bytes > r.peakBytes) r.peakBytes = bytes;
+    }
+    r.ms = now_ms() - t0;
+
+    as_phash_hits_free(&hits);
+    pool_free(&pool);
+    return r;
+}
+
+static Result run_global(const Library *lib, size_t budgetBytes) {
+    Result r = {0};
+
+    // 与 -as_crossDayPoolCapacity 同口径：预算按图片/视频平分，ObjC 映射按 96B/条估
+    size_t half = budgetBytes / 2;
+    size_t perEntry = as_phash_index_bytes_per_slot() + 96;
+    size_t table = as_phash_index_table_bytes();
+    size_t maxCount = half > table + perEntry * 256 ? (half - table) / perEntry : 256;
+
+    Pool dayPool, cross;
+    pool_init(&dayPool, lib->n, R_SIMILAR);
+    pool_init(&cross, lib->n, R_DUPLICATE);
+    uint32_t *dayModels = (uint32_t *)malloc(lib->n * sizeof(uint32_t));
+    uint32_t *carry = (uint32_t *)malloc(lib->n * sizeof(uint32_t));
+    size_t dayCount = 0;
+    size_t evictCursor = 0;
+
+    ASPHashHits near = {0}, far = {0};
+    uint32_t cur = UINT32_MAX;
+
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < lib->n; i++) {
+        if (lib->day[i] != cur) {
+            int adjacent = (cur != UINT32_MAX && lib->day[i] == cur + 1);
+            size_t carryCount = 0;
+            for (size_t k = 0; adjacent && k < dayCount; k++) {
+                if (lib->edge[dayModels[k]]) carry[carryCount++] = dayModels[k];
+            }
+            as_phash_index_clear(dayPool.idx);
+            dayCount = 0;
+            for (size_t k = 0; k < carryCount; k++) pool_add(&dayPool, lib, carry[k]);
+            cur = lib->day[i];
+        }
+
+        const uint64_t *h = lib->hash + (size_t)i * 4;
+        size_t ex1 = 0, ex2 = 0;
+        as_phash_index_query(dayPool.idx, h, R_SIMILAR, &near, &ex1);
+        as_phash_index_query(cross.idx, h, R_DUPLICATE, &far, &ex2);
+        r.examined += ex1 + ex2;
+
+        // 两个池的候选去重后才送 Vision
+        size_t uniqueFar = 0;
+        for (size_t k = 0; k < far.count; k++) {
+            if (!hits_contain(&dayPool, &near, (int32_t)cross.photo[far.slots[k]])) uniqueFar++;
+        }
+        r.candidates += near.count + uniqueFar;
+
+        if (lib->origin[i] >= 0 &&
+            (hits_contain(&dayPool, &near, lib->origin[i]) || hits_contain(&cross, &far, lib->origin[i]))) {
+            r.recalled++;
+        }
+
+        pool_add(&dayPool, lib, i);
+        dayModels[dayCount++] = i;
+        pool_add(&cross, lib, i);
+        while (as_phash_index_count(cross.idx) > maxCount) {
+            as_phash_index_remove(cross.idx, (uint32_t)evictCursor++);
+        }
+
+        // 与 ASPHashPool 一致：墓碑过半时按入池顺序重建，链表长度不随窗口滚动增长
+        size_t slots = as_phash_index_slot_count(cross.idx);
+        if (slots > 4096 && slots > as_phash_index_count(cross.idx) * 2) {
+            Pool fresh;
+            pool_init(&fresh, lib->n, R_DUPLICATE);
+            for (size_t s = evictCursor; s < slots; s++) pool_add(&fresh, lib, cross.photo[s]);
+            pool_free(&cross);
+            cross = fresh;
+            evictCursor = 0;
+        }
+
+        size_t bytes = as_phash_index_memory_bytes(dayPool.idx) +
+                       as_phash_index_count(cross.idx) * perEntry + table;
+        if (bytes > r.peakBytes) r.peakBytes = bytes;
+    }
+    r.ms = now_ms() - t0;
+
+    as_phash_hits_free(&near);
+    as_phash_hits_free(&far);
+    free(dayModels);
+    free(carry);
+    pool_free(&dayPool);
+    pool_free(&cross);
+    return r;
+}
+
+static Result run_naive(const Library *lib) {
+    Result r = {0};
+    Pool pool;
+    pool_init(&pool, lib->n, R_SIMILAR);
+    ASPHashHits hits = {0};
+
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < lib->n; i++) {
+        size_t ex = 0;
+        as_phash_index_query(pool.idx, lib->hash + (size_t)i * 4, R_SIMILAR, &hits, &ex);
+        r.examined += ex;
+        r.candidates += hits.count;
+        if (lib->origin[i] >= 0 && hits_contain(&pool, &hits, lib->origin[i])) r.recalled++;
+        pool_add(&pool, lib, i);
+    }
+    r.ms = now_ms() - t0;
+    r.peakBytes = as_phash_index_memory_bytes(pool.idx);
+
+    as_phash_hits_free(&hits);
+    pool_free(&pool);
+    return r;
+}
+
+static void print_result(const char *name, const Result *r, const Library *lib) {
+    printf("  %-7s %9.1fms  compares=%12zu  candidates=%10zu (%.2f/asset)  crossDayRecall=%5.1f%%  peak=%.1fMB\n",
+           name, r->ms, r->examined, r->candidates, (double)r->candidates / (double)lib->n,
+           lib->crossDay ? 100.0 * (double)r->recalled / (double)lib->crossDay : 0.0,
+           (double)r->peakBytes / (1024.0 * 1024.0));
+}
+
+static int run(size_t n) {
+    Library lib;
+    make_library(&lib, n);
+    printf("n=%-8zu days=%u crossDayResaves=%zu\n", n, lib.day[n - 1], lib.crossDay);
+
+    Result day = run_day(&lib);
+    Result global = run_global(&lib, 24u * 1024u * 1024u);
+    Result globalL = run_global(&lib, 96u * 1024u * 1024u);
+    print_result("day", &day, &lib);
+    print_result("global", &global, &lib);
+    print_result("g/96MB", &globalL, &lib);
+    if (n <= 100000) {
+        Result naive = run_naive(&lib);
+        print_result("naive", &naive, &lib);
+    }
+
+    free_library(&lib);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) return run((size_t)strtoull(argv[1], NULL, 10));
+
+    const size_t sizes[3] = { 20000, 100000, 500000 };
+    int rc = 0;
+    for (int i = 0; i < 3; i++) rc |= run(sizes[i]);
+    return rc;
+}
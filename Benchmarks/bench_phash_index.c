@@ -0,0 +1,132 @@
+// pHash256 候选索引 benchmark（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_phash_index.c ../Cleaner8-Xu2/manager/ASPHashIndex.c -o bench_phash_index -lpthread
+//   ./bench_phash_index            # 10k / 100k / 1M
+//   ./bench_phash_index 50000      # 指定规模
+//
+// 数据：约 30% 来自连拍簇（基准 hash 随机翻转 0..40 bit），其余均匀随机。
+// 每个规模都会抽样对比 multi-index 与线性扫描的结果，不一致直接退出码 1。
+
+#include "ASPHashIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static void make_hashes(uint64_t *out, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        uint64_t base[4] = { rng64(), rng64(), rng64(), rng64() };
+        memcpy(out + i * 4, base, sizeof(base));
+        i++;
+        if (rng64() % 10 < 3) {
+            size_t burst = 2 + rng64() % 30;
+            for (size_t b = 0; b < burst && i < n; b++, i++) {
+                uint64_t *h = out + i * 4;
+                memcpy(h, base, sizeof(base));
+                int flips = (int)(rng64() % 41);
+                for (int f = 0; f < flips; f++) {
+                    int bit = (int)(rng64() % 256);
+                    h[bit >> 6] ^= 1ull << (bit & 63);
+                }
+            }
+        }
+    }
+}
+
+static int same_hits(const ASPHashHits *a, const ASPHashHits *b) {
+    if (a->count != b->count) return 0;
+    return a->count == 0 || memcmp(a->slots, b->slots, a->count * sizeof(uint32_t)) == 0;
+}
+
+static int run(size_t n) {
+    uint64_t *hashes = (uint64_t *)malloc(n * 4 * sizeof(uint64_t));
+    if (!hashes) return 1;
+    make_hashes(hashes, n);
+
+    ASPHashIndex *idx = as_phash_index_create();
+    double t0 = now_ms();
+    for (size_t i = 0; i < n; i++) as_phash_index_add(idx, hashes + i * 4);
+    double buildMs = now_ms() - t0;
+
+    const uint32_t radii[2] = { 30, 119 }; // kPolicyDuplicate / kPolicySimilar
+    const size_t queries = 300;
+
+    printf("n=%-8zu build=%.1fms mem=%.1fMB\n", n, buildMs,
+           (double)as_phash_index_memory_bytes(idx) / (1024.0 * 1024.0));
+
+    // 按查询半径建的索引（ASPHashPool 的用法）：r=119 不建段表，结果同样与线性扫描逐条比对
+    ASPHashIndex *sized[2];
+    for (int r = 0; r < 2; r++) {
+        sized[r] = as_phash_index_create_for_radius(radii[r]);
+        for (size_t i = 0; i < n; i++) as_phash_index_add(sized[r], hashes + i * 4);
+        printf("  for_radius(%u) mem=%.1fMB\n", radii[r],
+               (double)as_phash_index_memory_bytes(sized[r]) / (1024.0 * 1024.0));
+    }
+
+    ASPHashHits hits = {0}, ref = {0};
+    int ok = 1;
+
+    for (int r = 0; r < 2; r++) {
+        size_t totalHits = 0, totalExamined = 0;
+        double idxMs = 0, scanMs = 0;
+
+        for (size_t q = 0; q < queries; q++) {
+            const uint64_t *h = hashes + (rng64() % n) * 4;
+            size_t examined = 0;
+
+            double a = now_ms();
+            as_phash_index_query(idx, h, radii[r], &hits, &examined);
+            idxMs += now_ms() - a;
+
+            a = now_ms();
+            as_phash_index_query_scan(idx, h, radii[r], &ref);
+            scanMs += now_ms() - a;
+
+            if (!same_hits(&hits, &ref)) ok = 0;
+            as_phash_index_query(sized[r], h, radii[r], &hits, NULL);
+            if (!same_hits(&hits, &ref)) ok = 0;
+            totalHits += hits.count;
+            totalExamined += examined;
+        }
+
+        printf("  r=%-3u index=%8.4fms/q  scan=%8.4fms/q  speedup=%6.1fx  examined=%9.1f/q  hits=%.1f/q\n",
+               radii[r], idxMs / queries, scanMs / queries,
+               idxMs > 0 ? scanMs / idxMs : 0.0,
+               (double)totalExamined / queries, (double)totalHits / queries);
+    }
+
+    if (!ok) printf("  MISMATCH: index result differs from linear scan\n");
+
+    as_phash_hits_free(&hits);
+    as_phash_hits_free(&ref);
+    as_phash_index_destroy(idx);
+    for (int r = 0; r < 2; r++) as_phash_index_destroy(sized[r]);
+    free(hashes);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) return run((size_t)strtoull(argv[1], NULL, 10));
+
+    const size_t sizes[3] = { 10000, 100000, 1000000 };
+    int rc = 0;
+    for (int i = 0; i < 3; i++) rc |= run(sizes[i]);
+    return rc;
+}
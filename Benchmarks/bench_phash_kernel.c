@@ -0,0 +1,187 @@
+// pHash256 内核校验 + benchmark（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -ffp-contract=off -I../Cleaner8-Xu2/manager bench_phash_kernel.c ../Cleaner8-Xu2/manager/ASPHashKernel.c -o bench_phash_kernel -lm -lpthread
+//   ./bench_phash_kernel            # 金标准 + 随机逐位校验 + 计时
+//   ./bench_phash_kernel golden     # 重新打印金标准（仅在有意修改算法时使用）
+//
+// 金标准：固定的合成图（渐变 / 棋盘 / 纯色 / 种子噪声）在原始标量实现下的 hash，
+// 快速版与参考版都必须与之一致；另外随机生成图片逐位比较两者。任一不一致退出码 1。
+// 注意：不要加 -ffast-math，它允许重排累加顺序，会破坏逐位一致。
+// 渐变 / 纯色图的高频系数接近 0，对舍入极敏感；金标准按 -ffp-contract=off（不融合 FMA）生成，
+// 这样 x86 / ARM 的 CI 结果一致。App 内默认允许 FMA 融合，快速版与参考版在同一编译设置下仍逐位相同。
+
+#include "ASPHashKernel.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIDE AS_PHASH_SIDE
+#define IMG_BYTES (SIDE * SIDE * 4)
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// MARK: - Synthetic images
+
+enum { kGoldenCount = 6 };
+
+static void make_golden(int which, uint8_t *img) {
+    for (int y = 0; y < SIDE; y++) {
+        for (int x = 0; x < SIDE; x++) {
+            uint8_t *p = img + (y * SIDE + x) * 4;
+            uint8_t r = 0, g = 0, b = 0;
+            switch (which) {
+                case 0: r = g = b = (uint8_t)(x * 4); break;                        // 水平渐变
+                case 1: r = (uint8_t)(y * 4); g = (uint8_t)(x * 4); b = 128; break; // 双向彩色渐变
+                case 2: r = g = b = (((x / 8) + (y / 8)) & 1) ? 230 : 20; break;    // 8px 棋盘
+                case 3: r = 200; g = 120; b = 40; break;                            // 纯色（全部系数 <= 中位数的退化情形）
+                case 4: {                                                           // 中心亮斑
+                    int dx = x - 32, dy = y - 24;
+                    int v = 255 - (dx * dx + dy * dy) / 4;
+                    r = g = b = (uint8_t)(v < 0 ? 0 : v);
+                    break;
+                }
+                default: r = (uint8_t)rng64(); g = (uint8_t)rng64(); b = (uint8_t)rng64(); break;
+            }
+            p[0] = r; p[1] = g; p[2] = b; p[3] = 255;
+        }
+    }
+}
+
+// 由原始标量实现（重构前的 computeColorPHash256Data）在 -O2 -ffp-contract=off 下生成
+static const uint64_t kGolden[kGoldenCount][4] = {
+    { 0x8015c968c2028459ull, 0xc81a42b8d02bf99cull, 0xab963a0534212f91ull, 0x4c12a655122196beull },
+    { 0xaa8016da88a863f3ull, 0x88a8261288802553ull, 0xed565cfc921f3f5dull, 0xe3ff3f7bd5d72038ull },
+    { 0xfa25a8df695928dfull, 0x8c27a8dfc71328dfull, 0x4000572069055720ull, 0x686dd72011885720ull },
+    { 0xb2220000cd51f222ull, 0x32220d51c0000d51ull, 0x72223222cd513222ull, 0x4d510d518d517222ull },
+    { 0x955595557aaa5faaull, 0x61057a015ea06957ull, 0x5a1565a5785f6615ull, 0x697a5a5f6185587aull },
+    { 0xca69aca8d13400d9ull, 0xcbd9ea9dc0b14cfeull, 0xe613e581f3c0ffddull, 0xaab4449aac05d063ull },
+};
+
+static void make_random(uint8_t *img) {
+    // 低频块 + 噪声，接近真实缩略图的能量分布
+    int bx = (int)(rng64() % 256), by = (int)(rng64() % 256);
+    for (int y = 0; y < SIDE; y++) {
+        for (int x = 0; x < SIDE; x++) {
+            uint8_t *p = img + (y * SIDE + x) * 4;
+            int base = (bx * x + by * y) / 64 + (int)(rng64() % 48);
+            for (int c = 0; c < 3; c++) {
+                int v = base + (int)(rng64() % 32) - 16;
+                p[c] = (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+            }
+            p[3] = 255;
+        }
+    }
+}
+
+static void print_hash(const uint64_t h[4]) {
+    printf("    { 0x%016" PRIx64 "ull, 0x%016" PRIx64 "ull, 0x%016" PRIx64 "ull, 0x%016" PRIx64 "ull },\n",
+           h[0], h[1], h[2], h[3]);
+}
+
+// MARK: - Checks
+
+static int check_golden(void) {
+    uint8_t *img = (uint8_t *)malloc(IMG_BYTES);
+    int ok = 1;
+    gRng = 0xC0FFEEull;
+    for (int i = 0; i < kGoldenCount; i++) {
+        make_golden(i, img);
+        uint64_t ref[4], fast[4];
+        as_phash256_from_rgba_reference(img, ref);
+        as_phash256_from_rgba(img, fast);
+        if (memcmp(ref, kGolden[i], sizeof(ref)) != 0) {
+            printf("  golden[%d] MISMATCH (reference)\n", i);
+            ok = 0;
+        }
+        if (memcmp(fast, kGolden[i], sizeof(fast)) != 0) {
+            printf("  golden[%d] MISMATCH (fast)\n", i);
+            ok = 0;
+        }
+    }
+    free(img);
+    printf("golden vectors: %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int check_random(int count) {
+    uint8_t *img = (uint8_t *)malloc(IMG_BYTES);
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        make_random(img);
+        uint64_t ref[4], fast[4];
+        as_phash256_from_rgba_reference(img, ref);
+        as_phash256_from_rgba(img, fast);
+        if (memcmp(ref, fast, sizeof(ref)) != 0) mismatches++;
+    }
+    free(img);
+    printf("random images: %d/%d bit-identical\n", count - mismatches, count);
+    return mismatches == 0;
+}
+
+static void bench(int count) {
+    uint8_t *imgs = (uint8_t *)malloc((size_t)count * IMG_BYTES);
+    for (int i = 0; i < count; i++) make_random(imgs + (size_t)i * IMG_BYTES);
+
+    uint64_t sink = 0, h[4];
+    const int rounds = 5;
+
+    double t0 = now_ms();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count; i++) {
+            as_phash256_from_rgba_reference(imgs + (size_t)i * IMG_BYTES, h);
+            sink ^= h[0];
+        }
+    }
+    double refMs = now_ms() - t0;
+
+    t0 = now_ms();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count; i++) {
+            as_phash256_from_rgba(imgs + (size_t)i * IMG_BYTES, h);
+            sink ^= h[0];
+        }
+    }
+    double fastMs = now_ms() - t0;
+
+    const double n = (double)count * rounds;
+    printf("reference: %7.2f us/hash\n", refMs * 1e3 / n);
+    printf("fast     : %7.2f us/hash  speedup=%.1fx  (sink=%" PRIx64 ")\n",
+           fastMs * 1e3 / n, fastMs > 0 ? refMs / fastMs : 0.0, sink & 0xF);
+    free(imgs);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "golden") == 0) {
+        uint8_t *img = (uint8_t *)malloc(IMG_BYTES);
+        gRng = 0xC0FFEEull;
+        for (int i = 0; i < kGoldenCount; i++) {
+            make_golden(i, img);
+            uint64_t h[4];
+            as_phash256_from_rgba_reference(img, h);
+            print_hash(h);
+        }
+        free(img);
+        return 0;
+    }
+
+    int ok = check_golden();
+    ok &= check_random(20000);
+    bench(2000);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+// 扫描缓存 v4 二进制格式 benchmark + 往返校验（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_scan_cache.c ../Cleaner8-Xu2/manager/ASScanCacheFormat.c -o bench_scan_cache
+//   ./bench_scan_cache              # 10k / 50k / 200k
+//   ./bench_scan_cache 500000
+//
+// 模拟 ASPhotoScanManager 的缓存内容：每条资产一个 ~40 字符 localId、pHash256，
+// 1/3 带 ~2KB Vision 特征；列表 = 截图/大视频/可比较集合 + 相似/重复分组 + 基线 localId。
+// 计时：编码、写文件、mmap 打开 + 遍历全部记录/列表（冷启动 UI 需要的工作量）。
+// 另外做截断 / 篡改文件的打开校验，确保损坏缓存返回错误而不是越界。
+// 旧 v3（NSKeyedArchiver）只能在 Apple 平台跑，对比数据见 App 内 [CACHE] 日志。
+
+#include "ASScanCacheFormat.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define VISION_BYTES 2048
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX/L0/001" 形态
+static int make_local_id(char *buf, uint32_t i) {
+    uint64_t a = rng64(), b = rng64();
+    return sprintf(buf, "%08X-%04X-%04X-%04X-%012" PRIX64 "/L0/%03u",
+                   (unsigned)(a >> 32), (unsigned)(a >> 16) & 0xFFFF, (unsigned)a & 0xFFFF,
+                   (unsigned)(b >> 48), (uint64_t)(b & 0xFFFFFFFFFFFFull), i % 1000);
+}
+
+typedef struct {
+    double encMs, writeMs, openMs;
+    size_t bytes;
+} Result;
+
+static int run(uint32_t n, const char *path, Result *res) {
+    static uint8_t vision[VISION_BYTES];
+    for (int i = 0; i < VISION_BYTES; i++) vision[i] = (uint8_t)rng64();
+
+    uint32_t *idx = malloc(sizeof(uint32_t) * n);
+    uint64_t checksum = 0;
+    char id[64];
+
+    double t0 = now_ms();
+    ASCacheWriter *w = as_cache_writer_create();
+    for (uint32_t i = 0; i < n; i++) {
+        int len = make_local_id(id, i);
+        ASCacheRecord r;
+        memset(&r, 0, sizeof(r));
+        r.localId = as_cache_writer_add_string(w, id, (uint32_t)len);
+        r.mediaType = (i % 10 == 0) ? 2 : 1;
+        r.subtypes = (i % 7 == 0) ? 4 : 0;
+        r.flags = AS_CACHE_REC_HAS_CREATION | AS_CACHE_REC_HAS_MODIFICATION;
+        r.creation = 1.6e9 + i * 60.0;
+        r.modification = r.creation + 1;
+        r.fileSize = 1000000 + (rng64() % 4000000);
+        r.blurScore = (float)(rng64() % 5000);
+        r.visionBlob = AS_CACHE_NONE;
+        if (i % 3 == 0) r.visionBlob = as_cache_writer_add_blob(w, vision, VISION_BYTES);
+        uint64_t h[4] = { rng64(), rng64(), rng64(), rng64() };
+        r.pHash64 = h[0];
+        as_cache_writer_add_record(w, &r, h);
+        checksum += r.fileSize;
+    }
+
+    // 可比较集合 = 全部图片；截图 ~5%；大视频 ~1%；分组 2~6 张
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < n; i++) if (i % 10) idx[m++] = i;
+    as_cache_writer_add_list(w, 4, 0, idx, m);
+    m = 0;
+    for (uint32_t i = 0; i < n; i += 20) idx[m++] = i;
+    as_cache_writer_add_list(w, 1, 0, idx, m);
+    m = 0;
+    for (uint32_t i = 0; i < n; i += 100) idx[m++] = i;
+    as_cache_writer_add_list(w, 3, 0, idx, m);
+    uint32_t groups = 0;
+    for (uint32_t i = 0; i + 6 < n; i += 25, groups++) {
+        uint32_t g[6], k = 2 + (uint32_t)(rng64() % 5);
+        for (uint32_t j = 0; j < k; j++) g[j] = i + j;
+        as_cache_writer_add_list(w, (groups & 1) ? 9 : 8, 1, g, k);
+    }
+    for (uint32_t i = 0; i < n; i++) idx[i] = i; // 记录 i 的 localId 就是字符串 i
+    as_cache_writer_add_list(w, 12, AS_CACHE_LIST_STRINGS, idx, n);
+
+    uint8_t meta[512];
+    memset(meta, 0xAB, sizeof(meta));
+    as_cache_writer_set_meta(w, meta, sizeof(meta));
+
+    uint8_t *bytes = NULL;
+    size_t len = 0;
+    if (!as_cache_writer_finish(w, &bytes, &len)) { fprintf(stderr, "finish failed\n"); return 1; }
+    as_cache_writer_destroy(w);
+    res->encMs = now_ms() - t0;
+    res->bytes = len;
+
+    t0 = now_ms();
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(bytes, 1, len, f) != len) { fprintf(stderr, "write failed\n"); return 1; }
+    fclose(f);
+    res->writeMs = now_ms() - t0;
+
+    // 损坏文件：截断 / 改魔数 / 改节偏移，都必须打开失败
+    ASCacheView bad;
+    if (as_cache_view_open(&bad, bytes, len / 2) == 0) { fprintf(stderr, "truncated file accepted\n"); return 1; }
+    uint8_t *copy = malloc(len);
+    memcpy(copy, bytes, len);
+    copy[0] ^= 0xFF;
+    if (as_cache_view_open(&bad, copy, len) == 0) { fprintf(stderr, "bad magic accepted\n"); return 1; }
+    memcpy(copy, bytes, len);
+    memset(copy + 40, 0xFF, 8); // 第一个节的 offset
+    if (as_cache_view_open(&bad, copy, len) == 0) { fprintf(stderr, "bad section accepted\n"); return 1; }
+    free(copy);
+    free(bytes);
+
+    // 冷启动路径：mmap + 校验 + 遍历记录/字符串/列表
+    t0 = now_ms();
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    fstat(fd, &st);
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) { fprintf(stderr, "mmap failed\n"); return 1; }
+
+    ASCacheView v;
+    int rc = as_cache_view_open(&v, map, (size_t)st.st_size);
+    if (rc != 0) { fprintf(stderr, "open rc=%d\n", rc); return 1; }
+
+    uint64_t sum = 0, strBytes = 0, blobs = 0;
+    for (uint32_t i = 0; i < v.recordCount; i++) {
+        const ASCacheRecord *r = &v.records[i];
+        uint32_t sl = 0;
+        as_cache_view_string(&v, r->localId, &sl);
+        strBytes += sl;
+        if (r->visionBlob != AS_CACHE_NONE) {
+            uint32_t bl = 0;
+            as_cache_view_blob(&v, r->visionBlob, &bl);
+            blobs += (bl == VISION_BYTES);
+        }
+        sum += r->fileSize;
+    }
+    size_t cursor = 0;
+    uint32_t listId, tag, cnt, lists = 0, baseline = 0;
+    const uint32_t *li;
+    while ((rc = as_cache_view_next_list(&v, &cursor, &listId, &tag, &li, &cnt)) > 0) {
+        lists++;
+        if (listId == 12) baseline = cnt;
+    }
+    res->openMs = now_ms() - t0;
+    munmap(map, (size_t)st.st_size);
+    free(idx);
+
+    if (rc < 0 || sum != checksum || v.recordCount != n || baseline != n ||
+        blobs != (n + 2) / 3 || lists != 4 + groups || strBytes < (uint64_t)n * 40) {
+        fprintf(stderr, "round-trip mismatch (n=%u)\n", n);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sizes[3] = { 10000, 50000, 200000 };
+    int count = 3;
+    if (argc > 1) { sizes[0] = (uint32_t)strtoul(argv[1], NULL, 10); count = 1; }
+
+    const char *path = "/tmp/as_bench_scan_cache.bin";
+    printf("%8s %10s %9s %9s %12s\n", "assets", "bytes", "encodeMs", "writeMs", "mmapOpenMs");
+    for (int i = 0; i < count; i++) {
+        Result r;
+        if (run(sizes[i], path, &r)) return 1;
+        printf("%8u %10zu %9.1f %9.1f %12.2f\n", sizes[i], r.bytes, r.encMs, r.writeMs, r.openMs);
+    }
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,300 @@
+// checkpoint 追加日志 vs 整库重写：写入字节 / 耗时 + 半截写入校验（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -I../Cleaner8-Xu2/manager bench_scan_journal.c ../Cleaner8-Xu2/manager/ASScanCacheFormat.c -o bench_scan_journal
+//   ./bench_scan_journal            # 10k / 50k（整库重写在 200k 时要写 ~80GB，默认不跑）
+//   ./bench_scan_journal 100000
+//
+// 模拟一次全量扫描：每 200 张一个 checkpoint。
+//   rewrite：每次把已扫描的全部记录编码成一个 v4 文件并覆盖写（旧行为，O(N²/200)）
+//   journal：每次只把新增 200 条编码成一帧追加；日志超过 max(8MB, base) 时压缩成 base
+// 最后按帧读回日志，核对帧数与记录总数；再截掉最后一帧的一半，确认读取在完整帧处停下；
+// 再去掉中间一帧，确认按 seq 重放在缺口处停下（与 ASReplayScanJournal 同一规则）。
+
+#include "ASScanCacheFormat.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECKPOINT_EVERY 200
+#define VISION_BYTES 2048
+#define COMPACT_MIN_BYTES (8u * 1024 * 1024)
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    char id[48];
+    int idLen;
+    ASCacheRecord rec;
+    uint64_t hash[4];
+} Asset;
+
+static uint8_t gVision[VISION_BYTES];
+
+// 把 [from, to) 编码成一个 v4 块；base 与帧同一格式
+// meta 前 8 字节记 seq（app 里在 meta 字典的 journalSeq）
+static uint8_t *encode_range(const Asset *a, uint32_t from, uint32_t to, uint64_t seq, size_t *outLen) {
+    ASCacheWriter *w = as_cache_writer_create();
+    uint32_t *idx = malloc(sizeof(uint32_t) * (to - from + 1));
+    for (uint32_t i = from; i < to; i++) {
+        ASCacheRecord r = a[i].rec;
+        r.localId = as_cache_writer_add_string(w, a[i].id, (uint32_t)a[i].idLen);
+        if (i % 3 == 0) r.visionBlob = as_cache_writer_add_blob(w, gVision, VISION_BYTES);
+        idx[i - from] = as_cache_writer_add_record(w, &r, a[i].hash);
+    }
+    as_cache_writer_add_list(w, 4, 0, idx, to - from);
+    uint8_t meta[256] = {0};
+    memcpy(meta, &seq, sizeof(seq));
+    as_cache_writer_set_meta(w, meta, sizeof(meta));
+
+    uint8_t *bytes = NULL;
+    as_cache_writer_finish(w, &bytes, outLen);
+    as_cache_writer_destroy(w);
+    free(idx);
+    return bytes;
+}
+
+static int write_file(const char *path, const char *mode, const void *p, size_t n) {
+    FILE *f = fopen(path, mode);
+    if (!f) return 0;
+    size_t w = fwrite(p, 1, n, f);
+    fclose(f);
+    return w == n;
+}
+
+static int append_frame(const char *path, const uint8_t *payload, uint32_t len, size_t *written) {
+    ASJournalFrameHeader h;
+    as_journal_frame_header(&h, payload, len);
+    static const uint8_t zeros[8] = {0};
+    FILE *f = fopen(path, "ab");
+    if (!f) return 0;
+    size_t pad = as_journal_frame_padding(len);
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(payload, 1, len, f) == len && fwrite(zeros, 1, pad, f) == pad;
+    fclose(f);
+    *written += sizeof(h) + len + pad;
+    return ok;
+}
+
+static uint8_t *read_all(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *p = aligned_alloc(8, (size_t)n + 8);
+    *len = fread(p, 1, (size_t)n, f);
+    fclose(f);
+    return p;
+}
+
+// 数帧、数记录；返回帧数
+static uint32_t scan_journal(const uint8_t *bytes, size_t len, uint64_t *records) {
+    size_t cursor = 0;
+    const uint8_t *payload;
+    uint32_t plen, frames = 0;
+    *records = 0;
+    while (as_journal_next(bytes, len, &cursor, &payload, &plen) > 0) {
+        ASCacheView v;
+        if (as_cache_view_open(&v, payload, plen) != 0) break;
+        *records += v.recordCount;
+        frames++;
+    }
+    return frames;
+}
+
+// 按 seq 重放：返回应用的帧数，*gap = 是否在缺口处停下
+static uint32_t replay_seq(const uint8_t *bytes, size_t len, uint64_t baseSeq, uint64_t *records, int *gap) {
+    size_t cursor = 0;
+    const uint8_t *payload;
+    uint32_t plen, applied = 0;
+    uint64_t last = baseSeq;
+    *records = 0;
+    *gap = 0;
+    while (as_journal_next(bytes, len, &cursor, &payload, &plen) > 0) {
+        ASCacheView v;
+        if (as_cache_view_open(&v, payload, plen) != 0 || v.metaLen < 8) break;
+        uint64_t seq;
+        memcpy(&seq, v.meta, sizeof(seq));
+        ASJournalSeqCheck check = as_journal_seq_check(last, seq);
+        if (check == AS_JOURNAL_SEQ_SKIP) continue;
+        if (check == AS_JOURNAL_SEQ_GAP) { *gap = 1; break; }
+        *records += v.recordCount;
+        last = seq;
+        applied++;
+    }
+    return applied;
+}
+
+// 去掉中间一帧：重放须停在缺口前，只应用前面连续的帧
+static int check_gap(const uint8_t *bytes, size_t len, uint32_t frames, uint64_t baseSeq) {
+    if (frames < 3) return 0;
+    uint32_t drop = frames / 2;
+    uint8_t *cut = aligned_alloc(8, len + 8);
+    size_t cursor = 0, at = 0, outLen = 0;
+    const uint8_t *payload;
+    uint32_t plen, k = 0;
+    uint64_t expectRecords = 0;
+    while (as_journal_next(bytes, len, &cursor, &payload, &plen) > 0) {
+        if (k != drop) {
+            memcpy(cut + outLen, bytes + at, cursor - at);
+            outLen += cursor - at;
+        }
+        if (k < drop) {
+            ASCacheView v;
+            as_cache_view_open(&v, payload, plen);
+            expectRecords += v.recordCount;
+        }
+        at = cursor;
+        k++;
+    }
+    uint64_t records = 0;
+    int gap = 0;
+    uint32_t applied = replay_seq(cut, outLen, baseSeq, &records, &gap);
+    free(cut);
+    if (!gap || applied != drop || records != expectRecords) {
+        fprintf(stderr, "missing frame: applied %u frames (%" PRIu64 " records) gap=%d, expected %u (%" PRIu64 ")\n",
+                applied, records, gap, drop, expectRecords);
+        return 1;
+    }
+    return 0;
+}
+
+static int run(uint32_t n) {
+    const char *base = "/tmp/as_bench_journal_base.bin";
+    const char *wal = "/tmp/as_bench_journal.wal";
+    unlink(base);
+    unlink(wal);
+
+    Asset *a = calloc(n, sizeof(Asset));
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t x = rng64(), y = rng64();
+        a[i].idLen = sprintf(a[i].id, "%016" PRIX64 "-%016" PRIX64 "/L0/001", x, y);
+        a[i].rec.mediaType = 1;
+        a[i].rec.flags = AS_CACHE_REC_HAS_CREATION;
+        a[i].rec.creation = 1.6e9 + i;
+        a[i].rec.fileSize = 1000000 + rng64() % 4000000;
+        a[i].rec.visionBlob = AS_CACHE_NONE;
+        for (int k = 0; k < 4; k++) a[i].hash[k] = rng64();
+    }
+
+    // 旧：整库重写
+    double t0 = now_ms();
+    uint64_t rewriteBytes = 0;
+    uint32_t checkpoints = 0;
+    for (uint32_t done = CHECKPOINT_EVERY; ; done += CHECKPOINT_EVERY) {
+        if (done > n) done = n;
+        size_t len;
+        uint8_t *p = encode_range(a, 0, done, 0, &len);
+        if (!write_file(base, "wb", p, len)) return 1;
+        free(p);
+        rewriteBytes += len;
+        checkpoints++;
+        if (done == n) break;
+    }
+    double rewriteMs = now_ms() - t0;
+
+    // 新：追加日志 + 按需压缩
+    unlink(base);
+    t0 = now_ms();
+    size_t journalBytes = 0, sinceBase = 0, lastBase = 0;
+    uint64_t baseBytes = 0;
+    uint32_t compactions = 0, baseUpTo = 0, mark = 0;
+    uint64_t seq = 0, baseSeq = 0;
+    for (uint32_t done = CHECKPOINT_EVERY; ; done += CHECKPOINT_EVERY) {
+        if (done > n) done = n;
+        size_t len;
+        if (sinceBase > (lastBase > COMPACT_MIN_BYTES ? lastBase : COMPACT_MIN_BYTES)) {
+            uint8_t *p = encode_range(a, 0, done, seq, &len);
+            if (!write_file(base, "wb", p, len)) return 1;
+            free(p);
+            unlink(wal);
+            baseSeq = seq;
+            baseBytes += len;
+            lastBase = len;
+            sinceBase = 0;
+            compactions++;
+            baseUpTo = done;
+        } else {
+            uint8_t *p = encode_range(a, mark, done, ++seq, &len);
+            size_t before = journalBytes;
+            if (!append_frame(wal, p, (uint32_t)len, &journalBytes)) return 1;
+            free(p);
+            sinceBase += journalBytes - before;
+        }
+        mark = done;
+        if (done == n) break;
+    }
+    double journalMs = now_ms() - t0;
+
+    // 重放：base 之后的记录数必须与日志一致
+    size_t wlen = 0;
+    uint8_t *wbytes = read_all(wal, &wlen);
+    uint64_t recs = 0;
+    uint32_t frames = wbytes ? scan_journal(wbytes, wlen, &recs) : 0;
+    if (recs != (uint64_t)(n - baseUpTo)) {
+        fprintf(stderr, "replay mismatch: %" PRIu64 " records, expected %u\n", recs, n - baseUpTo);
+        return 1;
+    }
+
+    // 半截写入：截掉最后一帧的一半，前面的帧仍可读
+    if (frames >= 2) {
+        size_t cursor = 0, lastStart = 0;
+        const uint8_t *payload;
+        uint32_t plen;
+        while (as_journal_next(wbytes, wlen, &cursor, &payload, &plen) > 0) {
+            if (cursor < wlen) lastStart = cursor;
+        }
+        uint64_t torn = 0;
+        uint32_t tf = scan_journal(wbytes, lastStart + (wlen - lastStart) / 2, &torn);
+        if (tf != frames - 1) {
+            fprintf(stderr, "torn tail: read %u frames, expected %u\n", tf, frames - 1);
+            return 1;
+        }
+    }
+    uint64_t seqRecs = 0;
+    int gap = 0;
+    if (wbytes && (replay_seq(wbytes, wlen, baseSeq, &seqRecs, &gap) != frames || gap || seqRecs != recs)) {
+        fprintf(stderr, "seq replay: stopped early on an intact journal\n");
+        return 1;
+    }
+    if (wbytes && check_gap(wbytes, wlen, frames, baseSeq)) return 1;
+    free(wbytes);
+    free(a);
+    unlink(base);
+    unlink(wal);
+
+    printf("%8u %6u %12.1f %10.0f %12.1f %10.0f %6u %7.1fx\n",
+           n, checkpoints,
+           rewriteBytes / 1048576.0, rewriteMs,
+           (journalBytes + baseBytes) / 1048576.0, journalMs,
+           compactions, (double)rewriteBytes / (double)(journalBytes + baseBytes));
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 0; i < VISION_BYTES; i++) gVision[i] = (uint8_t)rng64();
+
+    printf("%8s %6s %12s %10s %12s %10s %6s %8s\n",
+           "assets", "ckpts", "rewriteMB", "rewriteMs", "journalMB", "journalMs", "compact", "ratio");
+    if (argc > 1) return run((uint32_t)strtoul(argv[1], NULL, 10));
+
+    uint32_t sizes[2] = { 10000, 50000 };
+    for (int i = 0; i < 2; i++) if (run(sizes[i])) return 1;
+    return 0;
+}
@@ -0,0 +1,219 @@
+// 全量扫描：旧的串行循环 vs 有界环形队列流水线（自适应 decode 线程数）（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -pthread -I../Cleaner8-Xu2/manager bench_scan_pipeline.c ../Cleaner8-Xu2/manager/ASPipelineRing.c -lm -o bench_scan_pipeline
+//   ./bench_scan_pipeline                 # 20k 张，nominal / serious 两种热状态
+//   ./bench_scan_pipeline 5000 300 80 50  # 张数 / 每张等待 PhotoKit 出图 us / decode CPU us / 归类 CPU us
+//
+// 单张成本模型：decode = 等待出图（sleep，不占 CPU）+ pHash/模糊度（自旋占 CPU）；归类 = 串行 CPU。
+//   legacy：原实现 enumerateObjectsUsingBlock 在一个 block 里同步执行，信号量从不阻塞，等同逐张串行
+//   pipeline：fetch 线程 -> ring -> N 个 decode 线程 -> ring -> 归类线程（按 seq 重排后串行处理）
+// 归类线程核对 seq 严格递增（与串行顺序一致），并每 20ms 用 as_tuner_target 调整 decode 线程数。
+
+#include "ASPipelineRing.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_CAP 32
+#define WINDOW 96
+#define MAX_WORKERS 16
+
+static uint32_t gCount = 20000, gWaitUs = 200, gDecodeUs = 60, gConsumeUs = 40;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static void spin_us(uint32_t us) {
+    double end = now_us() + us;
+    while (now_us() < end) { }
+}
+
+static void sleep_us(uint32_t us) {
+    struct timespec ts = { 0, (long)us * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static uint64_t decode_item(uint32_t seq) {
+    sleep_us(gWaitUs);
+    spin_us(gDecodeUs);
+    return (uint64_t)seq * 2654435761u;
+}
+
+// MARK: - Pipeline
+
+typedef struct {
+    ASRing *in, *out;
+    uint32_t thermal;
+    _Atomic uint32_t target;
+    _Atomic uint32_t inflight;          // 已 fetch 未归类，<= WINDOW
+    _Atomic uint64_t decodeNs, decodeItems;
+    pthread_mutex_t parkLock;
+    pthread_cond_t park;
+    uint32_t maxTarget, adjustments;
+    int ordered;
+} Pipe;
+
+typedef struct { Pipe *p; uint32_t id; } Worker;
+
+static void *fetch_main(void *arg) {
+    Pipe *p = arg;
+    for (uint32_t seq = 0; seq < gCount; seq++) {
+        while (atomic_load(&p->inflight) >= WINDOW) sleep_us(20);
+        atomic_fetch_add(&p->inflight, 1);
+        if (!as_ring_push(p->in, seq, NULL)) break;
+    }
+    as_ring_close(p->in);
+    return NULL;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    Pipe *p = w->p;
+    uint32_t seq;
+    void *item;
+    for (;;) {
+        pthread_mutex_lock(&p->parkLock);
+        while (w->id >= atomic_load(&p->target)) pthread_cond_wait(&p->park, &p->parkLock);
+        pthread_mutex_unlock(&p->parkLock);
+
+        if (as_ring_pop_many(p->in, &seq, &item, 1) == 0) break;
+        double t0 = now_us();
+        uint64_t v = decode_item(seq);
+        atomic_fetch_add(&p->decodeNs, (uint64_t)((now_us() - t0) * 1000.0));
+        atomic_fetch_add(&p->decodeItems, 1);
+        if (!as_ring_push(p->out, seq, (void *)(uintptr_t)v)) break;
+    }
+    return NULL;
+}
+
+static void set_target(Pipe *p, uint32_t t) {
+    pthread_mutex_lock(&p->parkLock);
+    if (t != atomic_load(&p->target)) p->adjustments++;
+    atomic_store(&p->target, t);
+    if (t > p->maxTarget) p->maxTarget = t;
+    pthread_cond_broadcast(&p->park);
+    pthread_mutex_unlock(&p->parkLock);
+}
+
+static double run_pipeline(uint32_t thermal, Pipe *p, uint32_t *workersUsed) {
+    memset(p, 0, sizeof(*p));
+    p->in = as_ring_create(RING_CAP);
+    p->out = as_ring_create(RING_CAP);
+    p->thermal = thermal;
+    p->ordered = 1;
+    pthread_mutex_init(&p->parkLock, NULL);
+    pthread_cond_init(&p->park, NULL);
+
+    uint32_t cores = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    ASTunerInput ti = { .cores = cores, .thermal = thermal, .outCapacity = RING_CAP };
+    set_target(p, as_tuner_target(&ti));
+
+    uint32_t ceiling = as_tuner_max_workers(cores, thermal);
+    if (ceiling > MAX_WORKERS) ceiling = MAX_WORKERS;
+    pthread_t fetch, workers[MAX_WORKERS];
+    Worker ws[MAX_WORKERS];
+
+    double t0 = now_us();
+    pthread_create(&fetch, NULL, fetch_main, p);
+    for (uint32_t i = 0; i < ceiling; i++) {
+        ws[i] = (Worker){ p, i };
+        pthread_create(&workers[i], NULL, worker_main, &ws[i]);
+    }
+
+    // 归类线程（这里直接用主线程）：按 seq 重排
+    uint8_t *ready = calloc(WINDOW, 1);
+    uint64_t *vals = calloc(WINDOW, sizeof(uint64_t));
+    uint32_t next = 0, seqs[RING_CAP], lastSeq = UINT32_MAX;
+    void *items[RING_CAP];
+    double consumeNs = 0, lastTune = now_us();
+    uint64_t consumed = 0;
+    while (next < gCount) {
+        uint32_t n = as_ring_pop_many(p->out, seqs, items, RING_CAP);
+        if (n == 0) break;
+        for (uint32_t i = 0; i < n; i++) {
+            ready[seqs[i] % WINDOW] = 1;
+            vals[seqs[i] % WINDOW] = (uint64_t)(uintptr_t)items[i];
+        }
+        while (next < gCount && ready[next % WINDOW]) {
+            double c0 = now_us();
+            spin_us(gConsumeUs);
+            if (vals[next % WINDOW] != (uint64_t)next * 2654435761u) p->ordered = 0;
+            if (lastSeq != UINT32_MAX && next != lastSeq + 1) p->ordered = 0;
+            lastSeq = next;
+            ready[next % WINDOW] = 0;
+            next++;
+            consumed++;
+            atomic_fetch_sub(&p->inflight, 1);
+            consumeNs += (now_us() - c0) * 1000.0;
+        }
+        if (now_us() - lastTune > 20000) {
+            uint64_t di = atomic_load(&p->decodeItems);
+            ti.decodeUs = di ? (double)atomic_load(&p->decodeNs) / 1000.0 / (double)di : 0;
+            ti.consumeUs = consumed ? consumeNs / 1000.0 / (double)consumed : 0;
+            ti.outDepth = as_ring_depth(p->out);
+            ti.current = atomic_load(&p->target);
+            uint32_t t = as_tuner_target(&ti);
+            set_target(p, t > ceiling ? ceiling : t);
+            lastTune = now_us();
+        }
+    }
+    double ms = (now_us() - t0) / 1000.0;
+    *workersUsed = p->maxTarget;
+
+    as_ring_close(p->in);
+    as_ring_close(p->out);
+    set_target(p, MAX_WORKERS); // 唤醒所有停放的线程让它们退出
+    pthread_join(fetch, NULL);
+    for (uint32_t i = 0; i < ceiling; i++) pthread_join(workers[i], NULL);
+
+    if (next != gCount) p->ordered = 0;
+    free(ready);
+    free(vals);
+    as_ring_destroy(p->in);
+    as_ring_destroy(p->out);
+    return ms;
+}
+
+static double run_legacy(void) {
+    double t0 = now_us();
+    volatile uint64_t sink = 0;
+    for (uint32_t seq = 0; seq < gCount; seq++) {
+        sink += decode_item(seq);
+        spin_us(gConsumeUs);
+    }
+    (void)sink;
+    return (now_us() - t0) / 1000.0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) gCount = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (argc > 2) gWaitUs = (uint32_t)strtoul(argv[2], NULL, 10);
+    if (argc > 3) gDecodeUs = (uint32_t)strtoul(argv[3], NULL, 10);
+    if (argc > 4) gConsumeUs = (uint32_t)strtoul(argv[4], NULL, 10);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("assets=%u wait=%uus decode=%uus consume=%uus cores=%ld\n", gCount, gWaitUs, gDecodeUs, gConsumeUs, cores);
+    printf("%-18s %10s %10s %8s %8s %8s\n", "mode", "ms", "assets/s", "workers", "speedup", "ordered");
+
+    double legacy = run_legacy();
+    printf("%-18s %10.0f %10.0f %8u %8s %8s\n", "legacy serial", legacy, gCount / (legacy / 1000.0), 1u, "1.0x", "yes");
+
+    const char *names[2] = { "pipeline nominal", "pipeline serious" };
+    uint32_t thermals[2] = { 0, 2 };
+    for (int i = 0; i < 2; i++) {
+        Pipe p;
+        uint32_t used = 0;
+        double ms = run_pipeline(thermals[i], &p, &used);
+        printf("%-18s %10.0f %10.0f %8u %7.1fx %8s\n", names[i], ms, gCount / (ms / 1000.0), used, legacy / ms, p.ordered ? "yes" : "NO");
+        if (!p.ordered) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+// 模糊 Top-K：升序数组（二分 + insert/removeLast）vs 有界大顶堆，逐项核对结果（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_topk_heap.c ../Cleaner8-Xu2/manager/ASTopKHeap.c -o bench_topk_heap
+//   ./bench_topk_heap              # 50k 张，K = 300
+//   ./bench_topk_heap 200000 300
+//
+// 模拟扫描：每张一个分数（约 1/4 量化成整数，制造同分），按 updateBlurryTopKFixed 的准入规则维护 Top-K；
+// 每 1000 张做一次增量：随机删掉 Top-K 里的 5 张（删除的资产），再补到 K。
+// 数组版是原实现的 C 等价物（NSMutableArray 的 insertObject:atIndex: / removeObjectAtIndex: 都是 memmove）。
+// 最后堆的升序导出必须与数组逐项相同（分数与 id），被挤出的 id 序列也必须相同。
+// K = 300 时两者都在亚毫秒级，数组的 memmove 并不慢；堆的收益在 K 上千以后，以及按 localId 删除不再线性查找。
+
+#include "ASTopKHeap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    float score;
+    uint32_t id;
+} Entry;
+
+typedef struct {
+    Entry *a;
+    uint32_t n;
+} SortedArray;
+
+// 与 updateBlurryTopKFixed 相同：满了先比 lastObject，removeLastObject，再二分（upper bound）插入
+static int array_offer(SortedArray *s, float score, uint32_t id, uint32_t k, uint32_t *evicted) {
+    *evicted = AS_TOPK_NONE;
+    if (s->n >= k) {
+        if (!(score < s->a[s->n - 1].score)) return 0;
+        *evicted = s->a[--s->n].id;
+    }
+    uint32_t lo = 0, hi = s->n;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) >> 1;
+        if (score < s->a[mid].score) hi = mid;
+        else lo = mid + 1;
+    }
+    memmove(&s->a[lo + 1], &s->a[lo], sizeof(Entry) * (s->n - lo));
+    s->a[lo] = (Entry){ score, id };
+    s->n++;
+    return 1;
+}
+
+static void array_remove(SortedArray *s, uint32_t id) {
+    for (uint32_t i = 0; i < s->n; i++) {
+        if (s->a[i].id != id) continue;
+        memmove(&s->a[i], &s->a[i + 1], sizeof(Entry) * (s->n - i - 1));
+        s->n--;
+        return;
+    }
+}
+
+static float make_score(void) {
+    float s = (float)(rng64() % 1000000) / 10.f;
+    if ((rng64() & 3) == 0) s = (float)(int)(s / 100.f) * 100.f;
+    return s;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 50000;
+    uint32_t k = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 300;
+
+    float *scores = malloc(sizeof(float) * n);
+    for (uint32_t i = 0; i < n; i++) scores[i] = make_score();
+    // 增量删除的目标：固定种子，两边删同一批（按当前 Top-K 的位置挑）
+    uint64_t removeSeed = rng64();
+
+    uint32_t *evA = malloc(sizeof(uint32_t) * n), *evH = malloc(sizeof(uint32_t) * n);
+    uint32_t nevA = 0, nevH = 0;
+
+    // 数组
+    SortedArray arr = { malloc(sizeof(Entry) * (k + 1)), 0 };
+    gRng = removeSeed;
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t ev;
+        array_offer(&arr, scores[i], i, k, &ev);
+        if (ev != AS_TOPK_NONE) evA[nevA++] = ev;
+        if (i % 1000 == 999) {
+            for (int r = 0; r < 5 && arr.n; r++) {
+                uint32_t victim = (uint32_t)(rng64() % n);
+                array_remove(&arr, victim);
+            }
+        }
+    }
+    double arrMs = now_ms() - t0;
+
+    // 堆
+    ASTopKHeap *h = as_topk_create();
+    gRng = removeSeed;
+    t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t ev;
+        as_topk_offer(h, scores[i], i, k, &ev);
+        if (ev != AS_TOPK_NONE) evH[nevH++] = ev;
+        if (i % 1000 == 999) {
+            for (int r = 0; r < 5 && as_topk_count(h); r++) {
+                uint32_t victim = (uint32_t)(rng64() % n);
+                as_topk_remove(h, victim);
+            }
+        }
+    }
+    double heapMs = now_ms() - t0;
+
+    ASTopKItem *sorted = malloc(sizeof(ASTopKItem) * (as_topk_count(h) + 1));
+    t0 = now_ms();
+    uint32_t m = as_topk_sorted(h, sorted);
+    double sortUs = (now_ms() - t0) * 1e3;
+
+    int same = m == arr.n && nevA == nevH && memcmp(evA, evH, sizeof(uint32_t) * nevA) == 0;
+    for (uint32_t i = 0; same && i < m; i++) {
+        same = sorted[i].id == arr.a[i].id && sorted[i].score == arr.a[i].score;
+    }
+
+    printf("photos %u, K %u, evictions %u\n", n, k, nevH);
+    printf("%-22s %9.2f ms  (%6.1f ns/photo)\n", "sorted array", arrMs, arrMs * 1e6 / n);
+    printf("%-22s %9.2f ms  (%6.1f ns/photo)\n", "bounded heap", heapMs, heapMs * 1e6 / n);
+    printf("%-22s %9.1f us  (once per published snapshot)\n", "heap -> sorted", sortUs);
+    printf("result %s\n", same ? "identical" : "DIFFERENT");
+
+    as_topk_destroy(h);
+    free(scores); free(evA); free(evH); free(arr.a); free(sorted);
+    if (!same) {
+        fprintf(stderr, "heap and sorted array disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+// 视频指纹：截取 / 重新编码副本的召回、无关视频误判率、单帧 pHash 与对齐比较耗时（Linux / macOS 均可）
+//
+//   cc -O2 -std=gnu11 -Wall -Wextra -I../Cleaner8-Xu2/manager bench_video_fingerprint.c ../Cleaner8-Xu2/manager/ASVideoFingerprint.c -lm -o bench_video_fingerprint
+//   ./bench_video_fingerprint           # 200 个原视频
+//   ./bench_video_fingerprint 500
+//
+// 合成视频：若干镜头（2~8s 一切），每个镜头是几组缓慢平移的低频条纹叠加，解码成 96×64 亮度图。
+//   重新编码：换分辨率（80×54）+ 亮度偏移 + 噪声，时长不变
+//   截取：去掉头 / 尾 10%~30%，再重新编码
+// 阈值与 ASPhotoScanManager 的视频策略一致；对照组是只比较一帧封面 pHash 的旧做法。
+
+#include "ASVideoFingerprint.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SCENES 64
+#define WAVES 4
+
+// 与 ASPhotoScanManager 的 kASVideoPolicy* 一致
+#define SIM_DIST 12.f
+#define SIM_OVERLAP 0.5f
+#define DUP_DIST 6.f
+#define DUP_OVERLAP 0.9f
+#define DUP_DURATION_RATIO 0.9f
+#define POSTER_DIST 10
+
+static uint64_t gRng = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t rng64(void) {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 7;
+    gRng ^= gRng << 17;
+    return gRng;
+}
+
+static inline float frand(void) { return (float)(rng64() >> 11) / 9007199254740992.0f; }
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef struct {
+    float fx, fy, phase, amp, vel;
+} Wave;
+
+typedef struct {
+    float duration;
+    uint32_t scenes;
+    float cut[MAX_SCENES + 1];
+    Wave wave[MAX_SCENES][WAVES];
+    float base[MAX_SCENES];
+} Video;
+
+typedef struct {
+    const Video *src;
+    float start, duration;   // 在原视频里的区间
+    uint32_t w, h;
+    float brightness, noise;
+} Encoding;
+
+static void make_video(Video *v) {
+    v->duration = 5.f + frand() * 115.f;
+    float t = 0.f;
+    v->scenes = 0;
+    while (t < v->duration && v->scenes < MAX_SCENES) {
+        v->cut[v->scenes] = t;
+        v->base[v->scenes] = 60.f + frand() * 120.f;
+        for (int k = 0; k < WAVES; k++) {
+            Wave *w = &v->wave[v->scenes][k];
+            w->fx = 0.5f + frand() * 3.f;
+            w->fy = 0.5f + frand() * 3.f;
+            w->phase = frand() * 6.2831853f;
+            w->amp = 15.f + frand() * 35.f;
+            w->vel = (frand() - 0.5f) * 0.6f;
+        }
+        v->scenes++;
+        t += 2.f + frand() * 6.f;
+    }
+    v->cut[v->scenes] = v->duration + 1.f;
+}
+
+static void render(const Encoding *e, float t, uint8_t *out) {
+    const Video *v = e->src;
+    float at = e->start + t;
+    uint32_t s = 0;
+    while (s + 1 < v->scenes && v->cut[s + 1] <= at) s++;
+    float local = at - v->cut[s];
+    for (uint32_t y = 0; y < e->h; y++) {
+        for (uint32_t x = 0; x < e->w; x++) {
+            float fx = (float)x / (float)e->w, fy = (float)y / (float)e->h;
+            float p = v->base[s] + e->brightness;
+            for (int k = 0; k < WAVES; k++) {
+                const Wave *w = &v->wave[s][k];
+                p += w->amp * cosf(6.2831853f * (w->fx * fx + w->fy * fy) + w->phase + w->vel * local);
+            }
+            p += (frand() - 0.5f) * 2.f * e->noise;
+            out[y * e->w + x] = (uint8_t)(p < 0.f ? 0.f : (p > 255.f ? 255.f : p));
+        }
+    }
+}
+
+static double gHashNs;
+static uint64_t gHashes;
+
+static void fingerprint(const Encoding *e, ASVideoFingerprint *fp) {
+    static uint8_t frame[96 * 64];
+    memset(fp, 0, sizeof(*fp));
+    fp->version = AS_VFP_VERSION;
+    fp->count = as_vfp_frame_count(e->duration);
+    fp->duration = e->duration;
+    as_vfp_sample_times(e->duration, fp->count, fp->times);
+    for (uint32_t k = 0; k < fp->count; k++) {
+        render(e, fp->times[k], frame);
+        double t0 = now_ms();
+        fp->hashes[k] = as_vfp_frame_hash(frame, e->w, e->h, e->w);
+        gHashNs += (now_ms() - t0) * 1e6;
+        gHashes++;
+    }
+}
+
+// 旧做法：只有一帧封面（第一个采样点）
+static uint64_t poster(const Encoding *e) {
+    static uint8_t frame[96 * 64];
+    render(e, 0.5f, frame);
+    return as_vfp_frame_hash(frame, e->w, e->h, e->w);
+}
+
+static int is_similar(const ASVideoFingerprint *a, const ASVideoFingerprint *b) {
+    ASVideoMatch m;
+    return as_vfp_match(a, b, &m) && m.distance <= SIM_DIST && m.overlap >= SIM_OVERLAP;
+}
+
+static int is_duplicate(const ASVideoFingerprint *a, const ASVideoFingerprint *b) {
+    ASVideoMatch m;
+    if (!as_vfp_match(a, b, &m)) return 0;
+    float r = a->duration < b->duration ? a->duration / b->duration : b->duration / a->duration;
+    return m.distance <= DUP_DIST && m.overlap >= DUP_OVERLAP && r >= DUP_DURATION_RATIO;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 200;
+
+    Video *videos = calloc(n, sizeof(Video));
+    ASVideoFingerprint *orig = calloc(n, sizeof(ASVideoFingerprint));
+    ASVideoFingerprint *reenc = calloc(n, sizeof(ASVideoFingerprint));
+    ASVideoFingerprint *trim = calloc(n, sizeof(ASVideoFingerprint));
+    uint64_t *pOrig = calloc(n, sizeof(uint64_t)), *pReenc = calloc(n, sizeof(uint64_t)), *pTrim = calloc(n, sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < n; i++) {
+        make_video(&videos[i]);
+        Video *v = &videos[i];
+
+        Encoding e0 = { v, 0.f, v->duration, 96, 64, 0.f, 2.f };
+        Encoding e1 = { v, 0.f, v->duration, 80, 54, 8.f, 6.f };
+        float head = (rng64() & 1) ? v->duration * (0.1f + frand() * 0.2f) : 0.f;
+        float tail = (rng64() & 1) || head == 0.f ? v->duration * (0.1f + frand() * 0.2f) : 0.f;
+        Encoding e2 = { v, head, v->duration - head - tail, 80, 54, -6.f, 6.f };
+
+        fingerprint(&e0, &orig[i]);
+        fingerprint(&e1, &reenc[i]);
+        fingerprint(&e2, &trim[i]);
+        pOrig[i] = poster(&e0);
+        pReenc[i] = poster(&e1);
+        pTrim[i] = poster(&e2);
+    }
+
+    uint32_t dupHit = 0, dupTrimFalse = 0, simReenc = 0, simTrim = 0;
+    uint32_t posterReenc = 0, posterTrim = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        dupHit += is_duplicate(&orig[i], &reenc[i]);
+        dupTrimFalse += is_duplicate(&orig[i], &trim[i]);
+        simReenc += is_similar(&orig[i], &reenc[i]);
+        simTrim += is_similar(&orig[i], &trim[i]);
+        posterReenc += __builtin_popcountll(pOrig[i] ^ pReenc[i]) <= POSTER_DIST;
+        posterTrim += __builtin_popcountll(pOrig[i] ^ pTrim[i]) <= POSTER_DIST;
+    }
+
+    // 无关视频两两比较
+    uint64_t pairs = 0, falseSim = 0, falseDup = 0, falsePoster = 0;
+    double t0 = now_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = i + 1; j < n; j++) {
+            pairs++;
+            falseSim += is_similar(&orig[i], &orig[j]);
+            falseDup += is_duplicate(&orig[i], &orig[j]);
+            falsePoster += __builtin_popcountll(pOrig[i] ^ pOrig[j]) <= POSTER_DIST;
+        }
+    }
+    double matchUs = (now_ms() - t0) * 1e3 / (double)(pairs * 2);
+
+    printf("videos %u, %.1f frames each, frame hash %.1f us, aligned match %.1f us/pair\n",
+           n, (double)gHashes / (3.0 * n), gHashNs / 1e3 / (double)gHashes, matchUs);
+    printf("%-34s %8s %8s\n", "", "multi", "poster");
+    printf("%-34s %7.1f%% %7.1f%%\n", "re-encoded -> similar", 100.0 * simReenc / n, 100.0 * posterReenc / n);
+    printf("%-34s %7.1f%% %8s\n", "re-encoded -> duplicate", 100.0 * dupHit / n, "-");
+    printf("%-34s %7.1f%% %7.1f%%\n", "trimmed -> similar", 100.0 * simTrim / n, 100.0 * posterTrim / n);
+    printf("%-34s %7.1f%% %8s\n", "trimmed -> duplicate (should not)", 100.0 * dupTrimFalse / n, "-");
+    printf("%-34s %7.3f%% %7.3f%%\n", "unrelated -> similar", 100.0 * falseSim / pairs, 100.0 * falsePoster / pairs);
+    printf("%-34s %7.3f%% %8s\n", "unrelated -> duplicate", 100.0 * falseDup / pairs, "-");
+
+    int ok = simReenc * 100 >= n * 95 && simTrim * 100 >= n * 85 && falseSim * 1000 <= pairs;
+    free(videos); free(orig); free(reenc); free(trim);
+    free(pOrig); free(pReenc); free(pTrim);
+    if (!ok) {
+        fprintf(stderr, "recall / false-positive targets missed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 #import "AppDelegate.h"
+#import "ASBackgroundScanScheduler.h"
 
 @interface AppDelegate ()
 
@@ -9,6 +10,7 @@
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions {
     // Override point for customization after application launch.
+    [[ASBackgroundScanScheduler shared] registerTasks];
     return YES;
 }
 
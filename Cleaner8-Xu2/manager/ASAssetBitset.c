@@ -0,0 +1,106 @@
+#include "ASAssetBitset.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct ASAssetBitset {
+    uint64_t *words;
+    uint32_t nwords;
+    uint32_t count;
+};
+
+// MARK: - Lifecycle
+
+ASAssetBitset *as_bitset_create(uint32_t capacityBits) {
+    ASAssetBitset *b = calloc(1, sizeof(ASAssetBitset));
+    if (!b) return NULL;
+    uint32_t nw = (uint32_t)(((uint64_t)capacityBits + 63) / 64);
+    if (nw) {
+        b->words = calloc(nw, sizeof(uint64_t));
+        b->nwords = b->words ? nw : 0;
+    }
+    return b;
+}
+
+void as_bitset_destroy(ASAssetBitset *b) {
+    if (!b) return;
+    free(b->words);
+    free(b);
+}
+
+void as_bitset_clear(ASAssetBitset *b) {
+    if (b->nwords) memset(b->words, 0, sizeof(uint64_t) * b->nwords);
+    b->count = 0;
+}
+
+static int as_grow(ASAssetBitset *b, uint32_t nw) {
+    if (nw <= b->nwords) return 1;
+    uint32_t cap = b->nwords ? b->nwords : 16;
+    while (cap < nw) cap *= 2;
+    uint64_t *w = realloc(b->words, sizeof(uint64_t) * cap);
+    if (!w) return 0;
+    memset(w + b->nwords, 0, sizeof(uint64_t) * (cap - b->nwords));
+    b->words = w;
+    b->nwords = cap;
+    return 1;
+}
+
+// MARK: - Bits
+
+int as_bitset_set(ASAssetBitset *b, uint32_t i) {
+    if (i == AS_BITSET_END || !as_grow(b, i / 64 + 1)) return 0;
+    uint64_t m = 1ull << (i & 63);
+    if (b->words[i / 64] & m) return 0;
+    b->words[i / 64] |= m;
+    b->count++;
+    return 1;
+}
+
+int as_bitset_reset(ASAssetBitset *b, uint32_t i) {
+    if (i / 64 >= b->nwords) return 0;
+    uint64_t m = 1ull << (i & 63);
+    if (!(b->words[i / 64] & m)) return 0;
+    b->words[i / 64] &= ~m;
+    b->count--;
+    return 1;
+}
+
+int as_bitset_test(const ASAssetBitset *b, uint32_t i) {
+    return i / 64 < b->nwords && (b->words[i / 64] >> (i & 63)) & 1;
+}
+
+uint32_t as_bitset_count(const ASAssetBitset *b) { return b->count; }
+
+// MARK: - Set ops
+
+void as_bitset_or(ASAssetBitset *b, const ASAssetBitset *other) {
+    uint32_t nw = other->nwords;
+    while (nw && other->words[nw - 1] == 0) nw--;
+    if (!as_grow(b, nw)) return;
+    uint32_t c = 0;
+    for (uint32_t i = 0; i < nw; i++) b->words[i] |= other->words[i];
+    for (uint32_t i = 0; i < b->nwords; i++) c += (uint32_t)__builtin_popcountll(b->words[i]);
+    b->count = c;
+}
+
+void as_bitset_andnot(ASAssetBitset *b, const ASAssetBitset *other) {
+    uint32_t nw = b->nwords < other->nwords ? b->nwords : other->nwords;
+    uint32_t removed = 0;
+    for (uint32_t i = 0; i < nw; i++) {
+        uint64_t hit = b->words[i] & other->words[i];
+        removed += (uint32_t)__builtin_popcountll(hit);
+        b->words[i] &= ~hit;
+    }
+    b->count -= removed;
+}
+
+uint32_t as_bitset_next(const ASAssetBitset *b, uint32_t from) {
+    uint32_t wi = from / 64;
+    if (from == AS_BITSET_END || wi >= b->nwords) return AS_BITSET_END;
+    uint64_t w = b->words[wi] & (~0ull << (from & 63));
+    for (;;) {
+        if (w) return wi * 64 + (uint32_t)__builtin_ctzll(w);
+        if (++wi >= b->nwords) return AS_BITSET_END;
+        w = b->words[wi];
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef ASAssetBitset_h
+#define ASAssetBitset_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 资产行号位图（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 行号是 ASAssetTable 按 localId 登记的稠密 uint32，一个资产只占 1 bit。
+/// 置位 / 清位 / 查询 O(1)，个数随置位增量维护（读是 O(1)），差集按 64 位字做，
+/// 遍历用 ctz 跳过空字。越界的行号按「不在集合里」处理，置位时自动扩容。
+
+#define AS_BITSET_END UINT32_MAX
+
+typedef struct ASAssetBitset ASAssetBitset;
+
+ASAssetBitset *as_bitset_create(uint32_t capacityBits);
+void as_bitset_destroy(ASAssetBitset *b);
+void as_bitset_clear(ASAssetBitset *b);
+
+/// 返回 1 = 新置位，0 = 原来就在（或内存不足）
+int as_bitset_set(ASAssetBitset *b, uint32_t i);
+/// 返回 1 = 原来在、已清掉
+int as_bitset_reset(ASAssetBitset *b, uint32_t i);
+int as_bitset_test(const ASAssetBitset *b, uint32_t i);
+
+uint32_t as_bitset_count(const ASAssetBitset *b);
+
+/// b = b ∪ other / b = b − other
+void as_bitset_or(ASAssetBitset *b, const ASAssetBitset *other);
+void as_bitset_andnot(ASAssetBitset *b, const ASAssetBitset *other);
+
+/// >= from 的第一个置位行号；没有返回 AS_BITSET_END
+uint32_t as_bitset_next(const ASAssetBitset *b, uint32_t from);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASAssetBitset_h */
@@ -0,0 +1,54 @@
+#import <Foundation/Foundation.h>
+#import <Photos/Photos.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 一个资产占用的字节，按 PHAssetResource 类型拆分
+@interface ASAssetSizeInfo : NSObject
+@property (nonatomic, readonly) uint64_t totalBytes;        // 全部资源之和（删除资产释放的空间）
+@property (nonatomic, readonly) uint64_t photoBytes;        // 原图：Photo / AlternatePhoto
+@property (nonatomic, readonly) uint64_t videoBytes;        // 原视频：Video
+@property (nonatomic, readonly) uint64_t pairedVideoBytes;  // Live Photo 的视频：PairedVideo
+@property (nonatomic, readonly) uint64_t adjustmentBytes;   // 编辑：FullSize* 渲染 + AdjustmentData + AdjustmentBase*
+@property (nonatomic, readonly) uint64_t otherBytes;        // 其余（Audio 等）
+@property (nonatomic, readonly) BOOL cached;                // 来自持久化缓存，没有读 PHAssetResource
+@end
+
+/// 资产大小服务：扫描、左右滑、Live Photo 转封面、图片 / 视频压缩共用同一份口径。
+///
+/// 大小按 (localId, modificationDate) 持久化（与特征库同一种追加文件，见 ASFeatureStoreFormat.h），
+/// 资产没被编辑就不再调用 +assetResourcesForAsset: / KVC fileSize。
+/// 批量接口在服务自己的低优先级队列上分批解析；同步接口线程安全，未命中时在调用线程上解析一次。
+/// 取不到大小（0）不写缓存，下次再试。
+@interface ASAssetSizeService : NSObject
+
++ (instancetype)shared;
+
+/// 同步：命中缓存直接返回；否则读资源列表并写缓存
+- (ASAssetSizeInfo *)sizeInfoForAsset:(PHAsset *)asset;
+- (uint64_t)totalBytesForAsset:(PHAsset *)asset;
+/// 主资源：图片取 photoBytes，视频取 videoBytes（拆不出来时退回 totalBytes）。
+/// 压缩只重编码主资源，压缩前大小 / 预估 / 节省都按这个算；删除整个资产释放的才是 totalBytes
+- (uint64_t)primaryBytesForAsset:(PHAsset *)asset;
+
+/// 批量：后台分批解析，完成后在主线程回调 localId -> 大小（取不到的不在字典里）
+- (void)resolveSizesForAssets:(NSArray<PHAsset *> *)assets
+                   completion:(void (^)(NSDictionary<NSString *, ASAssetSizeInfo *> *sizes))completion;
+
+/// 预取：扫描开始时把整库交给服务在后台先解析，扫描线程随后的同步查询直接命中。
+/// 新的预取会取消尚未完成的旧预取；预取逐批让出队列，resolveSizesForAssets 不会排在整库后面
+- (void)prefetchSizesForAssets:(PHFetchResult<PHAsset *> *)assets;
+- (void)cancelPrefetch;
+
+/// 资产已删除
+- (void)removeLocalIds:(NSArray<NSString *> *)localIds;
+
+/// 尽快把新解析的大小落盘（异步；否则写入后约 2 秒合并落盘一次）
+- (void)flush;
+
+/// hits / misses / stale / puts / entries ...（同 ASFeatureStore -stats）
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,224 @@
+#import "ASAssetSizeService.h"
+#import <stdatomic.h>
+#import "ASFeatureStore.h"
+
+static NSString * const kASAssetSizeStoreFileName = @"as_asset_sizes_v1.bin";
+// 拆分口径变化时改版本号（旧文件整体作废）
+static const uint32_t kASAssetSizeStoreVersion = 1;
+// 批量解析每批的资产数（每批一个 autoreleasepool）
+static const NSUInteger kASAssetSizeBatch = 128;
+static const double kASAssetSizeFlushDelay = 2.0;
+
+@interface ASAssetSizeInfo ()
+@property (nonatomic, readwrite) uint64_t totalBytes;
+@property (nonatomic, readwrite) uint64_t photoBytes;
+@property (nonatomic, readwrite) uint64_t videoBytes;
+@property (nonatomic, readwrite) uint64_t pairedVideoBytes;
+@property (nonatomic, readwrite) uint64_t adjustmentBytes;
+@property (nonatomic, readwrite) uint64_t otherBytes;
+@property (nonatomic, readwrite) BOOL cached;
+@end
+
+@implementation ASAssetSizeInfo
+@end
+
+#pragma mark - Helpers
+
+static NSString *ASAssetSizeStorePath(void) {
+    NSArray *dirs = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+    NSString *dir = dirs.firstObject;
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    return [dir stringByAppendingPathComponent:kASAssetSizeStoreFileName];
+}
+
+// 与特征库同一个时间：modificationDate，没有则 creationDate
+static inline int64_t ASAssetSizeModMs(PHAsset *asset) {
+    NSDate *d = asset.modificationDate ?: asset.creationDate;
+    return d ? (int64_t)llround(d.timeIntervalSince1970 * 1000.0) : 0;
+}
+
+static uint64_t ASResourceBytes(PHAssetResource *r) {
+    NSNumber *n = nil;
+    @try { n = [r valueForKey:@"fileSize"]; }
+    @catch (__unused NSException *e) { n = nil; }
+    return [n isKindOfClass:[NSNumber class]] ? n.unsignedLongLongValue : 0;
+}
+
+static ASAssetSizeInfo *ASReadSizeInfo(PHAsset *asset) {
+    ASAssetSizeInfo *info = [ASAssetSizeInfo new];
+    for (PHAssetResource *r in [PHAssetResource assetResourcesForAsset:asset]) {
+        uint64_t v = ASResourceBytes(r);
+        info.totalBytes += v;
+        switch (r.type) {
+            case PHAssetResourceTypePhoto:
+            case PHAssetResourceTypeAlternatePhoto:
+                info.photoBytes += v; break;
+            case PHAssetResourceTypeVideo:
+                info.videoBytes += v; break;
+            case PHAssetResourceTypePairedVideo:
+                info.pairedVideoBytes += v; break;
+            case PHAssetResourceTypeFullSizePhoto:
+            case PHAssetResourceTypeFullSizeVideo:
+            case PHAssetResourceTypeFullSizePairedVideo:
+            case PHAssetResourceTypeAdjustmentData:
+            case PHAssetResourceTypeAdjustmentBasePhoto:
+            case PHAssetResourceTypeAdjustmentBaseVideo:
+            case PHAssetResourceTypeAdjustmentBasePairedVideo:
+                info.adjustmentBytes += v; break;
+            default:
+                info.otherBytes += v; break;
+        }
+    }
+    return info;
+}
+
+static ASAssetSizeInfo *ASSizeInfoFromStored(ASStoredFeatures *f) {
+    ASAssetSizeInfo *info = [ASAssetSizeInfo new];
+    info.totalBytes = f.fileSize;
+    info.photoBytes = f.photoBytes;
+    info.videoBytes = f.videoBytes;
+    info.pairedVideoBytes = f.pairedVideoBytes;
+    info.adjustmentBytes = f.adjustmentBytes;
+    uint64_t parts = f.photoBytes + f.videoBytes + f.pairedVideoBytes + f.adjustmentBytes;
+    info.otherBytes = f.fileSize > parts ? f.fileSize - parts : 0;
+    info.cached = YES;
+    return info;
+}
+
+#pragma mark - Service
+
+@interface ASAssetSizeService ()
+@property (nonatomic, strong) ASFeatureStore *store;
+@property (nonatomic, strong) dispatch_queue_t resolveQ;  // 批量 / 预取（串行，utility）
+@property (nonatomic, strong) dispatch_queue_t ioQ;       // 落盘（串行）
+@end
+
+@implementation ASAssetSizeService {
+    _Atomic uint64_t _prefetchGeneration;
+    atomic_bool _flushScheduled;
+}
+
++ (instancetype)shared {
+    static ASAssetSizeService *s;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{ s = [ASAssetSizeService new]; });
+    return s;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _store = [[ASFeatureStore alloc] initWithPath:ASAssetSizeStorePath() extractorVersion:kASAssetSizeStoreVersion];
+        _resolveQ = dispatch_queue_create("as.asset.size.resolve",
+                                          dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _ioQ = dispatch_queue_create("as.asset.size.io", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark - Lookup
+
+- (ASAssetSizeInfo *)sizeInfoForAsset:(PHAsset *)asset {
+    NSString *lid = asset.localIdentifier;
+    if (!lid.length) return [ASAssetSizeInfo new];
+    int64_t modMs = ASAssetSizeModMs(asset);
+
+    ASStoredFeatures *stored = [self.store featuresForLocalId:lid modificationMs:modMs includeFeature:NO];
+    if (stored.hasFileSize) return ASSizeInfoFromStored(stored);
+
+    ASAssetSizeInfo *info = ASReadSizeInfo(asset);
+    if (info.totalBytes > 0) {
+        ASStoredFeatures *f = [ASStoredFeatures new];
+        f.hasFileSize = YES;
+        f.fileSize = info.totalBytes;
+        f.photoBytes = info.photoBytes;
+        f.videoBytes = info.videoBytes;
+        f.pairedVideoBytes = info.pairedVideoBytes;
+        f.adjustmentBytes = info.adjustmentBytes;
+        [self.store storeFeatures:f forLocalId:lid modificationMs:modMs];
+        [self as_scheduleFlush];
+    }
+    return info;
+}
+
+- (uint64_t)totalBytesForAsset:(PHAsset *)asset {
+    return [self sizeInfoForAsset:asset].totalBytes;
+}
+
+- (uint64_t)primaryBytesForAsset:(PHAsset *)asset {
+    ASAssetSizeInfo *info = [self sizeInfoForAsset:asset];
+    uint64_t primary = (asset.mediaType == PHAssetMediaTypeVideo) ? info.videoBytes : info.photoBytes;
+    return primary ?: info.totalBytes;
+}
+
+#pragma mark - Batch
+
+- (void)resolveSizesForAssets:(NSArray<PHAsset *> *)assets
+                   completion:(void (^)(NSDictionary<NSString *, ASAssetSizeInfo *> *))completion {
+    NSArray<PHAsset *> *input = [assets copy] ?: @[];
+    dispatch_async(self.resolveQ, ^{
+        NSMutableDictionary<NSString *, ASAssetSizeInfo *> *out = [NSMutableDictionary dictionaryWithCapacity:input.count];
+        for (NSUInteger from = 0; from < input.count; from += kASAssetSizeBatch) {
+            @autoreleasepool {
+                NSUInteger to = MIN(from + kASAssetSizeBatch, input.count);
+                for (NSUInteger i = from; i < to; i++) {
+                    PHAsset *a = input[i];
+                    ASAssetSizeInfo *info = [self sizeInfoForAsset:a];
+                    if (info.totalBytes > 0 && a.localIdentifier) out[a.localIdentifier] = info;
+                }
+            }
+        }
+        if (completion) dispatch_async(dispatch_get_main_queue(), ^{ completion(out); });
+    });
+}
+
+- (void)prefetchSizesForAssets:(PHFetchResult<PHAsset *> *)assets {
+    uint64_t gen = atomic_fetch_add(&_prefetchGeneration, 1) + 1;
+    [self as_prefetchBatchFrom:0 assets:assets generation:gen];
+}
+
+// 一个 block 只做一批，做完再把下一批排到队尾：
+// 预取跑的是整个图库，resolveSizesForAssets（用户在等结果）最多等一批就能插进来
+- (void)as_prefetchBatchFrom:(NSUInteger)from assets:(PHFetchResult<PHAsset *> *)assets generation:(uint64_t)gen {
+    dispatch_async(self.resolveQ, ^{
+        if (atomic_load(&self->_prefetchGeneration) != gen) return;
+        NSUInteger n = assets.count;
+        if (from >= n) return;
+        NSUInteger to = MIN(from + kASAssetSizeBatch, n);
+        @autoreleasepool {
+            NSArray<PHAsset *> *batch = [assets objectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(from, to - from)]];
+            for (PHAsset *a in batch) [self sizeInfoForAsset:a];
+        }
+        [self as_prefetchBatchFrom:to assets:assets generation:gen];
+    });
+}
+
+- (void)cancelPrefetch {
+    atomic_fetch_add(&_prefetchGeneration, 1);
+}
+
+#pragma mark - Persistence
+
+- (void)removeLocalIds:(NSArray<NSString *> *)localIds {
+    if (localIds.count == 0) return;
+    [self.store removeLocalIds:localIds];
+    [self as_scheduleFlush];
+}
+
+// 连续写入合并成一次落盘
+- (void)as_scheduleFlush {
+    if (atomic_exchange(&_flushScheduled, true)) return;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kASAssetSizeFlushDelay * NSEC_PER_SEC)), self.ioQ, ^{
+        atomic_store(&self->_flushScheduled, false);
+        [self.store flush];
+    });
+}
+
+- (void)flush {
+    dispatch_async(self.ioQ, ^{ [self.store flush]; });
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    return [self.store stats];
+}
+
+@end
@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 全量扫描的后台续扫：没扫完进后台时提交一个 BGProcessingTask（要求充电、不需要网络），
+/// 系统给窗口时从 checkpoint 按工作单元继续，到期前在单元边界落盘；没扫完就再排下一个窗口。
+///
+/// 任务标识为 <bundleId>.scan，需要在 Info.plist 的 BGTaskSchedulerPermittedIdentifiers 里声明，
+/// 并在 application:didFinishLaunchingWithOptions: 返回前调用 -registerTasks。
+@interface ASBackgroundScanScheduler : NSObject
+
++ (instancetype)shared;
+
+/// 注册任务处理；只能在启动完成前调用一次
+- (void)registerTasks;
+
+/// 有没扫完的全量扫描时提交（重复提交会替换掉未执行的请求）
+- (void)scheduleIfNeeded;
+
+/// 全量扫描完成：记一次「从开始到拿到完整结果」的耗时和用掉的后台窗口数，之后清零
+- (void)noteFullScanFinishedStartedAt:(nullable NSDate *)startedAt;
+
+/// windows / expired / unitsLast / unitsTotal / assetsTotal / secondsTotal /
+/// firstFullResultSec / windowsToFullResult（持久化）
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,131 @@
+#import "ASBackgroundScanScheduler.h"
+#import <BackgroundTasks/BackgroundTasks.h>
+#import <stdatomic.h>
+#import "ASPhotoScanManager.h"
+
+static NSString * const kASBGScanStatsKey = @"as_bg_scan_stats_v1";
+// 本轮全量扫描已用掉的后台窗口数（完成时记入 windowsToFullResult 后清零）
+static NSString * const kASBGScanPendingWindowsKey = @"as_bg_scan_pending_windows_v1";
+// 最早多久之后开始（给前台刚退出的流水线留一点时间）
+static const NSTimeInterval kASBGScanEarliestDelay = 60;
+
+@implementation ASBackgroundScanScheduler {
+    BOOL _registered;
+}
+
++ (instancetype)shared {
+    static ASBackgroundScanScheduler *s;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{ s = [ASBackgroundScanScheduler new]; });
+    return s;
+}
+
+- (NSString *)taskIdentifier {
+    return [NSBundle.mainBundle.bundleIdentifier stringByAppendingString:@".scan"];
+}
+
+#pragma mark - Register / schedule
+
+- (void)registerTasks {
+    if (_registered) return;
+    __weak typeof(self) weakSelf = self;
+    _registered = [BGTaskScheduler.sharedScheduler registerForTaskWithIdentifier:[self taskIdentifier]
+                                                                     usingQueue:nil
+                                                                  launchHandler:^(__kindof BGTask *task) {
+        [weakSelf handleTask:(BGProcessingTask *)task];
+    }];
+    if (!_registered) NSLog(@"[BGSCAN] register failed (identifier not permitted?)");
+}
+
+- (void)scheduleIfNeeded {
+    if (!_registered) return;
+    if (![[ASPhotoScanManager shared] hasUnfinishedFullScan]) return;
+
+    BGProcessingTaskRequest *req = [[BGProcessingTaskRequest alloc] initWithIdentifier:[self taskIdentifier]];
+    req.requiresExternalPower = YES;
+    req.requiresNetworkConnectivity = NO;
+    req.earliestBeginDate = [NSDate dateWithTimeIntervalSinceNow:kASBGScanEarliestDelay];
+
+    NSError *error = nil;
+    if (![BGTaskScheduler.sharedScheduler submitTaskRequest:req error:&error]) {
+        NSLog(@"[BGSCAN] submit failed: %@", error);
+    }
+}
+
+#pragma mark - Window
+
+- (void)handleTask:(BGProcessingTask *)task {
+    __block atomic_bool expired = false;
+    task.expirationHandler = ^{ atomic_store(&expired, true); };
+
+    [self noteWindowStarted];
+    CFAbsoluteTime t0 = CFAbsoluteTimeGetCurrent();
+    [[ASPhotoScanManager shared] runBackgroundScanWindowUntil:^BOOL{
+        return atomic_load(&expired);
+    } completion:^(NSUInteger units, NSUInteger assets, BOOL finished) {
+        double sec = CFAbsoluteTimeGetCurrent() - t0;
+        BOOL wasExpired = atomic_load(&expired);
+        [self recordWindowUnits:units assets:assets seconds:sec expired:wasExpired];
+        NSLog(@"[BGSCAN] window units=%lu assets=%lu %.1fs expired=%d finished=%d",
+              (unsigned long)units, (unsigned long)assets, sec, wasExpired, finished);
+
+        if (!finished) [self scheduleIfNeeded];
+        [task setTaskCompletedWithSuccess:finished || !wasExpired];
+    }];
+}
+
+#pragma mark - Stats
+
+- (NSMutableDictionary *)loadStats {
+    NSDictionary *d = [NSUserDefaults.standardUserDefaults dictionaryForKey:kASBGScanStatsKey];
+    return d ? [d mutableCopy] : [NSMutableDictionary dictionary];
+}
+
+- (void)recordWindowUnits:(NSUInteger)units assets:(NSUInteger)assets seconds:(double)sec expired:(BOOL)expired {
+    @synchronized (self) {
+        NSUserDefaults *ud = NSUserDefaults.standardUserDefaults;
+        NSMutableDictionary *m = [self loadStats];
+        m[@"windows"] = @([m[@"windows"] unsignedIntegerValue] + 1);
+        m[@"expired"] = @([m[@"expired"] unsignedIntegerValue] + (expired ? 1 : 0));
+        m[@"unitsLast"] = @(units);
+        m[@"unitsTotal"] = @([m[@"unitsTotal"] unsignedIntegerValue] + units);
+        m[@"assetsTotal"] = @([m[@"assetsTotal"] unsignedIntegerValue] + assets);
+        m[@"secondsTotal"] = @([m[@"secondsTotal"] doubleValue] + sec);
+        [ud setObject:m forKey:kASBGScanStatsKey];
+    }
+}
+
+// 窗口开始时就计入：扫描在窗口内完成时，noteFullScanFinishedStartedAt: 先于窗口结算被调用
+- (void)noteWindowStarted {
+    @synchronized (self) {
+        NSUserDefaults *ud = NSUserDefaults.standardUserDefaults;
+        [ud setInteger:[ud integerForKey:kASBGScanPendingWindowsKey] + 1 forKey:kASBGScanPendingWindowsKey];
+    }
+}
+
+- (void)noteFullScanFinishedStartedAt:(NSDate *)startedAt {
+    @synchronized (self) {
+        NSUserDefaults *ud = NSUserDefaults.standardUserDefaults;
+        NSInteger windows = [ud integerForKey:kASBGScanPendingWindowsKey];
+        NSMutableDictionary *m = [self loadStats];
+        // 只记第一次拿到完整结果（之后的重扫不覆盖）
+        if (!m[@"firstFullResultSec"] && startedAt.timeIntervalSince1970 > 0) {
+            m[@"firstFullResultSec"] = @(MAX(0, [NSDate.date timeIntervalSinceDate:startedAt]));
+            m[@"windowsToFullResult"] = @(windows);
+            [ud setObject:m forKey:kASBGScanStatsKey];
+            NSLog(@"[BGSCAN] first full result %.0fs after start, %ld background windows",
+                  [m[@"firstFullResultSec"] doubleValue], (long)windows);
+        }
+        [ud removeObjectForKey:kASBGScanPendingWindowsKey];
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    @synchronized (self) {
+        NSMutableDictionary *m = [self loadStats];
+        m[@"pendingWindows"] = @([NSUserDefaults.standardUserDefaults integerForKey:kASBGScanPendingWindowsKey]);
+        return m;
+    }
+}
+
+@end
@@ -0,0 +1,155 @@
+#include "ASBlurKernel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// MARK: - ROI
+
+void as_blur_center_roi(uint32_t width, uint32_t height,
+                        uint32_t *x0, uint32_t *y0, uint32_t *roiW, uint32_t *roiH) {
+    uint32_t rw = (uint32_t)lrintf((float)width * AS_BLUR_ROI_FRAC);
+    uint32_t rh = (uint32_t)lrintf((float)height * AS_BLUR_ROI_FRAC);
+    if (rw < 16) rw = 16;
+    if (rh < 16) rh = 16;
+    if (rw > width) rw = width;
+    if (rh > height) rh = height;
+    *x0 = (width - rw) / 2;
+    *y0 = (height - rh) / 2;
+    *roiW = rw;
+    *roiH = rh;
+}
+
+// vImageConvolve_Planar8（divisor 1）的输出截到 0~255，原实现再减 128 平方
+static inline uint32_t as_grad_sq(int g) {
+    g = g < 0 ? 0 : (g > 255 ? 255 : g);
+    g -= 128;
+    return (uint32_t)(g * g);
+}
+
+// 一个像素的 gx² + gy²；l / c / r 为左中右列下标（边缘处复制）
+static inline uint32_t as_sobel_px(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2,
+                                   uint32_t l, uint32_t c, uint32_t r) {
+    int gx = ((int)r0[r] - r0[l]) + 2 * ((int)r1[r] - r1[l]) + ((int)r2[r] - r2[l]);
+    int gy = ((int)r2[l] + 2 * r2[c] + r2[r]) - ((int)r0[l] + 2 * r0[c] + r0[r]);
+    return as_grad_sq(gx) + as_grad_sq(gy);
+}
+
+// 写入均值 / 标准差；返回是否够亮、够有层次（否则不判模糊）
+static inline int as_finish(uint64_t sum, uint64_t sum2, uint64_t n, ASBlurStats *out) {
+    double mean = (double)sum / (double)(n ? n : 1);
+    double var = (double)sum2 / (double)(n ? n : 1) - mean * mean;
+    if (var < 0) var = 0;
+    double std = sqrt(var);
+    out->mean = (float)mean;
+    out->std = (float)std;
+    return mean > AS_BLUR_MIN_MEAN && std > AS_BLUR_MIN_STD;
+}
+
+// MARK: - Fused
+
+// 上中下三行的 Sobel 平方和（整行，边缘复制）
+static uint64_t as_sobel_row(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2, uint32_t w) {
+    uint64_t acc = as_sobel_px(r0, r1, r2, 0, 0, 1);
+    for (uint32_t x = 1; x + 1 < w; x++) {
+        int gx = ((int)r0[x + 1] - r0[x - 1]) + 2 * ((int)r1[x + 1] - r1[x - 1]) + ((int)r2[x + 1] - r2[x - 1]);
+        int gy = ((int)r2[x - 1] + 2 * r2[x] + r2[x + 1]) - ((int)r0[x - 1] + 2 * r0[x] + r0[x + 1]);
+        acc += as_grad_sq(gx) + as_grad_sq(gy);
+    }
+    acc += as_sobel_px(r0, r1, r2, w - 2, w - 1, w - 1);
+    return acc;
+}
+
+void as_blur_stats(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride,
+                   ASBlurStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->score = -1.f;
+    if (!gray || width == 0 || height == 0) return;
+
+    uint32_t x0, y0, w, h;
+    as_blur_center_roi(width, height, &x0, &y0, &w, &h);
+    const uint8_t *base = gray + (size_t)y0 * stride + x0;
+    const uint64_t n = (uint64_t)w * h;
+
+    const int withGrad = w >= 5 && h >= 5;
+    uint64_t sum = 0, sum2 = 0, grad = 0;
+    for (uint32_t y = 0; y < h; y++) {
+        const uint8_t *r1 = base + (size_t)y * stride;
+        uint64_t rs = 0, rs2 = 0;
+        for (uint32_t x = 0; x < w; x++) { uint32_t v = r1[x]; rs += v; rs2 += v * v; }
+        sum += rs; sum2 += rs2;
+
+        if (!withGrad) continue;
+        const uint8_t *r0 = y > 0 ? r1 - stride : r1;
+        const uint8_t *r2 = y + 1 < h ? r1 + stride : r1;
+        grad += as_sobel_row(r0, r1, r2, w);
+    }
+
+    if (!as_finish(sum, sum2, n, out)) return;
+    out->score = withGrad ? (float)((double)grad / (double)n) : 0.f;
+}
+
+// MARK: - Reference
+
+// 3×3 卷积（按原样套用），EdgeExtend，输出截到 0~255
+static void as_convolve3x3(const uint8_t *src, uint32_t w, uint32_t h, const int k[9], uint8_t *dst) {
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            int acc = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                int yy = (int)y + dy;
+                yy = yy < 0 ? 0 : (yy >= (int)h ? (int)h - 1 : yy);
+                for (int dx = -1; dx <= 1; dx++) {
+                    int xx = (int)x + dx;
+                    xx = xx < 0 ? 0 : (xx >= (int)w ? (int)w - 1 : xx);
+                    acc += k[(dy + 1) * 3 + (dx + 1)] * src[(size_t)yy * w + xx];
+                }
+            }
+            dst[(size_t)y * w + x] = (uint8_t)(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+        }
+    }
+}
+
+void as_blur_stats_reference(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride,
+                             ASBlurStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->score = -1.f;
+    if (!gray || width == 0 || height == 0) return;
+
+    uint32_t x0, y0, w, h;
+    as_blur_center_roi(width, height, &x0, &y0, &w, &h);
+    const uint64_t n = (uint64_t)w * h;
+
+    uint8_t *roi = malloc(n);
+    if (!roi) return;
+    for (uint32_t y = 0; y < h; y++) memcpy(roi + (size_t)y * w, gray + (size_t)(y0 + y) * stride + x0, w);
+
+    double sum = 0, sum2 = 0;
+    for (uint64_t i = 0; i < n; i++) { double v = roi[i]; sum += v; sum2 += v * v; }
+    double mean = sum / (double)n;
+    double var = sum2 / (double)n - mean * mean;
+    if (var < 0) var = 0;
+    out->mean = (float)mean;
+    out->std = (float)sqrt(var);
+
+    if (mean > AS_BLUR_MIN_MEAN && sqrt(var) > AS_BLUR_MIN_STD) {
+        if (w < 5 || h < 5) {
+            out->score = 0.f;
+        } else {
+            static const int kx[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 };
+            static const int ky[9] = { -1, -2, -1, 0, 0, 0, 1, 2, 1 };
+            uint8_t *gx = malloc(n), *gy = malloc(n);
+            if (gx && gy) {
+                as_convolve3x3(roi, w, h, kx, gx);
+                as_convolve3x3(roi, w, h, ky, gy);
+                uint64_t acc = 0;
+                for (uint64_t i = 0; i < n; i++) { int d = (int)gx[i] - 128; acc += (uint64_t)(d * d); }
+                for (uint64_t i = 0; i < n; i++) { int d = (int)gy[i] - 128; acc += (uint64_t)(d * d); }
+                out->score = (float)((double)acc / (double)n);
+            }
+            free(gx);
+            free(gy);
+        }
+    }
+    free(roi);
+}
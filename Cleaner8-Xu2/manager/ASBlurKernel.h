@@ -0,0 +1,48 @@
+#ifndef ASBlurKernel_h
+#define ASBlurKernel_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 模糊度内核（纯 C，可在 Linux 上编译做校验 / benchmark）
+///
+/// 输入：8-bit 灰度图（任意行跨度），取中心 AS_BLUR_ROI_FRAC 的 ROI，原地读取不拷贝。
+/// 输出：ROI 的亮度均值 / 标准差 + Tenengrad 分数（越小越模糊）。
+/// 分数定义沿用原 vImage 两趟实现（vImageConvolve_Planar8，Sobel 按原样不翻转套用，
+/// divisor 1，EdgeExtend）：每个像素的 gx、gy 先截到 0~255，再减 128 平方，两者求和后除以像素数。
+/// 特征库里存的分数都是这个口径，快速版与参考版逐位相同。
+///
+/// 快速版一趟按行流式处理：同一行上统计亮度、算 Sobel，不分配任何缓冲。
+/// 分数总是完整算出（会进 memo / 特征库，也会在 K 变化后重新排序），不做提前退出。
+
+#define AS_BLUR_ROI_FRAC   0.60f
+#define AS_BLUR_MIN_MEAN   20.0   // 过暗
+#define AS_BLUR_MIN_STD    8.0    // 过平
+
+typedef struct {
+    float mean;
+    float std;
+    float score;        // -1 = 过暗 / 过平，不参与模糊判定
+} ASBlurStats;
+
+/// 中心 ROI（与原实现同一取法；图比 16 像素还小时取整图）
+void as_blur_center_roi(uint32_t width, uint32_t height,
+                        uint32_t *x0, uint32_t *y0, uint32_t *roiW, uint32_t *roiH);
+
+/// 快速版
+void as_blur_stats(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride,
+                   ASBlurStats *out);
+
+/// 原实现（ROI 拷贝成连续内存，统计一趟，gx / gy 各一块缓冲两次卷积），用于逐位校验
+void as_blur_stats_reference(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride,
+                             ASBlurStats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASBlurKernel_h */
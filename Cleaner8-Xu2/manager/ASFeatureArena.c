@@ -0,0 +1,125 @@
+#include "ASFeatureArena.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AS_ROWS_PER_CHUNK 256u
+
+// 4 路 float 向量（clang / gcc 通用写法，ARM 上即 NEON）
+typedef float as_f4 __attribute__((vector_size(16)));
+
+static inline as_f4 as_f4_load(const float *p) {
+    as_f4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline float as_f4_sum(as_f4 v) {
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+struct ASFeatureArena {
+    uint32_t dim;
+    uint32_t count;
+    float **chunks;
+    uint32_t chunkCount, chunkCap;
+};
+
+ASFeatureArena *as_feature_arena_create(uint32_t dim) {
+    if (dim == 0) return NULL;
+    ASFeatureArena *a = (ASFeatureArena *)calloc(1, sizeof(ASFeatureArena));
+    if (a) a->dim = dim;
+    return a;
+}
+
+void as_feature_arena_destroy(ASFeatureArena *a) {
+    if (!a) return;
+    for (uint32_t i = 0; i < a->chunkCount; i++) free(a->chunks[i]);
+    free(a->chunks);
+    free(a);
+}
+
+uint32_t as_feature_arena_dim(const ASFeatureArena *a) { return a->dim; }
+uint32_t as_feature_arena_count(const ASFeatureArena *a) { return a->count; }
+
+uint32_t as_feature_arena_add(ASFeatureArena *a, const float *row) {
+    uint32_t c = a->count / AS_ROWS_PER_CHUNK;
+    if (c == a->chunkCount) {
+        if (a->chunkCount == a->chunkCap) {
+            uint32_t cap = a->chunkCap ? a->chunkCap * 2 : 16;
+            float **p = (float **)realloc(a->chunks, cap * sizeof(float *));
+            if (!p) return UINT32_MAX;
+            a->chunks = p;
+            a->chunkCap = cap;
+        }
+        // 16 字节对齐，行长是 4 的倍数时每行都对齐
+        float *chunk = NULL;
+        if (posix_memalign((void **)&chunk, 16, (size_t)AS_ROWS_PER_CHUNK * a->dim * sizeof(float)) != 0) return UINT32_MAX;
+        a->chunks[a->chunkCount++] = chunk;
+    }
+    uint32_t slot = a->count++;
+    memcpy(a->chunks[c] + (size_t)(slot % AS_ROWS_PER_CHUNK) * a->dim, row, (size_t)a->dim * sizeof(float));
+    return slot;
+}
+
+const float *as_feature_arena_row(const ASFeatureArena *a, uint32_t slot) {
+    if (slot >= a->count) return NULL;
+    return a->chunks[slot / AS_ROWS_PER_CHUNK] + (size_t)(slot % AS_ROWS_PER_CHUNK) * a->dim;
+}
+
+// MARK: - Distance
+
+float as_feature_l2(const float *a, const float *b, uint32_t dim) {
+    as_f4 s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0};
+    uint32_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        as_f4 d0 = as_f4_load(a + i)      - as_f4_load(b + i);
+        as_f4 d1 = as_f4_load(a + i + 4)  - as_f4_load(b + i + 4);
+        as_f4 d2 = as_f4_load(a + i + 8)  - as_f4_load(b + i + 8);
+        as_f4 d3 = as_f4_load(a + i + 12) - as_f4_load(b + i + 12);
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+        s2 += d2 * d2;
+        s3 += d3 * d3;
+    }
+    float sum = as_f4_sum((s0 + s1) + (s2 + s3));
+    for (; i < dim; i++) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sqrtf(sum);
+}
+
+void as_feature_l2_batch(const float *q, const float *const *rows, uint32_t n, uint32_t dim, float *out) {
+    uint32_t r = 0;
+    for (; r + 4 <= n && dim % 4 == 0; r += 4) {
+        const float *b0 = rows[r], *b1 = rows[r + 1], *b2 = rows[r + 2], *b3 = rows[r + 3];
+        as_f4 s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0};
+        for (uint32_t i = 0; i < dim; i += 4) {
+            as_f4 qv = as_f4_load(q + i);
+            as_f4 d0 = qv - as_f4_load(b0 + i);
+            as_f4 d1 = qv - as_f4_load(b1 + i);
+            as_f4 d2 = qv - as_f4_load(b2 + i);
+            as_f4 d3 = qv - as_f4_load(b3 + i);
+            s0 += d0 * d0;
+            s1 += d1 * d1;
+            s2 += d2 * d2;
+            s3 += d3 * d3;
+        }
+        out[r]     = sqrtf(as_f4_sum(s0));
+        out[r + 1] = sqrtf(as_f4_sum(s1));
+        out[r + 2] = sqrtf(as_f4_sum(s2));
+        out[r + 3] = sqrtf(as_f4_sum(s3));
+    }
+    for (; r < n; r++) out[r] = as_feature_l2(q, rows[r], dim);
+}
+
+float as_feature_l2_reference(const float *a, const float *b, uint32_t dim) {
+    double sum = 0;
+    for (uint32_t i = 0; i < dim; i++) {
+        double d = (double)a[i] - (double)b[i];
+        sum += d * d;
+    }
+    return (float)sqrt(sum);
+}
@@ -0,0 +1,47 @@
+#ifndef ASFeatureArena_h
+#define ASFeatureArena_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Vision 特征（VNFeaturePrintObservation 的原始 float32 向量）的连续存储 + L2 距离内核
+/// （纯 C，可在 Linux 上编译做校验 / benchmark）
+///
+/// - 维度由创建时指定（Revision1 = 2048，Revision2 = 768），所有行同维。
+/// - 按 256 行一块分配，块一旦分配不再移动：行指针在 arena 销毁前一直有效，
+///   调用方可以直接引用行内存（不必再拷贝一份）。
+/// - 距离与 computeDistance:toFeaturePrintObservation: 同口径：欧氏距离 sqrt(Σ(a-b)²)。
+
+typedef struct ASFeatureArena ASFeatureArena;
+
+ASFeatureArena *as_feature_arena_create(uint32_t dim);
+void as_feature_arena_destroy(ASFeatureArena *a);
+
+uint32_t as_feature_arena_dim(const ASFeatureArena *a);
+uint32_t as_feature_arena_count(const ASFeatureArena *a);
+
+/// 拷贝一行，返回行号（从 0 递增）；失败返回 UINT32_MAX
+uint32_t as_feature_arena_add(ASFeatureArena *a, const float *row);
+
+const float *as_feature_arena_row(const ASFeatureArena *a, uint32_t slot);
+
+// MARK: - Distance
+
+/// 4 路向量、4 组独立累加
+float as_feature_l2(const float *a, const float *b, uint32_t dim);
+
+/// q 对 n 行求距离，每次取 4 行共用 q 的读取
+void as_feature_l2_batch(const float *q, const float *const *rows, uint32_t n, uint32_t dim, float *out);
+
+/// 标量 double 累加，用于校验
+float as_feature_l2_reference(const float *a, const float *b, uint32_t dim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASFeatureArena_h */
@@ -0,0 +1,42 @@
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(NSUInteger, ASFeatureMask) {
+    ASFeatureMaskPHash = 1 << 0,   // 256-bit 彩色 pHash
+    ASFeatureMaskBlur  = 1 << 1,   // Tenengrad 清晰度 + 亮度均值/标准差
+};
+
+/// 一张缩略图上算出来的特征
+@interface ASImageFeatures : NSObject
+@property (nonatomic, strong, nullable) NSData *phash256Data;
+@property (nonatomic, assign) float blurScore;  // -1 = 过暗/过平，不参与模糊判定
+@property (nonatomic, assign) float lumaMean;   // 中心 60% ROI 的亮度均值（0~255）
+@property (nonatomic, assign) float lumaStd;
+@end
+
+/// 单次解码特征提取：一张 512 缩略图 -> pHash + 模糊度 + 曝光统计；
+/// 缩略图短暂保留，Vision 特征按需（分组命中时）复用，不再重新请求。
+/// 像素缓冲走小对象池，线程安全，可在扫描并发队列里直接调用。
+@interface ASFeatureExtractor : NSObject
+
++ (instancetype)shared;
+
+- (ASImageFeatures *)extractFromImage:(UIImage *)image features:(ASFeatureMask)mask;
+
+/// 最近解码过的缩略图（按字节数上限淘汰），给 Vision 懒计算用
+- (void)rememberThumbnail:(UIImage *)image forLocalId:(NSString *)localId;
+- (nullable UIImage *)recentThumbnailForLocalId:(NSString *)localId;
+
+/// 计时（ms）：缩略图请求 / pHash / 模糊 / Vision
+- (void)recordThumbnailRequestMs:(double)ms;
+- (void)recordVisionMs:(double)ms reusedThumbnail:(BOOL)reused;
+
+/// decode / phash / blur / vision 的次数与累计耗时，以及 Vision 复用缩略图次数
+- (NSDictionary<NSString *, NSNumber *> *)timingStats;
+- (void)resetTimingStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,245 @@
+#import "ASFeatureExtractor.h"
+#import <Accelerate/Accelerate.h>
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+#import "ASBlurKernel.h"
+#import "ASPHashKernel.h"
+
+// 缓冲池：并发扫描最多 6 路，每路同时占用 2 块（RGBA + 灰度）
+static const NSUInteger kASPixelPoolMax = 12;
+// 为 Vision 保留的最近缩略图总字节上限
+static const NSUInteger kASRecentThumbBytes = 24 * 1024 * 1024;
+
+static inline double ASNowMs(void) { return CACurrentMediaTime() * 1000.0; }
+
+@implementation ASImageFeatures
+- (instancetype)init {
+    if (self = [super init]) { _blurScore = -1.f; }
+    return self;
+}
+@end
+
+#pragma mark - Pixel pool
+
+typedef struct {
+    void *ptr;
+    size_t cap;
+} ASPixelBlock;
+
+@interface ASFeatureExtractor ()
+@property (nonatomic, strong) NSCache<NSString *, UIImage *> *recentThumbs;
+@end
+
+@implementation ASFeatureExtractor {
+    os_unfair_lock _poolLock;
+    ASPixelBlock _free[kASPixelPoolMax];
+    NSUInteger _freeCount;
+
+    os_unfair_lock _statLock;
+    NSUInteger _decodeCount, _phashCount, _blurCount, _visionCount, _visionReuse;
+    double _decodeMs, _phashMs, _blurMs, _visionMs;
+}
+
++ (instancetype)shared {
+    static ASFeatureExtractor *s;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{ s = [ASFeatureExtractor new]; });
+    return s;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _poolLock = OS_UNFAIR_LOCK_INIT;
+        _statLock = OS_UNFAIR_LOCK_INIT;
+        _recentThumbs = [NSCache new];
+        _recentThumbs.totalCostLimit = kASRecentThumbBytes;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _freeCount; i++) free(_free[i].ptr);
+}
+
+// 取一块 >= size 的缓冲；优先复用池里最小的够用块
+- (ASPixelBlock)acquire:(size_t)size {
+    ASPixelBlock b = {0};
+    os_unfair_lock_lock(&_poolLock);
+    NSInteger best = -1;
+    for (NSUInteger i = 0; i < _freeCount; i++) {
+        if (_free[i].cap >= size && (best < 0 || _free[i].cap < _free[best].cap)) best = (NSInteger)i;
+    }
+    if (best >= 0) {
+        b = _free[best];
+        _free[best] = _free[--_freeCount];
+    }
+    os_unfair_lock_unlock(&_poolLock);
+
+    if (!b.ptr) {
+        b.ptr = malloc(size);
+        b.cap = b.ptr ? size : 0;
+    }
+    return b;
+}
+
+- (void)releaseBlock:(ASPixelBlock)b {
+    if (!b.ptr) return;
+    os_unfair_lock_lock(&_poolLock);
+    if (_freeCount < kASPixelPoolMax) {
+        _free[_freeCount++] = b;
+        b.ptr = NULL;
+    }
+    os_unfair_lock_unlock(&_poolLock);
+    free(b.ptr);
+}
+
+#pragma mark - Extract
+
+- (ASImageFeatures *)extractFromImage:(UIImage *)image features:(ASFeatureMask)mask {
+    ASImageFeatures *f = [ASImageFeatures new];
+    CGImageRef cg = image.CGImage;
+    if (!cg) return f;
+
+    if (mask & ASFeatureMaskPHash) {
+        double t0 = ASNowMs();
+        f.phash256Data = [self phash256FromCGImage:cg];
+        [self addPHashMs:ASNowMs() - t0];
+    }
+    if (mask & ASFeatureMaskBlur) {
+        double t0 = ASNowMs();
+        [self blurStatsFromCGImage:cg into:f];
+        [self addBlurMs:ASNowMs() - t0];
+    }
+    return f;
+}
+
+- (NSData *)phash256FromCGImage:(CGImageRef)cg {
+    uint64_t hash[4] = {0,0,0,0};
+
+    const int side = AS_PHASH_SIDE;
+    uint8_t pixels[AS_PHASH_SIDE * AS_PHASH_SIDE * 4];
+    memset(pixels, 0, sizeof(pixels));
+
+    CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
+    CGContextRef ctx = CGBitmapContextCreate(
+        pixels, side, side, 8, side * 4, cs,
+        (CGBitmapInfo)kCGImageAlphaPremultipliedLast
+    );
+    CGColorSpaceRelease(cs);
+    if (!ctx) return [NSData dataWithBytes:hash length:32];
+
+    CGContextDrawImage(ctx, CGRectMake(0, 0, side, side), cg);
+    CGContextRelease(ctx);
+
+    // 亮度增强 + 只算左上 16×16 的 DCT + quickselect 中位数（与原标量实现逐位一致）
+    as_phash256_from_rgba(pixels, hash);
+    return [NSData dataWithBytes:hash length:32];
+}
+
+// 灰度矩阵直接作用在 RGBA 上（省掉通道重排），之后中心 ROI 的亮度统计与 Sobel 在灰度图上
+// 原地一趟算完（ASBlurKernel），不拷贝 ROI、不分配梯度缓冲；分数口径与原两趟 vImage 实现逐位相同。
+- (void)blurStatsFromCGImage:(CGImageRef)cg into:(ASImageFeatures *)f {
+    const size_t w = CGImageGetWidth(cg);
+    const size_t h = CGImageGetHeight(cg);
+    if (w == 0 || h == 0) return;
+
+    ASPixelBlock rgbaBlk = [self acquire:w * h * 4];
+    ASPixelBlock grayBlk = [self acquire:w * h];
+    if (!rgbaBlk.ptr || !grayBlk.ptr) {
+        [self releaseBlock:rgbaBlk];
+        [self releaseBlock:grayBlk];
+        return;
+    }
+
+    vImage_Buffer rgba = { rgbaBlk.ptr, h, w, w * 4 };
+    vImage_Buffer gray = { grayBlk.ptr, h, w, w };
+
+    BOOL ok = NO;
+    CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
+    CGContextRef ctx = CGBitmapContextCreate(
+        rgba.data, w, h, 8, rgba.rowBytes, cs,
+        (CGBitmapInfo)kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big
+    );
+    CGColorSpaceRelease(cs);
+    if (ctx) {
+        CGContextDrawImage(ctx, CGRectMake(0, 0, w, h), cg);
+        CGContextRelease(ctx);
+
+        // 内存顺序 R,G,B,A；系数 *256
+        const int16_t mtx[4] = {77, 150, 29, 0};
+        ok = vImageMatrixMultiply_ARGB8888ToPlanar8(&rgba, &gray, mtx, 256, NULL, 0, kvImageNoFlags) == kvImageNoError;
+    }
+    [self releaseBlock:rgbaBlk];
+
+    if (ok) {
+        ASBlurStats st;
+        as_blur_stats(gray.data, (uint32_t)w, (uint32_t)h, gray.rowBytes, &st);
+        f.lumaMean = st.mean;
+        f.lumaStd = st.std;
+        f.blurScore = st.score;
+    }
+    [self releaseBlock:grayBlk];
+}
+
+#pragma mark - Recent thumbnails
+
+- (void)rememberThumbnail:(UIImage *)image forLocalId:(NSString *)localId {
+    CGImageRef cg = image.CGImage;
+    if (!cg || !localId.length) return;
+    NSUInteger cost = CGImageGetBytesPerRow(cg) * CGImageGetHeight(cg);
+    [self.recentThumbs setObject:image forKey:localId cost:cost];
+}
+
+- (UIImage *)recentThumbnailForLocalId:(NSString *)localId {
+    if (!localId.length) return nil;
+    return [self.recentThumbs objectForKey:localId];
+}
+
+#pragma mark - Timings
+
+- (void)addPHashMs:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _phashCount += 1; _phashMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)addBlurMs:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _blurCount += 1; _blurMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)recordThumbnailRequestMs:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _decodeCount += 1; _decodeMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)recordVisionMs:(double)ms reusedThumbnail:(BOOL)reused {
+    os_unfair_lock_lock(&_statLock);
+    _visionCount += 1; _visionMs += ms;
+    if (reused) _visionReuse += 1;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)timingStats {
+    os_unfair_lock_lock(&_statLock);
+    NSDictionary *d = @{
+        @"decodeCount": @(_decodeCount), @"decodeMs": @(_decodeMs),
+        @"phashCount":  @(_phashCount),  @"phashMs":  @(_phashMs),
+        @"blurCount":   @(_blurCount),   @"blurMs":   @(_blurMs),
+        @"visionCount": @(_visionCount), @"visionMs": @(_visionMs),
+        @"visionThumbReuse": @(_visionReuse),
+    };
+    os_unfair_lock_unlock(&_statLock);
+    return d;
+}
+
+- (void)resetTimingStats {
+    os_unfair_lock_lock(&_statLock);
+    _decodeCount = _phashCount = _blurCount = _visionCount = _visionReuse = 0;
+    _decodeMs = _phashMs = _blurMs = _visionMs = 0;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+@end
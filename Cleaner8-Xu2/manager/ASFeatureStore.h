@@ -0,0 +1,53 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 一条已算好的特征；没有的字段：hasFileSize / hasBlur = NO，phash256Data / visionFeature / videoFingerprint = nil
+@interface ASStoredFeatures : NSObject
+@property (nonatomic) BOOL hasFileSize;
+@property (nonatomic) uint64_t fileSize;
+@property (nonatomic) uint64_t photoBytes;          // fileSize 的拆分（随 hasFileSize），见 ASAssetSizeService
+@property (nonatomic) uint64_t videoBytes;
+@property (nonatomic) uint64_t pairedVideoBytes;
+@property (nonatomic) uint64_t adjustmentBytes;
+@property (nonatomic, strong, nullable) NSData *phash256Data;   // 32 字节
+@property (nonatomic) BOOL hasBlur;
+@property (nonatomic) float blurScore;
+@property (nonatomic) float lumaMean;
+@property (nonatomic) float lumaStd;
+@property (nonatomic, strong, nullable) NSData *visionFeature;  // float32
+@property (nonatomic, strong, nullable) NSData *videoFingerprint;   // ASVideoFingerprint
+@end
+
+/// 持久化特征库：(localId, modificationDate) -> 文件大小 / pHash256 / 模糊度 / Vision 特征 / 视频指纹
+///
+/// 资产没被编辑就不用再解码：增量重建、续扫、重新全量扫描只为新增或被编辑的资产算特征。
+/// 文件是追加写的（见 ASFeatureStoreFormat.h），读取走映射内存；首次访问时才打开。
+/// 查询 / 写入线程安全（decode 线程并发调用）；flush 只在调用方的串行 IO 队列上调用。
+@interface ASFeatureStore : NSObject
+
+/// extractorVersion 变化（算法 / Vision revision 升级）时旧文件整体作废
+- (instancetype)initWithPath:(NSString *)path extractorVersion:(uint32_t)extractorVersion;
+
+@property (nonatomic, copy, readonly) NSString *path;
+
+/// modMs：modificationDate（没有则 creationDate）的毫秒时间戳；不一致即视为未命中
+- (nullable ASStoredFeatures *)featuresForLocalId:(NSString *)localId
+                                   modificationMs:(int64_t)modMs
+                                   includeFeature:(BOOL)includeFeature;
+
+/// 与已有同 modMs 的记录合并，只追加新字段
+- (void)storeFeatures:(ASStoredFeatures *)features forLocalId:(NSString *)localId modificationMs:(int64_t)modMs;
+
+- (void)removeLocalIds:(NSArray<NSString *> *)localIds;
+
+/// 把新写入的记录追加到文件（必要时压缩）
+- (void)flush;
+
+/// hits / misses / stale（被编辑过）/ puts / entries / liveBytes / deadBytes / pendingBytes
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+- (void)resetStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
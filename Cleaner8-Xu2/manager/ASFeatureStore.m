@@ -0,0 +1,235 @@
+#import "ASFeatureStore.h"
+#import <os/lock.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import "ASFeatureStoreFormat.h"
+
+// 死字节超过活字节且文件超过此大小时压缩
+static const size_t kASFeatureStoreCompactMinBytes = 4 * 1024 * 1024;
+
+@implementation ASStoredFeatures
+@end
+
+@implementation ASFeatureStore {
+    os_unfair_lock _lock;
+    ASFStore *_store;
+    NSData *_mapped;        // 已落盘部分的映射，索引里的偏移指向它
+    BOOL _opened;
+}
+
+- (instancetype)initWithPath:(NSString *)path extractorVersion:(uint32_t)extractorVersion {
+    if (self = [super init]) {
+        _path = [path copy];
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _store = as_fstore_create(extractorVersion);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_fstore_destroy(_store);
+}
+
+#pragma mark - File
+
+static NSData *ASMapFile(NSString *path) {
+    NSData *d = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+    return d.length > 0 ? d : nil;
+}
+
+// 首次访问时打开；半截尾记录截掉，版本不符则下次 flush 整体重写。调用方持锁
+- (void)as_openLocked {
+    if (_opened) return;
+    _opened = YES;
+
+    NSData *map = ASMapFile(self.path);
+    if (!map) return;
+    size_t valid = as_fstore_open(_store, map.bytes, map.length);
+    if (valid == 0) return;
+    if (valid < map.length) {
+        truncate(self.path.fileSystemRepresentation, (off_t)valid);
+        map = ASMapFile(self.path);
+        valid = map ? as_fstore_open(_store, map.bytes, map.length) : 0;
+        if (valid == 0) return;
+    }
+    _mapped = map;
+}
+
+static BOOL ASWriteAll(int fd, const uint8_t *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) return NO;
+        p += n;
+        len -= (size_t)n;
+    }
+    return YES;
+}
+
+- (void)flush {
+    os_unfair_lock_lock(&_lock);
+    [self as_openLocked];
+
+    // 压缩：整体重写（很少发生），期间持锁
+    if (as_fstore_should_compact(_store, kASFeatureStoreCompactMinBytes)) {
+        uint8_t *img = NULL;
+        size_t len = 0;
+        if (as_fstore_compact(_store, &img, &len)) {
+            NSData *d = [[NSData alloc] initWithBytesNoCopy:img length:len freeWhenDone:YES];
+            if ([d writeToFile:self.path atomically:YES]) {
+                NSData *map = ASMapFile(self.path);
+                if (map && as_fstore_open(_store, map.bytes, map.length) == map.length) _mapped = map;
+                [self as_protectFile];
+            }
+        }
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+
+    const uint8_t *bytes = NULL;
+    size_t len = 0;
+    int rewrite = 0;
+    as_fstore_pending(_store, &bytes, &len, &rewrite);
+    if (len == 0) {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    NSData *pending = [NSData dataWithBytes:bytes length:len];
+    os_unfair_lock_unlock(&_lock);
+
+    // 写文件不持锁：期间新写入的记录留在尾部，rebase 只消费已写出的部分
+    BOOL ok;
+    if (rewrite) {
+        ok = [pending writeToFile:self.path atomically:YES];
+        if (ok) [self as_protectFile];
+    } else {
+        int fd = open(self.path.fileSystemRepresentation, O_WRONLY | O_APPEND);
+        ok = fd >= 0 && ASWriteAll(fd, pending.bytes, pending.length);
+        if (fd >= 0) close(fd);
+    }
+    if (!ok) {
+        NSLog(@"[FSTORE] write failed bytes=%lu rewrite=%d", (unsigned long)pending.length, rewrite);
+        return;
+    }
+
+    NSData *map = ASMapFile(self.path);
+    os_unfair_lock_lock(&_lock);
+    if (map && as_fstore_rebase(_store, map.bytes, map.length)) _mapped = map;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)as_protectFile {
+    [[NSFileManager defaultManager] setAttributes:@{NSFileProtectionKey: NSFileProtectionCompleteUntilFirstUserAuthentication}
+                                     ofItemAtPath:self.path
+                                            error:nil];
+}
+
+#pragma mark - Access
+
+- (ASStoredFeatures *)featuresForLocalId:(NSString *)localId modificationMs:(int64_t)modMs includeFeature:(BOOL)includeFeature {
+    const char *lid = localId.UTF8String;
+    if (!lid) return nil;
+    uint32_t len = (uint32_t)strlen(lid);
+
+    os_unfair_lock_lock(&_lock);
+    [self as_openLocked];
+    ASFeatureEntry e;
+    if (!as_fstore_get(_store, lid, len, modMs, &e)) {
+        os_unfair_lock_unlock(&_lock);
+        return nil;
+    }
+    ASStoredFeatures *f = [ASStoredFeatures new];
+    f.hasFileSize = (e.flags & AS_FSTORE_HAS_SIZE) != 0;
+    f.fileSize = e.fileSize;
+    f.photoBytes = e.sizeParts[AS_FSTORE_PART_PHOTO];
+    f.videoBytes = e.sizeParts[AS_FSTORE_PART_VIDEO];
+    f.pairedVideoBytes = e.sizeParts[AS_FSTORE_PART_PAIRED_VIDEO];
+    f.adjustmentBytes = e.sizeParts[AS_FSTORE_PART_ADJUSTMENT];
+    if (e.flags & AS_FSTORE_HAS_PHASH) f.phash256Data = [NSData dataWithBytes:e.phash length:sizeof(e.phash)];
+    f.hasBlur = (e.flags & AS_FSTORE_HAS_BLUR) != 0;
+    f.blurScore = e.blurScore;
+    f.lumaMean = e.lumaMean;
+    f.lumaStd = e.lumaStd;
+    if (includeFeature && e.feature) {
+        f.visionFeature = [NSData dataWithBytes:e.feature length:(NSUInteger)e.featureCount * sizeof(float)];
+    }
+    if (e.video) f.videoFingerprint = [NSData dataWithBytes:e.video length:e.videoLen];
+    os_unfair_lock_unlock(&_lock);
+    return f;
+}
+
+- (void)storeFeatures:(ASStoredFeatures *)features forLocalId:(NSString *)localId modificationMs:(int64_t)modMs {
+    const char *lid = localId.UTF8String;
+    if (!lid || !features) return;
+
+    ASFeatureEntry e;
+    memset(&e, 0, sizeof(e));
+    if (features.hasFileSize) {
+        e.flags |= AS_FSTORE_HAS_SIZE;
+        e.fileSize = features.fileSize;
+        e.sizeParts[AS_FSTORE_PART_PHOTO] = features.photoBytes;
+        e.sizeParts[AS_FSTORE_PART_VIDEO] = features.videoBytes;
+        e.sizeParts[AS_FSTORE_PART_PAIRED_VIDEO] = features.pairedVideoBytes;
+        e.sizeParts[AS_FSTORE_PART_ADJUSTMENT] = features.adjustmentBytes;
+    }
+    if (features.phash256Data.length >= sizeof(e.phash)) {
+        e.flags |= AS_FSTORE_HAS_PHASH;
+        memcpy(e.phash, features.phash256Data.bytes, sizeof(e.phash));
+    }
+    if (features.hasBlur) {
+        e.flags |= AS_FSTORE_HAS_BLUR;
+        e.blurScore = features.blurScore;
+        e.lumaMean = features.lumaMean;
+        e.lumaStd = features.lumaStd;
+    }
+    NSData *feature = features.visionFeature;
+    if (feature.length >= sizeof(float)) {
+        e.flags |= AS_FSTORE_HAS_FEATURE;
+        e.feature = (const float *)feature.bytes;
+        e.featureCount = (uint32_t)(feature.length / sizeof(float));
+    }
+    NSData *video = features.videoFingerprint;
+    if (video.length > 0) {
+        e.flags |= AS_FSTORE_HAS_VIDEO;
+        e.video = video.bytes;
+        e.videoLen = (uint32_t)video.length;
+    }
+    if (e.flags == 0) return;
+
+    os_unfair_lock_lock(&_lock);
+    [self as_openLocked];
+    as_fstore_put(_store, lid, (uint32_t)strlen(lid), modMs, &e);
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)removeLocalIds:(NSArray<NSString *> *)localIds {
+    if (localIds.count == 0) return;
+    os_unfair_lock_lock(&_lock);
+    [self as_openLocked];
+    for (NSString *localId in localIds) {
+        const char *lid = localId.UTF8String;
+        if (lid) as_fstore_remove(_store, lid, (uint32_t)strlen(lid));
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+#pragma mark - Stats
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    ASFeatureStoreStats s;
+    os_unfair_lock_lock(&_lock);
+    as_fstore_stats(_store, &s);
+    os_unfair_lock_unlock(&_lock);
+    return @{
+        @"hits": @(s.hits), @"misses": @(s.misses), @"stale": @(s.stale), @"puts": @(s.puts),
+        @"entries": @(s.entries), @"liveBytes": @(s.liveBytes), @"deadBytes": @(s.deadBytes),
+        @"pendingBytes": @(s.pendingBytes),
+    };
+}
+
+- (void)resetStats {
+    os_unfair_lock_lock(&_lock);
+    as_fstore_reset_counters(_store);
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
@@ -0,0 +1,450 @@
+#include "ASFeatureStoreFormat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t extractorVersion;
+    uint32_t reserved[5];
+} ASFStoreHeader;           // 32 字节
+
+typedef struct {
+    uint32_t size;          // 整条记录字节数（8 对齐）
+    uint16_t flags;
+    uint16_t idLen;
+    uint64_t checksum;      // idHash 起到记录末尾的校验
+    uint64_t idHash;
+    int64_t  modMs;
+    uint64_t fileSize;
+    uint64_t sizeParts[AS_FSTORE_SIZE_PARTS];
+    uint64_t phash[4];
+    float    blurScore, lumaMean, lumaStd;
+    uint32_t featureCount;
+    uint32_t videoLen;
+    uint32_t reserved;
+} ASFStoreRecord;           // 128 字节，之后依次是 localId、float32 特征、视频指纹（各自补齐到 8）
+
+_Static_assert(sizeof(ASFStoreHeader) == 32, "header layout");
+_Static_assert(sizeof(ASFStoreRecord) == 128, "record layout");
+
+#define AS_SLOT_EMPTY UINT64_MAX
+#define AS_SLOT_GONE  (UINT64_MAX - 1)
+
+struct ASFStore {
+    uint32_t extractorVersion;
+
+    const uint8_t *base;    // 已落盘部分（调用方持有的映射）
+    size_t baseLen;
+    uint8_t *tail;          // 未落盘的追加，全局偏移 = baseLen + i
+    size_t tailLen, tailCap;
+    int needsRewrite;       // 文件需整体重写（tail 以 Header 开头）
+
+    uint64_t *keys;
+    uint64_t *offs;
+    uint32_t cap, used, live;
+
+    uint64_t liveBytes, deadBytes;
+    uint64_t hits, misses, stale, puts;
+};
+
+static inline size_t as_align8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+static uint64_t as_fs_hash(const void *bytes, size_t len, uint64_t h) {
+    const uint8_t *p = (const uint8_t *)bytes;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h ^= w;
+        h *= 0x100000001B3ull;
+    }
+    for (; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+    return h ^ (h >> 29);
+}
+
+static inline uint64_t as_fs_id_hash(const char *id, uint32_t len) {
+    return as_fs_hash(id, len, 0x84222325CBF29CE4ull);
+}
+
+static inline uint64_t as_fs_record_checksum(const uint8_t *rec, uint32_t size) {
+    return as_fs_hash(rec + 16, size - 16, 0xCBF29CE484222325ull);
+}
+
+static inline size_t as_fs_record_size(uint32_t idLen, uint32_t featureCount, uint32_t videoLen) {
+    return sizeof(ASFStoreRecord) + as_align8(idLen) + as_align8((size_t)featureCount * sizeof(float)) + as_align8(videoLen);
+}
+
+static inline const ASFStoreRecord *as_fs_rec(const ASFStore *s, uint64_t off) {
+    if (off < s->baseLen) return (const ASFStoreRecord *)(s->base + off);
+    return (const ASFStoreRecord *)(s->tail + (off - s->baseLen));
+}
+
+// MARK: - Index
+
+static void as_fs_index_clear(ASFStore *s) {
+    free(s->keys); free(s->offs);
+    s->keys = NULL; s->offs = NULL;
+    s->cap = s->used = s->live = 0;
+}
+
+static uint32_t as_fs_slot(const ASFStore *s, uint64_t key) {
+    uint32_t mask = s->cap - 1;
+    uint32_t i = (uint32_t)(key * 0x9E3779B97F4A7C15ull >> 32) & mask;
+    while (s->offs[i] != AS_SLOT_EMPTY && s->keys[i] != key) i = (i + 1) & mask;
+    return i;
+}
+
+static int as_fs_index_grow(ASFStore *s) {
+    uint32_t cap = s->cap ? s->cap : 1024;
+    while (cap < (s->live + 1) * 2) cap *= 2;
+    if (s->used + 1 > cap / 2) cap *= 2;
+
+    uint64_t *oldKeys = s->keys, *oldOffs = s->offs;
+    uint32_t oldCap = s->cap;
+    s->keys = (uint64_t *)malloc((size_t)cap * sizeof(uint64_t));
+    s->offs = (uint64_t *)malloc((size_t)cap * sizeof(uint64_t));
+    if (!s->keys || !s->offs) {
+        free(s->keys); free(s->offs);
+        s->keys = oldKeys; s->offs = oldOffs;
+        return 0;
+    }
+    memset(s->offs, 0xFF, (size_t)cap * sizeof(uint64_t));
+    s->cap = cap;
+    s->used = 0;
+    for (uint32_t i = 0; i < oldCap; i++) {
+        if (oldOffs[i] >= AS_SLOT_GONE) continue;
+        uint32_t j = as_fs_slot(s, oldKeys[i]);
+        s->keys[j] = oldKeys[i];
+        s->offs[j] = oldOffs[i];
+        s->used++;
+    }
+    free(oldKeys); free(oldOffs);
+    return 1;
+}
+
+// 返回槽位；空槽时 offs = AS_SLOT_EMPTY（已预留容量）
+static int as_fs_index_find(ASFStore *s, uint64_t key, uint32_t *slot) {
+    if (s->used + 1 > s->cap / 2 && !as_fs_index_grow(s)) return 0;
+    *slot = as_fs_slot(s, key);
+    return 1;
+}
+
+// 把 off 处的记录登记为 key 的最新值；旧值计入死字节
+static void as_fs_index_set(ASFStore *s, uint32_t slot, uint64_t key, uint64_t off, uint32_t size) {
+    uint64_t old = s->offs[slot];
+    if (old < AS_SLOT_GONE) {
+        uint32_t oldSize = as_fs_rec(s, old)->size;
+        s->liveBytes -= oldSize;
+        s->deadBytes += oldSize;
+    } else {
+        if (old == AS_SLOT_EMPTY) s->used++;
+        s->live++;
+    }
+    s->keys[slot] = key;
+    s->offs[slot] = off;
+    s->liveBytes += size;
+}
+
+static void as_fs_index_drop(ASFStore *s, uint32_t slot) {
+    uint64_t old = s->offs[slot];
+    if (old >= AS_SLOT_GONE) return;
+    uint32_t oldSize = as_fs_rec(s, old)->size;
+    s->liveBytes -= oldSize;
+    s->deadBytes += oldSize;
+    s->offs[slot] = AS_SLOT_GONE;
+    s->live--;
+}
+
+// MARK: - Tail
+
+static int as_fs_tail_reserve(ASFStore *s, size_t extra) {
+    if (s->tailLen + extra <= s->tailCap) return 1;
+    size_t cap = s->tailCap ? s->tailCap * 2 : 64 * 1024;
+    while (cap < s->tailLen + extra) cap *= 2;
+    uint8_t *p = (uint8_t *)realloc(s->tail, cap);
+    if (!p) return 0;
+    s->tail = p;
+    s->tailCap = cap;
+    return 1;
+}
+
+static void as_fs_reset_empty(ASFStore *s) {
+    as_fs_index_clear(s);
+    s->base = NULL;
+    s->baseLen = 0;
+    s->tailLen = 0;
+    s->liveBytes = s->deadBytes = 0;
+    s->needsRewrite = 1;
+    if (!as_fs_tail_reserve(s, sizeof(ASFStoreHeader))) return;
+    ASFStoreHeader h = { AS_FSTORE_MAGIC, AS_FSTORE_VERSION, s->extractorVersion, {0} };
+    memcpy(s->tail, &h, sizeof(h));
+    s->tailLen = sizeof(h);
+}
+
+// MARK: - Lifecycle
+
+ASFStore *as_fstore_create(uint32_t extractorVersion) {
+    ASFStore *s = (ASFStore *)calloc(1, sizeof(ASFStore));
+    if (!s) return NULL;
+    s->extractorVersion = extractorVersion;
+    as_fs_reset_empty(s);
+    return s;
+}
+
+void as_fstore_destroy(ASFStore *s) {
+    if (!s) return;
+    as_fs_index_clear(s);
+    free(s->tail);
+    free(s);
+}
+
+static int as_fs_record_valid(const uint8_t *p, size_t avail) {
+    if (avail < sizeof(ASFStoreRecord)) return 0;
+    const ASFStoreRecord *r = (const ASFStoreRecord *)p;
+    if (r->size < sizeof(ASFStoreRecord) || (r->size & 7) || r->size > avail) return 0;
+    if (as_fs_record_size(r->idLen, r->featureCount, r->videoLen) != r->size) return 0;
+    return as_fs_record_checksum(p, r->size) == r->checksum;
+}
+
+size_t as_fstore_open(ASFStore *s, const void *bytes, size_t len) {
+    as_fs_reset_empty(s);
+
+    const uint8_t *p = (const uint8_t *)bytes;
+    ASFStoreHeader h;
+    if (!p || len < sizeof(h)) return 0;
+    memcpy(&h, p, sizeof(h));
+    if (h.magic != AS_FSTORE_MAGIC || h.version != AS_FSTORE_VERSION || h.extractorVersion != s->extractorVersion) return 0;
+
+    s->tailLen = 0;
+    s->needsRewrite = 0;
+    s->base = p;
+    s->baseLen = len;
+
+    size_t off = sizeof(h);
+    while (off < len && as_fs_record_valid(p + off, len - off)) {
+        const ASFStoreRecord *r = (const ASFStoreRecord *)(p + off);
+        uint32_t slot;
+        if (!as_fs_index_find(s, r->idHash, &slot)) break;
+        if (r->flags & AS_FSTORE_TOMBSTONE) {
+            as_fs_index_drop(s, slot);
+            s->deadBytes += r->size;
+        } else {
+            as_fs_index_set(s, slot, r->idHash, off, r->size);
+        }
+        off += r->size;
+    }
+    // 半截尾记录之后的字节不再可见，调用方截断文件
+    s->baseLen = off;
+    return off;
+}
+
+// MARK: - Access
+
+static const ASFStoreRecord *as_fs_lookup(ASFStore *s, const char *id, uint32_t idLen, uint32_t *slotOut) {
+    if (!s->cap) return NULL;
+    uint64_t key = as_fs_id_hash(id, idLen);
+    uint32_t slot = as_fs_slot(s, key);
+    if (slotOut) *slotOut = slot;
+    if (s->offs[slot] >= AS_SLOT_GONE) return NULL;
+    const ASFStoreRecord *r = as_fs_rec(s, s->offs[slot]);
+    if (r->idLen != idLen || memcmp((const uint8_t *)r + sizeof(ASFStoreRecord), id, idLen) != 0) return NULL;
+    return r;
+}
+
+static inline const float *as_fs_feature(const ASFStoreRecord *r) {
+    return (const float *)((const uint8_t *)r + sizeof(ASFStoreRecord) + as_align8(r->idLen));
+}
+
+static inline const uint8_t *as_fs_video(const ASFStoreRecord *r) {
+    return (const uint8_t *)as_fs_feature(r) + as_align8((size_t)r->featureCount * sizeof(float));
+}
+
+int as_fstore_get(ASFStore *s, const char *localId, uint32_t idLen, int64_t modMs, ASFeatureEntry *out) {
+    const ASFStoreRecord *r = as_fs_lookup(s, localId, idLen, NULL);
+    if (!r || r->modMs != modMs) {
+        if (r) s->stale++;
+        s->misses++;
+        return 0;
+    }
+    s->hits++;
+    out->flags = r->flags;
+    out->fileSize = r->fileSize;
+    memcpy(out->sizeParts, r->sizeParts, sizeof(out->sizeParts));
+    memcpy(out->phash, r->phash, sizeof(out->phash));
+    out->blurScore = r->blurScore;
+    out->lumaMean = r->lumaMean;
+    out->lumaStd = r->lumaStd;
+    out->featureCount = (r->flags & AS_FSTORE_HAS_FEATURE) ? r->featureCount : 0;
+    out->feature = out->featureCount ? as_fs_feature(r) : NULL;
+    out->videoLen = (r->flags & AS_FSTORE_HAS_VIDEO) ? r->videoLen : 0;
+    out->video = out->videoLen ? as_fs_video(r) : NULL;
+    return 1;
+}
+
+int as_fstore_put(ASFStore *s, const char *localId, uint32_t idLen, int64_t modMs, const ASFeatureEntry *e) {
+    if (idLen > UINT16_MAX) return 0;
+    uint64_t key = as_fs_id_hash(localId, idLen);
+    uint32_t slot;
+    if (!as_fs_index_find(s, key, &slot)) return 0;
+
+    const ASFStoreRecord *old = as_fs_lookup(s, localId, idLen, NULL);
+    if (old && old->modMs != modMs) old = NULL;
+    uint32_t oldFlags = old ? old->flags : 0;
+    uint32_t newFlags = e->flags & (AS_FSTORE_HAS_SIZE | AS_FSTORE_HAS_PHASH | AS_FSTORE_HAS_BLUR |
+                                    AS_FSTORE_HAS_FEATURE | AS_FSTORE_HAS_VIDEO);
+    if (!e->feature || !e->featureCount) newFlags &= ~(uint32_t)AS_FSTORE_HAS_FEATURE;
+    if (!e->video || !e->videoLen) newFlags &= ~(uint32_t)AS_FSTORE_HAS_VIDEO;
+    // 没有新字段：已经存过，不再追加
+    if (old && (newFlags & ~oldFlags) == 0) return 1;
+
+    uint32_t flags = oldFlags | newFlags;
+    uint32_t featureCount = (newFlags & AS_FSTORE_HAS_FEATURE) ? e->featureCount
+                          : ((oldFlags & AS_FSTORE_HAS_FEATURE) ? old->featureCount : 0);
+    uint32_t videoLen = (newFlags & AS_FSTORE_HAS_VIDEO) ? e->videoLen
+                      : ((oldFlags & AS_FSTORE_HAS_VIDEO) ? old->videoLen : 0);
+    size_t size = as_fs_record_size(idLen, featureCount, videoLen);
+    if (size > UINT32_MAX) return 0;
+
+    uint64_t oldOff = old ? s->offs[slot] : 0;
+    if (!as_fs_tail_reserve(s, size)) return 0;
+    if (old) old = as_fs_rec(s, oldOff);  // tail 可能已搬家
+
+    uint8_t *p = s->tail + s->tailLen;
+    memset(p, 0, size);
+    ASFStoreRecord *r = (ASFStoreRecord *)p;
+    r->size = (uint32_t)size;
+    r->flags = (uint16_t)flags;
+    r->idLen = (uint16_t)idLen;
+    r->idHash = key;
+    r->modMs = modMs;
+
+    if (newFlags & AS_FSTORE_HAS_SIZE) {
+        r->fileSize = e->fileSize;
+        memcpy(r->sizeParts, e->sizeParts, sizeof(r->sizeParts));
+    } else if (old) {
+        r->fileSize = old->fileSize;
+        memcpy(r->sizeParts, old->sizeParts, sizeof(r->sizeParts));
+    }
+    if (newFlags & AS_FSTORE_HAS_PHASH) memcpy(r->phash, e->phash, sizeof(r->phash));
+    else if (old) memcpy(r->phash, old->phash, sizeof(r->phash));
+    if (newFlags & AS_FSTORE_HAS_BLUR) {
+        r->blurScore = e->blurScore; r->lumaMean = e->lumaMean; r->lumaStd = e->lumaStd;
+    } else if (old) {
+        r->blurScore = old->blurScore; r->lumaMean = old->lumaMean; r->lumaStd = old->lumaStd;
+    }
+    r->featureCount = featureCount;
+    r->videoLen = videoLen;
+
+    memcpy(p + sizeof(ASFStoreRecord), localId, idLen);
+    if (featureCount) {
+        const float *f = (newFlags & AS_FSTORE_HAS_FEATURE) ? e->feature : as_fs_feature(old);
+        memcpy((uint8_t *)as_fs_feature(r), f, (size_t)featureCount * sizeof(float));
+    }
+    if (videoLen) {
+        const void *v = (newFlags & AS_FSTORE_HAS_VIDEO) ? e->video : as_fs_video(old);
+        memcpy((uint8_t *)as_fs_video(r), v, videoLen);
+    }
+    r->checksum = as_fs_record_checksum(p, r->size);
+
+    as_fs_index_set(s, slot, key, s->baseLen + s->tailLen, r->size);
+    s->tailLen += size;
+    s->puts++;
+    return 1;
+}
+
+int as_fstore_remove(ASFStore *s, const char *localId, uint32_t idLen) {
+    uint32_t slot;
+    if (!as_fs_lookup(s, localId, idLen, &slot)) return 0;
+    size_t size = as_fs_record_size(idLen, 0, 0);
+    if (!as_fs_tail_reserve(s, size)) return 0;
+
+    uint8_t *p = s->tail + s->tailLen;
+    memset(p, 0, size);
+    ASFStoreRecord *r = (ASFStoreRecord *)p;
+    r->size = (uint32_t)size;
+    r->flags = AS_FSTORE_TOMBSTONE;
+    r->idLen = (uint16_t)idLen;
+    r->idHash = s->keys[slot];
+    memcpy(p + sizeof(ASFStoreRecord), localId, idLen);
+    r->checksum = as_fs_record_checksum(p, r->size);
+    s->tailLen += size;
+
+    as_fs_index_drop(s, slot);
+    s->deadBytes += size;
+    return 1;
+}
+
+// MARK: - Persistence
+
+void as_fstore_pending(const ASFStore *s, const uint8_t **bytes, size_t *len, int *needsRewrite) {
+    *bytes = s->tail;
+    *len = s->tailLen;
+    if (needsRewrite) *needsRewrite = s->needsRewrite;
+}
+
+int as_fstore_rebase(ASFStore *s, const void *bytes, size_t len) {
+    if (len < s->baseLen) return 0;
+    size_t consumed = len - s->baseLen;
+    if (consumed > s->tailLen) return 0;
+    if (s->needsRewrite && consumed < sizeof(ASFStoreHeader)) return 0;
+
+    memmove(s->tail, s->tail + consumed, s->tailLen - consumed);
+    s->tailLen -= consumed;
+    s->base = (const uint8_t *)bytes;
+    s->baseLen = len;
+    s->needsRewrite = 0;
+    return 1;
+}
+
+int as_fstore_should_compact(const ASFStore *s, size_t minBytes) {
+    return s->deadBytes > s->liveBytes && s->deadBytes + s->liveBytes > minBytes;
+}
+
+static int as_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+int as_fstore_compact(const ASFStore *s, uint8_t **out, size_t *outLen) {
+    uint64_t *offs = (uint64_t *)malloc(((size_t)s->live + 1) * sizeof(uint64_t));
+    uint8_t *buf = (uint8_t *)malloc(sizeof(ASFStoreHeader) + s->liveBytes);
+    if (!offs || !buf) { free(offs); free(buf); return 0; }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < s->cap; i++) if (s->offs[i] < AS_SLOT_GONE) offs[n++] = s->offs[i];
+    // 保持写入先后
+    qsort(offs, n, sizeof(uint64_t), as_cmp_u64);
+
+    ASFStoreHeader h = { AS_FSTORE_MAGIC, AS_FSTORE_VERSION, s->extractorVersion, {0} };
+    memcpy(buf, &h, sizeof(h));
+    size_t len = sizeof(h);
+    for (uint32_t i = 0; i < n; i++) {
+        const ASFStoreRecord *r = as_fs_rec(s, offs[i]);
+        memcpy(buf + len, r, r->size);
+        len += r->size;
+    }
+    free(offs);
+    *out = buf;
+    *outLen = len;
+    return 1;
+}
+
+void as_fstore_stats(const ASFStore *s, ASFeatureStoreStats *out) {
+    out->hits = s->hits;
+    out->misses = s->misses;
+    out->stale = s->stale;
+    out->puts = s->puts;
+    out->entries = s->live;
+    out->liveBytes = s->liveBytes;
+    out->deadBytes = s->deadBytes;
+    out->pendingBytes = s->tailLen;
+}
+
+void as_fstore_reset_counters(ASFStore *s) {
+    s->hits = s->misses = s->stale = s->puts = 0;
+}
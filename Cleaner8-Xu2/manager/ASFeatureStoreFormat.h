@@ -0,0 +1,99 @@
+#ifndef ASFeatureStoreFormat_h
+#define ASFeatureStoreFormat_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 持久化特征库（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 以 (localId, modificationDate) 为键缓存已算好的：文件大小 / pHash256 / 模糊度+曝光 / Vision 特征 / 视频指纹。
+/// 资产未被编辑（modificationDate 不变）时内容不变，增量重建、续扫、重新全量扫描直接复用，
+/// 只有新增或被编辑的资产才需要解码。
+///
+/// 文件 = Header + 追加的记录（8 字节对齐，每条带校验）。同一 localId 以最后一条为准，
+/// 被覆盖 / 删除的旧记录是死字节，超过活字节时整体压缩。进程被杀留下的半截尾记录在打开时丢弃。
+/// 内存里只有索引（localId 哈希 -> 偏移）和尚未落盘的尾部；已落盘部分直接读调用方给的映射内存。
+/// 非线程安全，由调用方加锁。
+
+#define AS_FSTORE_MAGIC   0x53465341u  // "ASFS"
+#define AS_FSTORE_VERSION 3u   // 2：记录加视频指纹；3：文件大小按资源类型拆分
+
+enum {
+    AS_FSTORE_HAS_SIZE    = 1u << 0,   // fileSize + sizeParts
+    AS_FSTORE_HAS_PHASH   = 1u << 1,
+    AS_FSTORE_HAS_BLUR    = 1u << 2,   // blurScore + lumaMean + lumaStd
+    AS_FSTORE_HAS_FEATURE = 1u << 3,   // float32 特征
+    AS_FSTORE_HAS_VIDEO   = 1u << 4,   // 视频指纹（不透明字节，见 ASVideoFingerprint.h）
+    AS_FSTORE_TOMBSTONE   = 1u << 15,
+};
+
+/// 文件大小拆分（见 ASAssetSizeService）；fileSize 减去各项之和即其余资源
+enum {
+    AS_FSTORE_PART_PHOTO = 0,       // 原图（Photo / AlternatePhoto）
+    AS_FSTORE_PART_VIDEO,           // 原视频
+    AS_FSTORE_PART_PAIRED_VIDEO,    // Live Photo 的视频
+    AS_FSTORE_PART_ADJUSTMENT,      // 编辑：全尺寸渲染 + 调整数据 + 调整基准
+    AS_FSTORE_SIZE_PARTS
+};
+
+typedef struct {
+    uint32_t flags;             // AS_FSTORE_HAS_*
+    uint64_t fileSize;
+    uint64_t sizeParts[AS_FSTORE_SIZE_PARTS];
+    uint64_t phash[4];
+    float blurScore, lumaMean, lumaStd;
+    const float *feature;       // get：指向库内存，下一次 put / remove / open / rebase 前有效
+    uint32_t featureCount;
+    const void *video;          // 同 feature，get 时指向库内存
+    uint32_t videoLen;
+} ASFeatureEntry;
+
+typedef struct ASFStore ASFStore;
+
+/// extractorVersion：特征算法版本（pHash / 模糊度 / Vision revision）；与文件不一致时整库作废
+ASFStore *as_fstore_create(uint32_t extractorVersion);
+void as_fstore_destroy(ASFStore *s);
+
+/// 以一份文件内容（调用方持有，须一直有效直到下一次 open / rebase）重建索引，丢弃未落盘尾部。
+/// 返回有效字节数（半截尾记录之前）；0 = 空文件或版本不符，此时库为空、下次落盘须整体重写
+size_t as_fstore_open(ASFStore *s, const void *bytes, size_t len);
+
+/// 命中返回 1 并填 out；localId 存在但 modMs 不同（资产被编辑过）或不存在返回 0
+int as_fstore_get(ASFStore *s, const char *localId, uint32_t idLen, int64_t modMs, ASFeatureEntry *out);
+
+/// 写入；与已有同 modMs 的记录合并（e 里没有的字段沿用旧值）。feature / video 会被复制
+int as_fstore_put(ASFStore *s, const char *localId, uint32_t idLen, int64_t modMs, const ASFeatureEntry *e);
+
+/// 删除（资产已从相册删除）；返回 1 = 原本存在
+int as_fstore_remove(ASFStore *s, const char *localId, uint32_t idLen);
+
+/// 尚未落盘的字节：追加到文件末尾即可（文件为空 / 版本不符时含 Header，需整体写而不是追加）
+void as_fstore_pending(const ASFStore *s, const uint8_t **bytes, size_t *len, int *needsRewrite);
+
+/// 落盘完成后，以新的文件内容替换映射：len 须 >= 旧映射长度，多出的部分即已写入的尾部字节
+int as_fstore_rebase(ASFStore *s, const void *bytes, size_t len);
+
+/// 死字节超过活字节且总量超过 minBytes 时建议压缩
+int as_fstore_should_compact(const ASFStore *s, size_t minBytes);
+
+/// 只含活记录的新文件内容（malloc，调用方 free）；写入后用 as_fstore_open 打开它
+int as_fstore_compact(const ASFStore *s, uint8_t **out, size_t *outLen);
+
+typedef struct {
+    uint64_t hits, misses, stale;   // stale：localId 命中但 modMs 不同
+    uint64_t puts, entries;
+    uint64_t liveBytes, deadBytes, pendingBytes;
+} ASFeatureStoreStats;
+
+void as_fstore_stats(const ASFStore *s, ASFeatureStoreStats *out);
+void as_fstore_reset_counters(ASFStore *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASFeatureStoreFormat_h */
@@ -0,0 +1,168 @@
+#include "ASGroupForest.h"
+
+#include <stdlib.h>
+
+#define AS_NO_SEQ UINT32_MAX
+
+struct ASGroupForest {
+    uint32_t *parent;
+    uint32_t *size;       // 仅根有效
+    uint32_t *first;      // 仅根有效：最小下标（保留的那张）
+    uint32_t *seq;        // 仅根有效：成组序号，单元素为 AS_NO_SEQ
+    uint32_t *next;       // 环形成员链表
+    uint64_t *bytes;      // 元素自身字节
+    uint64_t *setBytes;   // 仅根有效
+    uint8_t  *tag;        // 仅根有效
+    uint32_t count, cap;
+
+    uint32_t groups;
+    uint32_t nextSeq;
+    uint64_t cleanBytes, cleanCount;
+};
+
+ASGroupForest *as_forest_create(void) {
+    return (ASGroupForest *)calloc(1, sizeof(ASGroupForest));
+}
+
+void as_forest_destroy(ASGroupForest *f) {
+    if (!f) return;
+    free(f->parent); free(f->size); free(f->first); free(f->seq);
+    free(f->next); free(f->bytes); free(f->setBytes); free(f->tag);
+    free(f);
+}
+
+#define AS_GROW(field) do { \
+    void *p_ = realloc(f->field, (size_t)cap * sizeof(*f->field)); \
+    if (!p_) return 0; \
+    f->field = p_; \
+} while (0)
+
+static int as_forest_reserve(ASGroupForest *f, uint32_t need) {
+    if (need <= f->cap) return 1;
+    uint32_t cap = f->cap ? f->cap * 2 : 256;
+    while (cap < need) cap *= 2;
+    AS_GROW(parent); AS_GROW(size); AS_GROW(first); AS_GROW(seq);
+    AS_GROW(next); AS_GROW(bytes); AS_GROW(setBytes); AS_GROW(tag);
+    f->cap = cap;
+    return 1;
+}
+
+uint32_t as_forest_add(ASGroupForest *f, uint64_t bytes, uint8_t tag) {
+    if (!as_forest_reserve(f, f->count + 1)) return UINT32_MAX;
+    uint32_t i = f->count++;
+    f->parent[i] = i;
+    f->size[i] = 1;
+    f->first[i] = i;
+    f->seq[i] = AS_NO_SEQ;
+    f->next[i] = i;
+    f->bytes[i] = bytes;
+    f->setBytes[i] = bytes;
+    f->tag[i] = tag;
+    return i;
+}
+
+uint32_t as_forest_count(const ASGroupForest *f) { return f->count; }
+
+uint32_t as_forest_find(ASGroupForest *f, uint32_t x) {
+    while (f->parent[x] != x) {
+        f->parent[x] = f->parent[f->parent[x]];
+        x = f->parent[x];
+    }
+    return x;
+}
+
+// 一组对可清理汇总的贡献：除保留的那张之外
+static inline void as_forest_contrib(const ASGroupForest *f, uint32_t r, uint64_t *b, uint64_t *c) {
+    if (f->size[r] < 2) { *b = 0; *c = 0; return; }
+    *b = f->setBytes[r] - f->bytes[f->first[r]];
+    *c = f->size[r] - 1;
+}
+
+int as_forest_union(ASGroupForest *f, uint32_t a, uint32_t b) {
+    uint32_t ra = as_forest_find(f, a), rb = as_forest_find(f, b);
+    if (ra == rb) return 0;
+
+    uint64_t ba, ca, bb, cb;
+    as_forest_contrib(f, ra, &ba, &ca);
+    as_forest_contrib(f, rb, &bb, &cb);
+    f->cleanBytes -= ba + bb;
+    f->cleanCount -= ca + cb;
+
+    int wasGroupA = f->size[ra] >= 2, wasGroupB = f->size[rb] >= 2;
+
+    // 按大小合并；tag / 保留张 / 成组序号按「更早」的一方
+    uint32_t big = ra, small = rb;
+    if (f->size[ra] < f->size[rb]) { big = rb; small = ra; }
+    uint32_t keepFirst = f->first[ra] < f->first[rb] ? f->first[ra] : f->first[rb];
+    uint8_t keepTag = f->first[ra] < f->first[rb] ? f->tag[ra] : f->tag[rb];
+    uint32_t keepSeq = f->seq[ra] < f->seq[rb] ? f->seq[ra] : f->seq[rb];
+
+    f->parent[small] = big;
+    f->size[big] += f->size[small];
+    f->setBytes[big] += f->setBytes[small];
+    f->first[big] = keepFirst;
+    f->tag[big] = keepTag;
+    f->seq[big] = (keepSeq == AS_NO_SEQ) ? f->nextSeq++ : keepSeq;
+
+    // 拼接两个环
+    uint32_t t = f->next[big];
+    f->next[big] = f->next[small];
+    f->next[small] = t;
+
+    f->groups += 1 - (uint32_t)wasGroupA - (uint32_t)wasGroupB;
+
+    uint64_t bm, cm;
+    as_forest_contrib(f, big, &bm, &cm);
+    f->cleanBytes += bm;
+    f->cleanCount += cm;
+    return 1;
+}
+
+uint32_t as_forest_group_count(const ASGroupForest *f) { return f->groups; }
+uint64_t as_forest_cleanable_bytes(const ASGroupForest *f) { return f->cleanBytes; }
+uint64_t as_forest_cleanable_count(const ASGroupForest *f) { return f->cleanCount; }
+
+ASPairNeed as_forest_pair_need(ASGroupForest *sim, ASGroupForest *dup, uint32_t a, uint32_t b) {
+    if (as_forest_find(dup, a) == as_forest_find(dup, b)) return AS_PAIR_SKIP;
+    if (as_forest_find(sim, a) == as_forest_find(sim, b)) return AS_PAIR_DUPLICATE_ONLY;
+    return AS_PAIR_FULL;
+}
+
+uint32_t as_forest_set_size(ASGroupForest *f, uint32_t x) { return f->size[as_forest_find(f, x)]; }
+uint8_t as_forest_tag(ASGroupForest *f, uint32_t x) { return f->tag[as_forest_find(f, x)]; }
+
+// MARK: - Materialise
+
+static int as_cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int as_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t as_forest_groups(const ASGroupForest *f, uint32_t *out) {
+    uint64_t *keys = (uint64_t *)malloc(((size_t)f->groups + 1) * sizeof(uint64_t));
+    if (!keys) return 0;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < f->count && n < f->groups; i++) {
+        if (f->parent[i] == i && f->size[i] >= 2) keys[n++] = ((uint64_t)f->seq[i] << 32) | i;
+    }
+    // 成组序号唯一，按它排序即成组先后
+    qsort(keys, n, sizeof(uint64_t), as_cmp_u64);
+    for (uint32_t i = 0; i < n; i++) out[i] = (uint32_t)keys[i];
+    free(keys);
+    return n;
+}
+
+uint32_t as_forest_members(const ASGroupForest *f, uint32_t root, uint32_t *out) {
+    uint32_t n = 0, x = root;
+    do {
+        out[n++] = x;
+        x = f->next[x];
+    } while (x != root);
+    qsort(out, n, sizeof(uint32_t), as_cmp_u32);
+    return n;
+}
@@ -0,0 +1,64 @@
+#ifndef ASGroupForest_h
+#define ASGroupForest_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 相似 / 重复分组的并查集（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 元素是紧凑整数下标（按加入顺序 = 扫描顺序）。按大小合并 + 路径减半，
+/// 入组、两组合并、查询是否同组都是 O(α(n))。每个集合在根上维护：
+///   成员数 / 总字节 / 最小下标（组里保留的那张）/ 成组序号（物化时的组顺序）
+/// 以及全局的「可清理」汇总：每组除保留的那张之外的字节与张数，合并时增量更新。
+/// 成员用环形链表串起来，拼接 O(1)，物化一组 O(组大小)。
+
+typedef struct ASGroupForest ASGroupForest;
+
+ASGroupForest *as_forest_create(void);
+void as_forest_destroy(ASGroupForest *f);
+
+/// 加入一个单元素集合，返回下标（从 0 递增）；tag 由调用方定义（如媒体类型），合并后取根的
+uint32_t as_forest_add(ASGroupForest *f, uint64_t bytes, uint8_t tag);
+
+uint32_t as_forest_count(const ASGroupForest *f);
+
+uint32_t as_forest_find(ASGroupForest *f, uint32_t x);
+
+/// 合并 a、b 所在集合；返回 1 = 发生合并，0 = 本来就同组
+int as_forest_union(ASGroupForest *f, uint32_t a, uint32_t b);
+
+/// 分组时一对 (新 asset, 候选) 还要判什么（sim / dup 两片森林共用下标）：
+/// 已同重复组 = 不用比；已同相似组 = 只判重复（相似组经第三张连起来时，两张之间的重复边仍要测）；否则全判
+typedef enum {
+    AS_PAIR_SKIP = 0,
+    AS_PAIR_DUPLICATE_ONLY = 1,
+    AS_PAIR_FULL = 2,
+} ASPairNeed;
+
+ASPairNeed as_forest_pair_need(ASGroupForest *sim, ASGroupForest *dup, uint32_t a, uint32_t b);
+
+/// 成员数 >= 2 的集合个数
+uint32_t as_forest_group_count(const ASGroupForest *f);
+
+/// 所有组「除保留的那张（最小下标）之外」的字节 / 张数之和
+uint64_t as_forest_cleanable_bytes(const ASGroupForest *f);
+uint64_t as_forest_cleanable_count(const ASGroupForest *f);
+
+uint32_t as_forest_set_size(ASGroupForest *f, uint32_t x);
+uint8_t as_forest_tag(ASGroupForest *f, uint32_t x);
+
+/// 全部组的根，按成组先后排序；out 至少 as_forest_group_count 个；返回个数
+uint32_t as_forest_groups(const ASGroupForest *f, uint32_t *out);
+
+/// root 所在组的全部成员，按下标升序；out 至少 set_size 个；返回个数
+uint32_t as_forest_members(const ASGroupForest *f, uint32_t root, uint32_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASGroupForest_h */
@@ -0,0 +1,287 @@
+#include "ASPHashIndex.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AS_MIH_BANDS     16
+#define AS_MIH_BAND_BITS 16
+#define AS_MIH_BUCKETS   (1u << AS_MIH_BAND_BITS)
+
+// 条数太少时线性扫描更快，也不值得分配 4MB 段表
+#define AS_MIH_MIN_COUNT 1024
+
+struct ASPHashIndex {
+    uint64_t *hashes;   // slotCap * 4
+    uint8_t  *alive;    // slotCap
+    uint32_t *stamp;    // slotCap，查询去重
+    int32_t  *next;     // slotCap * 16，每段一条链
+    int32_t  *heads;    // 16 * 65536，未构建时为 NULL
+
+    size_t slots;
+    size_t slotCap;
+    size_t live;
+    uint32_t epoch;
+    int mih;            // 0 = 只做线性扫描，next / heads 都不分配
+};
+
+// MARK: - Mask table
+
+// 全部 16-bit 掩码按 popcount 升序排列；gMaskEnd[k] = popcount <= k 的掩码个数
+static uint16_t gMasks[AS_MIH_BUCKETS];
+static uint32_t gMaskEnd[AS_MIH_BAND_BITS + 1];
+static pthread_once_t gMaskOnce = PTHREAD_ONCE_INIT;
+
+static void as_build_mask_table(void) {
+    uint32_t n = 0;
+    for (int k = 0; k <= AS_MIH_BAND_BITS; k++) {
+        for (uint32_t m = 0; m < AS_MIH_BUCKETS; m++) {
+            if (__builtin_popcount(m) == k) gMasks[n++] = (uint16_t)m;
+        }
+        gMaskEnd[k] = n;
+    }
+}
+
+static inline uint32_t as_band_key(const uint64_t *h, int band) {
+    return (uint32_t)((h[band >> 2] >> ((band & 3) * AS_MIH_BAND_BITS)) & 0xFFFFu);
+}
+
+// MARK: - Hits
+
+static int as_hits_reserve(ASPHashHits *hits, size_t need) {
+    if (need <= hits->cap) return 1;
+    size_t cap = hits->cap ? hits->cap : 64;
+    while (cap < need) cap <<= 1;
+    uint32_t *p = (uint32_t *)realloc(hits->slots, cap * sizeof(uint32_t));
+    if (!p) return 0;
+    hits->slots = p;
+    hits->cap = cap;
+    return 1;
+}
+
+static inline void as_hits_push(ASPHashHits *hits, uint32_t slot) {
+    if (hits->count == hits->cap && !as_hits_reserve(hits, hits->count + 1)) return;
+    hits->slots[hits->count++] = slot;
+}
+
+void as_phash_hits_free(ASPHashHits *hits) {
+    if (!hits) return;
+    free(hits->slots);
+    hits->slots = NULL;
+    hits->count = 0;
+    hits->cap = 0;
+}
+
+static int as_slot_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// MARK: - Lifecycle
+
+ASPHashIndex *as_phash_index_create(void) {
+    pthread_once(&gMaskOnce, as_build_mask_table);
+    ASPHashIndex *idx = (ASPHashIndex *)calloc(1, sizeof(ASPHashIndex));
+    if (idx) idx->mih = 1;
+    return idx;
+}
+
+// as_mih_worthwhile 的条件 probes * (1 + live/B) * 2 < live 有解当且仅当 probes * 2 < B
+static inline int as_mih_can_pay(uint32_t rho) {
+    return (double)gMaskEnd[rho] * AS_MIH_BANDS * 2.0 < (double)AS_MIH_BUCKETS;
+}
+
+ASPHashIndex *as_phash_index_create_for_radius(uint32_t maxRadius) {
+    ASPHashIndex *idx = as_phash_index_create();
+    uint32_t rho = maxRadius / AS_MIH_BANDS;
+    if (idx) idx->mih = rho <= AS_MIH_BAND_BITS && as_mih_can_pay(rho);
+    return idx;
+}
+
+void as_phash_index_destroy(ASPHashIndex *idx) {
+    if (!idx) return;
+    free(idx->hashes);
+    free(idx->alive);
+    free(idx->stamp);
+    free(idx->next);
+    free(idx->heads);
+    free(idx);
+}
+
+void as_phash_index_clear(ASPHashIndex *idx) {
+    if (!idx) return;
+    idx->slots = 0;
+    idx->live = 0;
+    // 段表按需重建；按天重置时大多数天不会再达到阈值
+    free(idx->heads);
+    idx->heads = NULL;
+}
+
+static int as_grow(ASPHashIndex *idx) {
+    size_t cap = idx->slotCap ? idx->slotCap * 2 : 256;
+
+    uint64_t *h = (uint64_t *)realloc(idx->hashes, cap * AS_PHASH_WORDS * sizeof(uint64_t));
+    if (!h) return 0;
+    idx->hashes = h;
+
+    uint8_t *a = (uint8_t *)realloc(idx->alive, cap);
+    if (!a) return 0;
+    idx->alive = a;
+
+    uint32_t *s = (uint32_t *)realloc(idx->stamp, cap * sizeof(uint32_t));
+    if (!s) return 0;
+    idx->stamp = s;
+
+    if (idx->mih) {
+        int32_t *n = (int32_t *)realloc(idx->next, cap * AS_MIH_BANDS * sizeof(int32_t));
+        if (!n) return 0;
+        idx->next = n;
+    }
+
+    idx->slotCap = cap;
+    return 1;
+}
+
+static inline void as_link_slot(ASPHashIndex *idx, uint32_t slot) {
+    const uint64_t *h = idx->hashes + (size_t)slot * AS_PHASH_WORDS;
+    for (int b = 0; b < AS_MIH_BANDS; b++) {
+        int32_t *head = &idx->heads[(size_t)b * AS_MIH_BUCKETS + as_band_key(h, b)];
+        idx->next[(size_t)slot * AS_MIH_BANDS + b] = *head;
+        *head = (int32_t)slot;
+    }
+}
+
+static void as_build_mih(ASPHashIndex *idx) {
+    idx->heads = (int32_t *)malloc((size_t)AS_MIH_BANDS * AS_MIH_BUCKETS * sizeof(int32_t));
+    if (!idx->heads) return;
+    memset(idx->heads, 0xFF, (size_t)AS_MIH_BANDS * AS_MIH_BUCKETS * sizeof(int32_t));
+    for (uint32_t s = 0; s < idx->slots; s++) {
+        if (idx->alive[s]) as_link_slot(idx, s);
+    }
+}
+
+// MARK: - Mutation
+
+uint32_t as_phash_index_add(ASPHashIndex *idx, const uint64_t hash[AS_PHASH_WORDS]) {
+    if (idx->slots == idx->slotCap && !as_grow(idx)) return UINT32_MAX;
+
+    uint32_t slot = (uint32_t)idx->slots++;
+    memcpy(idx->hashes + (size_t)slot * AS_PHASH_WORDS, hash, AS_PHASH_WORDS * sizeof(uint64_t));
+    idx->alive[slot] = 1;
+    idx->stamp[slot] = 0;
+    idx->live += 1;
+
+    if (idx->heads) {
+        as_link_slot(idx, slot);
+    } else if (idx->mih && idx->live >= AS_MIH_MIN_COUNT) {
+        as_build_mih(idx);
+    }
+    return slot;
+}
+
+void as_phash_index_remove(ASPHashIndex *idx, uint32_t slot) {
+    if (!idx || slot >= idx->slots || !idx->alive[slot]) return;
+    idx->alive[slot] = 0;
+    idx->live -= 1;
+}
+
+size_t as_phash_index_count(const ASPHashIndex *idx) {
+    return idx ? idx->live : 0;
+}
+
+size_t as_phash_index_slot_count(const ASPHashIndex *idx) {
+    return idx ? idx->slots : 0;
+}
+
+size_t as_phash_index_bytes_per_slot(void) {
+    return AS_PHASH_WORDS * sizeof(uint64_t) + 1 + sizeof(uint32_t) + AS_MIH_BANDS * sizeof(int32_t);
+}
+
+size_t as_phash_index_table_bytes(void) {
+    return (size_t)AS_MIH_BANDS * AS_MIH_BUCKETS * sizeof(int32_t);
+}
+
+size_t as_phash_index_memory_bytes(const ASPHashIndex *idx) {
+    if (!idx) return 0;
+    size_t bytes = idx->slotCap * as_phash_index_bytes_per_slot();
+    if (!idx->mih) bytes -= idx->slotCap * AS_MIH_BANDS * sizeof(int32_t);
+    if (idx->heads) bytes += as_phash_index_table_bytes();
+    return bytes;
+}
+
+const uint64_t *as_phash_index_hash_at(const ASPHashIndex *idx, uint32_t slot) {
+    if (!idx || slot >= idx->slots) return NULL;
+    return idx->hashes + (size_t)slot * AS_PHASH_WORDS;
+}
+
+// MARK: - Query
+
+size_t as_phash_index_query_scan(const ASPHashIndex *idx,
+                                 const uint64_t hash[AS_PHASH_WORDS],
+                                 uint32_t radius,
+                                 ASPHashHits *hits) {
+    hits->count = 0;
+    if (!idx) return 0;
+    const uint64_t *p = idx->hashes;
+    for (size_t s = 0; s < idx->slots; s++, p += AS_PHASH_WORDS) {
+        if (!idx->alive[s]) continue;
+        if (as_hamming256(p, hash) <= radius) as_hits_push(hits, (uint32_t)s);
+    }
+    return hits->count;
+}
+
+// 估算多索引探测成本：探测桶数 * (1 + 平均桶长)
+static inline int as_mih_worthwhile(const ASPHashIndex *idx, uint32_t rho) {
+    if (!idx->heads) return 0;
+    double probes = (double)gMaskEnd[rho] * AS_MIH_BANDS;
+    double cost = probes * (1.0 + (double)idx->live / (double)AS_MIH_BUCKETS);
+    return cost * 2.0 < (double)idx->live;
+}
+
+size_t as_phash_index_query(ASPHashIndex *idx,
+                            const uint64_t hash[AS_PHASH_WORDS],
+                            uint32_t radius,
+                            ASPHashHits *hits,
+                            size_t *outExamined) {
+    hits->count = 0;
+    if (!idx || idx->live == 0) {
+        if (outExamined) *outExamined = 0;
+        return 0;
+    }
+
+    uint32_t rho = radius / AS_MIH_BANDS;
+    if (rho > AS_MIH_BAND_BITS) rho = AS_MIH_BAND_BITS;
+
+    if (!as_mih_worthwhile(idx, rho)) {
+        if (outExamined) *outExamined = idx->live;
+        return as_phash_index_query_scan(idx, hash, radius, hits);
+    }
+
+    if (++idx->epoch == 0) {
+        memset(idx->stamp, 0, idx->slotCap * sizeof(uint32_t));
+        idx->epoch = 1;
+    }
+    const uint32_t epoch = idx->epoch;
+    const uint32_t maskEnd = gMaskEnd[rho];
+    size_t examined = 0;
+
+    for (int b = 0; b < AS_MIH_BANDS; b++) {
+        const uint32_t key = as_band_key(hash, b);
+        const int32_t *heads = idx->heads + (size_t)b * AS_MIH_BUCKETS;
+        for (uint32_t mi = 0; mi < maskEnd; mi++) {
+            for (int32_t s = heads[key ^ gMasks[mi]]; s >= 0; s = idx->next[(size_t)s * AS_MIH_BANDS + b]) {
+                if (idx->stamp[s] == epoch) continue;
+                idx->stamp[s] = epoch;
+                if (!idx->alive[s]) continue;
+                examined++;
+                if (as_hamming256(idx->hashes + (size_t)s * AS_PHASH_WORDS, hash) <= radius) {
+                    as_hits_push(hits, (uint32_t)s);
+                }
+            }
+        }
+    }
+
+    if (hits->count > 1) qsort(hits->slots, hits->count, sizeof(uint32_t), as_slot_cmp);
+    if (outExamined) *outExamined = examined;
+    return hits->count;
+}
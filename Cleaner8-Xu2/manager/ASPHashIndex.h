@@ -0,0 +1,85 @@
+#ifndef ASPHashIndex_h
+#define ASPHashIndex_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 256-bit pHash 候选索引（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// - 半径较小时走 multi-index hashing：hash 切成 16 段 16-bit，
+///   按鸽巢原理，任意距离 <= r 的两条 hash 至少有一段距离 <= r/16，
+///   每段只需枚举 <= r/16 个比特翻转的邻居桶。
+/// - 半径过大（如 kPolicySimilar = 119）时鸽巢枚举比线性扫描还贵，
+///   自动退化为连续内存上的 popcount 扫描。
+/// 两种路径都是精确的：返回全部 hamming <= radius 的 slot，按 slot 升序。
+
+#define AS_PHASH_WORDS 4
+
+typedef struct ASPHashIndex ASPHashIndex;
+
+typedef struct {
+    uint32_t *slots;
+    size_t count;
+    size_t cap;
+} ASPHashHits;
+
+ASPHashIndex *as_phash_index_create(void);
+/// 声明查询会用到的最大半径：这个半径下多索引在任何规模都不划算（如 r=119，每段要枚举 7 比特邻居）时，
+/// 不建段表也不维护链表，只做线性扫描，省下 4MB 段表和每条 64 字节
+ASPHashIndex *as_phash_index_create_for_radius(uint32_t maxRadius);
+void as_phash_index_destroy(ASPHashIndex *idx);
+
+/// 清空（保留已分配内存，方便按天复用）
+void as_phash_index_clear(ASPHashIndex *idx);
+
+/// 插入一条 hash，返回 slot（单调递增，从 0 开始）
+uint32_t as_phash_index_add(ASPHashIndex *idx, const uint64_t hash[AS_PHASH_WORDS]);
+
+/// 逻辑删除（墓碑）；查询不再返回该 slot
+void as_phash_index_remove(ASPHashIndex *idx, uint32_t slot);
+
+/// 存活条数 / 已分配 slot 数（含墓碑）
+size_t as_phash_index_count(const ASPHashIndex *idx);
+size_t as_phash_index_slot_count(const ASPHashIndex *idx);
+
+/// 大致占用字节数（hash + 链表 + 段表）
+size_t as_phash_index_memory_bytes(const ASPHashIndex *idx);
+
+/// 每条记录的固定开销 / 多索引段表的固定开销（按内存预算换算容量用）
+size_t as_phash_index_bytes_per_slot(void);
+size_t as_phash_index_table_bytes(void);
+
+const uint64_t *as_phash_index_hash_at(const ASPHashIndex *idx, uint32_t slot);
+
+/// 查询全部 hamming <= radius 的存活 slot，结果写入 hits（会覆盖原内容并按需扩容）
+/// 返回命中数；*outExamined（可空）返回实际做了 popcount 比较的次数
+size_t as_phash_index_query(ASPHashIndex *idx,
+                            const uint64_t hash[AS_PHASH_WORDS],
+                            uint32_t radius,
+                            ASPHashHits *hits,
+                            size_t *outExamined);
+
+/// 强制走线性扫描（benchmark / 校验用）
+size_t as_phash_index_query_scan(const ASPHashIndex *idx,
+                                 const uint64_t hash[AS_PHASH_WORDS],
+                                 uint32_t radius,
+                                 ASPHashHits *hits);
+
+void as_phash_hits_free(ASPHashHits *hits);
+
+static inline uint32_t as_hamming256(const uint64_t *a, const uint64_t *b) {
+    return (uint32_t)(__builtin_popcountll(a[0] ^ b[0]) +
+                      __builtin_popcountll(a[1] ^ b[1]) +
+                      __builtin_popcountll(a[2] ^ b[2]) +
+                      __builtin_popcountll(a[3] ^ b[3]));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASPHashIndex_h */
@@ -0,0 +1,206 @@
+#include "ASPHashKernel.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AS_N    AS_PHASH_SIDE
+#define AS_LOW  16
+#define AS_BITS (AS_LOW * AS_LOW)
+
+// 4 路 float 向量（clang / gcc 通用写法，ARM 上即 NEON）
+typedef float as_f4 __attribute__((vector_size(16)));
+
+static inline as_f4 as_f4_load(const float *p) {
+    as_f4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void as_f4_store(float *p, as_f4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline as_f4 as_f4_splat(float x) {
+    return (as_f4){ x, x, x, x };
+}
+
+// MARK: - Cos table
+
+// gCos[k][n] = cos(pi/N * (n + 0.5) * k)，与原实现同样用 double 计算再截成 float
+// gCosT[n][k] 为前 16 行的转置，行 DCT 按 k 向量化时连续读取
+static float gCos[AS_N * AS_N];
+static float gCosT[AS_N * AS_LOW];
+static pthread_once_t gCosOnce = PTHREAD_ONCE_INIT;
+
+static void as_build_cos_table(void) {
+    const double N = (double)AS_N;
+    const double coef = M_PI / N;
+    for (int k = 0; k < AS_N; k++) {
+        for (int n = 0; n < AS_N; n++) {
+            gCos[k * AS_N + n] = (float)cos(coef * ((double)n + 0.5) * (double)k);
+        }
+    }
+    for (int n = 0; n < AS_N; n++) {
+        for (int k = 0; k < AS_LOW; k++) {
+            gCosT[n * AS_LOW + k] = gCos[k * AS_N + n];
+        }
+    }
+}
+
+// MARK: - Shared steps
+
+// 增强亮度：与原实现同一表达式，截断到 uint8 再转回 float
+static inline void as_luma_enhanced(const uint8_t *rgba, float *out) {
+    for (int i = 0; i < AS_N * AS_N; i++) {
+        float r = (float)rgba[i * 4 + 0];
+        float g = (float)rgba[i * 4 + 1];
+        float b = (float)rgba[i * 4 + 2];
+
+        float enhanced = 1.1f * (0.299f*r + 0.587f*g + 0.114f*b) - 10.f;
+        if (enhanced < 0.f) enhanced = 0.f;
+        if (enhanced > 255.f) enhanced = 255.f;
+
+        out[i] = (float)(uint8_t)enhanced;
+    }
+}
+
+static inline void as_pack_bits(const float *coeffs, float median, uint64_t out[4]) {
+    out[0] = out[1] = out[2] = out[3] = 0;
+    for (int i = 0; i < AS_BITS; i++) {
+        if (coeffs[i] > median) {
+            out[i / 64] |= 1ULL << (uint64_t)(63 - (i % 64));
+        }
+    }
+}
+
+// MARK: - Fast path
+
+// 第 k 小的值（0 起），会打乱 a；与排序后取 a[k] 结果相同
+static float as_quickselect(float *a, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        float pivot = a[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                float t = a[i]; a[i] = a[j]; a[j] = t;
+                i++; j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return a[k];
+    }
+    return a[k];
+}
+
+void as_phash256_from_rgba(const uint8_t *rgba, uint64_t out[4]) {
+    pthread_once(&gCosOnce, as_build_cos_table);
+
+    float luma[AS_N * AS_N];
+    as_luma_enhanced(rgba, luma);
+
+    // 行 DCT：每行只算 k = 0..15，按 k 向量化；每个 lane 仍按 n 顺序累加
+    float rows[AS_N * AS_LOW];
+    for (int r = 0; r < AS_N; r++) {
+        const float *in = luma + r * AS_N;
+        as_f4 a0 = as_f4_splat(0.f), a1 = a0, a2 = a0, a3 = a0;
+        for (int n = 0; n < AS_N; n++) {
+            const as_f4 x = as_f4_splat(in[n]);
+            const float *c = gCosT + n * AS_LOW;
+            a0 += x * as_f4_load(c + 0);
+            a1 += x * as_f4_load(c + 4);
+            a2 += x * as_f4_load(c + 8);
+            a3 += x * as_f4_load(c + 12);
+        }
+        float *o = rows + r * AS_LOW;
+        as_f4_store(o + 0, a0);
+        as_f4_store(o + 4, a1);
+        as_f4_store(o + 8, a2);
+        as_f4_store(o + 12, a3);
+    }
+
+    // 列 DCT：只算 16 列 × k = 0..15，按列向量化
+    float coeffs[AS_BITS];
+    for (int k = 0; k < AS_LOW; k++) {
+        const float *c = gCos + k * AS_N;
+        as_f4 a0 = as_f4_splat(0.f), a1 = a0, a2 = a0, a3 = a0;
+        for (int n = 0; n < AS_N; n++) {
+            const as_f4 w = as_f4_splat(c[n]);
+            const float *x = rows + n * AS_LOW;
+            a0 += as_f4_load(x + 0) * w;
+            a1 += as_f4_load(x + 4) * w;
+            a2 += as_f4_load(x + 8) * w;
+            a3 += as_f4_load(x + 12) * w;
+        }
+        float *o = coeffs + k * AS_LOW;
+        as_f4_store(o + 0, a0);
+        as_f4_store(o + 4, a1);
+        as_f4_store(o + 8, a2);
+        as_f4_store(o + 12, a3);
+    }
+
+    float scratch[AS_BITS];
+    memcpy(scratch, coeffs, sizeof(scratch));
+    float median = as_quickselect(scratch, AS_BITS, AS_BITS / 2);
+
+    as_pack_bits(coeffs, median, out);
+}
+
+// MARK: - Reference
+
+static int as_float_cmp(const void *a, const void *b) {
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static void as_dct1d_64(const float *in, float *out) {
+    for (int k = 0; k < AS_N; k++) {
+        const float *row = &gCos[k * AS_N];
+        float sum = 0.f;
+        for (int n = 0; n < AS_N; n++) {
+            sum += in[n] * row[n];
+        }
+        out[k] = sum;
+    }
+}
+
+void as_phash256_from_rgba_reference(const uint8_t *rgba, uint64_t out[4]) {
+    pthread_once(&gCosOnce, as_build_cos_table);
+
+    float px[AS_N * AS_N];
+    as_luma_enhanced(rgba, px);
+
+    float rowIn[AS_N], rowOut[AS_N];
+    for (int row = 0; row < AS_N; row++) {
+        memcpy(rowIn, &px[row * AS_N], sizeof(rowIn));
+        as_dct1d_64(rowIn, rowOut);
+        memcpy(&px[row * AS_N], rowOut, sizeof(rowOut));
+    }
+
+    float colIn[AS_N], colOut[AS_N];
+    for (int col = 0; col < AS_N; col++) {
+        for (int row = 0; row < AS_N; row++) colIn[row] = px[row * AS_N + col];
+        as_dct1d_64(colIn, colOut);
+        for (int row = 0; row < AS_N; row++) px[row * AS_N + col] = colOut[row];
+    }
+
+    float topLeft[AS_BITS];
+    int idx = 0;
+    for (int r = 0; r < AS_LOW; r++) {
+        for (int c = 0; c < AS_LOW; c++) {
+            topLeft[idx++] = px[r * AS_N + c];
+        }
+    }
+
+    float sorted[AS_BITS];
+    memcpy(sorted, topLeft, sizeof(sorted));
+    qsort(sorted, AS_BITS, sizeof(float), as_float_cmp);
+
+    as_pack_bits(topLeft, sorted[AS_BITS / 2], out);
+}
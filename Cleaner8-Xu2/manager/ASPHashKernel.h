@@ -0,0 +1,31 @@
+#ifndef ASPHashKernel_h
+#define ASPHashKernel_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 256-bit 彩色 pHash 内核（纯 C，可在 Linux 上编译做校验 / benchmark）
+///
+/// 输入：64×64 RGBA8（kCGImageAlphaPremultipliedLast，行宽 256 字节）
+/// 流程：增强亮度 -> 2D DCT-II -> 取左上 16×16 -> 中位数二值化
+///
+/// 快速版只计算实际用到的 16×16 低频块（行 DCT 64×16、列 DCT 16×16），
+/// 每个输出系数的累加顺序与完整 64×64 DCT 完全一致，结果逐位相同。
+/// 向量化只跨输出系数（不拆累加链），所以不用 vDSP 的分块矩阵乘：那会改变求和顺序。
+/// 两条路径都写成 acc += a * b，clang 默认 -ffp-contract=on 下融合方式一致；不要开 -ffast-math。
+
+#define AS_PHASH_SIDE 64
+
+void as_phash256_from_rgba(const uint8_t *rgba, uint64_t out[4]);
+
+/// 原始标量实现（完整 64×64 DCT + qsort 中位数），用于金标准校验
+void as_phash256_from_rgba_reference(const uint8_t *rgba, uint64_t out[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASPHashKernel_h */
@@ -25,6 +25,11 @@ typedef NS_ENUM(NSUInteger, ASGroupType) {
     ASGroupTypeSimilarVideo
 };
 
+typedef NS_ENUM(NSUInteger, ASGroupingWindow) {
+    ASGroupingWindowDay = 0,   // 默认：只在同一天内比对
+    ASGroupingWindowGlobal,    // 跨天：相邻两天按相似阈值，全库滚动窗口按重复阈值
+};
+
 @class ASAssetModel, ASAssetGroup, ASScanSnapshot;
 
 typedef void (^ASPhotoScanProgressBlock)(ASScanSnapshot *snapshot);
@@ -80,6 +85,10 @@ typedef NS_ENUM(NSInteger, ASModuleScanState) {
 @property (nonatomic, strong) NSDate *lastUpdated;
 @property (nonatomic, strong, nullable) NSData *phash256Data;
 
+/// 扫描中：从这一天（dayStart）到最新的每一天都已收完（倒序扫描，之后不会再有这些天的资产进来）。
+/// Global 窗口下更早的重复仍可能并入这些天的组
+@property (nonatomic, strong, nullable) NSDate *closedSinceDay;
+
 @end
 
 @interface ASAssetModel : NSObject <NSSecureCoding>
@@ -95,8 +104,13 @@ typedef NS_ENUM(NSInteger, ASModuleScanState) {
 
 @property (nonatomic, strong, nullable) NSData *phash256Data;
 
+@property (nonatomic) float lumaMean; // 中心 ROI 亮度均值/标准差（曝光统计，随模糊度一起算）
+@property (nonatomic) float lumaStd;
+
 @property (nonatomic) uint64_t pHash;
-@property (nonatomic, strong, nullable) NSData *visionPrintData;
+@property (nonatomic, strong, nullable) NSData *visionPrintData; // 旧缓存里归档的 VNFeaturePrintObservation，首次比较时转成 visionFeature
+@property (nonatomic, strong, nullable) NSData *visionFeature;   // Vision 特征原始 float32 向量（L2 距离直接算）
+@property (nonatomic, strong, nullable) NSData *videoFingerprint; // 视频多帧指纹（ASVideoFingerprint），仅可比较的视频
 @end
 
 @interface ASAssetGroup : NSObject <NSSecureCoding>
@@ -104,14 +118,105 @@ typedef NS_ENUM(NSInteger, ASModuleScanState) {
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *assets;
 @end
 
+/// 9 个模块的位，顺序同 moduleStates
+typedef NS_OPTIONS(NSUInteger, ASScanModuleMask) {
+    ASScanModuleMaskSimilarImage     = 1 << 0,
+    ASScanModuleMaskSimilarVideo     = 1 << 1,
+    ASScanModuleMaskDuplicateImage   = 1 << 2,
+    ASScanModuleMaskDuplicateVideo   = 1 << 3,
+    ASScanModuleMaskScreenshots      = 1 << 4,
+    ASScanModuleMaskScreenRecordings = 1 << 5,
+    ASScanModuleMaskBigVideos        = 1 << 6,
+    ASScanModuleMaskBlurryPhotos     = 1 << 7,
+    ASScanModuleMaskOtherPhotos      = 1 << 8,
+    ASScanModuleMaskAll              = 0x1FF,
+};
+
+/// 相对上一次发布的进度变化。扫描中的多次进度在主线程按屏幕刷新合并成一次（后台时立即发布），
+/// 公开的分组 / 列表属性与它同一时刻更新
+@interface ASScanProgressDelta : NSObject
+@property (nonatomic, readonly) ASScanSnapshot *snapshot;       // 当前快照（不是拷贝，只读）
+/// 首次订阅、扫描开始 / 结束、分组被合并或删除：下标不可用，按全量重建
+@property (nonatomic, readonly) BOOL full;
+/// 状态 / 数量 / 字节 / 组成员有变化的模块
+@property (nonatomic, readonly) ASScanModuleMask changedModules;
+@property (nonatomic, readonly) NSInteger scannedCountDelta;
+@property (nonatomic, readonly) int64_t scannedBytesDelta;
+@property (nonatomic, readonly) NSInteger cleanableCountDelta;
+@property (nonatomic, readonly) int64_t cleanableBytesDelta;
+/// 新成的组：分别是 duplicateGroups / similarGroups 里的下标（similarGroups 里相似组在前，只含相似组）
+@property (nonatomic, readonly) NSIndexSet *newDuplicateGroupIndexes;
+@property (nonatomic, readonly) NSIndexSet *newSimilarGroupIndexes;
+/// module 为 0~8（同 moduleStates）。4~8 是快照里的数量 / 字节变化；0~3 的数量是该类型新成的组数，字节记 0
+///（组内变化看 cleanable*Delta）
+- (NSInteger)countDeltaForModule:(NSUInteger)module;
+- (int64_t)bytesDeltaForModule:(NSUInteger)module;
+@end
+
+typedef NS_ENUM(NSUInteger, ASGroupSortOrder) {
+    ASGroupSortOrderFormed = 0,   // 成组先后（扫描最新优先，大致是新 -> 旧）
+    ASGroupSortOrderNewest,       // 组内最新一张的时间，新 -> 旧
+    ASGroupSortOrderOldest,
+    ASGroupSortOrderLargest,      // 组内字节之和，大 -> 小
+    ASGroupSortOrderSmallest,
+};
+
+/// 某一类分组的只读视图，绑定取视图时已发布的版本：之后的扫描进度 / 删除不影响它（快照隔离）。
+/// 每个版本的下标、时间、字节在扫描线程发布时就建好，取视图和按下标读都是 O(1)，不拷贝整表；
+/// 非 Formed 顺序只排下标，同一版本每种顺序排一次。只含至少 2 个成员的组
+@interface ASGroupReadView : NSObject
+@property (nonatomic, readonly) uint64_t version;
+@property (nonatomic, readonly) ASGroupType type;
+@property (nonatomic, readonly) ASGroupSortOrder order;
+@property (nonatomic, readonly) NSUInteger groupCount;
+/// 返回的组与成员数组都是共享的，只读
+- (ASAssetGroup *)groupAtIndex:(NSUInteger)index;
+- (NSUInteger)memberCountAtIndex:(NSUInteger)index;
+/// 只拷贝这一段；range 超出部分截掉
+- (NSArray<ASAssetModel *> *)membersAtIndex:(NSUInteger)index range:(NSRange)range;
+- (uint64_t)bytesAtIndex:(NSUInteger)index;
+- (NSDate *)dateAtIndex:(NSUInteger)index;
+/// 同一版本换一种顺序
+- (ASGroupReadView *)viewSortedBy:(ASGroupSortOrder)order;
+@end
+
 typedef void(^ASScanProgressBlock)(ASScanSnapshot *snapshot);
 typedef void(^ASScanCompletionBlock)(ASScanSnapshot *snapshot, NSError *_Nullable error);
+typedef void (^ASScanProgressDeltaBlock)(ASScanProgressDelta *delta);
 typedef void (^ASScanProgressBlock)(ASScanSnapshot * _Nullable snapshot);
 
 @interface ASPhotoScanManager : NSObject <PHPhotoLibraryChangeObserver>
 
 @property (nonatomic, readonly) ASScanSnapshot *snapshot;
 
+/// 相似/重复分组窗口（opt-in，持久化；下一次扫描开始时生效）
+@property (nonatomic) ASGroupingWindow groupingWindow;
+/// Global 窗口下跨天候选索引的内存预算（图片/视频平分），默认 24MB
+@property (nonatomic) uint64_t groupingMemoryBudgetBytes;
+
+/// 全量扫描 checkpoint 统计：写入字节（base / 日志）、构建与写入耗时、压缩次数；每次全量扫描开始时清零
+- (NSDictionary<NSString *, NSNumber *> *)checkpointStats;
+
+/// 最近一次全量扫描流水线的统计：各阶段吞吐 / 单张耗时 / 队列深度与峰值、decode 线程数、热状态
+- (NSDictionary<NSString *, NSNumber *> *)pipelineStats;
+
+/// 持久化特征库命中统计：hits / misses / stale（资产被编辑过）/ puts / entries / 文件活字节与死字节；
+/// 每次全量扫描、续扫、增量重建开始时清零
+- (NSDictionary<NSString *, NSNumber *> *)featureStoreStats;
+
+/// 扫描指标（opt-in，持久化，默认关闭）：各阶段延迟直方图 / 缓存命中率 / assets/sec / checkpoint 字节，
+/// 同时打 os_signpost。关闭时埋点几乎零开销；每次全量扫描开始时清零
+@property (nonatomic) BOOL scanMetricsEnabled;
+/// 当前指标的 JSON（p50 / p90 / p99 / max，单位微秒）
+- (NSData *)scanMetricsJSON;
+
+/// 优先扫描（opt-in，持久化，0 = 关闭；下一次扫描开始时生效）：全量扫描本来就是最新优先，
+/// 开启后最近 N 天每收完一天立即发布结果（不等节流），N 天收完后其余历史降到 utility QoS、decode 并发减半回填
+@property (nonatomic) NSUInteger priorityScanDays;
+/// 最近一次全量扫描 / 续扫：firstGroupMs / firstGroupAssets（从开始到出现第一个相似/重复组，不开优先扫描也统计）/
+/// closedDays / priorityDays / priorityDoneMs / priorityAssets / backfill
+- (NSDictionary<NSString *, NSNumber *> *)priorityScanStats;
+
 @property (nonatomic, readonly) NSArray<ASAssetGroup *> *duplicateGroups;
 @property (nonatomic, readonly) NSArray<ASAssetGroup *> *similarGroups;
 @property (nonatomic, readonly) NSArray<ASAssetModel *> *screenshots;
@@ -121,6 +226,11 @@ typedef void (^ASScanProgressBlock)(ASScanSnapshot * _Nullable snapshot);
 @property (nonatomic, readonly) NSArray<ASAssetModel *> *otherPhotos;
 - (void)applyLocalDeletionsForUI:(NSArray<NSString *> *)localIds;
 
+/// 分组分页读取（任意线程）：与 duplicateGroups / similarGroups 同一份已发布数据，不拷贝
+- (ASGroupReadView *)groupReadViewForType:(ASGroupType)type order:(ASGroupSortOrder)order;
+/// 当前已发布分组的版本号；变了说明旧视图已过期
+@property (nonatomic, readonly) uint64_t groupsVersion;
+
 /// 手动触发一次「删除资产清理 + 重新统计 + 保存缓存」
 ///（可用于你想显式做一次 purge 的场景）
 - (void)purgeDeletedAssetsAndRecalculate;
@@ -142,6 +252,14 @@ typedef void (^ASScanProgressBlock)(ASScanSnapshot * _Nullable snapshot);
 
 // 停止扫描（中断）
 - (void)cancel;
+
+/// 全量扫描没跑完（正在跑，或缓存停在 Scanning）
+- (BOOL)hasUnfinishedFullScan;
+
+/// 后台处理窗口：从 checkpoint 按工作单元（fetch 下标每 512 个一段）续扫，shouldStop 返回 YES 时在
+/// 当前单元做完后落盘退出。回调在内部队列：本窗口完成的单元数 / 资产数，以及全量扫描是否已完成
+- (void)runBackgroundScanWindowUntil:(BOOL (^)(void))shouldStop
+                          completion:(void (^)(NSUInteger units, NSUInteger assets, BOOL finished))completion;
 - (NSUUID *)subscribeProgress:(ASScanProgressBlock)progress;
 
 // 选择相关：只提供“可清理全选/反选”，其他类别是真全选
@@ -152,8 +270,15 @@ typedef void (^ASScanProgressBlock)(ASScanSnapshot * _Nullable snapshot);
 /// 添加观察者，返回 token（block 为空会返回 nil）
 - (nullable NSUUID *)addProgressObserver:(ASScanProgressBlock)block;
 
+/// 增量观察者：只收合并后的变化（主线程），先收到一次 full。用 removeProgressObserver: 移除
+- (nullable NSUUID *)addProgressDeltaObserver:(ASScanProgressDeltaBlock)block;
+
 /// 移除观察者（传 nil 也安全）
 - (void)removeProgressObserver:(nullable NSUUID *)token;
+
+/// 进度发布统计（主线程口径）：emits（扫描线程请求）/ publishes（合并后实际发布）/ mainMs（主线程上赋值 + 回调观察者的耗时）/
+/// mainMsPerSec / observerMs；每次全量扫描开始时清零
+- (NSDictionary<NSString *, NSNumber *> *)progressStats;
 @end
 
 NS_ASSUME_NONNULL_END
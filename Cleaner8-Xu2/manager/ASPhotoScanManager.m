@@ -5,7 +5,23 @@
 #import <AVFoundation/AVFoundation.h>
 #import <QuartzCore/QuartzCore.h>
 #import <float.h>
+#import <os/lock.h>
 #import <Photos/Photos.h>
+#import "ASPHashIndex.h"
+#import "ASGroupForest.h"
+#import "ASTopKHeap.h"
+#import "ASAssetBitset.h"
+#import "ASFeatureArena.h"
+#import "ASFeatureExtractor.h"
+#import "ASAssetSizeService.h"
+#import "ASBackgroundScanScheduler.h"
+#import "ASFeatureStore.h"
+#import "ASScanCacheFormat.h"
+#import "ASScanJournal.h"
+#import "ASScanMetrics.h"
+#import "ASScanPipeline.h"
+#import "ASVideoFingerprint.h"
+#import "ASVideoFingerprinter.h"
 
 typedef NS_ENUM(NSInteger, ASPhotoAuthState) {
     ASPhotoAuthStateNone    = 0, // 0
@@ -50,17 +66,43 @@ static const NSUInteger kBlurKeepMin     = 0;      // 至少 40 张
 static const NSUInteger kBlurKeepMax     = 300;     // 最多 300 张
 static const NSUInteger kBlurWarmup      = 20;
 
-// 并发控制：同时处理 6 张图片（避免 OOM 和发热过高）
-static const NSInteger kASScanConcurrencyLimit = 6;
-
 // 阈值: 缩略图取 512x512
 const ASComparePolicy kPolicySimilar   = { .phashThreshold = 119, .visionThreshold = 0.56f };
 const ASComparePolicy kPolicyDuplicate = { .phashThreshold = 30,  .visionThreshold = 0.20f };
 
-static NSString * const kASCacheFileName  = @"as_photo_scan_cache_v3.dat";
+// 视频多帧指纹（两边都有时代替封面 pHash + Vision）：对齐后汉明距离中位数 / 重叠比例 / 时长比
+// 截取的片段只算相似；重复要求几乎等长且整段对上（见 Benchmarks/bench_video_fingerprint.c）
+static const float kASVideoSimilarDistance   = 12.f;
+static const float kASVideoSimilarOverlap    = 0.5f;
+static const float kASVideoDuplicateDistance = 6.f;
+static const float kASVideoDuplicateOverlap  = 0.9f;
+static const float kASVideoDuplicateDuration = 0.9f;
+
+static NSString * const kASCacheFileName  = @"as_photo_scan_cache_v4.bin";
+static NSString * const kASLegacyCacheFileName = @"as_photo_scan_cache_v3.dat"; // NSKeyedArchiver，仅用于迁移
+static NSString * const kASJournalFileName = @"as_photo_scan_cache_v4.wal";
+// 持久化特征库：不随扫描缓存删除（dropCacheFile / 强制全量）；算法变化时改版本号
+static NSString * const kASFeatureStoreFileName = @"as_feature_store_v1.bin";
+static const uint32_t kASFeatureStoreAlgoVersion = 1;
+// 日志超过 max(此值, base 大小) 时压缩回 base，总写入量随库大小线性增长
+static const uint64_t kASJournalCompactMinBytes = 8ull * 1024 * 1024;
 static NSString * const kASScanSessionKey = @"as_scan_session_id_v1";
+static NSString * const kASGroupingWindowKey = @"as_grouping_window_v1";
+static NSString * const kASScanMetricsKey = @"as_scan_metrics_enabled_v1";
+static NSString * const kASPriorityScanDaysKey = @"as_priority_scan_days_v1";
+
+// 跨天分组：默认内存预算；相邻天判定（留余量兼容夏令时）；午夜前后带入下一天的时间窗；
+// 池子每条 ObjC 映射的估算开销
+static const uint64_t       kASGroupingDefaultBudget = (uint64_t)24 * 1024ull * 1024ull;
+static const NSTimeInterval kASAdjacentDaySpan       = 36 * 3600;
+static const NSTimeInterval kASMidnightCarrySpan     = 2 * 3600;
+static const NSUInteger     kASPoolObjCBytesPerEntry = 96;
 static const uint64_t   kBigVideoMinBytes = (uint64_t)20 * 1024ull * 1024ull;
 
+// 全量扫描的工作单元：按 fetch 顺序每 kASScanUnitSize 张一段；完成情况随 checkpoint 落盘，
+// 续扫（含后台 BGProcessingTask）直接跳过已完成的单元
+static const NSUInteger kASScanUnitSize = 512;
+
 #pragma mark - Screen Metrics (One-time)
 
 typedef struct {
@@ -250,14 +292,43 @@ static inline NSString *ASStateName(ASScanState s) {
 
 #pragma mark - Helpers
 
-static inline NSString *ASCachePath(void) {
+static inline NSString *ASCachePathNamed(NSString *name) {
     NSArray *dirs = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
     NSString *dir = dirs.firstObject;
     [[NSFileManager defaultManager] createDirectoryAtPath:dir
                               withIntermediateDirectories:YES
                                                attributes:nil
                                                     error:nil];
-    return [[dir stringByAppendingPathComponent:kASCacheFileName] copy];
+    return [[dir stringByAppendingPathComponent:name] copy];
+}
+
+static inline NSString *ASCachePath(void) {
+    return ASCachePathNamed(kASCacheFileName);
+}
+
+static inline NSString *ASLegacyCachePath(void) {
+    return ASCachePathNamed(kASLegacyCacheFileName);
+}
+
+static inline NSString *ASJournalPath(void) {
+    return ASCachePathNamed(kASJournalFileName);
+}
+
+static inline NSString *ASFeatureStorePath(void) {
+    return ASCachePathNamed(kASFeatureStoreFileName);
+}
+
+// 特征库版本 = 算法版本 + Vision revision（系统升级换了 revision，旧特征不可比）
+static inline uint32_t ASFeatureStoreVersion(void) {
+    uint32_t revision = 1;
+    if (@available(iOS 17.0, *)) revision = 2;
+    return (kASFeatureStoreAlgoVersion << 8) | revision;
+}
+
+// 与 ASBlurCacheKeyForAsset 同一个时间：modificationDate，没有则 creationDate
+static inline int64_t ASFeatureModMs(NSDate *modificationDate, NSDate *creationDate) {
+    NSDate *d = modificationDate ?: creationDate;
+    return d ? (int64_t)llround(d.timeIntervalSince1970 * 1000.0) : 0;
 }
 
 static inline NSDate *ASDayStart(NSDate *date) {
@@ -347,6 +418,7 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
     [coder encodeObject:self.lastUpdated forKey:@"lastUpdated"];
     [coder encodeObject:self.phash256Data forKey:@"phash256Data"];
     [coder encodeObject:self.moduleStates forKey:@"moduleStates"];
+    [coder encodeObject:self.closedSinceDay forKey:@"closedSinceDay"];
 }
 
 - (instancetype)initWithCoder:(NSCoder *)coder {
@@ -372,6 +444,7 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
                                            forKey:@"lastUpdated"] ?: [NSDate date];
         _phash256Data = [coder decodeObjectOfClass:[NSData class]
                                             forKey:@"phash256Data"];
+        _closedSinceDay = [coder decodeObjectOfClass:[NSDate class] forKey:@"closedSinceDay"];
 
         NSSet *classes = [NSSet setWithArray:@[[NSArray class], [NSNumber class]]];
         _moduleStates = [coder decodeObjectOfClasses:classes forKey:@"moduleStates"];
@@ -384,8 +457,17 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
 
 @end
 
+@interface ASAssetModel ()
+// ASAssetTable 的行号缓存（0 = 未登记）；改 localId 时清零
+@property (nonatomic, assign) uint32_t as_row;
+@end
+
 @implementation ASAssetModel
 + (BOOL)supportsSecureCoding { return YES; }
+- (void)setLocalId:(NSString *)localId {
+    _localId = [localId copy];
+    _as_row = 0;
+}
 - (void)encodeWithCoder:(NSCoder *)coder {
     [coder encodeObject:self.localId forKey:@"localId"];
     [coder encodeInteger:self.mediaType forKey:@"mediaType"];
@@ -395,7 +477,11 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
     [coder encodeInt64:(int64_t)self.fileSizeBytes forKey:@"fileSizeBytes"];
     [coder encodeInt64:(int64_t)self.pHash forKey:@"pHash"];
     [coder encodeObject:self.visionPrintData forKey:@"visionPrintData"];
+    [coder encodeObject:self.visionFeature forKey:@"visionFeature"];
     [coder encodeObject:self.phash256Data forKey:@"phash256Data"];
+    [coder encodeObject:self.videoFingerprint forKey:@"videoFingerprint"];
+    [coder encodeFloat:self.lumaMean forKey:@"lumaMean"];
+    [coder encodeFloat:self.lumaStd forKey:@"lumaStd"];
 }
 - (instancetype)initWithCoder:(NSCoder *)coder {
     if (self=[super init]) {
@@ -407,7 +493,11 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
         _fileSizeBytes = (uint64_t)[coder decodeInt64ForKey:@"fileSizeBytes"];
         _pHash = (uint64_t)[coder decodeInt64ForKey:@"pHash"];
         _visionPrintData = [coder decodeObjectOfClass:[NSData class] forKey:@"visionPrintData"];
+        _visionFeature = [coder decodeObjectOfClass:[NSData class] forKey:@"visionFeature"];
         _phash256Data = [coder decodeObjectOfClass:[NSData class] forKey:@"phash256Data"];
+        _videoFingerprint = [coder decodeObjectOfClass:[NSData class] forKey:@"videoFingerprint"];
+        _lumaMean = [coder decodeFloatForKey:@"lumaMean"];
+        _lumaStd = [coder decodeFloatForKey:@"lumaStd"];
     }
     return self;
 }
@@ -430,6 +520,186 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
 }
 @end
 
+#pragma mark - pHash candidate pool
+
+// 相似候选池：pHash 存在 C 索引里，slot 与 model 一一对应（按插入顺序）
+@interface ASPHashPool : NSObject
+/// maxRadius：这个池子查询用的最大半径；半径太大（当天池 r=119）时只做线性扫描，不建多索引段表
+- (instancetype)initWithQueryRadius:(uint32_t)maxRadius;
+- (instancetype)init NS_UNAVAILABLE;
+@property (nonatomic, readonly) NSUInteger count;
+/// 存活上限（0 = 不限）；超出后按入池顺序淘汰最早的（滚动窗口）
+@property (nonatomic) NSUInteger maxCount;
+@property (nonatomic, readonly) NSUInteger evictedCount;
+- (void)addModel:(ASAssetModel *)m;
+- (void)removeAllObjects;
+- (void)removeModelWithLocalId:(NSString *)localId;
+/// 全部 hamming <= radius 的候选，按入池顺序
+- (NSArray<ASAssetModel *> *)candidatesForHash:(NSData *)phash256 radius:(uint32_t)radius;
+@end
+
+@implementation ASPHashPool {
+    ASPHashIndex *_index;
+    ASPHashHits _hits;
+    NSMutableArray *_models; // slot -> ASAssetModel / NSNull(已删除)
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *_slotsByLocalId;
+    NSUInteger _evictCursor;
+}
+
+- (instancetype)initWithQueryRadius:(uint32_t)maxRadius {
+    if (self = [super init]) {
+        _index = as_phash_index_create_for_radius(maxRadius);
+        _models = [NSMutableArray array];
+        _slotsByLocalId = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_phash_hits_free(&_hits);
+    as_phash_index_destroy(_index);
+}
+
+- (NSUInteger)count {
+    return as_phash_index_count(_index);
+}
+
+- (void)addModel:(ASAssetModel *)m {
+    if (m.phash256Data.length < 32) return;
+
+    uint64_t h[AS_PHASH_WORDS];
+    memcpy(h, m.phash256Data.bytes, sizeof(h));
+    uint32_t slot = as_phash_index_add(_index, h);
+    if (slot == UINT32_MAX) return;
+
+    [_models addObject:m];
+    if (m.localId.length) {
+        NSMutableIndexSet *set = _slotsByLocalId[m.localId];
+        if (!set) { set = [NSMutableIndexSet indexSet]; _slotsByLocalId[m.localId] = set; }
+        [set addIndex:slot];
+    }
+
+    if (_maxCount > 0) [self evictToMaxCount];
+}
+
+- (void)evictToMaxCount {
+    while (as_phash_index_count(_index) > _maxCount && _evictCursor < _models.count) {
+        ASAssetModel *old = _models[_evictCursor];
+        if ((id)old != [NSNull null]) {
+            as_phash_index_remove(_index, (uint32_t)_evictCursor);
+            _models[_evictCursor] = [NSNull null];
+            [_slotsByLocalId[old.localId] removeIndex:_evictCursor];
+            if (_slotsByLocalId[old.localId].count == 0) [_slotsByLocalId removeObjectForKey:old.localId];
+            _evictedCount += 1;
+        }
+        _evictCursor += 1;
+    }
+
+    // 墓碑过半时压缩，slot 空间不随窗口滚动无限增长
+    NSUInteger live = as_phash_index_count(_index);
+    if (_models.count > 4096 && _models.count > live * 2) {
+        NSMutableArray<ASAssetModel *> *alive = [NSMutableArray arrayWithCapacity:live];
+        for (id m in _models) if (m != [NSNull null]) [alive addObject:m];
+
+        NSUInteger evicted = _evictedCount;
+        NSUInteger maxCount = _maxCount;
+        _maxCount = 0;
+        [self removeAllObjects];
+        for (ASAssetModel *m in alive) [self addModel:m];
+        _maxCount = maxCount;
+        _evictedCount = evicted;
+    }
+}
+
+- (void)removeAllObjects {
+    as_phash_index_clear(_index);
+    [_models removeAllObjects];
+    [_slotsByLocalId removeAllObjects];
+    _evictCursor = 0;
+}
+
+- (void)removeModelWithLocalId:(NSString *)localId {
+    if (!localId.length) return;
+    NSIndexSet *slots = _slotsByLocalId[localId];
+    if (!slots) return;
+
+    [slots enumerateIndexesUsingBlock:^(NSUInteger slot, BOOL *stop) {
+        as_phash_index_remove(self->_index, (uint32_t)slot);
+        self->_models[slot] = [NSNull null];
+    }];
+    [_slotsByLocalId removeObjectForKey:localId];
+}
+
+- (NSArray<ASAssetModel *> *)candidatesForHash:(NSData *)phash256 radius:(uint32_t)radius {
+    if (phash256.length < 32 || as_phash_index_count(_index) == 0) return @[];
+
+    uint64_t h[AS_PHASH_WORDS];
+    memcpy(h, phash256.bytes, sizeof(h));
+    size_t n = as_phash_index_query(_index, h, radius, &_hits, NULL);
+
+    NSMutableArray<ASAssetModel *> *out = [NSMutableArray arrayWithCapacity:n];
+    for (size_t i = 0; i < n; i++) {
+        id m = _models[_hits.slots[i]];
+        if (m != [NSNull null]) [out addObject:m];
+    }
+    return out;
+}
+
+@end
+
+#pragma mark - Vision feature arena
+
+// 新算出的 Vision 特征存进 C arena（按块分配、不移动），model.visionFeature 直接引用行内存；
+// 从缓存读出的特征引用 mmap 的 BLOB，同样不拷贝。距离一律走 as_feature_l2，不再解档 / computeDistance。
+@interface ASFeaturePrintArena : NSObject
+@property (nonatomic, readonly) NSUInteger count;
+/// 拷贝一行进 arena，返回引用该行的 NSData（持有 arena）；维度与 arena 不一致时返回独立拷贝
+- (NSData *)adoptFeature:(const float *)row count:(uint32_t)dim;
+@end
+
+@implementation ASFeaturePrintArena {
+    ASFeatureArena *_arena;
+}
+
+- (void)dealloc {
+    as_feature_arena_destroy(_arena);
+}
+
+- (NSUInteger)count {
+    return _arena ? as_feature_arena_count(_arena) : 0;
+}
+
+- (NSData *)adoptFeature:(const float *)row count:(uint32_t)dim {
+    if (!row || dim == 0) return nil;
+    if (!_arena) _arena = as_feature_arena_create(dim);
+
+    uint32_t slot = (_arena && as_feature_arena_dim(_arena) == dim) ? as_feature_arena_add(_arena, row) : UINT32_MAX;
+    if (slot == UINT32_MAX) return [NSData dataWithBytes:row length:(NSUInteger)dim * sizeof(float)];
+
+    return [[NSData alloc] initWithBytesNoCopy:(void *)as_feature_arena_row(_arena, slot)
+                                        length:(NSUInteger)dim * sizeof(float)
+                                   deallocator:^(void *bytes, NSUInteger length) {
+        (void)self; // 行内存归 arena，最后一个引用释放前 arena 不销毁
+    }];
+}
+
+@end
+
+// VNFeaturePrintObservation -> float32 行（Revision1/2 都是 float，double 的做一次转换）
+static NSData *ASAdoptFeaturePrint(ASFeaturePrintArena *arena, VNFeaturePrintObservation *obs) {
+    NSUInteger n = obs.elementCount;
+    if (n == 0 || n > UINT32_MAX) return nil;
+    if (obs.elementType == VNElementTypeFloat && obs.data.length >= n * sizeof(float)) {
+        return [arena adoptFeature:(const float *)obs.data.bytes count:(uint32_t)n];
+    }
+    if (obs.elementType == VNElementTypeDouble && obs.data.length >= n * sizeof(double)) {
+        NSMutableData *tmp = [NSMutableData dataWithLength:n * sizeof(float)];
+        vDSP_vdpsp((const double *)obs.data.bytes, 1, (float *)tmp.mutableBytes, 1, n);
+        return [arena adoptFeature:(const float *)tmp.bytes count:(uint32_t)n];
+    }
+    return nil;
+}
+
 #pragma mark - Cache container
 
 @interface ASScanCache : NSObject <NSSecureCoding>
@@ -469,6 +739,14 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
 @property (nonatomic, strong) NSDate *anchorDate;
 @property (nonatomic, strong) NSDate *homeStatRefreshDate;
 @property (nonatomic, assign) float blurScore;
+
+// 已并入本 base 的最后一个日志帧 seq（只存在于 v4 元数据里）
+@property (nonatomic, assign) NSUInteger journalSeq;
+
+// 工作单元（只存在于 v4 元数据里）：划分时的资产总数、单元大小、已完成位图
+@property (nonatomic, assign) NSUInteger scanUnitAssetCount;
+@property (nonatomic, assign) NSUInteger scanUnitSize;
+@property (nonatomic, copy, nullable) NSData *scanUnitsDone;
 @end
 
 @implementation ASScanCache
@@ -575,6 +853,1218 @@ static inline BOOL ASAllowedForCompare(PHAsset *a) {
 }
 @end
 
+#pragma mark - ASAssetGroupIndex (union-find)
+
+// 相似 / 重复分组的并查集索引：model -> 紧凑下标，两棵森林共用下标空间。
+// 入组、两组合并、可清理汇总都是 O(α(n))；ASAssetGroup 只在有人读的时候物化（结果缓存到下次变更）。
+@interface ASAssetGroupIndex : NSObject
+- (instancetype)initWithDuplicateGroups:(NSArray<ASAssetGroup *> *)dup similarGroups:(NSArray<ASAssetGroup *> *)sim;
+/// 返回 YES = 两个 model 原本不在同一组
+- (BOOL)unionModel:(ASAssetModel *)a with:(ASAssetModel *)b duplicate:(BOOL)duplicate;
+- (BOOL)isModel:(ASAssetModel *)a inSameGroupAs:(ASAssetModel *)b duplicate:(BOOL)duplicate;
+/// 这一对还要判什么；没入过组的 model 一律 AS_PAIR_FULL
+- (ASPairNeed)needForModel:(ASAssetModel *)a with:(ASAssetModel *)b;
+/// 物化结果（只读快照，不要修改）；组按成组先后，成员按加入顺序
+- (NSArray<ASAssetGroup *> *)groupsDuplicate:(BOOL)duplicate;
+@property (nonatomic, readonly) NSUInteger duplicateGroupCount;
+@property (nonatomic, readonly) NSUInteger similarGroupCount;
+/// 与 recomputeCleanableStatsFast 原口径一致：重复组 + 相似组各自「除第一张」之和
+@property (nonatomic, readonly) uint64_t cleanableBytes;
+@property (nonatomic, readonly) NSUInteger cleanableCount;
+@end
+
+@implementation ASAssetGroupIndex {
+    ASGroupForest *_dup;
+    ASGroupForest *_sim;
+    NSMapTable<ASAssetModel *, NSNumber *> *_indexOf;
+    NSMutableArray<ASAssetModel *> *_models;
+    NSArray<ASAssetGroup *> *_dupCache;
+    NSArray<ASAssetGroup *> *_simCache;
+}
+
+- (instancetype)initWithDuplicateGroups:(NSArray<ASAssetGroup *> *)dup similarGroups:(NSArray<ASAssetGroup *> *)sim {
+    if (self = [super init]) {
+        _dup = as_forest_create();
+        _sim = as_forest_create();
+        _indexOf = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsStrongMemory
+                                         valueOptions:NSPointerFunctionsStrongMemory];
+        _models = [NSMutableArray array];
+
+        // 按数组顺序给成员编号，物化时成员 / 组的顺序与原来一致
+        for (ASAssetGroup *g in dup) [self seedGroup:g duplicate:YES];
+        for (ASAssetGroup *g in sim) [self seedGroup:g duplicate:NO];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_forest_destroy(_dup);
+    as_forest_destroy(_sim);
+}
+
+- (void)seedGroup:(ASAssetGroup *)g duplicate:(BOOL)duplicate {
+    ASAssetModel *head = nil;
+    for (ASAssetModel *m in g.assets) {
+        if (!head) { head = m; [self indexForModel:m]; continue; }
+        [self unionModel:head with:m duplicate:duplicate];
+    }
+}
+
+- (uint32_t)indexForModel:(ASAssetModel *)m {
+    NSNumber *n = [_indexOf objectForKey:m];
+    if (n) return n.unsignedIntValue;
+    uint8_t tag = (m.mediaType == PHAssetMediaTypeVideo) ? 1 : 0;
+    uint32_t i = as_forest_add(_dup, m.fileSizeBytes, tag);
+    as_forest_add(_sim, m.fileSizeBytes, tag);
+    [_indexOf setObject:@(i) forKey:m];
+    [_models addObject:m];
+    return i;
+}
+
+- (BOOL)unionModel:(ASAssetModel *)a with:(ASAssetModel *)b duplicate:(BOOL)duplicate {
+    uint32_t ia = [self indexForModel:a], ib = [self indexForModel:b];
+    if (!as_forest_union(duplicate ? _dup : _sim, ia, ib)) return NO;
+    if (duplicate) _dupCache = nil;
+    else _simCache = nil;
+    return YES;
+}
+
+- (BOOL)isModel:(ASAssetModel *)a inSameGroupAs:(ASAssetModel *)b duplicate:(BOOL)duplicate {
+    NSNumber *na = [_indexOf objectForKey:a], *nb = [_indexOf objectForKey:b];
+    if (!na || !nb) return NO;
+    ASGroupForest *f = duplicate ? _dup : _sim;
+    return as_forest_find(f, na.unsignedIntValue) == as_forest_find(f, nb.unsignedIntValue);
+}
+
+- (ASPairNeed)needForModel:(ASAssetModel *)a with:(ASAssetModel *)b {
+    NSNumber *na = [_indexOf objectForKey:a], *nb = [_indexOf objectForKey:b];
+    if (!na || !nb) return AS_PAIR_FULL;
+    return as_forest_pair_need(_sim, _dup, na.unsignedIntValue, nb.unsignedIntValue);
+}
+
+- (NSArray<ASAssetGroup *> *)groupsDuplicate:(BOOL)duplicate {
+    NSArray *cached = duplicate ? _dupCache : _simCache;
+    if (cached) return cached;
+
+    ASGroupForest *f = duplicate ? _dup : _sim;
+    uint32_t groupCount = as_forest_group_count(f);
+    NSMutableArray<ASAssetGroup *> *out = [NSMutableArray arrayWithCapacity:groupCount];
+    if (groupCount) {
+        uint32_t *roots = malloc(sizeof(uint32_t) * groupCount);
+        uint32_t *members = malloc(sizeof(uint32_t) * MAX(as_forest_count(f), 1u));
+        uint32_t n = as_forest_groups(f, roots);
+        for (uint32_t gi = 0; gi < n; gi++) {
+            uint32_t k = as_forest_members(f, roots[gi], members);
+            BOOL video = as_forest_tag(f, roots[gi]) == 1;
+            ASAssetGroup *g = [ASAssetGroup new];
+            g.type = duplicate ? (video ? ASGroupTypeDuplicateVideo : ASGroupTypeDuplicateImage)
+                               : (video ? ASGroupTypeSimilarVideo : ASGroupTypeSimilarImage);
+            g.assets = [NSMutableArray arrayWithCapacity:k];
+            for (uint32_t j = 0; j < k; j++) [g.assets addObject:_models[members[j]]];
+            [out addObject:g];
+        }
+        free(roots);
+        free(members);
+    }
+    if (duplicate) _dupCache = out;
+    else _simCache = out;
+    return out;
+}
+
+- (NSUInteger)duplicateGroupCount { return as_forest_group_count(_dup); }
+- (NSUInteger)similarGroupCount { return as_forest_group_count(_sim); }
+- (uint64_t)cleanableBytes { return as_forest_cleanable_bytes(_dup) + as_forest_cleanable_bytes(_sim); }
+- (NSUInteger)cleanableCount { return (NSUInteger)(as_forest_cleanable_count(_dup) + as_forest_cleanable_count(_sim)); }
+@end
+
+#pragma mark - ASBlurryTopK (bounded heap)
+
+// 模糊 Top-K：ASTopKHeap 存 (blurScore, 槽位)，槽位 -> model、localId -> 槽位两张表，空出的槽位复用。
+// 加入 / 挤出 / 按条件删除都是 O(log K)；升序数组只在发布快照、写缓存时排一次（缓存到下次变更）。
+@interface ASBlurryTopK : NSObject
+/// models：缓存里的升序列表，原样恢复（同分的先后也不变）
+- (instancetype)initWithModels:(nullable NSArray<ASAssetModel *> *)models;
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) uint64_t totalBytes;
+/// 准入同原升序数组：满 limit 张后只有比最不糊的那张更糊才进，并挤掉它（*evicted）。
+/// 同一 localId 已在表里时先移除旧的（资产被编辑后重扫）
+- (BOOL)offerModel:(ASAssetModel *)m limit:(NSUInteger)limit evicted:(ASAssetModel * _Nullable * _Nullable)evicted;
+/// 最不糊的那张（堆顶）
+- (nullable ASAssetModel *)leastBlurry;
+- (nullable ASAssetModel *)popLeastBlurry;
+- (void)removeModelsPassingTest:(BOOL (^)(ASAssetModel *m))test;
+/// 升序（最糊在前）；未变更时返回同一个数组
+- (NSArray<ASAssetModel *> *)sortedModels;
+@end
+
+@implementation ASBlurryTopK {
+    ASTopKHeap *_heap;
+    NSMutableArray *_slots;                                  // 槽位 -> model（空槽 NSNull）
+    NSMutableArray<NSNumber *> *_freeSlots;
+    NSMutableDictionary<NSString *, NSNumber *> *_slotOfId;
+    NSArray<ASAssetModel *> *_sorted;
+    uint64_t _bytes;
+}
+
+- (instancetype)initWithModels:(NSArray<ASAssetModel *> *)models {
+    if (self = [super init]) {
+        _heap = as_topk_create();
+        _slots = [NSMutableArray array];
+        _freeSlots = [NSMutableArray array];
+        _slotOfId = [NSMutableDictionary dictionary];
+        for (ASAssetModel *m in models) {
+            if (m.localId.length && _slotOfId[m.localId]) continue;
+            uint32_t slot = [self as_takeSlot:m];
+            as_topk_push(_heap, m.blurScore, slot);
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_topk_destroy(_heap);
+}
+
+- (uint32_t)as_takeSlot:(ASAssetModel *)m {
+    uint32_t slot;
+    if (_freeSlots.count) {
+        slot = _freeSlots.lastObject.unsignedIntValue;
+        [_freeSlots removeLastObject];
+        _slots[slot] = m;
+    } else {
+        slot = (uint32_t)_slots.count;
+        [_slots addObject:m];
+    }
+    if (m.localId.length) _slotOfId[m.localId] = @(slot);
+    _bytes += m.fileSizeBytes;
+    _sorted = nil;
+    return slot;
+}
+
+- (ASAssetModel *)as_releaseSlot:(uint32_t)slot {
+    ASAssetModel *m = _slots[slot];
+    _slots[slot] = [NSNull null];
+    [_freeSlots addObject:@(slot)];
+    if (m.localId.length) [_slotOfId removeObjectForKey:m.localId];
+    _bytes = _bytes >= m.fileSizeBytes ? _bytes - m.fileSizeBytes : 0;
+    _sorted = nil;
+    return m;
+}
+
+- (NSUInteger)count { return as_topk_count(_heap); }
+- (uint64_t)totalBytes { return _bytes; }
+
+- (BOOL)offerModel:(ASAssetModel *)m limit:(NSUInteger)limit evicted:(ASAssetModel **)evicted {
+    if (evicted) *evicted = nil;
+    if (!m || limit == 0) return NO;
+
+    NSNumber *old = m.localId.length ? _slotOfId[m.localId] : nil;
+    if (old) {
+        as_topk_remove(_heap, old.unsignedIntValue);
+        [self as_releaseSlot:old.unsignedIntValue];
+    }
+
+    // 先判准入，进得来才占槽位
+    ASTopKItem top;
+    if (as_topk_count(_heap) >= limit && as_topk_peek(_heap, &top) && !(m.blurScore < top.score)) return NO;
+
+    uint32_t slot = [self as_takeSlot:m];
+    uint32_t out = AS_TOPK_NONE;
+    if (!as_topk_offer(_heap, m.blurScore, slot, (uint32_t)MIN(limit, (NSUInteger)UINT32_MAX), &out)) {
+        [self as_releaseSlot:slot];
+        return NO;
+    }
+    if (out != AS_TOPK_NONE) {
+        ASAssetModel *gone = [self as_releaseSlot:out];
+        if (evicted) *evicted = gone;
+    }
+    return YES;
+}
+
+- (ASAssetModel *)leastBlurry {
+    ASTopKItem top;
+    return as_topk_peek(_heap, &top) ? _slots[top.id] : nil;
+}
+
+- (ASAssetModel *)popLeastBlurry {
+    ASTopKItem top;
+    if (!as_topk_pop(_heap, &top)) return nil;
+    return [self as_releaseSlot:top.id];
+}
+
+- (void)removeModelsPassingTest:(BOOL (^)(ASAssetModel *))test {
+    NSUInteger n = _slots.count;
+    for (NSUInteger i = 0; i < n; i++) {
+        id m = _slots[i];
+        if (m == [NSNull null] || !test(m)) continue;
+        as_topk_remove(_heap, (uint32_t)i);
+        [self as_releaseSlot:(uint32_t)i];
+    }
+}
+
+- (NSArray<ASAssetModel *> *)sortedModels {
+    if (_sorted) return _sorted;
+    uint32_t n = as_topk_count(_heap);
+    NSMutableArray<ASAssetModel *> *out = [NSMutableArray arrayWithCapacity:n];
+    if (n) {
+        ASTopKItem *items = malloc(sizeof(ASTopKItem) * n);
+        n = as_topk_sorted(_heap, items);
+        for (uint32_t i = 0; i < n; i++) [out addObject:_slots[items[i].id]];
+        free(items);
+    }
+    _sorted = [out copy];
+    return _sorted;
+}
+@end
+
+#pragma mark - ASAssetTable (localId interning)
+
+// 进程内把 localId 登记成稠密行号（从 1 开始，0 = 无），行号缓存在 model 上，之后不再哈希字符串。
+// 只增不删（删掉的资产只是行号闲置，一次会话最多多占几个 bit）；加锁，任意线程可用。
+@interface ASAssetTable : NSObject
++ (instancetype)shared;
+@property (nonatomic, readonly) uint32_t count;
+/// 没登记就登记
+- (uint32_t)rowForLocalId:(NSString *)localId;
+- (uint32_t)rowForModel:(ASAssetModel *)m;
+/// 没登记返回 0（查询不应让表长大）
+- (uint32_t)existingRowForLocalId:(NSString *)localId;
+- (nullable NSString *)localIdAtRow:(uint32_t)row;
+@end
+
+@implementation ASAssetTable {
+    os_unfair_lock _lock;
+    NSMutableDictionary<NSString *, NSNumber *> *_rowOfId;
+    NSMutableArray<NSString *> *_ids;   // 行号 -> localId；[0] 占位
+}
+
++ (instancetype)shared {
+    static ASAssetTable *t;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{ t = [ASAssetTable new]; });
+    return t;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _rowOfId = [NSMutableDictionary dictionary];
+        _ids = [NSMutableArray arrayWithObject:@""];
+    }
+    return self;
+}
+
+- (uint32_t)count {
+    os_unfair_lock_lock(&_lock);
+    uint32_t n = (uint32_t)_ids.count - 1;
+    os_unfair_lock_unlock(&_lock);
+    return n;
+}
+
+- (uint32_t)rowForLocalId:(NSString *)localId {
+    if (!localId.length) return 0;
+    os_unfair_lock_lock(&_lock);
+    uint32_t row = _rowOfId[localId].unsignedIntValue;
+    if (!row) {
+        NSString *key = [localId copy];
+        row = (uint32_t)_ids.count;
+        [_ids addObject:key];
+        _rowOfId[key] = @(row);
+    }
+    os_unfair_lock_unlock(&_lock);
+    return row;
+}
+
+- (uint32_t)rowForModel:(ASAssetModel *)m {
+    uint32_t row = m.as_row;
+    if (row) return row;
+    row = [self rowForLocalId:m.localId];
+    m.as_row = row;
+    return row;
+}
+
+- (uint32_t)existingRowForLocalId:(NSString *)localId {
+    if (!localId.length) return 0;
+    os_unfair_lock_lock(&_lock);
+    uint32_t row = _rowOfId[localId].unsignedIntValue;
+    os_unfair_lock_unlock(&_lock);
+    return row;
+}
+
+- (NSString *)localIdAtRow:(uint32_t)row {
+    os_unfair_lock_lock(&_lock);
+    NSString *lid = (row && row < _ids.count) ? _ids[row] : nil;
+    os_unfair_lock_unlock(&_lock);
+    return lid;
+}
+@end
+
+// 资产集合（位图）：代替 NSMutableSet<NSString *> 做成员判断 / 去重 / 差集
+@interface ASAssetIdSet : NSObject
+- (instancetype)initWithLocalIds:(nullable id<NSFastEnumeration>)localIds;
+@property (nonatomic, readonly) NSUInteger count;
+/// 新加入返回 YES
+- (BOOL)addModel:(ASAssetModel *)m;
+- (BOOL)addLocalId:(NSString *)localId;
+- (void)addModels:(nullable NSArray<ASAssetModel *> *)models;
+- (BOOL)containsModel:(ASAssetModel *)m;
+- (BOOL)containsLocalId:(NSString *)localId;
+- (void)minusSet:(ASAssetIdSet *)other;
+- (NSArray<NSString *> *)allLocalIds;
+@end
+
+@implementation ASAssetIdSet {
+    ASAssetBitset *_bits;
+}
+
+- (instancetype)init { return [self initWithLocalIds:nil]; }
+
+- (instancetype)initWithLocalIds:(id<NSFastEnumeration>)localIds {
+    if (self = [super init]) {
+        _bits = as_bitset_create([ASAssetTable shared].count + 1);
+        for (NSString *lid in localIds) [self addLocalId:lid];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_bitset_destroy(_bits);
+}
+
+- (NSUInteger)count { return as_bitset_count(_bits); }
+
+- (BOOL)addModel:(ASAssetModel *)m {
+    uint32_t row = m ? [[ASAssetTable shared] rowForModel:m] : 0;
+    return row && as_bitset_set(_bits, row);
+}
+
+- (BOOL)addLocalId:(NSString *)localId {
+    uint32_t row = [[ASAssetTable shared] rowForLocalId:localId];
+    return row && as_bitset_set(_bits, row);
+}
+
+- (void)addModels:(NSArray<ASAssetModel *> *)models {
+    ASAssetTable *t = [ASAssetTable shared];
+    for (ASAssetModel *m in models) {
+        uint32_t row = [t rowForModel:m];
+        if (row) as_bitset_set(_bits, row);
+    }
+}
+
+- (BOOL)containsModel:(ASAssetModel *)m {
+    return m && as_bitset_test(_bits, [[ASAssetTable shared] rowForModel:m]);
+}
+
+- (BOOL)containsLocalId:(NSString *)localId {
+    uint32_t row = [[ASAssetTable shared] existingRowForLocalId:localId];
+    return row && as_bitset_test(_bits, row);
+}
+
+- (void)minusSet:(ASAssetIdSet *)other {
+    if (other) as_bitset_andnot(_bits, other->_bits);
+}
+
+- (NSArray<NSString *> *)allLocalIds {
+    ASAssetTable *t = [ASAssetTable shared];
+    NSMutableArray<NSString *> *out = [NSMutableArray arrayWithCapacity:as_bitset_count(_bits)];
+    for (uint32_t r = as_bitset_next(_bits, 1); r != AS_BITSET_END; r = as_bitset_next(_bits, r + 1)) {
+        NSString *lid = [t localIdAtRow:r];
+        if (lid) [out addObject:lid];
+    }
+    return out;
+}
+@end
+
+#pragma mark - ASScanUnitPlan (resumable work units)
+
+// 全量扫描按 fetch 下标切成等长单元。单元内按 localId 跳过已处理的资产，所以重做一个单元是幂等的；
+// 完成位图随 checkpoint 与扫描结果一起落盘。相册总数变了（下标错位）就重新划分，只靠 localId 跳过
+@interface ASScanUnitPlan : NSObject
+- (instancetype)initWithAssetCount:(NSUInteger)assetCount unitSize:(NSUInteger)unitSize;
+/// 缓存里的划分与当前相册对得上才恢复，否则返回 nil
++ (nullable instancetype)planFromCache:(ASScanCache *)c assetCount:(NSUInteger)assetCount;
+@property (nonatomic, readonly) NSUInteger assetCount;
+@property (nonatomic, readonly) NSUInteger unitSize;
+@property (nonatomic, readonly) NSUInteger unitCount;
+@property (nonatomic, readonly) NSUInteger doneCount;
+- (NSRange)rangeOfUnit:(NSUInteger)unit;
+- (BOOL)isUnitDone:(NSUInteger)unit;
+- (void)markUnitDone:(NSUInteger)unit;
+- (NSData *)doneBits;
+- (void)writeToCache:(ASScanCache *)c;
+@end
+
+@implementation ASScanUnitPlan {
+    NSMutableData *_bits;
+}
+
+- (instancetype)initWithAssetCount:(NSUInteger)assetCount unitSize:(NSUInteger)unitSize {
+    if (self = [super init]) {
+        _assetCount = assetCount;
+        _unitSize = MAX(unitSize, (NSUInteger)1);
+        _unitCount = (assetCount + _unitSize - 1) / _unitSize;
+        _bits = [NSMutableData dataWithLength:(_unitCount + 7) / 8];
+    }
+    return self;
+}
+
++ (instancetype)planFromCache:(ASScanCache *)c assetCount:(NSUInteger)assetCount {
+    if (c.scanUnitSize == 0 || c.scanUnitAssetCount != assetCount) return nil;
+    ASScanUnitPlan *p = [[ASScanUnitPlan alloc] initWithAssetCount:assetCount unitSize:c.scanUnitSize];
+    if (c.scanUnitsDone.length != p->_bits.length) return nil;
+    [p->_bits setData:c.scanUnitsDone];
+    const uint8_t *b = p->_bits.bytes;
+    for (NSUInteger i = 0; i < p->_bits.length; i++) p->_doneCount += (NSUInteger)__builtin_popcount(b[i]);
+    return p;
+}
+
+- (NSRange)rangeOfUnit:(NSUInteger)unit {
+    NSUInteger loc = unit * _unitSize;
+    return NSMakeRange(loc, MIN(_unitSize, _assetCount - loc));
+}
+
+- (BOOL)isUnitDone:(NSUInteger)unit {
+    return unit < _unitCount && (((const uint8_t *)_bits.bytes)[unit / 8] >> (unit % 8)) & 1;
+}
+
+- (void)markUnitDone:(NSUInteger)unit {
+    if (unit >= _unitCount || [self isUnitDone:unit]) return;
+    ((uint8_t *)_bits.mutableBytes)[unit / 8] |= (uint8_t)(1u << (unit % 8));
+    _doneCount += 1;
+}
+
+- (NSData *)doneBits { return [_bits copy]; }
+
+- (void)writeToCache:(ASScanCache *)c {
+    c.scanUnitAssetCount = _assetCount;
+    c.scanUnitSize = _unitSize;
+    c.scanUnitsDone = [self doneBits];
+}
+@end
+
+#pragma mark - Progress delta
+
+// 上一次发布时的计数（不克隆整个快照）
+typedef struct {
+    NSUInteger scannedCount, cleanableCount;
+    uint64_t scannedBytes, cleanableBytes;
+    NSUInteger moduleCount[9];
+    uint64_t moduleBytes[9];
+    NSInteger moduleState[9];
+    NSUInteger dupGroups, simGroups;
+} ASProgressCounters;
+
+static void ASReadProgressCounters(ASScanSnapshot *s, NSUInteger dupGroups, NSUInteger simGroups, ASProgressCounters *c) {
+    memset(c, 0, sizeof(*c));
+    c->scannedCount = s.scannedCount;     c->scannedBytes = s.scannedBytes;
+    c->cleanableCount = s.cleanableCount; c->cleanableBytes = s.cleanableBytes;
+    c->moduleCount[4] = s.screenshotCount;      c->moduleBytes[4] = s.screenshotBytes;
+    c->moduleCount[5] = s.screenRecordingCount; c->moduleBytes[5] = s.screenRecordingBytes;
+    c->moduleCount[6] = s.bigVideoCount;        c->moduleBytes[6] = s.bigVideoBytes;
+    c->moduleCount[7] = s.blurryCount;          c->moduleBytes[7] = s.blurryBytes;
+    c->moduleCount[8] = s.otherCount;           c->moduleBytes[8] = s.otherBytes;
+    NSArray<NSNumber *> *st = s.moduleStates;
+    for (NSUInteger i = 0; i < 9 && i < st.count; i++) c->moduleState[i] = st[i].integerValue;
+    c->dupGroups = dupGroups;
+    c->simGroups = simGroups;
+}
+
+@interface ASScanProgressDelta ()
+@property (nonatomic, readwrite) ASScanSnapshot *snapshot;
+@property (nonatomic, readwrite) BOOL full;
+@property (nonatomic, readwrite) ASScanModuleMask changedModules;
+@property (nonatomic, readwrite) NSInteger scannedCountDelta;
+@property (nonatomic, readwrite) int64_t scannedBytesDelta;
+@property (nonatomic, readwrite) NSInteger cleanableCountDelta;
+@property (nonatomic, readwrite) int64_t cleanableBytesDelta;
+@property (nonatomic, readwrite) NSIndexSet *newDuplicateGroupIndexes;
+@property (nonatomic, readwrite) NSIndexSet *newSimilarGroupIndexes;
+@end
+
+@implementation ASScanProgressDelta {
+    NSInteger _countDelta[9];
+    int64_t _bytesDelta[9];
+}
+
+// 全量：changedModules 全置位，差值为 0
++ (instancetype)fullDeltaWithSnapshot:(ASScanSnapshot *)snap {
+    ASScanProgressDelta *d = [ASScanProgressDelta new];
+    d.snapshot = snap;
+    d.full = YES;
+    d.changedModules = ASScanModuleMaskAll;
+    d.newDuplicateGroupIndexes = [NSIndexSet indexSet];
+    d.newSimilarGroupIndexes = [NSIndexSet indexSet];
+    return d;
+}
+
+// dirty：扫描线程标记的组成员变化（快照里看不出是哪一类组）
++ (instancetype)deltaFrom:(const ASProgressCounters *)a to:(const ASProgressCounters *)b
+                 snapshot:(ASScanSnapshot *)snap dup:(NSArray<ASAssetGroup *> *)dup sim:(NSArray<ASAssetGroup *> *)sim
+                    dirty:(ASScanModuleMask)dirty {
+    if (b->dupGroups < a->dupGroups || b->simGroups < a->simGroups) return [self fullDeltaWithSnapshot:snap];
+
+    ASScanProgressDelta *d = [ASScanProgressDelta new];
+    d.snapshot = snap;
+    d.scannedCountDelta = (NSInteger)b->scannedCount - (NSInteger)a->scannedCount;
+    d.scannedBytesDelta = (int64_t)b->scannedBytes - (int64_t)a->scannedBytes;
+    d.cleanableCountDelta = (NSInteger)b->cleanableCount - (NSInteger)a->cleanableCount;
+    d.cleanableBytesDelta = (int64_t)b->cleanableBytes - (int64_t)a->cleanableBytes;
+
+    ASScanModuleMask mask = dirty;
+    for (NSUInteger i = 0; i < 9; i++) {
+        d->_countDelta[i] = (NSInteger)b->moduleCount[i] - (NSInteger)a->moduleCount[i];
+        d->_bytesDelta[i] = (int64_t)b->moduleBytes[i] - (int64_t)a->moduleBytes[i];
+        if (d->_countDelta[i] || d->_bytesDelta[i] || a->moduleState[i] != b->moduleState[i]) mask |= (1u << i);
+    }
+
+    // 组按成组先后物化，新组在末尾；公开的 similarGroups 是 sim + dup，相似组下标不变
+    NSRange dupNew = NSMakeRange(a->dupGroups, b->dupGroups - a->dupGroups);
+    NSRange simNew = NSMakeRange(a->simGroups, b->simGroups - a->simGroups);
+    for (NSUInteger i = dupNew.location; i < NSMaxRange(dupNew) && i < dup.count; i++) {
+        NSUInteger m = dup[i].type == ASGroupTypeDuplicateVideo ? 3 : 2;
+        d->_countDelta[m] += 1;
+        mask |= (1u << m);
+    }
+    for (NSUInteger i = simNew.location; i < NSMaxRange(simNew) && i < sim.count; i++) {
+        NSUInteger m = sim[i].type == ASGroupTypeSimilarVideo ? 1 : 0;
+        d->_countDelta[m] += 1;
+        mask |= (1u << m);
+    }
+    d.newDuplicateGroupIndexes = [NSIndexSet indexSetWithIndexesInRange:dupNew];
+    d.newSimilarGroupIndexes = [NSIndexSet indexSetWithIndexesInRange:simNew];
+    d.changedModules = mask;
+    return d;
+}
+
+- (NSInteger)countDeltaForModule:(NSUInteger)module {
+    return module < 9 ? _countDelta[module] : 0;
+}
+
+- (int64_t)bytesDeltaForModule:(NSUInteger)module {
+    return module < 9 ? _bytesDelta[module] : 0;
+}
+
+@end
+
+#pragma mark - Group read view
+
+typedef struct {
+    uint32_t *idx;      // 在来源数组里的下标（成组先后）
+    double *date;       // 组内最新一张（creationDate ?: modificationDate）
+    uint64_t *bytes;
+    uint32_t count;
+    uint32_t *sorted[ASGroupSortOrderSmallest + 1];  // 各顺序的排列（下标指向本表），按需建
+} ASGroupTypeTable;
+
+// 一个版本的分组：来源数组 + 四种类型的表。建好后只追加排序缓存（加锁）
+@interface ASGroupStore : NSObject
+@property (nonatomic, readonly) uint64_t version;
+@property (nonatomic, readonly) NSArray<ASAssetGroup *> *dupSource, *simSource;
+- (instancetype)initWithDuplicateGroups:(NSArray<ASAssetGroup *> *)dup similarGroups:(NSArray<ASAssetGroup *> *)sim;
+@end
+
+@interface ASGroupReadView ()
+- (instancetype)initWithStore:(ASGroupStore *)store type:(ASGroupType)type order:(ASGroupSortOrder)order;
+@end
+
+typedef struct { double key; uint32_t pos; } ASGroupSortKey;
+
+static int ASGroupSortKeyCmp(const void *a, const void *b) {
+    const ASGroupSortKey *x = a, *y = b;
+    if (x->key < y->key) return -1;
+    if (x->key > y->key) return 1;
+    return x->pos < y->pos ? -1 : (x->pos > y->pos);
+}
+
+@implementation ASGroupStore {
+    ASGroupTypeTable _tables[4];
+    os_unfair_lock _sortLock;
+}
+
+- (instancetype)initWithDuplicateGroups:(NSArray<ASAssetGroup *> *)dup similarGroups:(NSArray<ASAssetGroup *> *)sim {
+    if (self = [super init]) {
+        static _Atomic uint64_t gVersion = 0;
+        _version = ++gVersion;
+        _dupSource = dup ?: @[];
+        _simSource = sim ?: @[];
+        _sortLock = OS_UNFAIR_LOCK_INIT;
+        [self buildFrom:_dupSource];
+        [self buildFrom:_simSource];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (int t = 0; t < 4; t++) {
+        free(_tables[t].idx); free(_tables[t].date); free(_tables[t].bytes);
+        for (int o = 0; o <= ASGroupSortOrderSmallest; o++) free(_tables[t].sorted[o]);
+    }
+}
+
+// 公开的 similarGroups 是 sim + dup 合并的，按类型过滤即可
+- (void)buildFrom:(NSArray<ASAssetGroup *> *)groups {
+    uint32_t cap[4] = {0, 0, 0, 0};
+    for (ASAssetGroup *g in groups) if (g.type < 4) cap[g.type] += 1;
+    for (int t = 0; t < 4; t++) {
+        if (!cap[t] || _tables[t].idx) continue;
+        _tables[t].idx = malloc(sizeof(uint32_t) * cap[t]);
+        _tables[t].date = malloc(sizeof(double) * cap[t]);
+        _tables[t].bytes = malloc(sizeof(uint64_t) * cap[t]);
+    }
+
+    uint32_t i = 0;
+    for (ASAssetGroup *g in groups) {
+        uint32_t gi = i++;
+        if (g.type >= 4 || g.assets.count < 2) continue;
+        ASGroupTypeTable *tb = &_tables[g.type];
+        if (!tb->idx) continue;   // 同一类型只从一个来源建
+        double date = 0;
+        uint64_t bytes = 0;
+        for (ASAssetModel *m in g.assets) {
+            NSDate *d = m.creationDate ?: m.modificationDate;
+            if (d && d.timeIntervalSince1970 > date) date = d.timeIntervalSince1970;
+            bytes += m.fileSizeBytes;
+        }
+        tb->idx[tb->count] = gi;
+        tb->date[tb->count] = date;
+        tb->bytes[tb->count] = bytes;
+        tb->count += 1;
+    }
+}
+
+- (NSArray<ASAssetGroup *> *)sourceForType:(ASGroupType)type {
+    return (type == ASGroupTypeDuplicateImage || type == ASGroupTypeDuplicateVideo) ? _dupSource : _simSource;
+}
+
+- (const ASGroupTypeTable *)tableForType:(ASGroupType)type { return &_tables[type]; }
+
+- (const uint32_t *)permutationForType:(ASGroupType)type order:(ASGroupSortOrder)order {
+    if (order == ASGroupSortOrderFormed || type >= 4) return NULL;
+    ASGroupTypeTable *tb = &_tables[type];
+    os_unfair_lock_lock(&_sortLock);
+    if (!tb->sorted[order] && tb->count) {
+        ASGroupSortKey *keys = malloc(sizeof(ASGroupSortKey) * tb->count);
+        for (uint32_t k = 0; k < tb->count; k++) {
+            double v = 0;
+            switch (order) {
+                case ASGroupSortOrderNewest:   v = -tb->date[k]; break;
+                case ASGroupSortOrderOldest:   v = tb->date[k]; break;
+                case ASGroupSortOrderLargest:  v = -(double)tb->bytes[k]; break;
+                case ASGroupSortOrderSmallest: v = (double)tb->bytes[k]; break;
+                default: break;
+            }
+            keys[k] = (ASGroupSortKey){ v, k };
+        }
+        qsort(keys, tb->count, sizeof(ASGroupSortKey), ASGroupSortKeyCmp);
+        uint32_t *perm = malloc(sizeof(uint32_t) * tb->count);
+        for (uint32_t k = 0; k < tb->count; k++) perm[k] = keys[k].pos;
+        free(keys);
+        tb->sorted[order] = perm;
+    }
+    const uint32_t *perm = tb->sorted[order];
+    os_unfair_lock_unlock(&_sortLock);
+    return perm;
+}
+
+@end
+
+@implementation ASGroupReadView {
+    ASGroupStore *_store;
+    NSArray<ASAssetGroup *> *_source;
+    const ASGroupTypeTable *_table;
+    const uint32_t *_perm;   // 归 _store 所有
+}
+
+- (instancetype)initWithStore:(ASGroupStore *)store type:(ASGroupType)type order:(ASGroupSortOrder)order {
+    if (self = [super init]) {
+        _store = store;
+        _type = type < 4 ? type : ASGroupTypeDuplicateImage;
+        _order = order;
+        _source = [store sourceForType:_type];
+        _table = [store tableForType:_type];
+        _perm = [store permutationForType:_type order:order];
+    }
+    return self;
+}
+
+- (uint64_t)version { return _store.version; }
+- (NSUInteger)groupCount { return _table->count; }
+
+static inline uint32_t ASViewRow(const uint32_t *perm, NSUInteger index) {
+    return perm ? perm[index] : (uint32_t)index;
+}
+
+- (ASAssetGroup *)groupAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _table->count);
+    return _source[_table->idx[ASViewRow(_perm, index)]];
+}
+
+- (NSUInteger)memberCountAtIndex:(NSUInteger)index {
+    return [self groupAtIndex:index].assets.count;
+}
+
+- (NSArray<ASAssetModel *> *)membersAtIndex:(NSUInteger)index range:(NSRange)range {
+    NSArray<ASAssetModel *> *all = [self groupAtIndex:index].assets;
+    if (range.location >= all.count) return @[];
+    range.length = MIN(range.length, all.count - range.location);
+    return [all subarrayWithRange:range];
+}
+
+- (uint64_t)bytesAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _table->count);
+    return _table->bytes[ASViewRow(_perm, index)];
+}
+
+- (NSDate *)dateAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _table->count);
+    return [NSDate dateWithTimeIntervalSince1970:_table->date[ASViewRow(_perm, index)]];
+}
+
+- (ASGroupReadView *)viewSortedBy:(ASGroupSortOrder)order {
+    if (order == _order) return self;
+    return [[ASGroupReadView alloc] initWithStore:_store type:_type order:order];
+}
+
+@end
+
+// 扫描线程准备好的一次发布内容；主线程合并时只保留最新的一份，dirty 取并集
+@interface ASProgressPublish : NSObject
+@property (nonatomic, strong) ASScanSnapshot *snapshot;
+@property (nonatomic, copy) NSArray<ASAssetGroup *> *dup, *sim;
+@property (nonatomic, copy) NSArray<ASAssetGroup *> *simMerged;   // 公开的 similarGroups（sim + dup）
+@property (nonatomic, strong) ASGroupStore *groupStore;           // 在扫描线程建好
+@property (nonatomic, copy) NSArray<ASAssetModel *> *shots, *recs, *bigs, *blurry, *other;
+@property (nonatomic, assign) ASScanModuleMask dirty;
+@end
+
+@implementation ASProgressPublish
+@end
+
+#pragma mark - Cache binary codec (v4)
+
+// 列表编号（写入文件，只增不改）
+typedef NS_ENUM(uint32_t, ASCacheListId) {
+    ASCacheListScreenshots = 1,
+    ASCacheListScreenRecordings,
+    ASCacheListBigVideos,
+    ASCacheListComparableImages,
+    ASCacheListComparableVideos,
+    ASCacheListBlurryPhotos,
+    ASCacheListOtherPhotos,
+    ASCacheListDuplicateGroups,   // 每组一个列表，tag = ASGroupType
+    ASCacheListSimilarGroups,
+    ASCacheListPendingUpsertIDs,  // 以下为字符串列表
+    ASCacheListPendingRemovedIDs,
+    ASCacheListBaselineIDs,
+    ASCacheListOtherAddedIDs,     // 仅日志帧
+    ASCacheListOtherRemovedIDs,
+    ASCacheListDuplicateUnionIDs, // 仅日志帧：成对的 localId，按顺序做并查集合并
+    ASCacheListSimilarUnionIDs,
+};
+
+static uint32_t ASCacheAddString(ASCacheWriter *w, NSMutableDictionary<NSString *, NSNumber *> *strIdx, NSString *str) {
+    str = str ?: @"";
+    NSNumber *hit = strIdx[str];
+    if (hit) return hit.unsignedIntValue;
+    const char *utf8 = str.UTF8String ?: "";
+    uint32_t i = as_cache_writer_add_string(w, utf8, (uint32_t)strlen(utf8));
+    strIdx[str] = @(i);
+    return i;
+}
+
+static uint32_t ASCacheAddModelRecord(ASCacheWriter *w, NSMutableDictionary<NSString *, NSNumber *> *strIdx, ASAssetModel *m) {
+    ASCacheRecord r;
+    memset(&r, 0, sizeof(r));
+    r.localId = ASCacheAddString(w, strIdx, m.localId);
+    r.subtypes = (uint32_t)m.subtypes;
+    r.mediaType = (uint8_t)m.mediaType;
+    r.blurScore = m.blurScore;
+    r.lumaMean = m.lumaMean;
+    r.lumaStd = m.lumaStd;
+    r.fileSize = m.fileSizeBytes;
+    r.pHash64 = m.pHash;
+    r.visionBlob = AS_CACHE_NONE;
+    if (m.creationDate) { r.flags |= AS_CACHE_REC_HAS_CREATION; r.creation = m.creationDate.timeIntervalSince1970; }
+    if (m.modificationDate) { r.flags |= AS_CACHE_REC_HAS_MODIFICATION; r.modification = m.modificationDate.timeIntervalSince1970; }
+    if (m.visionFeature.length) {
+        r.flags |= AS_CACHE_REC_VISION_F32;
+        r.visionBlob = as_cache_writer_add_blob(w, m.visionFeature.bytes, (uint32_t)m.visionFeature.length);
+    } else if (m.visionPrintData.length) {
+        r.visionBlob = as_cache_writer_add_blob(w, m.visionPrintData.bytes, (uint32_t)m.visionPrintData.length);
+    }
+    if (m.videoFingerprint.length) {
+        r.flags |= AS_CACHE_REC_VIDEO_FP;
+        r.videoBlob = as_cache_writer_add_blob(w, m.videoFingerprint.bytes, (uint32_t)m.videoFingerprint.length);
+    }
+
+    uint64_t h[4];
+    BOOL hasHash = m.phash256Data.length >= sizeof(h);
+    if (hasHash) memcpy(h, m.phash256Data.bytes, sizeof(h));
+    return as_cache_writer_add_record(w, &r, hasHash ? h : NULL);
+}
+
+// backing 通常是 mmap 出来的；Vision 特征直接引用映射内存，不拷贝
+static ASAssetModel *ASCacheModelFromRecord(const ASCacheView *v, uint32_t i, NSString *localId, NSData *backing) {
+    const ASCacheRecord *r = &v->records[i];
+    ASAssetModel *m = [ASAssetModel new];
+    m.localId = localId;
+    m.mediaType = (PHAssetMediaType)r->mediaType;
+    m.subtypes = (PHAssetMediaSubtype)r->subtypes;
+    m.fileSizeBytes = r->fileSize;
+    m.pHash = r->pHash64;
+    m.blurScore = r->blurScore;
+    m.lumaMean = r->lumaMean;
+    m.lumaStd = r->lumaStd;
+    if (r->flags & AS_CACHE_REC_HAS_CREATION) m.creationDate = [NSDate dateWithTimeIntervalSince1970:r->creation];
+    if (r->flags & AS_CACHE_REC_HAS_MODIFICATION) m.modificationDate = [NSDate dateWithTimeIntervalSince1970:r->modification];
+    if (r->flags & AS_CACHE_REC_HAS_PHASH) m.phash256Data = [NSData dataWithBytes:v->hashes + (size_t)i * 4 length:32];
+    if (r->visionBlob != AS_CACHE_NONE) {
+        uint32_t len = 0;
+        const void *p = as_cache_view_blob(v, r->visionBlob, &len);
+        BOOL raw = (r->flags & AS_CACHE_REC_VISION_F32) != 0;
+        if (raw && (((uintptr_t)p & (sizeof(float) - 1)) || len % sizeof(float))) {
+            // 与旧的归档特征混写时 BLOB 可能不对齐，拷一份
+            if (len % sizeof(float) == 0) m.visionFeature = [NSData dataWithBytes:p length:len];
+        } else if (len) {
+            NSData *d = [[NSData alloc] initWithBytesNoCopy:(void *)p length:len deallocator:^(void *bytes, NSUInteger length) {
+                (void)backing; // 持有映射，直到最后一个引用释放
+            }];
+            if (raw) m.visionFeature = d;
+            else m.visionPrintData = d;
+        }
+    }
+    if (r->flags & AS_CACHE_REC_VIDEO_FP) {
+        uint32_t len = 0;
+        const void *p = as_cache_view_blob(v, r->videoBlob, &len);
+        if (as_vfp_valid(p, len)) m.videoFingerprint = [NSData dataWithBytes:p length:len];
+    }
+    return m;
+}
+
+static NSString *ASCacheViewNSString(const ASCacheView *v, uint32_t i) {
+    uint32_t len = 0;
+    const char *p = as_cache_view_string(v, i, &len);
+    return [[NSString alloc] initWithBytes:p length:len encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+// 元数据很小，沿用 keyed archive；base 与日志帧共用同一套 key
+static NSMutableDictionary *ASScanCacheMeta(ASScanCache *c) {
+    NSMutableDictionary *meta = [NSMutableDictionary dictionary];
+    meta[@"snapshot"] = c.snapshot;
+    meta[@"calendarIdentifier"] = c.calendarIdentifier;
+    meta[@"timeZoneName"] = c.timeZoneName;
+    meta[@"blurDesiredK"] = @(c.blurDesiredK);
+    meta[@"scanSessionId"] = c.scanSessionId;
+    meta[@"scanStartedAt"] = c.scanStartedAt;
+    meta[@"lastCheckpointAt"] = c.lastCheckpointAt;
+    meta[@"currentDayStart"] = c.currentDayStart;
+    meta[@"blurryImagesSeen"] = @(c.blurryImagesSeen);
+    meta[@"blurryBytesRunning"] = @(c.blurryBytesRunning);
+    meta[@"otherCandidateBytes"] = @(c.otherCandidateBytes);
+    meta[@"anchorDate"] = c.anchorDate;
+    meta[@"homeStatRefreshDate"] = c.homeStatRefreshDate;
+    meta[@"blurScore"] = @(c.blurScore);
+    meta[@"journalSeq"] = @(c.journalSeq);
+    meta[@"scanUnitAssetCount"] = @(c.scanUnitAssetCount);
+    meta[@"scanUnitSize"] = @(c.scanUnitSize);
+    meta[@"scanUnitsDone"] = c.scanUnitsDone;
+    return meta;
+}
+
+static NSDictionary *ASDecodeCacheMeta(const ASCacheView *v) {
+    NSSet *metaClasses = [NSSet setWithArray:@[NSDictionary.class, NSString.class, NSNumber.class,
+                                               NSDate.class, NSArray.class, NSData.class, ASScanSnapshot.class]];
+    NSData *bytes = [NSData dataWithBytesNoCopy:(void *)v->meta length:v->metaLen freeWhenDone:NO];
+    NSDictionary *meta = [NSKeyedUnarchiver unarchivedObjectOfClasses:metaClasses fromData:bytes error:nil];
+    return [meta isKindOfClass:NSDictionary.class] ? meta : nil;
+}
+
+// 只覆盖 meta 里出现的字段（日志帧只带会变化的那部分）
+static void ASApplyScanCacheMeta(ASScanCache *c, NSDictionary *meta) {
+    id (^typed)(NSString *, Class) = ^id(NSString *key, Class cls) {
+        id v = meta[key];
+        return [v isKindOfClass:cls] ? v : nil;
+    };
+    ASScanSnapshot *snap = typed(@"snapshot", ASScanSnapshot.class);
+    if (snap) c.snapshot = snap;
+    NSString *s;
+    NSDate *d;
+    NSNumber *n;
+    if ((s = typed(@"calendarIdentifier", NSString.class))) c.calendarIdentifier = s;
+    if ((s = typed(@"timeZoneName", NSString.class))) c.timeZoneName = s;
+    if ((s = typed(@"scanSessionId", NSString.class))) c.scanSessionId = s;
+    if ((d = typed(@"scanStartedAt", NSDate.class))) c.scanStartedAt = d;
+    if ((d = typed(@"lastCheckpointAt", NSDate.class))) c.lastCheckpointAt = d;
+    if ((d = typed(@"currentDayStart", NSDate.class))) c.currentDayStart = d;
+    if ((d = typed(@"anchorDate", NSDate.class))) c.anchorDate = d;
+    if ((d = typed(@"homeStatRefreshDate", NSDate.class))) c.homeStatRefreshDate = d;
+    if ((n = typed(@"blurDesiredK", NSNumber.class))) c.blurDesiredK = n.unsignedIntegerValue;
+    if ((n = typed(@"blurryImagesSeen", NSNumber.class))) c.blurryImagesSeen = n.unsignedIntegerValue;
+    if ((n = typed(@"blurryBytesRunning", NSNumber.class))) c.blurryBytesRunning = n.unsignedLongLongValue;
+    if ((n = typed(@"otherCandidateBytes", NSNumber.class))) c.otherCandidateBytes = n.unsignedLongLongValue;
+    if ((n = typed(@"blurScore", NSNumber.class))) c.blurScore = n.floatValue;
+    if ((n = typed(@"journalSeq", NSNumber.class))) c.journalSeq = n.unsignedIntegerValue;
+    if ((n = typed(@"scanUnitAssetCount", NSNumber.class))) c.scanUnitAssetCount = n.unsignedIntegerValue;
+    if ((n = typed(@"scanUnitSize", NSNumber.class))) c.scanUnitSize = n.unsignedIntegerValue;
+    NSData *bits = typed(@"scanUnitsDone", NSData.class);
+    if (bits) c.scanUnitsDone = bits;
+}
+
+static NSData *ASFinishCacheWriter(ASCacheWriter *w, NSDictionary *meta) {
+    NSData *metaData = [NSKeyedArchiver archivedDataWithRootObject:meta requiringSecureCoding:YES error:nil];
+    if (metaData) as_cache_writer_set_meta(w, metaData.bytes, (uint32_t)metaData.length);
+
+    uint8_t *bytes = NULL;
+    size_t len = 0;
+    int ok = as_cache_writer_finish(w, &bytes, &len);
+    as_cache_writer_destroy(w);
+    if (!ok || !metaData) { free(bytes); return nil; }
+
+    return [NSData dataWithBytesNoCopy:bytes length:len freeWhenDone:YES];
+}
+
+static NSData *ASEncodeScanCacheV4(ASScanCache *c) {
+    ASCacheWriter *w = as_cache_writer_create();
+    if (!w) return nil;
+
+    NSMutableDictionary<NSString *, NSNumber *> *strIdx = [NSMutableDictionary dictionary];
+
+    // 同一个 model 对象在多个列表/分组里共享，只写一条记录（按指针去重）
+    NSMapTable<ASAssetModel *, NSNumber *> *recIdx =
+        [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsStrongMemory
+                              valueOptions:NSPointerFunctionsStrongMemory];
+    uint32_t (^addModel)(ASAssetModel *) = ^uint32_t(ASAssetModel *m) {
+        NSNumber *hit = [recIdx objectForKey:m];
+        if (hit) return hit.unsignedIntValue;
+        uint32_t i = ASCacheAddModelRecord(w, strIdx, m);
+        [recIdx setObject:@(i) forKey:m];
+        return i;
+    };
+
+    NSMutableData *scratch = [NSMutableData data];
+    void (^addModels)(uint32_t, uint32_t, NSArray<ASAssetModel *> *) = ^(uint32_t listId, uint32_t tag, NSArray<ASAssetModel *> *arr) {
+        scratch.length = arr.count * sizeof(uint32_t);
+        uint32_t *idx = (uint32_t *)scratch.mutableBytes;
+        NSUInteger n = 0;
+        for (ASAssetModel *m in arr) {
+            if ([m isKindOfClass:ASAssetModel.class]) idx[n++] = addModel(m);
+        }
+        as_cache_writer_add_list(w, listId, tag, idx, (uint32_t)n);
+    };
+    void (^addStrings)(uint32_t, NSArray<NSString *> *) = ^(uint32_t listId, NSArray<NSString *> *arr) {
+        scratch.length = arr.count * sizeof(uint32_t);
+        uint32_t *idx = (uint32_t *)scratch.mutableBytes;
+        NSUInteger n = 0;
+        for (NSString *str in arr) {
+            if ([str isKindOfClass:NSString.class]) idx[n++] = ASCacheAddString(w, strIdx, str);
+        }
+        as_cache_writer_add_list(w, listId, AS_CACHE_LIST_STRINGS, idx, (uint32_t)n);
+    };
+
+    addModels(ASCacheListScreenshots, 0, c.screenshots);
+    addModels(ASCacheListScreenRecordings, 0, c.screenRecordings);
+    addModels(ASCacheListBigVideos, 0, c.bigVideos);
+    addModels(ASCacheListComparableImages, 0, c.comparableImages);
+    addModels(ASCacheListComparableVideos, 0, c.comparableVideos);
+    addModels(ASCacheListBlurryPhotos, 0, c.blurryPhotos);
+    addModels(ASCacheListOtherPhotos, 0, c.otherPhotos);
+    for (ASAssetGroup *g in c.duplicateGroups) addModels(ASCacheListDuplicateGroups, (uint32_t)g.type, g.assets);
+    for (ASAssetGroup *g in c.similarGroups) addModels(ASCacheListSimilarGroups, (uint32_t)g.type, g.assets);
+    addStrings(ASCacheListPendingUpsertIDs, c.pendingUpsertIDs);
+    addStrings(ASCacheListPendingRemovedIDs, c.pendingRemovedIDs);
+    addStrings(ASCacheListBaselineIDs, c.baselineAllAssetIDsAtStart);
+
+    return ASFinishCacheWriter(w, ASScanCacheMeta(c));
+}
+
+static ASScanCache *ASDecodeScanCacheV4(NSData *data) {
+    ASCacheView v;
+    int rc = as_cache_view_open(&v, data.bytes, data.length);
+    if (rc != 0) {
+        NSLog(@"[CACHE] v4 open failed rc=%d", rc);
+        return nil;
+    }
+
+    NSDictionary *meta = ASDecodeCacheMeta(&v);
+    if (!meta) return nil;
+
+    NSMutableArray *strings = [NSMutableArray arrayWithCapacity:v.strCount];
+    for (uint32_t i = 0; i < v.strCount; i++) [strings addObject:ASCacheViewNSString(&v, i)];
+
+    NSMutableArray<ASAssetModel *> *models = [NSMutableArray arrayWithCapacity:v.recordCount];
+    for (uint32_t i = 0; i < v.recordCount; i++) {
+        [models addObject:ASCacheModelFromRecord(&v, i, strings[v.records[i].localId], data)];
+    }
+
+    ASScanCache *c = [ASScanCache new];
+    NSMutableArray *dup = [NSMutableArray array], *sim = [NSMutableArray array];
+
+    size_t cursor = 0;
+    uint32_t listId = 0, tag = 0, n = 0;
+    const uint32_t *idx = NULL;
+    while (as_cache_view_next_list(&v, &cursor, &listId, &tag, &idx, &n) > 0) {
+        NSMutableArray *arr = [NSMutableArray arrayWithCapacity:n];
+        NSArray *source = (tag & AS_CACHE_LIST_STRINGS) ? strings : models;
+        for (uint32_t i = 0; i < n; i++) [arr addObject:source[idx[i]]];
+
+        switch ((ASCacheListId)listId) {
+            case ASCacheListScreenshots:       c.screenshots = arr; break;
+            case ASCacheListScreenRecordings:  c.screenRecordings = arr; break;
+            case ASCacheListBigVideos:         c.bigVideos = arr; break;
+            case ASCacheListComparableImages:  c.comparableImages = arr; break;
+            case ASCacheListComparableVideos:  c.comparableVideos = arr; break;
+            case ASCacheListBlurryPhotos:      c.blurryPhotos = arr; break;
+            case ASCacheListOtherPhotos:       c.otherPhotos = arr; break;
+            case ASCacheListPendingUpsertIDs:  c.pendingUpsertIDs = arr; break;
+            case ASCacheListPendingRemovedIDs: c.pendingRemovedIDs = arr; break;
+            case ASCacheListBaselineIDs:       c.baselineAllAssetIDsAtStart = arr; break;
+            case ASCacheListDuplicateGroups:
+            case ASCacheListSimilarGroups: {
+                ASAssetGroup *g = [ASAssetGroup new];
+                g.type = (ASGroupType)tag;
+                g.assets = arr;
+                [(listId == ASCacheListDuplicateGroups ? dup : sim) addObject:g];
+                break;
+            }
+            default: break; // 新版本写入的未知列表，忽略
+        }
+    }
+    c.duplicateGroups = dup;
+    c.similarGroups = sim;
+
+    ASApplyScanCacheMeta(c, meta);
+    if (!c.snapshot) c.snapshot = [ASScanSnapshot new];
+    return c;
+}
+
+#pragma mark - Checkpoint journal replay
+
+// base + 日志：按 seq 顺序重放同一扫描会话、且晚于 base 的帧；任一帧语义不符或 seq 不连续即停止
+// （之后的帧依赖它），*complete = NO，调用方须按当前结果重写 base
+static NSUInteger ASReplayScanJournal(ASScanCache *c, ASScanJournal *journal, BOOL *complete) {
+    *complete = YES;
+    if (!c.scanSessionId.length || c.snapshot.state != ASScanStateScanning) return 0;
+
+    __block NSMutableDictionary<NSString *, ASAssetModel *> *byId = nil;
+    __block NSMutableOrderedSet<ASAssetModel *> *other = nil;
+    __block ASAssetGroupIndex *groups = nil;
+    __block NSMutableArray *screenshots, *screenRecordings, *bigVideos, *comparableImages, *comparableVideos;
+    __block NSUInteger applied = 0;
+    __block uint64_t lastSeq = c.journalSeq;
+    __block BOOL broken = NO;
+
+    // 第一帧命中时才把 base 展开成可变结构
+    void (^prepare)(void) = ^{
+        byId = [NSMutableDictionary dictionary];
+        void (^index)(NSArray<ASAssetModel *> *) = ^(NSArray<ASAssetModel *> *arr) {
+            for (ASAssetModel *m in arr) if (m.localId.length && !byId[m.localId]) byId[m.localId] = m;
+        };
+        screenshots = [c.screenshots mutableCopy] ?: [NSMutableArray array];
+        screenRecordings = [c.screenRecordings mutableCopy] ?: [NSMutableArray array];
+        bigVideos = [c.bigVideos mutableCopy] ?: [NSMutableArray array];
+        comparableImages = [c.comparableImages mutableCopy] ?: [NSMutableArray array];
+        comparableVideos = [c.comparableVideos mutableCopy] ?: [NSMutableArray array];
+        other = [NSMutableOrderedSet orderedSetWithArray:c.otherPhotos ?: @[]];
+        groups = [[ASAssetGroupIndex alloc] initWithDuplicateGroups:c.duplicateGroups ?: @[]
+                                                      similarGroups:c.similarGroups ?: @[]];
+        for (NSArray *arr in @[screenshots, screenRecordings, bigVideos, comparableImages, comparableVideos,
+                               c.blurryPhotos ?: @[], other.array]) index(arr);
+        for (ASAssetGroup *g in [(c.duplicateGroups ?: @[]) arrayByAddingObjectsFromArray:c.similarGroups ?: @[]]) index(g.assets);
+    };
+
+    [journal enumerateFramesUsingBlock:^(NSData *frame, BOOL *stop) {
+        ASCacheView v;
+        NSDictionary *meta = (as_cache_view_open(&v, frame.bytes, frame.length) == 0) ? ASDecodeCacheMeta(&v) : nil;
+        if (!meta) { broken = YES; *stop = YES; return; }
+        if (![meta[@"scanSessionId"] isEqual:c.scanSessionId]) return;
+        uint64_t seq = [meta[@"journalSeq"] unsignedLongLongValue];
+        ASJournalSeqCheck check = as_journal_seq_check(lastSeq, seq);
+        if (check == AS_JOURNAL_SEQ_SKIP) return;
+        if (check == AS_JOURNAL_SEQ_GAP) { broken = YES; *stop = YES; return; }
+
+        if (!byId) prepare();
+
+        for (uint32_t i = 0; i < v.recordCount; i++) {
+            NSString *lid = ASCacheViewNSString(&v, v.records[i].localId);
+            if (!byId[lid]) byId[lid] = ASCacheModelFromRecord(&v, i, lid, frame);
+        }
+
+        NSMutableArray<ASAssetModel *> *(^resolve)(const uint32_t *, uint32_t) = ^NSMutableArray *(const uint32_t *idx, uint32_t n) {
+            NSMutableArray *arr = [NSMutableArray arrayWithCapacity:n];
+            for (uint32_t i = 0; i < n; i++) {
+                ASAssetModel *m = byId[ASCacheViewNSString(&v, idx[i])];
+                if (!m) return nil;
+                [arr addObject:m];
+            }
+            return arr;
+        };
+
+        BOOL ok = YES;
+        size_t cursor = 0;
+        uint32_t listId = 0, tag = 0, n = 0;
+        const uint32_t *idx = NULL;
+        while (ok && as_cache_view_next_list(&v, &cursor, &listId, &tag, &idx, &n) > 0) {
+            if (!(tag & AS_CACHE_LIST_STRINGS)) { ok = NO; break; }
+
+            if (listId == ASCacheListPendingUpsertIDs || listId == ASCacheListPendingRemovedIDs) {
+                NSMutableArray *ids = [NSMutableArray arrayWithCapacity:n];
+                for (uint32_t i = 0; i < n; i++) [ids addObject:ASCacheViewNSString(&v, idx[i])];
+                if (listId == ASCacheListPendingUpsertIDs) c.pendingUpsertIDs = ids;
+                else c.pendingRemovedIDs = ids;
+                continue;
+            }
+            if (listId == ASCacheListOtherRemovedIDs) {
+                for (uint32_t i = 0; i < n; i++) {
+                    ASAssetModel *m = byId[ASCacheViewNSString(&v, idx[i])];
+                    if (m) [other removeObject:m];
+                }
+                continue;
+            }
+
+            NSMutableArray<ASAssetModel *> *models = resolve(idx, n);
+            if (!models) { ok = NO; break; }
+
+            switch ((ASCacheListId)listId) {
+                case ASCacheListScreenshots:       [screenshots addObjectsFromArray:models]; break;
+                case ASCacheListScreenRecordings:  [screenRecordings addObjectsFromArray:models]; break;
+                case ASCacheListBigVideos:         [bigVideos addObjectsFromArray:models]; break;
+                case ASCacheListComparableImages:  [comparableImages addObjectsFromArray:models]; break;
+                case ASCacheListComparableVideos:  [comparableVideos addObjectsFromArray:models]; break;
+                case ASCacheListBlurryPhotos:      c.blurryPhotos = models; break;
+                case ASCacheListOtherAddedIDs:     [other addObjectsFromArray:models]; break;
+                case ASCacheListDuplicateUnionIDs:
+                case ASCacheListSimilarUnionIDs: {
+                    if (models.count % 2) { ok = NO; break; }
+                    BOOL duplicate = (listId == ASCacheListDuplicateUnionIDs);
+                    for (NSUInteger i = 0; i < models.count; i += 2) {
+                        [groups unionModel:models[i] with:models[i + 1] duplicate:duplicate];
+                    }
+                    break;
+                }
+                default: break;
+            }
+        }
+        if (!ok) { broken = YES; *stop = YES; return; }
+
+        ASApplyScanCacheMeta(c, meta);
+        lastSeq = seq;
+        applied += 1;
+    }];
+    *complete = !broken;
+
+    if (applied) {
+        c.screenshots = screenshots;
+        c.screenRecordings = screenRecordings;
+        c.bigVideos = bigVideos;
+        c.comparableImages = comparableImages;
+        c.comparableVideos = comparableVideos;
+        c.otherPhotos = other.array;
+        c.duplicateGroups = [groups groupsDuplicate:YES];
+        c.similarGroups = [groups groupsDuplicate:NO];
+    }
+    return applied;
+}
+
 typedef NS_ENUM(NSUInteger, ASHomeModuleType) {
     ASHomeModuleTypeSimilarImage = 0,
     ASHomeModuleTypeSimilarVideo,
@@ -603,6 +2093,29 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 @property (nonatomic, assign) CFTimeInterval lastCheckpointT;
 @property (nonatomic, assign) NSUInteger lastCheckpointCount;
 
+// checkpoint 日志（workQ）：全量扫描期间只追加增量，journalNeedsBase 时整库写 base
+@property (nonatomic, strong) ASScanJournal *journal;
+// 持久化特征库（线程安全，decode 线程直接查）；落盘在 ioQ
+@property (nonatomic, strong) ASFeatureStore *featureStore;
+// 全量扫描流水线（保留到下一次全量扫描，便于扫描结束后读统计）
+@property (atomic, strong, nullable) ASScanPipeline *scanPipeline;
+// 本次全量扫描 / 续扫的工作单元；unitCursor 是流水线已归类到的 fetch 下标
+@property (nonatomic, strong, nullable) ASScanUnitPlan *unitPlan;
+@property (nonatomic, assign) NSUInteger unitCursor;
+@property (nonatomic, assign) BOOL journalActive;
+@property (nonatomic, assign) BOOL journalNeedsBase;
+@property (nonatomic, assign) NSUInteger journalSeq;
+@property (nonatomic, assign) uint64_t journalBytesSinceBase;
+@property (atomic, assign) uint64_t lastBaseBytes;
+// 已落盘的状态：model 指针、只追加列表的长度；上次落盘之后的分组合并（成对）、other 的净变化
+@property (nonatomic, strong) NSHashTable<ASAssetModel *> *journalLoggedModels;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *journalListMarks;
+@property (nonatomic, strong) NSMutableArray<ASAssetModel *> *journalDupUnions;
+@property (nonatomic, strong) NSMutableArray<ASAssetModel *> *journalSimUnions;
+@property (nonatomic, copy) NSArray<ASAssetModel *> *journalBlurryLogged;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, ASAssetModel *> *journalOtherAdded;
+@property (nonatomic, strong) NSMutableSet<NSString *> *journalOtherRemoved;
+
 @property (atomic, assign) BOOL needShowPermissionPlaceholder;
 
 @property (nonatomic, assign) NSUInteger blurryImagesSeen;
@@ -619,14 +2132,29 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 @property (nonatomic, strong) NSMutableSet<NSString*> *pendingRemovedIDs;
 @property (nonatomic, strong) dispatch_block_t incrementalDebounceBlock;
 
-@property (nonatomic, strong) NSCache<NSString*, VNFeaturePrintObservation*> *visionMemo;
+@property (nonatomic, strong) NSCache<NSString*, NSData*> *visionMemo;
+@property (nonatomic, strong) ASFeaturePrintArena *visionArena;
 @property (nonatomic, strong) dispatch_queue_t workQ;
 @property (nonatomic, strong) PHCachingImageManager *imageManager;
 
 @property (nonatomic, strong) ASScanCache *cache;
 
 @property (nonatomic, strong) NSMutableDictionary<NSUUID *, ASScanProgressBlock> *progressObservers;
+@property (nonatomic, strong) NSMutableDictionary<NSUUID *, ASScanProgressDeltaBlock> *deltaObservers;
 @property (nonatomic, strong) dispatch_queue_t observersQ;
+
+// 进度合并：dirtyModules 在 workQ 上累计；其余只在主线程读写
+@property (nonatomic, assign) ASScanModuleMask progressDirtyModules;
+@property (nonatomic, strong, nullable) ASProgressPublish *pendingPublish;
+@property (nonatomic, strong, nullable) CADisplayLink *progressLink;
+@property (nonatomic, assign) ASProgressCounters publishedCounters;
+@property (nonatomic, strong, nullable) ASScanSnapshot *publishedSnapshot;
+@property (nonatomic, assign) NSUInteger progressEmits, progressPublishes;
+@property (nonatomic, assign) double progressMainMs, progressObserverMs;
+@property (nonatomic, assign) CFTimeInterval progressStatsT0;
+
+// 与公开的 duplicateGroups / similarGroups 对应的分组视图数据；来源数组换了就按需重建
+@property (atomic, strong, nullable) ASGroupStore *groupStore;
 @property (nonatomic, copy) ASScanCompletionBlock completionBlock;
 
 @property (nonatomic, strong) ASScanSnapshot *snapshot;
@@ -639,16 +2167,25 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 @property (nonatomic, strong) NSArray<ASAssetModel *> *blurryPhotos;
 @property (nonatomic, strong) NSArray<ASAssetModel *> *otherPhotos;
 
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSMutableArray<ASAssetModel *> *> *indexImage;
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSMutableArray<ASAssetModel *> *> *indexVideo;
+@property (nonatomic, strong) ASPHashPool *indexImage;
+@property (nonatomic, strong) ASPHashPool *indexVideo;
+
+// Global 分组窗口：跨天重复候选 + 当天已入池的 model（换天时带入相邻天）
+@property (nonatomic, assign) ASGroupingWindow activeGroupingWindow;
+@property (nonatomic, strong) ASPHashPool *crossDayImage;
+@property (nonatomic, strong) ASPHashPool *crossDayVideo;
+@property (nonatomic, strong) NSMutableArray<ASAssetModel *> *dayModelsImage;
+@property (nonatomic, strong) NSMutableArray<ASAssetModel *> *dayModelsVideo;
 
 // mutable containers
+// 分组：扫描期间由 groupIndex（并查集）维护，读 dupGroupsM / simGroupsM 时才物化回数组
 @property (nonatomic, strong) NSMutableArray<ASAssetGroup *> *dupGroupsM;
 @property (nonatomic, strong) NSMutableArray<ASAssetGroup *> *simGroupsM;
+@property (nonatomic, strong, nullable) ASAssetGroupIndex *groupIndex;
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *screenshotsM;
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *screenRecordingsM;
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *bigVideosM;
-@property (nonatomic, strong) NSMutableArray<ASAssetModel *> *blurryPhotosM;
+@property (nonatomic, strong, nullable) ASBlurryTopK *blurryTopK;
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *otherPhotosM;
 
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *comparableImagesM;
@@ -660,6 +2197,13 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 @property (nonatomic, strong) NSDate *currentDay;
 @property (nonatomic, assign) BOOL didLoadCacheFromDisk;
 
+// 优先扫描：本次扫描 / 续扫开始时刻（CACurrentMediaTime）、生效的天数与统计（workQ 读写），
+// priorityStats 是发布给外部读的不可变副本
+@property (nonatomic, assign) CFTimeInterval priorityT0;
+@property (nonatomic, assign) NSUInteger priorityActiveDays;
+@property (nonatomic, strong, nullable) NSMutableDictionary<NSString *, NSNumber *> *priorityStatsM;
+@property (atomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *priorityStats;
+
 @property (atomic) BOOL cancelled;
 
 @end
@@ -704,8 +2248,11 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         _pendingRemovedIDsPersist = [NSMutableSet set];
         _lastCheckpointT = 0;
         _lastCheckpointCount = 0;
+        _journal = [[ASScanJournal alloc] initWithPath:ASJournalPath()];
+        _featureStore = [[ASFeatureStore alloc] initWithPath:ASFeatureStorePath() extractorVersion:ASFeatureStoreVersion()];
     
             _progressObservers = [NSMutableDictionary dictionary];
+            _deltaObservers = [NSMutableDictionary dictionary];
             _observersQ = dispatch_queue_create("as.photo.scan.observers", DISPATCH_QUEUE_SERIAL);
 
             _pendingInsertedMap = [NSMutableDictionary dictionary];
@@ -720,13 +2267,20 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
             _blurryPhotos = @[];
             _otherPhotos = @[];
 
-            _indexImage = [NSMutableDictionary dictionary];
-            _indexVideo = [NSMutableDictionary dictionary];
+            _indexImage = [[ASPHashPool alloc] initWithQueryRadius:kPolicySimilar.phashThreshold];
+            _indexVideo = [[ASPHashPool alloc] initWithQueryRadius:kPolicySimilar.phashThreshold];
+            _crossDayImage = [[ASPHashPool alloc] initWithQueryRadius:kPolicyDuplicate.phashThreshold];
+            _crossDayVideo = [[ASPHashPool alloc] initWithQueryRadius:kPolicyDuplicate.phashThreshold];
+            _dayModelsImage = [NSMutableArray array];
+            _dayModelsVideo = [NSMutableArray array];
+            _groupingMemoryBudgetBytes = kASGroupingDefaultBudget;
+            as_metrics_set_enabled([[NSUserDefaults standardUserDefaults] boolForKey:kASScanMetricsKey]);
 
             _cache = [ASScanCache new];
 
             _visionMemo = [[NSCache alloc] init];
             _visionMemo.countLimit = 3000;
+            _visionArena = [ASFeaturePrintArena new];
 
             if ([self as_currentAuthState] != ASPhotoAuthStateNone) {
                 [self refreshAllAssetsFetchResult];
@@ -745,8 +2299,11 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 - (void)as_appDidEnterBackground {
     dispatch_async(self.workQ, ^{
         if (self.fullScanRunning) {
-            [self checkpointSaveAsyncForce:YES];
+            // 进后台可能被杀：把日志压缩回 base，下次启动不用重放
+            [self as_compactCheckpointJournal];
         }
+        // 没扫完：交给充电时的后台处理窗口继续按单元推进
+        if ([self hasUnfinishedFullScan]) [[ASBackgroundScanScheduler shared] scheduleIfNeeded];
     });
 }
 
@@ -754,65 +2311,370 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     [[PHPhotoLibrary sharedPhotoLibrary] unregisterChangeObserver:self];
 }
 
-// 断点续扫
-- (ASScanCache *)buildCheckpointCacheSnapshot {
-    ASScanCache *c = [ASScanCache new];
+// 断点续扫
+- (ASScanCache *)buildCheckpointCacheSnapshot {
+    ASScanCache *c = [ASScanCache new];
+
+    c.scanSessionId = self.cache.scanSessionId ?: @"";
+    c.scanStartedAt = self.cache.scanStartedAt ?: [NSDate date];
+    c.baselineAllAssetIDsAtStart = self.cache.baselineAllAssetIDsAtStart ?: @[];
+
+    c.calendarIdentifier = self.cache.calendarIdentifier ?: NSCalendarIdentifierGregorian;
+    c.timeZoneName = self.cache.timeZoneName ?: [NSTimeZone localTimeZone].name;
+    c.blurDesiredK = self.cache.blurDesiredK;
+    if (self.unitPlan) {
+        [self.unitPlan writeToCache:c];
+    } else {
+        c.scanUnitAssetCount = self.cache.scanUnitAssetCount;
+        c.scanUnitSize = self.cache.scanUnitSize;
+        c.scanUnitsDone = self.cache.scanUnitsDone;
+    }
+
+    c.lastCheckpointAt = [NSDate date];
+    c.currentDayStart = self.currentDay;
+
+    c.snapshot = [self cloneSnapshot:self.snapshot];
+    c.snapshot.state = ASScanStateScanning;
+
+    c.duplicateGroups = [self as_groupsSnapshotDuplicate:YES] ?: self.cache.duplicateGroups ?: @[];
+    c.similarGroups   = [self as_groupsSnapshotDuplicate:NO] ?: self.cache.similarGroups ?: @[];
+    c.screenshots     = [self.screenshotsM copy] ?: self.cache.screenshots ?: @[];
+    c.screenRecordings = [self.screenRecordingsM copy] ?: self.cache.screenRecordings ?: @[];
+    c.bigVideos       = [self.bigVideosM copy] ?: self.cache.bigVideos ?: @[];
+
+    c.comparableImages = [self.comparableImagesM copy] ?: self.cache.comparableImages ?: @[];
+    c.comparableVideos = [self.comparableVideosM copy] ?: self.cache.comparableVideos ?: @[];
+
+    c.blurryPhotos = self.blurryTopK ? [self.blurryTopK sortedModels] : (self.cache.blurryPhotos ?: @[]);
+    c.otherPhotos  = [self.otherPhotosM copy]  ?: self.cache.otherPhotos  ?: @[];
+
+    c.blurryImagesSeen = self.blurryImagesSeen;
+    c.blurryBytesRunning = self.blurryBytesRunning;
+    c.otherCandidateBytes = self.otherCandidateBytes;
+
+    c.pendingUpsertIDs = self.pendingUpsertIDsPersist.allObjects ?: @[];
+    c.pendingRemovedIDs = self.pendingRemovedIDsPersist.allObjects ?: @[];
+
+    c.anchorDate = self.cache.anchorDate ?: [NSDate dateWithTimeIntervalSince1970:0];
+    c.homeStatRefreshDate = self.cache.homeStatRefreshDate ?: [NSDate dateWithTimeIntervalSince1970:0];
+
+    return c;
+}
+
+- (void)checkpointSaveAsyncForce:(BOOL)force {
+    CFTimeInterval now = CACurrentMediaTime();
+
+    // 节流 每 200 张或 3 秒一次
+    BOOL hitCount = (self.snapshot.scannedCount - self.lastCheckpointCount) >= 200;
+    BOOL hitTime  = (now - self.lastCheckpointT) >= 3;
+
+    if (!force && !(hitCount || hitTime)) return;
+
+    self.lastCheckpointT = now;
+    self.lastCheckpointCount = self.snapshot.scannedCount;
+
+    if (!self.journalActive) {
+        ASScanCache *snap = [self buildCheckpointCacheSnapshot];
+        self.cache = snap;
+        [self saveCacheAsync];
+        return;
+    }
+
+    BOOL tooBig = self.journalBytesSinceBase > MAX(kASJournalCompactMinBytes, self.lastBaseBytes);
+    if (self.journalNeedsBase || tooBig) {
+        [self as_compactCheckpointJournal];
+        return;
+    }
+
+    CFTimeInterval t0 = CACurrentMediaTime();
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_CHECKPOINT_BUILD);
+    NSData *frame = [self as_buildJournalFrame];
+    as_metrics_end(iv);
+    if (!frame) {
+        // 容器发生了非追加的变化（或编码失败），整库重写一次
+        [self as_compactCheckpointJournal];
+        return;
+    }
+    self.journalBytesSinceBase += frame.length;
+    [self.journal recordCheckpointBuildMs:(CACurrentMediaTime() - t0) * 1000.0 compaction:NO];
+
+    ASScanJournal *journal = self.journal;
+    dispatch_async(self.ioQ, ^{
+        if (![journal appendFrame:frame]) {
+            NSLog(@"[CACHE] journal append failed bytes=%lu", (unsigned long)frame.length);
+            // 这一帧没落盘，后面的帧 seq 会断开：下次 checkpoint 直接整库写 base
+            dispatch_async(self.workQ, ^{ self.journalNeedsBase = YES; });
+        }
+        [self.featureStore flush];
+    });
+}
+
+#pragma mark - Checkpoint journal
+
+- (NSDictionary<NSString *, NSNumber *> *)checkpointStats {
+    return [self.journal stats];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)pipelineStats {
+    return [self.scanPipeline stats] ?: @{};
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)featureStoreStats {
+    return [self.featureStore stats];
+}
+
+#pragma mark - Priority scan
+
+- (NSUInteger)priorityScanDays {
+    return (NSUInteger)[[NSUserDefaults standardUserDefaults] integerForKey:kASPriorityScanDaysKey];
+}
+
+- (void)setPriorityScanDays:(NSUInteger)priorityScanDays {
+    [[NSUserDefaults standardUserDefaults] setInteger:(NSInteger)priorityScanDays forKey:kASPriorityScanDaysKey];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)priorityScanStats {
+    return self.priorityStats ?: @{};
+}
+
+// 全量扫描 / 续扫开始（workQ）
+- (void)as_beginPriorityScan {
+    self.priorityT0 = CACurrentMediaTime();
+    self.priorityActiveDays = self.priorityScanDays;
+    self.priorityStatsM = [@{ @"priorityDays": @(self.priorityActiveDays), @"closedDays": @0, @"backfill": @NO } mutableCopy];
+    self.priorityStats = self.priorityStatsM;
+}
+
+- (double)as_priorityElapsedMs {
+    return (CACurrentMediaTime() - self.priorityT0) * 1000.0;
+}
+
+// 第一个相似/重复组：立即发布，不等 emitProgressMaybe 的节流
+- (void)as_noteGroupFormed {
+    NSMutableDictionary *st = self.priorityStatsM;
+    if (!st || st[@"firstGroupMs"]) return;
+    st[@"firstGroupMs"] = @([self as_priorityElapsedMs]);
+    st[@"firstGroupAssets"] = @(self.snapshot.scannedCount);
+    self.priorityStats = st;
+    if (as_metrics_enabled()) {
+        NSLog(@"[PRIORITY] first group %.0fms after start, %lu assets",
+              [st[@"firstGroupMs"] doubleValue], (unsigned long)self.snapshot.scannedCount);
+    }
+    [self emitProgress];
+}
+
+// 换天：倒序扫描，前一天已收完。最近 N 天每天发布一次；第 N 天收完后流水线降为回填
+- (void)as_noteDayClosed:(NSDate *)day {
+    NSMutableDictionary *st = self.priorityStatsM;
+    if (!st) return;
+    NSUInteger closed = [st[@"closedDays"] unsignedIntegerValue] + 1;
+    st[@"closedDays"] = @(closed);
+    self.snapshot.closedSinceDay = day;
+
+    NSUInteger n = self.priorityActiveDays;
+    if (n > 0 && closed <= n) {
+        if (closed == n) {
+            st[@"priorityDoneMs"] = @([self as_priorityElapsedMs]);
+            st[@"priorityAssets"] = @(self.snapshot.scannedCount);
+            st[@"backfill"] = @YES;
+            [self.scanPipeline lowerPriorityForBackfill];
+            if (as_metrics_enabled()) {
+                NSLog(@"[PRIORITY] newest %lu days done %.0fms, %lu assets; backfilling",
+                      (unsigned long)n, [st[@"priorityDoneMs"] doubleValue], (unsigned long)self.snapshot.scannedCount);
+            }
+        }
+        self.priorityStats = st;
+        [self emitProgress];
+    } else if (closed % 30 == 0) {
+        self.priorityStats = st;
+    }
+}
+
+#pragma mark - Scan metrics
 
-    c.scanSessionId = self.cache.scanSessionId ?: @"";
-    c.scanStartedAt = self.cache.scanStartedAt ?: [NSDate date];
-    c.baselineAllAssetIDsAtStart = self.cache.baselineAllAssetIDsAtStart ?: @[];
+- (BOOL)scanMetricsEnabled {
+    return as_metrics_enabled() != 0;
+}
 
-    c.calendarIdentifier = self.cache.calendarIdentifier ?: NSCalendarIdentifierGregorian;
-    c.timeZoneName = self.cache.timeZoneName ?: [NSTimeZone localTimeZone].name;
-    c.blurDesiredK = self.cache.blurDesiredK;
+- (void)setScanMetricsEnabled:(BOOL)scanMetricsEnabled {
+    [[NSUserDefaults standardUserDefaults] setBool:scanMetricsEnabled forKey:kASScanMetricsKey];
+    as_metrics_set_enabled(scanMetricsEnabled);
+}
 
-    c.lastCheckpointAt = [NSDate date];
-    c.currentDayStart = self.currentDay;
+- (NSData *)scanMetricsJSON {
+    ASMetricsSnapshot snap;
+    as_metrics_snapshot(&snap);
+    size_t len = as_metrics_json(&snap, NULL, 0);
+    NSMutableData *d = [NSMutableData dataWithLength:len + 1];
+    as_metrics_json(&snap, d.mutableBytes, len + 1);
+    d.length = len;
+    return d;
+}
 
-    c.snapshot = [self cloneSnapshot:self.snapshot];
-    c.snapshot.state = ASScanStateScanning;
+// 开始记录：全量扫描 / 续扫开始时调用，第一次 checkpoint 会先写 base
+- (void)as_beginCheckpointJournal {
+    self.journalActive = YES;
+    self.journalNeedsBase = YES;
+    self.journalSeq = self.cache.journalSeq;
+}
 
-    c.duplicateGroups = [self.dupGroupsM copy] ?: self.cache.duplicateGroups ?: @[];
-    c.similarGroups   = [self.simGroupsM copy] ?: self.cache.similarGroups ?: @[];
-    c.screenshots     = [self.screenshotsM copy] ?: self.cache.screenshots ?: @[];
-    c.screenRecordings = [self.screenRecordingsM copy] ?: self.cache.screenRecordings ?: @[];
-    c.bigVideos       = [self.bigVideosM copy] ?: self.cache.bigVideos ?: @[];
+- (void)as_endCheckpointJournal {
+    self.journalActive = NO;
+    self.journalLoggedModels = nil;
+    self.journalListMarks = nil;
+    self.journalDupUnions = nil;
+    self.journalSimUnions = nil;
+    self.journalBlurryLogged = nil;
+    self.journalOtherAdded = nil;
+    self.journalOtherRemoved = nil;
+}
 
-    c.comparableImages = [self.comparableImagesM copy] ?: self.cache.comparableImages ?: @[];
-    c.comparableVideos = [self.comparableVideosM copy] ?: self.cache.comparableVideos ?: @[];
+// 只追加的列表（顺序与 ASCacheListScreenshots... 对应）
+- (NSArray<NSMutableArray<ASAssetModel *> *> *)as_journalAppendOnlyLists {
+    return @[self.screenshotsM ?: @[], self.screenRecordingsM ?: @[], self.bigVideosM ?: @[],
+             self.comparableImagesM ?: @[], self.comparableVideosM ?: @[]];
+}
 
-    c.blurryPhotos = [self.blurryPhotosM copy] ?: self.cache.blurryPhotos ?: @[];
-    c.otherPhotos  = [self.otherPhotosM copy]  ?: self.cache.otherPhotos  ?: @[];
+// 整库写 base，并把当前状态记为「已落盘」；之后的 checkpoint 只写增量
+- (void)as_compactCheckpointJournal {
+    CFTimeInterval t0 = CACurrentMediaTime();
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_CHECKPOINT_BUILD);
 
-    c.blurryImagesSeen = self.blurryImagesSeen;
-    c.blurryBytesRunning = self.blurryBytesRunning;
-    c.otherCandidateBytes = self.otherCandidateBytes;
+    ASScanCache *snap = [self buildCheckpointCacheSnapshot];
+    snap.journalSeq = self.journalSeq;
+    self.cache = snap;
 
-    c.pendingUpsertIDs = self.pendingUpsertIDsPersist.allObjects ?: @[];
-    c.pendingRemovedIDs = self.pendingRemovedIDsPersist.allObjects ?: @[];
+    if (self.journalActive) {
+        NSHashTable<ASAssetModel *> *logged = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsStrongMemory];
+        NSMutableArray<NSNumber *> *marks = [NSMutableArray array];
+        for (NSArray<ASAssetModel *> *arr in [self as_journalAppendOnlyLists]) {
+            [marks addObject:@(arr.count)];
+            for (ASAssetModel *m in arr) [logged addObject:m];
+        }
+        for (ASAssetModel *m in [self.blurryTopK sortedModels]) [logged addObject:m];
+        for (ASAssetModel *m in self.otherPhotosM) [logged addObject:m];
+
+        for (ASAssetGroup *g in snap.duplicateGroups) for (ASAssetModel *m in g.assets) [logged addObject:m];
+        for (ASAssetGroup *g in snap.similarGroups) for (ASAssetModel *m in g.assets) [logged addObject:m];
+        self.journalDupUnions = [NSMutableArray array];
+        self.journalSimUnions = [NSMutableArray array];
+        self.journalLoggedModels = logged;
+        self.journalListMarks = marks;
+        self.journalBlurryLogged = [self.blurryTopK sortedModels] ?: @[];
+        self.journalOtherAdded = [NSMutableDictionary dictionary];
+        self.journalOtherRemoved = [NSMutableSet set];
+        self.journalNeedsBase = NO;
+    }
+    self.journalBytesSinceBase = 0;
+    as_metrics_end(iv);
+    [self.journal recordCheckpointBuildMs:(CACurrentMediaTime() - t0) * 1000.0 compaction:YES];
+
+    // 之前排队的帧都在 ioQ 上先于这次写入完成，base.journalSeq 已覆盖它们
+    [self as_saveCacheAsyncDroppingJournal];
+}
+
+// 距上次落盘的增量：新 model 记录 + 列表追加 + 分组合并 + other 净变化 + 计数器；
+// 出现非追加的变化时返回 nil，由调用方整库重写
+- (nullable NSData *)as_buildJournalFrame {
+    NSArray<NSMutableArray<ASAssetModel *> *> *lists = [self as_journalAppendOnlyLists];
+    if (self.journalListMarks.count != lists.count) return nil;
+    for (NSUInteger i = 0; i < lists.count; i++) {
+        if (lists[i].count < self.journalListMarks[i].unsignedIntegerValue) return nil;
+    }
+    if (!self.journalDupUnions || !self.journalSimUnions) return nil;
+
+    ASCacheWriter *w = as_cache_writer_create();
+    if (!w) return nil;
+    NSMutableDictionary<NSString *, NSNumber *> *strIdx = [NSMutableDictionary dictionary];
+    NSHashTable<ASAssetModel *> *logged = self.journalLoggedModels;
+    NSMutableData *scratch = [NSMutableData data];
+
+    // 列表元素一律写 localId；第一次出现的 model 顺带写一条记录
+    void (^addList)(uint32_t, uint32_t, NSArray<ASAssetModel *> *) = ^(uint32_t listId, uint32_t tag, NSArray<ASAssetModel *> *arr) {
+        scratch.length = arr.count * sizeof(uint32_t);
+        uint32_t *idx = (uint32_t *)scratch.mutableBytes;
+        NSUInteger n = 0;
+        for (ASAssetModel *m in arr) {
+            if (!m.localId.length) continue;
+            if (![logged containsObject:m]) {
+                ASCacheAddModelRecord(w, strIdx, m);
+                [logged addObject:m];
+            }
+            idx[n++] = ASCacheAddString(w, strIdx, m.localId);
+        }
+        as_cache_writer_add_list(w, listId, tag | AS_CACHE_LIST_STRINGS, idx, (uint32_t)n);
+    };
+    void (^addIds)(uint32_t, NSArray<NSString *> *) = ^(uint32_t listId, NSArray<NSString *> *ids) {
+        scratch.length = ids.count * sizeof(uint32_t);
+        uint32_t *idx = (uint32_t *)scratch.mutableBytes;
+        NSUInteger n = 0;
+        for (NSString *lid in ids) idx[n++] = ASCacheAddString(w, strIdx, lid);
+        as_cache_writer_add_list(w, listId, AS_CACHE_LIST_STRINGS, idx, (uint32_t)n);
+    };
 
-    c.anchorDate = self.cache.anchorDate ?: [NSDate dateWithTimeIntervalSince1970:0];
-    c.homeStatRefreshDate = self.cache.homeStatRefreshDate ?: [NSDate dateWithTimeIntervalSince1970:0];
+    for (NSUInteger i = 0; i < lists.count; i++) {
+        NSUInteger mark = self.journalListMarks[i].unsignedIntegerValue;
+        NSUInteger count = lists[i].count;
+        if (count > mark) addList(ASCacheListScreenshots + (uint32_t)i, 0, [lists[i] subarrayWithRange:NSMakeRange(mark, count - mark)]);
+        self.journalListMarks[i] = @(count);
+    }
 
-    return c;
-}
+    // 分组只记合并操作，重放时在 base 的分组上按顺序 union
+    if (self.journalDupUnions.count) addList(ASCacheListDuplicateUnionIDs, 0, self.journalDupUnions);
+    if (self.journalSimUnions.count) addList(ASCacheListSimilarUnionIDs, 0, self.journalSimUnions);
+    [self.journalDupUnions removeAllObjects];
+    [self.journalSimUnions removeAllObjects];
 
-- (void)checkpointSaveAsyncForce:(BOOL)force {
-    CFTimeInterval now = CACurrentMediaTime();
+    // 模糊 Top-K 最多几百张，有变化时整表覆盖（没变化时 sortedModels 是同一个数组，比较是 O(1)）
+    NSArray<ASAssetModel *> *blurry = [self.blurryTopK sortedModels] ?: @[];
+    if (blurry != self.journalBlurryLogged && ![blurry isEqualToArray:self.journalBlurryLogged ?: @[]]) {
+        addList(ASCacheListBlurryPhotos, 0, blurry);
+        self.journalBlurryLogged = blurry;
+    }
 
-    // 节流 每 200 张或 3 秒一次
-    BOOL hitCount = (self.snapshot.scannedCount - self.lastCheckpointCount) >= 200;
-    BOOL hitTime  = (now - self.lastCheckpointT) >= 3;
+    if (self.journalOtherAdded.count) addList(ASCacheListOtherAddedIDs, 0, self.journalOtherAdded.allValues);
+    if (self.journalOtherRemoved.count) addIds(ASCacheListOtherRemovedIDs, self.journalOtherRemoved.allObjects);
+    [self.journalOtherAdded removeAllObjects];
+    [self.journalOtherRemoved removeAllObjects];
 
-    if (!force && !(hitCount || hitTime)) return;
+    // 扫描期间 pending 集合只增不减
+    if (self.pendingUpsertIDsPersist.count) addIds(ASCacheListPendingUpsertIDs, self.pendingUpsertIDsPersist.allObjects);
+    if (self.pendingRemovedIDsPersist.count) addIds(ASCacheListPendingRemovedIDs, self.pendingRemovedIDsPersist.allObjects);
 
-    self.lastCheckpointT = now;
-    self.lastCheckpointCount = self.snapshot.scannedCount;
+    self.journalSeq += 1;
+    ASScanSnapshot *snap = [self cloneSnapshot:self.snapshot];
+    snap.state = ASScanStateScanning;
+    NSMutableDictionary *meta = [NSMutableDictionary dictionary];
+    meta[@"journalSeq"] = @(self.journalSeq);
+    meta[@"scanSessionId"] = self.cache.scanSessionId ?: @"";
+    meta[@"snapshot"] = snap;
+    meta[@"lastCheckpointAt"] = [NSDate date];
+    meta[@"currentDayStart"] = self.currentDay;
+    meta[@"blurDesiredK"] = @(self.cache.blurDesiredK);
+    meta[@"blurryImagesSeen"] = @(self.blurryImagesSeen);
+    meta[@"blurryBytesRunning"] = @(self.blurryBytesRunning);
+    meta[@"otherCandidateBytes"] = @(self.otherCandidateBytes);
+    meta[@"anchorDate"] = self.cache.anchorDate;
+    if (self.unitPlan) {
+        meta[@"scanUnitAssetCount"] = @(self.unitPlan.assetCount);
+        meta[@"scanUnitSize"] = @(self.unitPlan.unitSize);
+        meta[@"scanUnitsDone"] = [self.unitPlan doneBits];
+    }
 
-    ASScanCache *snap = [self buildCheckpointCacheSnapshot];
+    return ASFinishCacheWriter(w, meta);
+}
 
-    self.cache = snap;
-    [self saveCacheAsync];
+// other 候选是唯一会删除元素的列表：记录净变化
+- (void)as_journalOtherAdded:(ASAssetModel *)model {
+    if (!self.journalActive || !model.localId.length) return;
+    [self.journalOtherRemoved removeObject:model.localId];
+    self.journalOtherAdded[model.localId] = model;
+}
+
+- (void)as_journalOtherRemoved:(NSString *)lid {
+    if (!self.journalActive || !lid.length) return;
+    if (self.journalOtherAdded[lid]) [self.journalOtherAdded removeObjectForKey:lid];
+    else [self.journalOtherRemoved addObject:lid];
 }
 
 #pragma mark - Baseline IDs (Swift-style)
@@ -873,39 +2735,39 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
     NSArray<NSString *> *baselineArr = [self as_loadBaselineAllAssetIDs];
 
-    NSSet<NSString *> *baselineSet = nil;
-    if (baselineArr.count > 0) {
-        baselineSet = [NSSet setWithArray:baselineArr];
-    } else {
-        baselineSet = [self as_collectCachedIdsFromCache];
-    }
+    ASAssetIdSet *baselineSet = baselineArr.count > 0 ? [[ASAssetIdSet alloc] initWithLocalIds:baselineArr]
+                                                      : [self as_collectCachedIdsFromCache];
+    const NSUInteger baselineCount = baselineSet.count;
 
-    NSMutableSet<NSString *> *currentSet = [NSMutableSet setWithCapacity:allFR.count];
+    ASAssetIdSet *currentSet = [ASAssetIdSet new];
+    NSMutableArray<NSString *> *currentIds = [NSMutableArray arrayWithCapacity:allFR.count];
     NSMutableArray<NSString *> *insertedIds = [NSMutableArray array];
 
     for (PHAsset *a in allFR) {
         NSString *lid = a.localIdentifier ?: @"";
         if (!lid.length) continue;
 
-        [currentSet addObject:lid];
-        if (![baselineSet containsObject:lid]) {
+        if (![currentSet addLocalId:lid]) continue;
+        [currentIds addObject:lid];
+        if (![baselineSet containsLocalId:lid]) {
             [insertedIds addObject:lid];
         }
     }
 
-    NSMutableSet<NSString *> *removedSet = [NSMutableSet setWithSet:baselineSet ?: [NSSet set]];
-    [removedSet minusSet:currentSet];
+    // baseline 之后不再用，原地做差
+    [baselineSet minusSet:currentSet];
+    NSArray<NSString *> *removedIds = [baselineSet allLocalIds];
 
     ASIncLog(@"FORCE-FALLBACK diff | inserted=%lu removed=%lu baseline=%lu current=%lu",
              (unsigned long)insertedIds.count,
-             (unsigned long)removedSet.count,
-             (unsigned long)baselineSet.count,
+             (unsigned long)removedIds.count,
+             (unsigned long)baselineCount,
              (unsigned long)currentSet.count);
 
-    if (insertedIds.count == 0 && removedSet.count == 0) {
+    if (insertedIds.count == 0 && removedIds.count == 0) {
         // baseline 为空或不完整时，写一次当前全量
-        if (baselineArr.count == 0 || baselineSet.count != currentSet.count) {
-            [self as_saveBaselineAllAssetIDs:currentSet.allObjects ?: @[]];
+        if (baselineArr.count == 0 || baselineCount != currentSet.count) {
+            [self as_saveBaselineAllAssetIDs:currentIds];
         }
         return;
     }
@@ -913,9 +2775,9 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     NSArray<PHAsset *> *insertedAssets = [self as_fetchAssetsByLocalIdsChunked:insertedIds];
 
     [self incrementalRebuildWithInserted:insertedAssets
-                              removedIDs:removedSet.allObjects ?: @[]];
+                              removedIDs:removedIds];
 
-    [self as_saveBaselineAllAssetIDs:currentSet.allObjects ?: @[]];
+    [self as_saveBaselineAllAssetIDs:currentIds];
 }
 
 
@@ -923,27 +2785,13 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     if (!m || m.blurScore < 0.f) return;
     if (desiredK == 0) return;
 
-    if (!self.blurryPhotosM) self.blurryPhotosM = [NSMutableArray array];
-
-    if (self.blurryPhotosM.count >= desiredK) {
-        ASAssetModel *leastBlurry = self.blurryPhotosM.lastObject; // 升序：last 最不糊
-        if (!(m.blurScore < leastBlurry.blurScore)) return;
+    if (!self.blurryTopK) self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:nil];
 
-        [self.blurryPhotosM removeLastObject];
-        if (self.blurryBytesRunning >= leastBlurry.fileSizeBytes) self.blurryBytesRunning -= leastBlurry.fileSizeBytes;
-    }
-
-    NSUInteger lo = 0, hi = self.blurryPhotosM.count;
-    while (lo < hi) {
-        NSUInteger mid = (lo + hi) >> 1;
-        ASAssetModel *x = self.blurryPhotosM[mid];
-        if (m.blurScore < x.blurScore) hi = mid;
-        else lo = mid + 1;
-    }
-    [self.blurryPhotosM insertObject:m atIndex:lo];
-    self.blurryBytesRunning += m.fileSizeBytes;
+    // 挤出的那张由 as_addBlurChangedDayStartsFromOld 所在的天重建「其他」
+    if (![self.blurryTopK offerModel:m limit:desiredK evicted:NULL]) return;
+    self.blurryBytesRunning = self.blurryTopK.totalBytes;
 
-    self.snapshot.blurryCount = self.blurryPhotosM.count;
+    self.snapshot.blurryCount = self.blurryTopK.count;
     self.snapshot.blurryBytes = self.blurryBytesRunning;
 }
 
@@ -964,10 +2812,25 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     return token;
 }
 
+- (NSUUID *)addProgressDeltaObserver:(ASScanProgressDeltaBlock)block {
+    if (!block) return nil;
+
+    NSUUID *token = [NSUUID UUID];
+    dispatch_async(self.observersQ, ^{
+        self.deltaObservers[token] = [block copy];
+    });
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        block([ASScanProgressDelta fullDeltaWithSnapshot:self.snapshot]);
+    });
+    return token;
+}
+
 - (void)removeProgressObserver:(NSUUID *)token {
     if (!token) return;
     dispatch_async(self.observersQ, ^{
         [self.progressObservers removeObjectForKey:token];
+        [self.deltaObservers removeObjectForKey:token];
     });
 }
 
@@ -982,6 +2845,120 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     }
 }
 
+- (void)as_notifyDeltaObserversOnMain:(ASScanProgressDelta *)delta {
+    __block NSArray<ASScanProgressDeltaBlock> *blocks = nil;
+    dispatch_sync(self.observersQ, ^{
+        blocks = self.deltaObservers.allValues ?: @[];
+    });
+    for (ASScanProgressDeltaBlock b in blocks) b(delta);
+}
+
+#pragma mark - Group read API
+
+// 发布路径之外（载入缓存、删除后重建）直接改了公开数组时，这里按来源数组对不上来重建
+- (ASGroupStore *)as_currentGroupStore {
+    NSArray *dup = self.duplicateGroups ?: @[];
+    NSArray *sim = self.similarGroups ?: @[];
+    ASGroupStore *store = self.groupStore;
+    if (!store || store.dupSource != dup || store.simSource != sim) {
+        store = [[ASGroupStore alloc] initWithDuplicateGroups:dup similarGroups:sim];
+        self.groupStore = store;
+    }
+    return store;
+}
+
+- (ASGroupReadView *)groupReadViewForType:(ASGroupType)type order:(ASGroupSortOrder)order {
+    return [[ASGroupReadView alloc] initWithStore:[self as_currentGroupStore] type:type order:order];
+}
+
+- (uint64_t)groupsVersion {
+    return [self as_currentGroupStore].version;
+}
+
+#pragma mark - Progress publish (coalesced)
+
+- (NSDictionary<NSString *, NSNumber *> *)progressStats {
+    __block NSDictionary *d = nil;
+    void (^read)(void) = ^{
+        double sec = self.progressStatsT0 > 0 ? CACurrentMediaTime() - self.progressStatsT0 : 0;
+        d = @{
+            @"emits": @(self.progressEmits), @"publishes": @(self.progressPublishes),
+            @"mainMs": @(self.progressMainMs), @"observerMs": @(self.progressObserverMs),
+            @"mainMsPerSec": @(sec > 0 ? self.progressMainMs / sec : 0),
+        };
+    };
+    if ([NSThread isMainThread]) read();
+    else dispatch_sync(dispatch_get_main_queue(), read);
+    return d;
+}
+
+- (void)as_resetProgressStats {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        self.progressEmits = self.progressPublishes = 0;
+        self.progressMainMs = self.progressObserverMs = 0;
+        self.progressStatsT0 = CACurrentMediaTime();
+    });
+}
+
+// 主线程：收下最新的一份，下一帧发布；前台以外 display link 不走，直接发布
+- (void)as_enqueuePublish:(ASProgressPublish *)p {
+    CFTimeInterval t0 = CACurrentMediaTime();
+    self.progressEmits += 1;
+    if (self.pendingPublish) p.dirty |= self.pendingPublish.dirty;
+    self.pendingPublish = p;
+
+    BOOL final = p.snapshot.state != ASScanStateScanning;
+    if (final || UIApplication.sharedApplication.applicationState == UIApplicationStateBackground) {
+        self.progressLink.paused = YES;
+        [self as_flushPublish];
+    } else {
+        if (!self.progressLink) {
+            self.progressLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(as_progressLinkFired:)];
+            [self.progressLink addToRunLoop:NSRunLoop.mainRunLoop forMode:NSRunLoopCommonModes];
+        }
+        self.progressLink.paused = NO;
+    }
+    self.progressMainMs += (CACurrentMediaTime() - t0) * 1000.0;
+}
+
+- (void)as_progressLinkFired:(CADisplayLink *)link {
+    link.paused = YES;
+    CFTimeInterval t0 = CACurrentMediaTime();
+    [self as_flushPublish];
+    self.progressMainMs += (CACurrentMediaTime() - t0) * 1000.0;
+}
+
+- (void)as_flushPublish {
+    ASProgressPublish *p = self.pendingPublish;
+    if (!p) return;
+    self.pendingPublish = nil;
+    self.progressPublishes += 1;
+
+    self.duplicateGroups = p.dup;
+    self.similarGroups = p.simMerged;
+    self.groupStore = p.groupStore;
+    self.screenshots = p.shots;
+    self.screenRecordings = p.recs;
+    self.bigVideos = p.bigs;
+    self.blurryPhotos = p.blurry;
+    self.otherPhotos  = p.other;
+
+    ASProgressCounters prev = self.publishedCounters, cur;
+    ASReadProgressCounters(p.snapshot, p.dup.count, p.sim.count, &cur);
+    // 快照换了对象 = 新一轮扫描 / 续扫 / 载入缓存
+    BOOL full = p.snapshot != self.publishedSnapshot || p.snapshot.state != ASScanStateScanning;
+    ASScanProgressDelta *delta = full ? [ASScanProgressDelta fullDeltaWithSnapshot:p.snapshot]
+                                      : [ASScanProgressDelta deltaFrom:&prev to:&cur snapshot:p.snapshot
+                                                                  dup:p.dup sim:p.sim dirty:p.dirty];
+    self.publishedCounters = cur;
+    self.publishedSnapshot = p.snapshot;
+
+    CFTimeInterval t0 = CACurrentMediaTime();
+    [self notifyProgressObserversOnMain:p.snapshot];
+    [self as_notifyDeltaObserversOnMain:delta];
+    self.progressObserverMs += (CACurrentMediaTime() - t0) * 1000.0;
+}
+
 - (NSUInteger)blurryDesiredKForLibraryQuick {
     PHFetchOptions *opt = [PHFetchOptions new];
     opt.predicate = [NSPredicate predicateWithFormat:
@@ -1159,10 +3136,21 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 }
 
 - (void)resumeFullScanFromCache {
-    if (self.fullScanRunning || self.incrementalRunning) return;
-    if ([self as_currentAuthState] == ASPhotoAuthStateNone) return;
-    if (!self.cache || !self.cache.snapshot) return;
-    if (self.cache.snapshot.state != ASScanStateScanning) return;
+    [self as_resumeFullScanUntil:nil units:NULL assets:NULL];
+}
+
+// 续扫：只处理未完成的工作单元；shouldStop 返回 YES 时在资产边界停下、落盘，状态仍是「扫描中」。
+// 返回是否扫完（必须在 workQ 中调用）
+- (BOOL)as_resumeFullScanUntil:(nullable BOOL (^)(void))shouldStop
+                         units:(nullable NSUInteger *)unitsOut
+                        assets:(nullable NSUInteger *)assetsOut
+{
+    if (unitsOut) *unitsOut = 0;
+    if (assetsOut) *assetsOut = 0;
+    if (self.fullScanRunning || self.incrementalRunning) return NO;
+    if ([self as_currentAuthState] == ASPhotoAuthStateNone) return NO;
+    if (!self.cache || !self.cache.snapshot) return NO;
+    if (self.cache.snapshot.state != ASScanStateScanning) return NO;
 
     NSUInteger desiredK = self.cache.blurDesiredK ?: [self blurryDesiredKForLibraryQuick];
     self.cache.blurDesiredK = desiredK;
@@ -1179,13 +3167,14 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     self.bigVideosM = [self.cache.bigVideos mutableCopy] ?: [NSMutableArray array];
     self.comparableImagesM = [self.cache.comparableImages mutableCopy] ?: [NSMutableArray array];
     self.comparableVideosM = [self.cache.comparableVideos mutableCopy] ?: [NSMutableArray array];
-    self.blurryPhotosM = [self.cache.blurryPhotos mutableCopy] ?: [NSMutableArray array];
+    self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:self.cache.blurryPhotos];
     self.otherPhotosM  = [self.cache.otherPhotos  mutableCopy] ?: [NSMutableArray array];
 
     self.snapshot = [self cloneSnapshot:self.cache.snapshot];
     self.snapshot.state = ASScanStateScanning;
 
     self.currentDay = self.cache.currentDayStart;
+    [self as_beginPriorityScan];
 
     self.blurryImagesSeen = self.cache.blurryImagesSeen;
     self.blurryBytesRunning = self.cache.blurryBytesRunning;
@@ -1196,7 +3185,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         if (m.localId.length) self.otherCandidateMap[m.localId] = m;
     }
 
-    NSMutableSet<NSString *> *processed = [self as_collectCachedIdsFromCache];
+    ASAssetIdSet *processed = [self as_collectCachedIdsFromCache];
 
     NSMutableDictionary<NSDate*, NSMutableArray<ASAssetModel*>*> *seedImg = [NSMutableDictionary dictionary];
     NSMutableDictionary<NSDate*, NSMutableArray<ASAssetModel*>*> *seedVid = [NSMutableDictionary dictionary];
@@ -1214,113 +3203,136 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
     [self.indexImage removeAllObjects];
     [self.indexVideo removeAllObjects];
+    [self as_prepareGroupingWindow];
+    [self as_reseedCrossDayPools];
+
+    // 已重放的状态在第一次 checkpoint 时写回 base，日志重新开始
+    [self as_beginCheckpointJournal];
+    [self.featureStore resetStats];
 
     PHFetchResult<PHAsset *> *result = [PHAsset fetchAssetsWithOptions:[self allImageVideoFetchOptions]];
+    [[ASAssetSizeService shared] prefetchSizesForAssets:result];
+
+    // 划分对得上就跳过已完成的单元；对不上（相册增删过）重新划分，靠 localId 跳过已处理的
+    ASScanUnitPlan *plan = [ASScanUnitPlan planFromCache:self.cache assetCount:result.count];
+    if (!plan) plan = [[ASScanUnitPlan alloc] initWithAssetCount:result.count unitSize:kASScanUnitSize];
+    self.unitPlan = plan;
+    NSLog(@"[UNITS] resume %lu/%lu units done", (unsigned long)plan.doneCount, (unsigned long)plan.unitCount);
 
     NSDate *maxAnchor = self.cache.anchorDate ?: [NSDate dateWithTimeIntervalSince1970:0];
+    BOOL stopped = NO;
+    NSUInteger unitsThisRun = 0, assetsThisRun = 0;
+
+    for (NSUInteger unit = 0; unit < plan.unitCount && !stopped; unit++) {
+        if ([plan isUnitDone:unit]) continue;
+        NSArray<PHAsset *> *unitAssets = [result objectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:[plan rangeOfUnit:unit]]];
+        for (PHAsset *asset in unitAssets) {
+            @autoreleasepool {
+                if (self.cancelled || (shouldStop && shouldStop())) { stopped = YES; break; }
+
+                NSString *lid = asset.localIdentifier ?: @"";
+                if (lid.length && [processed containsLocalId:lid]) {
+                    continue;
+                }
 
-    for (PHAsset *asset in result) {
-        @autoreleasepool {
-            if (self.cancelled) break;
+                NSDate *cd = ASPrimaryDateForAsset(asset);
+                NSDate *md = asset.modificationDate ?: cd;
+                if ([cd compare:maxAnchor] == NSOrderedDescending) maxAnchor = cd;
+                if ([md compare:maxAnchor] == NSOrderedDescending) maxAnchor = md;
 
-            NSString *lid = asset.localIdentifier ?: @"";
-            if (lid.length && [processed containsObject:lid]) {
-                continue;
-            }
+                NSDate *day = [self as_dayStart:cd];
 
-            NSDate *cd = ASPrimaryDateForAsset(asset);
-            NSDate *md = asset.modificationDate ?: cd;
-            if ([cd compare:maxAnchor] == NSOrderedDescending) maxAnchor = cd;
-            if ([md compare:maxAnchor] == NSOrderedDescending) maxAnchor = md;
+                if (!self.currentDay || ![day isEqualToDate:self.currentDay]) {
+                    [self as_rollDayPoolsToDay:day];
 
-            NSDate *day = [self as_dayStart:cd];
+                    NSArray *si = seedImg[day] ?: @[];
+                    for (ASAssetModel *m in si) [self as_addModelToDayPool:m isImage:YES];
 
-            if (!self.currentDay || ![day isEqualToDate:self.currentDay]) {
-                self.currentDay = day;
+                    NSArray *sv = seedVid[day] ?: @[];
+                    for (ASAssetModel *m in sv) [self as_addModelToDayPool:m isImage:NO];
+                }
 
-                [self.indexImage removeAllObjects];
-                [self.indexVideo removeAllObjects];
+                NSError *error = nil;
+                ASAssetModel *model = [self buildModelForAsset:asset computeCompareBits:YES error:&error];
+                if (!model) continue;
+                assetsThisRun += 1;
+
+                self.snapshot.scannedCount += 1;
+                self.snapshot.scannedBytes += model.fileSizeBytes;
+
+                if (ASIsScreenshot(asset)) {
+                    [self.screenshotsM addObject:model];
+                    self.snapshot.screenshotCount += 1;
+                    self.snapshot.screenshotBytes += model.fileSizeBytes;
+                    [self emitProgressMaybe];
+                    [self checkpointSaveAsyncForce:NO];
+                    continue;
+                }
 
-                NSArray *si = seedImg[day] ?: @[];
-                for (ASAssetModel *m in si) {
-                    if (m.phash256Data.length >= 32) {
-                        NSNumber *k = ASBucketKeyForPHash256(m.phash256Data);
-                        if (!self.indexImage[k]) self.indexImage[k] = [NSMutableArray array];
-                        [self.indexImage[k] addObject:m];
-                    }
+                if (asset.mediaType == PHAssetMediaTypeImage) {
+                    [self setModule:ASHomeModuleTypeOtherPhotos state:ASModuleScanStateScanning];
+                    [self otherCandidateAddIfNeeded:model asset:asset];
                 }
 
-                NSArray *sv = seedVid[day] ?: @[];
-                for (ASAssetModel *m in sv) {
-                    if (m.phash256Data.length >= 32) {
-                        NSNumber *k = ASBucketKeyForPHash256(m.phash256Data);
-                        if (!self.indexVideo[k]) self.indexVideo[k] = [NSMutableArray array];
-                        [self.indexVideo[k] addObject:m];
-                    }
+                if (asset.mediaType == PHAssetMediaTypeImage && model.blurScore >= 0.f) {
+                    [self updateBlurryTopKFixed:model desiredK:desiredK];
                 }
-            }
 
-            NSError *error = nil;
-            ASAssetModel *model = [self buildModelForAsset:asset computeCompareBits:YES error:&error];
-            if (!model) continue;
+                if (ASIsScreenRecording(asset)) {
+                    [self.screenRecordingsM addObject:model];
+                    self.snapshot.screenRecordingCount += 1;
+                    self.snapshot.screenRecordingBytes += model.fileSizeBytes;
+                    [self emitProgressMaybe];
+                    [self checkpointSaveAsyncForce:NO];
+                    continue;
+                }
 
-            self.snapshot.scannedCount += 1;
-            self.snapshot.scannedBytes += model.fileSizeBytes;
+                if (asset.mediaType == PHAssetMediaTypeVideo && model.fileSizeBytes >= kBigVideoMinBytes) {
+                    [self.bigVideosM addObject:model];
+                    self.snapshot.bigVideoCount += 1;
+                    self.snapshot.bigVideoBytes += model.fileSizeBytes;
+                }
 
-            if (ASIsScreenshot(asset)) {
-                [self.screenshotsM addObject:model];
-                self.snapshot.screenshotCount += 1;
-                self.snapshot.screenshotBytes += model.fileSizeBytes;
-                [self emitProgressMaybe];
-                [self checkpointSaveAsyncForce:NO];
-                continue;
-            }
+                if (ASAllowedForCompare(asset)) {
+                    BOOL grouped = [self matchAndGroup:model asset:asset];
+                    if (grouped) [self as_markGroupModulesDirtyForAsset:asset];
+                    if (grouped) [self as_noteGroupFormed];
+                    if (grouped && asset.mediaType == PHAssetMediaTypeImage) {
+                        [self otherCandidateRemoveIfExistsLocalId:model.localId];
+                    }
 
-            if (asset.mediaType == PHAssetMediaTypeImage) {
-                [self setModule:ASHomeModuleTypeOtherPhotos state:ASModuleScanStateScanning];
-                [self otherCandidateAddIfNeeded:model asset:asset];
-            }
+                    if (asset.mediaType == PHAssetMediaTypeImage) [self.comparableImagesM addObject:model];
+                    else if (asset.mediaType == PHAssetMediaTypeVideo) [self.comparableVideosM addObject:model];
 
-            if (asset.mediaType == PHAssetMediaTypeImage) {
-                float score = [self blurScoreForAsset:asset];
-                if (score >= 0.f) {
-                    model.blurScore = score;
-                    [self updateBlurryTopKFixed:model desiredK:desiredK];
+                    [self recomputeCleanableStatsFast];
                 }
-            }
 
-            if (ASIsScreenRecording(asset)) {
-                [self.screenRecordingsM addObject:model];
-                self.snapshot.screenRecordingCount += 1;
-                self.snapshot.screenRecordingBytes += model.fileSizeBytes;
                 [self emitProgressMaybe];
                 [self checkpointSaveAsyncForce:NO];
-                continue;
-            }
 
-            if (asset.mediaType == PHAssetMediaTypeVideo && model.fileSizeBytes >= kBigVideoMinBytes) {
-                [self.bigVideosM addObject:model];
-                self.snapshot.bigVideoCount += 1;
-                self.snapshot.bigVideoBytes += model.fileSizeBytes;
+                self.cache.anchorDate = [self as_safeAnchorDate:maxAnchor];
             }
+        }
+        if (stopped) break;
 
-            if (ASAllowedForCompare(asset)) {
-                BOOL grouped = [self matchAndGroup:model asset:asset];
-                if (grouped && asset.mediaType == PHAssetMediaTypeImage) {
-                    [self otherCandidateRemoveIfExistsLocalId:model.localId];
-                }
-
-                if (asset.mediaType == PHAssetMediaTypeImage) [self.comparableImagesM addObject:model];
-                else if (asset.mediaType == PHAssetMediaTypeVideo) [self.comparableVideosM addObject:model];
-
-                [self recomputeCleanableStatsFast];
-            }
+        // 单元做完：标记并立刻落盘（日志帧很小），后台窗口随时被收回也只丢当前单元
+        [plan markUnitDone:unit];
+        unitsThisRun += 1;
+        [self checkpointSaveAsyncForce:YES];
+    }
 
-            [self emitProgressMaybe];
-            [self checkpointSaveAsyncForce:NO];
+    if (unitsOut) *unitsOut = unitsThisRun;
+    if (assetsOut) *assetsOut = assetsThisRun;
 
-            self.cache.anchorDate = [self as_safeAnchorDate:maxAnchor];
-        }
+    if (stopped) {
+        // 停在单元中间：已处理的资产在 checkpoint 里，下次按 localId 跳过
+        self.cache.anchorDate = [self as_safeAnchorDate:maxAnchor];
+        [self as_compactCheckpointJournal];
+        [self as_endCheckpointJournal];
+        self.fullScanRunning = NO;
+        NSLog(@"[UNITS] stopped %lu/%lu units done, %lu this run",
+              (unsigned long)plan.doneCount, (unsigned long)plan.unitCount, (unsigned long)unitsThisRun);
+        return NO;
     }
 
     self.otherPhotosM = [[self buildOtherPhotosFromAllAssetsFetchResult:result] mutableCopy];
@@ -1342,7 +3354,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     self.cache.bigVideos = [self.bigVideosM copy];
     self.cache.comparableImages = [self.comparableImagesM copy];
     self.cache.comparableVideos = [self.comparableVideosM copy];
-    self.cache.blurryPhotos = [self.blurryPhotosM copy];
+    self.cache.blurryPhotos = [self.blurryTopK sortedModels];
     self.cache.otherPhotos  = [self.otherPhotosM copy];
 
     self.cache.currentDayStart = self.currentDay;
@@ -1353,7 +3365,10 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     self.cache.pendingUpsertIDs = self.pendingUpsertIDsPersist.allObjects ?: @[];
     self.cache.pendingRemovedIDs = self.pendingRemovedIDsPersist.allObjects ?: @[];
 
-    [self saveCacheAsync];
+    self.cache.journalSeq = self.journalSeq;
+    [self as_endCheckpointJournal];
+    [self as_saveCacheAsyncDroppingJournal];
+    if (as_metrics_enabled()) NSLog(@"[CACHE] checkpoint %@", [self.journal stats]);
 
     [self applyCacheToPublicStateWithCompletion:^{
         [self emitProgress];
@@ -1367,7 +3382,51 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         [self reconcilePendingChangesAfterFullScan];
     });
 
+    [[ASBackgroundScanScheduler shared] noteFullScanFinishedStartedAt:self.cache.scanStartedAt];
+    self.unitPlan = nil;
     self.fullScanRunning = NO;
+    return YES;
+}
+
+- (void)runBackgroundScanWindowUntil:(BOOL (^)(void))shouldStop
+                          completion:(void (^)(NSUInteger, NSUInteger, BOOL))completion
+{
+    dispatch_async(self.workQ, ^{
+        // 进程还活着、前台流水线没跑完：流水线会随进程恢复继续，这里只等它并统计单元
+        if (self.fullScanRunning) {
+            ASScanUnitPlan *plan = self.unitPlan;   // 完成时会被清掉，先拿住
+            NSUInteger unitsAtStart = plan.doneCount;
+            NSUInteger scannedAtStart = self.snapshot.scannedCount;
+            [self as_waitForFullScanUntil:shouldStop then:^{
+                NSUInteger units = plan.doneCount - unitsAtStart;
+                NSUInteger assets = self.snapshot.scannedCount - scannedAtStart;
+                completion(units, assets, self.cache.snapshot.state == ASScanStateFinished);
+            }];
+            return;
+        }
+
+        [self loadCacheIfExists];
+        if (self.cache.snapshot.state != ASScanStateScanning) {
+            completion(0, 0, self.cache.snapshot.state == ASScanStateFinished);
+            return;
+        }
+
+        NSUInteger units = 0, assets = 0;
+        BOOL finished = [self as_resumeFullScanUntil:shouldStop units:&units assets:&assets];
+        completion(units, assets, finished);
+    });
+}
+
+// 每秒看一次；不占住 workQ（流水线的归类要进 workQ）
+- (void)as_waitForFullScanUntil:(BOOL (^)(void))shouldStop then:(dispatch_block_t)done {
+    if (!self.fullScanRunning || shouldStop()) { done(); return; }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)NSEC_PER_SEC), self.workQ, ^{
+        [self as_waitForFullScanUntil:shouldStop then:done];
+    });
+}
+
+- (BOOL)hasUnfinishedFullScan {
+    return self.fullScanRunning || self.cache.snapshot.state == ASScanStateScanning;
 }
 
 - (void)resetPublicStateForNoPermission {
@@ -1444,7 +3503,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     ASScanCompletionBlock completionCopy = [completion copy];
 
     // 2. 重置所有容器状态
-    self.blurryPhotosM = [NSMutableArray array];
+    self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:nil];
     self.otherPhotosM  = [NSMutableArray array];
     self.comparableImagesM = [NSMutableArray array];
     self.comparableVideosM = [NSMutableArray array];
@@ -1456,6 +3515,8 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     
     [self.indexImage removeAllObjects];
     [self.indexVideo removeAllObjects];
+    // 旧 model 持有的行仍然有效（NSData 持有旧 arena），新扫描从新 arena 开始
+    self.visionArena = [ASFeaturePrintArena new];
 
     // 3. 初始化 Snapshot
     self.snapshot = [ASScanSnapshot new];
@@ -1469,18 +3530,25 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
             self.blurryImagesSeen = 0;
             self.blurryBytesRunning = 0;
             [ASBlurMemo() removeAllObjects];
+            [[ASFeatureExtractor shared] resetTimingStats];
             gBlurDebugPrinted = 0;
 
             self.otherCandidateMap = [NSMutableDictionary dictionary];
             self.otherCandidateBytes = 0;
             self.currentDay = nil;
+            [self as_prepareGroupingWindow];
+            [self as_beginPriorityScan];
+            [self as_resetProgressStats];
 
             // 5. 获取资源列表
             PHFetchResult<PHAsset *> *result = [PHAsset fetchAssetsWithOptions:[self allImageVideoFetchOptions]];
+            // 大小在服务的后台队列上先行解析，扫描线程随后直接命中
+            [[ASAssetSizeService shared] prefetchSizesForAssets:result];
             
             // 初始化缓存上下文
             self.cache.scanSessionId = [[NSUUID UUID] UUIDString];
             self.cache.scanStartedAt = [NSDate date];
+            self.cache.journalSeq = 0;
             self.cache.calendarIdentifier = NSCalendarIdentifierGregorian;
             self.cache.timeZoneName = [NSTimeZone localTimeZone].name;
             [self prepareScanCalendarFromCache];
@@ -1492,67 +3560,56 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
             [self.pendingUpsertIDsPersist removeAllObjects];
             [self.pendingRemovedIDsPersist removeAllObjects];
 
-            // 存一次初始状态
+            self.unitPlan = [[ASScanUnitPlan alloc] initWithAssetCount:result.count unitSize:kASScanUnitSize];
+            self.unitCursor = 0;
+
+            // 存一次初始状态（base），之后的 checkpoint 只追加日志
+            [self.journal resetStats];
+            [self.featureStore resetStats];
+            as_metrics_reset();
+            [self as_beginCheckpointJournal];
             [self checkpointSaveAsyncForce:YES];
 
             // 确定模糊检测参数
             self.cache.blurDesiredK = [self blurryDesiredKForLibraryQuick];
             NSUInteger desiredK = self.cache.blurDesiredK;
 
-            // 6. 启动并发流水线
-            // 创建并发队列
-            dispatch_queue_t concurrentQ = dispatch_queue_create("as.photo.scan.concurrent", DISPATCH_QUEUE_CONCURRENT);
-            // 信号量控制最大并发数
-            dispatch_semaphore_t semaphore = dispatch_semaphore_create(kASScanConcurrencyLimit);
-            
-            // 切换到并发队列进行繁重的 IO 和计算任务
-            dispatch_async(concurrentQ, ^{
-                [result enumerateObjectsUsingBlock:^(PHAsset * _Nonnull asset, NSUInteger idx, BOOL * _Nonnull stop) {
-                    // 检查取消
-                    if (self.cancelled) {
-                        *stop = YES;
-                        return;
-                    }
-                    
-                    // 等待信号量 (控制并发数)
-                    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-                    
-                    @autoreleasepool {
-                        NSError *error = nil;
-                        
-                        // [关键优化] buildModelForAsset 内部现在必须包含:
-                        // 1. 加载缩略图
-                        // 2. 计算 pHash
-                        // 3. 计算 Vision Feature (如果是可比图片)
-                        // 确保这一步完成后，Model 已经包含了所有需要对比的数据
-                        ASAssetModel *model = [self buildModelForAsset:asset computeCompareBits:YES error:&error];
-                        
-                        if (model) {
-                            // 在并发线程计算模糊度 (耗时操作)
-                            if (asset.mediaType == PHAssetMediaTypeImage && !ASIsScreenshot(asset)) {
-                                float score = [self blurScoreForAsset:asset];
-                                if (score >= 0.f) {
-                                    model.blurScore = score;
-                                }
-                            }
-                            
-                            // 耗时计算完成后，同步回 workQ 进行线程安全的归类
-                            // dispatch_sync 确保顺序性并保护可变数组
-                            dispatch_sync(self.workQ, ^{
-                                [self processSingleScannedModel:model asset:asset desiredK:desiredK];
-                            });
-                        }
-                    }
-                    
-                    // 释放信号量
-                    dispatch_semaphore_signal(semaphore);
-                }];
-                
-                // 循环结束，回到 workQ 处理收尾
+            // 6. 启动流水线：fetch -> decode/特征（自适应并发）-> 归类（workQ，按相册顺序）
+            ASScanPipeline *pipeline = [[ASScanPipeline alloc] initWithCount:result.count fetch:^NSArray *(NSRange range) {
+                return [result objectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:range]];
+            } decode:^id(PHAsset *asset) {
+                if (self.cancelled) return nil;
+
+                // buildModelForAsset 内部只解码一次缩略图：pHash + 模糊度（直接写进 model.blurScore）；
+                // Vision Feature 延迟到分组命中时，复用刚解码的缩略图
+                ASMetricInterval iv = as_metrics_begin(AS_STAGE_DECODE);
+                NSError *error = nil;
+                ASAssetModel *model = [self buildModelForAsset:asset computeCompareBits:YES error:&error];
+                as_metrics_end(iv);
+                // 失败也要占位，归类端才能按下标推进工作单元
+                return model ?: (id)[NSNull null];
+            } consume:^(PHAsset *asset, id result) {
+                if ([result isKindOfClass:ASAssetModel.class]) {
+                    ASMetricInterval iv = as_metrics_begin(AS_STAGE_GROUP);
+                    [self processSingleScannedModel:result asset:asset desiredK:desiredK];
+                    as_metrics_end(iv);
+                    as_metrics_add(AS_COUNTER_ASSETS, 1);
+                }
+                [self as_advanceUnitCursor];
+            } queue:self.workQ];
+            self.scanPipeline = pipeline;
+
+            [pipeline startWithCompletion:^(BOOL cancelled) {
+                // 回到 workQ 处理收尾
                 dispatch_async(self.workQ, ^{
+                    if (as_metrics_enabled()) {
+                        NSLog(@"[PIPELINE] %@", [pipeline stats]);
+                        as_metrics_mark_end();
+                        NSLog(@"[METRICS] %@", [[NSString alloc] initWithData:[self scanMetricsJSON] encoding:NSUTF8StringEncoding]);
+                    }
                     [self finishFullScanWithCompletion:completionCopy tempToken:tempToken];
                 });
-            });
+            }];
         }
     });
 }
@@ -1576,9 +3633,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     // 3. 更新日期索引 (用于相似度分桶)
     NSDate *day = [self as_dayStart:cd];
     if (!self.currentDay || ![day isEqualToDate:self.currentDay]) {
-        self.currentDay = day;
-        [self.indexImage removeAllObjects];
-        [self.indexVideo removeAllObjects];
+        [self as_rollDayPoolsToDay:day];
     }
 
     // 4. 分类逻辑
@@ -1627,7 +3682,9 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
         // 这里不再会有 IO 操作，VisionData 在并发步骤已备好
         BOOL grouped = [self matchAndGroup:model asset:asset];
-        
+        if (grouped) [self as_markGroupModulesDirtyForAsset:asset];
+        if (grouped) [self as_noteGroupFormed];
+
         if (grouped && asset.mediaType == PHAssetMediaTypeImage) {
             [self otherCandidateRemoveIfExistsLocalId:model.localId];
         }
@@ -1645,6 +3702,16 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     [self checkpointSaveAsyncForce:NO];
 }
 
+// 流水线按 fetch 顺序归类，归类到单元末尾即该单元完成（取消后不再推进：之后的下标可能被跳过）
+- (void)as_advanceUnitCursor {
+    ASScanUnitPlan *plan = self.unitPlan;
+    if (!plan || self.cancelled) return;
+    self.unitCursor += 1;
+    if (self.unitCursor % plan.unitSize == 0 || self.unitCursor == plan.assetCount) {
+        [plan markUnitDone:(self.unitCursor - 1) / plan.unitSize];
+    }
+}
+
 // 辅助方法：完成扫描后的收尾 (必须在 workQ 中调用)
 - (void)finishFullScanWithCompletion:(ASScanCompletionBlock)completionCopy tempToken:(NSUUID *)tempToken {
     NSError *error = nil;
@@ -1656,6 +3723,11 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     } else {
         // 正常完成
         self.snapshot.state = ASScanStateFinished;
+        if (as_metrics_enabled()) NSLog(@"[FEATURE] %@", [[ASFeatureExtractor shared] timingStats]);
+        if (as_metrics_enabled()) NSLog(@"[FSTORE] %@", [self.featureStore stats]);
+        if (as_metrics_enabled()) NSLog(@"[SIZE] %@", [[ASAssetSizeService shared] stats]);
+        self.priorityStats = self.priorityStatsM;
+        if (as_metrics_enabled()) NSLog(@"[PRIORITY] %@", self.priorityStats);
         self.snapshot.duplicateGroupCount = self.dupGroupsM.count;
         self.snapshot.similarGroupCount = self.simGroupsM.count;
         self.snapshot.lastUpdated = [NSDate date];
@@ -1676,7 +3748,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         self.cache.bigVideos = [self.bigVideosM copy];
         self.cache.comparableImages = [self.comparableImagesM copy];
         self.cache.comparableVideos = [self.comparableVideosM copy];
-        self.cache.blurryPhotos = [self.blurryPhotosM copy];
+        self.cache.blurryPhotos = [self.blurryTopK sortedModels];
         self.cache.otherPhotos  = [self.otherPhotosM copy];
 
         // 更新 Home 统计刷新时间
@@ -1692,8 +3764,11 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         self.cache.blurryBytesRunning = self.blurryBytesRunning;
         self.cache.otherCandidateBytes = self.otherCandidateBytes;
 
-        // 存盘
-        [self saveCacheAsync];
+        // 存盘：最终 base 覆盖整个日志
+        self.cache.journalSeq = self.journalSeq;
+        [self as_endCheckpointJournal];
+        [self as_saveCacheAsyncDroppingJournal];
+        if (as_metrics_enabled()) NSLog(@"[CACHE] checkpoint %@", [self.journal stats]);
         
         // 更新 UI 模块状态
         [self setModule:ASHomeModuleTypeBlurryPhotos state:ASModuleScanStateFinished];
@@ -1711,8 +3786,13 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         [self refreshAllAssetsFetchResult];
         NSArray *ids = [self as_currentAllAssetIDsFromFetchResult:self.allAssetsFetchResult];
         [self as_saveBaselineAllAssetIDs:ids];
+
+        [[ASBackgroundScanScheduler shared] noteFullScanFinishedStartedAt:self.cache.scanStartedAt];
+        self.unitPlan = nil;
     }
 
+    // 取消：已写的 base + 日志保留，下次续扫重放
+    [self as_endCheckpointJournal];
     self.fullScanRunning = NO;
 
     // 回调主线程
@@ -1788,6 +3868,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
     if (!self.otherPhotosM) self.otherPhotosM = [NSMutableArray array];
     [self.otherPhotosM addObject:model];
+    [self as_journalOtherAdded:model];
 
     self.snapshot.otherCount = self.otherPhotosM.count;
     self.snapshot.otherBytes = self.otherCandidateBytes;
@@ -1802,7 +3883,12 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
     if (self.otherCandidateBytes >= old.fileSizeBytes) self.otherCandidateBytes -= old.fileSizeBytes;
     else self.otherCandidateBytes = 0;
 
-    [self.otherPhotosM removeObject:old];
+    // 刚被模糊 Top-K 收走的多半是最近才追加的，从尾部按指针找（removeObject: 要从头 isEqual 全表）
+    NSMutableArray<ASAssetModel *> *other = self.otherPhotosM;
+    for (NSUInteger i = other.count; i > 0; i--) {
+        if (other[i - 1] == old) { [other removeObjectAtIndex:i - 1]; break; }
+    }
+    [self as_journalOtherRemoved:lid];
 
     self.snapshot.otherCount = self.otherPhotosM.count;
     self.snapshot.otherBytes = self.otherCandidateBytes;
@@ -1810,6 +3896,8 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
 - (void)cancel {
     self.cancelled = YES;
+    [[ASAssetSizeService shared] cancelPrefetch];
+    [self.scanPipeline cancel];
 }
 
 - (BOOL)isCacheValid {
@@ -1858,6 +3946,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
 
     s.lastUpdated = src.lastUpdated ?: [NSDate date];
     s.phash256Data = [src.phash256Data copy];
+    s.closedSinceDay = src.closedSinceDay;
     s.moduleStates = [src.moduleStates copy] ?: @[@0,@0,@0,@0,@0,@0,@0,@0,@0];
     return s;
 }
@@ -1900,7 +3989,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         self.bigVideosM = [self.cache.bigVideos mutableCopy] ?: [NSMutableArray array];
         self.comparableImagesM = [self.cache.comparableImages mutableCopy] ?: [NSMutableArray array];
         self.comparableVideosM = [self.cache.comparableVideos mutableCopy] ?: [NSMutableArray array];
-        self.blurryPhotosM = [self.cache.blurryPhotos mutableCopy] ?: [NSMutableArray array];
+        self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:self.cache.blurryPhotos];
         self.otherPhotosM  = [self.cache.otherPhotos mutableCopy] ?: [NSMutableArray array];
 
         [self removeModelsByIds:deleted];
@@ -1916,7 +4005,7 @@ static NSString * const kASHasScannedOnceKey      = @"as_has_scanned_once_v1";
         self.cache.bigVideos       = [self.bigVideosM copy];
         self.cache.comparableImages = [self.comparableImagesM copy];
         self.cache.comparableVideos = [self.comparableVideosM copy];
-        self.cache.blurryPhotos    = [self.blurryPhotosM copy];
+        self.cache.blurryPhotos    = [self.blurryTopK sortedModels];
         self.cache.otherPhotos     = [self.otherPhotosM copy];
 
         [self saveCacheAsync];
@@ -1953,20 +4042,15 @@ static inline BOOL ASModelIsScreenshot(ASAssetModel *m) {
 
     if (!self.otherPhotosM) self.otherPhotosM = [NSMutableArray array];
     [self.otherPhotosM addObject:model];
+    [self as_journalOtherAdded:model];
 
     self.snapshot.otherCount = self.otherPhotosM.count;
     self.snapshot.otherBytes = self.otherCandidateBytes;
 }
 
 - (NSArray<ASAssetModel *> *)buildOtherPhotosFromAllAssetsFetchResult:(PHFetchResult<PHAsset*> *)result {
-    NSMutableSet<NSString*> *exclude = [NSMutableSet set];
-
-    for (ASAssetGroup *g in self.dupGroupsM)
-        for (ASAssetModel *m in g.assets) if(m.localId.length) [exclude addObject:m.localId];
-    for (ASAssetGroup *g in self.simGroupsM)
-        for (ASAssetModel *m in g.assets) if(m.localId.length) [exclude addObject:m.localId];
-    for (ASAssetModel *m in self.screenshotsM) if(m.localId.length) [exclude addObject:m.localId];
-    for (ASAssetModel *m in self.blurryPhotosM) if(m.localId.length) [exclude addObject:m.localId];
+    ASAssetIdSet *exclude = [self as_buildExcludeIdsForOther];
+    [exclude addModels:self.screenshotsM];
 
     NSMutableArray<ASAssetModel*> *out = [NSMutableArray array];
 
@@ -1975,7 +4059,7 @@ static inline BOOL ASModelIsScreenshot(ASAssetModel *m) {
         if (ASIsScreenshot(a)) continue;
         NSString *lid = a.localIdentifier ?: @"";
         if (!lid.length) continue;
-        if ([exclude containsObject:lid]) continue;
+        if ([exclude containsLocalId:lid]) continue;
 
         NSError *err = nil;
         ASAssetModel *m = [self buildModelForAsset:a computeCompareBits:NO error:&err];
@@ -1996,32 +4080,16 @@ static inline BOOL ASModelIsScreenshot(ASAssetModel *m) {
     desiredK = MAX(kBlurKeepMin, desiredK);
     desiredK = MIN(kBlurKeepMax, desiredK);
 
-    if (!self.blurryPhotosM) self.blurryPhotosM = [NSMutableArray array];
-
-    if (self.blurryPhotosM.count >= desiredK) {
-        ASAssetModel *leastBlurry = self.blurryPhotosM.lastObject;
-        if (!(m.blurScore < leastBlurry.blurScore)) return;
-
-        [self.blurryPhotosM removeLastObject];
-        if (self.blurryBytesRunning >= leastBlurry.fileSizeBytes) self.blurryBytesRunning -= leastBlurry.fileSizeBytes;
-        else self.blurryBytesRunning = 0;
+    if (!self.blurryTopK) self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:nil];
 
-        [self otherCandidateAddModelIfNeeded:leastBlurry];
-    }
-
-    NSUInteger lo = 0, hi = self.blurryPhotosM.count;
-    while (lo < hi) {
-        NSUInteger mid = (lo + hi) >> 1;
-        ASAssetModel *x = self.blurryPhotosM[mid];
-        if (m.blurScore < x.blurScore) hi = mid;
-        else lo = mid + 1;
-    }
-    [self.blurryPhotosM insertObject:m atIndex:lo];
-    self.blurryBytesRunning += m.fileSizeBytes;
+    ASAssetModel *leastBlurry = nil;
+    if (![self.blurryTopK offerModel:m limit:desiredK evicted:&leastBlurry]) return;
+    self.blurryBytesRunning = self.blurryTopK.totalBytes;
 
+    if (leastBlurry) [self otherCandidateAddModelIfNeeded:leastBlurry];
     [self otherCandidateRemoveIfExistsLocalId:m.localId];
 
-    self.snapshot.blurryCount = self.blurryPhotosM.count;
+    self.snapshot.blurryCount = self.blurryTopK.count;
     self.snapshot.blurryBytes = self.blurryBytesRunning;
 }
 
@@ -2031,196 +4099,23 @@ static inline NSString *ASBlurCacheKeyForAsset(PHAsset *a) {
     return [NSString stringWithFormat:@"%@_%.0f", lid, t * 1000.0];
 }
 
-- (float)blurScoreForAsset:(PHAsset *)asset {
-    NSString *key = ASBlurCacheKeyForAsset(asset);
-    NSNumber *cached = [ASBlurMemo() objectForKey:key];
-    if (cached) return cached.floatValue;
-
-    if (asset.mediaType != PHAssetMediaTypeImage) return -1.f;
-    if (ASIsScreenshot(asset)) return -1.f;
-
-    UIImage *thumb = [self requestThumbnailSyncForAsset:asset target:CGSizeMake(512, 512)];
-    if (!thumb.CGImage) return -1.f;
-
-    vImage_Buffer gray = {0};
-    if (![self vImageGrayFromCGImage:thumb.CGImage outGray:&gray] || !gray.data) return -1.f;
-
-    vImage_Buffer roi = [self vImageCenterROIFromGray:gray frac:0.60f];
-    vImage_Buffer roi8 = [self copyROIToContiguousPlanar8:roi];
-
-    uint8_t *p = (uint8_t *)roi8.data;
-    uint64_t n = (uint64_t)roi8.width * (uint64_t)roi8.height;
-    double sum=0, sum2=0;
-    for (uint64_t i=0;i<n;i++){ double v=p[i]; sum+=v; sum2+=v*v; }
-    double mean = sum / (double)MAX(n,1);
-    double var  = sum2/(double)MAX(n,1) - mean*mean;
-    if (var < 0) var = 0;
-    double std  = sqrt(var);
-
-    float score = -1.f;
-    if (mean > 20.0 && std > 8.0) {
-        score = [self tenengradMeanSqOnROI8:roi8];
-    }
-
-    free(roi8.data);
-    free(gray.data);
-    [ASBlurMemo() setObject:@(score) forKey:key];
-
-    return score;
-}
-
-#pragma mark - vImage helpers
-
-- (vImage_Buffer)copyROIToContiguousPlanar8:(vImage_Buffer)roi {
-    vImage_Buffer out = {0};
-    out.width = roi.width;
-    out.height = roi.height;
-    out.rowBytes = roi.width; // 连续
-    out.data = malloc(out.rowBytes * out.height);
-    if (!out.data) return (vImage_Buffer){0};
-
-    for (uint32_t y = 0; y < out.height; y++) {
-        memcpy((uint8_t *)out.data + y*out.rowBytes,
-               (uint8_t *)roi.data + y*roi.rowBytes,
-               out.width);
-    }
-    return out;
-}
-
-- (float)tenengradMeanSqOnROI8:(vImage_Buffer)roi8 {
-    const uint32_t w = (uint32_t)roi8.width, h = (uint32_t)roi8.height;
-    if (w < 5 || h < 5) return 0.f;
-
-    const int16_t kx[9] = {
-        -1, 0, 1,
-        -2, 0, 2,
-        -1, 0, 1
-    };
-    const int16_t ky[9] = {
-        -1, -2, -1,
-         0,  0,  0,
-         1,  2,  1
-    };
-
-    vImage_Buffer gx8 = {0}, gy8 = {0};
-    gx8.width = gy8.width = w;
-    gx8.height = gy8.height = h;
-    gx8.rowBytes = gy8.rowBytes = w;
-    gx8.data = malloc((size_t)w * (size_t)h);
-    gy8.data = malloc((size_t)w * (size_t)h);
-    if (!gx8.data || !gy8.data) {
-        if (gx8.data) free(gx8.data);
-        if (gy8.data) free(gy8.data);
-        return 0.f;
-    }
-
-    vImageConvolve_Planar8(&roi8, &gx8, NULL, 0, 0, kx, 3, 3, 1, 128, kvImageEdgeExtend);
-    vImageConvolve_Planar8(&roi8, &gy8, NULL, 0, 0, ky, 3, 3, 1, 128, kvImageEdgeExtend);
-
-    uint8_t *px = (uint8_t *)gx8.data;
-    uint8_t *py = (uint8_t *)gy8.data;
-    uint64_t n = (uint64_t)w * (uint64_t)h;
-
-    double sum2 = 0.0;
-    for (uint64_t i=0; i<n; i++) {
-        int gx = (int)px[i] - 128;
-        int gy = (int)py[i] - 128;
-        sum2 += (double)(gx*gx + gy*gy);
-    }
-
-    free(gx8.data);
-    free(gy8.data);
-
-    return (float)(sum2 / (double)MAX(n,1));
-}
+#pragma mark - vImage helpers
 
 - (void)updateBlurryTopKFixed:(ASAssetModel *)m desiredK:(NSUInteger)desiredK {
     if (!m || m.blurScore < 0.f || desiredK == 0) return;
-    if (!self.blurryPhotosM) self.blurryPhotosM = [NSMutableArray array];
-
-    if (self.blurryPhotosM.count >= desiredK) {
-        ASAssetModel *leastBlurry = self.blurryPhotosM.lastObject;
-        if (!(m.blurScore < leastBlurry.blurScore)) return;
-
-        [self.blurryPhotosM removeLastObject];
-        if (self.blurryBytesRunning >= leastBlurry.fileSizeBytes) self.blurryBytesRunning -= leastBlurry.fileSizeBytes;
-        else self.blurryBytesRunning = 0;
-
-        [self otherCandidateAddModelIfNeeded:leastBlurry];
-    }
+    if (!self.blurryTopK) self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:nil];
 
-    NSUInteger lo = 0, hi = self.blurryPhotosM.count;
-    while (lo < hi) {
-        NSUInteger mid = (lo + hi) >> 1;
-        ASAssetModel *x = self.blurryPhotosM[mid];
-        if (m.blurScore < x.blurScore) hi = mid;
-        else lo = mid + 1;
-    }
-    [self.blurryPhotosM insertObject:m atIndex:lo];
-    self.blurryBytesRunning += m.fileSizeBytes;
+    ASAssetModel *leastBlurry = nil;
+    if (![self.blurryTopK offerModel:m limit:desiredK evicted:&leastBlurry]) return;
+    self.blurryBytesRunning = self.blurryTopK.totalBytes;
 
+    if (leastBlurry) [self otherCandidateAddModelIfNeeded:leastBlurry];
     [self otherCandidateRemoveIfExistsLocalId:m.localId];
 
-    self.snapshot.blurryCount = self.blurryPhotosM.count;
+    self.snapshot.blurryCount = self.blurryTopK.count;
     self.snapshot.blurryBytes = self.blurryBytesRunning;
 }
 
-- (BOOL)vImageGrayFromCGImage:(CGImageRef)cg outGray:(vImage_Buffer *)outGray {
-    if (!cg || !outGray) return NO;
-
-    const size_t w = CGImageGetWidth(cg);
-    const size_t h = CGImageGetHeight(cg);
-    if (w == 0 || h == 0) return NO;
-
-    vImage_Buffer rgba = {0};
-    rgba.width = w;
-    rgba.height = h;
-    rgba.rowBytes = w * 4;
-    rgba.data = malloc(rgba.rowBytes * h);
-    if (!rgba.data) return NO;
-
-    CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
-    CGContextRef ctx = CGBitmapContextCreate(
-        rgba.data, w, h, 8, rgba.rowBytes, cs,
-        (CGBitmapInfo)kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big
-    );
-    CGColorSpaceRelease(cs);
-    if (!ctx) { free(rgba.data); return NO; }
-    CGContextDrawImage(ctx, CGRectMake(0, 0, w, h), cg);
-    CGContextRelease(ctx);
-
-    outGray->width = w;
-    outGray->height = h;
-    outGray->rowBytes = w;
-    outGray->data = malloc(outGray->rowBytes * h);
-    if (!outGray->data) { free(rgba.data); return NO; }
-
-    vImage_Buffer argb = {0};
-    argb.width = w;
-    argb.height = h;
-    argb.rowBytes = w * 4;
-    argb.data = malloc(argb.rowBytes * h);
-    if (!argb.data) { free(rgba.data); free(outGray->data); outGray->data=NULL; return NO; }
-
-    const uint8_t permuteMap[4] = {3, 0, 1, 2};
-    vImage_Error e = vImagePermuteChannels_ARGB8888(&rgba, &argb, permuteMap, kvImageNoFlags);
-    free(rgba.data);
-    if (e != kvImageNoError) { free(argb.data); free(outGray->data); outGray->data=NULL; return NO; }
-
-    const int16_t mtx[4] = {0, 77, 150, 29};  // *256
-    const int32_t divisor = 256;
-    e = vImageMatrixMultiply_ARGB8888ToPlanar8(&argb, outGray, mtx, divisor, NULL, 0, kvImageNoFlags);
-
-    free(argb.data);
-
-    if (e != kvImageNoError) {
-        free(outGray->data);
-        outGray->data = NULL;
-        return NO;
-    }
-    return YES;
-}
-
 - (float)edgeDensityOnGrayROI_Planar8:(vImage_Buffer)roi edgeThreshold:(int)thr {
     const uint32_t w = (uint32_t)roi.width;
     const uint32_t h = (uint32_t)roi.height;
@@ -2274,23 +4169,6 @@ static inline NSString *ASBlurCacheKeyForAsset(PHAsset *a) {
     return (float)strong / (float)MAX(n, 1);
 }
 
-- (vImage_Buffer)vImageCenterROIFromGray:(vImage_Buffer)gray frac:(float)frac {
-    frac = fmaxf(0.1f, fminf(frac, 1.0f));
-    uint32_t rw = (uint32_t)lrintf((float)gray.width * frac);
-    uint32_t rh = (uint32_t)lrintf((float)gray.height * frac);
-    rw = MAX(16, rw); rh = MAX(16, rh);
-
-    uint32_t x0 = (uint32_t)((gray.width  - rw) / 2);
-    uint32_t y0 = (uint32_t)((gray.height - rh) / 2);
-
-    vImage_Buffer roi = {0};
-    roi.width = rw;
-    roi.height = rh;
-    roi.rowBytes = gray.rowBytes;
-    roi.data = (uint8_t *)gray.data + y0 * gray.rowBytes + x0;
-    return roi;
-}
-
 - (float)tenengradOnGrayROI:(vImage_Buffer)roi {
     const int16_t kx[9] = {
         -1, 0, 1,
@@ -2350,39 +4228,19 @@ static const NSUInteger kASLocalIdChunk = 3500;
     return candidate;
 }
 
-- (NSMutableSet<NSString *> *)as_collectCachedIdsFromCache {
-    NSMutableSet<NSString *> *cachedIds = [NSMutableSet set];
-
-    NSArray<ASAssetGroup *> *dup = self.cache.duplicateGroups ?: @[];
-    for (ASAssetGroup *g in dup)
-        for (ASAssetModel *m in g.assets)
-            if (m.localId.length) [cachedIds addObject:m.localId];
+- (ASAssetIdSet *)as_collectCachedIdsFromCache {
+    ASAssetIdSet *cachedIds = [ASAssetIdSet new];
 
-    NSArray<ASAssetGroup *> *sim = self.cache.similarGroups ?: @[];
-    for (ASAssetGroup *g in sim)
-        for (ASAssetModel *m in g.assets)
-            if (m.localId.length) [cachedIds addObject:m.localId];
+    for (ASAssetGroup *g in (self.cache.duplicateGroups ?: @[])) [cachedIds addModels:g.assets];
+    for (ASAssetGroup *g in (self.cache.similarGroups ?: @[])) [cachedIds addModels:g.assets];
 
-    for (ASAssetModel *m in (self.cache.screenshots ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.screenRecordings ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.bigVideos ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.blurryPhotos ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.otherPhotos ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.comparableImages ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
-
-    for (ASAssetModel *m in (self.cache.comparableVideos ?: @[]))
-        if (m.localId.length) [cachedIds addObject:m.localId];
+    [cachedIds addModels:self.cache.screenshots];
+    [cachedIds addModels:self.cache.screenRecordings];
+    [cachedIds addModels:self.cache.bigVideos];
+    [cachedIds addModels:self.cache.blurryPhotos];
+    [cachedIds addModels:self.cache.otherPhotos];
+    [cachedIds addModels:self.cache.comparableImages];
+    [cachedIds addModels:self.cache.comparableVideos];
 
     return cachedIds;
 }
@@ -2555,14 +4413,14 @@ static const NSUInteger kASLocalIdChunk = 3500;
                                removedIDs:(NSArray<NSString*> *)removedIDs
 {
     NSArray<NSString *> *baselineArr = [self as_loadBaselineAllAssetIDs];
-    NSSet<NSString *> *baselineSet = baselineArr.count ? [NSSet setWithArray:baselineArr]
-                                                       : [self as_collectCachedIdsFromCache];
+    ASAssetIdSet *baselineSet = baselineArr.count ? [[ASAssetIdSet alloc] initWithLocalIds:baselineArr]
+                                                  : [self as_collectCachedIdsFromCache];
 
     NSMutableArray<PHAsset *> *realInserted = [NSMutableArray array];
     for (PHAsset *a in upserts) {
         NSString *lid = a.localIdentifier ?: @"";
         if (!lid.length) continue;
-        if (![baselineSet containsObject:lid]) {
+        if (![baselineSet containsLocalId:lid]) {
             [realInserted addObject:a];
         }
     }
@@ -2610,6 +4468,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     }
     
     self.incrementalRunning = YES;
+    [self.featureStore resetStats];
 
     ASIncLog(@"rebuild begin | inserted=%lu removed=%lu oldAnchor=%@",
              (unsigned long)inserted.count,
@@ -2627,13 +4486,12 @@ static const NSUInteger kASLocalIdChunk = 3500;
     self.screenRecordingsM = [self.cache.screenRecordings mutableCopy] ?: [NSMutableArray array];
     self.bigVideosM = [self.cache.bigVideos mutableCopy] ?: [NSMutableArray array];
 
-    self.blurryPhotosM = [self.cache.blurryPhotos mutableCopy] ?: [NSMutableArray array];
+    self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:self.cache.blurryPhotos];
     self.otherPhotosM  = [self.cache.otherPhotos  mutableCopy] ?: [NSMutableArray array];
 
-    self.blurryBytesRunning = 0;
-    for (ASAssetModel *bm in self.blurryPhotosM) self.blurryBytesRunning += bm.fileSizeBytes;
+    self.blurryBytesRunning = self.blurryTopK.totalBytes;
 
-    NSArray<ASAssetModel *> *oldBlur = [self.blurryPhotosM copy] ?: @[];
+    NSArray<ASAssetModel *> *oldBlur = [self.blurryTopK sortedModels] ?: @[];
 
     [self publishSnapshotStateOnMain:ASScanStateScanning];
 
@@ -2683,15 +4541,13 @@ static const NSUInteger kASLocalIdChunk = 3500;
             if (lid.length) [ASScreenRecordingMemo() removeObjectForKey:lid];
         }
 
-        self.blurryBytesRunning = 0;
-        for (ASAssetModel *bm in self.blurryPhotosM) self.blurryBytesRunning += bm.fileSizeBytes;
+        self.blurryBytesRunning = self.blurryTopK.totalBytes;
     }
 
     if (affectedDayStarts.count) {
         [self removeModelsByDayStarts:affectedDayStarts];
 
-        self.blurryBytesRunning = 0;
-        for (ASAssetModel *bm in self.blurryPhotosM) self.blurryBytesRunning += bm.fileSizeBytes;
+        self.blurryBytesRunning = self.blurryTopK.totalBytes;
 
         newAnchor = [self rebuildDaysObjC:affectedDayStarts];
     }
@@ -2699,7 +4555,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     [self rebuildIndexFromComparablePools];
 
     NSMutableSet<NSDate*> *otherRefreshDays = [affectedDayStarts mutableCopy];
-    [self as_addBlurChangedDayStartsFromOld:oldBlur toNew:(self.blurryPhotosM ?: @[]) into:otherRefreshDays];
+    [self as_addBlurChangedDayStartsFromOld:oldBlur toNew:([self.blurryTopK sortedModels] ?: @[]) into:otherRefreshDays];
     [self as_replaceOtherForDayStarts:otherRefreshDays];
 
     [self recomputeSnapshotFromCurrentContainers];
@@ -2714,7 +4570,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     self.cache.comparableImages = [self.comparableImagesM copy];
     self.cache.comparableVideos = [self.comparableVideosM copy];
 
-    self.cache.blurryPhotos = [self.blurryPhotosM copy];
+    self.cache.blurryPhotos = [self.blurryTopK sortedModels];
     self.cache.otherPhotos  = [self.otherPhotosM  copy];
 
     self.cache.anchorDate = [self as_safeAnchorDate:newAnchor];
@@ -2727,13 +4583,14 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
     [self setAllModulesState:ASModuleScanStateFinished];
 
+    ASIncLog(@"rebuild features | %@", [self.featureStore stats]);
     ASIncLog(@"rebuild done | dup=%lu sim=%lu shot=%lu rec=%lu big=%lu blurry=%lu other=%lu newAnchor=%@",
              (unsigned long)self.dupGroupsM.count,
              (unsigned long)self.simGroupsM.count,
              (unsigned long)self.screenshotsM.count,
              (unsigned long)self.screenRecordingsM.count,
              (unsigned long)self.bigVideosM.count,
-             (unsigned long)self.blurryPhotosM.count,
+             (unsigned long)self.blurryTopK.count,
              (unsigned long)self.otherPhotosM.count,
              self.cache.anchorDate);
 
@@ -2756,16 +4613,12 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
 #pragma mark - Other Incremental (affectedDays only)
 
-- (NSMutableSet<NSString *> *)as_buildExcludeIdsForOther {
-    NSMutableSet<NSString *> *ex = [NSMutableSet set];
+- (ASAssetIdSet *)as_buildExcludeIdsForOther {
+    ASAssetIdSet *ex = [ASAssetIdSet new];
 
-    for (ASAssetGroup *g in self.dupGroupsM) {
-        for (ASAssetModel *m in g.assets) if (m.localId.length) [ex addObject:m.localId];
-    }
-    for (ASAssetGroup *g in self.simGroupsM) {
-        for (ASAssetModel *m in g.assets) if (m.localId.length) [ex addObject:m.localId];
-    }
-    for (ASAssetModel *m in self.blurryPhotosM) if (m.localId.length) [ex addObject:m.localId];
+    for (ASAssetGroup *g in self.dupGroupsM) [ex addModels:g.assets];
+    for (ASAssetGroup *g in self.simGroupsM) [ex addModels:g.assets];
+    [ex addModels:[self.blurryTopK sortedModels]];
 
     return ex;
 }
@@ -2781,7 +4634,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
 }
 
 - (NSArray<ASAssetModel *> *)as_buildOtherForDayStart:(NSDate *)dayStart
-                                             exclude:(NSSet<NSString *> *)exclude
+                                             exclude:(ASAssetIdSet *)exclude
                                          modelByLocal:(NSDictionary<NSString*, ASAssetModel*> *)modelByLocal
 {
     if (!dayStart) return @[];
@@ -2804,7 +4657,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     for (PHAsset *a in fr) {
         NSString *lid = a.localIdentifier ?: @"";
         if (!lid.length) continue;
-        if ([exclude containsObject:lid]) continue;
+        if ([exclude containsLocalId:lid]) continue;
 
         ASAssetModel *m = modelByLocal[lid];
         if (m) {
@@ -2831,7 +4684,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     }
     self.otherPhotosM = kept;
 
-    NSSet<NSString *> *exclude = [self as_buildExcludeIdsForOther];
+    ASAssetIdSet *exclude = [self as_buildExcludeIdsForOther];
     NSDictionary<NSString*, ASAssetModel*> *modelByLocal = [self as_buildComparableImageMap];
 
     NSArray<NSDate *> *sortedDays = [[dayStarts allObjects] sortedArrayUsingComparator:^NSComparisonResult(NSDate *a, NSDate *b) {
@@ -2878,7 +4731,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
     scan(self.comparableImagesM);
     scan(self.screenshotsM);
-    scan(self.blurryPhotosM);
+    scan([self.blurryTopK sortedModels]);
     scan(self.otherPhotosM);
 }
 
@@ -2997,7 +4850,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
     self.bigVideosM = [[self.bigVideosM filteredArrayUsingPredicate:keep] mutableCopy];
     self.comparableImagesM = [[self.comparableImagesM filteredArrayUsingPredicate:keep] mutableCopy];
     self.comparableVideosM = [[self.comparableVideosM filteredArrayUsingPredicate:keep] mutableCopy];
-    self.blurryPhotosM = [[self.blurryPhotosM filteredArrayUsingPredicate:keep] mutableCopy];
+    [self.blurryTopK removeModelsPassingTest:^BOOL(ASAssetModel *m) { return ![keep evaluateWithObject:m]; }];
     self.otherPhotosM  = [[self.otherPhotosM  filteredArrayUsingPredicate:keep] mutableCopy];
 }
 
@@ -3005,6 +4858,10 @@ static const NSUInteger kASLocalIdChunk = 3500;
     NSDate *maxA = self.cache.anchorDate ?: [NSDate dateWithTimeIntervalSince1970:0];
     NSUInteger desiredK = [self blurryDesiredKForLibraryQuick];
 
+    // 受影响的天已从容器移除，剩余的 comparable 作为跨天候选
+    [self as_prepareGroupingWindow];
+    [self as_reseedCrossDayPools];
+
     NSCalendar *cal = self.scanCalendar ?: [NSCalendar currentCalendar];
     for (NSDate *dayStart in dayStarts) {
         NSDate *dayEnd = [cal dateByAddingUnit:NSCalendarUnitDay value:1 toDate:dayStart options:0];
@@ -3017,8 +4874,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
         PHFetchResult<PHAsset *> *fr = [PHAsset fetchAssetsWithOptions:opt];
 
-        [self.indexImage removeAllObjects];
-        [self.indexVideo removeAllObjects];
+        [self as_clearDayPools];
 
         for (PHAsset *asset in fr) {
             NSDate *cd = asset.creationDate ?: [NSDate dateWithTimeIntervalSince1970:0];
@@ -3035,12 +4891,8 @@ static const NSUInteger kASLocalIdChunk = 3500;
                 continue;
             }
 
-            if (asset.mediaType == PHAssetMediaTypeImage && !ASIsScreenshot(asset)) {
-                float score = [self blurScoreForAsset:asset];
-                if (score >= 0.f) {
-                    m.blurScore = score;
-                    [self updateBlurryTopKIncremental:m desiredK:desiredK];
-                }
+            if (asset.mediaType == PHAssetMediaTypeImage && !ASIsScreenshot(asset) && m.blurScore >= 0.f) {
+                [self updateBlurryTopKIncremental:m desiredK:desiredK];
             }
 
             if (ASIsScreenRecording(asset)) {
@@ -3066,13 +4918,9 @@ static const NSUInteger kASLocalIdChunk = 3500;
         }
     }
 
-    while (self.blurryPhotosM.count > desiredK) {
-        ASAssetModel *tail = self.blurryPhotosM.lastObject;
-        [self.blurryPhotosM removeLastObject];
-        if (self.blurryBytesRunning >= tail.fileSizeBytes) self.blurryBytesRunning -= tail.fileSizeBytes;
-        else self.blurryBytesRunning = 0;
-    }
-    self.snapshot.blurryCount = self.blurryPhotosM.count;
+    while (self.blurryTopK.count > desiredK) [self.blurryTopK popLeastBlurry];
+    self.blurryBytesRunning = self.blurryTopK.totalBytes;
+    self.snapshot.blurryCount = self.blurryTopK.count;
     self.snapshot.blurryBytes = self.blurryBytesRunning;
 
     return maxA;
@@ -3140,24 +4988,24 @@ static const NSUInteger kASLocalIdChunk = 3500;
     ];
     PHFetchResult<PHAsset *> *deltaFR = [PHAsset fetchAssetsWithOptions:opt];
 
-    NSMutableSet<NSString *> *cachedIds = [self as_collectCachedIdsFromCache];
-    NSMutableSet<NSString *> *deleted = [NSMutableSet set];
+    ASAssetIdSet *cachedIds = [self as_collectCachedIdsFromCache];
+    NSArray<NSString *> *deleted = @[];
 
     if (cachedIds.count > 0) {
-        NSMutableSet<NSString *> *existIds = [NSMutableSet setWithCapacity:cachedIds.count];
-        NSArray<NSString *> *allCached = cachedIds.allObjects;
+        ASAssetIdSet *existIds = [ASAssetIdSet new];
+        NSArray<NSString *> *allCached = [cachedIds allLocalIds];
 
         for (NSUInteger i = 0; i < allCached.count; i += kASLocalIdChunk) {
             NSRange r = NSMakeRange(i, MIN(kASLocalIdChunk, allCached.count - i));
             NSArray<NSString *> *slice = [allCached subarrayWithRange:r];
             PHFetchResult<PHAsset *> *existFR = [PHAsset fetchAssetsWithLocalIdentifiers:slice options:nil];
             for (PHAsset *a in existFR) {
-                if (a.localIdentifier.length) [existIds addObject:a.localIdentifier];
+                if (a.localIdentifier.length) [existIds addLocalId:a.localIdentifier];
             }
         }
 
-        [deleted unionSet:cachedIds];
-        [deleted minusSet:existIds];
+        [cachedIds minusSet:existIds];
+        deleted = [cachedIds allLocalIds];
     }
 
     ASIncLog(@"time-delta result | deltaFR=%lu deleted=%lu anchor=%@",
@@ -3175,7 +5023,7 @@ static const NSUInteger kASLocalIdChunk = 3500;
         if (a.localIdentifier.length) [deltaAssets addObject:a];
     }
 
-    [self incrementalRebuildWithInserted:deltaAssets removedIDs:deleted.allObjects];
+    [self incrementalRebuildWithInserted:deltaAssets removedIDs:deleted];
     [self refreshAllAssetsFetchResult];
 
     ASIncLog(@"delta path done | delta=%lu deleted=%lu current=%lu cached=%lu",
@@ -3187,53 +5035,49 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
 - (void)removeFromIndexByLocalId:(NSString *)localId {
     if (!localId.length) return;
-
-    void (^filterIndex)(NSMutableDictionary<NSNumber*, NSMutableArray<ASAssetModel*>*> *) =
-    ^(NSMutableDictionary *idx){
-        for (NSNumber *k in idx.allKeys) {
-            NSMutableArray *pool = idx[k];
-            NSIndexSet *rm = [pool indexesOfObjectsPassingTest:^BOOL(ASAssetModel *obj, NSUInteger i, BOOL *stop) {
-                return [obj.localId isEqualToString:localId];
-            }];
-            if (rm.count) [pool removeObjectsAtIndexes:rm];
-            if (pool.count == 0) [idx removeObjectForKey:k];
-        }
-    };
-
-    filterIndex(self.indexImage);
-    filterIndex(self.indexVideo);
+    [self.indexImage removeModelWithLocalId:localId];
+    [self.indexVideo removeModelWithLocalId:localId];
+    [self.crossDayImage removeModelWithLocalId:localId];
+    [self.crossDayVideo removeModelWithLocalId:localId];
 }
 
 - (void)removeModelByIdEverywhere:(NSString *)localId {
     if (!localId.length) return;
+    // removeModelsByIds 已经滤掉了 comparable 池
     [self removeModelsByIds:[NSSet setWithObject:localId]];
-
-    NSPredicate *keep = [NSPredicate predicateWithBlock:^BOOL(ASAssetModel *m, NSDictionary *_) {
-        return ![m.localId isEqualToString:localId];
-    }];
-
-    self.comparableImagesM = [[self.comparableImagesM filteredArrayUsingPredicate:keep] mutableCopy];
-    self.comparableVideosM = [[self.comparableVideosM filteredArrayUsingPredicate:keep] mutableCopy];
     [self removeFromIndexByLocalId:localId];
 }
 
 #pragma mark - Vision memo
 
-- (VNFeaturePrintObservation *)visionFeatureForLocalId:(NSString *)localId {
+- (NSData *)visionFeatureForLocalId:(NSString *)localId {
     if (!localId.length) return nil;
     
     if (@available(iOS 13.0, *)) {
-        VNFeaturePrintObservation *cached = [self.visionMemo objectForKey:localId];
+        NSData *cached = [self.visionMemo objectForKey:localId];
+        as_metrics_cache(AS_CACHE_VISION_MEMO, cached != nil);
         if (cached) return cached;
 
         PHFetchResult<PHAsset *> *fr = [PHAsset fetchAssetsWithLocalIdentifiers:@[localId] options:nil];
         PHAsset *asset = fr.firstObject;
         if (!asset) return nil;
 
+        int64_t modMs = ASFeatureModMs(asset.modificationDate, asset.creationDate);
+        NSData *stored = [self as_storedVisionFeatureForLocalId:localId modificationMs:modMs];
+        if (stored) {
+            [self.visionMemo setObject:stored forKey:localId];
+            return stored;
+        }
+
         @autoreleasepool {
-            UIImage *thumb = [self requestThumbnailSyncForAsset:asset target:CGSizeMake(512, 512)];
+            ASFeatureExtractor *fx = [ASFeatureExtractor shared];
+            UIImage *thumb = [fx recentThumbnailForLocalId:localId];
+            BOOL reused = (thumb != nil);
+            as_metrics_cache(AS_CACHE_THUMBNAIL, reused);
+            if (!thumb) thumb = [self requestThumbnailSyncForAsset:asset target:CGSizeMake(512, 512)];
             if (!thumb.CGImage) return nil;
 
+            double t0 = CACurrentMediaTime();
             VNGenerateImageFeaturePrintRequest *req = [VNGenerateImageFeaturePrintRequest new];
             
             if (@available(iOS 17.0, *)) {
@@ -3250,14 +5094,21 @@ static const NSUInteger kASLocalIdChunk = 3500;
                                                                                 orientation:ori
                                                                                     options:@{}];
             NSError *err = nil;
+            ASMetricInterval iv = as_metrics_begin(AS_STAGE_VISION);
             [handler performRequests:@[req] error:&err];
+            as_metrics_end(iv);
+            [fx recordVisionMs:(CACurrentMediaTime() - t0) * 1000.0 reusedThumbnail:reused];
             if (err) return nil;
 
             VNFeaturePrintObservation *obs = (VNFeaturePrintObservation *)req.results.firstObject;
             if (![obs isKindOfClass:[VNFeaturePrintObservation class]]) return nil;
 
-            [self.visionMemo setObject:obs forKey:localId];
-            return obs;
+            NSData *feature = ASAdoptFeaturePrint(self.visionArena, obs);
+            if (feature) {
+                [self.visionMemo setObject:feature forKey:localId];
+                [self as_storeVisionFeature:feature forLocalId:localId modificationMs:modMs];
+            }
+            return feature;
         }
     }
     return nil;
@@ -3267,7 +5118,15 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
 - (void)ensureVisionPrintDataForGroupMember:(ASAssetModel *)m assetIfAvailable:(PHAsset *)asset {
     if (!m) return;
-    if (m.visionPrintData.length > 0) return;
+    if (m.visionFeature.length > 0) return;
+    if (m.visionPrintData.length > 0 && [self as_upgradeArchivedVisionPrint:m]) return;
+
+    int64_t modMs = ASFeatureModMs(m.modificationDate, m.creationDate);
+    NSData *stored = [self as_storedVisionFeatureForLocalId:m.localId modificationMs:modMs];
+    if (stored) {
+        m.visionFeature = stored;
+        return;
+    }
 
     // 优先用传入的 asset（避免再 fetch）
     PHAsset *a = asset;
@@ -3278,16 +5137,40 @@ static const NSUInteger kASLocalIdChunk = 3500;
     if (!a) return;
 
     @autoreleasepool {
-        UIImage *thumb = [self requestThumbnailSyncForAsset:a target:CGSizeMake(512, 512)];
+        ASFeatureExtractor *fx = [ASFeatureExtractor shared];
+        UIImage *thumb = [fx recentThumbnailForLocalId:m.localId];
+        BOOL reused = (thumb != nil);
+        as_metrics_cache(AS_CACHE_THUMBNAIL, reused);
+        if (!thumb) thumb = [self requestThumbnailSyncForAsset:a target:CGSizeMake(512, 512)];
         if (!thumb.CGImage) return;
 
-        NSData *data = [self computeVisionPrintDataFromImage:thumb];
+        double t0 = CACurrentMediaTime();
+        ASMetricInterval iv = as_metrics_begin(AS_STAGE_VISION);
+        NSData *data = [self computeVisionFeatureFromImage:thumb];
+        as_metrics_end(iv);
+        [fx recordVisionMs:(CACurrentMediaTime() - t0) * 1000.0 reusedThumbnail:reused];
         if (data.length > 0) {
-            m.visionPrintData = data;
+            m.visionFeature = data;
+            [self as_storeVisionFeature:data forLocalId:m.localId modificationMs:modMs];
         }
     }
 }
 
+// 特征库里的 Vision 特征：搬进 arena，之后与新算的一样走批量距离
+- (nullable NSData *)as_storedVisionFeatureForLocalId:(NSString *)localId modificationMs:(int64_t)modMs {
+    if (!localId.length) return nil;
+    NSData *d = [self.featureStore featuresForLocalId:localId modificationMs:modMs includeFeature:YES].visionFeature;
+    if (d.length < sizeof(float)) return nil;
+    return [self.visionArena adoptFeature:(const float *)d.bytes count:(uint32_t)(d.length / sizeof(float))];
+}
+
+- (void)as_storeVisionFeature:(NSData *)feature forLocalId:(NSString *)localId modificationMs:(int64_t)modMs {
+    if (!localId.length || feature.length == 0) return;
+    ASStoredFeatures *f = [ASStoredFeatures new];
+    f.visionFeature = feature;
+    [self.featureStore storeFeatures:f forLocalId:localId modificationMs:modMs];
+}
+
 - (ASAssetModel *)buildModelForAsset:(PHAsset *)asset
                  computeCompareBits:(BOOL)computeCompareBits
                               error:(NSError **)err {
@@ -3298,33 +5181,96 @@ static const NSUInteger kASLocalIdChunk = 3500;
     m.creationDate = asset.creationDate;
     m.modificationDate = asset.modificationDate;
 
+    // 大小走共享的大小服务（自带持久化缓存，扫描开始时已在后台预取）
     m.fileSizeBytes = [self fetchFileSizeForAsset:asset];
+    if (!computeCompareBits) return m;
 
-    if (computeCompareBits && ASAllowedForCompare(asset)) {
-        @autoreleasepool {
-            UIImage *thumb = [self requestThumbnailSyncForAsset:asset target:CGSizeMake(512, 512)];
-            if (thumb) {
-                m.phash256Data = [self computeColorPHash256Data:thumb];
-                // 提前计算并缓存 Vision 数据，防止 matchAndGroup 时阻塞串行队列
-//                m.visionPrintData = [self computeVisionPrintDataFromImage:thumb];
+    // 资产没被编辑过：直接用特征库里的，只为缺的字段解码
+    int64_t modMs = ASFeatureModMs(asset.modificationDate, asset.creationDate);
+    ASStoredFeatures *stored = [self.featureStore featuresForLocalId:m.localId modificationMs:modMs includeFeature:NO];
+    as_metrics_cache(AS_CACHE_FEATURE_STORE, stored != nil);
+    ASStoredFeatures *fresh = [ASStoredFeatures new];
+
+    // 一次解码：pHash + 模糊度 + 曝光统计共用同一张 512 缩略图
+    ASFeatureMask mask = 0;
+    if (ASAllowedForCompare(asset)) {
+        if (stored.phash256Data) m.phash256Data = stored.phash256Data;
+        else mask |= ASFeatureMaskPHash;
+    }
+
+    NSString *blurKey = nil;
+    if (asset.mediaType == PHAssetMediaTypeImage && !ASIsScreenshot(asset)) {
+        blurKey = ASBlurCacheKeyForAsset(asset);
+        m.blurScore = -1.f;
+        if (stored.hasBlur) {
+            m.lumaMean = stored.lumaMean;
+            m.lumaStd = stored.lumaStd;
+            [ASBlurMemo() setObject:@(stored.blurScore) forKey:blurKey];
+        }
+        NSNumber *memo = [ASBlurMemo() objectForKey:blurKey];
+        as_metrics_cache(AS_CACHE_BLUR_MEMO, memo != nil);
+        if (memo) m.blurScore = memo.floatValue;
+        else mask |= ASFeatureMaskBlur;
+    }
+
+    // 视频：多帧指纹（一次 AVAssetReader 低分辨率解码）；取不到（如原片在 iCloud）时只用封面 pHash
+    if (asset.mediaType == PHAssetMediaTypeVideo && ASAllowedForCompare(asset)) {
+        NSData *vfp = stored.videoFingerprint;
+        if (as_vfp_valid(vfp.bytes, vfp.length)) {
+            m.videoFingerprint = vfp;
+        } else {
+            m.videoFingerprint = [[ASVideoFingerprinter shared] fingerprintForAsset:asset imageManager:self.imageManager];
+            fresh.videoFingerprint = m.videoFingerprint;
+        }
+    }
+
+    if (mask == 0) {
+        [self.featureStore storeFeatures:fresh forLocalId:m.localId modificationMs:modMs];
+        return m;
+    }
+
+    @autoreleasepool {
+        UIImage *thumb = [self requestThumbnailSyncForAsset:asset target:CGSizeMake(512, 512)];
+        if (thumb) {
+            ASFeatureExtractor *fx = [ASFeatureExtractor shared];
+            ASMetricInterval iv = as_metrics_begin(AS_STAGE_FEATURES);
+            ASImageFeatures *f = [fx extractFromImage:thumb features:mask];
+            as_metrics_end(iv);
+
+            if (mask & ASFeatureMaskPHash) {
+                m.phash256Data = f.phash256Data;
+                fresh.phash256Data = f.phash256Data;
+                // Vision 只在分组命中时才算，先留住缩略图避免再请求一次
+                [fx rememberThumbnail:thumb forLocalId:m.localId];
+            }
+            if (mask & ASFeatureMaskBlur) {
+                m.lumaMean = f.lumaMean;
+                m.lumaStd = f.lumaStd;
+                m.blurScore = f.blurScore;
+                [ASBlurMemo() setObject:@(f.blurScore) forKey:blurKey];
+                fresh.hasBlur = YES;
+                fresh.blurScore = f.blurScore;
+                fresh.lumaMean = f.lumaMean;
+                fresh.lumaStd = f.lumaStd;
             }
         }
     }
+    [self.featureStore storeFeatures:fresh forLocalId:m.localId modificationMs:modMs];
     return m;
 }
 
 - (uint64_t)fetchFileSizeForAsset:(PHAsset *)asset {
-    __block uint64_t size = 0;
-    NSArray *resources = [PHAssetResource assetResourcesForAsset:asset];
-    for (PHAssetResource *r in resources) {
-        NSNumber *s = [r valueForKey:@"fileSize"];
-        if ([s isKindOfClass:[NSNumber class]]) size += s.unsignedLongLongValue;
-    }
-    return size;
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_FILE_SIZE);
+    ASAssetSizeInfo *info = [[ASAssetSizeService shared] sizeInfoForAsset:asset];
+    as_metrics_end(iv);
+    as_metrics_cache(AS_CACHE_ASSET_SIZE, info.cached);
+    return info.totalBytes;
 }
 
 - (UIImage *)requestThumbnailSyncForAsset:(PHAsset *)asset target:(CGSize)target {
     __block UIImage *img = nil;
+    double t0 = CACurrentMediaTime();
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_THUMBNAIL);
 
         PHImageRequestOptions *opt = [PHImageRequestOptions new];
         opt.synchronous = YES;
@@ -3343,6 +5289,8 @@ static const NSUInteger kASLocalIdChunk = 3500;
             if (info[PHImageErrorKey]) return;
             img = result;
         }];
+        as_metrics_end(iv);
+        [[ASFeatureExtractor shared] recordThumbnailRequestMs:(CACurrentMediaTime() - t0) * 1000.0];
         return img;
 }
 
@@ -3382,142 +5330,12 @@ static const NSUInteger kASLocalIdChunk = 3500;
 
 static inline int ASHamming256(NSData *a, NSData *b) {
     if (a.length < 32 || b.length < 32) return INT_MAX;
-    const uint64_t *pa = (const uint64_t *)a.bytes;
-    const uint64_t *pb = (const uint64_t *)b.bytes;
-    int count = 0;
-    for (int i = 0; i < 4; i++) {
-        count += __builtin_popcountll(pa[i] ^ pb[i]);
-    }
-    return count;
-}
-
-static inline NSNumber *ASBucketKeyForPHash256(NSData *d) {
-    return @(0);
-}
-
-static int ASFloatCmp(const void *a, const void *b) {
-    float fa = *(const float *)a;
-    float fb = *(const float *)b;
-    return (fa > fb) - (fa < fb);
-}
-
-static const int kASDCTN = 64;
-static const int kASDCTSize = 64 * 64;
-
-static float *ASDCTCosTable(void) {
-    static float table[kASDCTSize];
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        const double N = (double)kASDCTN;
-        const double coef = M_PI / N;
-        for (int k = 0; k < kASDCTN; k++) {
-            for (int n = 0; n < kASDCTN; n++) {
-                table[k*kASDCTN + n] = (float)cos(coef * ((double)n + 0.5) * (double)k);
-            }
-        }
-    });
-    return table;
-}
-
-static inline void ASDCT1D_64(const float *in, float *out) {
-    const float *cosT = ASDCTCosTable();
-    for (int k = 0; k < 64; k++) {
-        const float *row = &cosT[k*64];
-        float sum = 0.f;
-        for (int n = 0; n < 64; n++) {
-            sum += in[n] * row[n];
-        }
-        out[k] = sum;
-    }
-}
-
-
-- (NSData *)computeColorPHash256Data:(UIImage *)image {
-    CGImageRef cg = image.CGImage;
-    if (!cg) { uint64_t z[4] = {0,0,0,0}; return [NSData dataWithBytes:z length:32]; }
-
-    const int width = 64, height = 64;
-    const int bytesPerRow = width * 4;
-
-    uint8_t pixels[64 * 64 * 4];
-    memset(pixels, 0, sizeof(pixels));
-
-    CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
-    CGContextRef ctx = CGBitmapContextCreate(
-        pixels, width, height, 8, bytesPerRow, cs,
-        (CGBitmapInfo)kCGImageAlphaPremultipliedLast
-    );
-    CGColorSpaceRelease(cs);
-
-    if (!ctx) { uint64_t z[4] = {0,0,0,0}; return [NSData dataWithBytes:z length:32]; }
-
-    CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), cg);
-    CGContextRelease(ctx);
-
-    for (int i = 0; i < width * height; i++) {
-        float r = (float)pixels[i*4 + 0];
-        float g = (float)pixels[i*4 + 1];
-        float b = (float)pixels[i*4 + 2];
-
-        float enhanced = 1.1f * (0.299f*r + 0.587f*g + 0.114f*b) - 10.f;
-        if (enhanced < 0.f) enhanced = 0.f;
-        if (enhanced > 255.f) enhanced = 255.f;
-
-        uint8_t e8 = (uint8_t)enhanced;
-
-        pixels[i*4 + 0] = e8;
-        pixels[i*4 + 1] = e8;
-        pixels[i*4 + 2] = e8;
-    }
-
-    float floatPixels[64 * 64];
-    for (int i = 0; i < width * height; i++) {
-        floatPixels[i] = (float)pixels[i*4 + 0];
-    }
-
-    float rowIn[64], rowOut[64];
-    for (int row = 0; row < 64; row++) {
-        memcpy(rowIn, &floatPixels[row * 64], sizeof(rowIn));
-        ASDCT1D_64(rowIn, rowOut);
-        memcpy(&floatPixels[row * 64], rowOut, sizeof(rowOut));
-    }
-
-    float colIn[64], colOut[64];
-    for (int col = 0; col < 64; col++) {
-        for (int row = 0; row < 64; row++) colIn[row] = floatPixels[row * 64 + col];
-        ASDCT1D_64(colIn, colOut);
-        for (int row = 0; row < 64; row++) floatPixels[row * 64 + col] = colOut[row];
-    }
-
-    float topLeft[16 * 16];
-    int idx = 0;
-    for (int r = 0; r < 16; r++) {
-        for (int c = 0; c < 16; c++) {
-            topLeft[idx++] = floatPixels[r * 64 + c];
-        }
-    }
-
-    float sorted[16 * 16];
-    memcpy(sorted, topLeft, sizeof(sorted));
-    qsort(sorted, 256, sizeof(float), ASFloatCmp);
-    float median = sorted[256 / 2];
-
-    uint64_t hash[4] = {0,0,0,0};
-    for (int i = 0; i < 256; i++) {
-        if (topLeft[i] > median) {
-            int word = i / 64;
-            int offset = 63 - (i % 64);
-            hash[word] |= (1ULL << (uint64_t)offset);
-        }
-    }
-
-    return [NSData dataWithBytes:hash length:32];
+    return (int)as_hamming256((const uint64_t *)a.bytes, (const uint64_t *)b.bytes);
 }
 
+#pragma mark - Vision FeaturePrint (raw float32, arena-backed)
 
-#pragma mark - Vision FeaturePrint (archived data for cache)
-
-- (NSData *)computeVisionPrintDataFromImage:(UIImage *)image {
+- (NSData *)computeVisionFeatureFromImage:(UIImage *)image {
     if (@available(iOS 13.0, *)) {
         CGImageRef cg = image.CGImage;
         if (!cg) return nil;
@@ -3543,8 +5361,7 @@ static inline void ASDCT1D_64(const float *in, float *out) {
         VNFeaturePrintObservation *obs = (VNFeaturePrintObservation *)req.results.firstObject;
         if (![obs isKindOfClass:[VNFeaturePrintObservation class]]) return nil;
 
-        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:obs requiringSecureCoding:YES error:nil];
-        return data;
+        return ASAdoptFeaturePrint(self.visionArena, obs);
     }
     return nil;
 }
@@ -3570,7 +5387,7 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     self.bigVideosM = [self.cache.bigVideos mutableCopy] ?: [NSMutableArray array];
     self.comparableImagesM = [self.cache.comparableImages mutableCopy] ?: [NSMutableArray array];
     self.comparableVideosM = [self.cache.comparableVideos mutableCopy] ?: [NSMutableArray array];
-    self.blurryPhotosM = [self.cache.blurryPhotos mutableCopy] ?: [NSMutableArray array];
+    self.blurryTopK = [[ASBlurryTopK alloc] initWithModels:self.cache.blurryPhotos];
     self.otherPhotosM  = [self.cache.otherPhotos mutableCopy] ?: [NSMutableArray array];
 
     [self removeModelsByIds:deleted];
@@ -3591,7 +5408,7 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     self.cache.bigVideos       = [self.bigVideosM copy];
     self.cache.comparableImages = [self.comparableImagesM copy];
     self.cache.comparableVideos = [self.comparableVideosM copy];
-    self.cache.blurryPhotos    = [self.blurryPhotosM copy];
+    self.cache.blurryPhotos    = [self.blurryTopK sortedModels];
     self.cache.otherPhotos     = [self.otherPhotosM copy];
 
     [self saveCacheAsync];
@@ -3603,41 +5420,120 @@ static inline void ASDCT1D_64(const float *in, float *out) {
 
 
 - (float)visionDistanceBetween:(ASAssetModel *)a and:(ASAssetModel *)b {
-    if (@available(iOS 13.0, *)) {
-        VNFeaturePrintObservation *oa = [self visionObsForModel:a];
-        VNFeaturePrintObservation *ob = [self visionObsForModel:b];
+    NSData *fa = [self visionFeatureForModel:a];
+    NSData *fb = [self visionFeatureForModel:b];
 
-        if (!oa) oa = [self visionFeatureForLocalId:a.localId];
-        if (!ob) ob = [self visionFeatureForLocalId:b.localId];
+    // 维度不同（不同 revision）时 computeDistance 同样会报错
+    if (!fa || !fb || fa.length != fb.length) return FLT_MAX;
+    return as_feature_l2(fa.bytes, fb.bytes, (uint32_t)(fa.length / sizeof(float)));
+}
 
-        if (!oa || !ob) return FLT_MAX;
+- (NSData *)visionFeatureForModel:(ASAssetModel *)m {
+    if (m.visionFeature.length > 0) return m.visionFeature;
 
-        float dist = 0.f;
-        NSError *err = nil;
-        [oa computeDistance:&dist toFeaturePrintObservation:ob error:&err];
-        return err ? FLT_MAX : dist;
-    }
-    return FLT_MAX;
+    // 旧缓存的归档数据：只解档这一次，之后就是原始向量
+    if (m.visionPrintData.length > 0 && [self as_upgradeArchivedVisionPrint:m]) return m.visionFeature;
+
+    // 只有当 Model 里没有数据时，才尝试去重新 fetch (兼容旧数据或异常情况)
+    return [self visionFeatureForLocalId:m.localId];
 }
 
-- (VNFeaturePrintObservation *)visionObsForModel:(ASAssetModel *)m {
-    // 1. 如果内存里有 Vision 数据（NSData），先解档
-    if (m.visionPrintData.length > 0) {
-        // 尝试检查 Cache 是否已经解档过
-        VNFeaturePrintObservation *cached = [self.visionMemo objectForKey:m.localId];
-        if (cached) return cached;
-        
-        NSError *error = nil;
-        VNFeaturePrintObservation *obs = [NSKeyedUnarchiver unarchivedObjectOfClass:[VNFeaturePrintObservation class] fromData:m.visionPrintData error:&error];
-        if (obs) {
-            // 存入 Memo 供后续对比使用，避免反复解档
-            [self.visionMemo setObject:obs forKey:m.localId];
-            return obs;
+- (BOOL)as_upgradeArchivedVisionPrint:(ASAssetModel *)m {
+    NSError *error = nil;
+    VNFeaturePrintObservation *obs = [NSKeyedUnarchiver unarchivedObjectOfClass:[VNFeaturePrintObservation class] fromData:m.visionPrintData error:&error];
+    NSData *feature = obs ? ASAdoptFeaturePrint(self.visionArena, obs) : nil;
+    if (!feature) return NO;
+    m.visionFeature = feature;
+    m.visionPrintData = nil;
+    return YES;
+}
+
+#pragma mark - Grouping window
+
+- (ASGroupingWindow)groupingWindow {
+    return (ASGroupingWindow)[[NSUserDefaults standardUserDefaults] integerForKey:kASGroupingWindowKey];
+}
+
+- (void)setGroupingWindow:(ASGroupingWindow)groupingWindow {
+    [[NSUserDefaults standardUserDefaults] setInteger:groupingWindow forKey:kASGroupingWindowKey];
+}
+
+// 图片/视频两个跨天池平分预算
+- (NSUInteger)as_crossDayPoolCapacity {
+    uint64_t half = self.groupingMemoryBudgetBytes / 2;
+    uint64_t table = as_phash_index_table_bytes();
+    uint64_t perEntry = as_phash_index_bytes_per_slot() + kASPoolObjCBytesPerEntry;
+    if (half <= table + perEntry * 256) return 256;
+    return (NSUInteger)((half - table) / perEntry);
+}
+
+// 每次扫描/重建开始时锁定窗口模式，扫描中途切换不生效
+- (void)as_prepareGroupingWindow {
+    self.activeGroupingWindow = self.groupingWindow;
+
+    NSUInteger cap = [self as_crossDayPoolCapacity];
+    self.crossDayImage.maxCount = cap;
+    self.crossDayVideo.maxCount = cap;
+
+    [self.crossDayImage removeAllObjects];
+    [self.crossDayVideo removeAllObjects];
+    [self.dayModelsImage removeAllObjects];
+    [self.dayModelsVideo removeAllObjects];
+}
+
+- (void)as_reseedCrossDayPools {
+    [self.crossDayImage removeAllObjects];
+    [self.crossDayVideo removeAllObjects];
+    if (self.activeGroupingWindow != ASGroupingWindowGlobal) return;
+
+    for (ASAssetModel *m in self.comparableImagesM) [self.crossDayImage addModel:m];
+    for (ASAssetModel *m in self.comparableVideosM) [self.crossDayVideo addModel:m];
+}
+
+- (void)as_clearDayPools {
+    [self.indexImage removeAllObjects];
+    [self.indexVideo removeAllObjects];
+    [self.dayModelsImage removeAllObjects];
+    [self.dayModelsVideo removeAllObjects];
+}
+
+// 换天：Day 模式直接清空；Global 模式把相邻一天午夜后的一小段带入新池（跨午夜连拍）
+// 只带午夜附近的：r=119 很宽，整天带入会让送 Vision 的候选翻倍
+- (void)as_rollDayPoolsToDay:(NSDate *)day {
+    NSDate *prev = self.currentDay;
+    self.currentDay = day;
+    if (prev) [self as_noteDayClosed:prev];
+
+    BOOL carry = (self.activeGroupingWindow == ASGroupingWindowGlobal) && prev && day &&
+                 fabs([prev timeIntervalSinceDate:day]) <= kASAdjacentDaySpan;
+    NSMutableArray<ASAssetModel *> *carryImg = [NSMutableArray array];
+    NSMutableArray<ASAssetModel *> *carryVid = [NSMutableArray array];
+    if (carry) {
+        // 倒序扫描：prev 是较新的一天，它的 dayStart 就是两天之间的午夜
+        for (ASAssetModel *m in self.dayModelsImage) {
+            if (m.creationDate && [m.creationDate timeIntervalSinceDate:prev] <= kASMidnightCarrySpan) [carryImg addObject:m];
+        }
+        for (ASAssetModel *m in self.dayModelsVideo) {
+            if (m.creationDate && [m.creationDate timeIntervalSinceDate:prev] <= kASMidnightCarrySpan) [carryVid addObject:m];
         }
     }
-    
-    // 2. 只有当 Model 里没有数据时，才尝试去重新 fetch (兼容旧数据或异常情况)
-    return [self visionFeatureForLocalId:m.localId];
+
+    [self as_clearDayPools];
+
+    for (ASAssetModel *m in carryImg) [self.indexImage addModel:m];
+    for (ASAssetModel *m in carryVid) [self.indexVideo addModel:m];
+}
+
+- (void)as_addModelToDayPool:(ASAssetModel *)m isImage:(BOOL)isImage {
+    [(isImage ? self.indexImage : self.indexVideo) addModel:m];
+    [(isImage ? self.dayModelsImage : self.dayModelsVideo) addObject:m];
+}
+
+- (void)as_addModelToGroupingPools:(ASAssetModel *)m isImage:(BOOL)isImage {
+    [self as_addModelToDayPool:m isImage:isImage];
+    if (self.activeGroupingWindow == ASGroupingWindowGlobal) {
+        [(isImage ? self.crossDayImage : self.crossDayVideo) addModel:m];
+    }
 }
 
 #pragma mark - Grouping
@@ -3646,95 +5542,193 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     if (!model.phash256Data || model.phash256Data.length < 32) return NO;
 
     BOOL isImage = (asset.mediaType == PHAssetMediaTypeImage);
-    NSMutableDictionary<NSNumber *, NSMutableArray<ASAssetModel *> *> *index = isImage ? self.indexImage : self.indexVideo;
+    BOOL videoFP = !isImage && model.videoFingerprint.length > 0;
+    ASPHashPool *pool = isImage ? self.indexImage : self.indexVideo;
+
+    // 只取 hamming <= 相似阈值的候选送 Vision；r=119 下多索引不划算，当天池本身是连续内存上的 popcount 扫描
+    NSArray<ASAssetModel *> *candidates = [pool candidatesForHash:model.phash256Data
+                                                           radius:kPolicySimilar.phashThreshold];
+
+    // 有多帧指纹的视频：截取的副本封面可能完全不同，当天的视频全部作为候选（每天视频很少）
+    if (videoFP && self.dayModelsVideo.count > candidates.count) {
+        NSMutableOrderedSet<ASAssetModel *> *merged = [NSMutableOrderedSet orderedSetWithArray:candidates];
+        [merged addObjectsFromArray:self.dayModelsVideo];
+        candidates = merged.array;
+    }
+
+    // Global 窗口：再按重复阈值查跨天池（半径小，走多索引，不随库大小线性增长）
+    if (self.activeGroupingWindow == ASGroupingWindowGlobal) {
+        ASPHashPool *cross = isImage ? self.crossDayImage : self.crossDayVideo;
+        NSArray<ASAssetModel *> *far = [cross candidatesForHash:model.phash256Data
+                                                         radius:kPolicyDuplicate.phashThreshold];
+        if (far.count) {
+            NSMutableOrderedSet<ASAssetModel *> *merged = [NSMutableOrderedSet orderedSetWithArray:candidates];
+            [merged addObjectsFromArray:far];
+            candidates = merged.array;
+        }
+    }
 
-    NSNumber *k = ASBucketKeyForPHash256(model.phash256Data);
-    NSMutableArray<ASAssetModel *> *pool = index[k];
-    if (!pool) { pool = [NSMutableArray array]; index[k] = pool; }
+    ASAssetGroupIndex *groups = [self as_liveGroupIndex];
+    BOOL grouped = NO;
 
-    ASAssetModel *hit = nil;
-    BOOL hitIsDup = NO;
+    // 已有特征的候选一次批量算完距离；没有特征的在循环里按需生成（可能被「已同组」跳过，省一次 Vision）
+    NSUInteger nc = candidates.count;
+    float *batchDist = NULL;
+    if (nc > 0 && !videoFP) {
+        [self ensureVisionPrintDataForGroupMember:model assetIfAvailable:asset];
+        NSData *mf = [self visionFeatureForModel:model];
+        if (mf.length) {
+            batchDist = malloc(nc * sizeof(float));
+            const float **rows = malloc(nc * sizeof(float *));
+            uint32_t *at = malloc(nc * sizeof(uint32_t));
+            uint32_t n = 0;
+            for (NSUInteger i = 0; i < nc; i++) {
+                batchDist[i] = NAN;
+                ASAssetModel *cand = candidates[i];
+                if (cand.visionFeature.length == mf.length) { rows[n] = cand.visionFeature.bytes; at[n++] = (uint32_t)i; }
+            }
+            float *out = malloc(MAX(n, 1u) * sizeof(float));
+            as_feature_l2_batch(mf.bytes, rows, n, (uint32_t)(mf.length / sizeof(float)), out);
+            for (uint32_t k = 0; k < n; k++) batchDist[at[k]] = out[k];
+            free(out);
+            free(at);
+            free(rows);
+        }
+    }
 
-    ASGroupType simType = isImage ? ASGroupTypeSimilarImage : ASGroupTypeSimilarVideo;
-    ASGroupType dupType = isImage ? ASGroupTypeDuplicateImage : ASGroupTypeDuplicateVideo;
+    // 命中多个组的候选时把这些组合并；已同重复组的候选不必再比，
+    // 只同相似组的（经第三张连起来，如连拍）仍要判重复边
+    for (NSUInteger ci = 0; ci < nc; ci++) {
+        ASAssetModel *cand = candidates[ci];
+        if (cand == model || [cand.localId isEqualToString:model.localId]) continue;
+        ASPairNeed need = grouped ? [groups needForModel:cand with:model] : AS_PAIR_FULL;
+        if (need == AS_PAIR_SKIP) continue;
+
+        BOOL duplicate;
+        if (videoFP && cand.videoFingerprint.length) {
+            // 两边都有多帧指纹：按时间对齐比较，不看封面 / Vision
+            float dist = 0, overlap = 0, ratio = 0;
+            if (![ASVideoFingerprinter matchFingerprint:model.videoFingerprint with:cand.videoFingerprint
+                                               distance:&dist overlap:&overlap durationRatio:&ratio]) continue;
+            if (dist > kASVideoSimilarDistance || overlap < kASVideoSimilarOverlap) continue;
+            duplicate = dist <= kASVideoDuplicateDistance && overlap >= kASVideoDuplicateOverlap &&
+                        ratio >= kASVideoDuplicateDuration;
+        } else {
+            int hd = ASHamming256(model.phash256Data, cand.phash256Data);
+            if (hd > kPolicySimilar.phashThreshold) continue;  // 当天视频全集带进来的远候选
+            if (need == AS_PAIR_DUPLICATE_ONLY && hd > kPolicyDuplicate.phashThreshold) continue;  // 已同相似组，成不了重复
+
+            float vd = batchDist ? batchDist[ci] : NAN;
+            if (isnan(vd)) {
+                [self ensureVisionPrintDataForGroupMember:cand assetIfAvailable:nil];
+                vd = [self visionDistanceBetween:model and:cand];
+            }
+            if (vd == FLT_MAX) continue;
+            if (vd > kPolicySimilar.visionThreshold) continue;
+            duplicate = hd <= kPolicyDuplicate.phashThreshold && vd <= kPolicyDuplicate.visionThreshold;
+        }
 
-    for (ASAssetModel *cand in pool) {
-        if ([cand.localId isEqualToString:model.localId]) continue;
-        if (!cand.phash256Data || cand.phash256Data.length < 32) continue;
+        // 相似组
+        if ([groups unionModel:cand with:model duplicate:NO]) [self as_journalUnion:cand with:model duplicate:NO];
 
-        int hd = ASHamming256(model.phash256Data, cand.phash256Data);
-        if (hd > kPolicySimilar.phashThreshold) continue;
-        
-        [self ensureVisionPrintDataForGroupMember:cand assetIfAvailable:nil];
-        [self ensureVisionPrintDataForGroupMember:model assetIfAvailable:asset];
+        // 重复组
+        if (duplicate) {
+            if ([groups unionModel:cand with:model duplicate:YES]) [self as_journalUnion:cand with:model duplicate:YES];
+        }
+        grouped = YES;
+    }
 
-        float vd = [self visionDistanceBetween:model and:cand];
-        if (vd == FLT_MAX) continue;
-        if (vd > kPolicySimilar.visionThreshold) continue;
+    free(batchDist);
 
-        hit = cand;
-        hitIsDup = (hd <= kPolicyDuplicate.phashThreshold && vd <= kPolicyDuplicate.visionThreshold);
-        break;
-    }
+    [self as_addModelToGroupingPools:model isImage:isImage];
+    return grouped; // NO = 未命中，不在任何组
+}
 
-    if (!hit) {
-        [pool addObject:model];
-        return NO; // 未命中，不在任何组
-    }
+#pragma mark - Group index
 
-    // 相似组
-    if (![self appendModel:model toExistingGroupByAnyMemberId:hit.localId groupType:simType]) {
-        ASAssetGroup *g = [ASAssetGroup new];
-        g.type = simType;
-        g.assets = [NSMutableArray arrayWithObjects:hit, model, nil];
-        [self.simGroupsM addObject:g];
+@synthesize dupGroupsM = _dupGroupsM;
+@synthesize simGroupsM = _simGroupsM;
+
+// 扫描期间的分组索引；没有时按当前数组建一个
+- (ASAssetGroupIndex *)as_liveGroupIndex {
+    if (!self.groupIndex) {
+        self.groupIndex = [[ASAssetGroupIndex alloc] initWithDuplicateGroups:_dupGroupsM ?: @[]
+                                                               similarGroups:_simGroupsM ?: @[]];
     }
+    return self.groupIndex;
+}
 
-    // 重复组
-    if (hitIsDup) {
-        if (![self appendModel:model toExistingGroupByAnyMemberId:hit.localId groupType:dupType]) {
-            ASAssetGroup *g2 = [ASAssetGroup new];
-            g2.type = dupType;
-            g2.assets = [NSMutableArray arrayWithObjects:hit, model, nil];
-            [self.dupGroupsM addObject:g2];
-        }
+// 把索引物化回可变数组并丢弃索引；之后对数组的任何修改都不再是「只有合并」，日志需要整库重写
+- (void)as_flushGroupIndex {
+    if (self.groupIndex) {
+        _dupGroupsM = [[self.groupIndex groupsDuplicate:YES] mutableCopy];
+        _simGroupsM = [[self.groupIndex groupsDuplicate:NO] mutableCopy];
+        self.groupIndex = nil;
     }
+    if (self.journalActive) self.journalNeedsBase = YES;
+}
 
-    [pool addObject:model];
-    return YES;
+- (NSMutableArray<ASAssetGroup *> *)dupGroupsM {
+    [self as_flushGroupIndex];
+    return _dupGroupsM;
 }
 
-- (BOOL)appendModel:(ASAssetModel *)model toExistingGroupByAnyMemberId:(NSString *)memberId groupType:(ASGroupType)type {
-    NSArray<ASAssetGroup *> *targets = (type==ASGroupTypeDuplicateImage || type==ASGroupTypeDuplicateVideo) ? self.dupGroupsM : self.simGroupsM;
-    for (ASAssetGroup *g in targets) {
-        if (g.type != type) continue;
-        for (ASAssetModel *m in g.assets) {
-            if ([m.localId isEqualToString:memberId]) {
-                [g.assets addObject:model];
-                return YES;
-            }
-        }
-    }
-    return NO;
+- (NSMutableArray<ASAssetGroup *> *)simGroupsM {
+    [self as_flushGroupIndex];
+    return _simGroupsM;
+}
+
+- (void)setDupGroupsM:(NSMutableArray<ASAssetGroup *> *)groups {
+    [self as_flushGroupIndex];
+    _dupGroupsM = groups;
+}
+
+- (void)setSimGroupsM:(NSMutableArray<ASAssetGroup *> *)groups {
+    [self as_flushGroupIndex];
+    _simGroupsM = groups;
+}
+
+// 只读快照：不丢弃索引（进度回调 / checkpoint 用），调用方不要修改
+- (NSArray<ASAssetGroup *> *)as_groupsSnapshotDuplicate:(BOOL)duplicate {
+    if (self.groupIndex) return [self.groupIndex groupsDuplicate:duplicate];
+    return [(duplicate ? _dupGroupsM : _simGroupsM) copy];
+}
+
+- (void)as_journalUnion:(ASAssetModel *)a with:(ASAssetModel *)b duplicate:(BOOL)duplicate {
+    if (!self.journalActive) return;
+    NSMutableArray<ASAssetModel *> *pairs = duplicate ? self.journalDupUnions : self.journalSimUnions;
+    [pairs addObject:a];
+    [pairs addObject:b];
 }
 
 #pragma mark - Cleanable stats
 
 - (void)recomputeCleanableStatsFast {
+    ASAssetGroupIndex *groups = self.groupIndex;
+    if (groups) {
+        self.snapshot.cleanableBytes = groups.cleanableBytes;
+        self.snapshot.cleanableCount = groups.cleanableCount;
+        self.snapshot.duplicateGroupCount = groups.duplicateGroupCount;
+        self.snapshot.similarGroupCount = groups.similarGroupCount;
+        self.snapshot.lastUpdated = [NSDate date];
+        return;
+    }
+
+    // 没有索引时数组就是最新的，直接读 ivar（不触发物化）
     uint64_t bytes = 0;
     NSUInteger count = 0;
 
-    for (ASAssetGroup *g in self.dupGroupsM) {
+    for (ASAssetGroup *g in _dupGroupsM) {
         for (NSInteger i=1; i<g.assets.count; i++) { bytes += g.assets[i].fileSizeBytes; count += 1; }
     }
-    for (ASAssetGroup *g in self.simGroupsM) {
+    for (ASAssetGroup *g in _simGroupsM) {
         for (NSInteger i=1; i<g.assets.count; i++) { bytes += g.assets[i].fileSizeBytes; count += 1; }
     }
 
     self.snapshot.cleanableBytes = bytes;
     self.snapshot.cleanableCount = count;
-    self.snapshot.duplicateGroupCount = self.dupGroupsM.count;
-    self.snapshot.similarGroupCount = self.simGroupsM.count;
+    self.snapshot.duplicateGroupCount = _dupGroupsM.count;
+    self.snapshot.similarGroupCount = _simGroupsM.count;
     self.snapshot.lastUpdated = [NSDate date];
 }
 
@@ -3742,15 +5736,12 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     ASScanSnapshot *s = [ASScanSnapshot new];
     s.state = ASScanStateFinished;
 
-    NSMutableSet<NSString *> *ids = [NSMutableSet set];
+    ASAssetIdSet *ids = [ASAssetIdSet new];
     __block uint64_t scannedBytes = 0;
 
     void (^addArr)(NSArray<ASAssetModel *> *) = ^(NSArray<ASAssetModel *> *arr){
-        for (ASAssetModel *m in (arr ?: @[])) {
-            if (!m.localId.length) continue;
-            if ([ids containsObject:m.localId]) continue;
-            [ids addObject:m.localId];
-            scannedBytes += m.fileSizeBytes;
+        for (ASAssetModel *m in arr) {
+            if ([ids addModel:m]) scannedBytes += m.fileSizeBytes;
         }
     };
 
@@ -3771,8 +5762,8 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     s.bigVideoCount = self.bigVideosM.count;
     for (ASAssetModel *m in self.bigVideosM) s.bigVideoBytes += m.fileSizeBytes;
 
-    s.blurryCount = self.blurryPhotosM.count;
-    for (ASAssetModel *m in self.blurryPhotosM) s.blurryBytes += m.fileSizeBytes;
+    s.blurryCount = self.blurryTopK.count;
+    s.blurryBytes = self.blurryTopK.totalBytes;
 
     s.otherCount = self.otherPhotosM.count;
     for (ASAssetModel *m in self.otherPhotosM) s.otherBytes += m.fileSizeBytes;
@@ -3796,12 +5787,17 @@ static inline void ASDCT1D_64(const float *in, float *out) {
 }
 
 - (void)removeModelsByIds:(NSSet<NSString *> *)ids {
+    [self.featureStore removeLocalIds:ids.allObjects];
+    [[ASAssetSizeService shared] removeLocalIds:ids.allObjects];
+
+    // 每个容器逐个 model 判一次：行号查位图，不再对 localId 求哈希 / 比字符串
+    ASAssetIdSet *gone = [[ASAssetIdSet alloc] initWithLocalIds:ids];
     NSArray *(^filterGroups)(NSArray<ASAssetGroup *> *) = ^NSArray *(NSArray<ASAssetGroup *> *groups){
         NSMutableArray *out = [NSMutableArray array];
         for (ASAssetGroup *g in groups) {
             NSMutableArray *kept = [NSMutableArray array];
             for (ASAssetModel *m in g.assets) {
-                if (![ids containsObject:m.localId]) [kept addObject:m];
+                if (![gone containsModel:m]) [kept addObject:m];
             }
             if (kept.count >= 2) {
                 g.assets = kept;
@@ -3815,7 +5811,7 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     self.simGroupsM = [[filterGroups(self.simGroupsM) mutableCopy] ?: [NSMutableArray array] mutableCopy];
 
     NSPredicate *keep = [NSPredicate predicateWithBlock:^BOOL(ASAssetModel *m, NSDictionary *_) {
-        return ![ids containsObject:m.localId];
+        return ![gone containsModel:m];
     }];
 
     self.comparableImagesM = [[self.comparableImagesM filteredArrayUsingPredicate:keep] mutableCopy];
@@ -3824,7 +5820,7 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     self.screenshotsM = [[self.screenshotsM filteredArrayUsingPredicate:keep] mutableCopy];
     self.screenRecordingsM = [[self.screenRecordingsM filteredArrayUsingPredicate:keep] mutableCopy];
     self.bigVideosM = [[self.bigVideosM filteredArrayUsingPredicate:keep] mutableCopy];
-    self.blurryPhotosM = [[self.blurryPhotosM filteredArrayUsingPredicate:keep] mutableCopy];
+    [self.blurryTopK removeModelsPassingTest:^BOOL(ASAssetModel *m) { return [gone containsModel:m]; }];
     self.otherPhotosM  = [[self.otherPhotosM  filteredArrayUsingPredicate:keep] mutableCopy];
 }
 
@@ -3845,17 +5841,10 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     [self.indexImage removeAllObjects];
     [self.indexVideo removeAllObjects];
 
-    void (^addModelToIndex)(ASAssetModel *, NSMutableDictionary<NSNumber*, NSMutableArray<ASAssetModel*>*> *) =
-    ^(ASAssetModel *m, NSMutableDictionary *index) {
-        if (!m.phash256Data || m.phash256Data.length < 32) return;
-        NSNumber *k = ASBucketKeyForPHash256(m.phash256Data);
-        NSMutableArray *pool = index[k];
-        if (!pool) { pool = [NSMutableArray array]; index[k] = pool; }
-        [pool addObject:m];
-    };
+    for (ASAssetModel *m in self.comparableImagesM) [self.indexImage addModel:m];
+    for (ASAssetModel *m in self.comparableVideosM) [self.indexVideo addModel:m];
 
-    for (ASAssetModel *m in self.comparableImagesM) addModelToIndex(m, self.indexImage);
-    for (ASAssetModel *m in self.comparableVideosM) addModelToIndex(m, self.indexVideo);
+    [self as_reseedCrossDayPools];
 }
 
 #pragma mark - Cache Path
@@ -3865,8 +5854,9 @@ static inline void ASDCT1D_64(const float *in, float *out) {
 }
 
 - (void)dropCacheFile {
-    NSString *path = ASCachePath();
-    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:ASCachePath() error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:ASLegacyCachePath() error:nil];
+    [self.journal truncate];
 }
 
 #pragma mark - Cache Validate / Normalize
@@ -3912,34 +5902,34 @@ static inline void ASDCT1D_64(const float *in, float *out) {
         return YES;
     }
     NSString *path = ASCachePath();
-    NSDictionary *attr = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
-    NSLog(@"[CACHE] load path=%@ size=%llu", path, [attr[NSFileSize] unsignedLongLongValue]);
-    NSData *data = [NSData dataWithContentsOfFile:path options:0 error:nil];
-    if (data.length == 0) return NO;
+    CFTimeInterval t0 = CACurrentMediaTime();
+    BOOL migrated = NO;
 
-    NSError *err = nil;
+    // v4：映射读取，按需分页
     ASScanCache *obj = nil;
-
-    if (@available(iOS 11.0, *)) {
-        NSSet *classes = [NSSet setWithArray:@[
-            NSArray.class, NSMutableArray.class,
-            NSDictionary.class, NSMutableDictionary.class,
-            NSString.class, NSNumber.class, NSDate.class, NSData.class,
-            ASScanSnapshot.class,
-            ASAssetModel.class,
-            ASAssetGroup.class,
-            ASScanCache.class
-        ]];
-        obj = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:data error:&err];
+    BOOL replayComplete = YES;
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (data.length > 0) {
+        obj = ASDecodeScanCacheV4(data);
+        if (obj) {
+            // 扫描中断过：base 之后的 checkpoint 在日志里
+            CFTimeInterval r0 = CACurrentMediaTime();
+            NSUInteger frames = ASReplayScanJournal(obj, self.journal, &replayComplete);
+            if (frames) {
+                double ms = (CACurrentMediaTime() - r0) * 1000.0;
+                [self.journal recordReplayedFrames:frames ms:ms];
+                NSLog(@"[CACHE] journal replay frames=%lu seq=%lu ms=%.1f",
+                      (unsigned long)frames, (unsigned long)obj.journalSeq, ms);
+            }
+        }
     } else {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-        @try { obj = [NSKeyedUnarchiver unarchiveObjectWithData:data]; }
-        @catch (__unused NSException *e) { obj = nil; }
-#pragma clang diagnostic pop
+        obj = [self loadLegacyKeyedArchiveCache];
+        migrated = (obj != nil);
     }
+    NSLog(@"[CACHE] load path=%@ size=%lu ms=%.1f legacy=%d",
+          path, (unsigned long)data.length, (CACurrentMediaTime() - t0) * 1000.0, (int)migrated);
 
-    if (!obj || err) {
+    if (!obj) {
         [self dropCacheFile];
         return NO;
     }
@@ -3965,9 +5955,47 @@ static inline void ASDCT1D_64(const float *in, float *out) {
     }
 
     self.didLoadCacheFromDisk = YES;
+
+    // 旧格式迁移：立即写一份 v4，写成功后 saveCache 会删掉 v3
+    if (migrated) [self saveCacheAsync];
+    // 日志在缺帧 / 坏帧处停下：按已重放的结果重写 base 并丢掉日志，后面那些帧不能再被接上
+    if (!replayComplete) {
+        NSLog(@"[CACHE] journal replay stopped early at seq=%lu, rebasing", (unsigned long)obj.journalSeq);
+        dispatch_async(self.workQ, ^{ self.journalNeedsBase = YES; });
+        [self as_saveCacheAsyncDroppingJournal];
+    }
     return YES;
 }
 
+// v3 NSKeyedArchiver 缓存：只读，迁移用
+- (nullable ASScanCache *)loadLegacyKeyedArchiveCache {
+    NSData *data = [NSData dataWithContentsOfFile:ASLegacyCachePath() options:0 error:nil];
+    if (data.length == 0) return nil;
+
+    NSError *err = nil;
+    ASScanCache *obj = nil;
+
+    if (@available(iOS 11.0, *)) {
+        NSSet *classes = [NSSet setWithArray:@[
+            NSArray.class, NSMutableArray.class,
+            NSDictionary.class, NSMutableDictionary.class,
+            NSString.class, NSNumber.class, NSDate.class, NSData.class,
+            ASScanSnapshot.class,
+            ASAssetModel.class,
+            ASAssetGroup.class,
+            ASScanCache.class
+        ]];
+        obj = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:data error:&err];
+    } else {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+        @try { obj = [NSKeyedUnarchiver unarchiveObjectWithData:data]; }
+        @catch (__unused NSException *e) { obj = nil; }
+#pragma clang diagnostic pop
+    }
+    return (obj && !err) ? obj : nil;
+}
+
 - (void)saveCacheAsync {
     dispatch_async(self.ioQ, ^{
         [self saveCache];
@@ -3975,29 +6003,57 @@ static inline void ASDCT1D_64(const float *in, float *out) {
 }
 
 - (BOOL)cacheFileExists {
-    NSString *path = ASCachePath();
-    NSDictionary *attr = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
-    unsigned long long sz = [attr[NSFileSize] unsignedLongLongValue];
-    return (sz > 0);
+    for (NSString *path in @[ASCachePath(), ASLegacyCachePath()]) {
+        NSDictionary *attr = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+        if ([attr[NSFileSize] unsignedLongLongValue] > 0) return YES;
+    }
+    return NO;
+}
+
+// base 写完之后日志里的帧都已并入，可以删掉
+- (void)as_saveCacheAsyncDroppingJournal {
+    ASScanCache *c = self.cache;
+    ASScanJournal *journal = self.journal;
+    dispatch_async(self.ioQ, ^{
+        if ([self as_writeBaseCache:c]) [journal truncate];
+        [self.featureStore flush];
+    });
 }
 
 - (void)saveCache {
-    NSError *err = nil;
-    NSData *d = [NSKeyedArchiver archivedDataWithRootObject:self.cache requiringSecureCoding:YES error:&err];
-    NSLog(@"[CACHE] archive bytes=%lu err=%@", (unsigned long)d.length, err);
+    [self as_writeBaseCache:self.cache];
+    [self.featureStore flush];
+    [[ASAssetSizeService shared] flush];
+}
+
+- (BOOL)as_writeBaseCache:(ASScanCache *)cache {
+    CFTimeInterval t0 = CACurrentMediaTime();
+    NSData *d = ASEncodeScanCacheV4(cache);
+    NSLog(@"[CACHE] encode bytes=%lu ms=%.1f", (unsigned long)d.length, (CACurrentMediaTime() - t0) * 1000.0);
 
-    if (!d || err || d.length == 0) return;
+    if (d.length == 0) return NO;
+
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_CHECKPOINT_WRITE);
 
     NSString *path = ASCachePath();
     BOOL ok = [d writeToFile:path atomically:YES];
+    as_metrics_end(iv);
     NSLog(@"[CACHE] write path=%@ ok=%d", path, (int)ok);
-    if (!ok) return;
+    if (!ok) return NO;
+
+    self.lastBaseBytes = d.length;
+    as_metrics_add(AS_COUNTER_CHECKPOINT_BASE_BYTES, d.length);
+    [self.journal recordBaseWriteBytes:d.length ms:(CACurrentMediaTime() - t0) * 1000.0];
+
+    // 已写成 v4，旧格式不再需要
+    [[NSFileManager defaultManager] removeItemAtPath:ASLegacyCachePath() error:nil];
 
     NSError *pe = nil;
     [[NSFileManager defaultManager] setAttributes:@{NSFileProtectionKey: NSFileProtectionCompleteUntilFirstUserAuthentication}
                                      ofItemAtPath:path
                                             error:&pe];
     NSLog(@"[CACHE] protect err=%@", pe);
+    return YES;
 }
 
 - (void)applyCacheToPublicStateWithCompletion:(dispatch_block_t)completion {
@@ -4051,28 +6107,38 @@ static inline void ASDCT1D_64(const float *in, float *out) {
 - (void)emitProgress {
     self.snapshot.lastUpdated = [NSDate date];
 
-    NSArray<ASAssetGroup *> *dupCopy = [self.dupGroupsM copy] ?: self.cache.duplicateGroups ?: @[];
-    NSArray<ASAssetGroup *> *simCopy = [self.simGroupsM copy] ?: self.cache.similarGroups ?: @[];
+    NSArray<ASAssetGroup *> *dupCopy = [self as_groupsSnapshotDuplicate:YES] ?: self.cache.duplicateGroups ?: @[];
+    NSArray<ASAssetGroup *> *simCopy = [self as_groupsSnapshotDuplicate:NO] ?: self.cache.similarGroups ?: @[];
     NSArray<ASAssetModel *> *shotCopy = [self.screenshotsM copy] ?: self.cache.screenshots ?: @[];
     NSArray<ASAssetModel *> *recCopy  = [self.screenRecordingsM copy] ?: self.cache.screenRecordings ?: @[];
     NSArray<ASAssetModel *> *bigCopy  = [self.bigVideosM copy] ?: self.cache.bigVideos ?: @[];
 
     ASScanSnapshot *snap = self.snapshot;
 
-    NSArray<ASAssetModel *> *blurryCopy = [self.blurryPhotosM copy] ?: self.cache.blurryPhotos ?: @[];
+    NSArray<ASAssetModel *> *blurryCopy = self.blurryTopK ? [self.blurryTopK sortedModels] : (self.cache.blurryPhotos ?: @[]);
     NSArray<ASAssetModel *> *otherCopy  = [self.otherPhotosM copy]  ?: self.cache.otherPhotos  ?: @[];
+
+    ASProgressPublish *p = [ASProgressPublish new];
+    p.snapshot = snap;
+    p.dup = dupCopy; p.sim = simCopy;
+    p.simMerged = [self mergedSimilarGroupsForUIFromDup:dupCopy sim:simCopy];
+    p.groupStore = [[ASGroupStore alloc] initWithDuplicateGroups:p.dup similarGroups:p.simMerged];
+    p.shots = shotCopy; p.recs = recCopy; p.bigs = bigCopy;
+    p.blurry = blurryCopy; p.other = otherCopy;
+    p.dirty = self.progressDirtyModules;
+    self.progressDirtyModules = 0;
+
+    // 主线程按屏幕刷新合并：一帧内多次进度只发布最后一份
     dispatch_async(dispatch_get_main_queue(), ^{
-        self.duplicateGroups = dupCopy;
-        self.similarGroups = [self mergedSimilarGroupsForUIFromDup:dupCopy sim:simCopy];
-        self.screenshots = shotCopy;
-        self.screenRecordings = recCopy;
-        self.bigVideos = bigCopy;
-        self.blurryPhotos = blurryCopy;
-        self.otherPhotos  = otherCopy;
-
-        [self notifyProgressObserversOnMain:snap];
+        [self as_enqueuePublish:p];
     });
+}
 
+// 组成员变化（加入已有组）在快照计数里看不出是哪一类组：按媒体类型标记（workQ）
+- (void)as_markGroupModulesDirtyForAsset:(PHAsset *)asset {
+    self.progressDirtyModules |= asset.mediaType == PHAssetMediaTypeVideo
+        ? (ASScanModuleMaskSimilarVideo | ASScanModuleMaskDuplicateVideo)
+        : (ASScanModuleMaskSimilarImage | ASScanModuleMaskDuplicateImage);
 }
 
 - (void)emitProgressMaybe {
@@ -0,0 +1,140 @@
+#include "ASPipelineRing.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+struct ASRing {
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    uint32_t *seqs;
+    void **items;
+    uint32_t capacity;
+    uint32_t head;      // 下一个读取位置
+    uint32_t count;
+    uint32_t highWater;
+    int closed;
+};
+
+ASRing *as_ring_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+    ASRing *r = (ASRing *)calloc(1, sizeof(ASRing));
+    if (!r) return NULL;
+    r->seqs = (uint32_t *)malloc(sizeof(uint32_t) * capacity);
+    r->items = (void **)malloc(sizeof(void *) * capacity);
+    if (!r->seqs || !r->items) {
+        free(r->seqs); free(r->items); free(r);
+        return NULL;
+    }
+    r->capacity = capacity;
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->notEmpty, NULL);
+    pthread_cond_init(&r->notFull, NULL);
+    return r;
+}
+
+void as_ring_destroy(ASRing *r) {
+    if (!r) return;
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->notEmpty);
+    pthread_cond_destroy(&r->notFull);
+    free(r->seqs);
+    free(r->items);
+    free(r);
+}
+
+int as_ring_push(ASRing *r, uint32_t seq, void *item) {
+    pthread_mutex_lock(&r->lock);
+    while (r->count == r->capacity && !r->closed) pthread_cond_wait(&r->notFull, &r->lock);
+    if (r->closed) {
+        pthread_mutex_unlock(&r->lock);
+        return 0;
+    }
+    uint32_t at = (r->head + r->count) % r->capacity;
+    r->seqs[at] = seq;
+    r->items[at] = item;
+    r->count++;
+    if (r->count > r->highWater) r->highWater = r->count;
+    pthread_cond_signal(&r->notEmpty);
+    pthread_mutex_unlock(&r->lock);
+    return 1;
+}
+
+uint32_t as_ring_pop_many(ASRing *r, uint32_t *seqs, void **items, uint32_t max) {
+    if (max == 0) return 0;
+    pthread_mutex_lock(&r->lock);
+    while (r->count == 0 && !r->closed) pthread_cond_wait(&r->notEmpty, &r->lock);
+    uint32_t n = r->count < max ? r->count : max;
+    for (uint32_t i = 0; i < n; i++) {
+        seqs[i] = r->seqs[r->head];
+        items[i] = r->items[r->head];
+        r->head = (r->head + 1) % r->capacity;
+    }
+    r->count -= n;
+    if (n) pthread_cond_broadcast(&r->notFull);
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+void as_ring_close(ASRing *r) {
+    pthread_mutex_lock(&r->lock);
+    r->closed = 1;
+    pthread_cond_broadcast(&r->notEmpty);
+    pthread_cond_broadcast(&r->notFull);
+    pthread_mutex_unlock(&r->lock);
+}
+
+uint32_t as_ring_capacity(const ASRing *r) { return r->capacity; }
+
+uint32_t as_ring_depth(ASRing *r) {
+    pthread_mutex_lock(&r->lock);
+    uint32_t n = r->count;
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+uint32_t as_ring_high_water(ASRing *r) {
+    pthread_mutex_lock(&r->lock);
+    uint32_t n = r->highWater;
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+// MARK: - Concurrency tuner
+
+uint32_t as_tuner_max_workers(uint32_t cores, uint32_t thermal) {
+    if (cores == 0) cores = 1;
+    uint32_t n;
+    switch (thermal) {
+        case 0:  n = cores * 2; if (n > 12) n = 12; break;
+        case 1:  n = cores;     if (n > 8) n = 8;   break;
+        case 2:  n = cores / 2; break;
+        default: n = 1;         break;
+    }
+    return n ? n : 1;
+}
+
+uint32_t as_tuner_target(const ASTunerInput *in) {
+    uint32_t ceiling = as_tuner_max_workers(in->cores, in->thermal);
+    uint32_t cur = in->current ? in->current : 1;
+
+    // 还没有测量值：先开一半
+    if (in->decodeUs <= 0 || in->consumeUs <= 0) {
+        uint32_t start = (ceiling + 1) / 2;
+        return start ? start : 1;
+    }
+
+    double ratio = ceil(in->decodeUs / in->consumeUs);
+    uint32_t ideal = ratio > (double)ceiling ? ceiling : (uint32_t)ratio + 1;
+
+    uint32_t target = cur;
+    if (in->outCapacity && in->outDepth * 4 >= in->outCapacity * 3) {
+        if (target > 1) target--;
+    } else if (in->outCapacity == 0 || in->outDepth * 4 <= in->outCapacity) {
+        target++;
+    }
+    if (target > ideal) target = ideal;
+    if (target > ceiling) target = ceiling;
+    return target ? target : 1;
+}
@@ -0,0 +1,60 @@
+#ifndef ASPipelineRing_h
+#define ASPipelineRing_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 扫描流水线的有界环形队列 + 并发度调节（纯 C，可在 Linux 上编译做 benchmark）
+///
+///   fetch(1 线程) --ring--> decode/特征(N 线程) --ring--> 归类/分组(1 线程，按 seq 重排)
+///
+/// 环满时 push 阻塞（背压），环空时 pop 阻塞；close 之后 push 失败、pop 取完剩余后返回 0。
+/// 元素是 (seq, item)：seq 由 fetch 按顺序编号，下游据此恢复原始顺序；item 由调用方管理所有权。
+
+typedef struct ASRing ASRing;
+
+ASRing *as_ring_create(uint32_t capacity);
+void as_ring_destroy(ASRing *r);
+
+/// 1 = 成功，0 = 已关闭
+int as_ring_push(ASRing *r, uint32_t seq, void *item);
+
+/// 至少取 1 个、至多 max 个；0 = 已关闭且取空
+uint32_t as_ring_pop_many(ASRing *r, uint32_t *seqs, void **items, uint32_t max);
+
+void as_ring_close(ASRing *r);
+
+uint32_t as_ring_capacity(const ASRing *r);
+uint32_t as_ring_depth(ASRing *r);
+uint32_t as_ring_high_water(ASRing *r);
+
+// MARK: - Concurrency tuner
+
+/// 热状态与 NSProcessInfoThermalState 对应：0 nominal / 1 fair / 2 serious / 3 critical
+typedef struct {
+    uint32_t cores;         // activeProcessorCount
+    uint32_t thermal;
+    double decodeUs;        // decode 阶段单张耗时（单线程，EWMA；0 = 尚无数据）
+    double consumeUs;       // 归类阶段单张耗时（串行，EWMA）
+    uint32_t outDepth;      // decode -> 归类 队列当前深度
+    uint32_t outCapacity;
+    uint32_t current;       // 当前 decode 线程数
+} ASTunerInput;
+
+/// 由核数与热状态决定的 decode 线程上限。decode 大部分时间在等 PhotoKit 出图，nominal 时允许超过核数
+uint32_t as_tuner_max_workers(uint32_t cores, uint32_t thermal);
+
+/// 下一个周期的 decode 线程数：
+///   - 够喂饱串行归类即可：ceil(decodeUs / consumeUs) + 1
+///   - 下游队列积压（>= 3/4）说明瓶颈在归类，减一；队列见底（<= 1/4）且未到上限，加一
+///   - 始终夹在 [1, as_tuner_max_workers]
+uint32_t as_tuner_target(const ASTunerInput *in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASPipelineRing_h */
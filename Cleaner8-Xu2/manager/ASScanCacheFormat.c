@@ -0,0 +1,376 @@
+#include "ASScanCacheFormat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define AS_TAG(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+enum {
+    AS_SEC_META = AS_TAG('M', 'E', 'T', 'A'),
+    AS_SEC_STRS = AS_TAG('S', 'T', 'R', 'S'),
+    AS_SEC_RECS = AS_TAG('R', 'E', 'C', 'S'),
+    AS_SEC_HASH = AS_TAG('H', 'A', 'S', 'H'),
+    AS_SEC_BLOB = AS_TAG('B', 'L', 'O', 'B'),
+    AS_SEC_LIST = AS_TAG('L', 'I', 'S', 'T'),
+};
+
+#define AS_SECTION_COUNT 6
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t recordSize;
+    uint64_t fileSize;
+    uint64_t reserved;
+} ASCacheHeader;            // 32 字节
+
+typedef struct {
+    uint32_t tag;
+    uint32_t count;         // 元素个数（字符串/记录/blob），其他段为 0
+    uint64_t offset;
+    uint64_t length;
+} ASCacheSection;           // 24 字节
+
+_Static_assert(sizeof(ASCacheRecord) == 64, "ASCacheRecord layout");
+_Static_assert(sizeof(ASCacheHeader) == 32, "ASCacheHeader layout");
+_Static_assert(sizeof(ASCacheSection) == 24, "ASCacheSection layout");
+
+static inline size_t as_align8(size_t n) { return (n + 7u) & ~(size_t)7u; }
+
+// MARK: - Growable buffer
+
+typedef struct {
+    uint8_t *p;
+    size_t len;
+    size_t cap;
+} ASBuf;
+
+static int as_buf_reserve(ASBuf *b, size_t extra) {
+    if (b->len + extra <= b->cap) return 1;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + extra) cap <<= 1;
+    uint8_t *p = (uint8_t *)realloc(b->p, cap);
+    if (!p) return 0;
+    b->p = p;
+    b->cap = cap;
+    return 1;
+}
+
+static int as_buf_append(ASBuf *b, const void *src, size_t n) {
+    if (!as_buf_reserve(b, n)) return 0;
+    if (n) memcpy(b->p + b->len, src, n);
+    b->len += n;
+    return 1;
+}
+
+static int as_buf_append_u32(ASBuf *b, uint32_t v) {
+    return as_buf_append(b, &v, sizeof(v));
+}
+
+// MARK: - Writer
+
+struct ASCacheWriter {
+    ASBuf strOffsets, strBytes;
+    ASBuf blobOffsets, blobBytes;
+    ASBuf records, hashes;
+    ASBuf lists;
+    ASBuf meta;
+    uint32_t strCount, blobCount, recordCount;
+    int failed;
+};
+
+ASCacheWriter *as_cache_writer_create(void) {
+    ASCacheWriter *w = (ASCacheWriter *)calloc(1, sizeof(ASCacheWriter));
+    if (!w) return NULL;
+    uint32_t zero = 0;
+    if (!as_buf_append(&w->strOffsets, &zero, 4) || !as_buf_append(&w->blobOffsets, &zero, 4)) w->failed = 1;
+    return w;
+}
+
+void as_cache_writer_destroy(ASCacheWriter *w) {
+    if (!w) return;
+    ASBuf *bufs[] = { &w->strOffsets, &w->strBytes, &w->blobOffsets, &w->blobBytes,
+                      &w->records, &w->hashes, &w->lists, &w->meta };
+    for (size_t i = 0; i < sizeof(bufs) / sizeof(bufs[0]); i++) free(bufs[i]->p);
+    free(w);
+}
+
+uint32_t as_cache_writer_add_string(ASCacheWriter *w, const char *utf8, uint32_t len) {
+    if (w->failed) return AS_CACHE_NONE;
+    if (w->strBytes.len + len > UINT32_MAX ||
+        !as_buf_append(&w->strBytes, utf8, len) ||
+        !as_buf_append_u32(&w->strOffsets, (uint32_t)w->strBytes.len)) {
+        w->failed = 1;
+        return AS_CACHE_NONE;
+    }
+    return w->strCount++;
+}
+
+uint32_t as_cache_writer_add_blob(ASCacheWriter *w, const void *bytes, uint32_t len) {
+    if (w->failed) return AS_CACHE_NONE;
+    if (w->blobBytes.len + len > UINT32_MAX ||
+        !as_buf_append(&w->blobBytes, bytes, len) ||
+        !as_buf_append_u32(&w->blobOffsets, (uint32_t)w->blobBytes.len)) {
+        w->failed = 1;
+        return AS_CACHE_NONE;
+    }
+    return w->blobCount++;
+}
+
+uint32_t as_cache_writer_add_record(ASCacheWriter *w, const ASCacheRecord *rec, const uint64_t *hash) {
+    if (w->failed) return AS_CACHE_NONE;
+    static const uint64_t zeros[4] = {0, 0, 0, 0};
+    ASCacheRecord r = *rec;
+    if (hash) r.flags |= AS_CACHE_REC_HAS_PHASH;
+    else r.flags &= (uint8_t)~AS_CACHE_REC_HAS_PHASH;
+
+    if (!as_buf_append(&w->records, &r, sizeof(r)) ||
+        !as_buf_append(&w->hashes, hash ? hash : zeros, 4 * sizeof(uint64_t))) {
+        w->failed = 1;
+        return AS_CACHE_NONE;
+    }
+    return w->recordCount++;
+}
+
+int as_cache_writer_add_list(ASCacheWriter *w, uint32_t listId, uint32_t tag, const uint32_t *idx, uint32_t n) {
+    if (w->failed) return 0;
+    uint32_t head[3] = { listId, tag, n };
+    if (!as_buf_append(&w->lists, head, sizeof(head)) ||
+        !as_buf_append(&w->lists, idx, (size_t)n * sizeof(uint32_t))) {
+        w->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+int as_cache_writer_set_meta(ASCacheWriter *w, const void *bytes, uint32_t len) {
+    if (w->failed) return 0;
+    w->meta.len = 0;
+    if (!as_buf_append(&w->meta, bytes, len)) { w->failed = 1; return 0; }
+    return 1;
+}
+
+int as_cache_writer_finish(ASCacheWriter *w, uint8_t **outBytes, size_t *outLen) {
+    *outBytes = NULL;
+    *outLen = 0;
+    if (w->failed) return 0;
+
+    // STRS / BLOB 段内部布局：u32 offsets[count + 1]，对齐后接字节
+    struct { uint32_t tag; uint32_t count; const ASBuf *a; const ASBuf *b; } parts[AS_SECTION_COUNT] = {
+        { AS_SEC_META, 0,              &w->meta,        NULL },
+        { AS_SEC_STRS, w->strCount,    &w->strOffsets,  &w->strBytes },
+        { AS_SEC_RECS, w->recordCount, &w->records,     NULL },
+        { AS_SEC_HASH, w->recordCount, &w->hashes,      NULL },
+        { AS_SEC_BLOB, w->blobCount,   &w->blobOffsets, &w->blobBytes },
+        { AS_SEC_LIST, 0,              &w->lists,       NULL },
+    };
+
+    ASCacheSection table[AS_SECTION_COUNT];
+    size_t off = as_align8(sizeof(ASCacheHeader) + sizeof(table));
+    for (int i = 0; i < AS_SECTION_COUNT; i++) {
+        size_t len = parts[i].a->len;
+        if (parts[i].b) len = as_align8(len) + parts[i].b->len;
+        table[i].tag = parts[i].tag;
+        table[i].count = parts[i].count;
+        table[i].offset = off;
+        table[i].length = len;
+        off = as_align8(off + len);
+    }
+
+    uint8_t *out = (uint8_t *)calloc(1, off);
+    if (!out) return 0;
+
+    ASCacheHeader h = { AS_CACHE_MAGIC, AS_CACHE_VERSION, AS_SECTION_COUNT, (uint32_t)sizeof(ASCacheRecord), off, 0 };
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + sizeof(h), table, sizeof(table));
+
+    for (int i = 0; i < AS_SECTION_COUNT; i++) {
+        uint8_t *dst = out + table[i].offset;
+        if (parts[i].a->len) memcpy(dst, parts[i].a->p, parts[i].a->len);
+        if (parts[i].b && parts[i].b->len) {
+            memcpy(dst + as_align8(parts[i].a->len), parts[i].b->p, parts[i].b->len);
+        }
+    }
+
+    *outBytes = out;
+    *outLen = off;
+    return 1;
+}
+
+// MARK: - Reader
+
+static const ASCacheSection *as_find_section(const ASCacheSection *table, uint32_t n, uint32_t tag) {
+    for (uint32_t i = 0; i < n; i++) if (table[i].tag == tag) return &table[i];
+    return NULL;
+}
+
+// 偏移表 + 字节的段：校验偏移单调且不越界
+static int as_open_offset_table(const uint8_t *base, const ASCacheSection *s,
+                                const uint32_t **outOffsets, const uint8_t **outBytes) {
+    size_t tableLen = ((size_t)s->count + 1) * sizeof(uint32_t);
+    if (s->length < tableLen) return 0;
+    const uint32_t *offs = (const uint32_t *)(base + s->offset);
+    size_t bytesAt = as_align8(tableLen);
+    size_t bytesLen = s->length >= bytesAt ? s->length - bytesAt : 0;
+    if (offs[0] != 0) return 0;
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (offs[i + 1] < offs[i]) return 0;
+    }
+    if (offs[s->count] > bytesLen) return 0;
+    *outOffsets = offs;
+    *outBytes = base + s->offset + bytesAt;
+    return 1;
+}
+
+int as_cache_view_open(ASCacheView *v, const void *bytes, size_t len) {
+    memset(v, 0, sizeof(*v));
+    const uint8_t *base = (const uint8_t *)bytes;
+    if (!base || len < sizeof(ASCacheHeader) || ((uintptr_t)base & 7u)) return -1;
+
+    ASCacheHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (h.magic != AS_CACHE_MAGIC) return -2;
+    if (h.version != AS_CACHE_VERSION || h.recordSize != sizeof(ASCacheRecord)) return -3;
+    if (h.fileSize != len || h.sectionCount > 64) return -4;
+    if (sizeof(h) + (size_t)h.sectionCount * sizeof(ASCacheSection) > len) return -4;
+
+    const ASCacheSection *table = (const ASCacheSection *)(base + sizeof(h));
+    for (uint32_t i = 0; i < h.sectionCount; i++) {
+        if ((table[i].offset & 7u) || table[i].offset > len || table[i].length > len - table[i].offset) return -5;
+    }
+
+    const ASCacheSection *meta = as_find_section(table, h.sectionCount, AS_SEC_META);
+    const ASCacheSection *strs = as_find_section(table, h.sectionCount, AS_SEC_STRS);
+    const ASCacheSection *recs = as_find_section(table, h.sectionCount, AS_SEC_RECS);
+    const ASCacheSection *hash = as_find_section(table, h.sectionCount, AS_SEC_HASH);
+    const ASCacheSection *blob = as_find_section(table, h.sectionCount, AS_SEC_BLOB);
+    const ASCacheSection *list = as_find_section(table, h.sectionCount, AS_SEC_LIST);
+    if (!meta || !strs || !recs || !hash || !blob || !list) return -6;
+
+    if (recs->length != (uint64_t)recs->count * sizeof(ASCacheRecord)) return -7;
+    if (hash->count != recs->count || hash->length != (uint64_t)hash->count * 4 * sizeof(uint64_t)) return -7;
+    if (meta->length > UINT32_MAX) return -7;
+
+    if (!as_open_offset_table(base, strs, &v->strOffsets, (const uint8_t **)&v->strBytes)) return -8;
+    if (!as_open_offset_table(base, blob, &v->blobOffsets, &v->blobBytes)) return -8;
+
+    v->records = (const ASCacheRecord *)(base + recs->offset);
+    v->hashes = (const uint64_t *)(base + hash->offset);
+    v->recordCount = recs->count;
+    v->strCount = strs->count;
+    v->blobCount = blob->count;
+    v->lists = base + list->offset;
+    v->listsLen = (size_t)list->length;
+    v->meta = base + meta->offset;
+    v->metaLen = (uint32_t)meta->length;
+
+    // 列表里的下标必须指向存在的记录
+    size_t cursor = 0;
+    uint32_t listId, tag, n;
+    const uint32_t *idx;
+    int rc;
+    while ((rc = as_cache_view_next_list(v, &cursor, &listId, &tag, &idx, &n)) > 0) {
+        (void)listId;
+        uint32_t limit = (tag & AS_CACHE_LIST_STRINGS) ? v->strCount : v->recordCount;
+        for (uint32_t i = 0; i < n; i++) if (idx[i] >= limit) return -9;
+    }
+    if (rc < 0) return -9;
+
+    for (uint32_t i = 0; i < v->recordCount; i++) {
+        const ASCacheRecord *r = &v->records[i];
+        if (r->localId >= v->strCount) return -10;
+        if (r->visionBlob != AS_CACHE_NONE && r->visionBlob >= v->blobCount) return -10;
+        if ((r->flags & AS_CACHE_REC_VIDEO_FP) && r->videoBlob >= v->blobCount) return -10;
+    }
+    return 0;
+}
+
+const char *as_cache_view_string(const ASCacheView *v, uint32_t idx, uint32_t *outLen) {
+    if (idx >= v->strCount) { if (outLen) *outLen = 0; return NULL; }
+    if (outLen) *outLen = v->strOffsets[idx + 1] - v->strOffsets[idx];
+    return v->strBytes + v->strOffsets[idx];
+}
+
+const void *as_cache_view_blob(const ASCacheView *v, uint32_t idx, uint32_t *outLen) {
+    if (idx >= v->blobCount) { if (outLen) *outLen = 0; return NULL; }
+    if (outLen) *outLen = v->blobOffsets[idx + 1] - v->blobOffsets[idx];
+    return v->blobBytes + v->blobOffsets[idx];
+}
+
+// 返回 1 = 取到一个列表，0 = 结束，-1 = 格式错误
+int as_cache_view_next_list(const ASCacheView *v, size_t *cursor,
+                            uint32_t *listId, uint32_t *tag,
+                            const uint32_t **idx, uint32_t *n) {
+    size_t at = *cursor;
+    if (at == v->listsLen) return 0;
+    if (v->listsLen - at < 3 * sizeof(uint32_t)) return -1;
+
+    const uint32_t *head = (const uint32_t *)(v->lists + at);
+    size_t body = (size_t)head[2] * sizeof(uint32_t);
+    if (v->listsLen - at - 3 * sizeof(uint32_t) < body) return -1;
+
+    *listId = head[0];
+    *tag = head[1];
+    *n = head[2];
+    *idx = head + 3;
+    *cursor = at + 3 * sizeof(uint32_t) + body;
+    return 1;
+}
+
+// MARK: - Journal
+
+_Static_assert(sizeof(ASJournalFrameHeader) == 16, "ASJournalFrameHeader layout");
+
+// FNV-1a 64，按 8 字节一组混合（只用于发现半截写入，不做抗碰撞）
+uint64_t as_cache_checksum(const void *bytes, size_t len) {
+    const uint8_t *p = (const uint8_t *)bytes;
+    uint64_t h = 0xCBF29CE484222325ull;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h ^= w;
+        h *= 0x100000001B3ull;
+    }
+    for (; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+void as_journal_frame_header(ASJournalFrameHeader *h, const void *payload, uint32_t len) {
+    h->magic = AS_JOURNAL_MAGIC;
+    h->length = len;
+    h->checksum = as_cache_checksum(payload, len);
+}
+
+size_t as_journal_frame_padding(uint32_t len) {
+    return as_align8(len) - len;
+}
+
+ASJournalSeqCheck as_journal_seq_check(uint64_t lastApplied, uint64_t seq) {
+    if (seq <= lastApplied) return AS_JOURNAL_SEQ_SKIP;
+    return seq == lastApplied + 1 ? AS_JOURNAL_SEQ_APPLY : AS_JOURNAL_SEQ_GAP;
+}
+
+int as_journal_next(const void *bytes, size_t len, size_t *cursor,
+                    const uint8_t **payload, uint32_t *payloadLen) {
+    const uint8_t *base = (const uint8_t *)bytes;
+    size_t at = *cursor;
+    if (!base || at >= len || len - at < sizeof(ASJournalFrameHeader)) return 0;
+
+    ASJournalFrameHeader h;
+    memcpy(&h, base + at, sizeof(h));
+    if (h.magic != AS_JOURNAL_MAGIC) return 0;
+
+    size_t body = at + sizeof(h);
+    if (h.length > len - body) return 0;
+    if (as_cache_checksum(base + body, h.length) != h.checksum) return 0;
+
+    *payload = base + body;
+    *payloadLen = h.length;
+    *cursor = body + as_align8(h.length);
+    return 1;
+}
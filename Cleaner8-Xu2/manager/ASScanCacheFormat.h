@@ -0,0 +1,147 @@
+#ifndef ASScanCacheFormat_h
+#define ASScanCacheFormat_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 扫描缓存 v4 二进制格式（纯 C，可在 Linux 上编译做 benchmark）
+///
+///   Header | SectionTable | META | STRS | RECS | HASH | BLOB | LIST
+///
+/// - RECS：定长记录（大小 / 日期 / subtypes / 模糊度 ...），localId 存字符串表下标
+/// - HASH：pHash256 单独成列（32B/条），建索引时可直接顺序读
+/// - STRS / BLOB：偏移表 + 连续字节（localId、Vision 特征）
+/// - LIST：模型列表与分组，元素是记录下标；同一 model 只存一份
+/// - META：调用方自定义的小块元数据（快照、计数器等）
+/// 所有段 8 字节对齐、小端；读取端零拷贝，可直接作用在 mmap 的内存上，
+/// 打开时校验全部偏移/长度，损坏文件返回错误而不是越界。
+
+#define AS_CACHE_MAGIC   0x43535341u  // "ASSC"
+#define AS_CACHE_VERSION 4u
+#define AS_CACHE_NONE    UINT32_MAX
+
+/// 列表 tag 带此位时，元素是字符串下标（如全部 localId 基线），否则是记录下标
+#define AS_CACHE_LIST_STRINGS 0x80000000u
+
+enum {
+    AS_CACHE_REC_HAS_CREATION     = 1u << 0,
+    AS_CACHE_REC_HAS_MODIFICATION = 1u << 1,
+    AS_CACHE_REC_HAS_PHASH        = 1u << 2,
+    AS_CACHE_REC_VISION_F32       = 1u << 3,  // visionBlob 是原始 float32 特征（否则是归档的 VNFeaturePrintObservation）
+    AS_CACHE_REC_VIDEO_FP         = 1u << 4,  // videoBlob 有效（视频多帧指纹）
+};
+
+typedef struct {
+    uint32_t localId;       // 字符串下标
+    uint32_t subtypes;
+    uint32_t visionBlob;    // BLOB 下标，AS_CACHE_NONE = 无
+    uint8_t  mediaType;
+    uint8_t  flags;         // AS_CACHE_REC_*
+    uint16_t reserved;
+    float    blurScore;
+    float    lumaMean;
+    float    lumaStd;
+    uint32_t videoBlob;     // BLOB 下标，仅 AS_CACHE_REC_VIDEO_FP 时有效（旧文件里是 0）
+    double   creation;      // timeIntervalSince1970
+    double   modification;
+    uint64_t fileSize;
+    uint64_t pHash64;
+} ASCacheRecord;            // 64 字节
+
+// MARK: - Writer
+
+typedef struct ASCacheWriter ASCacheWriter;
+
+ASCacheWriter *as_cache_writer_create(void);
+void as_cache_writer_destroy(ASCacheWriter *w);
+
+uint32_t as_cache_writer_add_string(ASCacheWriter *w, const char *utf8, uint32_t len);
+uint32_t as_cache_writer_add_blob(ASCacheWriter *w, const void *bytes, uint32_t len);
+
+/// hash 可空（写全 0，flags 不带 HAS_PHASH）；返回记录下标
+uint32_t as_cache_writer_add_record(ASCacheWriter *w, const ASCacheRecord *rec, const uint64_t *hash);
+
+/// 追加一个列表：listId 由调用方定义，tag 供分组类型等使用；同一 listId 可出现多次
+int as_cache_writer_add_list(ASCacheWriter *w, uint32_t listId, uint32_t tag, const uint32_t *idx, uint32_t n);
+
+int as_cache_writer_set_meta(ASCacheWriter *w, const void *bytes, uint32_t len);
+
+/// 生成完整文件内容；*outBytes 由调用方 free()
+int as_cache_writer_finish(ASCacheWriter *w, uint8_t **outBytes, size_t *outLen);
+
+// MARK: - Reader
+
+typedef struct {
+    const ASCacheRecord *records;
+    const uint64_t *hashes;     // recordCount * 4
+    uint32_t recordCount;
+
+    const uint32_t *strOffsets; // strCount + 1
+    const char *strBytes;
+    uint32_t strCount;
+
+    const uint32_t *blobOffsets;
+    const uint8_t *blobBytes;
+    uint32_t blobCount;
+
+    const uint8_t *lists;
+    size_t listsLen;
+
+    const uint8_t *meta;
+    uint32_t metaLen;
+} ASCacheView;
+
+/// 0 = 成功；<0 = 魔数/版本/越界等错误
+int as_cache_view_open(ASCacheView *v, const void *bytes, size_t len);
+
+const char *as_cache_view_string(const ASCacheView *v, uint32_t idx, uint32_t *outLen);
+const void *as_cache_view_blob(const ASCacheView *v, uint32_t idx, uint32_t *outLen);
+
+/// 依次遍历列表；*cursor 从 0 开始；返回 1 = 取到一个，0 = 结束，<0 = 格式错误
+int as_cache_view_next_list(const ASCacheView *v, size_t *cursor,
+                            uint32_t *listId, uint32_t *tag,
+                            const uint32_t **idx, uint32_t *n);
+
+// MARK: - Journal
+
+/// checkpoint 追加日志：若干帧，每帧 = FrameHeader + payload（一个完整的 v4 块，只含本次增量），补齐到 8 字节。
+/// 进程被杀时最后一帧可能只写了一半：读取遇到不完整 / 校验失败的帧即停止，之前的帧仍然有效。
+
+#define AS_JOURNAL_MAGIC 0x4A535341u  // "ASSJ"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t length;        // payload 字节数（不含补齐）
+    uint64_t checksum;      // as_cache_checksum(payload)
+} ASJournalFrameHeader;     // 16 字节
+
+uint64_t as_cache_checksum(const void *bytes, size_t len);
+
+void as_journal_frame_header(ASJournalFrameHeader *h, const void *payload, uint32_t len);
+
+/// payload 之后需要补的 0 字节数
+size_t as_journal_frame_padding(uint32_t len);
+
+/// 依次取帧；*cursor 从 0 开始；返回 1 = 取到一帧，0 = 结束（含不完整的尾帧）
+int as_journal_next(const void *bytes, size_t len, size_t *cursor,
+                    const uint8_t **payload, uint32_t *payloadLen);
+
+/// 重放时按帧里的 seq 判断：<= last 已并入 base，跳过；== last + 1 应用；更大说明中间缺帧，
+/// 之后的增量都建立在缺的那帧上，必须停止重放
+typedef enum {
+    AS_JOURNAL_SEQ_SKIP = 0,
+    AS_JOURNAL_SEQ_APPLY = 1,
+    AS_JOURNAL_SEQ_GAP = 2,
+} ASJournalSeqCheck;
+
+ASJournalSeqCheck as_journal_seq_check(uint64_t lastApplied, uint64_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASScanCacheFormat_h */
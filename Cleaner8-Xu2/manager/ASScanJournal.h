@@ -0,0 +1,37 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 全量扫描的 checkpoint 追加日志（base 缓存之外的 .wal 文件）
+///
+/// 每次 checkpoint 只追加本次新增的 model / 分组变更（一帧），不再整库重写；
+/// 扫描结束、进后台或日志超过 base 大小时压缩回 base 并清空日志。
+/// 文件读写只在调用方的串行 IO 队列上进行；统计接口线程安全。
+@interface ASScanJournal : NSObject
+
+- (instancetype)initWithPath:(NSString *)path;
+
+@property (nonatomic, copy, readonly) NSString *path;
+
+/// 追加一帧；返回写入字节数（含帧头），0 = 失败（文件截回追加前的长度，调用方应改写 base）
+- (NSUInteger)appendFrame:(NSData *)payload;
+
+/// 删除日志（压缩进 base 之后）
+- (void)truncate;
+
+/// 按顺序遍历完整帧；半截写入的尾帧被忽略（seq 是否连续由调用方检查）。frame 引用映射内存，block 返回后仍可持有
+- (NSUInteger)enumerateFramesUsingBlock:(void (^)(NSData *frame, BOOL *stop))block;
+
+/// 统计：checkpoint 构建耗时（扫描线程被占用的时间）/ 写入字节 / 写入耗时
+- (void)recordCheckpointBuildMs:(double)ms compaction:(BOOL)compaction;
+- (void)recordBaseWriteBytes:(NSUInteger)bytes ms:(double)ms;
+- (void)recordReplayedFrames:(NSUInteger)frames ms:(double)ms;
+
+/// checkpoints / compactions / buildMs / buildMsMax / frames / frameBytes / frameWriteMs /
+/// baseWrites / baseBytes / baseWriteMs / bytesWritten / replayFrames / replayMs
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+- (void)resetStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
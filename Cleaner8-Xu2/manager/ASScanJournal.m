@@ -0,0 +1,145 @@
+#import "ASScanJournal.h"
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+#import <fcntl.h>
+#import <sys/stat.h>
+#import <sys/uio.h>
+#import <unistd.h>
+#import "ASScanCacheFormat.h"
+#import "ASScanMetrics.h"
+
+static inline double ASNowMs(void) { return CACurrentMediaTime() * 1000.0; }
+
+@implementation ASScanJournal {
+    os_unfair_lock _statLock;
+    NSUInteger _checkpoints, _compactions, _frames, _baseWrites, _replayFrames;
+    uint64_t _frameBytes, _baseBytes;
+    double _buildMs, _buildMsMax, _frameWriteMs, _baseWriteMs, _replayMs;
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    if (self = [super init]) {
+        _path = [path copy];
+        _statLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+#pragma mark - File
+
+- (NSUInteger)appendFrame:(NSData *)payload {
+    if (payload.length == 0 || payload.length > UINT32_MAX) return 0;
+    double t0 = ASNowMs();
+
+    BOOL created = ![[NSFileManager defaultManager] fileExistsAtPath:self.path];
+    int fd = open(self.path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) return 0;
+    // 写失败 / 写一半时截回原长度，不在文件里留半截帧（之后追加的帧会接在它后面）
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return 0; }
+
+    ASJournalFrameHeader h;
+    as_journal_frame_header(&h, payload.bytes, (uint32_t)payload.length);
+    static const uint8_t zeros[8] = {0};
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_CHECKPOINT_WRITE);
+
+    struct iovec iov[3] = {
+        { &h, sizeof(h) },
+        { (void *)payload.bytes, payload.length },
+        { (void *)zeros, as_journal_frame_padding((uint32_t)payload.length) },
+    };
+    size_t total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+    ssize_t n = writev(fd, iov, 3);
+    if (n != (ssize_t)total) ftruncate(fd, st.st_size);
+    close(fd);
+    as_metrics_end(iv);
+
+    if (created) {
+        [[NSFileManager defaultManager] setAttributes:@{NSFileProtectionKey: NSFileProtectionCompleteUntilFirstUserAuthentication}
+                                         ofItemAtPath:self.path
+                                                error:nil];
+    }
+    if (n != (ssize_t)total) return 0;
+
+    as_metrics_add(AS_COUNTER_CHECKPOINT_FRAME_BYTES, total);
+    double ms = ASNowMs() - t0;
+    os_unfair_lock_lock(&_statLock);
+    _frames += 1;
+    _frameBytes += total;
+    _frameWriteMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+    return total;
+}
+
+- (void)truncate {
+    [[NSFileManager defaultManager] removeItemAtPath:self.path error:nil];
+}
+
+- (NSUInteger)enumerateFramesUsingBlock:(void (^)(NSData *, BOOL *))block {
+    NSData *data = [NSData dataWithContentsOfFile:self.path options:NSDataReadingMappedIfSafe error:nil];
+    if (data.length == 0) return 0;
+
+    NSUInteger count = 0;
+    size_t cursor = 0;
+    const uint8_t *payload = NULL;
+    uint32_t len = 0;
+    BOOL stop = NO;
+    while (!stop && as_journal_next(data.bytes, data.length, &cursor, &payload, &len) > 0) {
+        NSData *frame = [[NSData alloc] initWithBytesNoCopy:(void *)payload length:len deallocator:^(void *bytes, NSUInteger length) {
+            (void)data; // 持有映射
+        }];
+        block(frame, &stop);
+        count += 1;
+    }
+    return count;
+}
+
+#pragma mark - Stats
+
+- (void)recordCheckpointBuildMs:(double)ms compaction:(BOOL)compaction {
+    os_unfair_lock_lock(&_statLock);
+    _checkpoints += 1;
+    if (compaction) _compactions += 1;
+    _buildMs += ms;
+    if (ms > _buildMsMax) _buildMsMax = ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)recordBaseWriteBytes:(NSUInteger)bytes ms:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _baseWrites += 1;
+    _baseBytes += bytes;
+    _baseWriteMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)recordReplayedFrames:(NSUInteger)frames ms:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _replayFrames += frames;
+    _replayMs += ms;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    os_unfair_lock_lock(&_statLock);
+    NSDictionary *d = @{
+        @"checkpoints": @(_checkpoints), @"compactions": @(_compactions),
+        @"buildMs": @(_buildMs), @"buildMsMax": @(_buildMsMax),
+        @"frames": @(_frames), @"frameBytes": @(_frameBytes), @"frameWriteMs": @(_frameWriteMs),
+        @"baseWrites": @(_baseWrites), @"baseBytes": @(_baseBytes), @"baseWriteMs": @(_baseWriteMs),
+        @"bytesWritten": @(_frameBytes + _baseBytes),
+        @"replayFrames": @(_replayFrames), @"replayMs": @(_replayMs),
+    };
+    os_unfair_lock_unlock(&_statLock);
+    return d;
+}
+
+- (void)resetStats {
+    os_unfair_lock_lock(&_statLock);
+    _checkpoints = _compactions = _frames = _baseWrites = _replayFrames = 0;
+    _frameBytes = _baseBytes = 0;
+    _buildMs = _buildMsMax = _frameWriteMs = _baseWriteMs = _replayMs = 0;
+    os_unfair_lock_unlock(&_statLock);
+}
+
+@end
@@ -0,0 +1,245 @@
+#include "ASScanMetrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__APPLE__)
+#include <os/signpost.h>
+#include <pthread.h>
+#endif
+
+_Atomic int as_metrics_flag = 0;
+
+typedef struct {
+    _Atomic uint64_t count, totalNs, maxNs;
+    _Atomic uint64_t buckets[AS_METRIC_BUCKETS];
+} ASAtomicHistogram;
+
+static ASAtomicHistogram gStages[AS_STAGE_COUNT];
+static _Atomic uint64_t gCacheHits[AS_CACHE_COUNT], gCacheMisses[AS_CACHE_COUNT];
+static _Atomic uint64_t gCounters[AS_COUNTER_COUNT];
+static _Atomic uint64_t gStartNs, gEndNs;
+
+#define AS_RELAXED memory_order_relaxed
+
+uint64_t as_metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void as_metrics_set_enabled(int on) {
+    if (on && !as_metrics_enabled()) as_metrics_reset();
+    atomic_store_explicit(&as_metrics_flag, on ? 1 : 0, AS_RELAXED);
+}
+
+void as_metrics_reset(void) {
+    for (int s = 0; s < AS_STAGE_COUNT; s++) {
+        atomic_store_explicit(&gStages[s].count, 0, AS_RELAXED);
+        atomic_store_explicit(&gStages[s].totalNs, 0, AS_RELAXED);
+        atomic_store_explicit(&gStages[s].maxNs, 0, AS_RELAXED);
+        for (int b = 0; b < AS_METRIC_BUCKETS; b++) atomic_store_explicit(&gStages[s].buckets[b], 0, AS_RELAXED);
+    }
+    for (int c = 0; c < AS_CACHE_COUNT; c++) {
+        atomic_store_explicit(&gCacheHits[c], 0, AS_RELAXED);
+        atomic_store_explicit(&gCacheMisses[c], 0, AS_RELAXED);
+    }
+    for (int c = 0; c < AS_COUNTER_COUNT; c++) atomic_store_explicit(&gCounters[c], 0, AS_RELAXED);
+    atomic_store_explicit(&gStartNs, as_metrics_now_ns(), AS_RELAXED);
+    atomic_store_explicit(&gEndNs, 0, AS_RELAXED);
+}
+
+void as_metrics_mark_end(void) {
+    atomic_store_explicit(&gEndNs, as_metrics_now_ns(), AS_RELAXED);
+}
+
+// MARK: - Signpost
+
+#if defined(__APPLE__)
+static os_log_t gLog;
+static pthread_once_t gLogOnce = PTHREAD_ONCE_INIT;
+
+static void as_metrics_make_log(void) {
+    gLog = os_log_create("as.photo.scan", "Pipeline");
+}
+
+// os_signpost 的名字必须是字面量
+#define AS_SIGNPOST(kind, stage, id) do { \
+    switch (stage) { \
+        case AS_STAGE_FILE_SIZE:         os_signpost_interval_##kind(gLog, id, "FileSize"); break; \
+        case AS_STAGE_THUMBNAIL:         os_signpost_interval_##kind(gLog, id, "Thumbnail"); break; \
+        case AS_STAGE_FEATURES:          os_signpost_interval_##kind(gLog, id, "Features"); break; \
+        case AS_STAGE_VISION:            os_signpost_interval_##kind(gLog, id, "Vision"); break; \
+        case AS_STAGE_DECODE:            os_signpost_interval_##kind(gLog, id, "Decode"); break; \
+        case AS_STAGE_GROUP:             os_signpost_interval_##kind(gLog, id, "Group"); break; \
+        case AS_STAGE_CHECKPOINT_BUILD:  os_signpost_interval_##kind(gLog, id, "CheckpointBuild"); break; \
+        case AS_STAGE_CHECKPOINT_WRITE:  os_signpost_interval_##kind(gLog, id, "CheckpointWrite"); break; \
+        case AS_STAGE_VIDEO_FINGERPRINT: os_signpost_interval_##kind(gLog, id, "VideoFingerprint"); break; \
+        default: break; \
+    } \
+} while (0)
+#endif
+
+// MARK: - Record
+
+ASMetricInterval as_metrics_begin_slow(ASMetricStage stage) {
+    ASMetricInterval iv = { as_metrics_now_ns(), 0, (int)stage };
+    if (iv.t0 == 0) iv.t0 = 1;
+#if defined(__APPLE__)
+    pthread_once(&gLogOnce, as_metrics_make_log);
+    if (os_signpost_enabled(gLog)) {
+        os_signpost_id_t sid = os_signpost_id_generate(gLog);
+        iv.signpost = sid;
+        AS_SIGNPOST(begin, stage, sid);
+    }
+#endif
+    return iv;
+}
+
+void as_metrics_end_slow(ASMetricInterval iv) {
+    uint64_t now = as_metrics_now_ns();
+    as_metrics_record_ns((ASMetricStage)iv.stage, now > iv.t0 ? now - iv.t0 : 0);
+#if defined(__APPLE__)
+    if (iv.signpost) AS_SIGNPOST(end, iv.stage, (os_signpost_id_t)iv.signpost);
+#endif
+}
+
+static inline int as_bucket_for_ns(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int b = 0;
+    while (us > 1 && b < AS_METRIC_BUCKETS - 1) { us >>= 1; b++; }
+    return b;
+}
+
+void as_metrics_record_ns(ASMetricStage stage, uint64_t ns) {
+    if ((unsigned)stage >= AS_STAGE_COUNT) return;
+    ASAtomicHistogram *h = &gStages[stage];
+    atomic_fetch_add_explicit(&h->count, 1, AS_RELAXED);
+    atomic_fetch_add_explicit(&h->totalNs, ns, AS_RELAXED);
+    atomic_fetch_add_explicit(&h->buckets[as_bucket_for_ns(ns)], 1, AS_RELAXED);
+    uint64_t m = atomic_load_explicit(&h->maxNs, AS_RELAXED);
+    while (ns > m && !atomic_compare_exchange_weak_explicit(&h->maxNs, &m, ns, AS_RELAXED, AS_RELAXED)) { }
+}
+
+void as_metrics_cache_slow(ASMetricCache cache, int hit) {
+    if ((unsigned)cache >= AS_CACHE_COUNT) return;
+    atomic_fetch_add_explicit(hit ? &gCacheHits[cache] : &gCacheMisses[cache], 1, AS_RELAXED);
+}
+
+void as_metrics_add_slow(ASMetricCounter counter, uint64_t v) {
+    if ((unsigned)counter >= AS_COUNTER_COUNT) return;
+    atomic_fetch_add_explicit(&gCounters[counter], v, AS_RELAXED);
+}
+
+// MARK: - Export
+
+void as_metrics_snapshot(ASMetricsSnapshot *out) {
+    memset(out, 0, sizeof(*out));
+    for (int s = 0; s < AS_STAGE_COUNT; s++) {
+        out->stages[s].count = atomic_load_explicit(&gStages[s].count, AS_RELAXED);
+        out->stages[s].totalNs = atomic_load_explicit(&gStages[s].totalNs, AS_RELAXED);
+        out->stages[s].maxNs = atomic_load_explicit(&gStages[s].maxNs, AS_RELAXED);
+        for (int b = 0; b < AS_METRIC_BUCKETS; b++) out->stages[s].buckets[b] = atomic_load_explicit(&gStages[s].buckets[b], AS_RELAXED);
+    }
+    for (int c = 0; c < AS_CACHE_COUNT; c++) {
+        out->cacheHits[c] = atomic_load_explicit(&gCacheHits[c], AS_RELAXED);
+        out->cacheMisses[c] = atomic_load_explicit(&gCacheMisses[c], AS_RELAXED);
+    }
+    for (int c = 0; c < AS_COUNTER_COUNT; c++) out->counters[c] = atomic_load_explicit(&gCounters[c], AS_RELAXED);
+
+    uint64_t start = atomic_load_explicit(&gStartNs, AS_RELAXED);
+    uint64_t end = atomic_load_explicit(&gEndNs, AS_RELAXED);
+    if (!end) end = as_metrics_now_ns();
+    out->elapsedNs = (start && end > start) ? end - start : 0;
+    out->enabled = as_metrics_enabled();
+}
+
+double as_metrics_percentile_us(const ASMetricHistogram *h, double p) {
+    if (h->count == 0) return 0;
+    if (p < 0) p = 0;
+    if (p > 1) p = 1;
+    double rank = p * (double)h->count;
+    uint64_t seen = 0;
+    for (int b = 0; b < AS_METRIC_BUCKETS; b++) {
+        uint64_t n = h->buckets[b];
+        if (n == 0) continue;
+        if ((double)(seen + n) >= rank) {
+            double lo = b == 0 ? 0 : (double)(1ull << b);
+            double hi = (double)(1ull << (b + 1));
+            double v = lo + (hi - lo) * ((rank - (double)seen) / (double)n);
+            double maxUs = (double)h->maxNs / 1000.0;
+            return v < maxUs ? v : maxUs;
+        }
+        seen += n;
+    }
+    return (double)h->maxNs / 1000.0;
+}
+
+const char *as_metrics_stage_name(ASMetricStage stage) {
+    static const char *names[AS_STAGE_COUNT] = {
+        "fileSize", "thumbnail", "features", "vision", "decode", "group", "checkpointBuild", "checkpointWrite",
+        "videoFingerprint",
+    };
+    return (unsigned)stage < AS_STAGE_COUNT ? names[stage] : "?";
+}
+
+const char *as_metrics_cache_name(ASMetricCache cache) {
+    static const char *names[AS_CACHE_COUNT] = { "blurMemo", "visionMemo", "thumbnail", "featureStore", "assetSize" };
+    return (unsigned)cache < AS_CACHE_COUNT ? names[cache] : "?";
+}
+
+typedef struct {
+    char *buf;
+    size_t cap, len;
+} ASJsonOut;
+
+static void as_json_put(ASJsonOut *o, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = o->len < o->cap ? o->cap - o->len : 0;
+    int n = vsnprintf(room ? o->buf + o->len : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0) o->len += (size_t)n;
+}
+
+size_t as_metrics_json(const ASMetricsSnapshot *s, char *buf, size_t cap) {
+    ASJsonOut o = { buf, cap, 0 };
+    if (buf && cap) buf[0] = 0;
+
+    double secs = (double)s->elapsedNs / 1e9;
+    uint64_t assets = s->counters[AS_COUNTER_ASSETS];
+    as_json_put(&o, "{\"enabled\":%s,\"elapsedMs\":%.1f,\"assets\":%llu,\"assetsPerSec\":%.1f,",
+                s->enabled ? "true" : "false", secs * 1000.0, (unsigned long long)assets, secs > 0 ? (double)assets / secs : 0.0);
+    as_json_put(&o, "\"checkpointBaseBytes\":%llu,\"checkpointFrameBytes\":%llu,",
+                (unsigned long long)s->counters[AS_COUNTER_CHECKPOINT_BASE_BYTES],
+                (unsigned long long)s->counters[AS_COUNTER_CHECKPOINT_FRAME_BYTES]);
+    uint64_t videos = s->counters[AS_COUNTER_VIDEOS], frames = s->counters[AS_COUNTER_VIDEO_FRAMES];
+    as_json_put(&o, "\"videos\":%llu,\"videoFrames\":%llu,\"framesPerVideo\":%.2f,",
+                (unsigned long long)videos, (unsigned long long)frames, videos ? (double)frames / (double)videos : 0.0);
+
+    as_json_put(&o, "\"stages\":{");
+    for (int i = 0; i < AS_STAGE_COUNT; i++) {
+        const ASMetricHistogram *h = &s->stages[i];
+        as_json_put(&o, "%s\"%s\":{\"count\":%llu,\"totalMs\":%.3f,\"avgUs\":%.1f,\"p50Us\":%.1f,\"p90Us\":%.1f,\"p99Us\":%.1f,\"maxUs\":%.1f,\"buckets\":[",
+                    i ? "," : "", as_metrics_stage_name((ASMetricStage)i), (unsigned long long)h->count,
+                    (double)h->totalNs / 1e6, h->count ? (double)h->totalNs / 1e3 / (double)h->count : 0.0,
+                    as_metrics_percentile_us(h, 0.5), as_metrics_percentile_us(h, 0.9), as_metrics_percentile_us(h, 0.99),
+                    (double)h->maxNs / 1e3);
+        // 只输出到最后一个非空桶；第 b 个桶 = [2^b, 2^(b+1)) 微秒
+        int last = -1;
+        for (int b = 0; b < AS_METRIC_BUCKETS; b++) if (h->buckets[b]) last = b;
+        for (int b = 0; b <= last; b++) as_json_put(&o, "%s%llu", b ? "," : "", (unsigned long long)h->buckets[b]);
+        as_json_put(&o, "]}");
+    }
+    as_json_put(&o, "},\"caches\":{");
+    for (int i = 0; i < AS_CACHE_COUNT; i++) {
+        uint64_t hit = s->cacheHits[i], miss = s->cacheMisses[i];
+        as_json_put(&o, "%s\"%s\":{\"hits\":%llu,\"misses\":%llu,\"hitRate\":%.4f}",
+                    i ? "," : "", as_metrics_cache_name((ASMetricCache)i), (unsigned long long)hit, (unsigned long long)miss,
+                    hit + miss ? (double)hit / (double)(hit + miss) : 0.0);
+    }
+    as_json_put(&o, "}}");
+    return o.len;
+}
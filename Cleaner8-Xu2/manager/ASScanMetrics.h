@@ -0,0 +1,128 @@
+#ifndef ASScanMetrics_h
+#define ASScanMetrics_h
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 扫描指标（纯 C，始终编译；Linux 上可编译做校验 / benchmark）
+///
+/// - 每个阶段一条延迟直方图：按微秒取 log2 分 32 桶，另记次数 / 总耗时 / 最大值，全部是 relaxed 原子计数
+/// - 缓存命中率（blur memo / vision memo / 缩略图复用 / 持久化特征库 / 资产大小）、资产数 / 秒、checkpoint 写入字节
+/// - 导出 JSON；Apple 平台上每个区间同时打 os_signpost（Instruments 里按阶段看时间线）
+/// 关闭时每个埋点只是一次 relaxed load + 分支，不取时间、不写共享内存。
+
+typedef enum {
+    AS_STAGE_FILE_SIZE = 0,     // fetchFileSizeForAsset（大小服务；未命中时读 PHAssetResource）
+    AS_STAGE_THUMBNAIL,         // 同步请求 512 缩略图
+    AS_STAGE_FEATURES,          // 一次解码里的 pHash + 模糊度 + 曝光
+    AS_STAGE_VISION,            // Vision 特征
+    AS_STAGE_DECODE,            // 单张 decode 阶段总耗时（流水线 decode 线程）
+    AS_STAGE_GROUP,             // 单张归类 / 分组（workQ）
+    AS_STAGE_CHECKPOINT_BUILD,  // checkpoint 构建（占用 workQ）
+    AS_STAGE_CHECKPOINT_WRITE,  // checkpoint 落盘（ioQ）
+    AS_STAGE_VIDEO_FINGERPRINT, // 单个视频多帧指纹（取 AVAsset + 一次 AVAssetReader 解码）
+    AS_STAGE_COUNT
+} ASMetricStage;
+
+typedef enum {
+    AS_CACHE_BLUR_MEMO = 0,
+    AS_CACHE_VISION_MEMO,
+    AS_CACHE_THUMBNAIL,         // Vision 复用 decode 阶段留下的缩略图
+    AS_CACHE_FEATURE_STORE,     // 持久化特征库（localId + modificationDate）
+    AS_CACHE_ASSET_SIZE,        // 资产大小服务的持久化缓存
+    AS_CACHE_COUNT
+} ASMetricCache;
+
+typedef enum {
+    AS_COUNTER_ASSETS = 0,      // 归类完成的资产数
+    AS_COUNTER_CHECKPOINT_BASE_BYTES,
+    AS_COUNTER_CHECKPOINT_FRAME_BYTES,
+    AS_COUNTER_VIDEOS,          // 算过指纹的视频数
+    AS_COUNTER_VIDEO_FRAMES,    // 指纹解码出的帧数（framesPerVideo = 帧数 / 视频数）
+    AS_COUNTER_COUNT
+} ASMetricCounter;
+
+#define AS_METRIC_BUCKETS 32
+
+extern _Atomic int as_metrics_flag;
+
+static inline int as_metrics_enabled(void) {
+    return atomic_load_explicit(&as_metrics_flag, memory_order_relaxed);
+}
+
+void as_metrics_set_enabled(int on);
+
+/// 清零全部计数，并把「扫描开始时间」设为现在（assets/sec 的分母）
+void as_metrics_reset(void);
+/// 扫描结束时调用，assets/sec 以此为止；未调用则算到导出时刻
+void as_metrics_mark_end(void);
+
+uint64_t as_metrics_now_ns(void);
+
+// MARK: - Record
+
+typedef struct {
+    uint64_t t0;                // 0 = 未开启
+    uint64_t signpost;
+    int stage;
+} ASMetricInterval;
+
+ASMetricInterval as_metrics_begin_slow(ASMetricStage stage);
+void as_metrics_end_slow(ASMetricInterval iv);
+void as_metrics_record_ns(ASMetricStage stage, uint64_t ns);
+void as_metrics_cache_slow(ASMetricCache cache, int hit);
+void as_metrics_add_slow(ASMetricCounter counter, uint64_t v);
+
+static inline ASMetricInterval as_metrics_begin(ASMetricStage stage) {
+    if (!as_metrics_enabled()) return (ASMetricInterval){ 0, 0, 0 };
+    return as_metrics_begin_slow(stage);
+}
+
+static inline void as_metrics_end(ASMetricInterval iv) {
+    if (iv.t0) as_metrics_end_slow(iv);
+}
+
+static inline void as_metrics_cache(ASMetricCache cache, int hit) {
+    if (as_metrics_enabled()) as_metrics_cache_slow(cache, hit);
+}
+
+static inline void as_metrics_add(ASMetricCounter counter, uint64_t v) {
+    if (as_metrics_enabled()) as_metrics_add_slow(counter, v);
+}
+
+// MARK: - Export
+
+typedef struct {
+    uint64_t count, totalNs, maxNs;
+    uint64_t buckets[AS_METRIC_BUCKETS];
+} ASMetricHistogram;
+
+typedef struct {
+    ASMetricHistogram stages[AS_STAGE_COUNT];
+    uint64_t cacheHits[AS_CACHE_COUNT], cacheMisses[AS_CACHE_COUNT];
+    uint64_t counters[AS_COUNTER_COUNT];
+    uint64_t elapsedNs;
+    int enabled;
+} ASMetricsSnapshot;
+
+void as_metrics_snapshot(ASMetricsSnapshot *out);
+
+/// 直方图分位数（微秒，桶内线性插值）；p ∈ [0, 1]
+double as_metrics_percentile_us(const ASMetricHistogram *h, double p);
+
+const char *as_metrics_stage_name(ASMetricStage stage);
+const char *as_metrics_cache_name(ASMetricCache cache);
+
+/// 写 JSON 到 buf（以 0 结尾），返回需要的长度（不含 0）；buf 不够时截断，可先传 NULL/0 取长度
+size_t as_metrics_json(const ASMetricsSnapshot *s, char *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASScanMetrics_h */
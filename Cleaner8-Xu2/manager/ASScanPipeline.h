@@ -0,0 +1,36 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 全量扫描流水线
+///
+///   fetch（1 线程，分批取对象）--ring--> decode/特征（N 线程）--ring--> 归类（按原顺序，dispatch_sync 到调用方队列）
+///
+/// 两个有界环形队列提供背压；fetch 最多领先归类 window 张，重排缓冲随之有界。
+/// decode 线程数每 250ms 按核数、热状态、两阶段的实测单张耗时和下游队列深度调整（ASPipelineRing 里的 tuner）。
+/// decode 线程不再 dispatch_sync 回串行队列，不会被分组拖住；归类每批只进一次调用方队列。
+@interface ASScanPipeline : NSObject
+
+/// fetch：按区间取对象（在 fetch 线程调用）；decode：并发调用，返回 nil 表示跳过；
+/// consume：在 queue 上按 fetch 顺序串行调用，只收到 decode 非 nil 的结果
+- (instancetype)initWithCount:(NSUInteger)count
+                        fetch:(NSArray *(^)(NSRange range))fetch
+                       decode:(id _Nullable (^)(id object))decode
+                      consume:(void (^)(id object, id result))consume
+                        queue:(dispatch_queue_t)queue;
+
+/// completion 在归类线程调用（所有 consume 之后），cancelled = 中途取消
+- (void)startWithCompletion:(void (^)(BOOL cancelled))completion;
+- (void)cancel;
+
+/// 之后的工作降为回填：各线程在下一个对象前切到 utility QoS，decode 并发上限减半（不可逆）
+- (void)lowerPriorityForBackfill;
+
+/// fetchItems / decodeItems / decodeMsAvg / decodeWorkers / decodeWorkersMax / thermalState /
+/// groupItems / groupMsAvg / inDepth / inHighWater / outDepth / outHighWater / reorderHighWater /
+/// tunerAdjustments / elapsedMs / assetsPerSec / backfill
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
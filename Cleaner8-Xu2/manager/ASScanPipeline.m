@@ -0,0 +1,323 @@
+#import "ASScanPipeline.h"
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+#import <pthread/qos.h>
+#import "ASPipelineRing.h"
+
+static const uint32_t kASPipelineRingCapacity = 32;
+static const NSUInteger kASPipelineWindow = 96;
+static const NSUInteger kASPipelineFetchBatch = 64;
+static const CFTimeInterval kASPipelineTuneInterval = 0.25;
+
+static inline double ASNowMs(void) { return CACurrentMediaTime() * 1000.0; }
+
+// 回填阶段：当前线程降到 utility（每个线程只降一次）
+static inline void ASLowerQoSIfNeeded(volatile BOOL *backfill, BOOL *lowered) {
+    if (*backfill && !*lowered) {
+        *lowered = YES;
+        pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+    }
+}
+
+@implementation ASScanPipeline {
+    NSUInteger _count;
+    NSArray *(^_fetch)(NSRange);
+    id (^_decode)(id);
+    void (^_consume)(id, id);
+    dispatch_queue_t _queue;
+
+    ASRing *_in;
+    ASRing *_out;
+    dispatch_semaphore_t _window;
+    dispatch_group_t _producers;
+    NSCondition *_park;
+    uint32_t _target;           // _park 保护
+    BOOL _inputClosed;          // _park 保护
+    uint32_t _liveWorkers;      // _park 保护；最后一个退出的关闭 _out
+    volatile BOOL _cancelled;
+    volatile BOOL _backfill;
+
+    os_unfair_lock _statLock;
+    NSUInteger _fetchItems, _decodeItems, _groupItems, _reorderHighWater, _adjustments;
+    uint32_t _targetMax, _thermal;
+    double _decodeMs, _groupMs, _startMs, _endMs;
+}
+
+- (instancetype)initWithCount:(NSUInteger)count
+                        fetch:(NSArray *(^)(NSRange))fetch
+                       decode:(id (^)(id))decode
+                      consume:(void (^)(id, id))consume
+                        queue:(dispatch_queue_t)queue {
+    if (self = [super init]) {
+        _count = count;
+        _fetch = [fetch copy];
+        _decode = [decode copy];
+        _consume = [consume copy];
+        _queue = queue;
+        _in = as_ring_create(kASPipelineRingCapacity);
+        _out = as_ring_create(kASPipelineRingCapacity);
+        // 从 0 开始再补足：取消时令牌不会全部归还，初始值大于 0 的信号量在那种情况下释放会崩
+        _window = dispatch_semaphore_create(0);
+        for (NSUInteger i = 0; i < kASPipelineWindow; i++) dispatch_semaphore_signal(_window);
+        _producers = dispatch_group_create();
+        _park = [NSCondition new];
+        _statLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    as_ring_destroy(_in);
+    as_ring_destroy(_out);
+}
+
+- (void)startWithCompletion:(void (^)(BOOL))completion {
+    _startMs = ASNowMs();
+
+    NSProcessInfo *pi = [NSProcessInfo processInfo];
+    uint32_t cores = (uint32_t)pi.activeProcessorCount;
+    uint32_t ceiling = as_tuner_max_workers(cores, 0);
+    ASTunerInput ti = { .cores = cores, .thermal = (uint32_t)pi.thermalState, .outCapacity = kASPipelineRingCapacity };
+    [self setTarget:as_tuner_target(&ti)];
+    _thermal = ti.thermal;
+
+    dispatch_group_enter(_producers);
+    NSThread *fetch = [[NSThread alloc] initWithBlock:^{ [self runFetch]; dispatch_group_leave(self->_producers); }];
+    fetch.name = @"as.scan.fetch";
+    fetch.qualityOfService = NSQualityOfServiceUserInitiated;
+    [fetch start];
+
+    _liveWorkers = ceiling;
+    for (uint32_t i = 0; i < ceiling; i++) {
+        dispatch_group_enter(_producers);
+        NSThread *w = [[NSThread alloc] initWithBlock:^{ [self runWorker:i]; dispatch_group_leave(self->_producers); }];
+        w.name = [NSString stringWithFormat:@"as.scan.decode.%u", i];
+        w.qualityOfService = NSQualityOfServiceUserInitiated;
+        [w start];
+    }
+
+    void (^done)(BOOL) = [completion copy];
+    NSThread *consumer = [[NSThread alloc] initWithBlock:^{ [self runConsumerWithTuner:ti ceiling:ceiling completion:done]; }];
+    consumer.name = @"as.scan.group";
+    consumer.qualityOfService = NSQualityOfServiceUserInitiated;
+    [consumer start];
+}
+
+- (void)lowerPriorityForBackfill {
+    _backfill = YES;
+}
+
+- (void)cancel {
+    _cancelled = YES;
+    as_ring_close(_in);
+    as_ring_close(_out);
+    [self closeInput];
+}
+
+#pragma mark - Stages
+
+- (void)runFetch {
+    NSUInteger seq = 0;
+    BOOL lowered = NO;
+    for (NSUInteger from = 0; from < _count && !_cancelled; from += kASPipelineFetchBatch) {
+        ASLowerQoSIfNeeded(&_backfill, &lowered);
+        @autoreleasepool {
+            NSArray *batch = _fetch(NSMakeRange(from, MIN(kASPipelineFetchBatch, _count - from)));
+            os_unfair_lock_lock(&_statLock);
+            _fetchItems += batch.count;
+            os_unfair_lock_unlock(&_statLock);
+
+            for (id obj in batch) {
+                // 领先归类太多时等一等（重排缓冲有界）；定时醒来检查取消
+                while (dispatch_semaphore_wait(_window, dispatch_time(DISPATCH_TIME_NOW, 50 * NSEC_PER_MSEC)) != 0) {
+                    if (_cancelled) return;
+                }
+                if (!as_ring_push(_in, (uint32_t)seq, (void *)CFBridgingRetain(obj))) {
+                    CFRelease((__bridge CFTypeRef)obj); // 已关闭：push 没有接手这次 retain
+                    return;
+                }
+                seq++;
+            }
+            if (batch.count < MIN(kASPipelineFetchBatch, _count - from)) break; // 相册在扫描中变小
+        }
+    }
+    as_ring_close(_in);
+    [self closeInput];
+}
+
+- (void)runWorker:(uint32_t)index {
+    uint32_t seq;
+    void *item;
+    BOOL lowered = NO;
+    for (;;) {
+        ASLowerQoSIfNeeded(&_backfill, &lowered);
+        [_park lock];
+        while (index >= _target && !_inputClosed) [_park wait];
+        [_park unlock];
+
+        if (as_ring_pop_many(_in, &seq, &item, 1) == 0) break;
+        id obj = CFBridgingRelease(item);
+        if (_cancelled) break;
+
+        id result = nil;
+        double t0 = ASNowMs();
+        @autoreleasepool {
+            result = _decode(obj);
+        }
+        double ms = ASNowMs() - t0;
+        os_unfair_lock_lock(&_statLock);
+        _decodeItems += 1;
+        _decodeMs += ms;
+        os_unfair_lock_unlock(&_statLock);
+
+        // 结果与对象成对传下去；跳过的也要占位，保证下游能按 seq 连续推进
+        NSArray *pair = result ? @[obj, result] : @[obj];
+        if (!as_ring_push(_out, seq, (void *)CFBridgingRetain(pair))) {
+            CFRelease((__bridge CFTypeRef)pair);
+            break;
+        }
+    }
+
+    [_park lock];
+    BOOL last = (--_liveWorkers == 0);
+    [_park unlock];
+    if (last) as_ring_close(_out);
+}
+
+- (void)runConsumerWithTuner:(ASTunerInput)ti ceiling:(uint32_t)ceiling completion:(void (^)(BOOL))completion {
+    NSMutableDictionary<NSNumber *, NSArray *> *pending = [NSMutableDictionary dictionary];
+    uint32_t next = 0;
+    uint32_t seqs[kASPipelineRingCapacity];
+    void *items[kASPipelineRingCapacity];
+    CFTimeInterval lastTune = CACurrentMediaTime();
+    BOOL lowered = NO;
+
+    for (;;) {
+        ASLowerQoSIfNeeded(&_backfill, &lowered);
+        uint32_t n = as_ring_pop_many(_out, seqs, items, kASPipelineRingCapacity);
+        if (n == 0) break;
+        for (uint32_t i = 0; i < n; i++) pending[@(seqs[i])] = CFBridgingRelease(items[i]);
+
+        NSMutableArray<NSArray *> *run = [NSMutableArray array];
+        NSArray *pair;
+        while ((pair = pending[@(next)])) {
+            [pending removeObjectForKey:@(next)];
+            [run addObject:pair];
+            next++;
+        }
+
+        os_unfair_lock_lock(&_statLock);
+        _reorderHighWater = MAX(_reorderHighWater, pending.count + run.count);
+        os_unfair_lock_unlock(&_statLock);
+
+        if (run.count) {
+            __block double ms = 0;
+            __block NSUInteger consumed = 0;
+            dispatch_sync(_queue, ^{
+                double t0 = ASNowMs();
+                for (NSArray *p in run) {
+                    if (self->_cancelled) break;
+                    @autoreleasepool {
+                        if (p.count == 2) { self->_consume(p[0], p[1]); consumed++; }
+                    }
+                }
+                ms = ASNowMs() - t0;
+            });
+            os_unfair_lock_lock(&_statLock);
+            _groupItems += consumed;
+            _groupMs += ms;
+            os_unfair_lock_unlock(&_statLock);
+            for (NSUInteger i = 0; i < run.count; i++) dispatch_semaphore_signal(_window);
+        }
+        if (_cancelled) break;
+
+        CFTimeInterval now = CACurrentMediaTime();
+        if (now - lastTune >= kASPipelineTuneInterval) {
+            lastTune = now;
+            os_unfair_lock_lock(&_statLock);
+            ti.decodeUs = _decodeItems ? _decodeMs * 1000.0 / _decodeItems : 0;
+            ti.consumeUs = _groupItems ? _groupMs * 1000.0 / _groupItems : 0;
+            os_unfair_lock_unlock(&_statLock);
+            ti.thermal = (uint32_t)[NSProcessInfo processInfo].thermalState;
+            ti.outDepth = as_ring_depth(_out);
+            [_park lock];
+            ti.current = _target;
+            [_park unlock];
+            uint32_t cap = _backfill ? MAX(1u, ceiling / 2) : ceiling;
+            uint32_t t = MIN(as_tuner_target(&ti), cap);
+            if (t != ti.current) [self setTarget:t];
+            os_unfair_lock_lock(&_statLock);
+            _thermal = ti.thermal;
+            os_unfair_lock_unlock(&_statLock);
+        }
+    }
+
+    // 取消：让停放 / 阻塞的线程都退出，再把两个环里剩下的对象释放掉
+    BOOL cancelled = _cancelled;
+    if (cancelled) [self cancel];
+    dispatch_group_wait(_producers, DISPATCH_TIME_FOREVER);
+    ASRing *rings[2] = { _in, _out };
+    for (int k = 0; k < 2; k++) {
+        uint32_t m;
+        while ((m = as_ring_pop_many(rings[k], seqs, items, kASPipelineRingCapacity)) > 0) {
+            for (uint32_t i = 0; i < m; i++) CFRelease(items[i]);
+        }
+    }
+    _endMs = ASNowMs();
+    completion(cancelled);
+}
+
+#pragma mark - Workers
+
+- (void)setTarget:(uint32_t)target {
+    [_park lock];
+    if (_target && target != _target) {
+        os_unfair_lock_lock(&_statLock);
+        _adjustments += 1;
+        os_unfair_lock_unlock(&_statLock);
+    }
+    _target = target;
+    [_park broadcast];
+    [_park unlock];
+
+    os_unfair_lock_lock(&_statLock);
+    _targetMax = MAX(_targetMax, target);
+    os_unfair_lock_unlock(&_statLock);
+}
+
+- (void)closeInput {
+    [_park lock];
+    _inputClosed = YES;
+    [_park broadcast];
+    [_park unlock];
+}
+
+#pragma mark - Stats
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    [_park lock];
+    uint32_t workers = _target;
+    [_park unlock];
+
+    os_unfair_lock_lock(&_statLock);
+    double elapsed = (_endMs > 0 ? _endMs : ASNowMs()) - _startMs;
+    NSDictionary *d = @{
+        @"fetchItems": @(_fetchItems),
+        @"decodeItems": @(_decodeItems), @"decodeMsAvg": @(_decodeItems ? _decodeMs / _decodeItems : 0),
+        @"decodeWorkers": @(workers), @"decodeWorkersMax": @(_targetMax), @"thermalState": @(_thermal),
+        @"groupItems": @(_groupItems), @"groupMsAvg": @(_groupItems ? _groupMs / _groupItems : 0),
+        @"reorderHighWater": @(_reorderHighWater), @"tunerAdjustments": @(_adjustments),
+        @"elapsedMs": @(elapsed), @"assetsPerSec": @(elapsed > 0 ? _groupItems * 1000.0 / elapsed : 0),
+        @"backfill": @(_backfill),
+    };
+    os_unfair_lock_unlock(&_statLock);
+
+    NSMutableDictionary *out = [d mutableCopy];
+    out[@"inDepth"] = @(as_ring_depth(_in));
+    out[@"inHighWater"] = @(as_ring_high_water(_in));
+    out[@"outDepth"] = @(as_ring_depth(_out));
+    out[@"outHighWater"] = @(as_ring_high_water(_out));
+    return out;
+}
+
+@end
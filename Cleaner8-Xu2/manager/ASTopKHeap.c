@@ -0,0 +1,161 @@
+#include "ASTopKHeap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct ASTopKHeap {
+    ASTopKItem *items;
+    uint32_t count, cap;
+    uint32_t *pos;      // id -> 堆下标；AS_TOPK_NONE = 不在堆里
+    uint32_t posCap;
+    uint64_t nextSeq;
+};
+
+// MARK: - Lifecycle
+
+ASTopKHeap *as_topk_create(void) {
+    return calloc(1, sizeof(ASTopKHeap));
+}
+
+void as_topk_destroy(ASTopKHeap *h) {
+    if (!h) return;
+    free(h->items);
+    free(h->pos);
+    free(h);
+}
+
+void as_topk_clear(ASTopKHeap *h) {
+    for (uint32_t i = 0; i < h->count; i++) h->pos[h->items[i].id] = AS_TOPK_NONE;
+    h->count = 0;
+}
+
+uint32_t as_topk_count(const ASTopKHeap *h) { return h->count; }
+
+int as_topk_contains(const ASTopKHeap *h, uint32_t id) {
+    return id < h->posCap && h->pos[id] != AS_TOPK_NONE;
+}
+
+// MARK: - Sift
+
+// 大顶堆序：分数大的在上，同分时后插入的在上
+static inline int as_above(const ASTopKItem *a, const ASTopKItem *b) {
+    return a->score > b->score || (a->score == b->score && a->seq > b->seq);
+}
+
+static inline void as_place(ASTopKHeap *h, uint32_t i, ASTopKItem it) {
+    h->items[i] = it;
+    h->pos[it.id] = i;
+}
+
+static void as_sift_up(ASTopKHeap *h, uint32_t i) {
+    ASTopKItem it = h->items[i];
+    while (i > 0) {
+        uint32_t p = (i - 1) / 2;
+        if (!as_above(&it, &h->items[p])) break;
+        as_place(h, i, h->items[p]);
+        i = p;
+    }
+    as_place(h, i, it);
+}
+
+static void as_sift_down(ASTopKHeap *h, uint32_t i) {
+    ASTopKItem it = h->items[i];
+    for (;;) {
+        uint32_t c = 2 * i + 1;
+        if (c >= h->count) break;
+        if (c + 1 < h->count && as_above(&h->items[c + 1], &h->items[c])) c++;
+        if (!as_above(&h->items[c], &it)) break;
+        as_place(h, i, h->items[c]);
+        i = c;
+    }
+    as_place(h, i, it);
+}
+
+// 删掉下标 i：末尾元素补位后上浮或下沉
+static void as_remove_at(ASTopKHeap *h, uint32_t i) {
+    h->pos[h->items[i].id] = AS_TOPK_NONE;
+    h->count--;
+    if (i == h->count) return;
+    h->items[i] = h->items[h->count];
+    h->pos[h->items[i].id] = i;
+    if (i > 0 && as_above(&h->items[i], &h->items[(i - 1) / 2])) as_sift_up(h, i);
+    else as_sift_down(h, i);
+}
+
+// MARK: - Update
+
+static int as_reserve(ASTopKHeap *h, uint32_t id) {
+    if (id == AS_TOPK_NONE) return 0;
+    if (id >= h->posCap) {
+        uint32_t cap = h->posCap ? h->posCap : 64;
+        while (cap <= id) cap *= 2;
+        uint32_t *p = realloc(h->pos, sizeof(uint32_t) * cap);
+        if (!p) return 0;
+        memset(p + h->posCap, 0xFF, sizeof(uint32_t) * (cap - h->posCap));
+        h->pos = p;
+        h->posCap = cap;
+    }
+    if (h->count == h->cap) {
+        uint32_t cap = h->cap ? h->cap * 2 : 64;
+        ASTopKItem *it = realloc(h->items, sizeof(ASTopKItem) * cap);
+        if (!it) return 0;
+        h->items = it;
+        h->cap = cap;
+    }
+    return 1;
+}
+
+int as_topk_push(ASTopKHeap *h, float score, uint32_t id) {
+    if (as_topk_contains(h, id) || !as_reserve(h, id)) return 0;
+    ASTopKItem it = { score, id, h->nextSeq++ };
+    uint32_t i = h->count++;
+    as_place(h, i, it);
+    as_sift_up(h, i);
+    return 1;
+}
+
+int as_topk_offer(ASTopKHeap *h, float score, uint32_t id, uint32_t k, uint32_t *evicted) {
+    if (evicted) *evicted = AS_TOPK_NONE;
+    if (k == 0 || as_topk_contains(h, id)) return 0;
+    if (h->count >= k) {
+        if (!(score < h->items[0].score)) return 0;
+        if (evicted) *evicted = h->items[0].id;
+        as_remove_at(h, 0);
+    }
+    return as_topk_push(h, score, id);
+}
+
+int as_topk_remove(ASTopKHeap *h, uint32_t id) {
+    if (!as_topk_contains(h, id)) return 0;
+    as_remove_at(h, h->pos[id]);
+    return 1;
+}
+
+int as_topk_peek(const ASTopKHeap *h, ASTopKItem *out) {
+    if (h->count == 0) return 0;
+    *out = h->items[0];
+    return 1;
+}
+
+int as_topk_pop(ASTopKHeap *h, ASTopKItem *out) {
+    if (h->count == 0) return 0;
+    if (out) *out = h->items[0];
+    as_remove_at(h, 0);
+    return 1;
+}
+
+// MARK: - Export
+
+static int as_item_cmp(const void *a, const void *b) {
+    const ASTopKItem *x = a, *y = b;
+    if (as_above(y, x)) return -1;
+    if (as_above(x, y)) return 1;
+    return 0;
+}
+
+uint32_t as_topk_sorted(const ASTopKHeap *h, ASTopKItem *out) {
+    if (h->count == 0) return 0;
+    memcpy(out, h->items, sizeof(ASTopKItem) * h->count);
+    qsort(out, h->count, sizeof(ASTopKItem), as_item_cmp);
+    return h->count;
+}
@@ -0,0 +1,57 @@
+#ifndef ASTopKHeap_h
+#define ASTopKHeap_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 有界 Top-K（分数最小的 K 个）的大顶堆（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 元素是 (score, id)，id 是调用方的紧凑槽位号（可复用）。堆顶是当前「最不糊」的那个：
+/// 满 K 个后只有 score 严格小于堆顶的才能进，进来时挤掉堆顶——与原来升序数组
+/// 「比 lastObject 小才插入，removeLastObject」的准入完全一致。
+/// 同分按插入先后排（后插入的算更大），所以升序导出的顺序也与原数组逐项相同。
+/// 加入 / 挤出 / 按 id 删除都是 O(log K)，只在发布快照时排一次序。
+
+#define AS_TOPK_NONE UINT32_MAX
+
+typedef struct {
+    float score;
+    uint32_t id;
+    uint64_t seq;   // 插入序号
+} ASTopKItem;
+
+typedef struct ASTopKHeap ASTopKHeap;
+
+ASTopKHeap *as_topk_create(void);
+void as_topk_destroy(ASTopKHeap *h);
+void as_topk_clear(ASTopKHeap *h);
+
+uint32_t as_topk_count(const ASTopKHeap *h);
+
+/// 按准入规则加入：不足 k 个直接进；否则 score < 堆顶才进，并挤掉堆顶（只挤一个，与原数组一致）。
+/// 返回 1 = 已加入；*evicted 为被挤掉的 id（没有为 AS_TOPK_NONE）。id 已在堆里时返回 0
+int as_topk_offer(ASTopKHeap *h, float score, uint32_t id, uint32_t k, uint32_t *evicted);
+
+/// 无条件加入（从缓存恢复）；id 已在堆里返回 0
+int as_topk_push(ASTopKHeap *h, float score, uint32_t id);
+
+/// 按 id 删除；不在堆里返回 0
+int as_topk_remove(ASTopKHeap *h, uint32_t id);
+
+int as_topk_contains(const ASTopKHeap *h, uint32_t id);
+
+/// 堆顶（最大）；空时返回 0
+int as_topk_peek(const ASTopKHeap *h, ASTopKItem *out);
+int as_topk_pop(ASTopKHeap *h, ASTopKItem *out);
+
+/// 按 (score, seq) 升序导出到 out（至少 count 个）；返回个数
+uint32_t as_topk_sorted(const ASTopKHeap *h, ASTopKItem *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASTopKHeap_h */
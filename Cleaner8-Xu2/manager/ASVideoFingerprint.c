@@ -0,0 +1,177 @@
+#include "ASVideoFingerprint.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+_Static_assert(sizeof(ASVideoFingerprint) == 208, "fingerprint layout");
+
+#define AS_VFP_LOW 8u   // 取 8×8 低频
+
+static float gCos[AS_VFP_LOW][AS_VFP_HASH_SIDE];
+static pthread_once_t gCosOnce = PTHREAD_ONCE_INIT;
+
+static void as_vfp_init_cos(void) {
+    for (uint32_t u = 0; u < AS_VFP_LOW; u++) {
+        for (uint32_t x = 0; x < AS_VFP_HASH_SIDE; x++) {
+            gCos[u][x] = (float)cos((2.0 * x + 1.0) * u * M_PI / (2.0 * AS_VFP_HASH_SIDE));
+        }
+    }
+}
+
+uint32_t as_vfp_frame_count(float duration) {
+    if (!(duration > 0.f)) return 0;
+    float n = duration / 4.f;
+    if (n < 6.f) return 6;
+    if (n > (float)AS_VFP_MAX_FRAMES) return AS_VFP_MAX_FRAMES;
+    return (uint32_t)n;
+}
+
+void as_vfp_sample_times(float duration, uint32_t n, float *times) {
+    if (n == 0) return;
+    float step = duration / (float)n;
+    for (uint32_t k = 0; k < n; k++) times[k] = ((float)k + 0.5f) * step;
+}
+
+// MARK: - Frame hash
+
+uint64_t as_vfp_frame_hash(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride) {
+    pthread_once(&gCosOnce, as_vfp_init_cos);
+    if (!gray || width == 0 || height == 0) return 0;
+
+    // 面积平均缩到 32×32（源比 32 小时退化为最近邻）
+    float px[AS_VFP_HASH_SIDE][AS_VFP_HASH_SIDE];
+    for (uint32_t oy = 0; oy < AS_VFP_HASH_SIDE; oy++) {
+        uint32_t y0 = oy * height / AS_VFP_HASH_SIDE;
+        uint32_t y1 = (oy + 1) * height / AS_VFP_HASH_SIDE;
+        if (y1 <= y0) y1 = y0 + 1;
+        for (uint32_t ox = 0; ox < AS_VFP_HASH_SIDE; ox++) {
+            uint32_t x0 = ox * width / AS_VFP_HASH_SIDE;
+            uint32_t x1 = (ox + 1) * width / AS_VFP_HASH_SIDE;
+            if (x1 <= x0) x1 = x0 + 1;
+            uint32_t sum = 0;
+            for (uint32_t y = y0; y < y1; y++) {
+                const uint8_t *row = gray + (size_t)y * stride;
+                for (uint32_t x = x0; x < x1; x++) sum += row[x];
+            }
+            px[oy][ox] = (float)sum / (float)((y1 - y0) * (x1 - x0));
+        }
+    }
+
+    // 可分离 DCT-II，只算 8×8 低频
+    float rows[AS_VFP_HASH_SIDE][AS_VFP_LOW];
+    for (uint32_t y = 0; y < AS_VFP_HASH_SIDE; y++) {
+        for (uint32_t u = 0; u < AS_VFP_LOW; u++) {
+            float acc = 0.f;
+            for (uint32_t x = 0; x < AS_VFP_HASH_SIDE; x++) acc += px[y][x] * gCos[u][x];
+            rows[y][u] = acc;
+        }
+    }
+    float coef[AS_VFP_LOW * AS_VFP_LOW];
+    for (uint32_t v = 0; v < AS_VFP_LOW; v++) {
+        for (uint32_t u = 0; u < AS_VFP_LOW; u++) {
+            float acc = 0.f;
+            for (uint32_t y = 0; y < AS_VFP_HASH_SIDE; y++) acc += gCos[v][y] * rows[y][u];
+            coef[v * AS_VFP_LOW + u] = acc;
+        }
+    }
+
+    // 中位数不含 DC（DC 只反映整体亮度）
+    float ac[AS_VFP_LOW * AS_VFP_LOW - 1];
+    memcpy(ac, coef + 1, sizeof(ac));
+    const uint32_t n = AS_VFP_LOW * AS_VFP_LOW - 1;
+    for (uint32_t i = 1; i < n; i++) {
+        float x = ac[i];
+        uint32_t j = i;
+        while (j > 0 && ac[j - 1] > x) { ac[j] = ac[j - 1]; j--; }
+        ac[j] = x;
+    }
+    float median = ac[n / 2];
+
+    uint64_t h = 0;
+    for (uint32_t k = 0; k < AS_VFP_LOW * AS_VFP_LOW; k++) {
+        if (coef[k] > median) h |= 1ull << k;
+    }
+    return h;
+}
+
+int as_vfp_valid(const void *bytes, size_t len) {
+    if (!bytes || len != sizeof(ASVideoFingerprint)) return 0;
+    ASVideoFingerprint f;
+    memcpy(&f, bytes, sizeof(f));
+    return f.version == AS_VFP_VERSION && f.count > 0 && f.count <= AS_VFP_MAX_FRAMES && f.duration >= 0.f;
+}
+
+// MARK: - Alignment
+
+static inline uint32_t as_vfp_nearest(const ASVideoFingerprint *a, float t) {
+    uint32_t best = 0;
+    float bd = fabsf(a->times[0] - t);
+    for (uint32_t i = 1; i < a->count; i++) {
+        float d = fabsf(a->times[i] - t);
+        if (d < bd) { bd = d; best = i; }
+    }
+    return best;
+}
+
+int as_vfp_match(const ASVideoFingerprint *a, const ASVideoFingerprint *b, ASVideoMatch *out) {
+    if (!a->count || !b->count) return 0;
+
+    // A 取较长的那个；偏移最后换回「B 相对 A」
+    float sign = 1.f;
+    if (b->duration > a->duration) {
+        const ASVideoFingerprint *t = a; a = b; b = t;
+        sign = -1.f;
+    }
+
+    float spanA = a->duration / (float)a->count, spanB = b->duration / (float)b->count;
+    float tol = 0.5f * (spanA > spanB ? spanA : spanB) + 1e-3f;
+    uint32_t minPairs = a->count < b->count ? a->count : b->count;
+    if (minPairs > 3) minPairs = 3;
+    float shorter = b->duration > 0.f ? b->duration : 1e-3f;
+
+    int found = 0;
+    ASVideoMatch best = { 65.f, 0.f, 0.f, 0 };
+    uint32_t d[AS_VFP_MAX_FRAMES];
+
+    // 候选偏移：A 的第 i 帧对齐 B 的第 j 帧
+    for (uint32_t i = 0; i < a->count; i++) {
+        for (uint32_t j = 0; j < b->count; j++) {
+            float s = a->times[i] - b->times[j];
+
+            uint32_t m = 0, inside = 0;
+            for (uint32_t k = 0; k < b->count; k++) {
+                float t = b->times[k] + s;
+                if (t < -tol || t > a->duration + tol) continue;
+                inside++;
+                uint32_t n = as_vfp_nearest(a, t);
+                if (fabsf(a->times[n] - t) > tol) continue;
+                d[m++] = (uint32_t)__builtin_popcountll(a->hashes[n] ^ b->hashes[k]);
+            }
+            // 重叠段内多数帧要对上
+            if (m < minPairs || m * 10 < inside * 6) continue;
+
+            for (uint32_t x = 1; x < m; x++) {
+                uint32_t v = d[x], y = x;
+                while (y > 0 && d[y - 1] > v) { d[y] = d[y - 1]; y--; }
+                d[y] = v;
+            }
+            float median = (float)d[(m - 1) / 2];
+
+            float lo = s > 0.f ? s : 0.f;
+            float hi = s + b->duration < a->duration ? s + b->duration : a->duration;
+            float overlap = hi > lo ? (hi - lo) / shorter : 0.f;
+            if (overlap > 1.f) overlap = 1.f;
+
+            if (!found || median < best.distance || (median == best.distance && overlap > best.overlap)) {
+                best.distance = median;
+                best.overlap = overlap;
+                best.offset = s * sign;
+                best.matched = m;
+                found = 1;
+            }
+        }
+    }
+    if (found && out) *out = best;
+    return found;
+}
@@ -0,0 +1,58 @@
+#ifndef ASVideoFingerprint_h
+#define ASVideoFingerprint_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 视频指纹（纯 C，可在 Linux 上编译做校验 / benchmark）
+///
+/// 在 N 个均匀分布的时间点各取一帧低分辨率亮度图，每帧一个 64-bit pHash（32×32 DCT 取 8×8 低频，中位数二值化），
+/// 再加上时长。比较时按时间偏移对齐：枚举「A 的某帧对齐 B 的某帧」得到的偏移，
+/// 取对上的帧对里汉明距离的中位数最小的那个。截掉头尾的副本、重新编码（码率 / 分辨率 / 轻微调色）都能对上，
+/// 单张封面帧 pHash 做不到这一点。
+/// 整个结构体就是持久化格式（小端、定长 208 字节）。
+
+#define AS_VFP_VERSION    1u
+#define AS_VFP_MAX_FRAMES 16u
+#define AS_VFP_HASH_SIDE  32u   // 每帧先缩到 32×32 再做 DCT
+
+typedef struct {
+    uint32_t version;       // AS_VFP_VERSION
+    uint32_t count;         // 实际取到的帧数（<= AS_VFP_MAX_FRAMES）
+    float    duration;      // 秒
+    float    reserved;
+    float    times[AS_VFP_MAX_FRAMES];   // 升序，秒
+    uint64_t hashes[AS_VFP_MAX_FRAMES];
+} ASVideoFingerprint;       // 208 字节
+
+/// 按时长取帧数：约每 4 秒一帧，至少 6 帧、至多 AS_VFP_MAX_FRAMES（短视频也够对齐，长视频解码量封顶）
+uint32_t as_vfp_frame_count(float duration);
+
+/// n 个采样时间点：(k + 0.5) * duration / n，避开首尾黑帧
+void as_vfp_sample_times(float duration, uint32_t n, float *times);
+
+/// 单帧 pHash；gray 为 8-bit 亮度平面（如 420 的 Y），任意尺寸（>= 8×8）
+uint64_t as_vfp_frame_hash(const uint8_t *gray, uint32_t width, uint32_t height, size_t stride);
+
+/// 持久化数据是否是完整的当前版本指纹
+int as_vfp_valid(const void *bytes, size_t len);
+
+typedef struct {
+    float distance;         // 对上的帧对汉明距离（0~64）的中位数
+    float overlap;          // 对齐后重叠时长 / 较短视频时长
+    float offset;           // B 相对 A 的时间偏移（秒）
+    uint32_t matched;       // 对上的帧对数
+} ASVideoMatch;
+
+/// 对齐比较；返回 1 = 找到有效对齐（至少 3 对，且重叠段内多数帧对上），0 = 不可比
+int as_vfp_match(const ASVideoFingerprint *a, const ASVideoFingerprint *b, ASVideoMatch *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASVideoFingerprint_h */
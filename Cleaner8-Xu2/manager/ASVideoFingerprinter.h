@@ -0,0 +1,25 @@
+#import <Foundation/Foundation.h>
+#import <Photos/Photos.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 视频多帧指纹：一个 AVAssetReader 按若干短时间段随机访问，低分辨率解码 Y 平面，
+/// 每段取第一帧算 pHash（见 ASVideoFingerprint.h），加上时长打包成定长 NSData。
+/// 同步调用，只在扫描 decode 线程上用；不走网络（iCloud 上的原片返回 nil，调用方退回封面 pHash）。
+@interface ASVideoFingerprinter : NSObject
+
++ (instancetype)shared;
+
+/// 失败（取不到 AVAsset / 没有视频轨 / 解出的帧少于 3）返回 nil
+- (nullable NSData *)fingerprintForAsset:(PHAsset *)asset imageManager:(PHImageManager *)imageManager;
+
+/// 两个指纹对齐比较；任一无效返回 NO
++ (BOOL)matchFingerprint:(NSData *)a
+                    with:(NSData *)b
+                distance:(float *)distance
+                 overlap:(float *)overlap
+           durationRatio:(float *)durationRatio;
+
+@end
+
+NS_ASSUME_NONNULL_END
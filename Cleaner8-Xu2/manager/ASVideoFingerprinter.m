@@ -0,0 +1,223 @@
+#import "ASVideoFingerprinter.h"
+#import <AVFoundation/AVFoundation.h>
+#import "ASVideoFingerprint.h"
+#import "ASScanMetrics.h"
+
+// 解码宽度（长边）；pHash 只用 32×32，再大没有意义
+static const int kASVFPDecodeSide = 64;
+// 每个采样点读的时间段长度：够拿到一帧，又不会顺带解出太多帧
+static const double kASVFPRangeSeconds = 0.1;
+// 取 AVAsset 的等待上限 / 单个视频解码总预算
+static const double kASVFPAssetTimeout = 2.0;
+static const double kASVFPDecodeBudget = 1.5;
+
+@implementation ASVideoFingerprinter
+
++ (instancetype)shared {
+    static ASVideoFingerprinter *s;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{ s = [ASVideoFingerprinter new]; });
+    return s;
+}
+
+#pragma mark - Decode
+
+// preferredTransform 的旋转（0~3 个 90°），按显示方向算 hash，旋转烧进画面的副本也能对上
+static int ASQuarterTurns(CGAffineTransform t) {
+    double a = atan2(t.b, t.a);
+    long k = lround(a / M_PI_2);
+    return (int)(((k % 4) + 4) % 4);
+}
+
+// Y 平面按显示方向拷贝到 dst（dst 至少 w*h），返回旋转后的宽高
+static void ASCopyRotated(const uint8_t *src, size_t stride, int w, int h, int turns,
+                          uint8_t *dst, int *outW, int *outH) {
+    int ow = (turns & 1) ? h : w, oh = (turns & 1) ? w : h;
+    for (int y = 0; y < h; y++) {
+        const uint8_t *row = src + (size_t)y * stride;
+        for (int x = 0; x < w; x++) {
+            int dx, dy;
+            switch (turns) {
+                case 1:  dx = h - 1 - y; dy = x;         break;
+                case 2:  dx = w - 1 - x; dy = h - 1 - y; break;
+                case 3:  dx = y;         dy = w - 1 - x; break;
+                default: dx = x;         dy = y;         break;
+            }
+            dst[dy * ow + dx] = row[x];
+        }
+    }
+    *outW = ow;
+    *outH = oh;
+}
+
+- (AVAsset *)as_avAssetForAsset:(PHAsset *)asset imageManager:(PHImageManager *)imageManager {
+    __block AVAsset *out = nil;
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    PHVideoRequestOptions *opt = [PHVideoRequestOptions new];
+    opt.networkAccessAllowed = NO;
+    opt.deliveryMode = PHVideoRequestOptionsDeliveryModeFastFormat;
+    opt.version = PHVideoRequestOptionsVersionCurrent;
+    // 回调里只拿 AVAsset，解码在调用线程上做，不占 Photos 的回调队列
+    PHImageRequestID rid = [imageManager requestAVAssetForVideo:asset options:opt resultHandler:^(AVAsset * _Nullable avAsset, AVAudioMix * _Nullable audioMix, NSDictionary * _Nullable info) {
+        out = avAsset;
+        dispatch_semaphore_signal(sema);
+    }];
+    if (dispatch_semaphore_wait(sema, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kASVFPAssetTimeout * NSEC_PER_SEC))) != 0) {
+        [imageManager cancelImageRequest:rid];
+        return nil;
+    }
+    return out;
+}
+
+- (NSData *)fingerprintForAsset:(PHAsset *)asset imageManager:(PHImageManager *)imageManager {
+    if (asset.mediaType != PHAssetMediaTypeVideo) return nil;
+    ASMetricInterval iv = as_metrics_begin(AS_STAGE_VIDEO_FINGERPRINT);
+    NSData *out = nil;
+    @autoreleasepool {
+        out = [self as_fingerprintForAsset:asset imageManager:imageManager];
+    }
+    as_metrics_end(iv);
+    return out;
+}
+
+- (NSData *)as_fingerprintForAsset:(PHAsset *)asset imageManager:(PHImageManager *)imageManager {
+    AVAsset *avAsset = [self as_avAssetForAsset:asset imageManager:imageManager];
+    if (!avAsset) return nil;
+    AVAssetTrack *track = [avAsset tracksWithMediaType:AVMediaTypeVideo].firstObject;
+    if (!track) return nil;
+
+    double duration = CMTimeGetSeconds(avAsset.duration);
+    if (!(duration > 0)) duration = asset.duration;
+    uint32_t n = as_vfp_frame_count((float)duration);
+    if (n == 0) return nil;
+
+    ASVideoFingerprint fp;
+    memset(&fp, 0, sizeof(fp));
+    fp.version = AS_VFP_VERSION;
+    fp.duration = (float)duration;
+    float times[AS_VFP_MAX_FRAMES];
+    as_vfp_sample_times(fp.duration, n, times);
+
+    // 按长边 kASVFPDecodeSide 缩放解码，只要 Y 平面
+    CGSize nat = track.naturalSize;
+    if (nat.width <= 0 || nat.height <= 0) return nil;
+    double scale = kASVFPDecodeSide / MAX(nat.width, nat.height);
+    int dw = MAX(16, (int)lround(nat.width * scale)) & ~1;
+    int dh = MAX(16, (int)lround(nat.height * scale)) & ~1;
+    NSDictionary *settings = @{
+        (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_420YpCbCr8BiPlanarFullRange),
+        (id)kCVPixelBufferWidthKey: @(dw),
+        (id)kCVPixelBufferHeightKey: @(dh),
+    };
+
+    NSError *err = nil;
+    AVAssetReader *reader = [[AVAssetReader alloc] initWithAsset:avAsset error:&err];
+    if (!reader || err) return nil;
+    AVAssetReaderTrackOutput *output = [[AVAssetReaderTrackOutput alloc] initWithTrack:track outputSettings:settings];
+    output.alwaysCopiesSampleData = NO;
+    // 一个 reader 依次读 n 个短时间段，不为每个采样点各建一次解码会话
+    output.supportsRandomAccess = YES;
+    if (![reader canAddOutput:output]) return nil;
+    [reader addOutput:output];
+
+    // resetForReadingTimeRanges 要求各段升序且不重叠（否则抛异常）：在 1/600 秒的整数刻度上算，
+    // 每段截到下一段起点为止；不到 0.6 秒的短片段长随之变短，短到一个刻度都不剩就不做指纹
+    const int32_t scale600 = 600;
+    int64_t starts[AS_VFP_MAX_FRAMES], lens[AS_VFP_MAX_FRAMES];
+    const int64_t maxLen = (int64_t)llround(kASVFPRangeSeconds * scale600);
+    const int64_t endTick = (int64_t)floor(duration * scale600);
+    for (uint32_t k = 0; k < n; k++) starts[k] = (int64_t)llround(times[k] * scale600);
+    for (uint32_t k = 0; k < n; k++) {
+        int64_t limit = (k + 1 < n ? starts[k + 1] : endTick) - starts[k];
+        lens[k] = MIN(maxLen, limit);
+        if (lens[k] < 1) return nil;
+    }
+
+    reader.timeRange = CMTimeRangeMake(CMTimeMake(starts[0], scale600), CMTimeMake(lens[0], scale600));
+    if (![reader startReading]) return nil;
+
+    int turns = ASQuarterTurns(track.preferredTransform);
+    uint8_t *rot = malloc((size_t)(kASVFPDecodeSide + 2) * (kASVFPDecodeSide + 2));
+    double t0 = CACurrentMediaTime();
+    uint32_t got = 0;
+
+    for (uint32_t k = 0; k < n; k++) {
+        if (k > 0) {
+            if (CACurrentMediaTime() - t0 > kASVFPDecodeBudget) break;
+            CMTimeRange r = CMTimeRangeMake(CMTimeMake(starts[k], scale600), CMTimeMake(lens[k], scale600));
+            [output resetForReadingTimeRanges:@[[NSValue valueWithCMTimeRange:r]]];
+        }
+        BOOL taken = NO;
+        CMSampleBufferRef sb;
+        // 段内第一帧算 hash，其余读空（reset 之前必须读到 NULL）
+        while ((sb = [output copyNextSampleBuffer])) {
+            CVImageBufferRef pb = taken ? NULL : CMSampleBufferGetImageBuffer(sb);
+            if (pb && CVPixelBufferLockBaseAddress(pb, kCVPixelBufferLock_ReadOnly) == kCVReturnSuccess) {
+                const uint8_t *y = CVPixelBufferGetBaseAddressOfPlane(pb, 0);
+                int w = (int)CVPixelBufferGetWidthOfPlane(pb, 0);
+                int h = (int)CVPixelBufferGetHeightOfPlane(pb, 0);
+                size_t stride = CVPixelBufferGetBytesPerRowOfPlane(pb, 0);
+                if (y && w > 0 && h > 0) {
+                    uint64_t hash;
+                    if (turns == 0 || w > kASVFPDecodeSide + 2 || h > kASVFPDecodeSide + 2 || !rot) {
+                        hash = as_vfp_frame_hash(y, (uint32_t)w, (uint32_t)h, stride);
+                    } else {
+                        int rw, rh;
+                        ASCopyRotated(y, stride, w, h, turns, rot, &rw, &rh);
+                        hash = as_vfp_frame_hash(rot, (uint32_t)rw, (uint32_t)rh, (size_t)rw);
+                    }
+                    double pts = CMTimeGetSeconds(CMSampleBufferGetPresentationTimeStamp(sb));
+                    fp.times[got] = isfinite(pts) ? (float)pts : times[k];
+                    fp.hashes[got] = hash;
+                    got++;
+                    taken = YES;
+                }
+                CVPixelBufferUnlockBaseAddress(pb, kCVPixelBufferLock_ReadOnly);
+            }
+            CFRelease(sb);
+        }
+        if (reader.status == AVAssetReaderStatusFailed) break;
+    }
+    [reader cancelReading];
+    free(rot);
+
+    as_metrics_add(AS_COUNTER_VIDEOS, 1);
+    as_metrics_add(AS_COUNTER_VIDEO_FRAMES, got);
+    if (got < 3) return nil;
+
+    // 实际帧时间须升序（关键帧附近可能落到同一帧）
+    uint32_t m = 1;
+    for (uint32_t i = 1; i < got; i++) {
+        if (fp.times[i] <= fp.times[m - 1]) continue;
+        fp.times[m] = fp.times[i];
+        fp.hashes[m] = fp.hashes[i];
+        m++;
+    }
+    if (m < 3) return nil;
+    fp.count = m;
+    return [NSData dataWithBytes:&fp length:sizeof(fp)];
+}
+
+#pragma mark - Match
+
++ (BOOL)matchFingerprint:(NSData *)a
+                    with:(NSData *)b
+                distance:(float *)distance
+                 overlap:(float *)overlap
+           durationRatio:(float *)durationRatio {
+    if (!as_vfp_valid(a.bytes, a.length) || !as_vfp_valid(b.bytes, b.length)) return NO;
+    ASVideoFingerprint fa, fb;
+    memcpy(&fa, a.bytes, sizeof(fa));
+    memcpy(&fb, b.bytes, sizeof(fb));
+    ASVideoMatch m;
+    if (!as_vfp_match(&fa, &fb, &m)) return NO;
+    if (distance) *distance = m.distance;
+    if (overlap) *overlap = m.overlap;
+    if (durationRatio) {
+        float lo = MIN(fa.duration, fb.duration), hi = MAX(fa.duration, fb.duration);
+        *durationRatio = hi > 0 ? lo / hi : 1.f;
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,324 @@
+#include "CMBackupFormat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t live;
+    int64_t  dateMs;
+    uint64_t liveBytes;
+    uint64_t deadBytes;
+    uint32_t idLen;
+    uint32_t nameLen;
+    uint64_t tableOff;
+    uint64_t reserved;
+} CMBkHeader;               // 64 字节
+
+typedef struct {
+    uint64_t off;
+    uint32_t storedLen;
+    uint32_t rawLen;
+    uint32_t flags;
+    uint32_t checksum;
+} CMBkEntry;                // 24 字节
+
+_Static_assert(sizeof(CMBkHeader) == CM_BK_HEADER_BYTES, "header layout");
+_Static_assert(sizeof(CMBkEntry) == 24, "entry layout");
+
+#define CM_BK_MAX_STR 4096u
+
+static inline size_t cm_align8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+static uint32_t cm_bk_checksum(const void *bytes, size_t len) {
+    const uint8_t *p = (const uint8_t *)bytes;
+    uint64_t h = 0xCBF29CE484222325ull;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h ^= w;
+        h *= 0x100000001B3ull;
+    }
+    for (; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+// MARK: - Header
+
+static int cm_bk_load_header(const void *bytes, size_t len, CMBkHeader *h) {
+    if (!bytes || len < sizeof(CMBkHeader)) return 0;
+    memcpy(h, bytes, sizeof(CMBkHeader));
+    if (h->magic != CM_BK_MAGIC || h->version != CM_BK_VERSION) return 0;
+    if (h->idLen > CM_BK_MAX_STR || h->nameLen > CM_BK_MAX_STR || h->live > h->count) return 0;
+    if (h->tableOff != sizeof(CMBkHeader) + cm_align8(h->idLen) + cm_align8(h->nameLen)) return 0;
+    return 1;
+}
+
+size_t cm_bk_meta_len(const void *bytes, size_t len) {
+    CMBkHeader h;
+    return cm_bk_load_header(bytes, len, &h) ? (size_t)h.tableOff : 0;
+}
+
+size_t cm_bk_head_len(const void *bytes, size_t len) {
+    CMBkHeader h;
+    return cm_bk_load_header(bytes, len, &h) ? (size_t)h.tableOff + (size_t)h.count * sizeof(CMBkEntry) : 0;
+}
+
+static void cm_bk_fill_header(const uint8_t *bytes, const CMBkHeader *h, CMBackupHeader *out) {
+    out->count = h->count;
+    out->live = h->live;
+    out->dateMs = h->dateMs;
+    out->liveBytes = h->liveBytes;
+    out->deadBytes = h->deadBytes;
+    out->backupId = (const char *)bytes + sizeof(CMBkHeader);
+    out->idLen = h->idLen;
+    out->name = (const char *)bytes + sizeof(CMBkHeader) + cm_align8(h->idLen);
+    out->nameLen = h->nameLen;
+    out->metaLen = (size_t)h->tableOff;
+    out->headLen = (size_t)h->tableOff + (size_t)h->count * sizeof(CMBkEntry);
+}
+
+int cm_bk_read_header(const void *bytes, size_t len, CMBackupHeader *out) {
+    CMBkHeader h;
+    if (!cm_bk_load_header(bytes, len, &h) || len < h.tableOff) return 0;
+    cm_bk_fill_header((const uint8_t *)bytes, &h, out);
+    return 1;
+}
+
+// MARK: - Writer
+
+struct CMBackupWriter {
+    CMBkEntry *entries;     // off 为相对记录区的偏移
+    uint32_t count, cap;
+    uint8_t *data;
+    size_t dataLen, dataCap;
+};
+
+CMBackupWriter *cm_bk_writer_create(void) {
+    return calloc(1, sizeof(CMBackupWriter));
+}
+
+void cm_bk_writer_destroy(CMBackupWriter *w) {
+    if (!w) return;
+    free(w->entries);
+    free(w->data);
+    free(w);
+}
+
+uint32_t cm_bk_writer_count(const CMBackupWriter *w) { return w->count; }
+
+int cm_bk_writer_add(CMBackupWriter *w, const void *stored, uint32_t storedLen, uint32_t rawLen, uint32_t flags) {
+    if (w->count == UINT32_MAX) return 0;
+    if (w->count == w->cap) {
+        uint32_t cap = w->cap ? w->cap * 2 : 64;
+        CMBkEntry *e = realloc(w->entries, sizeof(CMBkEntry) * cap);
+        if (!e) return 0;
+        w->entries = e;
+        w->cap = cap;
+    }
+    if (w->dataLen + storedLen > w->dataCap) {
+        size_t cap = w->dataCap ? w->dataCap : 16384;
+        while (cap < w->dataLen + storedLen) cap *= 2;
+        uint8_t *d = realloc(w->data, cap);
+        if (!d) return 0;
+        w->data = d;
+        w->dataCap = cap;
+    }
+    if (storedLen) memcpy(w->data + w->dataLen, stored, storedLen);
+    w->entries[w->count++] = (CMBkEntry){
+        .off = w->dataLen,
+        .storedLen = storedLen,
+        .rawLen = rawLen,
+        .flags = flags & CM_BK_COMPRESSED,
+        .checksum = cm_bk_checksum(stored, storedLen),
+    };
+    w->dataLen += storedLen;
+    return 1;
+}
+
+// 记录区紧跟表；entries 的 off 相对记录区
+static int cm_bk_emit(const CMBkEntry *entries, uint32_t count, const uint8_t *const *recordBase,
+                      const char *backupId, uint32_t idLen, const char *name, uint32_t nameLen, int64_t dateMs,
+                      uint8_t **out, size_t *outLen) {
+    if (idLen > CM_BK_MAX_STR || nameLen > CM_BK_MAX_STR) return 0;
+    size_t tableOff = sizeof(CMBkHeader) + cm_align8(idLen) + cm_align8(nameLen);
+    size_t dataOff = tableOff + (size_t)count * sizeof(CMBkEntry);
+    size_t dataLen = 0;
+    for (uint32_t i = 0; i < count; i++) dataLen += entries[i].storedLen;
+
+    uint8_t *buf = calloc(1, dataOff + dataLen);
+    if (!buf) return 0;
+
+    CMBkHeader h = {
+        .magic = CM_BK_MAGIC, .version = CM_BK_VERSION,
+        .count = count, .live = count, .dateMs = dateMs,
+        .liveBytes = dataLen, .deadBytes = 0,
+        .idLen = idLen, .nameLen = nameLen, .tableOff = tableOff,
+    };
+    memcpy(buf, &h, sizeof(h));
+    if (idLen) memcpy(buf + sizeof(CMBkHeader), backupId, idLen);
+    if (nameLen) memcpy(buf + sizeof(CMBkHeader) + cm_align8(idLen), name, nameLen);
+
+    size_t at = dataOff;
+    for (uint32_t i = 0; i < count; i++) {
+        CMBkEntry e = entries[i];
+        memcpy(buf + at, recordBase[i] + e.off, e.storedLen);
+        e.off = at;
+        e.flags &= CM_BK_COMPRESSED;
+        memcpy(buf + tableOff + (size_t)i * sizeof(CMBkEntry), &e, sizeof(e));
+        at += e.storedLen;
+    }
+    *out = buf;
+    *outLen = dataOff + dataLen;
+    return 1;
+}
+
+int cm_bk_writer_finish(const CMBackupWriter *w,
+                        const char *backupId, uint32_t idLen,
+                        const char *name, uint32_t nameLen,
+                        int64_t dateMs,
+                        uint8_t **out, size_t *outLen) {
+    const uint8_t **bases = malloc(sizeof(uint8_t *) * (w->count ? w->count : 1));
+    if (!bases) return 0;
+    for (uint32_t i = 0; i < w->count; i++) bases[i] = w->data;
+    int ok = cm_bk_emit(w->entries, w->count, bases, backupId, idLen, name, nameLen, dateMs, out, outLen);
+    free(bases);
+    return ok;
+}
+
+// MARK: - View
+
+struct CMBackupView {
+    const uint8_t *bytes;
+    size_t len;
+    CMBackupHeader header;
+    const uint8_t *table;
+    uint32_t *slots;        // 活下标 -> 表项号
+    uint32_t live;
+};
+
+static inline CMBkEntry cm_bk_entry(const uint8_t *table, uint32_t slot) {
+    CMBkEntry e;
+    memcpy(&e, table + (size_t)slot * sizeof(CMBkEntry), sizeof(e));
+    return e;
+}
+
+CMBackupView *cm_bk_open(const void *bytes, size_t len) {
+    CMBkHeader h;
+    if (!cm_bk_load_header(bytes, len, &h)) return NULL;
+    if (h.tableOff > len || h.count > (len - h.tableOff) / sizeof(CMBkEntry)) return NULL;
+    size_t headLen = (size_t)h.tableOff + (size_t)h.count * sizeof(CMBkEntry);
+
+    CMBackupView *v = calloc(1, sizeof(CMBackupView));
+    if (!v) return NULL;
+    v->slots = malloc(sizeof(uint32_t) * (h.count ? h.count : 1));
+    if (!v->slots) { free(v); return NULL; }
+    v->bytes = (const uint8_t *)bytes;
+    v->len = len;
+    v->table = v->bytes + h.tableOff;
+    cm_bk_fill_header(v->bytes, &h, &v->header);
+
+    uint64_t liveBytes = 0, deadBytes = 0;
+    for (uint32_t i = 0; i < h.count; i++) {
+        CMBkEntry e = cm_bk_entry(v->table, i);
+        if (e.off < headLen || e.off > len || e.storedLen > len - e.off) { cm_bk_close(v); return NULL; }
+        if (e.flags & CM_BK_DELETED) { deadBytes += e.storedLen; continue; }
+        v->slots[v->live++] = i;
+        liveBytes += e.storedLen;
+    }
+    if (v->live != h.live || liveBytes != h.liveBytes || deadBytes != h.deadBytes) { cm_bk_close(v); return NULL; }
+    return v;
+}
+
+void cm_bk_close(CMBackupView *v) {
+    if (!v) return;
+    free(v->slots);
+    free(v);
+}
+
+const CMBackupHeader *cm_bk_header(const CMBackupView *v) { return &v->header; }
+uint32_t cm_bk_live_count(const CMBackupView *v) { return v->live; }
+
+uint32_t cm_bk_slot(const CMBackupView *v, uint32_t liveIndex) {
+    return liveIndex < v->live ? v->slots[liveIndex] : UINT32_MAX;
+}
+
+int cm_bk_get(const CMBackupView *v, uint32_t liveIndex, CMBackupRecord *out) {
+    if (liveIndex >= v->live) return 0;
+    CMBkEntry e = cm_bk_entry(v->table, v->slots[liveIndex]);
+    const uint8_t *p = v->bytes + e.off;
+    if (cm_bk_checksum(p, e.storedLen) != e.checksum) return 0;
+    out->bytes = p;
+    out->storedLen = e.storedLen;
+    out->rawLen = e.rawLen;
+    out->flags = e.flags & CM_BK_COMPRESSED;
+    return 1;
+}
+
+// MARK: - Delete / compact
+
+static int cm_u32_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y);
+}
+
+uint32_t cm_bk_delete(uint8_t *head, size_t headLen, const uint32_t *liveIndices, uint32_t n) {
+    CMBkHeader h;
+    if (!cm_bk_load_header(head, headLen, &h) || n == 0) return 0;
+    if (headLen < (size_t)h.tableOff + (size_t)h.count * sizeof(CMBkEntry)) return 0;
+
+    uint32_t *want = malloc(sizeof(uint32_t) * n);
+    if (!want) return 0;
+    memcpy(want, liveIndices, sizeof(uint32_t) * n);
+    qsort(want, n, sizeof(uint32_t), cm_u32_cmp);
+
+    // 一遍扫表：活下标按顺序对上即打墓碑（下标都是删除前的编号）
+    uint8_t *table = head + h.tableOff;
+    uint32_t liveIdx = 0, k = 0, removed = 0;
+    for (uint32_t slot = 0; slot < h.count && k < n; slot++) {
+        CMBkEntry e = cm_bk_entry(table, slot);
+        if (e.flags & CM_BK_DELETED) continue;
+        while (k < n && want[k] < liveIdx) k++;
+        if (k < n && want[k] == liveIdx) {
+            e.flags |= CM_BK_DELETED;
+            memcpy(table + (size_t)slot * sizeof(CMBkEntry), &e, sizeof(e));
+            h.live -= 1;
+            h.liveBytes -= e.storedLen;
+            h.deadBytes += e.storedLen;
+            removed++;
+            while (k < n && want[k] == liveIdx) k++;
+        }
+        liveIdx++;
+    }
+    free(want);
+    memcpy(head, &h, sizeof(h));
+    return removed;
+}
+
+int cm_bk_should_compact(const CMBackupView *v, uint64_t minBytes) {
+    return v->header.deadBytes > v->header.liveBytes && v->header.deadBytes + v->header.liveBytes > minBytes;
+}
+
+int cm_bk_compact(const CMBackupView *v, uint8_t **out, size_t *outLen) {
+    uint32_t n = v->live;
+    CMBkEntry *entries = malloc(sizeof(CMBkEntry) * (n ? n : 1));
+    const uint8_t **bases = malloc(sizeof(uint8_t *) * (n ? n : 1));
+    int ok = 0;
+    if (entries && bases) {
+        for (uint32_t i = 0; i < n; i++) {
+            entries[i] = cm_bk_entry(v->table, v->slots[i]);
+            bases[i] = v->bytes;
+        }
+        ok = cm_bk_emit(entries, n, bases, v->header.backupId, v->header.idLen,
+                        v->header.name, v->header.nameLen, v->header.dateMs, out, outLen);
+    }
+    free(entries);
+    free(bases);
+    return ok;
+}
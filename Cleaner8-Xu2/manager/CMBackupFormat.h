@@ -0,0 +1,104 @@
+#ifndef CMBackupFormat_h
+#define CMBackupFormat_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 联系人备份容器（纯 C，可在 Linux 上编译做 benchmark）
+///
+///   Header(64) | backupId | name | Table(count × 24) | 记录...
+///
+/// - Header：元数据 + 条数，列表只需读开头几十字节，不碰记录
+/// - Table：每条 {偏移, 存储长度, 原始长度, flags, 校验}；一条记录 = 一个联系人的 vCard（可选压缩，压缩由调用方做）
+/// - 删除只在表里打墓碑并更新 Header（「头部」= Header + 字符串 + 表，连续放在文件开头），
+///   记录字节不动；头部写到文件副本上再整体替换，不原地覆盖（写一半 Header 与表对不上，打开会判损坏）；
+///   死字节超过活字节时整体压缩成只含活记录的新文件
+/// 对外的下标都是「活下标」：跳过墓碑后的第几条，与列表里看到的顺序一致。
+/// 小端；打开时校验全部偏移 / 长度，损坏文件返回 NULL 而不是越界。非线程安全。
+
+#define CM_BK_MAGIC        0x4B424D43u  // "CMBK"
+#define CM_BK_VERSION      1u
+#define CM_BK_HEADER_BYTES 64u
+
+enum {
+    CM_BK_COMPRESSED = 1u << 0,     // 存储的是压缩后的字节，rawLen 为解压后长度
+    CM_BK_DELETED    = 1u << 15,
+};
+
+typedef struct {
+    uint32_t count;             // 表项数（含墓碑）
+    uint32_t live;
+    int64_t dateMs;
+    uint64_t liveBytes, deadBytes;  // 记录存储字节
+    const char *backupId;       // UTF-8，指向传入的内存，不以 0 结尾
+    uint32_t idLen;
+    const char *name;
+    uint32_t nameLen;
+    size_t metaLen;             // Header + 字符串
+    size_t headLen;             // Header + 字符串 + 表
+} CMBackupHeader;
+
+/// 从开头至少 CM_BK_HEADER_BYTES 字节判断：不是容器 / 版本不符返回 0
+size_t cm_bk_meta_len(const void *bytes, size_t len);
+size_t cm_bk_head_len(const void *bytes, size_t len);
+
+/// 只读元数据（列表用）：len 须 >= cm_bk_meta_len；成功返回 1
+int cm_bk_read_header(const void *bytes, size_t len, CMBackupHeader *out);
+
+// MARK: - 写
+
+typedef struct CMBackupWriter CMBackupWriter;
+
+CMBackupWriter *cm_bk_writer_create(void);
+void cm_bk_writer_destroy(CMBackupWriter *w);
+/// 追加一条（字节被复制）；flags 只认 CM_BK_COMPRESSED
+int cm_bk_writer_add(CMBackupWriter *w, const void *stored, uint32_t storedLen, uint32_t rawLen, uint32_t flags);
+uint32_t cm_bk_writer_count(const CMBackupWriter *w);
+/// 生成整个文件（malloc，调用方 free）
+int cm_bk_writer_finish(const CMBackupWriter *w,
+                        const char *backupId, uint32_t idLen,
+                        const char *name, uint32_t nameLen,
+                        int64_t dateMs,
+                        uint8_t **out, size_t *outLen);
+
+// MARK: - 读
+
+typedef struct CMBackupView CMBackupView;
+
+typedef struct {
+    const void *bytes;          // 指向传入的内存
+    uint32_t storedLen;
+    uint32_t rawLen;
+    uint32_t flags;
+} CMBackupRecord;
+
+/// bytes 为整个文件（可以是 mmap），须在 view 销毁前有效
+CMBackupView *cm_bk_open(const void *bytes, size_t len);
+void cm_bk_close(CMBackupView *v);
+const CMBackupHeader *cm_bk_header(const CMBackupView *v);
+uint32_t cm_bk_live_count(const CMBackupView *v);
+/// 按活下标取记录；越界或校验不符返回 0
+int cm_bk_get(const CMBackupView *v, uint32_t liveIndex, CMBackupRecord *out);
+/// 活下标对应的表项号（墓碑不计）；越界返回 UINT32_MAX
+uint32_t cm_bk_slot(const CMBackupView *v, uint32_t liveIndex);
+
+// MARK: - 删除 / 压缩
+
+/// head：文件开头 headLen 字节的可写副本。按活下标打墓碑并更新 Header，重复 / 越界的下标忽略。
+/// 返回实际删除条数；之后把 head 写到文件副本的偏移 0，落盘后替换原文件
+uint32_t cm_bk_delete(uint8_t *head, size_t headLen, const uint32_t *liveIndices, uint32_t n);
+
+/// 死字节超过活字节且总量超过 minBytes 时建议压缩
+int cm_bk_should_compact(const CMBackupView *v, uint64_t minBytes);
+/// 只含活记录的新文件（malloc，调用方 free），元数据不变
+int cm_bk_compact(const CMBackupView *v, uint8_t **out, size_t *outLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMBackupFormat_h */
@@ -0,0 +1,394 @@
+#include "CMContactCluster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t key;
+    uint32_t kind;
+    uint32_t row;
+} CMKeyRec;
+
+typedef struct {
+    uint32_t a, b;
+} CMPairRec;
+
+typedef struct {
+    uint64_t block;
+    uint32_t order;     // 块内排序：块小时按长度，块大时按字典序名次
+    uint32_t row;
+} CMBlockRec;
+
+struct CMCluster {
+    uint32_t count, cap;
+    uint32_t *nameOff;      // 模糊串在 pool 里的起点
+    uint8_t *nameLen;
+    uint16_t *pool;
+    uint32_t poolLen, poolCap;
+
+    CMKeyRec *keys;
+    uint32_t keyCount, keyCap;
+
+    uint32_t *parent, *size;
+    uint8_t *reason;
+
+    CMPairRec *pairs;
+    uint32_t pairCount, pairCap;
+
+    CMClusterStats stats;
+};
+
+// MARK: - Lifecycle
+
+void cm_cluster_default_params(CMClusterParams *p) {
+    p->minFuzzyLen = 5;
+    p->maxDistShort = 1;
+    p->maxDistLong = 2;
+    p->longLen = 10;
+    p->blockLen = 3;
+    p->maxBlock = 64;
+    p->window = 12;
+}
+
+CMCluster *cm_cluster_create(void) {
+    return calloc(1, sizeof(CMCluster));
+}
+
+void cm_cluster_destroy(CMCluster *c) {
+    if (!c) return;
+    free(c->nameOff); free(c->nameLen); free(c->pool);
+    free(c->keys);
+    free(c->parent); free(c->size); free(c->reason);
+    free(c->pairs);
+    free(c);
+}
+
+static int cm_grow(void **p, uint32_t *cap, uint32_t need, size_t elem) {
+    if (need <= *cap) return 1;
+    uint32_t n = *cap ? *cap : 256;
+    while (n < need) n *= 2;
+    void *q = realloc(*p, elem * n);
+    if (!q) return 0;
+    *p = q;
+    *cap = n;
+    return 1;
+}
+
+uint32_t cm_cluster_add(CMCluster *c, const uint16_t *fuzzyName, uint32_t len) {
+    if (!fuzzyName) len = 0;
+    if (len > CM_CLUSTER_FUZZY_MAX) len = CM_CLUSTER_FUZZY_MAX;
+
+    if (c->count == c->cap) {
+        uint32_t cap = c->cap ? c->cap * 2 : 256;
+        uint32_t *off = realloc(c->nameOff, sizeof(uint32_t) * cap);
+        if (!off) return UINT32_MAX;
+        c->nameOff = off;
+        uint8_t *ln = realloc(c->nameLen, cap);
+        if (!ln) return UINT32_MAX;
+        c->nameLen = ln;
+        c->cap = cap;
+    }
+    if (!cm_grow((void **)&c->pool, &c->poolCap, c->poolLen + len, sizeof(uint16_t))) return UINT32_MAX;
+
+    uint32_t row = c->count++;
+    c->nameOff[row] = c->poolLen;
+    c->nameLen[row] = (uint8_t)len;
+    if (len) memcpy(c->pool + c->poolLen, fuzzyName, sizeof(uint16_t) * len);
+    c->poolLen += len;
+    return row;
+}
+
+void cm_cluster_add_key(CMCluster *c, uint32_t row, CMClusterKeyKind kind, uint64_t key) {
+    if (row >= c->count) return;
+    if (!cm_grow((void **)&c->keys, &c->keyCap, c->keyCount + 1, sizeof(CMKeyRec))) return;
+    c->keys[c->keyCount++] = (CMKeyRec){ key, (uint32_t)kind, row };
+}
+
+uint32_t cm_cluster_count(const CMCluster *c) { return c->count; }
+
+// MARK: - Union-find
+
+uint32_t cm_cluster_find(CMCluster *c, uint32_t x) {
+    while (c->parent[x] != x) {
+        c->parent[x] = c->parent[c->parent[x]];
+        x = c->parent[x];
+    }
+    return x;
+}
+
+static int cm_union(CMCluster *c, uint32_t a, uint32_t b, uint8_t why) {
+    a = cm_cluster_find(c, a);
+    b = cm_cluster_find(c, b);
+    if (a == b) {
+        c->reason[a] |= why;
+        return 0;
+    }
+    if (c->size[a] < c->size[b]) { uint32_t t = a; a = b; b = t; }
+    c->parent[b] = a;
+    c->size[a] += c->size[b];
+    c->reason[a] |= c->reason[b] | why;
+    return 1;
+}
+
+uint32_t cm_cluster_reasons(CMCluster *c, uint32_t row) {
+    return c->reason[cm_cluster_find(c, row)];
+}
+
+// MARK: - Edit distance
+
+uint32_t cm_edit_distance_bounded(const uint16_t *a, uint32_t la, const uint16_t *b, uint32_t lb, uint32_t k) {
+    if (la > lb) { const uint16_t *t = a; a = b; b = t; uint32_t tl = la; la = lb; lb = tl; }
+    if (lb - la > k) return k + 1;
+    while (la && a[0] == b[0]) { a++; b++; la--; lb--; }
+    while (la && a[la - 1] == b[lb - 1]) { la--; lb--; }
+    if (la == 0) return lb <= k ? lb : k + 1;
+    if (lb > CM_CLUSTER_FUZZY_MAX) return k + 1;
+
+    // 只算 |i - j| <= k 的带；带外按 k + 1
+    uint32_t prev[CM_CLUSTER_FUZZY_MAX + 1], cur[CM_CLUSTER_FUZZY_MAX + 1];
+    const uint32_t inf = k + 1;
+    for (uint32_t j = 0; j <= lb; j++) prev[j] = j <= k ? j : inf;
+    for (uint32_t i = 1; i <= la; i++) {
+        uint32_t lo = i > k ? i - k : 1;
+        uint32_t hi = i + k < lb ? i + k : lb;
+        cur[0] = i <= k ? i : inf;
+        if (lo > 1) cur[lo - 1] = inf;
+        uint32_t rowMin = cur[0];
+        for (uint32_t j = lo; j <= hi; j++) {
+            uint32_t v = prev[j - 1] + (a[i - 1] != b[j - 1]);
+            uint32_t del = prev[j] + 1, ins = cur[j - 1] + 1;
+            if (del < v) v = del;
+            if (ins < v) v = ins;
+            if (v > inf) v = inf;
+            cur[j] = v;
+            if (v < rowMin) rowMin = v;
+        }
+        if (hi < lb) cur[hi + 1] = inf;
+        if (rowMin > k) return inf;
+        memcpy(prev, cur, sizeof(uint32_t) * (lb + 1));
+    }
+    return prev[lb] <= k ? prev[lb] : inf;
+}
+
+// MARK: - Run
+
+static int cm_key_cmp(const void *x, const void *y) {
+    const CMKeyRec *a = x, *b = y;
+    if (a->kind != b->kind) return a->kind < b->kind ? -1 : 1;
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    return a->row < b->row ? -1 : (a->row > b->row);
+}
+
+static int cm_block_cmp(const void *x, const void *y) {
+    const CMBlockRec *a = x, *b = y;
+    if (a->block != b->block) return a->block < b->block ? -1 : 1;
+    if (a->order != b->order) return a->order < b->order ? -1 : 1;
+    return a->row < b->row ? -1 : (a->row > b->row);
+}
+
+typedef struct {
+    const uint16_t *s;
+    uint32_t len, row;
+} CMLexRec;
+
+static int cm_lex_cmp(const void *x, const void *y) {
+    const CMLexRec *a = x, *b = y;
+    uint32_t n = a->len < b->len ? a->len : b->len;
+    for (uint32_t i = 0; i < n; i++) if (a->s[i] != b->s[i]) return a->s[i] < b->s[i] ? -1 : 1;
+    if (a->len != b->len) return a->len < b->len ? -1 : 1;
+    return a->row < b->row ? -1 : (a->row > b->row);
+}
+
+static uint64_t cm_block_key(const uint16_t *s, uint32_t n, uint32_t pass) {
+    uint64_t h = 1469598103934665603ull ^ pass;
+    for (uint32_t i = 0; i < n; i++) { h ^= s[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+static inline uint32_t cm_max_dist(const CMClusterParams *p, uint32_t la, uint32_t lb) {
+    return (la > lb ? la : lb) >= p->longLen ? p->maxDistLong : p->maxDistShort;
+}
+
+// 只记下来，不合并；已在同一簇的不用比
+static void cm_try_pair(CMCluster *c, const CMClusterParams *p, uint32_t ra, uint32_t rb) {
+    if (cm_cluster_find(c, ra) == cm_cluster_find(c, rb)) return;
+    uint32_t la = c->nameLen[ra], lb = c->nameLen[rb];
+    uint32_t k = cm_max_dist(p, la, lb);
+    if ((la > lb ? la - lb : lb - la) > k) return;
+    c->stats.comparisons += 1;
+    if (cm_edit_distance_bounded(c->pool + c->nameOff[ra], la, c->pool + c->nameOff[rb], lb, k) <= k) {
+        if (!cm_grow((void **)&c->pairs, &c->pairCap, c->pairCount + 1, sizeof(CMPairRec))) return;
+        c->pairs[c->pairCount++] = ra < rb ? (CMPairRec){ ra, rb } : (CMPairRec){ rb, ra };
+    }
+}
+
+static int cm_pair_cmp(const void *x, const void *y) {
+    const CMPairRec *a = x, *b = y;
+    if (a->a != b->a) return a->a < b->a ? -1 : 1;
+    return a->b < b->b ? -1 : (a->b > b->b);
+}
+
+// 两遍分块会找到重复的对，同一对簇也可能有多对成员相近：每对簇只留行号最小的一对。
+// 按 (a, b) 排好后顺序扫，第一次见到的簇对就是最小的；簇对用开放寻址表去重。
+// 两端已在同一精确簇的对一律丢掉：它们已经在「重复」里，不能再作为疑似出现一次
+static void cm_dedup_pairs(CMCluster *c) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < c->pairCount; i++) {
+        if (cm_cluster_find(c, c->pairs[i].a) != cm_cluster_find(c, c->pairs[i].b)) c->pairs[n++] = c->pairs[i];
+    }
+    c->pairCount = n;
+    if (n == 0) return;
+    qsort(c->pairs, n, sizeof(CMPairRec), cm_pair_cmp);
+
+    uint32_t cap = 16;
+    while (cap < n * 2) cap *= 2;
+    uint64_t *seen = malloc(sizeof(uint64_t) * cap);
+    if (!seen) return;
+    memset(seen, 0xff, sizeof(uint64_t) * cap);
+
+    uint32_t out = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t x = cm_cluster_find(c, c->pairs[i].a), y = cm_cluster_find(c, c->pairs[i].b);
+        uint64_t key = x < y ? ((uint64_t)x << 32 | y) : ((uint64_t)y << 32 | x);
+        uint32_t h = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (cap - 1);
+        while (seen[h] != UINT64_MAX && seen[h] != key) h = (h + 1) & (cap - 1);
+        if (seen[h] == key) continue;
+        seen[h] = key;
+        c->pairs[out++] = c->pairs[i];
+    }
+    free(seen);
+    c->pairCount = out;
+}
+
+static void cm_fuzzy_pass(CMCluster *c, const CMClusterParams *p, const uint32_t *lexRank,
+                          CMBlockRec *recs, uint32_t pass) {
+    uint32_t n = 0;
+    for (uint32_t r = 0; r < c->count; r++) {
+        uint32_t len = c->nameLen[r];
+        if (len < p->minFuzzyLen) continue;
+        const uint16_t *s = c->pool + c->nameOff[r];
+        uint32_t bl = p->blockLen < len ? p->blockLen : len;
+        uint64_t key = pass == 0 ? cm_block_key(s, bl, 0) : cm_block_key(s + len - bl, bl, 1);
+        recs[n++] = (CMBlockRec){ key, len, r };
+    }
+    qsort(recs, n, sizeof(CMBlockRec), cm_block_cmp);
+
+    for (uint32_t i = 0; i < n; ) {
+        uint32_t j = i + 1;
+        while (j < n && recs[j].block == recs[i].block) j++;
+        uint32_t m = j - i;
+        if (m >= 2) {
+            c->stats.blocks += 1;
+            if (m <= p->maxBlock) {
+                // 按长度排好：长度差超过最大阈值就不用往后比了
+                for (uint32_t x = i; x < j; x++) {
+                    for (uint32_t y = x + 1; y < j; y++) {
+                        if (recs[y].order - recs[x].order > p->maxDistLong) break;
+                        cm_try_pair(c, p, recs[x].row, recs[y].row);
+                    }
+                }
+            } else {
+                c->stats.bigBlocks += 1;
+                for (uint32_t x = i; x < j; x++) recs[x].order = lexRank[recs[x].row];
+                qsort(recs + i, m, sizeof(CMBlockRec), cm_block_cmp);
+                for (uint32_t x = i; x < j; x++) {
+                    uint32_t end = x + 1 + p->window < j ? x + 1 + p->window : j;
+                    for (uint32_t y = x + 1; y < end; y++) cm_try_pair(c, p, recs[x].row, recs[y].row);
+                }
+            }
+        }
+        i = j;
+    }
+}
+
+void cm_cluster_run(CMCluster *c, const CMClusterParams *params) {
+    CMClusterParams p;
+    if (params) p = *params; else cm_cluster_default_params(&p);
+    if (p.blockLen == 0) p.blockLen = 1;
+
+    uint32_t n = c->count;
+    free(c->parent); free(c->size); free(c->reason);
+    c->parent = malloc(sizeof(uint32_t) * (n ? n : 1));
+    c->size = malloc(sizeof(uint32_t) * (n ? n : 1));
+    c->reason = calloc(n ? n : 1, 1);
+    memset(&c->stats, 0, sizeof(c->stats));
+    c->stats.rows = n;
+    c->pairCount = 0;
+    if (!c->parent || !c->size || !c->reason) return;
+    for (uint32_t i = 0; i < n; i++) { c->parent[i] = i; c->size[i] = 1; }
+
+    // 1. 精确键：排序后相邻相等的合并
+    qsort(c->keys, c->keyCount, sizeof(CMKeyRec), cm_key_cmp);
+    for (uint32_t i = 1; i < c->keyCount; i++) {
+        const CMKeyRec *a = &c->keys[i - 1], *b = &c->keys[i];
+        if (a->kind == b->kind && a->key == b->key && a->row != b->row) {
+            if (cm_union(c, a->row, b->row, (uint8_t)(1u << b->kind))) c->stats.keyEdges += 1;
+        }
+    }
+
+    // 2. 模糊姓名：前缀块 + 后缀块，只出疑似对
+    CMLexRec *lex = malloc(sizeof(CMLexRec) * (n ? n : 1));
+    uint32_t *lexRank = malloc(sizeof(uint32_t) * (n ? n : 1));
+    CMBlockRec *recs = malloc(sizeof(CMBlockRec) * (n ? n : 1));
+    if (lex && lexRank && recs) {
+        uint32_t m = 0;
+        for (uint32_t r = 0; r < n; r++) {
+            if (c->nameLen[r] >= p.minFuzzyLen) lex[m++] = (CMLexRec){ c->pool + c->nameOff[r], c->nameLen[r], r };
+        }
+        qsort(lex, m, sizeof(CMLexRec), cm_lex_cmp);
+        for (uint32_t i = 0; i < m; i++) lexRank[lex[i].row] = i;
+
+        cm_fuzzy_pass(c, &p, lexRank, recs, 0);
+        cm_fuzzy_pass(c, &p, lexRank, recs, 1);
+    }
+    free(lex); free(lexRank); free(recs);
+    cm_dedup_pairs(c);
+    c->stats.fuzzyPairs = c->pairCount;
+}
+
+// MARK: - Export
+
+uint32_t cm_cluster_groups(CMCluster *c, uint32_t minSize, uint32_t *rows, uint32_t *starts) {
+    uint32_t n = c->count;
+    if (n == 0 || !c->parent) { starts[0] = 0; return 0; }
+    if (minSize < 1) minSize = 1;
+
+    // 根 -> 簇序号（按首个成员出现的先后）；复用 starts 之外的临时表
+    uint32_t *slot = malloc(sizeof(uint32_t) * n);
+    uint32_t *fill = malloc(sizeof(uint32_t) * (n + 1));
+    if (!slot || !fill) { free(slot); free(fill); starts[0] = 0; return 0; }
+    for (uint32_t i = 0; i < n; i++) slot[i] = UINT32_MAX;
+
+    uint32_t groups = 0;
+    for (uint32_t r = 0; r < n; r++) {
+        uint32_t root = cm_cluster_find(c, r);
+        if (c->size[root] < minSize || slot[root] != UINT32_MAX) continue;
+        slot[root] = groups;
+        fill[groups] = c->size[root];
+        groups++;
+    }
+    uint32_t acc = 0;
+    for (uint32_t g = 0; g < groups; g++) {
+        starts[g] = acc;
+        acc += fill[g];
+        fill[g] = starts[g];
+    }
+    starts[groups] = acc;
+    for (uint32_t r = 0; r < n; r++) {
+        uint32_t g = slot[cm_cluster_find(c, r)];
+        if (g != UINT32_MAX) rows[fill[g]++] = r;
+    }
+    free(slot); free(fill);
+    return groups;
+}
+
+uint32_t cm_cluster_fuzzy_pair_count(const CMCluster *c) { return c->pairCount; }
+
+void cm_cluster_fuzzy_pair(const CMCluster *c, uint32_t i, uint32_t *a, uint32_t *b) {
+    *a = i < c->pairCount ? c->pairs[i].a : UINT32_MAX;
+    *b = i < c->pairCount ? c->pairs[i].b : UINT32_MAX;
+}
+
+void cm_cluster_stats(const CMCluster *c, CMClusterStats *out) {
+    *out = c->stats;
+}
@@ -0,0 +1,90 @@
+#ifndef CMContactCluster_h
+#define CMContactCluster_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 重复联系人的模糊 / 传递聚类（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 每个联系人一行：一个用于模糊比较的姓名串（音译成拉丁字母后的 UTF-16，调用方给）
+/// + 任意个精确键（姓名 / 电话后缀 / 邮箱的 64 位哈希）。
+/// 簇：同一种精确键相等即连边，进并查集传递合并，所以「A、B 同名，B、C 同号」会成为一组。
+/// 姓名串相近（编辑距离不超过阈值）只算「疑似重复」对，不合并、不传递：
+/// 音译会把同音不同字（张伟 / 章伟 / 张薇）变成同一个串，单凭它连边会把不相干的人串成大簇。
+/// 模糊比较只在块内做：块键 = 姓名串前 blockLen 个字符，再按后 blockLen 个字符分一遍，
+/// 两端任一处的错字都还能落进同一块；块太大时退化成按字典序排好后只比相邻 window 个。
+/// 整体是 排序 O(n log n) + 块内比较 O(n · window)，不做全对比较。
+
+#define CM_CLUSTER_FUZZY_MAX 48   // 模糊串超出部分截掉
+
+typedef enum {
+    CMClusterKeyName  = 0,   // 归一化姓名完全相同
+    CMClusterKeyPhone = 1,
+    CMClusterKeyEmail = 2,
+} CMClusterKeyKind;
+
+// 簇的成因（cm_cluster_reasons）
+#define CM_CLUSTER_BY_NAME   (1u << CMClusterKeyName)
+#define CM_CLUSTER_BY_PHONE  (1u << CMClusterKeyPhone)
+#define CM_CLUSTER_BY_EMAIL  (1u << CMClusterKeyEmail)
+
+typedef struct {
+    uint32_t minFuzzyLen;    // 模糊串短于此只走精确键（默认 5）
+    uint32_t maxDistShort;   // 较长一方 < longLen 时允许的编辑距离（默认 1）
+    uint32_t maxDistLong;    // 默认 2
+    uint32_t longLen;        // 默认 10
+    uint32_t blockLen;       // 块键长度（默认 3）
+    uint32_t maxBlock;       // 块内人数超过就改比相邻（默认 64）
+    uint32_t window;         // 默认 12
+} CMClusterParams;
+
+typedef struct {
+    uint32_t rows;
+    uint32_t keyEdges;       // 精确键合并次数（实际合并的）
+    uint32_t fuzzyPairs;     // 去重后的疑似对数
+    uint32_t blocks;
+    uint32_t bigBlocks;      // 退化成相邻比较的块
+    uint64_t comparisons;    // 实际算了编辑距离的对数
+} CMClusterStats;
+
+typedef struct CMCluster CMCluster;
+
+void cm_cluster_default_params(CMClusterParams *p);
+
+CMCluster *cm_cluster_create(void);
+void cm_cluster_destroy(CMCluster *c);
+
+/// 加一行，返回行号（从 0 递增）；fuzzyName 可为 NULL / 空
+uint32_t cm_cluster_add(CMCluster *c, const uint16_t *fuzzyName, uint32_t len);
+void cm_cluster_add_key(CMCluster *c, uint32_t row, CMClusterKeyKind kind, uint64_t key);
+
+/// 建边并合并、找疑似对；之后才能查询。可重复调用（重新从单元素开始）
+void cm_cluster_run(CMCluster *c, const CMClusterParams *p);
+
+uint32_t cm_cluster_count(const CMCluster *c);
+uint32_t cm_cluster_find(CMCluster *c, uint32_t row);
+/// row 所在簇的成因位
+uint32_t cm_cluster_reasons(CMCluster *c, uint32_t row);
+
+/// 成员数 >= minSize 的簇：rows 按簇连续排列（簇按首个成员的行号排，簇内行号升序），
+/// 第 g 个簇是 rows[starts[g] .. starts[g+1])。rows 至少 count 个，starts 至少 count + 1 个；返回簇数
+uint32_t cm_cluster_groups(CMCluster *c, uint32_t minSize, uint32_t *rows, uint32_t *starts);
+
+/// 疑似重复对：姓名串相近、且两端不在同一个精确簇里（同簇的已算「重复」，不会再报）。同一对簇只报一次（行号最小的那对），
+/// a < b，按 (a, b) 升序
+uint32_t cm_cluster_fuzzy_pair_count(const CMCluster *c);
+void cm_cluster_fuzzy_pair(const CMCluster *c, uint32_t i, uint32_t *a, uint32_t *b);
+
+void cm_cluster_stats(const CMCluster *c, CMClusterStats *out);
+
+/// 有界编辑距离：超过 k 时返回 k + 1
+uint32_t cm_edit_distance_bounded(const uint16_t *a, uint32_t la, const uint16_t *b, uint32_t lb, uint32_t k);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMContactCluster_h */
@@ -0,0 +1,59 @@
+#import <Foundation/Foundation.h>
+#import <Contacts/Contacts.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 一个联系人的归一化键（由 ContactsManager 的 builder 生成）
+@interface CMContactIndexEntry : NSObject <NSSecureCoding>
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, copy) NSString *nameKey;                  // 空串 = 没有名字键
+@property (nonatomic, copy) NSString *fuzzyName;                // 音译成拉丁字母后的姓名（a-z0-9），找疑似重复对用
+@property (nonatomic, copy) NSArray<NSString *> *phoneKeys;
+@property (nonatomic, copy) NSArray<NSString *> *emailKeys;
+@property (nonatomic) BOOL nameMissing;
+@property (nonatomic) BOOL phoneMissing;
+@end
+
+typedef CMContactIndexEntry *_Nullable (^CMContactIndexEntryBuilder)(CNContact *contact);
+
+/// 持久化的联系人索引：归一化的姓名 / 电话 / 邮箱键 + 不完整标记 + 按键的重复簇
+///
+/// 用 CNChangeHistoryFetchRequest 的 token 增量更新：每次 refresh 只应用上次之后的增删改；
+/// 没有 token、token 过期 / 无效、或出现 link / unlink 事件时才整表重建（一次 enumerate）。
+/// 非线程安全，只在 ContactsManager 的串行 workQueue 上使用。
+@interface CMContactIndex : NSObject
+
+/// keys：builder 需要的 key（全量枚举与变更历史都按这组取）
+- (instancetype)initWithStore:(CNContactStore *)store
+                      fileURL:(NSURL *)fileURL
+                  keysToFetch:(NSArray<id<CNKeyDescriptor>> *)keys
+                 entryBuilder:(CMContactIndexEntryBuilder)builder;
+
+/// 首次调用先读盘；之后应用变更历史，必要时全量重建；有变化就写盘
+- (BOOL)refresh:(NSError **)error;
+
+/// 丢掉内存与磁盘上的索引，下次 refresh 全量重建
+- (void)invalidate;
+
+@property (nonatomic, readonly) NSUInteger count;
+/// 顺序：全量重建时按系统枚举顺序，之后新增的排在末尾
+@property (nonatomic, readonly) NSArray<NSString *> *identifiers;
+- (nullable CMContactIndexEntry *)entryForIdentifier:(NSString *)identifier;
+
+/// 缺姓名或缺电话
+@property (nonatomic, readonly) NSUInteger incompleteCount;
+/// 两个标记都精确匹配（NO, NO 即完整联系人）
+- (NSArray<NSString *> *)incompleteIdentifiersMissingName:(BOOL)name phone:(BOOL)phone;
+
+/// 同一个键下至少 2 人的簇；组内顺序同 identifiers
+- (NSDictionary<NSString *, NSArray<NSString *> *> *)nameClusters;
+- (NSDictionary<NSString *, NSArray<NSString *> *> *)phoneClusters;
+/// 出现在任一姓名 / 电话簇里的联系人数
+@property (nonatomic, readonly) NSUInteger duplicateCount;
+
+/// fullRebuilds / incrementalRefreshes / eventsApplied / historyInvalid / lastRefreshMs / entries
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,312 @@
+#import "CMContactIndex.h"
+
+static const NSInteger kCMContactIndexVersion = 3;   // 3：键改由 CMContactKey 生成
+
+@implementation CMContactIndexEntry
+
++ (BOOL)supportsSecureCoding { return YES; }
+
+- (void)encodeWithCoder:(NSCoder *)c {
+    [c encodeObject:self.identifier forKey:@"id"];
+    [c encodeObject:self.nameKey forKey:@"n"];
+    [c encodeObject:self.fuzzyName forKey:@"f"];
+    [c encodeObject:self.phoneKeys forKey:@"p"];
+    [c encodeObject:self.emailKeys forKey:@"e"];
+    [c encodeBool:self.nameMissing forKey:@"nm"];
+    [c encodeBool:self.phoneMissing forKey:@"pm"];
+}
+
+- (instancetype)initWithCoder:(NSCoder *)c {
+    if (self = [super init]) {
+        NSSet *strs = [NSSet setWithObjects:NSArray.class, NSString.class, nil];
+        _identifier = [c decodeObjectOfClass:NSString.class forKey:@"id"] ?: @"";
+        _nameKey = [c decodeObjectOfClass:NSString.class forKey:@"n"] ?: @"";
+        _fuzzyName = [c decodeObjectOfClass:NSString.class forKey:@"f"] ?: @"";
+        _phoneKeys = [c decodeObjectOfClasses:strs forKey:@"p"] ?: @[];
+        _emailKeys = [c decodeObjectOfClasses:strs forKey:@"e"] ?: @[];
+        _nameMissing = [c decodeBoolForKey:@"nm"];
+        _phoneMissing = [c decodeBoolForKey:@"pm"];
+    }
+    return self;
+}
+
+@end
+
+@interface CMContactIndex ()
+@property (nonatomic, strong) CNContactStore *store;
+@property (nonatomic, copy) NSURL *fileURL;
+@property (nonatomic, copy) NSArray<id<CNKeyDescriptor>> *keys;
+@property (nonatomic, copy) CMContactIndexEntryBuilder builder;
+@property (nonatomic, copy, nullable) NSData *token;
+@end
+
+@implementation CMContactIndex {
+    BOOL _loaded;
+    BOOL _dirty;
+    NSMutableDictionary<NSString *, CMContactIndexEntry *> *_entries;
+    NSMutableOrderedSet<NSString *> *_order;
+    NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *_byName;
+    NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *_byPhone;
+
+    NSUInteger _fullRebuilds, _incrementalRefreshes, _eventsApplied, _historyInvalid;
+    double _lastRefreshMs;
+}
+
+- (instancetype)initWithStore:(CNContactStore *)store
+                      fileURL:(NSURL *)fileURL
+                  keysToFetch:(NSArray<id<CNKeyDescriptor>> *)keys
+                 entryBuilder:(CMContactIndexEntryBuilder)builder {
+    if (self = [super init]) {
+        _store = store;
+        _fileURL = [fileURL copy];
+        _keys = [keys copy];
+        _builder = [builder copy];
+        [self as_resetTables];
+    }
+    return self;
+}
+
+- (void)as_resetTables {
+    _entries = [NSMutableDictionary dictionary];
+    _order = [NSMutableOrderedSet orderedSet];
+    _byName = [NSMutableDictionary dictionary];
+    _byPhone = [NSMutableDictionary dictionary];
+    _token = nil;
+}
+
+#pragma mark - Entries
+
+static void CMMapAdd(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *map, NSString *key, NSString *cid) {
+    if (key.length == 0) return;
+    NSMutableSet *set = map[key] ?: (map[key] = [NSMutableSet set]);
+    [set addObject:cid];
+}
+
+static void CMMapRemove(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *map, NSString *key, NSString *cid) {
+    if (key.length == 0) return;
+    NSMutableSet *set = map[key];
+    [set removeObject:cid];
+    if (set.count == 0) [map removeObjectForKey:key];
+}
+
+- (void)as_removeIdentifier:(NSString *)cid {
+    CMContactIndexEntry *old = _entries[cid];
+    if (!old) return;
+    CMMapRemove(_byName, old.nameKey, cid);
+    for (NSString *pk in old.phoneKeys) CMMapRemove(_byPhone, pk, cid);
+    [_entries removeObjectForKey:cid];
+    [_order removeObject:cid];
+    _dirty = YES;
+}
+
+- (void)as_putEntry:(CMContactIndexEntry *)e {
+    if (e.identifier.length == 0) return;
+    NSString *cid = e.identifier;
+    CMContactIndexEntry *old = _entries[cid];
+    if (old) {
+        CMMapRemove(_byName, old.nameKey, cid);
+        for (NSString *pk in old.phoneKeys) CMMapRemove(_byPhone, pk, cid);
+    } else {
+        [_order addObject:cid];
+    }
+    _entries[cid] = e;
+    CMMapAdd(_byName, e.nameKey, cid);
+    for (NSString *pk in e.phoneKeys) CMMapAdd(_byPhone, pk, cid);
+    _dirty = YES;
+}
+
+- (void)as_putContact:(CNContact *)c {
+    CMContactIndexEntry *e = self.builder(c);
+    if (e) [self as_putEntry:e];
+}
+
+#pragma mark - Refresh
+
+- (BOOL)refresh:(NSError **)error {
+    CFAbsoluteTime t0 = CFAbsoluteTimeGetCurrent();
+    if (!_loaded) {
+        _loaded = YES;
+        [self as_load];
+    }
+
+    BOOL ok = YES;
+    if (!self.token || ![self as_applyChangeHistory]) {
+        ok = [self as_rebuild:error];
+    }
+    if (ok && _dirty) [self as_save];
+    _lastRefreshMs = (CFAbsoluteTimeGetCurrent() - t0) * 1000.0;
+    return ok;
+}
+
+- (void)invalidate {
+    [self as_resetTables];
+    _loaded = YES;
+    _dirty = NO;
+    [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+}
+
+// 先取 token 再枚举：枚举期间的改动下次会重放一遍（按 identifier 覆盖，幂等）
+- (BOOL)as_rebuild:(NSError **)error {
+    [self as_resetTables];
+    NSData *token = self.store.currentHistoryToken;
+
+    CNContactFetchRequest *req = [[CNContactFetchRequest alloc] initWithKeysToFetch:self.keys];
+    req.unifyResults = YES;
+    BOOL ok = [self.store enumerateContactsWithFetchRequest:req
+                                                      error:error
+                                                 usingBlock:^(CNContact * _Nonnull c, BOOL * _Nonnull stop) {
+        @autoreleasepool { [self as_putContact:c]; }
+    }];
+    if (!ok) {
+        [self as_resetTables];
+        return NO;
+    }
+
+    self.token = token;
+    _dirty = YES;
+    _fullRebuilds += 1;
+    return YES;
+}
+
+// 返回 NO = 需要全量重建（token 失效 / link、unlink 等无法逐条应用的事件）
+- (BOOL)as_applyChangeHistory {
+    CNChangeHistoryFetchRequest *req = [CNChangeHistoryFetchRequest new];
+    req.startingToken = self.token;
+    req.additionalContactKeyDescriptors = self.keys;
+    req.shouldUnifyResults = YES;
+    req.includeGroupChanges = NO;
+
+    NSError *err = nil;
+    CNFetchResult<NSEnumerator<CNChangeHistoryEvent *> *> *res =
+        [self.store enumeratorForChangeHistoryFetchRequest:req error:&err];
+    if (!res || err) {
+        _historyInvalid += 1;
+        return NO;
+    }
+
+    NSUInteger applied = 0;
+    for (CNChangeHistoryEvent *ev in res.value) {
+        @autoreleasepool {
+            if ([ev isKindOfClass:[CNChangeHistoryDropEverythingEvent class]]) {
+                // 之后会把现存联系人逐条作为新增重放
+                [self as_resetTables];
+                _dirty = YES;
+            } else if ([ev isKindOfClass:[CNChangeHistoryAddContactEvent class]]) {
+                [self as_putContact:((CNChangeHistoryAddContactEvent *)ev).contact];
+            } else if ([ev isKindOfClass:[CNChangeHistoryUpdateContactEvent class]]) {
+                [self as_putContact:((CNChangeHistoryUpdateContactEvent *)ev).contact];
+            } else if ([ev isKindOfClass:[CNChangeHistoryDeleteContactEvent class]]) {
+                [self as_removeIdentifier:((CNChangeHistoryDeleteContactEvent *)ev).contactIdentifier ?: @""];
+            } else if ([ev isKindOfClass:[CNChangeHistoryLinkContactsEvent class]] ||
+                       [ev isKindOfClass:[CNChangeHistoryUnlinkContactsEvent class]]) {
+                return NO;
+            }
+            applied += 1;
+        }
+    }
+
+    if (res.currentHistoryToken && ![res.currentHistoryToken isEqualToData:self.token]) {
+        self.token = res.currentHistoryToken;
+        _dirty = YES;
+    }
+    _eventsApplied += applied;
+    _incrementalRefreshes += 1;
+    return YES;
+}
+
+#pragma mark - Persistence
+
+- (void)as_load {
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL];
+    if (data.length == 0) return;
+
+    NSSet *classes = [NSSet setWithObjects:NSDictionary.class, NSArray.class, NSString.class,
+                      NSNumber.class, NSData.class, CMContactIndexEntry.class, nil];
+    NSDictionary *root = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:data error:nil];
+    if (![root isKindOfClass:[NSDictionary class]]) return;
+    if ([root[@"v"] integerValue] != kCMContactIndexVersion) return;
+    NSData *token = [root[@"token"] isKindOfClass:[NSData class]] ? root[@"token"] : nil;
+    NSArray *entries = [root[@"entries"] isKindOfClass:[NSArray class]] ? root[@"entries"] : nil;
+    if (!token || !entries) return;
+
+    for (CMContactIndexEntry *e in entries) {
+        if ([e isKindOfClass:[CMContactIndexEntry class]]) [self as_putEntry:e];
+    }
+    self.token = token;
+    _dirty = NO;
+}
+
+- (void)as_save {
+    if (!self.token) return;
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:_order.count];
+    for (NSString *cid in _order) [entries addObject:_entries[cid]];
+
+    NSDictionary *root = @{ @"v": @(kCMContactIndexVersion), @"token": self.token, @"entries": entries };
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:root requiringSecureCoding:YES error:nil];
+    if (!data) return;
+
+    [[NSFileManager defaultManager] createDirectoryAtURL:[self.fileURL URLByDeletingLastPathComponent]
+                             withIntermediateDirectories:YES attributes:nil error:nil];
+    if ([data writeToURL:self.fileURL options:NSDataWritingAtomic error:nil]) _dirty = NO;
+}
+
+#pragma mark - Queries
+
+- (NSUInteger)count { return _entries.count; }
+
+- (NSArray<NSString *> *)identifiers { return _order.array; }
+
+- (CMContactIndexEntry *)entryForIdentifier:(NSString *)identifier {
+    return identifier.length ? _entries[identifier] : nil;
+}
+
+- (NSUInteger)incompleteCount {
+    NSUInteger n = 0;
+    for (CMContactIndexEntry *e in _entries.objectEnumerator) n += (e.nameMissing || e.phoneMissing);
+    return n;
+}
+
+- (NSArray<NSString *> *)incompleteIdentifiersMissingName:(BOOL)name phone:(BOOL)phone {
+    NSMutableArray<NSString *> *out = [NSMutableArray array];
+    for (NSString *cid in _order) {
+        CMContactIndexEntry *e = _entries[cid];
+        if (e.nameMissing == name && e.phoneMissing == phone) [out addObject:cid];
+    }
+    return out;
+}
+
+- (NSDictionary<NSString *, NSArray<NSString *> *> *)as_clustersIn:(NSDictionary<NSString *, NSMutableSet<NSString *> *> *)map {
+    NSMutableDictionary *out = [NSMutableDictionary dictionary];
+    NSMutableOrderedSet<NSString *> *order = _order;
+    [map enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableSet<NSString *> *ids, BOOL *stop) {
+        if (ids.count < 2) return;
+        out[key] = [ids.allObjects sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+            NSUInteger ia = [order indexOfObject:a], ib = [order indexOfObject:b];
+            return ia < ib ? NSOrderedAscending : (ia > ib ? NSOrderedDescending : NSOrderedSame);
+        }];
+    }];
+    return out;
+}
+
+- (NSDictionary<NSString *, NSArray<NSString *> *> *)nameClusters { return [self as_clustersIn:_byName]; }
+- (NSDictionary<NSString *, NSArray<NSString *> *> *)phoneClusters { return [self as_clustersIn:_byPhone]; }
+
+- (NSUInteger)duplicateCount {
+    NSMutableSet<NSString *> *ids = [NSMutableSet set];
+    for (NSMutableSet *s in _byName.objectEnumerator) if (s.count >= 2) [ids unionSet:s];
+    for (NSMutableSet *s in _byPhone.objectEnumerator) if (s.count >= 2) [ids unionSet:s];
+    return ids.count;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    return @{
+        @"fullRebuilds": @(_fullRebuilds),
+        @"incrementalRefreshes": @(_incrementalRefreshes),
+        @"eventsApplied": @(_eventsApplied),
+        @"historyInvalid": @(_historyInvalid),
+        @"lastRefreshMs": @(_lastRefreshMs),
+        @"entries": @(_entries.count),
+    };
+}
+
+@end
@@ -0,0 +1,227 @@
+#include "CMContactKey.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct CMKeyTables {
+    uint8_t keep[8192];
+    uint16_t lower[65536];
+};
+
+// MARK: - Tables
+
+static inline void cm_set_bit(uint8_t *bm, uint32_t c) { bm[c >> 3] |= (uint8_t)(1u << (c & 7)); }
+static inline int cm_bit(const uint8_t *bm, uint32_t c) { return (bm[c >> 3] >> (c & 7)) & 1; }
+
+static void cm_lower_range(uint16_t *lo, uint32_t a, uint32_t b, int32_t delta) {
+    for (uint32_t c = a; c <= b; c++) lo[c] = (uint16_t)((int32_t)c + delta);
+}
+
+// 拉丁扩展 A：大小写交替排列（偶大奇小 / 奇大偶小）
+static void cm_lower_pairs(uint16_t *lo, uint32_t a, uint32_t b) {
+    for (uint32_t c = a; c < b; c += 2) lo[c] = (uint16_t)(c + 1);
+}
+
+CMKeyTables *cm_keytab_create(const uint8_t *keepBitmap) {
+    CMKeyTables *t = malloc(sizeof(CMKeyTables));
+    if (!t) return NULL;
+
+    if (keepBitmap) {
+        memcpy(t->keep, keepBitmap, sizeof(t->keep));
+    } else {
+        memset(t->keep, 0, sizeof(t->keep));
+        for (uint32_t c = '0'; c <= '9'; c++) cm_set_bit(t->keep, c);
+        for (uint32_t c = 'a'; c <= 'z'; c++) { cm_set_bit(t->keep, c); cm_set_bit(t->keep, c - 32); }
+        for (uint32_t c = 0xC0; c <= 0xFF; c++) if (c != 0xD7 && c != 0xF7) cm_set_bit(t->keep, c);
+        cm_set_bit(t->keep, 0xAA); cm_set_bit(t->keep, 0xB5); cm_set_bit(t->keep, 0xBA);
+    }
+
+    for (uint32_t c = 0; c < 65536; c++) t->lower[c] = (uint16_t)c;
+    cm_lower_range(t->lower, 'A', 'Z', 32);
+    cm_lower_range(t->lower, 0xC0, 0xDE, 32);
+    t->lower[0xD7] = 0xD7;
+    cm_lower_pairs(t->lower, 0x100, 0x12F);
+    cm_lower_pairs(t->lower, 0x132, 0x137);
+    cm_lower_pairs(t->lower, 0x139, 0x148);
+    cm_lower_pairs(t->lower, 0x14A, 0x177);
+    t->lower[0x178] = 0xFF;
+    cm_lower_pairs(t->lower, 0x179, 0x17E);
+    cm_lower_range(t->lower, 0x391, 0x3AB, 32);
+    t->lower[0x3A2] = 0x3A2;
+    t->lower[0x386] = 0x3AC;
+    cm_lower_range(t->lower, 0x388, 0x38A, 37);
+    t->lower[0x38C] = 0x3CC;
+    cm_lower_range(t->lower, 0x38E, 0x38F, 63);
+    cm_lower_range(t->lower, 0x400, 0x40F, 80);
+    cm_lower_range(t->lower, 0x410, 0x42F, 32);
+    cm_lower_range(t->lower, 0xFF21, 0xFF3A, 32);
+    return t;
+}
+
+void cm_keytab_destroy(CMKeyTables *t) { free(t); }
+
+void cm_keytab_set_lower(CMKeyTables *t, uint16_t from, uint16_t to) { t->lower[from] = to; }
+
+// MARK: - Keys
+
+static inline int cm_is_high(uint16_t c) { return c >= 0xD800 && c <= 0xDBFF; }
+static inline int cm_is_low(uint16_t c) { return c >= 0xDC00 && c <= 0xDFFF; }
+
+uint32_t cm_key_name(const CMKeyTables *t, const uint16_t *in, uint32_t len, uint16_t *out) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t c = in[i];
+        if (cm_is_high(c) && i + 1 < len && cm_is_low(in[i + 1])) {
+            uint32_t cp = 0x10000 + (((uint32_t)c - 0xD800) << 10) + ((uint32_t)in[i + 1] - 0xDC00);
+            if (cp >= 0x20000 && cp < 0x40000) { out[n++] = c; out[n++] = in[i + 1]; }
+            i++;
+            continue;
+        }
+        uint16_t l = t->lower[c];
+        if (cm_bit(t->keep, l)) out[n++] = l;
+    }
+    return n;
+}
+
+// whitespaceAndNewlineCharacterSet
+static inline int cm_is_space(uint16_t c) {
+    if (c <= 0x20) return c == 0x20 || (c >= 0x09 && c <= 0x0D);
+    return c == 0x85 || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A) ||
+           c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+}
+
+uint32_t cm_key_email(const CMKeyTables *t, const uint16_t *in, uint32_t len, uint16_t *out) {
+    uint32_t a = 0, b = len;
+    while (a < b && cm_is_space(in[a])) a++;
+    while (b > a && cm_is_space(in[b - 1])) b--;
+    for (uint32_t i = a; i < b; i++) out[i - a] = t->lower[in[i]];
+    return b - a;
+}
+
+uint32_t cm_key_phone_digits(const uint16_t *in, uint32_t len, char out[11]) {
+    // 环形保留最后 11 位
+    char ring[11];
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t c = in[i];
+        if (c >= '0' && c <= '9') ring[total++ % 11] = (char)c;
+    }
+    uint32_t n = total < 11 ? total : 11;
+    uint32_t start = total - n;
+    for (uint32_t i = 0; i < n; i++) out[i] = ring[(start + i) % 11];
+    return n;
+}
+
+uint64_t cm_key_phone(const uint16_t *in, uint32_t len) {
+    char d[11];
+    uint32_t n = cm_key_phone_digits(in, len, d);
+    if (n == 0) return 0;
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < n; i++) v = v * 10 + (uint64_t)(d[i] - '0');
+    return ((uint64_t)n << 40) | v;   // 10^11 < 2^37，位数放高位区分前导 0
+}
+
+uint64_t cm_key_hash(const uint16_t *s, uint32_t len) {
+    uint64_t h = 1469598103934665603ull ^ len;
+    for (uint32_t i = 0; i < len; i++) { h ^= s[i]; h *= 1099511628211ull; }
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h ? h : 1;
+}
+
+// MARK: - Key set
+
+typedef struct {
+    uint64_t hash;
+    uint32_t id1;   // id + 1；0 = 空
+} CMKeySlot;
+
+struct CMKeySet {
+    CMKeySlot *slots;
+    uint32_t slotCap;       // 2 的幂
+    uint32_t count;
+    uint32_t *off, *len;
+    uint32_t idCap;
+    uint16_t *pool;
+    uint32_t poolLen, poolCap;
+    uint32_t collisions;
+};
+
+CMKeySet *cm_keyset_create(void) {
+    CMKeySet *s = calloc(1, sizeof(CMKeySet));
+    if (!s) return NULL;
+    s->slotCap = 1024;
+    s->slots = calloc(s->slotCap, sizeof(CMKeySlot));
+    if (!s->slots) { free(s); return NULL; }
+    return s;
+}
+
+void cm_keyset_destroy(CMKeySet *s) {
+    if (!s) return;
+    free(s->slots); free(s->off); free(s->len); free(s->pool);
+    free(s);
+}
+
+uint32_t cm_keyset_count(const CMKeySet *s) { return s->count; }
+uint32_t cm_keyset_collisions(const CMKeySet *s) { return s->collisions; }
+
+static int cm_keyset_rehash(CMKeySet *s) {
+    uint32_t cap = s->slotCap * 2;
+    CMKeySlot *slots = calloc(cap, sizeof(CMKeySlot));
+    if (!slots) return 0;
+    for (uint32_t i = 0; i < s->slotCap; i++) {
+        if (!s->slots[i].id1) continue;
+        uint32_t j = (uint32_t)s->slots[i].hash & (cap - 1);
+        while (slots[j].id1) j = (j + 1) & (cap - 1);
+        slots[j] = s->slots[i];
+    }
+    free(s->slots);
+    s->slots = slots;
+    s->slotCap = cap;
+    return 1;
+}
+
+uint32_t cm_keyset_intern_hashed(CMKeySet *s, uint64_t hash, const uint16_t *str, uint32_t len) {
+    uint32_t mask = s->slotCap - 1;
+    uint32_t j = (uint32_t)hash & mask;
+    for (; s->slots[j].id1; j = (j + 1) & mask) {
+        if (s->slots[j].hash != hash) continue;
+        uint32_t id = s->slots[j].id1 - 1;
+        if (s->len[id] == len && memcmp(s->pool + s->off[id], str, sizeof(uint16_t) * len) == 0) return id;
+        s->collisions += 1;
+    }
+
+    if (s->count == s->idCap) {
+        uint32_t cap = s->idCap ? s->idCap * 2 : 256;
+        uint32_t *off = realloc(s->off, sizeof(uint32_t) * cap);
+        if (!off) return UINT32_MAX;
+        s->off = off;
+        uint32_t *ln = realloc(s->len, sizeof(uint32_t) * cap);
+        if (!ln) return UINT32_MAX;
+        s->len = ln;
+        s->idCap = cap;
+    }
+    if (s->poolLen + len > s->poolCap) {
+        uint32_t cap = s->poolCap ? s->poolCap : 4096;
+        while (cap < s->poolLen + len) cap *= 2;
+        uint16_t *p = realloc(s->pool, sizeof(uint16_t) * cap);
+        if (!p) return UINT32_MAX;
+        s->pool = p;
+        s->poolCap = cap;
+    }
+
+    uint32_t id = s->count++;
+    s->off[id] = s->poolLen;
+    s->len[id] = len;
+    if (len) memcpy(s->pool + s->poolLen, str, sizeof(uint16_t) * len);
+    s->poolLen += len;
+    s->slots[j] = (CMKeySlot){ hash, id + 1 };
+
+    if (s->count * 2 > s->slotCap && !cm_keyset_rehash(s)) return UINT32_MAX;
+    return id;
+}
+
+uint32_t cm_keyset_intern(CMKeySet *s, const uint16_t *str, uint32_t len) {
+    return cm_keyset_intern_hashed(s, cm_key_hash(str, len), str, len);
+}
@@ -0,0 +1,58 @@
+#ifndef CMContactKey_h
+#define CMContactKey_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 联系人匹配键的归一化（纯 C，可在 Linux 上编译做 benchmark）
+///
+/// 直接在 UTF-16 缓冲上查表，不分配：
+///   姓名：逐字符小写后只留「字母 / 十进制数字」（与原 lowercaseString + letterCharacterSet ∪ decimalDigitCharacterSet 的过滤一致）
+///   电话：只取 ASCII 0-9，保留最后 11 位；也可直接打包成 64 位键（位数 + 数值，无碰撞）
+///   邮箱：去掉首尾空白后小写
+/// 表由调用方一次建好：BMP 位图（NSCharacterSet.bitmapRepresentation 同一布局：bitmap[c >> 3] & (1 << (c & 7))）
+/// + 小写映射（只收长度不变的，如 U+0130 这类小写后变长的保持原样）。
+/// BMP 之外的字符：CJK 扩展（U+20000–U+3FFFF）按字母保留，其余（emoji 等）丢掉。
+///
+/// CMKeySet 把归一化后的串映射成稠密 id：先比 64 位哈希，哈希相同再比原串，碰撞不会合并两个不同的键。
+
+typedef struct CMKeyTables CMKeyTables;
+
+/// keepBitmap：8192 字节；NULL 时只用内置的 ASCII 字母数字 + Latin-1 字母
+CMKeyTables *cm_keytab_create(const uint8_t *keepBitmap);
+void cm_keytab_destroy(CMKeyTables *t);
+/// 覆盖一个 BMP 字符的小写（内置已含 ASCII / Latin-1 / 希腊 / 西里尔 / 全角）
+void cm_keytab_set_lower(CMKeyTables *t, uint16_t from, uint16_t to);
+
+/// out 至少 len 个；返回写入个数
+uint32_t cm_key_name(const CMKeyTables *t, const uint16_t *in, uint32_t len, uint16_t *out);
+uint32_t cm_key_email(const CMKeyTables *t, const uint16_t *in, uint32_t len, uint16_t *out);
+
+/// 最后 11 位数字（ASCII），返回位数
+uint32_t cm_key_phone_digits(const uint16_t *in, uint32_t len, char out[11]);
+/// 同上打包成键：0 = 没有数字
+uint64_t cm_key_phone(const uint16_t *in, uint32_t len);
+
+/// 非 0 的 64 位哈希
+uint64_t cm_key_hash(const uint16_t *s, uint32_t len);
+
+typedef struct CMKeySet CMKeySet;
+
+CMKeySet *cm_keyset_create(void);
+void cm_keyset_destroy(CMKeySet *s);
+/// 相同的串返回相同 id（从 0 递增）；失败返回 UINT32_MAX
+uint32_t cm_keyset_intern(CMKeySet *s, const uint16_t *str, uint32_t len);
+/// 哈希由调用方给（测试碰撞用）
+uint32_t cm_keyset_intern_hashed(CMKeySet *s, uint64_t hash, const uint16_t *str, uint32_t len);
+uint32_t cm_keyset_count(const CMKeySet *s);
+/// 哈希相同但串不同的次数
+uint32_t cm_keyset_collisions(const CMKeySet *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMContactKey_h */
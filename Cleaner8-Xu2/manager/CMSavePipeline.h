@@ -0,0 +1,62 @@
+#import <Foundation/Foundation.h>
+#import <Contacts/Contacts.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void(^CMSaveProgressBlock)(NSUInteger done, NSUInteger total);
+
+/// 一次分批保存（删除 / 恢复）的句柄；cancel 在当前批次写完后生效
+@interface CMSaveOperation : NSObject
+@property (atomic, readonly, getter=isCancelled) BOOL cancelled;
+- (void)cancel;
+@end
+
+/// 一批的回调（都在调用 run 的线程上）
+@interface CMSaveTask : NSObject
+/// 条目总数；条目按下标顺序分批
+@property (nonatomic) NSUInteger total;
+/// 往 req 里加 range 内条目的改动，返回加入的条数（0 = 这一批不用写）
+@property (nonatomic, copy) NSUInteger (^build)(CNSaveRequest *req, NSRange range);
+/// range 处理完：saved = NO 表示这些条目写入失败被跳过（只会是单条）
+@property (nonatomic, copy, nullable) void (^committed)(NSRange range, BOOL saved);
+/// 主线程回调
+@property (nonatomic, copy, nullable) CMSaveProgressBlock progress;
+
+/// 持久化日志：logKey 非 nil 时每个写入的区间（含二分出来的子区间）完成后记一次进度；
+/// 同 key 且 info 相同的任务再次运行时从断点继续
+@property (nonatomic, copy, nullable) NSString *logKey;
+@property (nonatomic, copy, nullable) NSDictionary *info;   // plist 类型
+/// 写一个区间之前记下的探针（plist），用于判断「写完了但没来得及记日志」的那个区间；
+/// 只针对正在写的那一个 CNSaveRequest，它要么整体生效要么整体没生效
+@property (nonatomic, copy, nullable) NSDictionary * _Nullable (^probe)(NSRange range);
+/// 断点处有未确认的区间时调用：YES = 这个区间其实已写入，跳过
+@property (nonatomic, copy, nullable) BOOL (^verify)(NSRange range, NSDictionary *probe);
+@end
+
+/// 把大量联系人改动拆成多个 CNSaveRequest 执行：
+/// 批次之间可取消、有进度；一批失败时二分重试，只跳过真正写不进去的那一条，其余照常写入。
+/// 有 logKey 时进度落盘（Application Support/CMSaveOps），中断后重跑同一任务不会重复新增。
+/// run 在调用方线程同步执行（ContactsManager 的串行队列）；统计接口线程安全。
+@interface CMSavePipeline : NSObject
+
+- (instancetype)initWithStore:(CNContactStore *)store logDirectory:(NSURL *)directory;
+
+/// 每批条数，默认 100
+@property (nonatomic) NSUInteger batchSize;
+
+/// 全部处理完返回 YES（个别条目失败时仍返回 NO，error.userInfo[@"failed"] 为失败条数，日志已清掉）；
+/// 取消 / 中途出错返回 NO 并保留日志
+- (BOOL)runTask:(CMSaveTask *)task operation:(nullable CMSaveOperation *)op error:(NSError **)error;
+
+/// 未完成任务的 info（最近的在前）
+- (NSArray<NSDictionary *> *)pendingTaskInfos;
+- (void)discardLogForKey:(NSString *)logKey;
+
+/// runs / resumed / cancelled / batches / splits / failedItems / contacts / saveMs，
+/// 以及 bySize：{ "100": { batches, contacts, ms, contactsPerSec } }
+- (NSDictionary<NSString *, id> *)stats;
+- (void)resetStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,284 @@
+#import "CMSavePipeline.h"
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+
+static inline double CMNowMs(void) { return CACurrentMediaTime() * 1000.0; }
+
+static const NSInteger kCMSaveLogVersion = 1;
+
+@implementation CMSaveOperation {
+    BOOL _cancelled;
+}
+
+- (BOOL)isCancelled {
+    @synchronized (self) { return _cancelled; }
+}
+
+- (void)cancel {
+    @synchronized (self) { _cancelled = YES; }
+}
+
+@end
+
+@implementation CMSaveTask
+@end
+
+@implementation CMSavePipeline {
+    CNContactStore *_store;
+    NSURL *_directory;
+
+    os_unfair_lock _statLock;
+    NSUInteger _runs, _resumed, _cancelled, _batches, _splits, _failedItems, _contacts;
+    double _saveMs;
+    NSMutableDictionary<NSNumber *, NSMutableArray<NSNumber *> *> *_bySize;   // size -> [batches, contacts, ms]
+}
+
+- (instancetype)initWithStore:(CNContactStore *)store logDirectory:(NSURL *)directory {
+    if (self = [super init]) {
+        _store = store;
+        _directory = directory;
+        _batchSize = 100;
+        _statLock = OS_UNFAIR_LOCK_INIT;
+        _bySize = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark - Log
+
+- (NSURL *)_logURLForKey:(NSString *)key {
+    NSMutableString *name = [NSMutableString stringWithCapacity:key.length];
+    for (NSUInteger i = 0; i < key.length; i++) {
+        unichar c = [key characterAtIndex:i];
+        BOOL ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+        [name appendFormat:@"%C", ok ? c : (unichar)'_'];
+    }
+    return [_directory URLByAppendingPathComponent:[name stringByAppendingPathExtension:@"plist"]];
+}
+
+// done 之前的条目已处理；pending 是正要写的那个区间（带探针时才记）
+- (void)_writeLog:(NSURL *)url task:(CMSaveTask *)task done:(NSUInteger)done pending:(NSRange)pending probe:(NSDictionary *)probe {
+    if (!url) return;
+    [[NSFileManager defaultManager] createDirectoryAtURL:_directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSMutableDictionary *log = [@{
+        @"v": @(kCMSaveLogVersion),
+        @"info": task.info ?: @{},
+        @"total": @(task.total),
+        @"done": @(done),
+        @"updated": @([NSDate date].timeIntervalSince1970),
+    } mutableCopy];
+    if (probe && pending.length > 0) {
+        log[@"pendingLen"] = @(pending.length);
+        log[@"probe"] = probe;
+    }
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:log format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    [data writeToURL:url options:NSDataWritingAtomic error:nil];
+}
+
+- (NSDictionary *)_readLog:(NSURL *)url {
+    NSData *data = [NSData dataWithContentsOfURL:url];
+    if (!data) return nil;
+    id log = [NSPropertyListSerialization propertyListWithData:data options:0 format:NULL error:nil];
+    if (![log isKindOfClass:[NSDictionary class]] || [log[@"v"] integerValue] != kCMSaveLogVersion) return nil;
+    return log;
+}
+
+- (NSArray<NSDictionary *> *)pendingTaskInfos {
+    NSArray<NSURL *> *urls = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:_directory
+                                                           includingPropertiesForKeys:nil
+                                                                              options:0
+                                                                                error:nil];
+    NSMutableArray<NSDictionary *> *logs = [NSMutableArray array];
+    for (NSURL *u in urls) {
+        if (![u.pathExtension isEqualToString:@"plist"]) continue;
+        NSDictionary *log = [self _readLog:u];
+        if ([log[@"info"] isKindOfClass:[NSDictionary class]]) [logs addObject:log];
+    }
+    [logs sortUsingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return [b[@"updated"] compare:a[@"updated"]];
+    }];
+    return [logs valueForKey:@"info"];
+}
+
+- (void)discardLogForKey:(NSString *)logKey {
+    [[NSFileManager defaultManager] removeItemAtURL:[self _logURLForKey:logKey] error:nil];
+}
+
+#pragma mark - Run
+
+// 权限 / 数据库不可用：拆小也没用，直接停
+static BOOL CMSaveErrorIsFatal(NSError *e) {
+    if (![e.domain isEqualToString:CNErrorDomain]) return NO;
+    return e.code == CNErrorCodeAuthorizationDenied || e.code == CNErrorCodeCommunicationError || e.code == CNErrorCodeDataAccessError;
+}
+
+- (void)_recordBatch:(NSUInteger)size contacts:(NSUInteger)contacts ms:(double)ms {
+    os_unfair_lock_lock(&_statLock);
+    _batches += 1;
+    _contacts += contacts;
+    _saveMs += ms;
+    NSMutableArray<NSNumber *> *s = _bySize[@(size)];
+    if (!s) _bySize[@(size)] = s = [@[@0, @0, @0.0] mutableCopy];
+    s[0] = @(s[0].unsignedIntegerValue + 1);
+    s[1] = @(s[1].unsignedIntegerValue + contacts);
+    s[2] = @(s[2].doubleValue + ms);
+    os_unfair_lock_unlock(&_statLock);
+}
+
+// 一批失败就二分重试，直到单条；返回 NO 只在致命错误时。
+// 日志按实际提交的区间记：写之前记下这个区间和探针，写完（或跳过）立刻把 done 推到区间末尾，
+// 所以日志里的 pending 永远是一个 CNSaveRequest，要么整体生效要么整体没生效，不会是二分到一半的大批次
+- (BOOL)_saveRange:(NSRange)range task:(CMSaveTask *)task log:(NSURL *)logURL
+              done:(NSUInteger *)done failed:(NSUInteger *)failed error:(NSError **)error {
+    NSDictionary *probe = (logURL && task.probe) ? task.probe(range) : nil;
+    if (probe) [self _writeLog:logURL task:task done:range.location pending:range probe:probe];
+
+    BOOL ok = YES;
+    NSUInteger added = 0;
+    double t0 = CMNowMs();
+    NSError *e = nil;
+    @autoreleasepool {
+        CNSaveRequest *req = [CNSaveRequest new];
+        added = task.build(req, range);
+        if (added > 0) ok = [_store executeSaveRequest:req error:&e];
+    }
+
+    if (ok) {
+        if (added > 0) [self _recordBatch:range.length contacts:added ms:CMNowMs() - t0];
+        if (task.committed) task.committed(range, YES);
+        *done = NSMaxRange(range);
+        [self _writeLog:logURL task:task done:*done pending:NSMakeRange(*done, 0) probe:nil];
+        return YES;
+    }
+    if (CMSaveErrorIsFatal(e)) {
+        if (error) *error = e;
+        return NO;
+    }
+    if (range.length == 1) {
+        NSLog(@"[CM][save] skip item %lu err=%@", (unsigned long)range.location, e);
+        *failed += 1;
+        os_unfair_lock_lock(&_statLock);
+        _failedItems += 1;
+        os_unfair_lock_unlock(&_statLock);
+        if (task.committed) task.committed(range, NO);
+        *done = NSMaxRange(range);
+        [self _writeLog:logURL task:task done:*done pending:NSMakeRange(*done, 0) probe:nil];
+        return YES;
+    }
+
+    os_unfair_lock_lock(&_statLock);
+    _splits += 1;
+    os_unfair_lock_unlock(&_statLock);
+    NSUInteger half = range.length / 2;
+    return [self _saveRange:NSMakeRange(range.location, half) task:task log:logURL done:done failed:failed error:error] &&
+           [self _saveRange:NSMakeRange(range.location + half, range.length - half) task:task log:logURL
+                       done:done failed:failed error:error];
+}
+
+- (BOOL)runTask:(CMSaveTask *)task operation:(CMSaveOperation *)op error:(NSError **)error {
+    NSUInteger total = task.total;
+    NSURL *logURL = task.logKey.length > 0 ? [self _logURLForKey:task.logKey] : nil;
+
+    // 断点续做：同一任务（info 相同）从上次记下的位置开始
+    NSUInteger start = 0;
+    NSDictionary *log = logURL ? [self _readLog:logURL] : nil;
+    if (log && [log[@"info"] isEqual:task.info ?: @{}] && [log[@"total"] unsignedIntegerValue] == total) {
+        start = MIN([log[@"done"] unsignedIntegerValue], total);
+        NSUInteger pendingLen = [log[@"pendingLen"] unsignedIntegerValue];
+        NSDictionary *probe = [log[@"probe"] isKindOfClass:[NSDictionary class]] ? log[@"probe"] : nil;
+        if (pendingLen > 0 && probe && task.verify && pendingLen <= total - start &&
+            task.verify(NSMakeRange(start, pendingLen), probe)) {
+            start += pendingLen;
+        }
+        NSLog(@"[CM][save] resume %@ at %lu/%lu", task.logKey, (unsigned long)start, (unsigned long)total);
+    }
+
+    os_unfair_lock_lock(&_statLock);
+    _runs += 1;
+    if (start > 0) _resumed += 1;
+    os_unfair_lock_unlock(&_statLock);
+
+    CMSaveProgressBlock progress = task.progress;
+    if (progress && start > 0) {
+        dispatch_async(dispatch_get_main_queue(), ^{ progress(start, total); });
+    }
+
+    NSUInteger size = MAX(self.batchSize, (NSUInteger)1);
+    NSUInteger failed = 0;
+    NSUInteger at = start;
+    NSError *fatal = nil;
+    BOOL cancelled = NO;
+
+    while (at < total) {
+        if (op.isCancelled) { cancelled = YES; break; }
+
+        NSRange r = NSMakeRange(at, MIN(size, total - at));
+        if (![self _saveRange:r task:task log:logURL done:&at failed:&failed error:&fatal]) break;
+
+        if (progress) {
+            NSUInteger done = at;
+            dispatch_async(dispatch_get_main_queue(), ^{ progress(done, total); });
+        }
+    }
+
+    if (at >= total) {
+        if (logURL) [[NSFileManager defaultManager] removeItemAtURL:logURL error:nil];
+    } else {
+        [self _writeLog:logURL task:task done:at pending:NSMakeRange(at, 0) probe:nil];
+    }
+
+    if (cancelled) {
+        os_unfair_lock_lock(&_statLock);
+        _cancelled += 1;
+        os_unfair_lock_unlock(&_statLock);
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager"
+                                                code:600
+                                            userInfo:@{NSLocalizedDescriptionKey:@"Operation cancelled",
+                                                       @"done": @(at), @"total": @(total)}];
+        return NO;
+    }
+    if (fatal) {
+        if (error) *error = fatal;
+        return NO;
+    }
+    if (failed > 0) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager"
+                                                code:601
+                                            userInfo:@{NSLocalizedDescriptionKey:[NSString stringWithFormat:@"%lu contacts could not be saved", (unsigned long)failed],
+                                                       @"failed": @(failed), @"total": @(total)}];
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark - Stats
+
+- (NSDictionary<NSString *, id> *)stats {
+    os_unfair_lock_lock(&_statLock);
+    NSMutableDictionary<NSString *, NSDictionary *> *bySize = [NSMutableDictionary dictionary];
+    [_bySize enumerateKeysAndObjectsUsingBlock:^(NSNumber *size, NSMutableArray<NSNumber *> *s, BOOL *stop) {
+        double ms = s[2].doubleValue;
+        bySize[size.stringValue] = @{
+            @"batches": s[0], @"contacts": s[1], @"ms": @(ms),
+            @"contactsPerSec": @(ms > 0 ? s[1].doubleValue * 1000.0 / ms : 0),
+        };
+    }];
+    NSDictionary *d = @{
+        @"runs": @(_runs), @"resumed": @(_resumed), @"cancelled": @(_cancelled),
+        @"batches": @(_batches), @"splits": @(_splits), @"failedItems": @(_failedItems),
+        @"contacts": @(_contacts), @"saveMs": @(_saveMs),
+        @"bySize": bySize,
+    };
+    os_unfair_lock_unlock(&_statLock);
+    return d;
+}
+
+- (void)resetStats {
+    os_unfair_lock_lock(&_statLock);
+    _runs = _resumed = _cancelled = _batches = _splits = _failedItems = _contacts = 0;
+    _saveMs = 0;
+    [_bySize removeAllObjects];
+    os_unfair_lock_unlock(&_statLock);
+}
+
+@end
@@ -1,5 +1,6 @@
 #import <Foundation/Foundation.h>
 #import <Contacts/Contacts.h>
+#import "CMSavePipeline.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -23,14 +24,19 @@ typedef NS_ENUM(NSInteger, CMDuplicateMode) {
     CMDuplicateModeName,          // 姓名重复
     CMDuplicateModePhone,         // 电话重复
     CMDuplicateModeNameOrPhone,   // 姓名或电话任一重复（并集）
-    CMDuplicateModeAll            // 返回全部重复：分别返回姓名重复组 + 电话重复组
+    CMDuplicateModeAll,           // 返回全部重复：分别返回姓名重复组 + 电话重复组
+    CMDuplicateModeCluster        // 姓名相同 / 电话 / 邮箱任一相连即同组（传递合并，组间不重叠）；
+                                  // 之后再附上姓名相近的疑似对（possible = YES）
 };
 
 /// 重复联系人分组
 @interface CMDuplicateGroup : NSObject
-@property (nonatomic, copy) NSString *key;                 // 分组key（name或phone）
+@property (nonatomic, copy) NSString *key;                 // 分组key（name或phone；Cluster 时为首个成员的姓名键）
 @property (nonatomic, assign) CMDuplicateMode by;          // 本组是按姓名还是按号码
 @property (nonatomic, strong) NSArray<CNContact *> *items; // 组内联系人
+/// 只是姓名相近（音译后相同 / 1~2 处错字），没有共同的姓名 / 电话 / 邮箱：固定两人，不传递，
+/// 不计入重复数、不参与全选，由用户自己确认
+@property (nonatomic, assign) BOOL possible;
 @end
 
 /// 备份元信息
@@ -64,6 +70,12 @@ FOUNDATION_EXPORT NSString * const CMBackupsDidChangeNotification;
 
 - (void)fetchDashboardCounts:(CMDashboardCountsBlock)completion;
 
+/// 联系人索引（变更历史增量更新）的统计：fullRebuilds / incrementalRefreshes / eventsApplied / lastRefreshMs ...
+- (NSDictionary<NSString *, NSNumber *> *)contactIndexStats;
+
+/// 分批保存（删除 / 恢复）的统计：batches / splits / failedItems / bySize 下每种批大小的 contactsPerSec ...
+- (NSDictionary<NSString *, id> *)saveStats;
+
 /// 权限（建议App启动时调用一次）
 - (void)requestContactsAccess:(CMVoidBlock)completion;
 
@@ -73,6 +85,10 @@ FOUNDATION_EXPORT NSString * const CMBackupsDidChangeNotification;
 /// 2 删除选中联系人（传 identifier 列表）
 - (void)deleteContactsWithIdentifiers:(NSArray<NSString *> *)identifiers
                            completion:(CMVoidBlock)completion;
+/// 分批删除；批次之间可 cancel（已删的不回滚），个别删不掉时 error.code = 601
+- (CMSaveOperation *)deleteContactsWithIdentifiers:(NSArray<NSString *> *)identifiers
+                                          progress:(nullable CMSaveProgressBlock)progress
+                                        completion:(CMVoidBlock)completion;
 
 /// 3 备份选中联系人（传 identifier 列表，生成一个备份）
 - (void)backupContactsWithIdentifiers:(NSArray<NSString *> *)identifiers
@@ -94,6 +110,27 @@ FOUNDATION_EXPORT NSString * const CMBackupsDidChangeNotification;
                         contactIndicesInBackup:(NSArray<NSNumber *> *)indices
                                     completion:(CMVoidBlock)completion;
 
+/// 以上三种恢复的分批版本：只解析选中的条目，按批写入，有进度、可取消（error.code = 600）。
+/// 进度落盘，被取消 / 杀进程后用同样的参数再调一次（或 resumeInterruptedRestore）从断点继续，不会重复新增
+- (CMSaveOperation *)restoreContactsFromBackupId:(NSString *)backupId
+                           contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                         progress:(nullable CMSaveProgressBlock)progress
+                                       completion:(CMVoidBlock)completion;
+- (CMSaveOperation *)restoreContactsSmartFromBackupId:(NSString *)backupId
+                               contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                             progress:(nullable CMSaveProgressBlock)progress
+                                           completion:(CMVoidBlock)completion;
+- (CMSaveOperation *)restoreContactsOverwriteAllFromBackupId:(NSString *)backupId
+                                      contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                                    progress:(nullable CMSaveProgressBlock)progress
+                                                  completion:(CMVoidBlock)completion;
+
+/// 有没有中断了的恢复（启动时可提示用户继续）
+- (BOOL)hasInterruptedRestore;
+/// 继续最近一次中断的恢复；没有时直接回调 nil 并返回 nil；备份已被改过时放弃并回调 603
+- (nullable CMSaveOperation *)resumeInterruptedRestoreWithProgress:(nullable CMSaveProgressBlock)progress
+                                                        completion:(CMVoidBlock)completion;
+
 /// 5 获取重复联系人（姓名重复/电话重复/全部）
 - (void)fetchDuplicateContactsWithMode:(CMDuplicateMode)mode
                             completion:(CMDuplicatesBlock)completion;
@@ -106,6 +143,10 @@ FOUNDATION_EXPORT NSString * const CMBackupsDidChangeNotification;
 /// 7 获取备份列表 & 备份里的联系人列表
 - (void)fetchBackupList:(CMBackupsBlock)completion;
 - (void)fetchContactsInBackupId:(NSString *)backupId completion:(CMBackupContactsBlock)completion;
+/// 分页读取备份里的联系人（按备份内下标，超出部分截掉）；只解析这一页的 vCard
+- (void)fetchContactsInBackupId:(NSString *)backupId
+                          range:(NSRange)range
+                     completion:(CMBackupContactsBlock)completion;
 
 // 删除备份内的部分联系人（按备份内下标删除）
 - (void)deleteContactsFromBackupId:(NSString *)backupId
@@ -1,5 +1,11 @@
 #import "ContactsManager.h"
 #import <Contacts/Contacts.h>
+#import "CMContactIndex.h"
+#import "CMContactCluster.h"
+#import "CMContactKey.h"
+#import "CMBackupFormat.h"
+#import "CMSavePipeline.h"
+#import <compression.h>
 
 NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotification";
 
@@ -15,6 +21,8 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 @interface ContactsManager ()
 @property (nonatomic, strong) CNContactStore *store;
 @property (nonatomic, strong) dispatch_queue_t workQueue;
+@property (nonatomic, strong) CMContactIndex *contactIndex; // 只在 workQueue 上用
+@property (nonatomic, strong) CMSavePipeline *savePipeline;   // run 只在 workQueue 上调
 @end
 
 @implementation ContactsManager
@@ -32,6 +40,9 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
     if (self = [super init]) {
         _store = [[CNContactStore alloc] init];
         _workQueue = dispatch_queue_create("com.contacts.manager.queue", DISPATCH_QUEUE_SERIAL);
+        NSURL *support = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+        _savePipeline = [[CMSavePipeline alloc] initWithStore:_store
+                                                 logDirectory:[support URLByAppendingPathComponent:@"CMSaveOps" isDirectory:YES]];
     }
     return self;
 }
@@ -120,68 +131,108 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
             return;
         }
 
+        // 索引增量更新（变更历史）；只有首次 / token 失效时才整表枚举
         NSError *error = nil;
-        __block NSUInteger allCount = 0;
-        __block NSUInteger incompleteCount = 0;
+        CMContactIndex *index = [self _refreshedContactIndex:&error];
+        NSUInteger allCount = index.count;
+        NSUInteger incompleteCount = index.incompleteCount;
+        NSUInteger duplicateCount = 0;
+        for (NSArray<NSString *> *ids in [self _clusterIdentifiersInIndex:index possible:NULL]) duplicateCount += ids.count;
 
-        NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *nameMap = [NSMutableDictionary dictionary];
-        NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *phoneMap = [NSMutableDictionary dictionary];
-
-        CNContactFetchRequest *req =
-            [[CNContactFetchRequest alloc] initWithKeysToFetch:[self _keysForDashboardCounts]];
-        req.unifyResults = YES;
-
-        BOOL ok = [self.store enumerateContactsWithFetchRequest:req
-                                                         error:&error
-                                                    usingBlock:^(CNContact * _Nonnull c, BOOL * _Nonnull stop) {
-            @autoreleasepool {
-                allCount++;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completion) completion(allCount, incompleteCount, duplicateCount, backupCount, error);
+        });
+    });
+}
 
-                BOOL n = [self _isNameMissing:c];
-                BOOL p = [self _isPhoneMissing:c];
-                if (n || p) incompleteCount++;
+#pragma mark - Contact index
 
-                NSString *cid = c.identifier ?: @"";
-                if (cid.length == 0) return;
+// 索引要的键：dashboard 的姓名 / 电话 + 邮箱（智能恢复按邮箱匹配）
+- (NSArray<id<CNKeyDescriptor>> *)_keysForContactIndex {
+    return [[self _keysForDashboardCounts] arrayByAddingObject:CNContactEmailAddressesKey];
+}
 
-                NSString *nk = [self _normalizeName:c];
-                if (nk.length > 0) {
-                    NSMutableSet *set = nameMap[nk] ?: (nameMap[nk] = [NSMutableSet set]);
-                    [set addObject:cid];
-                }
+// 文件名不带版本：格式版本只看文件里的 v（kCMContactIndexVersion），不符就重建。
+// 早先带 .v1 后缀的文件不会再被读到，顺手删掉
+- (NSURL *)_contactIndexURL {
+    NSURL *dir = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    [[NSFileManager defaultManager] removeItemAtURL:[dir URLByAppendingPathComponent:@"CMContactIndex.v1"] error:nil];
+    return [dir URLByAppendingPathComponent:@"CMContactIndex"];
+}
 
-                if ([c isKeyAvailable:CNContactPhoneNumbersKey]) {
-                    for (CNLabeledValue<CNPhoneNumber *> *lv in (c.phoneNumbers ?: @[])) {
-                        NSString *pk = [self _normalizePhone:lv.value.stringValue];
-                        if (pk.length == 0) continue;
+- (CMContactIndexEntry *)_indexEntryForContact:(CNContact *)c {
+    if (c.identifier.length == 0) return nil;
+    CMContactIndexEntry *e = [CMContactIndexEntry new];
+    e.identifier = c.identifier;
+    e.nameKey = [self _normalizeName:c] ?: @"";
+    e.fuzzyName = [self _fuzzyNameForContact:c];
+    e.nameMissing = [self _isNameMissing:c];
+    e.phoneMissing = [self _isPhoneMissing:c];
 
-                        NSMutableSet *set = phoneMap[pk] ?: (phoneMap[pk] = [NSMutableSet set]);
-                        [set addObject:cid];
-                    }
-                }
-            }
-        }];
+    NSMutableOrderedSet<NSString *> *phones = [NSMutableOrderedSet orderedSet];
+    if ([c isKeyAvailable:CNContactPhoneNumbersKey]) {
+        for (CNLabeledValue<CNPhoneNumber *> *lv in (c.phoneNumbers ?: @[])) {
+            NSString *pk = [self _normalizePhone:lv.value.stringValue];
+            if (pk.length > 0) [phones addObject:pk];
+        }
+    }
+    e.phoneKeys = phones.array;
 
-        if (!ok && !error) {
-            error = [NSError errorWithDomain:@"ContactsManager"
-                                        code:901
-                                    userInfo:@{NSLocalizedDescriptionKey:@"Enumerate contacts failed"}];
+    NSMutableOrderedSet<NSString *> *emails = [NSMutableOrderedSet orderedSet];
+    if ([c isKeyAvailable:CNContactEmailAddressesKey]) {
+        for (CNLabeledValue<NSString *> *lv in (c.emailAddresses ?: @[])) {
+            NSString *ek = [self _normalizeEmailForMatch:lv.value];
+            if (ek.length > 0) [emails addObject:ek];
         }
+    }
+    e.emailKeys = emails.array;
+    return e;
+}
 
-        NSMutableSet<NSString *> *dupIds = [NSMutableSet set];
-        [nameMap enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableSet<NSString *> *obj, BOOL *stop) {
-            if (obj.count >= 2) [dupIds unionSet:obj];
-        }];
-        [phoneMap enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableSet<NSString *> *obj, BOOL *stop) {
-            if (obj.count >= 2) [dupIds unionSet:obj];
+// workQueue 上调用；失败时返回 nil
+- (CMContactIndex *)_refreshedContactIndex:(NSError **)error {
+    if (!self.contactIndex) {
+        __weak typeof(self) weakSelf = self;
+        self.contactIndex = [[CMContactIndex alloc] initWithStore:self.store
+                                                          fileURL:[self _contactIndexURL]
+                                                      keysToFetch:[self _keysForContactIndex]
+                                                     entryBuilder:^CMContactIndexEntry *(CNContact *c) {
+            return [weakSelf _indexEntryForContact:c];
         }];
+    }
+    NSError *e = nil;
+    if (![self.contactIndex refresh:&e]) {
+        if (error) *error = e ?: [NSError errorWithDomain:@"ContactsManager"
+                                                    code:901
+                                                userInfo:@{NSLocalizedDescriptionKey:@"Enumerate contacts failed"}];
+        return nil;
+    }
+    return self.contactIndex;
+}
 
-        NSUInteger duplicateCount = dupIds.count;
+// 按索引里的顺序取出这些联系人（只取这一批，不整表枚举）
+- (NSDictionary<NSString *, CNContact *> *)_contactsByIdForIdentifiers:(NSArray<NSString *> *)identifiers
+                                                                  keys:(NSArray<id<CNKeyDescriptor>> *)keys
+                                                                 error:(NSError **)error {
+    if (identifiers.count == 0) return @{};
+    NSPredicate *pred = [CNContact predicateForContactsWithIdentifiers:identifiers];
+    NSArray<CNContact *> *arr = [self.store unifiedContactsMatchingPredicate:pred keysToFetch:keys error:error];
+    if (!arr) return nil;
+    NSMutableDictionary<NSString *, CNContact *> *map = [NSMutableDictionary dictionaryWithCapacity:arr.count];
+    for (CNContact *c in arr) {
+        if (c.identifier.length > 0) map[c.identifier] = c;
+    }
+    return map;
+}
 
-        dispatch_async(dispatch_get_main_queue(), ^{
-            if (completion) completion(allCount, incompleteCount, duplicateCount, backupCount, error);
-        });
-    });
+- (NSDictionary<NSString *, NSNumber *> *)contactIndexStats {
+    __block NSDictionary *d = nil;
+    dispatch_sync(self.workQueue, ^{ d = [self.contactIndex stats] ?: @{}; });
+    return d;
+}
+
+- (NSDictionary<NSString *, id> *)saveStats {
+    return [self.savePipeline stats];
 }
 
 #pragma mark - Keys
@@ -278,6 +329,14 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 #pragma mark - 2 Delete
 
 - (void)deleteContactsWithIdentifiers:(NSArray<NSString *> *)identifiers completion:(CMVoidBlock)completion {
+    [self deleteContactsWithIdentifiers:identifiers progress:nil completion:completion];
+}
+
+// 分批删除：重跑同一批删除是幂等的（已删的取不到），所以不记日志
+- (CMSaveOperation *)deleteContactsWithIdentifiers:(NSArray<NSString *> *)identifiers
+                                          progress:(CMSaveProgressBlock)progress
+                                        completion:(CMVoidBlock)completion {
+    CMSaveOperation *op = [CMSaveOperation new];
     dispatch_async(self.workQueue, ^{
         NSError *error = nil;
         NSArray<CNContact *> *contacts = [self _fetchContactsByIdentifiers:identifiers error:&error];
@@ -286,18 +345,22 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
             return;
         }
 
-        CNSaveRequest *req = [[CNSaveRequest alloc] init];
-        for (CNContact *c in contacts) {
-            CNMutableContact *mc = [c mutableCopy];
-            [req deleteContact:mc];
-        }
+        CMSaveTask *task = [CMSaveTask new];
+        task.total = contacts.count;
+        task.progress = progress;
+        task.build = ^NSUInteger(CNSaveRequest *req, NSRange r) {
+            for (NSUInteger i = r.location; i < NSMaxRange(r); i++) {
+                [req deleteContact:[contacts[i] mutableCopy]];
+            }
+            return r.length;
+        };
 
-        BOOL ok = [self.store executeSaveRequest:req error:&error];
+        BOOL ok = [self.savePipeline runTask:task operation:op error:&error];
         dispatch_async(dispatch_get_main_queue(), ^{
-            if (!ok) { if (completion) completion(error); }
-            else { if (completion) completion(nil); }
+            if (completion) completion(ok ? nil : error);
         });
     });
+    return op;
 }
 
 #pragma mark - Backup Storage (vCard)
@@ -367,10 +430,250 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 }
 
 
+// 旧格式：整个 vCard base64 进 JSON；只读（打开时转换成容器）
 - (NSURL *)_backupFileURL:(NSString *)backupId {
     return [[self _backupRootURL] URLByAppendingPathComponent:[NSString stringWithFormat:@"%@.json", backupId]];
 }
 
+// 新格式：Header + 偏移表 + 每人一条 vCard（CMBackupFormat）
+- (NSURL *)_backupContainerURL:(NSString *)backupId {
+    return [[self _backupRootURL] URLByAppendingPathComponent:[NSString stringWithFormat:@"%@.cmbk", backupId]];
+}
+
+// 死字节超过活字节且总量超过这个值才压缩
+static const uint64_t kCMBackupCompactMinBytes = 256 * 1024;
+
+// 单条 vCard 压缩后省不到 1/8 就存原文（带头像的基本压不动）
+static NSData *CMBackupEncodeRecord(NSData *raw, uint32_t *flags) {
+    *flags = 0;
+    if (raw.length < 256) return raw;
+    NSMutableData *dst = [NSMutableData dataWithLength:raw.length];
+    size_t n = compression_encode_buffer(dst.mutableBytes, dst.length, raw.bytes, raw.length, NULL, COMPRESSION_LZFSE);
+    if (n == 0 || n > raw.length - raw.length / 8) return raw;
+    dst.length = n;
+    *flags = CM_BK_COMPRESSED;
+    return dst;
+}
+
+static NSData *CMBackupDecodeRecord(const CMBackupRecord *r) {
+    if (!(r->flags & CM_BK_COMPRESSED)) return [NSData dataWithBytes:r->bytes length:r->storedLen];
+    NSMutableData *dst = [NSMutableData dataWithLength:r->rawLen];
+    size_t n = compression_decode_buffer(dst.mutableBytes, dst.length, r->bytes, r->storedLen, NULL, COMPRESSION_LZFSE);
+    return n == r->rawLen ? dst : nil;
+}
+
+- (BOOL)_writeBackupContainer:(NSArray<CNContact *> *)contacts
+                     backupId:(NSString *)backupId
+                         name:(NSString *)name
+                       dateMs:(long long)dateMs
+                        error:(NSError **)error {
+    CMBackupWriter *w = cm_bk_writer_create();
+    BOOL ok = (w != NULL);
+    for (CNContact *c in contacts) {
+        if (!ok) break;
+        @autoreleasepool {
+            NSData *raw = [CNContactVCardSerialization dataWithContacts:@[c] error:error];
+            if (!raw) { ok = NO; break; }
+            uint32_t flags = 0;
+            NSData *stored = CMBackupEncodeRecord(raw, &flags);
+            ok = cm_bk_writer_add(w, stored.bytes, (uint32_t)stored.length, (uint32_t)raw.length, flags);
+        }
+    }
+
+    NSData *idData = [backupId dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *nameData = [name dataUsingEncoding:NSUTF8StringEncoding];
+    uint8_t *bytes = NULL;
+    size_t len = 0;
+    ok = ok && cm_bk_writer_finish(w, idData.bytes, (uint32_t)idData.length,
+                                   nameData.bytes, (uint32_t)nameData.length, dateMs, &bytes, &len);
+    cm_bk_writer_destroy(w);
+    if (!ok) {
+        if (error && !*error) {
+            *error = [NSError errorWithDomain:@"ContactsManager"
+                                         code:302
+                                     userInfo:@{NSLocalizedDescriptionKey:@"vCard serialization failed"}];
+        }
+        return NO;
+    }
+
+    NSData *file = [NSData dataWithBytesNoCopy:bytes length:len freeWhenDone:YES];
+    return [file writeToURL:[self _backupContainerURL:backupId] options:NSDataWritingAtomic error:error];
+}
+
+// 旧 JSON 备份转成容器（只做一次），成功后删掉 JSON
+- (BOOL)_migrateLegacyBackup:(NSString *)backupId error:(NSError **)error {
+    NSURL *legacyURL = [self _backupFileURL:backupId];
+    NSData *data = [NSData dataWithContentsOfURL:legacyURL];
+    if (!data) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:100 userInfo:@{NSLocalizedDescriptionKey:@"Backup not found"}];
+        return NO;
+    }
+    NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+    if (![json isKindOfClass:[NSDictionary class]]) return NO;
+
+    NSString *b64 = [json[@"vcardBase64"] isKindOfClass:[NSString class]] ? json[@"vcardBase64"] : @"";
+    NSData *vcard = [[NSData alloc] initWithBase64EncodedString:b64 options:0];
+    if (!vcard) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:101 userInfo:@{NSLocalizedDescriptionKey:@"Invalid vCard data"}];
+        return NO;
+    }
+    NSArray<CNContact *> *contacts = @[];
+    if (vcard.length > 0) {
+        contacts = [CNContactVCardSerialization contactsWithData:vcard error:error];
+        if (!contacts) return NO;
+    }
+
+    NSString *name = [json[@"name"] isKindOfClass:[NSString class]] ? json[@"name"] : @"";
+    long long ms = [json[@"date"] longLongValue];
+    if (![self _writeBackupContainer:contacts backupId:backupId name:name dateMs:ms error:error]) return NO;
+
+    [[NSFileManager defaultManager] removeItemAtURL:legacyURL error:nil];
+    NSLog(@"[CM][backup] migrated legacy backup=%@ count=%lu", backupId, (unsigned long)contacts.count);
+    return YES;
+}
+
+// 映射整个备份文件并打开；data 须在 view 关闭前持有
+- (CMBackupView *)_openBackup:(NSString *)backupId data:(NSData **)outData error:(NSError **)error {
+    NSURL *url = [self _backupContainerURL:backupId];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:url.path] &&
+        ![self _migrateLegacyBackup:backupId error:error]) {
+        return NULL;
+    }
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+    if (!data) return NULL;
+    CMBackupView *v = cm_bk_open(data.bytes, data.length);
+    if (!v) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:102 userInfo:@{NSLocalizedDescriptionKey:@"Backup file is damaged"}];
+        return NULL;
+    }
+    *outData = data;
+    return v;
+}
+
+// 只解析需要的那些条；indexes 为 nil = 全部，超出条数的下标忽略
+- (NSArray<CNContact *> *)_contactsInBackupId:(NSString *)backupId
+                                      indexes:(nullable NSIndexSet *)indexes
+                                        error:(NSError **)error {
+    NSData *data = nil;
+    CMBackupView *v = [self _openBackup:backupId data:&data error:error];
+    if (!v) return nil;
+
+    NSUInteger live = cm_bk_live_count(v);
+    if (!indexes) indexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, live)];
+
+    NSMutableArray<CNContact *> *out = [NSMutableArray arrayWithCapacity:MIN(indexes.count, live)];
+    __block BOOL ok = YES;
+    [indexes enumerateIndexesInRange:NSMakeRange(0, live) options:0 usingBlock:^(NSUInteger i, BOOL *stop) {
+        @autoreleasepool {
+            CMBackupRecord r;
+            NSData *raw = cm_bk_get(v, (uint32_t)i, &r) ? CMBackupDecodeRecord(&r) : nil;
+            CNContact *c = raw ? [CNContactVCardSerialization contactsWithData:raw error:nil].firstObject : nil;
+            if (!c) { ok = NO; *stop = YES; return; }
+            [out addObject:c];
+        }
+    }];
+    cm_bk_close(v);
+
+    if (!ok) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:101 userInfo:@{NSLocalizedDescriptionKey:@"Invalid vCard data"}];
+        return nil;
+    }
+    return out;
+}
+
+// 列表用：只读 Header + 字符串，不碰记录
+- (nullable CMBackupInfo *)_backupInfoFromContainerAtURL:(NSURL *)url {
+    NSFileHandle *fh = [NSFileHandle fileHandleForReadingFromURL:url error:nil];
+    if (!fh) return nil;
+    NSData *first = [fh readDataUpToLength:CM_BK_HEADER_BYTES error:nil];
+    size_t metaLen = first ? cm_bk_meta_len(first.bytes, first.length) : 0;
+    NSData *meta = nil;
+    if (metaLen > 0 && [fh seekToOffset:0 error:nil]) meta = [fh readDataUpToLength:metaLen error:nil];
+    [fh closeAndReturnError:nil];
+
+    CMBackupHeader h;
+    if (!meta || !cm_bk_read_header(meta.bytes, meta.length, &h)) return nil;
+
+    CMBackupInfo *info = [CMBackupInfo new];
+    info.backupId = [[NSString alloc] initWithBytes:h.backupId length:h.idLen encoding:NSUTF8StringEncoding] ?: @"";
+    info.name = [[NSString alloc] initWithBytes:h.name length:h.nameLen encoding:NSUTF8StringEncoding] ?: @"";
+    info.date = [NSDate dateWithTimeIntervalSince1970:(h.dateMs / 1000.0)];
+    info.count = h.live;
+    return info.backupId.length > 0 ? info : nil;
+}
+
+// 按活下标打墓碑：只改写文件头部（Header + 偏移表），记录字节不动。返回删除条数，-1 = 失败
+// 不原地写：头部写一半会让 Header 计数与表对不上，cm_bk_open 会把整份备份判成损坏。
+// 先复制一份（APFS 上是 clone，不拷记录字节），在副本上改头部并落盘，再整体替换原文件。
+- (NSInteger)_tombstoneIndices:(NSArray<NSNumber *> *)indices
+                  inBackupAtURL:(NSURL *)url
+                      liveAfter:(NSUInteger *)liveAfter
+                          error:(NSError **)error {
+    NSFileHandle *fh = [NSFileHandle fileHandleForReadingFromURL:url error:error];
+    if (!fh) return -1;
+
+    NSData *first = [fh readDataUpToLength:CM_BK_HEADER_BYTES error:error];
+    size_t headLen = first ? cm_bk_head_len(first.bytes, first.length) : 0;
+    NSMutableData *head = nil;
+    if (headLen > 0 && [fh seekToOffset:0 error:error]) head = [[fh readDataUpToLength:headLen error:error] mutableCopy];
+    [fh closeAndReturnError:nil];
+    if (head.length != headLen || headLen == 0) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:102 userInfo:@{NSLocalizedDescriptionKey:@"Backup file is damaged"}];
+        return -1;
+    }
+
+    uint32_t *idx = malloc(sizeof(uint32_t) * MAX(indices.count, (NSUInteger)1));
+    uint32_t n = 0;
+    for (NSNumber *num in indices) {
+        NSInteger i = num.integerValue;
+        if (i >= 0 && i < (NSInteger)UINT32_MAX) idx[n++] = (uint32_t)i;
+    }
+    uint32_t removed = idx ? cm_bk_delete(head.mutableBytes, headLen, idx, n) : 0;
+    free(idx);
+    if (removed == 0) {
+        if (error) *error = [NSError errorWithDomain:@"ContactsManager" code:122 userInfo:@{NSLocalizedDescriptionKey:@"Indices out of range"}];
+        return -1;
+    }
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *tmpName = [NSString stringWithFormat:@".%@.%@.tmp", url.lastPathComponent, [NSUUID UUID].UUIDString];
+    NSURL *tmp = [url.URLByDeletingLastPathComponent URLByAppendingPathComponent:tmpName];
+    BOOL ok = [fm copyItemAtURL:url toURL:tmp error:error];
+    if (ok) {
+        NSFileHandle *out = [NSFileHandle fileHandleForUpdatingURL:tmp error:error];
+        ok = out && [out seekToOffset:0 error:error] && [out writeData:head error:error] && [out synchronizeAndReturnError:error];
+        [out closeAndReturnError:nil];
+    }
+    ok = ok && [fm replaceItemAtURL:url withItemAtURL:tmp backupItemName:nil options:0 resultingItemURL:nil error:error];
+    if (!ok) {
+        [fm removeItemAtURL:tmp error:nil];
+        return -1;
+    }
+
+    CMBackupHeader h;
+    cm_bk_read_header(head.bytes, head.length, &h);
+    if (liveAfter) *liveAfter = h.live;
+    return removed;
+}
+
+// 死字节攒多了：重写成只含活记录的新文件（best-effort，失败不影响数据）
+- (void)_compactBackupIfNeededAtURL:(NSURL *)url {
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil];
+    CMBackupView *v = data ? cm_bk_open(data.bytes, data.length) : NULL;
+    if (!v) return;
+    uint8_t *bytes = NULL;
+    size_t len = 0;
+    BOOL compacted = cm_bk_should_compact(v, kCMBackupCompactMinBytes) && cm_bk_compact(v, &bytes, &len);
+    cm_bk_close(v);
+    if (!compacted) return;
+
+    NSError *err = nil;
+    NSData *out = [NSData dataWithBytesNoCopy:bytes length:len freeWhenDone:YES];
+    BOOL ok = [out writeToURL:url options:NSDataWritingAtomic error:&err];
+    NSLog(@"[CM][backup] compact %@ %lu -> %lu ok=%d err=%@",
+          url.lastPathComponent, (unsigned long)data.length, (unsigned long)len, ok, err);
+}
+
 #pragma mark - 3 Backup Selected
 
 - (void)backupContactsWithIdentifiers:(NSArray<NSString *> *)identifiers
@@ -402,49 +705,21 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
             return;
         }
 
-        // 2) vCard 序列化
-        NSData *vcard = [CNContactVCardSerialization dataWithContacts:contacts error:&error];
-        if (!vcard || error) {
-            NSError *e = error ?: [NSError errorWithDomain:@"ContactsManager"
-                                                     code:302
-                                                 userInfo:@{NSLocalizedDescriptionKey:@"vCard serialization failed"}];
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, e); });
-            return;
-        }
-
-        // 3) 生成备份 JSON
+        // 2) 确保目录存在
         NSString *backupId = [[NSUUID UUID] UUIDString];
         NSDate *now = [NSDate date];
-
-        NSDictionary *backupJson = @{
-            @"backupId": backupId,
-            @"name": backupName ?: @"Backup",
-            @"date": @((long long)(now.timeIntervalSince1970 * 1000)),
-            @"count": @(contacts.count),
-            @"vcardBase64": [vcard base64EncodedStringWithOptions:0]
-        };
-
-        // 4) 确保目录存在
         [self _ensureBackupDir];
 
         NSLog(@"[CM][backup] bundleId=%@", [[NSBundle mainBundle] bundleIdentifier]);
         NSLog(@"[CM][backup] root=%@", [self _backupRootURL].path);
 
-        // 5) 写备份文件（先写文件，后写 index）
-        NSURL *fileURL = [self _backupFileURL:backupId];
-
-        NSData *data = [NSJSONSerialization dataWithJSONObject:backupJson
-                                                       options:NSJSONWritingPrettyPrinted
-                                                         error:&error];
-        if (!data || error) {
-            NSError *e = error ?: [NSError errorWithDomain:@"ContactsManager"
-                                                     code:303
-                                                 userInfo:@{NSLocalizedDescriptionKey:@"Backup JSON encode failed"}];
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, e); });
-            return;
-        }
-
-        BOOL ok = [data writeToURL:fileURL options:NSDataWritingAtomic error:&error];
+        // 3) 每人一条 vCard 写进容器（先写文件，后写 index）
+        NSURL *fileURL = [self _backupContainerURL:backupId];
+        BOOL ok = [self _writeBackupContainer:contacts
+                                     backupId:backupId
+                                         name:backupName ?: @"Backup"
+                                       dateMs:(long long)(now.timeIntervalSince1970 * 1000)
+                                        error:&error];
 
         BOOL exists = [[NSFileManager defaultManager] fileExistsAtPath:fileURL.path];
         NSDictionary *attr = exists ? [[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:nil] : nil;
@@ -462,7 +737,7 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
             return;
         }
 
-        // 6) 更新 index.json
+        // 4) 更新 index.json
         NSDictionary *idx = [self _readBackupIndex];
         NSMutableArray *arr = [idx[@"backups"] mutableCopy];
         if (![arr isKindOfClass:[NSMutableArray class]]) arr = [NSMutableArray array];
@@ -600,8 +875,17 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
     NSMutableArray<CMBackupInfo *> *out = [NSMutableArray array];
 
     for (NSURL *u in urls) {
-        if (![[u.pathExtension lowercaseString] isEqualToString:@"json"]) continue;
+        NSString *ext = [u.pathExtension lowercaseString];
+        if ([ext isEqualToString:@"cmbk"]) {
+            CMBackupInfo *info = [self _backupInfoFromContainerAtURL:u];
+            if (info) [out addObject:info];
+            continue;
+        }
+        if (![ext isEqualToString:@"json"]) continue;
         if ([[u.lastPathComponent lowercaseString] isEqualToString:@"index.json"]) continue;
+        // 转换到一半（容器已写、JSON 未删）时以容器为准
+        NSString *bidFromName = u.lastPathComponent.stringByDeletingPathExtension;
+        if ([[NSFileManager defaultManager] fileExistsAtPath:[self _backupContainerURL:bidFromName].path]) continue;
 
         NSData *data = [NSData dataWithContentsOfURL:u];
         if (!data || data.length == 0) {
@@ -645,27 +929,27 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 - (void)fetchContactsInBackupId:(NSString *)backupId completion:(CMBackupContactsBlock)completion {
     dispatch_async(self.workQueue, ^{
         NSError *error = nil;
-        NSData *data = [NSData dataWithContentsOfURL:[self _backupFileURL:backupId]];
-        if (!data) {
-            error = [NSError errorWithDomain:@"ContactsManager" code:100 userInfo:@{NSLocalizedDescriptionKey:@"Backup not found"}];
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, error); });
-            return;
-        }
-        NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
-        if (!json || error) {
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, error); });
-            return;
-        }
+        NSArray<CNContact *> *contacts = [self _contactsInBackupId:backupId indexes:nil error:&error];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completion) completion(contacts, error);
+        });
+    });
+}
 
-        NSString *b64 = json[@"vcardBase64"];
-        NSData *vcard = [[NSData alloc] initWithBase64EncodedString:b64 options:0];
-        if (!vcard) {
-            NSError *e = [NSError errorWithDomain:@"ContactsManager" code:101 userInfo:@{NSLocalizedDescriptionKey:@"Invalid vCard data"}];
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, e); });
-            return;
+- (void)fetchContactsInBackupId:(NSString *)backupId
+                          range:(NSRange)range
+                     completion:(CMBackupContactsBlock)completion {
+    dispatch_async(self.workQueue, ^{
+        NSError *error = nil;
+        NSUInteger len = MIN(range.length, (NSUInteger)UINT32_MAX);
+        NSArray<CNContact *> *contacts = nil;
+        if (range.location <= UINT32_MAX) {
+            contacts = [self _contactsInBackupId:backupId
+                                         indexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(range.location, len)]
+                                           error:&error];
+        } else {
+            contacts = @[];
         }
-
-        NSArray<CNContact *> *contacts = [CNContactVCardSerialization contactsWithData:vcard error:&error];
         dispatch_async(dispatch_get_main_queue(), ^{
             if (completion) completion(contacts, error);
         });
@@ -674,45 +958,261 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 
 #pragma mark - 4 Restore Selected From Backup
 
+static NSString * const kCMRestoreSelected  = @"selected";
+static NSString * const kCMRestoreSmart     = @"smart";
+static NSString * const kCMRestoreOverwrite = @"overwrite";
+
 - (void)restoreContactsFromBackupId:(NSString *)backupId
              contactIndicesInBackup:(NSArray<NSNumber *> *)indices
                         completion:(CMVoidBlock)completion {
-    // 先把备份里解析出来，然后根据 indices 选中，再逐个 addContact
-    [self fetchContactsInBackupId:backupId completion:^(NSArray<CNContact *> * _Nullable contacts, NSError * _Nullable error) {
-        if (error || !contacts) { if (completion) completion(error); return; }
+    [self restoreContactsFromBackupId:backupId contactIndicesInBackup:indices progress:nil completion:completion];
+}
 
-        dispatch_async(self.workQueue, ^{
-            NSError *e = nil;
-            NSMutableArray<CNContact *> *selected = [NSMutableArray array];
+- (CMSaveOperation *)restoreContactsFromBackupId:(NSString *)backupId
+                           contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                         progress:(CMSaveProgressBlock)progress
+                                       completion:(CMVoidBlock)completion {
+    return [self _restoreFromBackupId:backupId kind:kCMRestoreSelected indices:indices expectLive:nil progress:progress completion:completion];
+}
 
-            if (indices.count == 0) {
-                [selected addObjectsFromArray:contacts];
-            } else {
-                for (NSNumber *n in indices) {
-                    NSInteger i = n.integerValue;
-                    if (i >= 0 && i < (NSInteger)contacts.count) {
-                        [selected addObject:contacts[i]];
+#pragma mark - Batched Restore
+
+- (NSUInteger)_liveCountInBackupId:(NSString *)backupId error:(NSError **)error {
+    NSData *data = nil;
+    CMBackupView *v = [self _openBackup:backupId data:&data error:error];
+    if (!v) return NSNotFound;
+    NSUInteger live = cm_bk_live_count(v);
+    cm_bk_close(v);
+    return live;
+}
+
+// 同名联系人数：恢复日志的探针（-1 = 查不了）
+- (NSInteger)_countContactsMatchingName:(NSString *)name {
+    if (name.length == 0) return -1;
+    NSArray *arr = [self.store unifiedContactsMatchingPredicate:[CNContact predicateForContactsMatchingName:name]
+                                                    keysToFetch:@[CNContactIdentifierKey]
+                                                          error:nil];
+    return arr ? (NSInteger)arr.count : -1;
+}
+
+// 所有恢复方式共用：只解析选中的那些条，分批写入，进度落盘。
+// 日志 info 记 {kind, backupId, live, ranges}，同一备份同一选择再恢复时从断点继续；
+// 探针记下这一批第一个会新增、且有名字的联系人的同名数，「写完了但没来得及记日志」时靠它判断，避免重复新增。
+// expectLive 非 nil 表示续做：备份在中断后被改过（活条数变了）就放弃日志，下标已经对不上
+- (CMSaveOperation *)_restoreFromBackupId:(NSString *)backupId
+                                     kind:(NSString *)kind
+                                  indices:(NSArray<NSNumber *> *)indices
+                               expectLive:(nullable NSNumber *)expectLive
+                                 progress:(CMSaveProgressBlock)progress
+                               completion:(CMVoidBlock)completion {
+    CMSaveOperation *op = [CMSaveOperation new];
+    dispatch_async(self.workQueue, ^{
+        void (^finish)(NSError *) = ^(NSError *e) {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
+        };
+        NSString *logKey = [NSString stringWithFormat:@"restore-%@-%@", kind, backupId];
+
+        NSError *error = nil;
+        NSUInteger live = [self _liveCountInBackupId:backupId error:&error];
+        if (live == NSNotFound) { finish(error); return; }
+        if (expectLive && expectLive.unsignedIntegerValue != live) {
+            [self.savePipeline discardLogForKey:logKey];
+            finish([NSError errorWithDomain:@"ContactsManager" code:603
+                                   userInfo:@{NSLocalizedDescriptionKey:@"Backup changed since the restore was interrupted"}]);
+            return;
+        }
+
+        NSMutableIndexSet *selectedIdx = [NSMutableIndexSet indexSet];
+        if (indices.count == 0) {
+            [selectedIdx addIndexesInRange:NSMakeRange(0, live)];
+        } else {
+            for (NSNumber *n in indices) {
+                NSInteger i = n.integerValue;
+                if (i >= 0 && i < (NSInteger)live) [selectedIdx addIndex:(NSUInteger)i];
+            }
+        }
+
+        BOOL smart = [kind isEqualToString:kCMRestoreSmart];
+        if (selectedIdx.count == 0) {
+            if ([kind isEqualToString:kCMRestoreSelected]) { finish(nil); return; }
+            finish(smart ? [NSError errorWithDomain:@"ContactsManager" code:501
+                                           userInfo:@{NSLocalizedDescriptionKey:@"No contacts selected in backup"}]
+                         : [NSError errorWithDomain:@"ContactsManager" code:422
+                                           userInfo:@{NSLocalizedDescriptionKey:@"No contacts selected to restore"}]);
+            return;
+        }
+
+        NSString *containerId = nil;
+        if (![kind isEqualToString:kCMRestoreSelected]) {
+            containerId = [self.store defaultContainerIdentifier];
+            if (containerId.length == 0) {
+                finish([NSError errorWithDomain:@"ContactsManager" code:(smart ? 502 : 420)
+                                       userInfo:@{NSLocalizedDescriptionKey:@"Default container not found"}]);
+                return;
+            }
+        }
+
+        NSArray<CNContact *> *selected = [self _contactsInBackupId:backupId indexes:selectedIdx error:&error];
+        if (!selected) { finish(error); return; }
+
+        // 智能恢复：现有联系人的电话 / 邮箱；每批写成功后再把新增的并进来
+        NSMutableSet<NSString *> *phoneSet = [NSMutableSet set];
+        NSMutableSet<NSString *> *emailSet = [NSMutableSet set];
+        if (smart) {
+            NSError *fetchErr = nil;
+            NSArray<CNContact *> *existing = [self _fetchAllContactsInDefaultContainerForSmartMatch:&fetchErr];
+            if (fetchErr) { finish(fetchErr); return; }
+            for (CNContact *c in existing) {
+                [self _indexMutableForSets:c phoneSet:phoneSet emailSet:emailSet];
+            }
+        }
+
+        NSMutableArray<NSNumber *> *ranges = [NSMutableArray array];
+        [selectedIdx enumerateRangesUsingBlock:^(NSRange r, BOOL *stop) {
+            [ranges addObject:@(r.location)];
+            [ranges addObject:@(r.length)];
+        }];
+
+        CMSaveTask *task = [CMSaveTask new];
+        task.total = selected.count;
+        task.progress = progress;
+        task.logKey = logKey;
+        task.info = @{ @"kind": kind, @"backupId": backupId, @"live": @(live), @"ranges": ranges };
+
+        __block NSMutableIndexSet *added = nil;   // 当前这一批新增的（build 与 committed 成对调用）
+        task.build = ^NSUInteger(CNSaveRequest *req, NSRange r) {
+            added = [NSMutableIndexSet indexSet];
+            NSMutableSet<NSString *> *batchPhones = [NSMutableSet set];
+            NSMutableSet<NSString *> *batchEmails = [NSMutableSet set];
+            for (NSUInteger i = r.location; i < NSMaxRange(r); i++) {
+                @autoreleasepool {
+                    CNContact *b = selected[i];
+                    if (!smart) {
+                        // 从 vCard 解析出来的 CNContact 没有可用 identifier，直接 add 即可
+                        [req addContact:[b mutableCopy] toContainerWithIdentifier:containerId];
+                        [added addIndex:i];
+                        continue;
                     }
+                    if ([self _backupContactExistsByPhoneOrEmail:b phoneSet:phoneSet emailSet:emailSet] ||
+                        [self _backupContactExistsByPhoneOrEmail:b phoneSet:batchPhones emailSet:batchEmails]) {
+                        continue;
+                    }
+                    [req addContact:[self _mutableContactForAddFromBackupContact:b] toContainerWithIdentifier:containerId];
+                    [self _indexMutableForSets:b phoneSet:batchPhones emailSet:batchEmails];
+                    [added addIndex:i];
                 }
             }
-
-            CNSaveRequest *req = [[CNSaveRequest alloc] init];
-            for (CNContact *c in selected) {
-                CNMutableContact *mc = [c mutableCopy];
-                [req addContact:mc toContainerWithIdentifier:nil];
+            return added.count;
+        };
+        task.committed = ^(NSRange r, BOOL saved) {
+            if (!smart || !saved) return;
+            [added enumerateIndexesUsingBlock:^(NSUInteger i, BOOL *stop) {
+                [self _indexMutableForSets:selected[i] phoneSet:phoneSet emailSet:emailSet];
+            }];
+        };
+        // 探针只管正在写的那个区间（一个 CNSaveRequest，整体生效或整体没生效）：
+        // 区间里第一个会新增的人，记下同名联系人数，重跑时数变多就说明这个区间已写入
+        task.probe = ^NSDictionary *(NSRange r) {
+            for (NSUInteger i = r.location; i < NSMaxRange(r); i++) {
+                CNContact *b = selected[i];
+                if (smart && [self _backupContactExistsByPhoneOrEmail:b phoneSet:phoneSet emailSet:emailSet]) continue;
+                NSString *name = [CNContactFormatter stringFromContact:b style:CNContactFormatterStyleFullName];
+                NSInteger n = [self _countContactsMatchingName:name];
+                if (n >= 0) return @{ @"name": name, @"count": @(n) };
             }
+            return nil;
+        };
+        task.verify = ^BOOL(NSRange r, NSDictionary *probe) {
+            NSInteger n = [self _countContactsMatchingName:probe[@"name"]];
+            return n > [probe[@"count"] integerValue];
+        };
 
-            BOOL ok = [self.store executeSaveRequest:req error:&e];
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (!ok) { if (completion) completion(e); }
-                else { if (completion) completion(nil); }
-            });
+        BOOL ok = [self.savePipeline runTask:task operation:op error:&error];
+        finish(ok ? nil : error);
+    });
+    return op;
+}
+
+- (BOOL)hasInterruptedRestore {
+    return [self.savePipeline pendingTaskInfos].count > 0;
+}
+
+- (CMSaveOperation *)resumeInterruptedRestoreWithProgress:(CMSaveProgressBlock)progress
+                                               completion:(CMVoidBlock)completion {
+    NSDictionary *info = [self.savePipeline pendingTaskInfos].firstObject;
+    NSString *kind = info[@"kind"];
+    NSString *backupId = info[@"backupId"];
+    NSArray<NSNumber *> *ranges = info[@"ranges"];
+    NSNumber *live = info[@"live"];
+    BOOL known = [kind isEqualToString:kCMRestoreSelected] || [kind isEqualToString:kCMRestoreSmart] ||
+                 [kind isEqualToString:kCMRestoreOverwrite];
+    if (!known || ![backupId isKindOfClass:[NSString class]] || ![ranges isKindOfClass:[NSArray class]] ||
+        ![live isKindOfClass:[NSNumber class]]) {
+        if (info) [self.savePipeline discardLogForKey:[NSString stringWithFormat:@"restore-%@-%@", kind, backupId]];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completion) completion(info ? [NSError errorWithDomain:@"ContactsManager" code:603
+                                                              userInfo:@{NSLocalizedDescriptionKey:@"Interrupted restore cannot be resumed"}] : nil);
         });
-    }];
+        return nil;
+    }
+
+    NSMutableArray<NSNumber *> *indices = [NSMutableArray array];
+    for (NSUInteger k = 0; k + 1 < ranges.count; k += 2) {
+        NSUInteger loc = ranges[k].unsignedIntegerValue, len = ranges[k + 1].unsignedIntegerValue;
+        for (NSUInteger i = loc; i < loc + len && i < live.unsignedIntegerValue; i++) [indices addObject:@(i)];
+    }
+    return [self _restoreFromBackupId:backupId kind:kind indices:indices expectLive:live progress:progress completion:completion];
 }
 
 #pragma mark - Normalization helpers
 
+// 归一化表只建一次：保留集 = letterCharacterSet ∪ decimalDigitCharacterSet（BMP 位图），
+// 小写取 lowercaseString 里长度不变的那部分；查表内核见 CMContactKey
+static CMKeyTables *CMSharedKeyTables(void) {
+    static CMKeyTables *tables;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableCharacterSet *keep = [[NSCharacterSet letterCharacterSet] mutableCopy];
+        [keep formUnionWithCharacterSet:[NSCharacterSet decimalDigitCharacterSet]];
+        NSData *bitmap = keep.bitmapRepresentation;
+        tables = bitmap.length >= 8192 ? cm_keytab_create(bitmap.bytes) : cm_keytab_create(NULL);
+
+        // 有大小写的 BMP 字符：大写 + 标题大小写，再加罗马数字 / 带圈字母这类非字母
+        NSMutableCharacterSet *cased = [[NSCharacterSet uppercaseLetterCharacterSet] mutableCopy];
+        [cased formUnionWithCharacterSet:[NSCharacterSet capitalizedLetterCharacterSet]];
+        [cased addCharactersInRange:NSMakeRange(0x2160, 0x10)];
+        [cased addCharactersInRange:NSMakeRange(0x24B6, 0x1A)];
+        NSData *casedBits = cased.bitmapRepresentation;
+        const uint8_t *bits = casedBits.bytes;
+        NSMutableString *m = [NSMutableString string];
+        for (uint32_t ch = 0; ch < 0x10000 && (ch >> 3) < casedBits.length; ch++) {
+            if (!((bits[ch >> 3] >> (ch & 7)) & 1)) continue;
+            unichar u = (unichar)ch;
+            [m setString:[NSString stringWithCharacters:&u length:1]];
+            CFStringLowercase((__bridge CFMutableStringRef)m, NULL);
+            if (m.length == 1) cm_keytab_set_lower(tables, u, [m characterAtIndex:0]);
+        }
+    });
+    return tables;
+}
+
+enum { CMKeyStackLen = 256 };
+
+// 取出 UTF-16 跑一遍内核；短串用栈上缓冲
+static NSString *CMApplyKey(NSString *s, uint32_t (*fn)(const CMKeyTables *, const uint16_t *, uint32_t, uint16_t *)) {
+    NSUInteger n = s.length;
+    if (n == 0) return @"";
+    unichar stack[CMKeyStackLen * 2];
+    unichar *in = n <= CMKeyStackLen ? stack : malloc(sizeof(unichar) * n * 2);
+    if (!in) return @"";
+    unichar *out = in + n;
+    [s getCharacters:in range:NSMakeRange(0, n)];
+    uint32_t k = fn(CMSharedKeyTables(), in, (uint32_t)n, out);
+    NSString *key = [[NSString alloc] initWithCharacters:out length:k];
+    if (in != stack) free(in);
+    return key;
+}
+
 - (BOOL)_isNameMissing:(CNContact *)c {
     // 用系统全名格式化
     NSString *full = [CNContactFormatter stringFromContact:c style:CNContactFormatterStyleFullName];
@@ -746,126 +1246,251 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
                 c.organizationName ?: @""];
     }
 
-    NSString *s = [[full stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] lowercaseString];
-
-    // 保留“任意语种的字母” + “数字”，去掉空格/标点
-    NSMutableCharacterSet *keep = [NSMutableCharacterSet characterSetWithCharactersInString:@""];
-    [keep formUnionWithCharacterSet:[NSCharacterSet letterCharacterSet]];        // 包含中文等 Unicode 字母
-    [keep formUnionWithCharacterSet:[NSCharacterSet decimalDigitCharacterSet]]; // 数字
-    NSCharacterSet *remove = [keep invertedSet];
-
-    NSArray *parts = [s componentsSeparatedByCharactersInSet:remove];
-    NSString *key = [parts componentsJoinedByString:@""];
-
-    return key;
+    // 小写后只留“任意语种的字母” + “数字”，去掉空格/标点
+    return CMApplyKey(full, cm_key_name);
 }
 
 - (NSString *)_normalizePhone:(NSString *)raw {
-    if (raw.length == 0) return @"";
-    NSMutableString *digits = [NSMutableString string];
-    for (NSUInteger i = 0; i < raw.length; i++) {
-        unichar ch = [raw characterAtIndex:i];
-        if (ch >= '0' && ch <= '9') [digits appendFormat:@"%c", ch];
-    }
-
-    if (digits.length > 11) {
-        return [digits substringFromIndex:digits.length - 11];
-    }
-    return digits;
+    NSUInteger n = raw.length;
+    if (n == 0) return @"";
+    unichar stack[CMKeyStackLen];
+    unichar *buf = n <= CMKeyStackLen ? stack : malloc(sizeof(unichar) * n);
+    if (!buf) return @"";
+    [raw getCharacters:buf range:NSMakeRange(0, n)];
+
+    // 只留 0-9，保留最后 11 位（国内手机号常用）
+    char digits[11];
+    uint32_t k = cm_key_phone_digits(buf, (uint32_t)n, digits);
+    if (buf != stack) free(buf);
+    return [[NSString alloc] initWithBytes:digits length:k encoding:NSASCIIStringEncoding];
 }
 
 #pragma mark - 5 Duplicate detection
 
 - (void)fetchDuplicateContactsWithMode:(CMDuplicateMode)mode completion:(CMDuplicatesBlock)completion {
-    [self fetchAllContacts:^(NSArray<CNContact *> * _Nullable contacts, NSError * _Nullable error) {
-        if (error || !contacts) { if (completion) completion(nil, nil, nil, error); return; }
-
-        dispatch_async(self.workQueue, ^{
-            NSMutableDictionary<NSString *, NSMutableArray<CNContact *> *> *nameMap  = [NSMutableDictionary dictionary];
-            NSMutableDictionary<NSString *, NSMutableArray<CNContact *> *> *phoneMap = [NSMutableDictionary dictionary];
-
-            for (CNContact *c in contacts) {
-                NSString *nk = [self _normalizeName:c];
-                if (nk.length > 0) {
-                    if (!nameMap[nk]) nameMap[nk] = [NSMutableArray array];
-                    [nameMap[nk] addObject:c];
-                }
+    dispatch_async(self.workQueue, ^{
+        NSError *error = nil;
+        CMContactIndex *index = [self _refreshedContactIndex:&error];
+        if (!index) {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, nil, nil, error); });
+            return;
+        }
 
-                if ([c isKeyAvailable:CNContactPhoneNumbersKey]) {
-                    for (CNLabeledValue<CNPhoneNumber *> *lv in c.phoneNumbers) {
-                        NSString *pk = [self _normalizePhone:lv.value.stringValue];
-                        if (pk.length > 0) {
-                            if (!phoneMap[pk]) phoneMap[pk] = [NSMutableArray array];
-                            [phoneMap[pk] addObject:c];
-                        }
-                    }
-                }
-            }
+        if (mode == CMDuplicateModeCluster) {
+            NSArray<CMDuplicateGroup *> *groups = [self _clusterGroupsInIndex:index error:&error];
+            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(groups, nil, nil, groups ? nil : error); });
+            return;
+        }
 
-            NSArray<CMDuplicateGroup *> *(^buildGroups)(NSDictionary<NSString *, NSMutableArray<CNContact *> *> *, CMDuplicateMode) =
-            ^(NSDictionary<NSString *, NSMutableArray<CNContact *> *> *map, CMDuplicateMode byMode) {
-                NSMutableArray<CMDuplicateGroup *> *groups = [NSMutableArray array];
-                [map enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableArray<CNContact *> *obj, BOOL *stop) {
-                    NSOrderedSet *set = [NSOrderedSet orderedSetWithArray:obj];
-                    if (set.count >= 2) {
-                        CMDuplicateGroup *g = [CMDuplicateGroup new];
-                        g.key = key;
-                        g.by = byMode;
-                        g.items = set.array;
-                        [groups addObject:g];
-                    }
-                }];
-                return groups;
-            };
+        NSDictionary<NSString *, NSArray<NSString *> *> *nameClusters = [index nameClusters];
 
-            NSArray<CMDuplicateGroup *> *nameGroups = buildGroups(nameMap, CMDuplicateModeName);
+        // 电话组排除已在姓名组里的人（与原逻辑一致）
+        NSMutableSet<NSString *> *nameDupIDs = [NSMutableSet set];
+        for (NSArray<NSString *> *ids in nameClusters.objectEnumerator) [nameDupIDs addObjectsFromArray:ids];
 
-            NSMutableSet<NSString *> *nameDupIDs = [NSMutableSet set];
-            for (CMDuplicateGroup *g in nameGroups) {
-                for (CNContact *c in g.items) {
-                    if (c.identifier.length > 0) {
-                        [nameDupIDs addObject:c.identifier];
-                    }
-                }
+        NSMutableDictionary<NSString *, NSArray<NSString *> *> *phoneClusters = [NSMutableDictionary dictionary];
+        [[index phoneClusters] enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSArray<NSString *> *ids, BOOL *stop) {
+            NSMutableArray<NSString *> *filtered = [NSMutableArray array];
+            for (NSString *cid in ids) {
+                if (![nameDupIDs containsObject:cid]) [filtered addObject:cid];
             }
+            if (filtered.count >= 2) phoneClusters[key] = filtered;
+        }];
 
-            NSMutableDictionary<NSString *, NSMutableArray<CNContact *> *> *phoneMapFiltered = [NSMutableDictionary dictionary];
-            [phoneMap enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableArray<CNContact *> *obj, BOOL *stop) {
-                NSMutableArray<CNContact *> *filtered = [NSMutableArray array];
-                NSOrderedSet *set = [NSOrderedSet orderedSetWithArray:obj];
-                for (CNContact *c in set.array) {
-                    if (c.identifier.length == 0) continue;
-                    if (![nameDupIDs containsObject:c.identifier]) {
-                        [filtered addObject:c];
-                    }
+        // 只取出组里的联系人
+        NSMutableOrderedSet<NSString *> *need = [NSMutableOrderedSet orderedSet];
+        if (mode != CMDuplicateModePhone) [need unionSet:nameDupIDs];
+        if (mode != CMDuplicateModeName) {
+            for (NSArray<NSString *> *ids in phoneClusters.objectEnumerator) [need addObjectsFromArray:ids];
+        }
+        NSDictionary<NSString *, CNContact *> *byId = [self _contactsByIdForIdentifiers:need.array
+                                                                                  keys:[self keysForDuplicateDetect]
+                                                                                 error:&error];
+        if (!byId) {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(nil, nil, nil, error); });
+            return;
+        }
+
+        NSArray<CMDuplicateGroup *> *(^buildGroups)(NSDictionary<NSString *, NSArray<NSString *> *> *, CMDuplicateMode) =
+        ^(NSDictionary<NSString *, NSArray<NSString *> *> *clusters, CMDuplicateMode byMode) {
+            NSMutableArray<CMDuplicateGroup *> *groups = [NSMutableArray array];
+            [clusters enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSArray<NSString *> *ids, BOOL *stop) {
+                NSMutableArray<CNContact *> *items = [NSMutableArray arrayWithCapacity:ids.count];
+                for (NSString *cid in ids) {
+                    CNContact *c = byId[cid];
+                    if (c) [items addObject:c];
                 }
-                if (filtered.count >= 2) {
-                    phoneMapFiltered[key] = filtered;
+                if (items.count >= 2) {
+                    CMDuplicateGroup *g = [CMDuplicateGroup new];
+                    g.key = key;
+                    g.by = byMode;
+                    g.items = items;
+                    [groups addObject:g];
                 }
             }];
+            return groups;
+        };
 
-            NSArray<CMDuplicateGroup *> *phoneGroups = buildGroups(phoneMapFiltered, CMDuplicateModePhone);
+        NSArray<CMDuplicateGroup *> *nameGroups = (mode == CMDuplicateModePhone) ? @[] : buildGroups(nameClusters, CMDuplicateModeName);
+        NSArray<CMDuplicateGroup *> *phoneGroups = (mode == CMDuplicateModeName) ? @[] : buildGroups(phoneClusters, CMDuplicateModePhone);
 
-            NSArray<CMDuplicateGroup *> *outGroups = nil;
-            if (mode == CMDuplicateModeName) {
-                outGroups = nameGroups;
-            } else if (mode == CMDuplicateModePhone) {
-                outGroups = phoneGroups;
-            } else {
-                outGroups = [nameGroups arrayByAddingObjectsFromArray:phoneGroups];
-            }
+        NSArray<CMDuplicateGroup *> *outGroups = nil;
+        if (mode == CMDuplicateModeName) {
+            outGroups = nameGroups;
+        } else if (mode == CMDuplicateModePhone) {
+            outGroups = phoneGroups;
+        } else {
+            outGroups = [nameGroups arrayByAddingObjectsFromArray:phoneGroups];
+        }
 
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (completion) {
-                    if (mode == CMDuplicateModeAll) {
-                        completion(outGroups, nameGroups, phoneGroups, nil);
-                    } else {
-                        completion(outGroups, nil, nil, nil);
-                    }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completion) {
+                if (mode == CMDuplicateModeAll) {
+                    completion(outGroups, nameGroups, phoneGroups, nil);
+                } else {
+                    completion(outGroups, nil, nil, nil);
                 }
-            });
+            }
         });
-    }];
+    });
+}
+
+#pragma mark - 5b Duplicate clusters
+
+// 键换成稠密 id 再交给聚类：哈希相同再比原串，两个不同的键不会因为撞哈希被连成一簇
+static void CMClusterAddKey(CMCluster *cl, uint32_t row, CMClusterKeyKind kind, CMKeySet *set, NSString *key) {
+    NSUInteger n = key.length;
+    unichar stack[CMKeyStackLen];
+    unichar *buf = n <= CMKeyStackLen ? stack : malloc(sizeof(unichar) * n);
+    if (!buf) return;
+    [key getCharacters:buf range:NSMakeRange(0, n)];
+    uint32_t id = cm_keyset_intern(set, buf, (uint32_t)n);
+    if (buf != stack) free(buf);
+    if (id != UINT32_MAX) cm_cluster_add_key(cl, row, kind, id);
+}
+
+// 拉丁音译 + 去声调 + 只留 a-z0-9：「張偉」「Zhang Wei」「zhāng wěi」都成 zhangwei。
+// 同音不同字也会撞成同一个串，所以它只用来找疑似对，不参与合并
+- (NSString *)_fuzzyNameForContact:(CNContact *)c {
+    NSString *full = [CNContactFormatter stringFromContact:c style:CNContactFormatterStyleFullName];
+    if (full.length == 0) {
+        full = [NSString stringWithFormat:@"%@%@%@", c.familyName ?: @"", c.givenName ?: @"", c.organizationName ?: @""];
+    }
+    if (full.length == 0) return @"";
+
+    NSMutableString *m = [full mutableCopy];
+    CFStringTransform((__bridge CFMutableStringRef)m, NULL, kCFStringTransformToLatin, false);
+    CFStringTransform((__bridge CFMutableStringRef)m, NULL, kCFStringTransformStripCombiningMarks, false);
+    NSString *lower = m.lowercaseString;
+
+    NSUInteger n = MIN(lower.length, (NSUInteger)CM_CLUSTER_FUZZY_MAX * 2);
+    unichar buf[CM_CLUSTER_FUZZY_MAX * 2];
+    [lower getCharacters:buf range:NSMakeRange(0, n)];
+    NSUInteger k = 0;
+    for (NSUInteger i = 0; i < n && k < CM_CLUSTER_FUZZY_MAX; i++) {
+        unichar ch = buf[i];
+        if ((ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9')) buf[k++] = ch;
+    }
+    return [NSString stringWithCharacters:buf length:k];
+}
+
+// 索引上跑一遍聚类；返回成员 >= 2 的簇（identifier，按索引顺序）。possible 非 NULL 时一并给出疑似对（每个两人）
+- (NSArray<NSArray<NSString *> *> *)_clusterIdentifiersInIndex:(CMContactIndex *)index
+                                                      possible:(NSArray<NSArray<NSString *> *> **)possible {
+    NSArray<NSString *> *ids = index.identifiers;
+    if (possible) *possible = @[];
+    if (ids.count < 2) return @[];
+
+    CMCluster *cl = cm_cluster_create();
+    CMKeySet *names = cm_keyset_create(), *phones = cm_keyset_create(), *emails = cm_keyset_create();
+    unichar buf[CM_CLUSTER_FUZZY_MAX];
+    for (NSString *cid in ids) {
+        CMContactIndexEntry *e = [index entryForIdentifier:cid];
+        NSUInteger len = MIN(e.fuzzyName.length, (NSUInteger)CM_CLUSTER_FUZZY_MAX);
+        [e.fuzzyName getCharacters:buf range:NSMakeRange(0, len)];
+        uint32_t row = cm_cluster_add(cl, buf, (uint32_t)len);
+        if (e.nameKey.length > 0) CMClusterAddKey(cl, row, CMClusterKeyName, names, e.nameKey);
+        for (NSString *pk in e.phoneKeys) CMClusterAddKey(cl, row, CMClusterKeyPhone, phones, pk);
+        for (NSString *ek in e.emailKeys) CMClusterAddKey(cl, row, CMClusterKeyEmail, emails, ek);
+    }
+    cm_keyset_destroy(names);
+    cm_keyset_destroy(phones);
+    cm_keyset_destroy(emails);
+    cm_cluster_run(cl, NULL);
+
+    uint32_t n = cm_cluster_count(cl);
+    uint32_t *rows = malloc(sizeof(uint32_t) * n);
+    uint32_t *starts = malloc(sizeof(uint32_t) * (n + 1));
+    NSMutableArray<NSArray<NSString *> *> *out = [NSMutableArray array];
+    if (rows && starts) {
+        uint32_t groups = cm_cluster_groups(cl, 2, rows, starts);
+        for (uint32_t g = 0; g < groups; g++) {
+            NSMutableArray<NSString *> *members = [NSMutableArray arrayWithCapacity:starts[g + 1] - starts[g]];
+            for (uint32_t i = starts[g]; i < starts[g + 1]; i++) [members addObject:ids[rows[i]]];
+            [out addObject:members];
+        }
+    }
+    if (possible) {
+        uint32_t pc = cm_cluster_fuzzy_pair_count(cl);
+        NSMutableArray<NSArray<NSString *> *> *pairs = [NSMutableArray arrayWithCapacity:pc];
+        for (uint32_t i = 0; i < pc; i++) {
+            uint32_t a, b;
+            cm_cluster_fuzzy_pair(cl, i, &a, &b);
+            [pairs addObject:@[ids[a], ids[b]]];
+        }
+        *possible = pairs;
+    }
+    free(rows);
+    free(starts);
+    cm_cluster_destroy(cl);
+    return out;
+}
+
+- (NSArray<CMDuplicateGroup *> *)_clusterGroupsInIndex:(CMContactIndex *)index error:(NSError **)error {
+    NSArray<NSArray<NSString *> *> *possible = nil;
+    NSArray<NSArray<NSString *> *> *clusters = [self _clusterIdentifiersInIndex:index possible:&possible];
+
+    // 两人已在同一个确定簇里的疑似对不再单列，否则同一次合并会在「重复」和「疑似」里各出现一次
+    NSMutableDictionary<NSString *, NSNumber *> *clusterOf = [NSMutableDictionary dictionary];
+    for (NSUInteger gi = 0; gi < clusters.count; gi++) {
+        for (NSString *cid in clusters[gi]) clusterOf[cid] = @(gi);
+    }
+    NSMutableArray<NSArray<NSString *> *> *pairs = [NSMutableArray arrayWithCapacity:possible.count];
+    for (NSArray<NSString *> *pair in possible) {
+        NSNumber *a = clusterOf[pair.firstObject], *b = clusterOf[pair.lastObject];
+        if (a && [a isEqualToNumber:b]) continue;
+        [pairs addObject:pair];
+    }
+    possible = pairs;
+
+    NSMutableOrderedSet<NSString *> *need = [NSMutableOrderedSet orderedSet];
+    for (NSArray<NSString *> *ids in clusters) [need addObjectsFromArray:ids];
+    for (NSArray<NSString *> *ids in possible) [need addObjectsFromArray:ids];
+    NSDictionary<NSString *, CNContact *> *byId = [self _contactsByIdForIdentifiers:need.array
+                                                                              keys:[self keysForDuplicateDetect]
+                                                                             error:error];
+    if (!byId) return nil;
+
+    // 确定的簇在前，疑似对在后
+    NSMutableArray<CMDuplicateGroup *> *groups = [NSMutableArray arrayWithCapacity:clusters.count + possible.count];
+    NSUInteger certain = clusters.count;
+    clusters = [clusters arrayByAddingObjectsFromArray:possible];
+    for (NSUInteger gi = 0; gi < clusters.count; gi++) {
+        NSArray<NSString *> *ids = clusters[gi];
+        NSMutableArray<CNContact *> *items = [NSMutableArray arrayWithCapacity:ids.count];
+        for (NSString *cid in ids) {
+            CNContact *c = byId[cid];
+            if (c) [items addObject:c];
+        }
+        if (items.count < 2) continue;
+        CMDuplicateGroup *g = [CMDuplicateGroup new];
+        g.key = [index entryForIdentifier:ids.firstObject].nameKey ?: @"";
+        g.by = CMDuplicateModeCluster;
+        g.items = items;
+        g.possible = gi >= certain;
+        [groups addObject:g];
+    }
+    return groups;
 }
 
 #pragma mark - 6 Merge contacts
@@ -990,56 +1615,31 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
     dispatch_async(self.workQueue, ^{
         NSError *error = nil;
 
-        // 读备份文件
-        NSData *data = [NSData dataWithContentsOfURL:[self _backupFileURL:backupId]];
-        if (!data) {
-            NSError *e = [NSError errorWithDomain:@"ContactsManager" code:120 userInfo:@{NSLocalizedDescriptionKey:@"Backup not found"}];
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
-            return;
-        }
-
-        NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
-        if (!json || error) {
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
-            return;
-        }
-
-        NSString *b64 = json[@"vcardBase64"] ?: @"";
-        NSData *vcard = [[NSData alloc] initWithBase64EncodedString:b64 options:0];
-
-        NSArray<CNContact *> *contacts = @[];
-        if (vcard.length > 0) {
-            contacts = [CNContactVCardSerialization contactsWithData:vcard error:&error] ?: @[];
-            if (error) {
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
-                return;
-            }
-        }
-
         if (indices.count == 0) {
             NSError *e = [NSError errorWithDomain:@"ContactsManager" code:121 userInfo:@{NSLocalizedDescriptionKey:@"No indices to delete"}];
             dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
             return;
         }
 
-        // 生成要删除的 indexSet（过滤越界）
-        NSMutableIndexSet *removeSet = [NSMutableIndexSet indexSet];
-        for (NSNumber *n in indices) {
-            NSInteger i = n.integerValue;
-            if (i >= 0 && i < (NSInteger)contacts.count) [removeSet addIndex:(NSUInteger)i];
-        }
-        if (removeSet.count == 0) {
-            NSError *e = [NSError errorWithDomain:@"ContactsManager" code:122 userInfo:@{NSLocalizedDescriptionKey:@"Indices out of range"}];
+        // 旧 JSON 备份先转成容器
+        NSURL *url = [self _backupContainerURL:backupId];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:url.path] &&
+            ![self _migrateLegacyBackup:backupId error:&error]) {
+            NSError *e = error ?: [NSError errorWithDomain:@"ContactsManager" code:120 userInfo:@{NSLocalizedDescriptionKey:@"Backup not found"}];
             dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
             return;
         }
 
-        NSMutableArray<CNContact *> *mutable = [contacts mutableCopy];
-        [mutable removeObjectsAtIndexes:removeSet];
+        // 打墓碑：只改写文件头部
+        NSUInteger live = 0;
+        if ([self _tombstoneIndices:indices inBackupAtURL:url liveAfter:&live error:&error] < 0) {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
+            return;
+        }
 
         // 如果删空：直接删除这个备份文件 + 从 index.json 移除
-        if (mutable.count == 0) {
-            [[NSFileManager defaultManager] removeItemAtURL:[self _backupFileURL:backupId] error:nil];
+        if (live == 0) {
+            [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
 
             NSDictionary *idx = [self _readBackupIndex];
             NSMutableArray *arr = [idx[@"backups"] mutableCopy] ?: [NSMutableArray array];
@@ -1062,28 +1662,7 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
             return;
         }
 
-        // 重新序列化 vCard
-        NSData *newVcard = [CNContactVCardSerialization dataWithContacts:mutable error:&error];
-        if (!newVcard || error) {
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
-            return;
-        }
-
-        NSMutableDictionary *newJson = [json mutableCopy];
-        newJson[@"count"] = @(mutable.count);
-        newJson[@"vcardBase64"] = [newVcard base64EncodedStringWithOptions:0];
-
-        NSData *out = [NSJSONSerialization dataWithJSONObject:newJson options:NSJSONWritingPrettyPrinted error:&error];
-        if (!out || error) {
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
-            return;
-        }
-
-        BOOL w = [out writeToURL:[self _backupFileURL:backupId] options:NSDataWritingAtomic error:&error];
-        if (!w) {
-            dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(error); });
-            return;
-        }
+        [self _compactBackupIfNeededAtURL:url];
 
         // 同步更新 index.json 里的 count
         NSDictionary *idx = [self _readBackupIndex];
@@ -1091,7 +1670,7 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
         for (NSUInteger i = 0; i < arr.count; i++) {
             NSMutableDictionary *d = [arr[i] mutableCopy];
             if ([d[@"backupId"] isEqualToString:backupId]) {
-                d[@"count"] = @(mutable.count);
+                d[@"count"] = @(live);
                 arr[i] = d;
                 break;
             }
@@ -1214,96 +1793,14 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
 - (void)restoreContactsSmartFromBackupId:(NSString *)backupId
                  contactIndicesInBackup:(NSArray<NSNumber *> *)indices
                              completion:(CMVoidBlock)completion {
+    [self restoreContactsSmartFromBackupId:backupId contactIndicesInBackup:indices progress:nil completion:completion];
+}
 
-    [self fetchContactsInBackupId:backupId completion:^(NSArray<CNContact *> * _Nullable backupContacts, NSError * _Nullable error) {
-        if (error || !backupContacts) { if (completion) completion(error); return; }
-
-        dispatch_async(self.workQueue, ^{
-            NSMutableArray<CNContact *> *selected = [NSMutableArray array];
-            if (indices.count == 0) {
-                [selected addObjectsFromArray:backupContacts];
-            } else {
-                for (NSNumber *n in indices) {
-                    NSInteger i = n.integerValue;
-                    if (i >= 0 && i < (NSInteger)backupContacts.count) {
-                        [selected addObject:backupContacts[i]];
-                    }
-                }
-            }
-
-            if (selected.count == 0) {
-                NSError *e = [NSError errorWithDomain:@"ContactsManager"
-                                                 code:501
-                                             userInfo:@{NSLocalizedDescriptionKey:@"No contacts selected in backup"}];
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
-                return;
-            }
-
-            NSString *containerId = [self.store defaultContainerIdentifier];
-            if (containerId.length == 0) {
-                NSError *e = [NSError errorWithDomain:@"ContactsManager"
-                                                 code:502
-                                             userInfo:@{NSLocalizedDescriptionKey:@"Default container not found"}];
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
-                return;
-            }
-
-            NSError *fetchErr = nil;
-            NSArray<CNContact *> *existing = [self _fetchAllContactsInDefaultContainerForSmartMatch:&fetchErr];
-            if (fetchErr) {
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(fetchErr); });
-                return;
-            }
-
-            NSMutableSet<NSString *> *phoneSet = [NSMutableSet set];
-            NSMutableSet<NSString *> *emailSet = [NSMutableSet set];
-
-            for (CNContact *c in existing) {
-                if ([c isKeyAvailable:CNContactPhoneNumbersKey]) {
-                    for (CNLabeledValue<CNPhoneNumber *> *lv in (c.phoneNumbers ?: @[])) {
-                        NSString *k = [self _normalizePhoneForMatch:lv.value.stringValue];
-                        if (k.length > 0) [phoneSet addObject:k];
-                    }
-                }
-                if ([c isKeyAvailable:CNContactEmailAddressesKey]) {
-                    for (CNLabeledValue<NSString *> *lv in (c.emailAddresses ?: @[])) {
-                        NSString *k = [self _normalizeEmailForMatch:lv.value];
-                        if (k.length > 0) [emailSet addObject:k];
-                    }
-                }
-            }
-
-            CNSaveRequest *req = [CNSaveRequest new];
-            NSUInteger addCount = 0;
-
-            for (CNContact *b in selected) {
-                if ([self _backupContactExistsByPhoneOrEmail:b phoneSet:phoneSet emailSet:emailSet]) {
-                    continue;
-                }
-
-                CNMutableContact *mc = [self _mutableContactForAddFromBackupContact:b];
-                [req addContact:mc toContainerWithIdentifier:containerId];
-                addCount++;
-
-                [self _indexMutableForSets:mc phoneSet:phoneSet emailSet:emailSet];
-            }
-
-            if (addCount == 0) {
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    if (completion) completion(nil);
-                });
-                return;
-            }
-
-            NSError *saveErr = nil;
-            BOOL ok = [self.store executeSaveRequest:req error:&saveErr];
-
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (!ok) { if (completion) completion(saveErr); }
-                else { if (completion) completion(nil); }
-            });
-        });
-    }];
+- (CMSaveOperation *)restoreContactsSmartFromBackupId:(NSString *)backupId
+                               contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                             progress:(CMSaveProgressBlock)progress
+                                           completion:(CMVoidBlock)completion {
+    return [self _restoreFromBackupId:backupId kind:kCMRestoreSmart indices:indices expectLive:nil progress:progress completion:completion];
 }
 
 #pragma mark - Smart Restore Helpers
@@ -1344,23 +1841,14 @@ NSString * const CMBackupsDidChangeNotification = @"CMBackupsDidChangeNotificati
                                                    error:error] ?: @[];
 }
 
+// 与重复检测 / 看板用同一套键，否则智能恢复和索引对“同一个号码”的判断会不一致
 - (NSString *)_normalizePhoneForMatch:(NSString *)raw {
-    if (raw.length == 0) return @"";
-    NSMutableString *digits = [NSMutableString string];
-    for (NSUInteger i = 0; i < raw.length; i++) {
-        unichar ch = [raw characterAtIndex:i];
-        if (ch >= '0' && ch <= '9') [digits appendFormat:@"%c", ch];
-    }
-    if (digits.length > 11) {
-        return [digits substringFromIndex:digits.length - 11]; // 国内手机号常用；如不需要可去掉
-    }
-    return digits;
+    return [self _normalizePhone:raw];
 }
 
 - (NSString *)_normalizeEmailForMatch:(NSString *)raw {
     if (![raw isKindOfClass:[NSString class]] || raw.length == 0) return @"";
-    NSString *s = [[raw stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] lowercaseString];
-    return s;
+    return CMApplyKey(raw, cm_key_email);
 }
 
 - (NSString *)_addressKey:(CNPostalAddress *)a {
@@ -1524,8 +2012,8 @@ static inline BOOL CMIsEmptyStr(NSString *s) {
         // 1) 删文件（best-effort）
         for (NSString *bid in backupIds) {
             if (![bid isKindOfClass:[NSString class]] || bid.length == 0) continue;
-            NSURL *u = [self _backupFileURL:bid];
-            [[NSFileManager defaultManager] removeItemAtURL:u error:nil];
+            [[NSFileManager defaultManager] removeItemAtURL:[self _backupContainerURL:bid] error:nil];
+            [[NSFileManager defaultManager] removeItemAtURL:[self _backupFileURL:bid] error:nil];
         }
 
         // 2) 更新 index.json
@@ -1560,58 +2048,15 @@ static inline BOOL CMIsEmptyStr(NSString *s) {
 - (void)restoreContactsOverwriteAllFromBackupId:(NSString *)backupId
                         contactIndicesInBackup:(NSArray<NSNumber *> *)indices
                                     completion:(CMVoidBlock)completion {
+    [self restoreContactsOverwriteAllFromBackupId:backupId contactIndicesInBackup:indices progress:nil completion:completion];
+}
 
-    [self fetchContactsInBackupId:backupId completion:^(NSArray<CNContact *> * _Nullable backupContacts, NSError * _Nullable error) {
-        if (error || !backupContacts) { if (completion) completion(error); return; }
-
-        dispatch_async(self.workQueue, ^{
-            // 选中要恢复的联系人
-            NSMutableArray<CNContact *> *selected = [NSMutableArray array];
-            if (indices.count == 0) {
-                [selected addObjectsFromArray:backupContacts];
-            } else {
-                for (NSNumber *n in indices) {
-                    NSInteger i = n.integerValue;
-                    if (i >= 0 && i < (NSInteger)backupContacts.count) {
-                        [selected addObject:backupContacts[i]];
-                    }
-                }
-            }
-
-            if (selected.count == 0) {
-                NSError *e = [NSError errorWithDomain:@"ContactsManager" code:422
-                                             userInfo:@{NSLocalizedDescriptionKey:@"No contacts selected to restore"}];
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
-                return;
-            }
-
-            NSString *containerId = [self.store defaultContainerIdentifier];
-            if (containerId.length == 0) {
-                NSError *e = [NSError errorWithDomain:@"ContactsManager" code:420
-                                             userInfo:@{NSLocalizedDescriptionKey:@"Default container not found"}];
-                dispatch_async(dispatch_get_main_queue(), ^{ if (completion) completion(e); });
-                return;
-            }
-
-            // 只新增：不管现有联系人，不去重，不跳过
-            CNSaveRequest *req = [CNSaveRequest new];
-            for (CNContact *c in selected) {
-                @autoreleasepool {
-                    // 从 vCard 解析出来的 CNContact 没有可用 identifier，直接 add 即可
-                    CNMutableContact *mc = [c mutableCopy];
-                    [req addContact:mc toContainerWithIdentifier:containerId];
-                }
-            }
-
-            NSError *saveErr = nil;
-            BOOL ok = [self.store executeSaveRequest:req error:&saveErr];
-
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (!ok) { if (completion) completion(saveErr); }
-                else { if (completion) completion(nil); }
-            });
-        });
-    }];
+// 只新增：不管现有联系人，不去重，不跳过
+- (CMSaveOperation *)restoreContactsOverwriteAllFromBackupId:(NSString *)backupId
+                                      contactIndicesInBackup:(NSArray<NSNumber *> *)indices
+                                                    progress:(CMSaveProgressBlock)progress
+                                                  completion:(CMVoidBlock)completion {
+    return [self _restoreFromBackupId:backupId kind:kCMRestoreOverwrite indices:indices expectLive:nil progress:progress completion:completion];
 }
 
 - (void)fetchIncompleteContacts:(CMIncompletesBlock)completion {
@@ -1623,29 +2068,33 @@ static inline BOOL CMIsEmptyStr(NSString *s) {
         NSMutableArray<CNContact *> *missPhone = [NSMutableArray array];
         NSMutableArray<CNContact *> *missBoth = [NSMutableArray array];
 
-        CNContactFetchRequest *req =
-            [[CNContactFetchRequest alloc] initWithKeysToFetch:[self keysForIncompleteDetect]];
-        req.unifyResults = YES;
-
-        BOOL ok = [self.store enumerateContactsWithFetchRequest:req
-                                                         error:&error
-                                                    usingBlock:^(CNContact * _Nonnull c, BOOL * _Nonnull stop) {
-            @autoreleasepool {
-                BOOL n = [self _isNameMissing:c];
-                BOOL p = [self _isPhoneMissing:c];
-                if (!n && !p) return;
-
-                [all addObject:c];
-
-                if (n && p) {
-                    [missBoth addObject:c];
-                } else if (n) {
-                    [missName addObject:c];
-                } else if (p) {
-                    [missPhone addObject:c];
-                }
+        // 索引里已有不完整标记，只取出这些联系人
+        CMContactIndex *index = [self _refreshedContactIndex:&error];
+        NSMutableArray<NSString *> *ids = [NSMutableArray array];
+        for (NSString *cid in index.identifiers) {
+            CMContactIndexEntry *e = [index entryForIdentifier:cid];
+            if (e.nameMissing || e.phoneMissing) [ids addObject:cid];
+        }
+        NSDictionary<NSString *, CNContact *> *byId = index ? [self _contactsByIdForIdentifiers:ids
+                                                                                          keys:[self keysForIncompleteDetect]
+                                                                                         error:&error] : nil;
+        BOOL ok = (byId != nil);
+
+        for (NSString *cid in ids) {
+            CNContact *c = byId[cid];
+            if (!c) continue;
+            CMContactIndexEntry *e = [index entryForIdentifier:cid];
+
+            [all addObject:c];
+
+            if (e.nameMissing && e.phoneMissing) {
+                [missBoth addObject:c];
+            } else if (e.nameMissing) {
+                [missName addObject:c];
+            } else {
+                [missPhone addObject:c];
             }
-        }];
+        }
 
         if (!ok && !error) {
             error = [NSError errorWithDomain:@"ContactsManager"
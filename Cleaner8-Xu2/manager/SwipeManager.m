@@ -1,10 +1,14 @@
 #import "SwipeManager.h"
 #import "Common.h"
+#import "ASAssetSizeService.h"
 #import <UIKit/UIKit.h>
 #import <Photos/Photos.h>
 
 NSString * const SwipeManagerDidUpdateNotification = @"SwipeManagerDidUpdateNotification";
 
+// bytesByAssetID 的口径：2 = 大小服务的全部资源之和（1 / 无 = 只取第一个资源）
+static const NSInteger kSwipeBytesVersion = 2;
+
 #pragma mark - SwipeModule
 
 @implementation SwipeModule
@@ -178,14 +182,17 @@ NSString * const SwipeManagerDidUpdateNotification = @"SwipeManagerDidUpdateNoti
     NSDictionary *sorts  = state[@"moduleSortAscendingByID"];
     NSArray *random20    = state[@"random20AssetIDs"];
     NSNumber *archBytes  = state[@"archivedBytesCached"];
+    NSNumber *bytesVer   = state[@"bytesVersion"];
 
     NSDictionary *cursor = state[@"moduleCursorAssetIDByID"];
 
     if ([status isKindOfClass:NSDictionary.class]) self.statusByAssetID = status.mutableCopy;
-    if ([bytes isKindOfClass:NSDictionary.class]) self.bytesByAssetID = bytes.mutableCopy;
+    // 旧版本只取第一个资源的大小，与扫描口径不一致：丢掉，refreshArchivedBytesIfNeeded 按大小服务重新补齐
+    BOOL bytesCurrent = [bytesVer isKindOfClass:NSNumber.class] && bytesVer.integerValue == kSwipeBytesVersion;
+    if ([bytes isKindOfClass:NSDictionary.class] && bytesCurrent) self.bytesByAssetID = bytes.mutableCopy;
     if ([sorts isKindOfClass:NSDictionary.class]) self.moduleSortAscendingByID = sorts.mutableCopy;
     if ([random20 isKindOfClass:NSArray.class]) self.random20AssetIDs = random20.mutableCopy;
-    if ([archBytes isKindOfClass:NSNumber.class]) self.archivedBytesCached = archBytes.unsignedLongLongValue;
+    if ([archBytes isKindOfClass:NSNumber.class] && bytesCurrent) self.archivedBytesCached = archBytes.unsignedLongLongValue;
 
     if ([cursor isKindOfClass:NSDictionary.class]) {
         self.moduleCursorAssetIDByID = cursor.mutableCopy;
@@ -250,6 +257,7 @@ NSString * const SwipeManagerDidUpdateNotification = @"SwipeManagerDidUpdateNoti
             @"moduleSortAscendingByID": sortSnap,
             @"random20AssetIDs": randomSnap,
             @"archivedBytesCached": archSnap,
+            @"bytesVersion": @(kSwipeBytesVersion),
             @"moduleCursorAssetIDByID": cursorSnap,
             @"undoStack": undoSnap,
         };
@@ -873,25 +881,17 @@ NSString * const SwipeManagerDidUpdateNotification = @"SwipeManagerDidUpdateNoti
 - (unsigned long long)quickAssetBytes:(NSString *)assetID {
     PHAsset *asset = [self assetForID:assetID];
     if (!asset) return 0;
-
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    if (resources.count == 0) return 0;
-
-    PHAssetResource *res = resources.firstObject;
-    @try {
-        unsigned long long v = [[res valueForKey:@"fileSize"] unsignedLongLongValue];
-        return v;
-    } @catch (__unused NSException *e) {
-        return 0;
-    }
+    return [[ASAssetSizeService shared] totalBytesForAsset:asset];
 }
 
 - (void)refreshArchivedBytesIfNeeded:(void(^)(unsigned long long bytes))completion {
-    // 对已归档但 bytes 缺失的做补齐（可能慢：会读取资源数据）
+    // 对已归档但 bytes 缺失的做补齐（大小服务批量解析，命中其持久化缓存时不读资源）
     NSSet<NSString *> *archived = [self archivedAssetIDSet];
     NSMutableArray<NSString *> *missing = [NSMutableArray array];
-    for (NSString *aid in archived) {
-        if (!self.bytesByAssetID[aid]) [missing addObject:aid];
+    @synchronized (self.stateLock) {
+        for (NSString *aid in archived) {
+            if (!self.bytesByAssetID[aid]) [missing addObject:aid];
+        }
     }
 
     if (missing.count == 0) {
@@ -899,64 +899,19 @@ NSString * const SwipeManagerDidUpdateNotification = @"SwipeManagerDidUpdateNoti
         return;
     }
 
-    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
-        __block unsigned long long add = 0;
-
-        dispatch_group_t g = dispatch_group_create();
-        for (NSString *aid in missing) {
-            dispatch_group_enter(g);
-            PHAsset *asset = [self assetForID:aid];
-            if (!asset) { dispatch_group_leave(g); continue; }
-
-            NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-            PHAssetResource *res = resources.firstObject;
-            if (!res) { dispatch_group_leave(g); continue; }
-
-            // 尝试KVC再次读取
-            unsigned long long v = 0;
-            @try { v = [[res valueForKey:@"fileSize"] unsignedLongLongValue]; } @catch (__unused NSException *e) {}
-
-            if (v > 0) {
-                @synchronized (self.stateLock) {
-                    if ([self statusForAssetID:aid] == SwipeAssetStatusArchived && !self.bytesByAssetID[aid]) {
-                        self.bytesByAssetID[aid] = @(v);
-                        add += v;
-                    }
-                }
-                dispatch_group_leave(g);
-                continue;
-            }
-
-            // fallback：读取数据累计
-            __block unsigned long long bytes = 0;
-            [[PHAssetResourceManager defaultManager] requestDataForAssetResource:res
-                                                                        options:nil
-                                                                 dataReceivedHandler:^(NSData * _Nonnull data) {
-                bytes += data.length;
-            } completionHandler:^(__unused NSError * _Nullable error) {
-                if (bytes > 0) {
-                    @synchronized (self.stateLock) {
-                        if ([self statusForAssetID:aid] == SwipeAssetStatusArchived && !self.bytesByAssetID[aid]) {
-                            self.bytesByAssetID[aid] = @(bytes);
-                            add += bytes;
-                        }
-                    }
-                }
-                dispatch_group_leave(g);
+    NSArray<PHAsset *> *assets = [self assetsForIDs:missing];
+    [[ASAssetSizeService shared] resolveSizesForAssets:assets completion:^(NSDictionary<NSString *, ASAssetSizeInfo *> *sizes) {
+        @synchronized (self.stateLock) {
+            [sizes enumerateKeysAndObjectsUsingBlock:^(NSString *aid, ASAssetSizeInfo *info, BOOL *stop) {
+                if ([self statusForAssetID:aid] != SwipeAssetStatusArchived || self.bytesByAssetID[aid]) return;
+                self.bytesByAssetID[aid] = @(info.totalBytes);
+                self.archivedBytesCached += info.totalBytes;
             }];
         }
-
-        dispatch_group_wait(g, DISPATCH_TIME_FOREVER);
-
-        dispatch_async(dispatch_get_main_queue(), ^{
-            @synchronized (self.stateLock) {
-                self.archivedBytesCached += add;
-            }
-            [self saveStateToDisk];
-            [[NSNotificationCenter defaultCenter] postNotificationName:SwipeManagerDidUpdateNotification object:self];
-            if (completion) completion(self.archivedBytesCached);
-        });
-    });
+        [self saveStateToDisk];
+        [[NSNotificationCenter defaultCenter] postNotificationName:SwipeManagerDidUpdateNotification object:self];
+        if (completion) completion(self.archivedBytesCached);
+    }];
 }
 
 #pragma mark - Delete assets
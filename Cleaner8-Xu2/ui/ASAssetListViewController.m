@@ -457,6 +457,7 @@ static inline void ASNoAnim(dispatch_block_t block) {
 @property (nonatomic, copy) NSString *title;
 @property (nonatomic, strong) NSMutableArray<ASAssetModel *> *assets;
 @property (nonatomic, strong) NSDate *groupDate; // 组排序
+@property (nonatomic) uint64_t groupBytes;        // 组排序（建 section 时从分组视图取，不再逐个累加）
 @property (nonatomic) BOOL isGrouped; // 相似/重复的那种分组 section
 @end
 @implementation ASAssetSection @end
@@ -1999,16 +2000,6 @@ static inline CGFloat ASPillW(NSString *title, UIFont *font, CGFloat imgW, CGFlo
     return m.creationDate ?: m.modificationDate;
 }
 
-- (NSDate *)dateForGroupAssets:(NSArray<ASAssetModel *> *)assets {
-    NSDate *best = nil;
-    for (ASAssetModel *m in assets) {
-        NSDate *d = [self dateForModel:m];
-        if (!d) continue;
-        if (!best || [d compare:best] == NSOrderedDescending) best = d;
-    }
-    return best ?: [NSDate dateWithTimeIntervalSince1970:0];
-}
-
 - (BOOL)isGroupMode {
     return (self.mode == ASAssetListModeSimilarImage ||
             self.mode == ASAssetListModeSimilarVideo ||
@@ -2026,23 +2017,30 @@ static inline CGFloat ASPillW(NSString *title, UIFont *font, CGFloat imgW, CGFlo
     }
 }
 
+- (ASGroupSortOrder)groupSortOrder {
+    switch (self.sortMode) {
+        case ASAssetSortModeNewest:   return ASGroupSortOrderNewest;
+        case ASAssetSortModeOldest:   return ASGroupSortOrderOldest;
+        case ASAssetSortModeLargest:  return ASGroupSortOrderLargest;
+        case ASAssetSortModeSmallest: return ASGroupSortOrderSmallest;
+    }
+    return ASGroupSortOrderNewest;
+}
+
 - (void)rebuildDataFromManager {
     [self.sections removeAllObjects];
     self.assetById = @{}; // 先清空
 
     if ([self isGroupMode]) {
-        NSArray<ASAssetGroup *> *src = (self.mode == ASAssetListModeSimilarImage ||
-                                        self.mode == ASAssetListModeSimilarVideo)
-                                        ? (self.scanMgr.similarGroups ?: @[])
-                                        : (self.scanMgr.duplicateGroups ?: @[]);
-
-        ASGroupType t = [self wantedGroupType];
+        // 分组视图已按当前排序排好，时间 / 字节也是现成的
+        ASGroupReadView *view = [self.scanMgr groupReadViewForType:[self wantedGroupType]
+                                                             order:[self groupSortOrder]];
 
-        for (ASAssetGroup *g in src) {
-            if (g.type != t) continue;
+        for (NSUInteger gi = 0; gi < view.groupCount; gi++) {
+            NSArray<ASAssetModel *> *members = [view groupAtIndex:gi].assets;
 
-            NSMutableArray<ASAssetModel *> *valid = [NSMutableArray array];
-            for (ASAssetModel *m in g.assets) {
+            NSMutableArray<ASAssetModel *> *valid = [NSMutableArray arrayWithCapacity:members.count];
+            for (ASAssetModel *m in members) {
                 if (m.localId.length) [valid addObject:m];
             }
             if (valid.count < 2) continue;
@@ -2050,14 +2048,11 @@ static inline CGFloat ASPillW(NSString *title, UIFont *font, CGFloat imgW, CGFlo
             ASAssetSection *s = [ASAssetSection new];
             s.isGrouped = YES;
             s.assets = valid;
-            s.groupDate = [self dateForGroupAssets:s.assets];
+            s.groupDate = [view dateAtIndex:gi];
+            s.groupBytes = [view bytesAtIndex:gi];
             [self.sections addObject:s];
         }
 
-        [self.sections sortUsingComparator:^NSComparisonResult(ASAssetSection *a, ASAssetSection *b) {
-            return [b.groupDate compare:a.groupDate];
-        }];
-
         NSInteger idx = 1;
         for (ASAssetSection *sec in self.sections) {
             sec.title = [NSString stringWithFormat:@"%ld（%lu）", (long)idx, (unsigned long)sec.assets.count];
@@ -2171,19 +2166,15 @@ static inline CGFloat ASPillW(NSString *title, UIFont *font, CGFloat imgW, CGFlo
 
             case ASAssetSortModeLargest: {
                 [self.sections sortUsingComparator:^NSComparisonResult(ASAssetSection *a, ASAssetSection *b) {
-                    uint64_t sa = [self cleanableBytesForSection:a];
-                    uint64_t sb = [self cleanableBytesForSection:b];
-                    if (sa == sb) return NSOrderedSame;
-                    return (sa > sb) ? NSOrderedAscending : NSOrderedDescending;
+                    if (a.groupBytes == b.groupBytes) return NSOrderedSame;
+                    return (a.groupBytes > b.groupBytes) ? NSOrderedAscending : NSOrderedDescending;
                 }];
             } break;
 
             case ASAssetSortModeSmallest: {
                 [self.sections sortUsingComparator:^NSComparisonResult(ASAssetSection *a, ASAssetSection *b) {
-                    uint64_t sa = [self cleanableBytesForSection:a];
-                    uint64_t sb = [self cleanableBytesForSection:b];
-                    if (sa == sb) return NSOrderedSame;
-                    return (sa < sb) ? NSOrderedAscending : NSOrderedDescending;
+                    if (a.groupBytes == b.groupBytes) return NSOrderedSame;
+                    return (a.groupBytes < b.groupBytes) ? NSOrderedAscending : NSOrderedDescending;
                 }];
             } break;
         }
@@ -3,6 +3,7 @@
 #import <PhotosUI/PhotosUI.h>
 #import <AVFoundation/AVFoundation.h>
 #import <AVKit/AVKit.h>
+#import "ASAssetSizeService.h"
 
 #pragma mark - Helpers
 
@@ -53,30 +54,7 @@ static NSString *ASHumanSizeShort(uint64_t bytes) {
 }
 
 static uint64_t ASAssetTotalBytes(PHAsset *asset) {
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    if (resources.count == 0) return 0;
-
-    BOOL isLive = (asset.mediaType == PHAssetMediaTypeImage) && ((asset.mediaSubtypes & PHAssetMediaSubtypePhotoLive) != 0);
-    uint64_t sum = 0;
-
-    for (PHAssetResource *r in resources) {
-        BOOL need = NO;
-        if (asset.mediaType == PHAssetMediaTypeVideo) {
-            need = (r.type == PHAssetResourceTypeVideo) || (r.type == PHAssetResourceTypeFullSizeVideo);
-        } else if (isLive) {
-            need = (r.type == PHAssetResourceTypePhoto) ||
-                   (r.type == PHAssetResourceTypeFullSizePhoto) ||
-                   (r.type == PHAssetResourceTypePairedVideo);
-        } else {
-            need = (r.type == PHAssetResourceTypePhoto) || (r.type == PHAssetResourceTypeFullSizePhoto);
-        }
-        if (!need) continue;
-
-        NSNumber *n = nil;
-        @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-        sum += n.unsignedLongLongValue;
-    }
-    return sum;
+    return [[ASAssetSizeService shared] totalBytesForAsset:asset];
 }
 
 static UIImage *ASSelectOnImg(void) {
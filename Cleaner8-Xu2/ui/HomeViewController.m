@@ -95,6 +95,21 @@ typedef NS_ENUM(NSUInteger, ASHomeCardType) {
     ASHomeCardTypeOtherPhotos,
 };
 
+// 卡片对应的扫描模块
+static ASScanModuleMask ASModuleMaskForCard(ASHomeCardType type) {
+    switch (type) {
+        case ASHomeCardTypeSimilarPhotos:   return ASScanModuleMaskSimilarImage;
+        case ASHomeCardTypeDuplicatePhotos: return ASScanModuleMaskDuplicateImage;
+        case ASHomeCardTypeScreenshots:     return ASScanModuleMaskScreenshots;
+        case ASHomeCardTypeBlurryPhotos:    return ASScanModuleMaskBlurryPhotos;
+        case ASHomeCardTypeOtherPhotos:     return ASScanModuleMaskOtherPhotos;
+        case ASHomeCardTypeVideos:
+            return ASScanModuleMaskSimilarVideo | ASScanModuleMaskDuplicateVideo |
+                   ASScanModuleMaskScreenRecordings | ASScanModuleMaskBigVideos;
+    }
+    return ASScanModuleMaskAll;
+}
+
 #pragma mark - Scan UI Result Model
 
 @interface ASScanUIResult : NSObject
@@ -1069,6 +1084,7 @@ shouldFullSpanAtIndexPath:(NSIndexPath *)indexPath;
 
 @property (nonatomic, strong) NSTimer *scanUITimer;
 @property (nonatomic) BOOL pendingScanUIUpdate;
+@property (nonatomic) ASScanModuleMask pendingScanModules; // 上次刷新以来变化的模块
 @property (nonatomic) CFTimeInterval lastScanUIFire;
 
 @property (nonatomic, strong) NSSet<NSString *> *allCleanableIds;
@@ -1176,17 +1192,19 @@ shouldFullSpanAtIndexPath:(NSIndexPath *)indexPath;
     self.imgMgr = [[PHCachingImageManager alloc] init];
     self.scanMgr = [ASPhotoScanManager shared];
 
-    self.scanProgressToken = [[ASPhotoScanManager shared] addProgressObserver:^(ASScanSnapshot *snapshot) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            if (snapshot.state == ASScanStateScanning) {
-                [self scheduleScanUIUpdateCoalesced];
-            } else {
-                [self.scanUITimer invalidate];
-                self.scanUITimer = nil;
-                self.pendingScanUIUpdate = NO;
-                [self rebuildModulesAndReload];
-            }
-        });
+    // 增量：只有卡片相关的模块变了才刷新，且只刷这些卡片
+    self.scanProgressToken = [[ASPhotoScanManager shared] addProgressDeltaObserver:^(ASScanProgressDelta *delta) {
+        if (delta.snapshot.state == ASScanStateScanning) {
+            if (delta.changedModules == 0) return;
+            self.pendingScanModules |= delta.changedModules;
+            [self scheduleScanUIUpdateCoalesced];
+        } else {
+            [self.scanUITimer invalidate];
+            self.scanUITimer = nil;
+            self.pendingScanUIUpdate = NO;
+            self.pendingScanModules = 0;
+            [self rebuildModulesAndReload];
+        }
     }];
     [self bootstrapScanFlow];
     
@@ -1426,15 +1444,20 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
 }
 
 - (void)refreshVisibleCellsAndCovers {
+    [self refreshVisibleCellsForModules:ASScanModuleMaskAll];
+}
+
+- (void)refreshVisibleCellsForModules:(ASScanModuleMask)modules {
     NSArray<NSIndexPath *> *vis = [self.cv indexPathsForVisibleItems];
     for (NSIndexPath *ip in vis) {
         if (ip.item >= self.modules.count) continue;
 
+        ASHomeModuleVM *vm = self.modules[ip.item];
+        if (!(ASModuleMaskForCard(vm.type) & modules)) continue;
+
         HomeModuleCell *cell = (HomeModuleCell *)[self.cv cellForItemAtIndexPath:ip];
         if (![cell isKindOfClass:HomeModuleCell.class]) continue;
 
-        ASHomeModuleVM *vm = self.modules[ip.item];
-
         [cell applyVM:vm humanSizeFn:^NSString *(uint64_t bytes) {
             return [HomeModuleCell humanSize:bytes];
         }];
@@ -1841,6 +1864,8 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
     }
 
     self.pendingScanUIUpdate = NO;
+    ASScanModuleMask changed = self.pendingScanModules ?: ASScanModuleMaskAll;
+    self.pendingScanModules = 0;
 
     __weak typeof(self) weakSelf = self;
     dispatch_async(self.homeBuildQueue, ^{
@@ -1860,8 +1885,9 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
             self2.clutterBytes   = r.clutterBytes;
             self2.appDataBytes   = r.appDataBytes;
 
-            // 更新 modules（modules 只有 6 个，主线程改很轻）
+            // 更新 modules（modules 只有 6 个，主线程改很轻）；没变的卡片不动
             for (ASHomeModuleVM *vm in self2.modules) {
+                if (!(ASModuleMaskForCard(vm.type) & changed)) continue;
                 switch (vm.type) {
                     case ASHomeCardTypeSimilarPhotos:
                         vm.totalBytes = r.simBytes; vm.totalCount = r.simCount;
@@ -1898,7 +1924,7 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
 
             [self2 updateHeaderDuringScanning];
 
-            [self2 refreshVisibleCellsAndCovers];
+            [self2 refreshVisibleCellsForModules:changed];
         });
     });
 }
@@ -271,6 +271,10 @@ static inline NSString *ASACFirstCharForAvatar(NSString *s) {
 @property (nonatomic, strong) UIButton *leftButton;
 @property (nonatomic, strong) UIButton *rightButton;
 @property (nonatomic, assign) BOOL hasContactsAccess;
+
+// 备份分页读取：token 变了说明已重新开始，旧页丢弃
+@property (nonatomic, assign) NSUInteger backupLoadToken;
+@property (nonatomic, assign) BOOL backupFullyLoaded;
 @end
 
 @implementation AllContactsViewController
@@ -544,19 +548,11 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
     __weak typeof(self) weakSelf = self;
 
     if (self.mode == AllContactsModeRestore) {
-        [self.contactsManager fetchContactsInBackupId:self.backupId completion:^(NSArray<CNContact *> * _Nullable contacts, NSError * _Nullable error) {
-            if (error) { NSLog(@"读取备份失败: %@", error.localizedDescription); return; }
-
-            weakSelf.contacts = [NSMutableArray arrayWithArray:contacts ?: @[]];
-            [weakSelf.selectedBackupIndices removeAllObjects];
-
-            [weakSelf rebuildSections];
-            [weakSelf.cv reloadData];
-
-            [weakSelf syncTopSelectState];
-            [weakSelf updateBottomState];
-            [weakSelf updateEmptyStateIfNeeded];
-        }];
+        [self.contacts removeAllObjects];
+        [self.selectedBackupIndices removeAllObjects];
+        self.backupFullyLoaded = NO;
+        self.backupLoadToken += 1;
+        [self loadBackupPageWithToken:self.backupLoadToken];
         return;
     }
 
@@ -630,6 +626,30 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
     return name;
 }
 
+// 备份按页解析：第一页先显示，后面的页接着追加（contacts 下标即备份内下标）
+static const NSUInteger kASBackupPageSize = 200;
+
+- (void)loadBackupPageWithToken:(NSUInteger)token {
+    __weak typeof(self) weakSelf = self;
+    NSRange range = NSMakeRange(self.contacts.count, kASBackupPageSize);
+    [self.contactsManager fetchContactsInBackupId:self.backupId range:range completion:^(NSArray<CNContact *> * _Nullable contacts, NSError * _Nullable error) {
+        if (!weakSelf || token != weakSelf.backupLoadToken) return;
+        if (error) { NSLog(@"读取备份失败: %@", error.localizedDescription); return; }
+
+        [weakSelf.contacts addObjectsFromArray:contacts ?: @[]];
+        weakSelf.backupFullyLoaded = (contacts.count < kASBackupPageSize);
+
+        [weakSelf rebuildSections];
+        [weakSelf.cv reloadData];
+
+        [weakSelf syncTopSelectState];
+        [weakSelf updateBottomState];
+        [weakSelf updateEmptyStateIfNeeded];
+
+        if (!weakSelf.backupFullyLoaded) [weakSelf loadBackupPageWithToken:token];
+    }];
+}
+
 - (void)rebuildSections {
     // 不完整联系人：不要首字母分组/吸顶，只做单 section
     if (self.mode == AllContactsModeIncomplete) {
@@ -1242,6 +1262,13 @@ minimumLineSpacingForSectionAtIndex:(NSInteger)section {
         }
         [weakSelf.contacts removeObjectsAtIndexes:rm];
 
+        // 还没读完：后面页的下标已经前移，从头重新读
+        if (!weakSelf.backupFullyLoaded) {
+            [weakSelf showToastDone];
+            [weakSelf loadContacts];
+            return;
+        }
+
         [weakSelf.selectedBackupIndices removeAllObjects];
 
         [weakSelf rebuildSections];
@@ -451,6 +451,8 @@ static NSString * const kASDCDupWhiteBgKind = @"kASDCDupWhiteBgKind";
 
 @property (nonatomic, strong) NSArray<CMDuplicateGroup *> *allGroups;
 @property (nonatomic, strong) NSMutableSet<NSString *> *selectedContactIds;
+// 用户在组内亲手勾过的疑似组：选择按联系人记，全选确定组时疑似组可能被「顺带」勾满，只有这里的才允许合并
+@property (nonatomic, strong) NSHashTable<CMDuplicateGroup *> *confirmedPossibleGroups;
 
 @property (nonatomic, strong) ContactsManager *contactsManager;
 
@@ -490,6 +492,7 @@ static NSString * const kASDCDupWhiteBgKind = @"kASDCDupWhiteBgKind";
 
     self.contactsManager = [ContactsManager shared];
     self.selectedContactIds = [NSMutableSet set];
+    self.confirmedPossibleGroups = [NSHashTable hashTableWithOptions:NSHashTableObjectPointerPersonality];
     self.previewMode = NO;
     self.didMergeOnce = NO;
 
@@ -612,7 +615,7 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
             return;
         }
 
-        [weakSelf.contactsManager fetchDuplicateContactsWithMode:CMDuplicateModeAll
+        [weakSelf.contactsManager fetchDuplicateContactsWithMode:CMDuplicateModeCluster
                                                      completion:^(NSArray<CMDuplicateGroup *> * _Nullable groups,
                                                                   NSArray<CMDuplicateGroup *> * _Nullable nameGroups,
                                                                   NSArray<CMDuplicateGroup *> * _Nullable phoneGroups,
@@ -652,6 +655,11 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
 
 #pragma mark - Helpers
 
+- (void)setAllGroups:(NSArray<CMDuplicateGroup *> *)allGroups {
+    _allGroups = allGroups;
+    [self.confirmedPossibleGroups removeAllObjects];
+}
+
 - (NSInteger)selectedMergeableContactCountInGroups:(NSArray<CMDuplicateGroup *> *)groups {
     NSMutableSet<NSString *> *set = [NSMutableSet set];
     for (CMDuplicateGroup *g in (groups ?: @[])) {
@@ -681,9 +689,11 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
     [self.cv reloadData];
 }
 
+// 疑似组（只是姓名相近）不计数、不参与全选，只能逐组手动勾选
 - (NSSet<NSString *> *)allDuplicateIDsSet {
     NSMutableSet<NSString *> *set = [NSMutableSet set];
     for (CMDuplicateGroup *g in (self.allGroups ?: @[])) {
+        if (g.possible) continue;
         for (CNContact *c in g.items) {
             if (c.identifier.length > 0) [set addObject:c.identifier];
         }
@@ -764,6 +774,7 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
 - (NSArray<CMDuplicateGroup *> *)mergeableGroupsFrom:(NSArray<CMDuplicateGroup *> *)sourceShownGroups {
     NSMutableArray *arr = [NSMutableArray array];
     for (CMDuplicateGroup *g in (sourceShownGroups ?: @[])) {
+        if (g.possible && ![self.confirmedPossibleGroups containsObject:g]) continue;
         NSInteger cnt = 0;
         for (CNContact *c in g.items) {
             if ([self.selectedContactIds containsObject:c.identifier]) {
@@ -1101,6 +1112,7 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
                 [weakSelf.selectedContactIds removeObject:c.identifier];
             } else {
                 [weakSelf.selectedContactIds addObject:c.identifier];
+                if (g.possible) [weakSelf.confirmedPossibleGroups addObject:g];
             }
 
             [weakSelf updateFloatingButtonState];
@@ -1207,7 +1219,9 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
         countToShow = [self selectedIdentifiersInGroup:g].count;
     }
 
-    NSString *title = [NSString stringWithFormat:NSLocalizedString(@"%ld Duplicate Contacts", nil), (long)countToShow];
+    NSString *title = g.possible
+        ? [NSString stringWithFormat:NSLocalizedString(@"%ld Possible Duplicates", nil), (long)countToShow]
+        : [NSString stringWithFormat:NSLocalizedString(@"%ld Duplicate Contacts", nil), (long)countToShow];
     [v configTitle:title allSelected:allSel showSelect:showSelect showRemove:showRemove];
 
     __weak typeof(self) weakSelf = self;
@@ -1217,8 +1231,10 @@ forSupplementaryViewOfKind:UICollectionElementKindSectionHeader
         v.onToggleSelectAll = ^{
             if ([weakSelf isGroupAllSelected:g]) {
                 [weakSelf deselectAllInGroup:g];
+                [weakSelf.confirmedPossibleGroups removeObject:g];
             } else {
                 [weakSelf selectAllInGroup:g];
+                if (g.possible) [weakSelf.confirmedPossibleGroups addObject:g];
             }
             [weakSelf updateFloatingButtonState];
             [weakSelf syncTopSelectState];
@@ -3,6 +3,7 @@
 #import "ASMediaPreviewViewController.h"
 #import <UIKit/UIKit.h>
 #import <Photos/Photos.h>
+#import "ASAssetSizeService.h"
 
 static inline CGFloat SWDesignWidth(void) { return 402.0; }
 static inline CGFloat SWDesignHeight(void) { return 874.0; }
@@ -32,7 +33,7 @@ static NSString *ASImageSavePillText(uint64_t bytes) {
     return [NSString stringWithFormat:NSLocalizedString(@"Save %.0fMB",nil), mb];
 }
 
-static NSString * const kASImgSizeCachePlist = @"as_img_size_cache_v2.plist";
+static NSString * const kASImgSizeCachePlist = @"as_img_size_cache_v3.plist";
 
 static inline NSString *ASImgSizeCachePath(void) {
     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
@@ -1256,19 +1257,9 @@ UICollectionViewDataSourcePrefetching
     return n ? n.unsignedLongLongValue : 0;
 }
 
+/// 与扫描 / 左右滑同一口径（大小服务：全部资源之和）；缓存文件随口径升级换了版本号
 - (uint64_t)fileSizeForAsset:(PHAsset *)asset {
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    PHAssetResource *target = nil;
-    for (PHAssetResource *r in resources) {
-        if (r.type == PHAssetResourceTypePhoto || r.type == PHAssetResourceTypeFullSizePhoto) { target = r; break; }
-    }
-    if (!target) target = resources.firstObject;
-    if (!target) return 0;
-
-    NSNumber *n = nil;
-    @try { n = [target valueForKey:@"fileSize"]; }
-    @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
+    return [[ASAssetSizeService shared] totalBytesForAsset:asset];
 }
 
 - (void)startComputeAllSizesIfNeeded {
@@ -4,6 +4,7 @@
 #import "ASStudioAlbumManager.h"
 #import "ASStudioStore.h"
 #import "ASStudioUtils.h"
+#import "ASAssetSizeService.h"
 
 @implementation ASImageCompressionSummary
 @end
@@ -33,14 +34,6 @@ static CGFloat ASJPEGQualityForQuality(ASImageCompressionQuality q) {
     }
 }
 
-static uint64_t ASAssetFileSize(PHAsset *asset) {
-    PHAssetResource *r = [PHAssetResource assetResourcesForAsset:asset].firstObject;
-    if (!r) return 0;
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
 @interface ImageCompressionManager ()
 @property (atomic) BOOL cancelFlag;
 @property (atomic, readwrite) BOOL isRunning;
@@ -82,7 +75,7 @@ static uint64_t ASAssetFileSize(PHAsset *asset) {
         uint64_t beforeSum = 0;
         uint64_t afterSum = 0;
 
-        for (PHAsset *a in input) beforeSum += ASAssetFileSize(a);
+        for (PHAsset *a in input) beforeSum += [[ASAssetSizeService shared] primaryBytesForAsset:a];
 
         // 先确保 album
         __block PHAssetCollection *studioAlbum = nil;
@@ -181,7 +174,7 @@ static uint64_t ASAssetFileSize(PHAsset *asset) {
                 item.assetId = createdAssetId;
                 item.type = ASStudioMediaTypePhoto;
                 item.afterBytes = (int64_t)jpg.length;
-                item.beforeBytes = (int64_t)ASAssetFileSize(asset);
+                item.beforeBytes = (int64_t)[[ASAssetSizeService shared] primaryBytesForAsset:asset];
                 item.compressedAt = [NSDate date];
                 item.duration = 0;
                 item.displayName = [ASStudioUtils makeDisplayNameForPhotoWithQualitySuffix:ASQualitySuffix(quality)];
@@ -1,6 +1,7 @@
 #import "ImageCompressionQualityViewController.h"
 #import "ImageCompressionProgressViewController.h"
 #import <Photos/Photos.h>
+#import "ASAssetSizeService.h"
 
 static inline CGFloat SWDesignWidth(void) { return 402.0; }
 static inline CGFloat SWDesignHeight(void) { return 874.0; }
@@ -28,14 +29,6 @@ static inline CGFloat ASClamp(CGFloat v, CGFloat lo, CGFloat hi) {
 
 #pragma mark - Helpers
 
-static uint64_t ASAssetFileSize(PHAsset *asset) {
-    PHAssetResource *r = [PHAssetResource assetResourcesForAsset:asset].firstObject;
-    if (!r) return 0;
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
 static NSString *ASMB1(uint64_t bytes) {
     double mb = (double)bytes / (1024.0 * 1024.0);
     return [NSString stringWithFormat:@"%.1fMB", mb];
@@ -388,7 +381,7 @@ static double ASImageRemainRatioForQuality(ASImageCompressionQuality q) {
 
 - (void)calcBefore {
     uint64_t t = 0;
-    for (PHAsset *a in self.assets) t += ASAssetFileSize(a);
+    for (PHAsset *a in self.assets) t += [[ASAssetSizeService shared] primaryBytesForAsset:a];
     self.totalBeforeBytes = t;
 
     NSInteger count = self.assets.count;
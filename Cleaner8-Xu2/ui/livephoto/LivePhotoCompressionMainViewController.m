@@ -4,6 +4,7 @@
 #import <UIKit/UIKit.h>
 #import <Photos/Photos.h>
 #import "LivePhotoCoverFrameManager.h"
+#import "ASAssetSizeService.h"
 
 static inline CGFloat SWDesignWidth(void) { return 402.0; }
 static inline CGFloat SWDesignHeight(void) { return 874.0; }
@@ -33,7 +34,7 @@ static NSString *ASImageSavePillText(uint64_t bytes) {
     return [NSString stringWithFormat:NSLocalizedString(@"Save %.0fMB",nil), mb];
 }
 
-static NSString * const kASLiveSizeCachePlist = @"as_live_size_cache_v1.plist";
+static NSString * const kASLiveSizeCachePlist = @"as_live_size_cache_v2.plist";
 
 static inline NSString *ASLiveSizeCachePath(void) {
     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
@@ -1136,26 +1137,9 @@ UICollectionViewDataSourcePrefetching
     return n ? n.unsignedLongLongValue : 0;
 }
 
-/// Live Photo 占用：图片资源 + paired video 资源一起加
+/// 与扫描 / 左右滑同一口径（大小服务：全部资源之和）；缓存文件随口径升级换了版本号
 - (uint64_t)fileSizeForAsset:(PHAsset *)asset {
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    if (resources.count == 0) return 0;
-
-    uint64_t sum = 0;
-    for (PHAssetResource *r in resources) {
-        BOOL need =
-        (r.type == PHAssetResourceTypePhoto) ||
-        (r.type == PHAssetResourceTypeFullSizePhoto) ||
-        (r.type == PHAssetResourceTypePairedVideo);
-
-        if (!need) continue;
-
-        NSNumber *n = nil;
-        @try { n = [r valueForKey:@"fileSize"]; }
-        @catch (__unused NSException *e) { n = nil; }
-        sum += n.unsignedLongLongValue;
-    }
-    return sum;
+    return [[ASAssetSizeService shared] totalBytesForAsset:asset];
 }
 
 - (void)startComputeAllSizesIfNeeded {
@@ -1,30 +1,16 @@
 #import "LivePhotoCoverFrameManager.h"
 #import <UIKit/UIKit.h>
 
+#import "ASAssetSizeService.h"
 #import "ASStudioAlbumManager.h"
 #import "ASStudioStore.h"
 #import "ASStudioUtils.h"
 
-static uint64_t ASResourceFileSize(PHAssetResource *r) {
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; }
-    @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
-/// 统计 Live Photo：photo bytes & pairedVideo bytes
+/// 统计 Live Photo：转成静态图后留下的 bytes（photo side）& 省掉的 paired video bytes；两者之和 = 资产总大小
 static void ASLiveBytes(PHAsset *asset, uint64_t *outPhoto, uint64_t *outVideo) {
-    uint64_t p = 0, v = 0;
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    for (PHAssetResource *r in resources) {
-        if (r.type == PHAssetResourceTypePhoto ||
-            r.type == PHAssetResourceTypeFullSizePhoto) {
-            p += ASResourceFileSize(r);
-        } else if (r.type == PHAssetResourceTypePairedVideo) {
-            v += ASResourceFileSize(r);
-        }
-    }
-    if (outPhoto) *outPhoto = p;
+    ASAssetSizeInfo *info = [[ASAssetSizeService shared] sizeInfoForAsset:asset];
+    uint64_t v = info.pairedVideoBytes;
+    if (outPhoto) *outPhoto = info.totalBytes - v;
     if (outVideo) *outVideo = v;
 }
 
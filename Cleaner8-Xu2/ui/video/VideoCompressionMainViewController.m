@@ -2,6 +2,7 @@
 #import "VideoCompressionQualityViewController.h"
 #import <UIKit/UIKit.h>
 #import <Photos/Photos.h>
+#import "ASAssetSizeService.h"
 
 static inline CGFloat SWDesignWidth(void) { return 402.0; }
 static inline CGFloat SWDesignHeight(void) { return 874.0; }
@@ -23,7 +24,7 @@ static inline UIFont *ASFontS(CGFloat s, UIFontWeight w) { return [UIFont system
 static inline UIEdgeInsets ASEdgeInsets(CGFloat t, CGFloat l, CGFloat b, CGFloat r) { return UIEdgeInsetsMake(AS(t), AS(l), AS(b), AS(r)); }
 
 #pragma mark - Helpers
-static NSString * const kASVidSizeCachePlist = @"as_vid_size_cache_v2.plist";
+static NSString * const kASVidSizeCachePlist = @"as_vid_size_cache_v3.plist";
 
 static inline NSString *ASVidSizeCachePath(void) {
     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
@@ -959,21 +960,9 @@ UICollectionViewDataSourcePrefetching
     return n ? n.unsignedLongLongValue : 0;
 }
 
+/// 与扫描 / 左右滑同一口径（大小服务：全部资源之和）；缓存文件随口径升级换了版本号
 - (uint64_t)fileSizeForAsset:(PHAsset *)asset {
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    PHAssetResource *target = nil;
-    for (PHAssetResource *r in resources) {
-        if (r.type == PHAssetResourceTypeVideo || r.type == PHAssetResourceTypePairedVideo) {
-            target = r; break;
-        }
-    }
-    if (!target) target = resources.firstObject;
-    if (!target) return 0;
-
-    NSNumber *n = nil;
-    @try { n = [target valueForKey:@"fileSize"]; }
-    @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
+    return [[ASAssetSizeService shared] totalBytesForAsset:asset];
 }
 
 - (NSString *)savePillTextForBytes:(uint64_t)bytes {
@@ -4,6 +4,7 @@
 #import "ASStudioAlbumManager.h"
 #import "ASStudioStore.h"
 #import "ASStudioUtils.h"
+#import "ASAssetSizeService.h"
 
 @implementation ASCompressionItemResult
 @end
@@ -212,15 +213,6 @@ static uint64_t ASFileSizeAtURL(NSURL *url) {
     return (uint64_t)[attr[NSFileSize] unsignedLongLongValue];
 }
 
-static uint64_t ASAssetFileSize(PHAsset *asset) {
-    NSArray<PHAssetResource *> *resources = [PHAssetResource assetResourcesForAsset:asset];
-    PHAssetResource *r = resources.firstObject;
-    if (!r) return 0;
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
 static double ASRemainRatio(ASCompressionQuality q) {
     switch (q) {
         case ASCompressionQualitySmall:  return 0.20; // save 80%
@@ -413,7 +405,7 @@ static CMSampleBufferRef ASCopySampleBufferWithTimeOffset(CMSampleBufferRef sb,
 
     PHAsset *ph = self.assets[self.index];
 
-    uint64_t before = ASAssetFileSize(ph);
+    uint64_t before = [[ASAssetSizeService shared] primaryBytesForAsset:ph];
     self.totalBefore += before;
 
     PHVideoRequestOptions *opt = [PHVideoRequestOptions new];
@@ -3,6 +3,7 @@
 #import <AVFoundation/AVFoundation.h>
 #import "VideoCompressionResultViewController.h"
 #import "VideoCompressionManager.h"
+#import "ASAssetSizeService.h"
 
 static inline CGFloat SWDesignWidth(void) { return 402.0; }
 static inline CGFloat SWDesignHeight(void) { return 874.0; }
@@ -32,14 +33,6 @@ static inline UIColor *ASGrayBG(void) {
     return [UIColor colorWithRed:246/255.0 green:246/255.0 blue:246/255.0 alpha:1.0];
 }
 
-static uint64_t ASAssetFileSize(PHAsset *asset) {
-    PHAssetResource *r = [PHAssetResource assetResourcesForAsset:asset].firstObject;
-    if (!r) return 0;
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
 static NSString *ASMB1(uint64_t bytes) {
     double mb = (double)bytes / (1024.0 * 1024.0);
     return [NSString stringWithFormat:@"%.1fMB", mb];
@@ -314,7 +307,7 @@ static double ASRemainRatioForQuality(ASCompressionQuality q) {
 
     if (self.totalBeforeBytes == 0) {
         uint64_t t = 0;
-        for (PHAsset *a in self.assets) t += ASAssetFileSize(a);
+        for (PHAsset *a in self.assets) t += [[ASAssetSizeService shared] primaryBytesForAsset:a];
         self.totalBeforeBytes = t;
     }
     if (self.estimatedAfterBytes == 0 && self.totalBeforeBytes > 0) {
@@ -3,6 +3,7 @@
 #import <Photos/Photos.h>
 #import "VideoCompressionProgressViewController.h"
 #import "ASMediaPreviewViewController.h"
+#import "ASAssetSizeService.h"
 
 static const CGFloat kASDesignBaseWidth  = 402.0;
 static const CGFloat kASDesignBaseHeight = 874.0;
@@ -20,14 +21,6 @@ static inline CGFloat ASClamp(CGFloat v, CGFloat lo, CGFloat hi) { return MIN(MA
 
 #pragma mark - Helpers
 
-static uint64_t ASAssetFileSize(PHAsset *asset) {
-    PHAssetResource *r = [PHAssetResource assetResourcesForAsset:asset].firstObject;
-    if (!r) return 0;
-    NSNumber *n = nil;
-    @try { n = [r valueForKey:@"fileSize"]; } @catch (__unused NSException *e) { n = nil; }
-    return n.unsignedLongLongValue;
-}
-
 static NSString *ASHumanSize(uint64_t bytes) {
     double b = (double)bytes;
     if (b < 1024) return [NSString stringWithFormat:@"%.0f B", b];
@@ -720,13 +713,13 @@ static inline UIFont *ASRG(CGFloat s) { return [UIFont systemFontOfSize:round(s
     self.titleLabel.text = (count <= 1) ? NSLocalizedString(@"1 Video Selected",nil) : [NSString stringWithFormat:NSLocalizedString(@"%ld Videos Selected",nil),(long)count];
 
     uint64_t total = 0;
-    for (PHAsset *a in self.assets) total += ASAssetFileSize(a);
+    for (PHAsset *a in self.assets) total += [[ASAssetSizeService shared] primaryBytesForAsset:a];
     self.totalBeforeBytes = total;
 
     PHAsset *first = self.assets.firstObject;
     if (!first) return;
 
-    uint64_t b = ASAssetFileSize(first);
+    uint64_t b = [[ASAssetSizeService shared] primaryBytesForAsset:first];
     self.sizeVal.text = (b > 0) ? ASHumanSize(b) : @"--";
     self.durVal.text = ASDurationText(first.duration);
     self.resVal.text = [NSString stringWithFormat:@"%ld × %ld", (long)first.pixelWidth, (long)first.pixelHeight];